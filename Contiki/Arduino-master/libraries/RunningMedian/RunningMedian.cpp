@@ -1,7 +1,7 @@
 //
 //    FILE: RunningMedian.cpp
 //  AUTHOR: Rob dot Tillaart at gmail dot com
-// VERSION: 0.1.08
+// VERSION: 0.1.10
 // PURPOSE: RunningMedian library for Arduino
 //
 // HISTORY:
@@ -14,6 +14,8 @@
 // 0.1.06 - 2013-10-19 faster sort, dynamic arrays, replaced sorted float array with indirection array
 // 0.1.07 - 2013-10-19 add correct median if _cnt is even.
 // 0.1.08 - 2013-10-20 add getElement(), add getSottedElement() add predict()
+// 0.1.09 - 2014-11-02 keep _p sorted in add() instead of bubble sort; MEDIAN_MAX_SIZE overridable; add RunningMedianT template
+// 0.1.10 - 2014-11-09 add() ignores NAN, it broke the size order of _p
 //
 // Released to the public domain
 //
@@ -45,26 +47,44 @@ void RunningMedian::clear()
 {
     _cnt = 0;
     _idx = 0;
-    _sorted = false;
 
     for (uint8_t i=0; i< _size; i++) _p[i] = i;
 }
 
 // adds a new value to the data-set
 // or overwrites the oldest if full.
+// _p is kept in size order, the new value is moved from the position
+// of the value it replaces to its own, so no sort is needed.
+// NAN is ignored, it has no place in the size order.
 void RunningMedian::add(float value)
 {
-    _ar[_idx++] = value;
+    if (isnan(value)) return;
+
+    uint8_t k;
+    if (_cnt < _size) k = _cnt++;
+    else k = rank(_idx);
+
+    _ar[_idx] = value;
+    while (k > 0 && value < _ar[_p[k-1]])
+    {
+        _p[k] = _p[k-1];
+        k--;
+    }
+    while (k + 1 < _cnt && _ar[_p[k+1]] < value)
+    {
+        _p[k] = _p[k+1];
+        k++;
+    }
+    _p[k] = _idx;
+
+    _idx++;
     if (_idx >= _size) _idx = 0; // wrap around
-    if (_cnt < _size) _cnt++;
-    _sorted = false;
 }
 
 float RunningMedian::getMedian()
 {
     if (_cnt > 0)
     {
-        if (_sorted == false) sort();
         if (_cnt & 0x01) return _ar[_p[_cnt/2]];
         else return (_ar[_p[_cnt/2]] + _ar[_p[_cnt/2 - 1]]) / 2.0;
     }
@@ -95,8 +115,6 @@ float RunningMedian::getAverage(uint8_t nMedians)
         uint8_t start = ((_cnt - nMedians)/2);
         uint8_t stop = start + nMedians;
 
-        if (_sorted == false) sort();
-
         float sum = 0;
         for (uint8_t i = start; i < stop; i++) sum += _ar[_p[i]];
         return sum / nMedians;
@@ -117,7 +135,6 @@ float RunningMedian::getSortedElement(uint8_t n)
 {
     if ((_cnt > 0) && (n < _cnt))
     {
-        if (_sorted == false) sort();
         return _ar[_p[n]];
     }
     return NAN;
@@ -127,7 +144,7 @@ float RunningMedian::predict(uint8_t n)
 {
     if ((_cnt > 0) && (n < _cnt/2))
     {
-        float med = getMedian();  // takes care of sorting !
+        float med = getMedian();
         if (_cnt & 0x01)
         {
             return max(med - _ar[_p[_cnt/2-n]], _ar[_p[_cnt/2+n]] - med);
@@ -147,26 +164,27 @@ uint8_t RunningMedian::getSize() { return _size; };
 uint8_t RunningMedian::getCount() { return _cnt; };
 #endif
 
-void RunningMedian::sort()
+// position of element idx in _p, for small sizes a scan of _p,
+// else a binary search on its value and a scan over the equal values.
+uint8_t RunningMedian::rank(uint8_t idx)
 {
-    // bubble sort with flag
-    for (uint8_t i=0; i< _cnt-1; i++)
+    if (_cnt <= 16)
     {
-        bool flag = true;
-        for (uint8_t j=1; j< _cnt-i; j++)
-        {
-            if (_ar[_p[j-1]] > _ar[_p[j]])
-            {
-                uint8_t t = _p[j-1];
-                _p[j-1] = _p[j];
-                _p[j] = t;
-                flag = false;
-            }
-        }
-        if (flag) break;
+        uint8_t k = 0;
+        while (_p[k] != idx) k++;
+        return k;
     }
-
-    _sorted = true;
+    float value = _ar[idx];
+    uint8_t lo = 0;
+    uint8_t hi = _cnt - 1;
+    while (lo < hi)
+    {
+        uint8_t mid = lo + (hi - lo) / 2;
+        if (_ar[_p[mid]] < value) lo = mid + 1;
+        else hi = mid;
+    }
+    while (lo < _cnt - 1 && _p[lo] != idx) lo++;
+    return lo;
 }
 
 // END OF FILE
\ No newline at end of file
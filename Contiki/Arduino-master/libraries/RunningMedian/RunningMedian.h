@@ -4,7 +4,7 @@
 //    FILE: RunningMedian.h
 //  AUTHOR: Rob dot Tillaart at gmail dot com
 // PURPOSE: RunningMedian library for Arduino
-// VERSION: 0.1.08
+// VERSION: 0.1.10
 //     URL: http://arduino.cc/playground/Main/RunningMedian
 // HISTORY: See RunningMedian.cpp
 //
@@ -19,7 +19,7 @@
 
 #include <inttypes.h>
 
-#define RUNNING_MEDIAN_VERSION "0.1.08"
+#define RUNNING_MEDIAN_VERSION "0.1.10"
 
 // prepare for dynamic version
 // not tested use at own risk :)
@@ -32,9 +32,11 @@
 
 // should at least be 5 to be practical
 // odd size results in a 'real' middle element.
-// even size takes the lower of the two middle elements (TODO)
+// even size returns the average of the two middle elements.
 #define MEDIAN_MIN_SIZE     1
-#define MEDIAN_MAX_SIZE     19          // adjust if needed
+#ifndef MEDIAN_MAX_SIZE
+#define MEDIAN_MAX_SIZE     19          // adjust if needed, max 255
+#endif
 
 
 class RunningMedian
@@ -44,7 +46,7 @@ public:
     ~RunningMedian();                   // destructor
 
     void clear();                       // resets internal buffer and var
-    void add(float value);              // adds a new value to internal buffer, optionally replacing the oldest element.
+    void add(float value);              // adds a new value to internal buffer, optionally replacing the oldest element. NAN is ignored.
     float getMedian();                  // returns the median == middle element
 
 #ifdef RUNNING_MEDIAN_ALL
@@ -62,7 +64,6 @@ public:
 #endif
 
 protected:
-    boolean _sorted;
     uint8_t _size;
     uint8_t _cnt;
     uint8_t _idx;
@@ -74,7 +75,169 @@ protected:
     float _ar[MEDIAN_MAX_SIZE];
     uint8_t _p[MEDIAN_MAX_SIZE];
 #endif
-    void sort();
+    uint8_t rank(uint8_t idx);
+};
+
+
+// RunningMedianT is the template variant for integer and fixed point
+// samples, e.g. RunningMedianT<int16_t, 31, long> for raw ADC values.
+//   T   = sample type; a fixed point value is just an integer in its
+//         own units, e.g. 1/16 degree or 1/100 hPa.
+//   N   = window size, 1..255, fixed at compile time, no malloc.
+//   SUM = accumulator for getAverage(), must hold N * max(T).
+//
+// The samples are kept twice: in time order in a ring buffer and in
+// size order in a sorted array. add() finds the oldest sample in the
+// sorted array by binary search and slides the new one into its place,
+// so it moves only the elements between the old and new rank instead
+// of sorting the window. All queries are a lookup in the sorted array.
+// RAM use is 2 * N * sizeof(T) + sizeof(SUM) + 2 bytes.
+//
+// Functions returning T return 0 when the window is empty, check
+// getCount() first; the float averages return NAN.
+template <typename T, uint8_t N, typename SUM = T>
+class RunningMedianT
+{
+public:
+    RunningMedianT() { clear(); };
+
+    void clear()
+    {
+        _cnt = 0;
+        _idx = 0;
+        _sum = 0;
+    };
+
+    // adds a new value, replacing the oldest one if the window is full.
+    // NAN is ignored, it has no place in the size order.
+    void add(T value)
+    {
+        if (value != value) return;     // NAN, never true for integers
+
+        uint8_t k;
+        if (_cnt < N)
+        {
+            k = _cnt++;
+        }
+        else
+        {
+            T old = _ar[_idx];
+            _sum -= old;
+            // binary search for the oldest value, any equal one will do
+            uint8_t lo = 0;
+            uint8_t hi = N - 1;
+            while (lo < hi)
+            {
+                uint8_t mid = lo + (hi - lo) / 2;
+                if (_s[mid] < old) lo = mid + 1;
+                else hi = mid;
+            }
+            k = lo;
+        }
+        _ar[_idx] = value;
+        _sum += value;
+        if (++_idx >= N) _idx = 0;
+
+        // move the free slot k to where value belongs
+        while (k > 0 && value < _s[k-1])
+        {
+            _s[k] = _s[k-1];
+            k--;
+        }
+        while (k + 1 < _cnt && _s[k+1] < value)
+        {
+            _s[k] = _s[k+1];
+            k++;
+        }
+        _s[k] = value;
+    };
+
+    T getMedian()
+    {
+        if (_cnt == 0) return 0;
+        T a = _s[(_cnt - 1) / 2];
+        T b = _s[_cnt / 2];
+        return a + (b - a) / 2;         // no overflow of a + b
+    };
+
+    // q = 0.0 .. 1.0, nearest rank; 0.5 gives the upper middle element for an even count
+    T getQuantile(float q)
+    {
+        if (_cnt == 0) return 0;
+        if (q <= 0) return _s[0];
+        if (q >= 1) return _s[_cnt - 1];
+        return _s[(uint8_t)(q * (_cnt - 1) + 0.5)];
+    };
+
+    T getLowest() { return getSortedElement(0); };
+    T getHighest() { return getSortedElement(_cnt - 1); };
+
+    // n'th element in size order
+    T getSortedElement(uint8_t n)
+    {
+        if (n < _cnt) return _s[n];
+        return 0;
+    };
+
+    // n'th element in time order, 0 is the oldest
+    T getElement(uint8_t n)
+    {
+        if (n >= _cnt) return 0;
+        uint8_t i = n;
+        if (_cnt == N) i = (n < N - _idx) ? _idx + n : n - (N - _idx);
+        return _ar[i];
+    };
+
+    float getAverage()
+    {
+        if (_cnt == 0) return NAN;
+        return (float)_sum / _cnt;
+    };
+
+    // average of the middle nMedian values, removes noise from outliers
+    float getAverage(uint8_t nMedian)
+    {
+        if ((_cnt == 0) || (nMedian == 0)) return NAN;
+        if (nMedian > _cnt) nMedian = _cnt;
+        uint8_t start = (_cnt - nMedian) / 2;
+        SUM sum = 0;
+        for (uint8_t i = start; i < start + nMedian; i++) sum += _s[i];
+        return (float)sum / nMedian;
+    };
+
+    // average without the nTrim lowest and the nTrim highest values
+    float getTrimmedMean(uint8_t nTrim)
+    {
+        if (2 * nTrim >= _cnt) return getAverage(2 - (_cnt & 0x01));
+        SUM sum = _sum;
+        for (uint8_t i = 0; i < nTrim; i++)
+        {
+            sum -= _s[i];
+            sum -= _s[_cnt - 1 - i];
+        }
+        return (float)sum / (_cnt - 2 * nTrim);
+    };
+
+    // predict the max change of median after n additions
+    T predict(uint8_t n)
+    {
+        if (n >= _cnt / 2) return 0;
+        T med = getMedian();
+        T lo = _s[(_cnt - 1) / 2 - n];
+        T hi = _s[_cnt / 2 + n];
+        if (med - lo > hi - med) return med - lo;
+        return hi - med;
+    };
+
+    uint8_t getSize() { return N; };
+    uint8_t getCount() { return _cnt; };
+
+protected:
+    uint8_t _cnt;
+    uint8_t _idx;
+    SUM _sum;
+    T _ar[N];                           // time order, ring buffer
+    T _s[N];                            // size order
 };
 
 #endif
@@ -0,0 +1,22 @@
+//
+//    FILE: Arduino.h
+//  AUTHOR: Rob dot Tillaart at gmail dot com
+// PURPOSE: minimal Arduino.h to build RunningMedian on a PC for the benchmark
+//
+// Released to the public domain
+//
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef bool boolean;
+
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define max(a,b) ((a)>(b)?(a):(b))
+
+#endif
+// END OF FILE
@@ -0,0 +1,271 @@
+//
+//    FILE: RunningMedianBench.cpp
+//  AUTHOR: Rob dot Tillaart at gmail dot com
+// VERSION: 0.1.01
+// PURPOSE: PC benchmark of RunningMedian, add() + getMedian() per second
+//          for window sizes 5..255, compared with the bubble sort of 0.1.08
+//
+// HISTORY:
+// 0.1.00 - 2014-11-02 initial version
+// 0.1.01 - 2014-11-09 check that NAN samples are ignored
+//
+// Released to the public domain
+//
+
+#include <stdio.h>
+#include <time.h>
+
+#include "RunningMedian.h"
+
+#define SAMPLES     100000L
+
+static float samples[SAMPLES];
+static float expected[SAMPLES];
+static float result[SAMPLES];
+static int failures;
+
+// RunningMedian 0.1.08, the indirection array sorted by a bubble sort
+// on every query after an add(), as the baseline.
+class RunningMedianOld
+{
+public:
+    RunningMedianOld(uint8_t size) { _size = size; clear(); };
+    void clear()
+    {
+        _cnt = 0;
+        _idx = 0;
+        _sorted = false;
+        for (uint8_t i=0; i< _size; i++) _p[i] = i;
+    };
+    void add(float value)
+    {
+        _ar[_idx++] = value;
+        if (_idx >= _size) _idx = 0;
+        if (_cnt < _size) _cnt++;
+        _sorted = false;
+    };
+    float getMedian()
+    {
+        if (_cnt > 0)
+        {
+            if (_sorted == false) sort();
+            if (_cnt & 0x01) return _ar[_p[_cnt/2]];
+            else return (_ar[_p[_cnt/2]] + _ar[_p[_cnt/2 - 1]]) / 2.0;
+        }
+        return NAN;
+    };
+    float getSortedElement(uint8_t n)
+    {
+        if (_sorted == false) sort();
+        return _ar[_p[n]];
+    };
+    uint8_t getCount() { return _cnt; };
+
+protected:
+    boolean _sorted;
+    uint8_t _size;
+    uint8_t _cnt;
+    uint8_t _idx;
+    float _ar[255];
+    uint8_t _p[255];
+
+    void sort()
+    {
+        for (uint8_t i=0; i< _cnt-1; i++)
+        {
+            bool flag = true;
+            for (uint8_t j=1; j< _cnt-i; j++)
+            {
+                if (_ar[_p[j-1]] > _ar[_p[j]])
+                {
+                    uint8_t t = _p[j-1];
+                    _p[j-1] = _p[j];
+                    _p[j] = t;
+                    flag = false;
+                }
+            }
+            if (flag) break;
+        }
+        _sorted = true;
+    };
+};
+
+double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// a noisy 10 bit ADC signal with a spike now and then
+void generate()
+{
+    unsigned long seed = 1;
+    for (long i = 0; i < SAMPLES; i++)
+    {
+        seed = seed * 1103515245UL + 12345;
+        int noise = (seed >> 16) % 64;
+        int x = 512 + (i / 50) % 256 + noise;
+        if ((seed >> 8) % 97 == 0) x = (seed >> 20) % 1024;
+        samples[i] = x;
+    }
+}
+
+void report(const char * name, double t)
+{
+    printf("  %-32s %8.0f updates/s\n", name, SAMPLES / t);
+}
+
+void compare(const char * name, uint8_t size)
+{
+    for (long i = 0; i < SAMPLES; i++)
+    {
+        if (result[i] != expected[i])
+        {
+            printf("FAIL: %s, window %d, sample %ld: median %g, expected %g\n",
+                   name, size, i, result[i], expected[i]);
+            failures++;
+            return;
+        }
+    }
+}
+
+// the other statistics against the sorted window of the baseline
+template <typename T, uint8_t N, typename SUM>
+void check(const char * name)
+{
+    RunningMedianOld ref(N);
+    RunningMedianT<T, N, SUM> rm;
+
+    for (long i = 0; i < 20 * N && i < SAMPLES; i++)
+    {
+        ref.add(samples[i]);
+        rm.add(samples[i]);
+        uint8_t c = ref.getCount();
+
+        float q = ref.getSortedElement((uint8_t)(0.9 * (c - 1) + 0.5));
+        float lo = ref.getSortedElement(0);
+        float hi = ref.getSortedElement(c - 1);
+        uint8_t trim = c / 4;
+        float sum = 0;
+        for (uint8_t j = trim; j < c - trim; j++) sum += ref.getSortedElement(j);
+        float mean = sum / (c - 2 * trim);
+
+        if (rm.getQuantile(0.9) != q || rm.getLowest() != lo ||
+            rm.getHighest() != hi || rm.getElement(c - 1) != samples[i] ||
+            fabs(rm.getTrimmedMean(trim) - mean) > 0.001 * mean)
+        {
+            printf("FAIL: %s, window %d, sample %ld: q90 %g/%g low %g/%g "
+                   "high %g/%g trimmed mean %g/%g\n", name, N, i,
+                   (float)rm.getQuantile(0.9), q, (float)rm.getLowest(), lo,
+                   (float)rm.getHighest(), hi, rm.getTrimmedMean(trim), mean);
+            failures++;
+            return;
+        }
+    }
+}
+
+// NAN samples are ignored, so after a burst of NANs the window must
+// match one that only got the other samples.
+template <uint8_t N>
+void check_nan()
+{
+    RunningMedianOld ref(N);
+    RunningMedian rm(N);
+    RunningMedianT<float, N> rmf;
+
+    for (long i = 0; i < 4 * N + 100; i++)
+    {
+        float x = samples[i];
+        if (i < 2 * N && i % 3 == 0) x = NAN;
+        else ref.add(x);
+        rm.add(x);
+        rmf.add(x);
+
+        uint8_t c = ref.getCount();
+        bool ok = (rm.getCount() == c) && (rmf.getCount() == c);
+        for (uint8_t j = 0; ok && j < c; j++)
+        {
+            float e = ref.getSortedElement(j);
+            ok = (rm.getSortedElement(j) == e) && (rmf.getSortedElement(j) == e);
+        }
+        if (!ok || (c > 0 && (rm.getMedian() != ref.getMedian() ||
+                              rmf.getMedian() != ref.getMedian())))
+        {
+            printf("FAIL: NAN, window %d, sample %ld: median %g/%g, expected %g\n",
+                   N, i, rm.getMedian(), (float)rmf.getMedian(), ref.getMedian());
+            failures++;
+            return;
+        }
+    }
+}
+
+template <uint8_t N>
+void bench()
+{
+    double t;
+
+    printf("window %d:\n", N);
+
+    RunningMedianOld old(N);
+    t = now();
+    for (long i = 0; i < SAMPLES; i++)
+    {
+        old.add(samples[i]);
+        expected[i] = old.getMedian();
+    }
+    report("0.1.08 bubble sort", now() - t);
+
+    RunningMedian rm(N);
+    t = now();
+    for (long i = 0; i < SAMPLES; i++)
+    {
+        rm.add(samples[i]);
+        result[i] = rm.getMedian();
+    }
+    report("RunningMedian", now() - t);
+    compare("RunningMedian", N);
+
+    RunningMedianT<float, N> rmf;
+    t = now();
+    for (long i = 0; i < SAMPLES; i++)
+    {
+        rmf.add(samples[i]);
+        result[i] = rmf.getMedian();
+    }
+    report("RunningMedianT<float>", now() - t);
+    compare("RunningMedianT<float>", N);
+
+    // the integer median rounds the average of the middle two down
+    RunningMedianT<int16_t, N, long> rmi;
+    t = now();
+    for (long i = 0; i < SAMPLES; i++)
+    {
+        rmi.add(samples[i]);
+        result[i] = rmi.getMedian();
+    }
+    report("RunningMedianT<int16_t, long>", now() - t);
+    for (long i = 0; i < SAMPLES; i++) expected[i] = floor(expected[i]);
+    compare("RunningMedianT<int16_t, long>", N);
+
+    check<float, N, float>("RunningMedianT<float>");
+    check<int16_t, N, long>("RunningMedianT<int16_t, long>");
+    check_nan<N>();
+}
+
+int main()
+{
+    generate();
+
+    bench<5>();
+    bench<9>();
+    bench<19>();
+    bench<31>();
+    bench<63>();
+    bench<127>();
+    bench<255>();
+
+    printf("%d failures\n", failures);
+    return failures != 0;
+}
+// END OF FILE
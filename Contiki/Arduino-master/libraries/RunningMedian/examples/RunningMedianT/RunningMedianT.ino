@@ -0,0 +1,56 @@
+//
+//    FILE: RunningMedianT.ino
+//  AUTHOR: Rob Tillaart
+// VERSION: 0.1.00
+// PURPOSE: demo of the template variant, integer samples
+//    DATE: 2014-11-02
+//     URL:
+//
+// Released to the public domain
+//
+
+#include "RunningMedian.h"
+
+// 31 raw ADC values, the sum of 31 x 1023 fits in a long
+RunningMedianT<int16_t, 31, long> samples;
+
+long count = 0;
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.print(F("Running Median Version: "));
+  Serial.println(RUNNING_MEDIAN_VERSION);
+}
+
+void loop()
+{
+  if (count % 20 == 0) Serial.println(F("\nmsec \tAnR \tCnt \tLow \tQ10 \tMed \tQ90 \tHigh \tAvg \tTrim(5)"));
+  count++;
+
+  int x = analogRead(A0);
+
+  samples.add(x);
+
+  Serial.print(millis());
+  Serial.print('\t');
+  Serial.print(x);
+  Serial.print('\t');
+  Serial.print(samples.getCount());
+  Serial.print('\t');
+  Serial.print(samples.getLowest());
+  Serial.print('\t');
+  Serial.print(samples.getQuantile(0.1));
+  Serial.print('\t');
+  Serial.print(samples.getMedian());
+  Serial.print('\t');
+  Serial.print(samples.getQuantile(0.9));
+  Serial.print('\t');
+  Serial.print(samples.getHighest());
+  Serial.print('\t');
+  Serial.print(samples.getAverage(), 2);
+  Serial.print('\t');
+  Serial.println(samples.getTrimmedMean(5), 2);
+
+  delay(100);
+}
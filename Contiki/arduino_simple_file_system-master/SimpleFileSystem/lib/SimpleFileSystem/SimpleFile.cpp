@@ -15,160 +15,58 @@
  */
 
 #include <Arduino.h>
-#include <avr/eeprom.h>
+#include <string.h>
 
 #include "SimpleFile.h"
-#include "SimpleTools.h"
+#include "SimpleStore.h"
 
 // Constructor
 SimpleFile::SimpleFile() {
-	Serial.print("Start of data address:");
-	Serial.println(SimpleFileSystem::GetStartOfDataAddress());
+	fName[0] = '\0';
 }
 
 // Constructor
 // filename is the name of the new file
-SimpleFile::SimpleFile(String fileName) {
-	SimpleFile();
-	fName = FixFileName(fileName);
+SimpleFile::SimpleFile(const char *filename) {
+	SetFileName(filename);
 }
 
-// Fix file name
-String SimpleFile::FixFileName(String filename) {
-	int i;
-	if (filename.length() < MaxFilenameSize) {
-		for (i = filename.length(); i < MaxFilenameSize; i ++) {
-			filename +=' ';
-		}
-	}
-	else {
-		filename = filename.substring(0, MaxFilenameSize);
-	}
-
-	return filename;
+// Names longer than MaxFilenameSize are cut
+void SimpleFile::SetFileName(const char *filename) {
+	strncpy(fName, filename, MaxFilenameSize);
+	fName[MaxFilenameSize] = '\0';
 }
 
 // Save the file to EEPROM
-void SimpleFile::Save(String data) {
-	fData = data;
-	bool fileExists = SimpleFileSystem::FileExists(fName);
-	int maximumAddressLength = SimpleTools::GetNumberDigits(SimpleFileSystem::GetEEPROMSize());
-	long i;
-
-	if (fileExists) { // File exists Update file
-		long * fileAddress = SimpleFileSystem::GetFileAddress(fName);
-		long addressStartIndex = fileAddress[0];
-		long addressEndIndex = fileAddress[1];
-
-		long previusDataLength = addressEndIndex - addressStartIndex;
-		Serial.print("Previus data length: " );
-		Serial.println(previusDataLength);
-
-		long newDataLength = data.length();
-		Serial.print("New data length: " );
-		Serial.println(newDataLength);
-
-		long dataDifference = 0;
-		if (newDataLength > previusDataLength) {
-			dataDifference = newDataLength - previusDataLength;
-			Serial.println("New data are bigger");		
-
-		}
-		else {
-			dataDifference = previusDataLength - newDataLength;
-			Serial.println("New data are smaller");
-			// Write the file
-			for (i = addressStartIndex+ dataDifference; i < addressEndIndex; i++) {
-				SimpleFileSystem::WriteToEEPROM(i, fData.charAt(i));
-			}
-		}
-	}
-	else { // Create new file
-		// Find free space to save the new file
-		long positionToStartWriting = -1;
-		for (i = EEPROMSize - 1; i > SimpleFileSystem::GetStartOfDataAddress(); i--) {
-			if (SimpleFileSystem::ReadFromEEPROM(i) == 0) {
-				positionToStartWriting = i;
-				break;
-			}
-		}
-
-		if (positionToStartWriting > -1) {										// Free space found. Write file to EEPROM
-			fAddressStartIndex = positionToStartWriting - fData.length()+1;		// Start of data EEPROM address
-			fAddressEndIndex = fAddressStartIndex + fData.length()-1;			// End of data EEPROM address
-		
-			for (i = 0; i< fData.length(); i++) {								// Write data to EEPROM
-				SimpleFileSystem::WriteToEEPROM(fAddressStartIndex+i, fData.charAt(i));
-			}
-
-			// Create file index data
-			String indexData = fName;
-	
-			String strAddressStartIndex(fAddressStartIndex);					// Fix start address digits
-			if (strAddressStartIndex.length() < maximumAddressLength) {
-				for (i=0; i <maximumAddressLength - strAddressStartIndex.length(); i++) {
-					strAddressStartIndex = "0" + strAddressStartIndex;
-				}
-			}
-			indexData += strAddressStartIndex;
-
-			String strAddressEndIndex(fAddressEndIndex);						// Fix end address digits
-			if (strAddressEndIndex.length() < maximumAddressLength) {
-				for (i=0; i <maximumAddressLength - strAddressEndIndex.length(); i++) {
-					strAddressEndIndex = "0" + strAddressEndIndex;
-				}
-			}
-			indexData += strAddressEndIndex;
+bool SimpleFile::Save(const char *data) {
+	return Save(data, strlen(data));
+}
 
-			indexData += String(char(1));
+// Save the file to EEPROM. The whole file is written in one batch
+bool SimpleFile::Save(const void *data, int length) {
+	bool saved = SimpleStore::Put(fName, data, length) == length;
+	SimpleStore::Flush();
+	return saved;
+}
 
-			// Save file index
-			SaveFileIndex(indexData);
-		}
-	}
+// Load a file
+int SimpleFile::Load(const char *filename, char *buffer, int size) {
+	SetFileName(filename);
+	return Load(buffer, size);
 }
 
-void SimpleFile::SaveFileIndex(String fileIndexData) {
-	int i;
-	int maximumAddressLength = SimpleTools::GetNumberDigits(SimpleFileSystem::GetEEPROMSize());
-	
-	// Find last file index from the begining of EEPROM
-	// and then write the new file index
-	int positionToStartWriting = -1;
-	for (i = 0; i < SimpleFileSystem::GetStartOfDataAddress(); i += MaxFilenameSize + 1 + (2 * maximumAddressLength)) {
-		if (SimpleFileSystem::ReadFromEEPROM(i) == 0) {
-			positionToStartWriting = i;
-			break;
-		}
+int SimpleFile::Load(char *buffer, int size) {
+	if (size <= 0) {
+		return -1;
 	}
 
-	if (positionToStartWriting>-1) {
-		for (i=0; i <fileIndexData.length(); i ++) {
-			SimpleFileSystem::WriteToEEPROM(positionToStartWriting + i , fileIndexData.charAt(i));
-		}
-	}
+	int length = SimpleStore::Get(fName, buffer, size - 1);
+	buffer[length < 0 ? 0 : (length < size - 1 ? length : size - 1)] = '\0';
+	return length;
 }
 
-// Load a new file
-String SimpleFile::Load(String filename) {
-	fName = filename;
-	filename = FixFileName(filename);
-	
-	int i;
-	int maximumAddressLength = SimpleTools::GetNumberDigits(SimpleFileSystem::GetEEPROMSize());
-
-
-	// Check if file exists
-	for (i = 0; i < SimpleFileSystem::GetStartOfDataAddress(); i += MaxFilenameSize + 1 + (2 * maximumAddressLength)) {
-		String portionToCheck = SimpleFileSystem::ReadStringBlockFromEEPROM(i, i + MaxFilenameSize + 1 + (2 * maximumAddressLength));
-		
-		if (portionToCheck.startsWith(filename)) { // File found
-			String startIndexStr = portionToCheck.substring(MaxFilenameSize, MaxFilenameSize + maximumAddressLength);
-			String endIndexStr = portionToCheck.substring(MaxFilenameSize + maximumAddressLength, MaxFilenameSize + 2 * maximumAddressLength);
-			
-			return SimpleFileSystem::ReadStringBlockFromEEPROM(startIndexStr.toInt(), endIndexStr.toInt());
-		}
-	}
-
-	return NULL;
+bool SimpleFile::Remove() {
+	bool removed = SimpleStore::Remove(fName);
+	SimpleStore::Flush();
+	return removed;
 }
@@ -19,21 +19,27 @@
 
 #include "SimpleFileSystem.h"
 
+// A named file, stored as a key of SimpleStore. Files are read into and
+// written from buffers supplied by the caller.
 class SimpleFile  {
 private:
-	String fName;
-	String fData;
-	unsigned long fAddressStartIndex;
-	unsigned long fAddressEndIndex;
-	
-	String FixFileName(String filename);
-	void SaveFileIndex(String fileIndexData);
+	char fName[MaxFilenameSize + 1];
+
+	void SetFileName(const char *filename);
 
 public:
 	SimpleFile();
-	SimpleFile(String filename);	
-	void Save(String data);
-	String Load(String filename);
+	SimpleFile(const char *filename);	
+	// Saves a string; returns false if EEPROM is full
+	bool Save(const char *data);
+	// Saves length bytes of data; returns false if EEPROM is full
+	bool Save(const void *data, int length);
+	// Loads the file into buffer as a string of at most size - 1
+	// characters. Returns the length of the file, or -1 if it does not exist
+	int Load(const char *filename, char *buffer, int size);
+	int Load(char *buffer, int size);
+	// Return's true if the file existed and was removed
+	bool Remove();
 };
 
 #endif
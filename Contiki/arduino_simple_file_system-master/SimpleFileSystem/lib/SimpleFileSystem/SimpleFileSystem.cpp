@@ -16,83 +16,37 @@
 
 #include <Arduino.h>
 #include <avr/eeprom.h>
-#include "SimpleTools.h"
 
 #include "SimpleFileSystem.h"
+#include "SimpleStore.h"
 
 long SimpleFileSystem::GetEEPROMSize() {
 	return EEPROMSize;
 }
 
-// This number indicates the address of the Start of the data storage
-long SimpleFileSystem::GetStartOfDataAddress() {
-	int maximumAddressLength = SimpleTools::GetNumberDigits(SimpleFileSystem::GetEEPROMSize());
-	return MaxFiles * (MaxFilenameSize + 1 + (2 * maximumAddressLength));
-}
-
-// Erases EEPROM
+// Erases all files. Only the segment headers of the store are written, so
+// this does not wear the rest of EEPROM
 void SimpleFileSystem::EraseEEPROM() {
-	for (int i = 0; i < EEPROMSize; i++) {
-		WriteToEEPROM(i, 0);
-	}
+	SimpleStore::Format();
 }
 
 // Return's true if file exist
-bool SimpleFileSystem::FileExists(String filename) {
-	int i;
-	int maximumAddressLength = SimpleTools::GetNumberDigits(SimpleFileSystem::GetEEPROMSize());
-
-	// Check if file exists
-	for (i = 0; i < MaxFiles * (MaxFilenameSize + 1 + (2 * maximumAddressLength)); i += MaxFilenameSize + 1 + (2 * maximumAddressLength)) {
-		String portionToCheck = ReadStringBlockFromEEPROM(i, i + MaxFilenameSize + 1 + (2 * maximumAddressLength));
-	
-		if (portionToCheck.startsWith(filename)) { // File found
-			return true;
-		}
-	}
-	return false;
-}
-
-// Return's the start address of the file
-long* SimpleFileSystem::GetFileAddress(String filename) {
-	int i;
-	int maximumAddressLength = SimpleTools::GetNumberDigits(SimpleFileSystem::GetEEPROMSize());
-	long* pointer;
-	long result[2];
-	pointer = result;
-
-	result[0] = 0;
-	result[1] = 0;
-
-	// Find file
-	for (i = 0; i < MaxFiles * (MaxFilenameSize + 1 + (2 * maximumAddressLength)); i += MaxFilenameSize + 1 + (2 * maximumAddressLength)) {
-		String portionToCheck = SimpleFileSystem::ReadStringBlockFromEEPROM(i, i + MaxFilenameSize + 1 + (2 * maximumAddressLength));
-	
-		if (portionToCheck.startsWith(filename)) // File found
-		{
-			String startIndexStr = portionToCheck.substring(MaxFilenameSize, MaxFilenameSize + maximumAddressLength);
-			String endIndexStr = portionToCheck.substring(MaxFilenameSize + maximumAddressLength, MaxFilenameSize + 2 * maximumAddressLength);
-			result[0] = startIndexStr.toInt();
-			result[1] = endIndexStr.toInt();
-		}
-	}
-
-	return pointer;
+bool SimpleFileSystem::FileExists(const char *filename) {
+	return SimpleStore::Exists(filename);
 }
 
-
 uint8_t SimpleFileSystem::ReadFromEEPROM(int address) {
 	return eeprom_read_byte((unsigned char *) address);
 }
 
-String SimpleFileSystem::ReadStringBlockFromEEPROM(int addressStart, int addressEnd) {
-	String result ="";
-	for (int i=addressStart; i <=addressEnd; i++) {
-		result = result + String(char(ReadFromEEPROM(i)));
-	}
-	return result;
-}
-
 void SimpleFileSystem::WriteToEEPROM(int address, uint8_t value) {
 	eeprom_write_byte((unsigned char *) address, value);
 }
+
+void SimpleFileSystem::ReadBlock(unsigned int address, void *buffer, int length) {
+	eeprom_read_block(buffer, (const void *) address, length);
+}
+
+void SimpleFileSystem::WriteBlock(unsigned int address, const void *buffer, int length) {
+	eeprom_update_block(buffer, (void *) address, length);
+}
@@ -17,6 +17,8 @@
 #ifndef SimpleFileSystem_h
 #define SimpleFileSystem_h
 
+#include <stdint.h>
+
 #ifndef EEPROMSize 
 #define EEPROMSize 1024			// The size of EEPROM in bytes
 #endif
@@ -32,17 +34,17 @@
 class SimpleFileSystem  {
 public:
 	static long GetEEPROMSize();
-	// This number indicates the address of the Start of the data storage
-	static long GetStartOfDataAddress();
-	// Erases EEPROM
+	// Erases all files
 	static void EraseEEPROM();
 	// Return's true if file exist
-	static bool FileExists(String filename);
-	// Return's the start address of the file
-	static long* GetFileAddress(String filename);
+	static bool FileExists(const char *filename);
 	static uint8_t ReadFromEEPROM(int address);
-	static String ReadStringBlockFromEEPROM(int addressStart, int addressEnd);
 	static void WriteToEEPROM(int address, uint8_t value);
+	// Reads length bytes starting at address into buffer
+	static void ReadBlock(unsigned int address, void *buffer, int length);
+	// Writes length bytes starting at address; cells that already hold
+	// the right value are not written
+	static void WriteBlock(unsigned int address, const void *buffer, int length);
 };
 
 #endif
@@ -0,0 +1,512 @@
+/*
+   Copyright 2013 Michael Crosson
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <Arduino.h>
+#include <string.h>
+
+#include "SimpleStore.h"
+
+// EEPROM is used as a ring of segments. Each segment starts with a header
+// that holds its sequence number and the sequence number of the oldest
+// segment in use. Records are appended to the newest segment, and hold a
+// key, a value and a checksum. The checksum includes the sequence number
+// of the segment, so that records left over from an earlier round through
+// the ring are never taken for new ones. When the ring is full, the live
+// records of the oldest segment are copied to the newest one.
+
+#define Segments (EEPROMSize / EEPROMSegmentSize)
+
+#if Segments < 3
+#error "SimpleStore needs room for at least three segments"
+#endif
+
+#if EEPROMSegmentSize % EEPROMPageSize
+#error "EEPROMSegmentSize must be a multiple of EEPROMPageSize"
+#endif
+
+#define SegmentMagic 0x4b56
+#define SegmentHeaderSize 8		// Magic, sequence number, oldest sequence number, checksum
+#define RecordHeaderSize 4		// Key length, flags, value length
+#define RecordSize(keyLength, valueLength) (RecordHeaderSize + (keyLength) + (valueLength) + 2)
+#define FlagRemoved 1
+#define CopyBufferSize 16
+
+struct Record {
+	unsigned int address;
+	uint8_t keyLength;
+	uint8_t flags;
+	unsigned int valueLength;
+};
+
+struct IndexEntry {
+	uint16_t hash;
+	uint16_t address;
+};
+
+static IndexEntry keyIndex[MaxFiles];
+static int keyCount;
+
+// The oldest and the newest segment, and the end of the newest one
+static int head, tail;
+static uint16_t headSeq, tailSeq;
+static unsigned int tailEnd;
+
+// Appended data that has not been written to EEPROM yet
+static uint8_t pageBuffer[EEPROMPageSize];
+static unsigned int bufferStart, bufferEnd;
+
+static void Put16(uint8_t *p, uint16_t value) {
+	p[0] = value & 0xff;
+	p[1] = value >> 8;
+}
+
+static uint16_t Get16(const uint8_t *p) {
+	return p[0] | (p[1] << 8);
+}
+
+// CCITT CRC16, the same as the Contiki store uses
+static uint16_t Crc16(const uint8_t *data, int length, uint16_t acc) {
+	while (length-- > 0) {
+		acc ^= *data++;
+		acc = (acc >> 8) | (acc << 8);
+		acc ^= (acc & 0xff00) << 4;
+		acc ^= (acc >> 8) >> 4;
+		acc ^= (acc & 0xff00) >> 5;
+	}
+	return acc;
+}
+
+static uint16_t HashKey(const char *key, int length) {
+	uint16_t hash = 0;
+	while (length-- > 0) {
+		hash = hash * 31 + (uint8_t) *key++;
+	}
+	return hash;
+}
+
+// Reads EEPROM, including data that is still in the page buffer
+static void ReadBytes(unsigned int address, void *buffer, int length) {
+	SimpleFileSystem::ReadBlock(address, buffer, length);
+
+	unsigned int start = address > bufferStart ? address : bufferStart;
+	unsigned int end = address + length < bufferEnd ? address + length : bufferEnd;
+	if (start < end) {
+		memcpy((uint8_t *) buffer + (start - address), &pageBuffer[start % EEPROMPageSize], end - start);
+	}
+}
+
+// Appends to the page buffer, which is written out when it is full or
+// when data is written elsewhere
+static void WriteBytes(unsigned int address, const void *data, int length) {
+	while (length > 0) {
+		if (bufferStart < bufferEnd && address != bufferEnd) {
+			SimpleStore::Flush();
+		}
+		if (bufferStart == bufferEnd) {
+			bufferStart = bufferEnd = address;
+		}
+
+		int n = EEPROMPageSize - address % EEPROMPageSize;
+		if (n > length) {
+			n = length;
+		}
+		memcpy(&pageBuffer[address % EEPROMPageSize], data, n);
+		bufferEnd += n;
+		if (bufferEnd % EEPROMPageSize == 0) {
+			SimpleStore::Flush();
+		}
+
+		address += n;
+		data = (const uint8_t *) data + n;
+		length -= n;
+	}
+}
+
+static uint16_t Checksum(unsigned int address, unsigned int length, uint16_t acc) {
+	uint8_t buffer[CopyBufferSize];
+	while (length > 0) {
+		unsigned int n = length < sizeof(buffer) ? length : sizeof(buffer);
+		ReadBytes(address, buffer, n);
+		acc = Crc16(buffer, n, acc);
+		address += n;
+		length -= n;
+	}
+	return acc;
+}
+
+static bool ReadSegmentHeader(int segment, uint16_t *seq, uint16_t *first) {
+	uint8_t header[SegmentHeaderSize];
+
+	ReadBytes((unsigned int) segment * EEPROMSegmentSize, header, sizeof(header));
+	if (Get16(header) != SegmentMagic || Get16(&header[6]) != Crc16(header, 6, 0)) {
+		return false;
+	}
+	*seq = Get16(&header[2]);
+	*first = Get16(&header[4]);
+	return true;
+}
+
+static void OpenSegment() {
+	uint8_t header[SegmentHeaderSize];
+
+	tail = (tail + 1) % Segments;
+	tailSeq++;
+	tailEnd = SegmentHeaderSize;
+
+	Put16(header, SegmentMagic);
+	Put16(&header[2], tailSeq);
+	Put16(&header[4], headSeq);
+	Put16(&header[6], Crc16(header, 6, 0));
+	WriteBytes((unsigned int) tail * EEPROMSegmentSize, header, sizeof(header));
+}
+
+// Reads the record at address. If key is not NULL, the key is copied to it
+// and the checksum is verified against the sequence number of the segment
+static bool ReadRecord(Record *r, unsigned int address, uint16_t seq, char *key) {
+	uint8_t header[RecordHeaderSize + 2];
+	unsigned int offset = address % EEPROMSegmentSize;
+
+	if (offset + RecordSize(1, 0) > EEPROMSegmentSize) {
+		return false;
+	}
+
+	ReadBytes(address, header, RecordHeaderSize);
+	r->address = address;
+	r->keyLength = header[0];
+	r->flags = header[1];
+	r->valueLength = Get16(&header[2]);
+	if (r->keyLength == 0 || r->keyLength > MaxFilenameSize || (r->flags & ~FlagRemoved) != 0 ||
+			offset + RecordSize(r->keyLength, r->valueLength) > EEPROMSegmentSize) {
+		return false;
+	}
+
+	if (key != NULL) {
+		Put16(&header[RecordHeaderSize], seq);
+		uint16_t crc = Crc16(&header[RecordHeaderSize], 2, 0);
+		crc = Crc16(header, RecordHeaderSize, crc);
+		ReadBytes(address + RecordHeaderSize, key, r->keyLength);
+		crc = Crc16((const uint8_t *) key, r->keyLength, crc);
+		crc = Checksum(address + RecordHeaderSize + r->keyLength, r->valueLength, crc);
+		ReadBytes(address + RecordHeaderSize + r->keyLength + r->valueLength, header, 2);
+		if (Get16(header) != crc) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Returns the index entry of key and reads its record, or returns -1
+static int Find(const char *key, int keyLength, uint16_t hash, Record *r) {
+	char stored[MaxFilenameSize];
+
+	for (int i = 0; i < keyCount; i++) {
+		if (keyIndex[i].hash == hash && ReadRecord(r, keyIndex[i].address, 0, NULL) && r->keyLength == keyLength) {
+			ReadBytes(r->address + RecordHeaderSize, stored, keyLength);
+			if (memcmp(stored, key, keyLength) == 0) {
+				return i;
+			}
+		}
+	}
+	return -1;
+}
+
+static int Reserve(unsigned int size, bool compacting);
+
+// Appends a record. The key and value come from RAM, or if key is NULL,
+// they are copied from the record at from
+static int Append(const uint8_t *header, const char *key, const void *value, unsigned int from, bool compacting) {
+	uint8_t buffer[CopyBufferSize];
+	unsigned int keyLength = header[0];
+	unsigned int valueLength = Get16(&header[2]);
+
+	int address = Reserve(RecordSize(keyLength, valueLength), compacting);
+	if (address < 0) {
+		return -1;
+	}
+
+	// The checksum covers the sequence number of the segment
+	Put16(buffer, tailSeq);
+	uint16_t crc = Crc16(buffer, 2, 0);
+	crc = Crc16(header, RecordHeaderSize, crc);
+	WriteBytes(address, header, RecordHeaderSize);
+	unsigned int to = address + RecordHeaderSize;
+
+	if (key != NULL) {
+		crc = Crc16((const uint8_t *) key, keyLength, crc);
+		WriteBytes(to, key, keyLength);
+		crc = Crc16((const uint8_t *) value, valueLength, crc);
+		WriteBytes(to + keyLength, value, valueLength);
+		to += keyLength + valueLength;
+	}
+	else {
+		from += RecordHeaderSize;
+		for (unsigned int length = keyLength + valueLength; length > 0; ) {
+			unsigned int n = length < sizeof(buffer) ? length : sizeof(buffer);
+			ReadBytes(from, buffer, n);
+			crc = Crc16(buffer, n, crc);
+			WriteBytes(to, buffer, n);
+			from += n;
+			to += n;
+			length -= n;
+		}
+	}
+
+	Put16(buffer, crc);
+	WriteBytes(to, buffer, 2);
+	tailEnd += RecordSize(keyLength, valueLength);
+
+	return address;
+}
+
+// Copies the live records of the oldest segment to the newest one and
+// releases the oldest segment
+static void Compact() {
+	uint8_t header[RecordHeaderSize];
+	Record r;
+	unsigned int address = (unsigned int) head * EEPROMSegmentSize + SegmentHeaderSize;
+
+	while (ReadRecord(&r, address, headSeq, NULL)) {
+		for (int i = 0; i < keyCount; i++) {
+			if (keyIndex[i].address == address) {
+				header[0] = r.keyLength;
+				header[1] = r.flags;
+				Put16(&header[2], r.valueLength);
+				int newAddress = Append(header, NULL, NULL, address, true);
+				if (newAddress >= 0) {
+					keyIndex[i].address = newAddress;
+				}
+				break;
+			}
+		}
+		address += RecordSize(r.keyLength, r.valueLength);
+	}
+
+	head = (head + 1) % Segments;
+	headSeq++;
+}
+
+// Makes room for a record and returns its address. One segment is kept
+// free so that compacting always has room for the live records
+static int Reserve(unsigned int size, bool compacting) {
+	if (size > EEPROMSegmentSize - SegmentHeaderSize) {
+		return -1;
+	}
+
+	for (int attempts = 0; tailEnd + size > EEPROMSegmentSize; attempts++) {
+		if (compacting || Segments - (uint16_t) (tailSeq - headSeq + 1) > 1) {
+			OpenSegment();
+			break;
+		}
+		if (attempts == Segments) {
+			return -1;
+		}
+		Compact();
+	}
+
+	return (unsigned int) tail * EEPROMSegmentSize + tailEnd;
+}
+
+// Applies the records of a segment to the index and returns the end of
+// its data
+static unsigned int Replay(int segment, uint16_t seq) {
+	Record r, old;
+	char key[MaxFilenameSize];
+	unsigned int address = (unsigned int) segment * EEPROMSegmentSize + SegmentHeaderSize;
+
+	while (ReadRecord(&r, address, seq, key)) {
+		uint16_t hash = HashKey(key, r.keyLength);
+		int i = Find(key, r.keyLength, hash, &old);
+		if (r.flags & FlagRemoved) {
+			if (i >= 0) {
+				keyIndex[i] = keyIndex[--keyCount];
+			}
+		}
+		else {
+			if (i < 0 && keyCount < MaxFiles) {
+				i = keyCount++;
+				keyIndex[i].hash = hash;
+			}
+			if (i >= 0) {
+				keyIndex[i].address = address;
+			}
+		}
+		address += RecordSize(r.keyLength, r.valueLength);
+	}
+
+	return address - (unsigned int) segment * EEPROMSegmentSize;
+}
+
+int SimpleStore::Begin() {
+	uint16_t seq, segmentSeq, first, newestFirst = 0;
+	bool found = false;
+	int i;
+
+	keyCount = 0;
+	bufferStart = bufferEnd = 0;
+
+	// The newest segment holds the sequence number of the oldest one
+	for (i = 0; i < Segments; i++) {
+		if (ReadSegmentHeader(i, &seq, &first) && (!found || (int16_t) (seq - tailSeq) > 0)) {
+			found = true;
+			tail = i;
+			tailSeq = seq;
+			newestFirst = first;
+		}
+	}
+	if (!found || (uint16_t) (tailSeq - newestFirst) >= Segments) {
+		Format();
+		return -1;
+	}
+
+	headSeq = newestFirst;
+	head = (tail + Segments - (uint16_t) (tailSeq - headSeq)) % Segments;
+
+	for (i = head, seq = headSeq; ; i = (i + 1) % Segments, seq++) {
+		if (!ReadSegmentHeader(i, &segmentSeq, &first) || segmentSeq != seq) {
+			// The log is broken; start it after this segment
+			keyCount = 0;
+			head = (i + 1) % Segments;
+			headSeq = seq + 1;
+			continue;
+		}
+		tailEnd = Replay(i, seq);
+		if (i == tail) {
+			break;
+		}
+	}
+
+	return keyCount;
+}
+
+int SimpleStore::Get(const char *key, void *buffer, int size) {
+	Record r;
+	int keyLength = strlen(key);
+
+	if (Find(key, keyLength, HashKey(key, keyLength), &r) < 0) {
+		return -1;
+	}
+
+	if (size > (int) r.valueLength) {
+		size = r.valueLength;
+	}
+	ReadBytes(r.address + RecordHeaderSize + keyLength, buffer, size);
+	return r.valueLength;
+}
+
+static bool SameValue(unsigned int address, const uint8_t *value, unsigned int length) {
+	uint8_t buffer[CopyBufferSize];
+	while (length > 0) {
+		unsigned int n = length < sizeof(buffer) ? length : sizeof(buffer);
+		ReadBytes(address, buffer, n);
+		if (memcmp(buffer, value, n) != 0) {
+			return false;
+		}
+		address += n;
+		value += n;
+		length -= n;
+	}
+	return true;
+}
+
+int SimpleStore::Put(const char *key, const void *value, int length) {
+	uint8_t header[RecordHeaderSize];
+	Record r;
+	int keyLength = strlen(key);
+
+	if (keyLength == 0 || keyLength > MaxFilenameSize || length < 0 ||
+			RecordSize(keyLength, length) > EEPROMSegmentSize - SegmentHeaderSize) {
+		return -1;
+	}
+
+	// Saving the same value again writes nothing
+	uint16_t hash = HashKey(key, keyLength);
+	int i = Find(key, keyLength, hash, &r);
+	if (i >= 0 && (int) r.valueLength == length &&
+			SameValue(r.address + RecordHeaderSize + keyLength, (const uint8_t *) value, length)) {
+		return length;
+	}
+	if (i < 0 && keyCount == MaxFiles) {
+		return -1;
+	}
+
+	header[0] = keyLength;
+	header[1] = 0;
+	Put16(&header[2], length);
+	int address = Append(header, key, value, 0, false);
+	if (address < 0) {
+		return -1;
+	}
+
+	if (i < 0) {
+		i = keyCount++;
+		keyIndex[i].hash = hash;
+	}
+	keyIndex[i].address = address;
+	return length;
+}
+
+bool SimpleStore::Remove(const char *key) {
+	uint8_t header[RecordHeaderSize];
+	Record r;
+	int keyLength = strlen(key);
+
+	int i = Find(key, keyLength, HashKey(key, keyLength), &r);
+	if (i < 0) {
+		return false;
+	}
+
+	header[0] = keyLength;
+	header[1] = FlagRemoved;
+	Put16(&header[2], 0);
+	if (Append(header, key, NULL, 0, false) < 0) {
+		return false;
+	}
+
+	keyIndex[i] = keyIndex[--keyCount];
+	return true;
+}
+
+bool SimpleStore::Exists(const char *key) {
+	Record r;
+	int keyLength = strlen(key);
+
+	return Find(key, keyLength, HashKey(key, keyLength), &r) >= 0;
+}
+
+void SimpleStore::Flush() {
+	if (bufferStart < bufferEnd) {
+		SimpleFileSystem::WriteBlock(bufferStart, &pageBuffer[bufferStart % EEPROMPageSize], bufferEnd - bufferStart);
+	}
+	bufferStart = bufferEnd = 0;
+}
+
+void SimpleStore::Format() {
+	uint8_t zero[2] = {0, 0};
+
+	keyCount = 0;
+	bufferStart = bufferEnd = 0;
+
+	for (int i = 0; i < Segments; i++) {
+		SimpleFileSystem::WriteBlock((unsigned int) i * EEPROMSegmentSize, zero, sizeof(zero));
+	}
+
+	head = 0;
+	headSeq = 0;
+	tail = Segments - 1;
+	tailSeq = headSeq - 1;
+	OpenSegment();
+	Flush();
+}
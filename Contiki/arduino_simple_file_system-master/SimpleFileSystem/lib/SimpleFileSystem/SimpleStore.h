@@ -0,0 +1,54 @@
+/*
+   Copyright 2013 Michael Crosson
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef SimpleStore_h
+#define SimpleStore_h
+
+#include "SimpleFileSystem.h"
+
+#ifndef EEPROMSegmentSize
+#define EEPROMSegmentSize 256	// The log rotates through EEPROM in segments of this size
+#endif
+
+#ifndef EEPROMPageSize
+#define EEPROMPageSize 32		// Writes are collected in pages of this size
+#endif
+
+// A log-structured key/value store. Every save appends a record to a log
+// that rotates through the whole EEPROM, so repeated saves of the same
+// key wear all cells evenly. An index of the keys is kept in RAM and is
+// built by Begin() in one pass over the log. The store uses no heap.
+class SimpleStore {
+public:
+	// Builds the index. Returns the number of keys, or -1 if EEPROM held
+	// no store and has been formatted
+	static int Begin();
+	// Copies the value of key to buffer and returns its length, or -1 if
+	// the key does not exist
+	static int Get(const char *key, void *buffer, int size);
+	// Sets the value of key. Returns length, or -1 if the store is full
+	static int Put(const char *key, const void *value, int length);
+	// Return's true if the key existed and was removed
+	static bool Remove(const char *key);
+	// Return's true if the key exists
+	static bool Exists(const char *key);
+	// Writes the page that Put() and Remove() collect data in to EEPROM
+	static void Flush();
+	// Removes all keys
+	static void Format();
+};
+
+#endif
@@ -21,14 +21,20 @@
 
 #include <SimpleFileSystem.h>
 #include <SimpleFile.h>
+#include <SimpleStore.h>
 
 #include <EEPROM.h>
 
 void setup() {
-	int i;
+	char data[32];
 	Serial.begin(9600);
 	while (!Serial);
 
+	// Load the file index
+	if (SimpleStore::Begin() < 0) {
+		Serial.println("Formatted EEPROM");
+	}
+
 	// Erase EEPROM
 	SimpleFileSystem::EraseEEPROM();
 	
@@ -45,22 +51,25 @@ void setup() {
 	// Load a file
 	SimpleFile fileToLoad;
 	if(SimpleFileSystem::FileExists("File2")) {
-		String data = fileToLoad.Load("File2");
-		Serial.println("Previus data: " + data);
+		fileToLoad.Load("File2", data, sizeof(data));
+		Serial.print("Previus data: ");
+		Serial.println(data);
 
 		fileToLoad.Save("Small!");
-		Serial.println("New data: " + fileToLoad.Load("File2"));
+		fileToLoad.Load("File2", data, sizeof(data));
+		Serial.print("New data: ");
+		Serial.println(data);
 	}
 
-	for (i = 0; i < 1024; i++) {
-		char value = char(EEPROM.read(i));
-		Serial.print(i);
-		Serial.print("- - - - - - - - -");
-		if (value > char(13)) {
-			Serial.print(value);
-		}
-		Serial.println();
+	// Save a setting many times; each save goes to new cells
+	for (int i = 0; i < 100; i++) {
+		SimpleStore::Put("counter", &i, sizeof(i));
+		SimpleStore::Flush();
 	}
+	int counter;
+	SimpleStore::Get("counter", &counter, sizeof(counter));
+	Serial.print("Counter: ");
+	Serial.println(counter);
 }
 
 void loop() { }
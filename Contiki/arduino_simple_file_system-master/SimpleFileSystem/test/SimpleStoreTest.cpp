@@ -0,0 +1,235 @@
+/*
+   Copyright 2013 Michael Crosson
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+// Tests SimpleStore on a PC over an emulated EEPROM that counts the
+// writes of every cell. Checks that keys survive a reboot and a write
+// that is cut short, and reports the wear and the lookup time.
+
+#include <stdio.h>
+#include <time.h>
+
+#include "SimpleFileSystem.h"
+#include "SimpleFile.h"
+#include "SimpleStore.h"
+#include "avr/eeprom.h"
+
+#define Saves 20000L
+#define Lookups 1000000L
+
+uint8_t eeprom[EEPROMSize];
+unsigned long eepromWrites[EEPROMSize];
+unsigned long eepromWriteOps;
+long eepromWriteBudget = -1;
+
+static int failures;
+
+static void Check(bool ok, const char *what) {
+	if (!ok) {
+		printf("FAIL: %s\n", what);
+		failures++;
+	}
+}
+
+static double Now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static long GetLong(const char *key) {
+	long value;
+	if (SimpleStore::Get(key, &value, sizeof(value)) != sizeof(value)) {
+		return -1;
+	}
+	return value;
+}
+
+static void PutLong(const char *key, long value) {
+	SimpleStore::Put(key, &value, sizeof(value));
+}
+
+// A blank EEPROM is formatted, and a formatted one holds no keys
+static void TestBegin() {
+	memset(eeprom, 0xff, sizeof(eeprom));
+	Check(SimpleStore::Begin() == -1, "a blank EEPROM is formatted");
+	Check(SimpleStore::Begin() == 0, "a formatted EEPROM holds no keys");
+}
+
+static void TestPutGet() {
+	char buffer[8];
+
+	SimpleStore::Format();
+	Check(SimpleStore::Get("missing", buffer, sizeof(buffer)) == -1, "a missing key is not found");
+	Check(SimpleStore::Put("", "x", 1) == -1, "an empty key is refused");
+	Check(SimpleStore::Put("a key that is too long", "x", 1) == -1, "a long key is refused");
+	Check(SimpleStore::Put("big", eeprom, EEPROMSegmentSize) == -1, "a value larger than a segment is refused");
+
+	Check(SimpleStore::Put("greeting", "hello world", 11) == 11, "put");
+	Check(SimpleStore::Get("greeting", buffer, 5) == 11 && memcmp(buffer, "hello", 5) == 0,
+		"get into a short buffer returns the full length");
+	Check(SimpleStore::Exists("greeting"), "exists");
+
+	for (int i = 1; i < MaxFiles; i++) {
+		char key[8];
+		snprintf(key, sizeof(key), "key%d", i);
+		PutLong(key, i);
+	}
+	Check(SimpleStore::Put("onemore", "x", 1) == -1, "at most MaxFiles keys");
+	Check(SimpleStore::Remove("greeting"), "remove");
+	Check(!SimpleStore::Exists("greeting") && !SimpleStore::Remove("greeting"), "a removed key is gone");
+	Check(SimpleStore::Put("onemore", "x", 1) == 1, "a removed key makes room");
+	SimpleStore::Flush();
+
+	Check(SimpleStore::Begin() == MaxFiles, "the keys are found after a reboot");
+	Check(!SimpleStore::Exists("greeting") && GetLong("key1") == 1 && GetLong("key4") == 4,
+		"the values are found after a reboot");
+}
+
+// Saving a file with the contents it already has writes nothing
+static void TestSimpleFile() {
+	char buffer[16];
+
+	SimpleStore::Format();
+	SimpleFile file("config");
+	Check(file.Save("mode=2"), "save a file");
+	unsigned long ops = eepromWriteOps;
+	Check(file.Save("mode=2") && eepromWriteOps == ops, "saving the same contents writes nothing");
+
+	SimpleStore::Begin();
+	SimpleFile loaded;
+	Check(loaded.Load("config", buffer, sizeof(buffer)) == 6 && strcmp(buffer, "mode=2") == 0,
+		"load a file after a reboot");
+	Check(loaded.Remove() && loaded.Load(buffer, sizeof(buffer)) == -1 && buffer[0] == '\0',
+		"remove a file");
+}
+
+// Power is lost after each number of cells written while a save is
+// flushed. After the reboot, the key must hold the old or the new value,
+// and the other keys must be intact.
+static void TestTornWrite() {
+	static uint8_t before[EEPROMSize];
+
+	for (long budget = 0; ; budget++) {
+		SimpleStore::Format();
+		PutLong("other", 7);
+		for (long i = 0; i < 40; i++) {
+			PutLong("counter", i);
+		}
+		SimpleStore::Flush();
+		memcpy(before, eeprom, sizeof(before));
+
+		eepromWriteBudget = budget;
+		PutLong("counter", 1000);
+		SimpleStore::Flush();
+		bool complete = eepromWriteBudget != 0;
+		eepromWriteBudget = -1;
+
+		SimpleStore::Begin();
+		long counter = GetLong("counter");
+		if ((counter != 39 && counter != 1000) || GetLong("other") != 7 ||
+				(complete && counter != 1000)) {
+			printf("FAIL: power lost after %ld cells: counter %ld, other %ld\n",
+				budget, counter, GetLong("other"));
+			failures++;
+			return;
+		}
+		if (complete) {
+			break;
+		}
+	}
+}
+
+// Saves a few keys over and over, and compares the wear with saving them
+// in place
+static void TestWear() {
+	const char *keys[] = {"counter", "uptime", "mode", "level"};
+	const int nkeys = sizeof(keys) / sizeof(keys[0]);
+	long values[nkeys];
+
+	memset(eepromWrites, 0, sizeof(eepromWrites));
+	eepromWriteOps = 0;
+	SimpleStore::Format();
+
+	for (long i = 0; i < Saves; i++) {
+		int k = i % nkeys;
+		values[k] = i;
+		PutLong(keys[k], i);
+		SimpleStore::Flush();
+
+		if (i % 997 == 0) {
+			SimpleStore::Begin();
+			for (int j = 0; j < nkeys && j <= i; j++) {
+				if (GetLong(keys[j]) != values[j]) {
+					printf("FAIL: save %ld, %s: %ld, expected %ld\n", i, keys[j], GetLong(keys[j]), values[j]);
+					failures++;
+					return;
+				}
+			}
+		}
+	}
+
+	unsigned long maxWrites = 0, total = 0;
+	for (int i = 0; i < EEPROMSize; i++) {
+		total += eepromWrites[i];
+		if (eepromWrites[i] > maxWrites) {
+			maxWrites = eepromWrites[i];
+		}
+	}
+	// In place, every cell of a value would be written on each save of its key
+	unsigned long inPlace = Saves / nkeys;
+	printf("%ld saves of %d keys: max writes per cell %lu, mean %lu, %lu in place\n",
+		Saves, nkeys, maxWrites, total / EEPROMSize, inPlace);
+	printf("  %lu write operations\n", eepromWriteOps);
+	Check(maxWrites < inPlace / 2, "the log spreads the wear");
+}
+
+static void TestLookup() {
+	SimpleStore::Format();
+	for (int i = 0; i < MaxFiles; i++) {
+		char key[8];
+		snprintf(key, sizeof(key), "key%d", i);
+		PutLong(key, i);
+	}
+	SimpleStore::Flush();
+
+	double t = Now();
+	int keys = SimpleStore::Begin();
+	t = Now() - t;
+	printf("Begin() found %d keys in %.0f ns\n", keys, t * 1e9);
+
+	long sum = 0;
+	t = Now();
+	for (long i = 0; i < Lookups; i++) {
+		char key[8] = "key0";
+		key[3] += i % MaxFiles;
+		sum += GetLong(key);
+	}
+	t = Now() - t;
+	printf("Get() %.0f ns\n", t * 1e9 / Lookups);
+	Check(sum == Lookups / MaxFiles * (MaxFiles * (MaxFiles - 1) / 2), "lookups");
+}
+
+int main() {
+	TestBegin();
+	TestPutGet();
+	TestSimpleFile();
+	TestTornWrite();
+	TestWear();
+	TestLookup();
+
+	printf("%d failures\n", failures);
+	return failures != 0;
+}
@@ -0,0 +1,63 @@
+/*
+   Copyright 2013 Michael Crosson
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+// An emulated EEPROM for the test. The cells live in eeprom[], and every
+// write of a cell is counted in eepromWrites[]. Once eepromWriteBudget
+// cells have been written, further writes are dropped, as if power had
+// been lost; a negative budget never runs out.
+
+#ifndef avr_eeprom_h
+#define avr_eeprom_h
+
+#include <stdint.h>
+#include <string.h>
+
+extern uint8_t eeprom[];
+extern unsigned long eepromWrites[];
+extern unsigned long eepromWriteOps;
+extern long eepromWriteBudget;
+
+static inline uint8_t eeprom_read_byte(const uint8_t *address) {
+	return eeprom[(uintptr_t) address];
+}
+
+static inline void eeprom_read_block(void *buffer, const void *address, size_t length) {
+	memcpy(buffer, &eeprom[(uintptr_t) address], length);
+}
+
+static inline void eeprom_write_byte(uint8_t *address, uint8_t value) {
+	if (eepromWriteBudget == 0) {
+		return;
+	}
+	if (eepromWriteBudget > 0) {
+		eepromWriteBudget--;
+	}
+	eeprom[(uintptr_t) address] = value;
+	eepromWrites[(uintptr_t) address]++;
+}
+
+// Only cells that change are written, as by avr-libc
+static inline void eeprom_update_block(const void *buffer, void *address, size_t length) {
+	eepromWriteOps++;
+	for (size_t i = 0; i < length; i++) {
+		uint8_t *cell = (uint8_t *) address + i;
+		if (eeprom[(uintptr_t) cell] != ((const uint8_t *) buffer)[i]) {
+			eeprom_write_byte(cell, ((const uint8_t *) buffer)[i]);
+		}
+	}
+}
+
+#endif
@@ -87,6 +87,7 @@ aql_clear(aql_adt_t *adt)
   adt->attribute_count = 0;
   adt->value_count = 0;
   adt->flags = 0;
+  adt->quantile = 50;
   memset(adt->aggregators, 0, sizeof(adt->aggregators));
 }
 
@@ -120,6 +121,29 @@ aql_add_attribute(aql_adt_t *adt, char *name, domain_t domain,
   return DB_OK;
 }
 
+db_result_t
+aql_set_group(aql_adt_t *adt, char *name)
+{
+  aql_attribute_t *attr;
+
+  /* A grouping attribute that is only used in the WHERE clause must 
+     be stored in the result as well. */
+  attr = get_attribute(adt, name);
+  if(attr != NULL && adt->aggregators[attr - adt->attributes] == AQL_NONE) {
+    attr->flags &= ~ATTRIBUTE_FLAG_NO_STORE;
+  } else {
+    if(DB_ERROR(aql_add_attribute(adt, name, DOMAIN_UNSPECIFIED, 0, 0))) {
+      return DB_LIMIT_ERROR;
+    }
+    attr = &adt->attributes[adt->attribute_count - 1];
+  }
+
+  adt->group_attribute = attr - adt->attributes;
+  adt->flags |= AQL_FLAG_GROUP | AQL_FLAG_AGGREGATE;
+
+  return DB_OK;
+}
+
 db_result_t
 aql_add_value(aql_adt_t *adt, domain_t domain, void *value_ptr)
 {
@@ -67,7 +67,7 @@ aql_execute(db_handle_t *handle, aql_adt_t *adt)
 {
   uint8_t optype;
   int first_rel_arg;
-  db_result_t result;
+  db_result_t result, release_result;
   relation_t *rel;
   aql_attribute_t *attr;
   attribute_t *relattr;
@@ -180,7 +180,11 @@ aql_execute(db_handle_t *handle, aql_adt_t *adt)
 
   if(rel != NULL) {
     if(handle == NULL || !(handle->flags & DB_HANDLE_FLAG_PROCESSING)) {
-      relation_release(rel);
+      /* Releasing the relation may store buffered rows. */
+      release_result = relation_release(rel);
+      if(!DB_ERROR(result) && DB_ERROR(release_result)) {
+        result = release_result;
+      }
     }
   }
 
@@ -147,6 +147,7 @@ PARSER_TOKEN(aggregator)
   case SUM:
   case MEAN:
   case MEDIAN:
+  case QUANTILE:
   case MAX:
   case MIN:
     return TOKEN;
@@ -159,6 +160,7 @@ PARSER(attributes)
 {
   token_t token;
   aql_aggregator_t function;
+  long quantile;
 
   token = PARSE_TOKEN(aggregator);
   if(token != NONE) {
@@ -175,6 +177,9 @@ PARSER(attributes)
     case MEDIAN:
       function = AQL_MEDIAN;
       break;
+    case QUANTILE:
+      function = AQL_QUANTILE;
+      break;
     case MAX:
       function = AQL_MAX;
       break;
@@ -196,6 +201,17 @@ PARSER(attributes)
     AQL_ADD_AGGREGATE(adt, function, VALUE);
     PRINTF("aggregated attribute: %s\n", VALUE);
 
+    /* QUANTILE takes the quantile in percent after the attribute. */
+    if(function == AQL_QUANTILE) {
+      CONSUME(COMMA);
+      CONSUME(INTEGER_VALUE);
+      memcpy(&quantile, VALUE, sizeof(quantile));
+      if(quantile < 0 || quantile > 100) {
+        RETURN(SYNTAX_ERROR);
+      }
+      adt->quantile = quantile;
+    }
+
     CONSUME(RIGHT_PAREN);
     goto check_more_attributes;
   } else {
@@ -502,11 +518,22 @@ PARSER(select)
     }
 
     AQL_SET_CONDITION(adt, &p);
-  } else {
+    NEXT;
+  } else if(TOKEN != GROUP) {
     REWIND;
     RETURN(OK);
   }
 
+  if(TOKEN == GROUP) {
+    CONSUME(BY);
+    CONSUME(IDENTIFIER);
+    if(DB_ERROR(AQL_SET_GROUP(adt, VALUE))) {
+      RETURN(SYNTAX_ERROR);
+    }
+  } else {
+    REWIND;
+  }
+
   CONSUME(END);
 
   return OK;
@@ -645,6 +672,9 @@ PARSER_TOKEN(index_type)
   case MEMHASH:
     type = INDEX_MEMHASH;
     break;
+  case BTREE:
+    type = INDEX_BTREE;
+    break;
   default:
     return NONE;
   };
@@ -60,7 +60,6 @@ typedef enum {
 struct attribute {
   struct attribute *next;
   void *index;
-  long aggregation_value;
   uint8_t aggregator;
   uint8_t domain;
   uint8_t element_size;
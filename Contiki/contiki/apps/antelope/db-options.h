@@ -86,6 +86,28 @@
 #define DB_MAX_ELEMENT_SIZE		16
 #endif /* DB_MAX_ELEMENT_SIZE */
 
+/* The size of the buffer that rows are read into in blocks, and of
+   the write buffer if it is enabled. Zero disables row buffering. */
+#ifndef DB_STORAGE_BUFFER_SIZE
+#define DB_STORAGE_BUFFER_SIZE		128
+#endif /* DB_STORAGE_BUFFER_SIZE */
+
+/* Append rows through a write buffer as well. This is off by default,
+   because a buffered row is in RAM only when storage_put_row() returns,
+   and a reset loses it. Rows reach the flash when the buffer is full,
+   when a query reads or counts the relation, when rows are appended to
+   another relation, when the last reference to the relation is
+   released, or when db_flush() is called. Call db_flush() after the
+   inserts that must survive a reset. */
+#ifndef DB_STORAGE_WRITE_BUFFER
+#define DB_STORAGE_WRITE_BUFFER		0
+#endif /* DB_STORAGE_WRITE_BUFFER */
+
+#if DB_STORAGE_BUFFER_SIZE == 0
+#undef DB_STORAGE_WRITE_BUFFER
+#define DB_STORAGE_WRITE_BUFFER		0
+#endif
+
 
 #ifndef DB_VM_BYTECODE_SIZE
 #define DB_VM_BYTECODE_SIZE		128
@@ -108,6 +130,18 @@
 #define AQL_ATTRIBUTE_LIMIT    		5
 #endif /* AQL_ATTRIBUTE_LIMIT */
 
+/* The number of distinct groups that a GROUP BY query can produce. */
+#ifndef AQL_GROUP_LIMIT
+#define AQL_GROUP_LIMIT    		8
+#endif /* AQL_GROUP_LIMIT */
+
+/* The number of values in the sketch that approximates the MEDIAN and
+   QUANTILE aggregators. They are exact for up to this many rows. Must
+   be at least 8. */
+#ifndef AQL_MEDIAN_SAMPLES
+#define AQL_MEDIAN_SAMPLES    		64
+#endif /* AQL_MEDIAN_SAMPLES */
+
 
 /* Physical storage options. Changing these may cause compatibility problems. */
 #ifndef DB_COFFEE_RESERVE_SIZE
@@ -159,6 +193,42 @@
 #define DB_HEAP_CACHE_LIMIT		1
 #endif /* DB_HEAP_CACHE_LIMIT */
 
+/* The maximum number of B+-tree indexes that can be loaded at once. */
+#ifndef DB_BTREE_INDEX_LIMIT
+#define DB_BTREE_INDEX_LIMIT		1
+#endif /* DB_BTREE_INDEX_LIMIT */
+
+/* The number of B+-tree nodes that are cached in RAM. */
+#ifndef DB_BTREE_CACHE_LIMIT
+#define DB_BTREE_CACHE_LIMIT		2
+#endif /* DB_BTREE_CACHE_LIMIT */
+
+/* The size of a B+-tree node in bytes; at most 2048. */
+#ifndef DB_BTREE_NODE_SIZE
+#define DB_BTREE_NODE_SIZE		256
+#endif /* DB_BTREE_NODE_SIZE */
+
+/* The number of nodes that are reserved for a B+-tree file. When they
+   run out, the tree is compacted into a new file, which needs space
+   for a second file of this size while it is written. */
+#ifndef DB_BTREE_NODE_LIMIT
+#define DB_BTREE_NODE_LIMIT		1024
+#endif /* DB_BTREE_NODE_LIMIT */
+
+#ifndef DB_BTREE_MAX_DEPTH
+#define DB_BTREE_MAX_DEPTH		8
+#endif /* DB_BTREE_MAX_DEPTH */
+
+/* The amount of RAM in bytes for the rows of a hash join. A larger
+   build relation is joined in several passes over the other one. */
+#ifndef DB_JOIN_MEMORY
+#define DB_JOIN_MEMORY			1024
+#endif /* DB_JOIN_MEMORY */
+
+#ifndef DB_JOIN_HASH_BUCKETS
+#define DB_JOIN_HASH_BUCKETS		31
+#endif /* DB_JOIN_HASH_BUCKETS */
+
 
 /* Propositional Logic Engine options. */
 #ifndef PLE_MAX_NAME_LENGTH
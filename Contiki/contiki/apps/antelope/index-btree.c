@@ -0,0 +1,1062 @@
+/*
+ * Copyright (c) 2014, Contiki-Sensor-Node contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *	A B+-tree for data indexing over flash memory.
+ *
+ *     The tree is stored in a single file that is divided into fixed-size
+ *     nodes. Like the buckets of the max-heap index, a node is only ever
+ *     appended to: entries are written sequentially into the unused part
+ *     of the node, so a node never has to be rewritten in place.
+ *
+ *     Each entry is keyed by the pair (key, tuple id), which makes all
+ *     keys in the tree unique even if the attribute has duplicate values.
+ *     A branch entry states that its child covers the keys from its own
+ *     key up to the next larger key in the same branch. When a node fills
+ *     up, its live entries are copied into two new nodes, and entries for
+ *     these nodes are appended to the parent. The new entry for the lower
+ *     half has the same key as the entry of the old node, and supersedes
+ *     it because it is located later in the parent. If the new key is
+ *     larger than all keys in a full node, only a new node for the key is
+ *     created, and the old node remains in use. Hence, keys that are
+ *     inserted in ascending order produce full nodes.
+ *
+ *     Node 0 holds an append-only log of root node numbers, in which
+ *     the last entry is the current root.
+ *
+ *     Superseded nodes are not reused. When the file runs out of nodes
+ *     or the root log is full, the live tree is compacted: its leaves
+ *     are read in key order and written to a new file from the bottom
+ *     up, with room left in every node for later inserts. The index
+ *     catalog is then pointed to the new file, and the old file is
+ *     removed.
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cfs/cfs.h"
+#include "lib/memb.h"
+
+#include "db-options.h"
+#include "index.h"
+#include "result.h"
+#include "storage.h"
+
+#define DEBUG DEBUG_NONE
+#include "net/uip-debug.h"
+
+typedef int32_t btree_key_t;
+typedef uint16_t btree_page_t;
+
+#define KEY_MIN		INT32_MIN
+#define KEY_MAX		INT32_MAX
+
+#define NODE_SIZE	DB_BTREE_NODE_SIZE
+#define ROOT_SLOTS	(NODE_SIZE / sizeof(btree_page_t))
+
+/* The share of the entries that a compaction fills in each node. */
+#define LEAF_FILL	(LEAF_CAPACITY * 3 / 4)
+#define BRANCH_FILL	(BRANCH_CAPACITY * 3 / 4)
+
+#define NODE_FREE	0
+#define NODE_LEAF	1
+#define NODE_BRANCH	2
+
+/*
+ * The value of a leaf entry is the tuple ID plus one, so that an
+ * unused entry can be recognized by its zero value. The key and value
+ * of a branch entry is the smallest (key, value) pair that its child
+ * node may contain.
+ */
+struct leaf_entry {
+  btree_key_t key;
+  tuple_id_t value;
+};
+
+struct branch_entry {
+  btree_key_t key;
+  tuple_id_t value;
+  btree_page_t child;
+  uint16_t unused;
+};
+
+struct node_header {
+  uint8_t type;
+  uint8_t unused[3];
+};
+
+#define LEAF_CAPACITY	((NODE_SIZE - sizeof(struct node_header)) / \
+			 sizeof(struct leaf_entry))
+#define BRANCH_CAPACITY	((NODE_SIZE - sizeof(struct node_header)) / \
+			 sizeof(struct branch_entry))
+
+#define ENTRY_OFFSET(page, size, i)				\
+  ((unsigned long)(page) * NODE_SIZE + sizeof(struct node_header) + \
+   (unsigned long)(i) * (size))
+
+struct node {
+  struct node_header header;
+  union {
+    struct leaf_entry leaf[LEAF_CAPACITY];
+    struct branch_entry branch[BRANCH_CAPACITY];
+  } u;
+};
+
+struct btree {
+  db_storage_id_t fd;
+  btree_page_t root;
+  btree_page_t next_page;
+  uint16_t next_root_slot;
+  uint8_t exhausted;
+};
+typedef struct btree btree_t;
+
+struct node_cache {
+  btree_t *tree;
+  btree_page_t page;
+  uint8_t count;
+  uint16_t last_use;
+  struct node node;
+};
+
+/* The nodes visited on the way from the root to a leaf. */
+struct path {
+  uint8_t depth;
+  btree_page_t page[DB_BTREE_MAX_DEPTH];
+  struct leaf_entry lower[DB_BTREE_MAX_DEPTH];
+  struct leaf_entry upper;
+  uint8_t has_upper;
+};
+
+/* Storage for the live entries of a node that is being split. */
+static union {
+  struct leaf_entry leaf[LEAF_CAPACITY + 1];
+  struct branch_entry branch[BRANCH_CAPACITY + 2];
+  btree_page_t roots[ROOT_SLOTS];
+} scratch;
+
+static struct node_cache node_cache[DB_BTREE_CACHE_LIMIT];
+static uint16_t cache_clock;
+MEMB(btrees, btree_t, DB_BTREE_INDEX_LIMIT);
+
+static db_result_t create(index_t *);
+static db_result_t destroy(index_t *);
+static db_result_t load(index_t *);
+static db_result_t release(index_t *);
+static db_result_t insert(index_t *, attribute_value_t *, tuple_id_t);
+static db_result_t delete(index_t *, attribute_value_t *);
+static tuple_id_t get_next(index_iterator_t *);
+
+index_api_t index_btree = {
+  INDEX_BTREE,
+  INDEX_API_EXTERNAL | INDEX_API_RANGE_QUERIES,
+  create,
+  destroy,
+  load,
+  release,
+  insert,
+  delete,
+  get_next
+};
+
+static int
+compare(btree_key_t key1, tuple_id_t value1,
+	btree_key_t key2, tuple_id_t value2)
+{
+  if(key1 != key2) {
+    return key1 < key2 ? -1 : 1;
+  }
+  if(value1 != value2) {
+    return value1 < value2 ? -1 : 1;
+  }
+  return 0;
+}
+
+#define ENTRY_COMPARE(a, b)	compare((a)->key, (a)->value, (b)->key, (b)->value)
+
+static void
+sort_leaf_entries(struct leaf_entry *entries, int count)
+{
+  struct leaf_entry tmp;
+  int i, j;
+
+  for(i = 1; i < count; i++) {
+    tmp = entries[i];
+    for(j = i; j > 0 && ENTRY_COMPARE(&entries[j - 1], &tmp) > 0; j--) {
+      entries[j] = entries[j - 1];
+    }
+    entries[j] = tmp;
+  }
+}
+
+static void
+sort_branch_entries(struct branch_entry *entries, int count)
+{
+  struct branch_entry tmp;
+  int i, j;
+
+  for(i = 1; i < count; i++) {
+    tmp = entries[i];
+    for(j = i; j > 0 && ENTRY_COMPARE(&entries[j - 1], &tmp) > 0; j--) {
+      entries[j] = entries[j - 1];
+    }
+    entries[j] = tmp;
+  }
+}
+
+static void
+invalidate_cache(btree_t *tree)
+{
+  int i;
+
+  for(i = 0; i < DB_BTREE_CACHE_LIMIT; i++) {
+    if(node_cache[i].tree == tree) {
+      node_cache[i].tree = NULL;
+    }
+  }
+}
+
+static struct node_cache *
+node_load(btree_t *tree, btree_page_t page)
+{
+  struct node_cache *cache;
+  int i;
+
+  cache = &node_cache[0];
+  for(i = 0; i < DB_BTREE_CACHE_LIMIT; i++) {
+    if(node_cache[i].tree == tree && node_cache[i].page == page) {
+      node_cache[i].last_use = ++cache_clock;
+      return &node_cache[i];
+    }
+    if(node_cache[i].tree == NULL) {
+      cache = &node_cache[i];
+    } else if(cache->tree != NULL &&
+              (uint16_t)(cache_clock - node_cache[i].last_use) >
+              (uint16_t)(cache_clock - cache->last_use)) {
+      cache = &node_cache[i];
+    }
+  }
+
+  cache->tree = NULL;
+  if(DB_ERROR(storage_read(tree->fd, &cache->node,
+                           (unsigned long)page * NODE_SIZE,
+                           sizeof(cache->node)))) {
+    PRINTF("DB: Failed to read B+-tree node %u\n", (unsigned)page);
+    return NULL;
+  }
+
+  if(cache->node.header.type == NODE_LEAF) {
+    for(i = 0; i < LEAF_CAPACITY; i++) {
+      if(cache->node.u.leaf[i].value == 0) {
+        break;
+      }
+    }
+  } else if(cache->node.header.type == NODE_BRANCH) {
+    for(i = 0; i < BRANCH_CAPACITY; i++) {
+      if(cache->node.u.branch[i].child == 0) {
+        break;
+      }
+    }
+  } else {
+    PRINTF("DB: Invalid B+-tree node %u\n", (unsigned)page);
+    return NULL;
+  }
+
+  cache->tree = tree;
+  cache->page = page;
+  cache->count = i;
+  cache->last_use = ++cache_clock;
+
+  return cache;
+}
+
+static int
+node_append(btree_t *tree, struct node_cache *cache,
+            void *entries, unsigned size, unsigned count)
+{
+  char *dst;
+
+  if(DB_ERROR(storage_write(tree->fd, entries,
+                            ENTRY_OFFSET(cache->page, size, cache->count),
+                            size * count))) {
+    return 0;
+  }
+
+  dst = (char *)&cache->node.u + (unsigned)cache->count * size;
+  memcpy(dst, entries, size * count);
+  cache->count += count;
+
+  return 1;
+}
+
+static int
+node_create(btree_t *tree, uint8_t type, void *entries,
+            unsigned size, unsigned count)
+{
+  struct node_header header;
+  btree_page_t page;
+
+  if(tree->next_page >= DB_BTREE_NODE_LIMIT) {
+    PRINTF("DB: No more B+-tree nodes available\n");
+    tree->exhausted = 1;
+    return 0;
+  }
+  page = tree->next_page++;
+
+  memset(&header, 0, sizeof(header));
+  header.type = type;
+
+  if(DB_ERROR(storage_write(tree->fd, &header,
+                            (unsigned long)page * NODE_SIZE, sizeof(header))) ||
+     DB_ERROR(storage_write(tree->fd, entries, ENTRY_OFFSET(page, size, 0),
+                            size * count))) {
+    return 0;
+  }
+
+  return page;
+}
+
+static int
+set_root(btree_t *tree, btree_page_t page)
+{
+  if(tree->next_root_slot >= ROOT_SLOTS) {
+    PRINTF("DB: The B+-tree root log is full\n");
+    tree->exhausted = 1;
+    return 0;
+  }
+
+  if(DB_ERROR(storage_write(tree->fd, &page,
+                            tree->next_root_slot * sizeof(page),
+                            sizeof(page)))) {
+    return 0;
+  }
+
+  tree->next_root_slot++;
+  tree->root = page;
+
+  return 1;
+}
+
+/*
+ * Find the leaf that covers the pair (key, value), and record the
+ * nodes on the way together with the ranges that they cover.
+ */
+static struct node_cache *
+descend(btree_t *tree, btree_key_t key, tuple_id_t value, struct path *path)
+{
+  struct node_cache *cache;
+  struct branch_entry *entry;
+  struct branch_entry *best;
+  btree_page_t page;
+  int i;
+
+  path->depth = 0;
+  path->has_upper = 0;
+  page = tree->root;
+
+  for(;;) {
+    if(path->depth == DB_BTREE_MAX_DEPTH) {
+      PRINTF("DB: The B+-tree is too deep\n");
+      return NULL;
+    }
+
+    cache = node_load(tree, page);
+    if(cache == NULL) {
+      return NULL;
+    }
+
+    path->page[path->depth] = page;
+    if(path->depth == 0) {
+      path->lower[0].key = KEY_MIN;
+      path->lower[0].value = 0;
+    }
+
+    if(cache->node.header.type == NODE_LEAF) {
+      path->depth++;
+      return cache;
+    }
+
+    /*
+     * Select the entry with the largest key that is smaller than or
+     * equal to the search key. Later entries supersede earlier entries
+     * with the same key.
+     */
+    best = NULL;
+    for(i = 0; i < cache->count; i++) {
+      entry = &cache->node.u.branch[i];
+      if(compare(entry->key, entry->value, key, value) <= 0) {
+        if(best == NULL || ENTRY_COMPARE(entry, best) >= 0) {
+          best = entry;
+        }
+      } else if(!path->has_upper ||
+                compare(entry->key, entry->value,
+                        path->upper.key, path->upper.value) < 0) {
+        path->upper.key = entry->key;
+        path->upper.value = entry->value;
+        path->has_upper = 1;
+      }
+    }
+
+    if(best == NULL) {
+      PRINTF("DB: B+-tree node %u does not cover the key %ld\n",
+             (unsigned)page, (long)key);
+      return NULL;
+    }
+
+    path->depth++;
+    path->lower[path->depth].key = best->key;
+    path->lower[path->depth].value = best->value;
+    page = best->child;
+  }
+}
+
+/*
+ * Add entries for new child nodes to the parent of the node at the
+ * given depth in the path, and split the parent if it is full.
+ */
+static int
+insert_into_parent(btree_t *tree, struct path *path, int depth,
+                   struct branch_entry *entries, int count)
+{
+  struct node_cache *cache;
+  struct branch_entry split[2];
+  btree_page_t old_page;
+  btree_page_t page;
+  int i, j, live;
+
+  if(depth == 0) {
+    /*
+     * The entries cover the whole key space. A single entry replaces
+     * the root, whereas two entries make the tree grow by one level.
+     */
+    if(count == 1) {
+      return set_root(tree, entries[0].child);
+    }
+    page = node_create(tree, NODE_BRANCH, entries, sizeof(entries[0]), count);
+    return page != 0 && set_root(tree, page);
+  }
+
+  old_page = path->page[depth - 1];
+  cache = node_load(tree, old_page);
+  if(cache == NULL) {
+    return 0;
+  }
+
+  if(cache->count + count <= BRANCH_CAPACITY) {
+    return node_append(tree, cache, entries, sizeof(entries[0]), count);
+  }
+
+  /* Collect the live entries of the full node and the new entries. */
+  memcpy(scratch.branch, cache->node.u.branch,
+         cache->count * sizeof(scratch.branch[0]));
+  memcpy(&scratch.branch[cache->count], entries, count * sizeof(entries[0]));
+  count += cache->count;
+
+  for(i = live = 0; i < count; i++) {
+    for(j = i + 1; j < count; j++) {
+      if(ENTRY_COMPARE(&scratch.branch[i], &scratch.branch[j]) == 0) {
+        break;
+      }
+    }
+    if(j == count) {
+      scratch.branch[live++] = scratch.branch[i];
+    }
+  }
+
+  memset(split, 0, sizeof(split));
+
+  if(count == cache->count + 1 && live == count) {
+    for(i = 0; i < live - 1; i++) {
+      if(ENTRY_COMPARE(&scratch.branch[i], &scratch.branch[live - 1]) > 0) {
+        break;
+      }
+    }
+    if(i == live - 1) {
+      /* Only a larger entry was added: keep the full node in use. */
+      page = node_create(tree, NODE_BRANCH, &scratch.branch[live - 1],
+                         sizeof(scratch.branch[0]), 1);
+      if(page == 0) {
+        return 0;
+      }
+      split[0].key = path->lower[depth - 1].key;
+      split[0].value = path->lower[depth - 1].value;
+      split[0].child = old_page;
+      split[1].key = scratch.branch[live - 1].key;
+      split[1].value = scratch.branch[live - 1].value;
+      split[1].child = page;
+      if(depth - 1 == 0) {
+        return insert_into_parent(tree, path, depth - 1, split, 2);
+      }
+      return insert_into_parent(tree, path, depth - 1, &split[1], 1);
+    }
+  }
+
+  sort_branch_entries(scratch.branch, live);
+
+  if(live < BRANCH_CAPACITY) {
+    /* Superseded entries were dropped, so the node fits in one copy. */
+    page = node_create(tree, NODE_BRANCH, scratch.branch,
+                       sizeof(scratch.branch[0]), live);
+    if(page == 0) {
+      return 0;
+    }
+    split[0].key = path->lower[depth - 1].key;
+    split[0].value = path->lower[depth - 1].value;
+    split[0].child = page;
+    return insert_into_parent(tree, path, depth - 1, split, 1);
+  }
+
+  PRINTF("DB: Split B+-tree branch %u\n", (unsigned)old_page);
+
+  split[0].key = path->lower[depth - 1].key;
+  split[0].value = path->lower[depth - 1].value;
+  split[0].child = node_create(tree, NODE_BRANCH, scratch.branch,
+                               sizeof(scratch.branch[0]), live / 2);
+  split[1].key = scratch.branch[live / 2].key;
+  split[1].value = scratch.branch[live / 2].value;
+  split[1].child = node_create(tree, NODE_BRANCH,
+                               &scratch.branch[live / 2],
+                               sizeof(scratch.branch[0]), live - live / 2);
+  if(split[0].child == 0 || split[1].child == 0) {
+    return 0;
+  }
+
+  return insert_into_parent(tree, path, depth - 1, split, 2);
+}
+
+static int
+split_leaf(btree_t *tree, struct path *path, struct node_cache *cache,
+           struct leaf_entry *entry)
+{
+  struct branch_entry split[2];
+  btree_page_t old_page;
+  int count;
+  int i;
+
+  old_page = cache->page;
+  count = cache->count;
+
+  memset(split, 0, sizeof(split));
+  split[0].key = path->lower[path->depth - 1].key;
+  split[0].value = path->lower[path->depth - 1].value;
+
+  for(i = 0; i < count; i++) {
+    if(ENTRY_COMPARE(&cache->node.u.leaf[i], entry) > 0) {
+      break;
+    }
+  }
+
+  if(i == count) {
+    /* The new key is the largest in the leaf: keep the full leaf in use. */
+    split[0].child = old_page;
+    split[1].key = entry->key;
+    split[1].value = entry->value;
+    split[1].child = node_create(tree, NODE_LEAF, entry, sizeof(*entry), 1);
+    if(split[1].child == 0) {
+      return 0;
+    }
+    if(path->depth == 1) {
+      return insert_into_parent(tree, path, path->depth - 1, split, 2);
+    }
+    return insert_into_parent(tree, path, path->depth - 1, &split[1], 1);
+  }
+
+  PRINTF("DB: Split B+-tree leaf %u\n", (unsigned)old_page);
+
+  memcpy(scratch.leaf, cache->node.u.leaf, count * sizeof(scratch.leaf[0]));
+  scratch.leaf[count++] = *entry;
+  sort_leaf_entries(scratch.leaf, count);
+
+  split[0].child = node_create(tree, NODE_LEAF, scratch.leaf,
+                               sizeof(scratch.leaf[0]), count / 2);
+  split[1].key = scratch.leaf[count / 2].key;
+  split[1].value = scratch.leaf[count / 2].value;
+  split[1].child = node_create(tree, NODE_LEAF, &scratch.leaf[count / 2],
+                               sizeof(scratch.leaf[0]), count - count / 2);
+  if(split[0].child == 0 || split[1].child == 0) {
+    return 0;
+  }
+
+  return insert_into_parent(tree, path, path->depth - 1, split, 2);
+}
+
+static int
+insert_item(btree_t *tree, btree_key_t key, tuple_id_t value)
+{
+  struct path path;
+  struct node_cache *cache;
+  struct leaf_entry entry;
+
+  entry.key = key;
+  entry.value = value + 1;
+  tree->exhausted = 0;
+
+  cache = descend(tree, entry.key, entry.value, &path);
+  if(cache == NULL) {
+    return 0;
+  }
+
+  if(cache->count < LEAF_CAPACITY) {
+    return node_append(tree, cache, &entry, sizeof(entry), 1);
+  }
+
+  if(split_leaf(tree, &path, cache, &entry) == 0) {
+    /* The cached nodes may no longer match the file. */
+    invalidate_cache(tree);
+    return 0;
+  }
+
+  return 1;
+}
+
+/*
+ * Append entries to the node that is being filled at a level of a
+ * tree that is built from the bottom up. A new node at a level gets
+ * an entry in the level above it, which is created when the level gets
+ * its second node.
+ */
+static int
+build_append(btree_t *tree, btree_page_t *pages, uint8_t *counts,
+             uint8_t *height, int level, void *entries, unsigned count)
+{
+  struct branch_entry parent[2];
+  struct leaf_entry *first;
+  unsigned size, fill, n;
+  btree_page_t page;
+
+  if(level >= DB_BTREE_MAX_DEPTH) {
+    PRINTF("DB: The compacted B+-tree is too deep\n");
+    return 0;
+  }
+
+  size = level == 0 ? sizeof(struct leaf_entry) : sizeof(struct branch_entry);
+  fill = level == 0 ? LEAF_FILL : BRANCH_FILL;
+
+  while(count > 0) {
+    if(level < *height && counts[level] < fill) {
+      n = fill - counts[level];
+      if(n > count) {
+        n = count;
+      }
+      if(DB_ERROR(storage_write(tree->fd, entries,
+                                ENTRY_OFFSET(pages[level], size,
+                                             counts[level]),
+                                size * n))) {
+        return 0;
+      }
+    } else {
+      n = count > fill ? fill : count;
+      page = node_create(tree, level == 0 ? NODE_LEAF : NODE_BRANCH,
+                         entries, size, n);
+      if(page == 0) {
+        return 0;
+      }
+      if(level < *height) {
+        /* Both leaf and branch entries begin with the key pair. */
+        first = entries;
+        memset(parent, 0, sizeof(parent));
+        parent[0].key = KEY_MIN;
+        parent[0].child = pages[level];
+        parent[1].key = first->key;
+        parent[1].value = first->value;
+        parent[1].child = page;
+        if(level + 1 == *height) {
+          if(!build_append(tree, pages, counts, height, level + 1,
+                           parent, 2)) {
+            return 0;
+          }
+        } else if(!build_append(tree, pages, counts, height, level + 1,
+                                &parent[1], 1)) {
+          return 0;
+        }
+      } else {
+        *height = level + 1;
+      }
+      pages[level] = page;
+      counts[level] = 0;
+    }
+    counts[level] += n;
+    entries = (char *)entries + size * n;
+    count -= n;
+  }
+
+  return 1;
+}
+
+/* Write the live entries of one tree into another, empty tree. */
+static int
+copy_tree(btree_t *from, btree_t *to)
+{
+  btree_page_t pages[DB_BTREE_MAX_DEPTH];
+  uint8_t counts[DB_BTREE_MAX_DEPTH];
+  uint8_t height;
+  struct path path;
+  struct node_cache *cache;
+  struct leaf_entry upper;
+  struct node_header header;
+  int count;
+
+  height = 0;
+  upper.key = KEY_MIN;
+  upper.value = 0;
+
+  for(;;) {
+    cache = descend(from, upper.key, upper.value, &path);
+    if(cache == NULL) {
+      return 0;
+    }
+
+    count = cache->count;
+    memcpy(scratch.leaf, cache->node.u.leaf, count * sizeof(scratch.leaf[0]));
+    sort_leaf_entries(scratch.leaf, count);
+    if(!build_append(to, pages, counts, &height, 0, scratch.leaf, count)) {
+      return 0;
+    }
+
+    if(!path.has_upper) {
+      break;
+    }
+    upper = path.upper;
+  }
+
+  if(height == 0) {
+    /* The tree is empty. */
+    memset(&header, 0, sizeof(header));
+    header.type = NODE_LEAF;
+    if(DB_ERROR(storage_write(to->fd, &header,
+                              (unsigned long)to->next_page * NODE_SIZE,
+                              sizeof(header)))) {
+      return 0;
+    }
+    return set_root(to, to->next_page++);
+  }
+
+  return set_root(to, pages[height - 1]);
+}
+
+/* Move the live tree of an index into a new file. */
+static int
+compact(index_t *index)
+{
+  btree_t *tree;
+  btree_t new_tree;
+  char *filename;
+  char old_file[DB_MAX_FILENAME_LENGTH];
+
+  tree = (btree_t *)index->opaque_data;
+
+  PRINTF("DB: Compacting the B+-tree in %s, %u nodes used\n",
+         index->descriptor_file, (unsigned)tree->next_page);
+
+  filename = storage_generate_file("btree",
+                                   (unsigned long)DB_BTREE_NODE_LIMIT * NODE_SIZE);
+  if(filename == NULL) {
+    PRINTF("DB: No space for a compacted B+-tree\n");
+    return 0;
+  }
+  memcpy(old_file, index->descriptor_file, sizeof(old_file));
+  memcpy(index->descriptor_file, filename, sizeof(index->descriptor_file));
+
+  new_tree.fd = storage_open(index->descriptor_file);
+  new_tree.next_page = 1;
+  new_tree.next_root_slot = 0;
+  new_tree.exhausted = 0;
+
+  /* The catalog refers to the new file only when it is complete. */
+  if(new_tree.fd < 0 || copy_tree(tree, &new_tree) == 0 ||
+     DB_ERROR(storage_put_index(index))) {
+    PRINTF("DB: Failed to compact the B+-tree\n");
+    storage_close(new_tree.fd);
+    cfs_remove(index->descriptor_file);
+    memcpy(index->descriptor_file, old_file, sizeof(index->descriptor_file));
+    invalidate_cache(tree);
+    return 0;
+  }
+
+  invalidate_cache(tree);
+  storage_close(tree->fd);
+  cfs_remove(old_file);
+
+  tree->fd = new_tree.fd;
+  tree->root = new_tree.root;
+  tree->next_page = new_tree.next_page;
+  tree->next_root_slot = new_tree.next_root_slot;
+  storage_stats.compactions++;
+
+  PRINTF("DB: Compacted the B+-tree into %s, %u nodes used\n",
+         index->descriptor_file, (unsigned)tree->next_page);
+
+  return 1;
+}
+
+static db_result_t
+create(index_t *index)
+{
+  char *filename;
+  db_result_t result;
+  btree_t *tree;
+  struct node_header header;
+  btree_page_t root;
+
+  if(index->attr->domain != DOMAIN_INT && index->attr->domain != DOMAIN_LONG) {
+    PRINTF("DB: B+-tree indexes support only integer attributes\n");
+    return DB_INDEX_ERROR;
+  }
+
+  filename = storage_generate_file("btree",
+                                   (unsigned long)DB_BTREE_NODE_LIMIT * NODE_SIZE);
+  if(filename == NULL) {
+    PRINTF("DB: Failed to generate a B+-tree file\n");
+    return DB_INDEX_ERROR;
+  }
+
+  memcpy(index->descriptor_file, filename, sizeof(index->descriptor_file));
+
+  PRINTF("DB: Generated the B+-tree file \"%s\" using %lu bytes of space\n",
+	 index->descriptor_file,
+         (unsigned long)DB_BTREE_NODE_LIMIT * NODE_SIZE);
+
+  index->opaque_data = tree = memb_alloc(&btrees);
+  if(tree == NULL) {
+    PRINTF("DB: Failed to allocate a B+-tree\n");
+    result = DB_ALLOCATION_ERROR;
+    goto end;
+  }
+
+  tree->fd = storage_open(index->descriptor_file);
+  if(tree->fd < 0) {
+    result = DB_STORAGE_ERROR;
+    goto end;
+  }
+
+  /* Begin with an empty leaf as the root. */
+  root = 1;
+  memset(&header, 0, sizeof(header));
+  header.type = NODE_LEAF;
+  tree->next_root_slot = 0;
+  tree->next_page = root + 1;
+  tree->exhausted = 0;
+
+  if(DB_ERROR(storage_write(tree->fd, &header,
+                            (unsigned long)root * NODE_SIZE,
+                            sizeof(header))) ||
+     set_root(tree, root) == 0) {
+    result = DB_STORAGE_ERROR;
+    goto end;
+  }
+
+  PRINTF("DB: Created a B+-tree index\n");
+  result = DB_OK;
+
+ end:
+  if(result != DB_OK) {
+    if(tree != NULL) {
+      storage_close(tree->fd);
+      memb_free(&btrees, tree);
+      index->opaque_data = NULL;
+    }
+    cfs_remove(index->descriptor_file);
+    index->descriptor_file[0] = '\0';
+  }
+  return result;
+}
+
+static db_result_t
+destroy(index_t *index)
+{
+  if(index->opaque_data != NULL) {
+    release(index);
+  }
+  cfs_remove(index->descriptor_file);
+  return DB_OK;
+}
+
+static db_result_t
+load(index_t *index)
+{
+  btree_t *tree;
+  struct node_header header;
+  unsigned low, high, middle;
+  int i;
+
+  index->opaque_data = tree = memb_alloc(&btrees);
+  if(tree == NULL) {
+    PRINTF("DB: Failed to allocate a B+-tree\n");
+    return DB_ALLOCATION_ERROR;
+  }
+
+  tree->fd = storage_open(index->descriptor_file);
+  if(tree->fd < 0 ||
+     DB_ERROR(storage_read(tree->fd, scratch.roots, 0, sizeof(scratch.roots)))) {
+    storage_close(tree->fd);
+    memb_free(&btrees, tree);
+    index->opaque_data = NULL;
+    return DB_STORAGE_ERROR;
+  }
+
+  /* The last entry in the root log is the current root. */
+  for(i = 0; i < ROOT_SLOTS && scratch.roots[i] != 0; i++) {
+    tree->root = scratch.roots[i];
+  }
+  tree->next_root_slot = i;
+  tree->exhausted = 0;
+
+  /* Nodes are allocated in order, so the first free node can be found
+     with a binary search. */
+  for(low = tree->root, high = DB_BTREE_NODE_LIMIT; low + 1 < high;) {
+    middle = low + (high - low) / 2;
+    if(DB_ERROR(storage_read(tree->fd, &header,
+                             (unsigned long)middle * NODE_SIZE,
+                             sizeof(header))) ||
+       header.type == NODE_FREE) {
+      high = middle;
+    } else {
+      low = middle;
+    }
+  }
+  tree->next_page = high;
+
+  PRINTF("DB: Loaded B+-tree index from file %s with root %u and %u nodes\n",
+	 index->descriptor_file, (unsigned)tree->root,
+         (unsigned)tree->next_page);
+
+  return DB_OK;
+}
+
+static db_result_t
+release(index_t *index)
+{
+  btree_t *tree;
+
+  tree = index->opaque_data;
+
+  invalidate_cache(tree);
+  storage_close(tree->fd);
+  memb_free(&btrees, tree);
+  index->opaque_data = NULL;
+  return DB_OK;
+}
+
+static db_result_t
+insert(index_t *index, attribute_value_t *key, tuple_id_t value)
+{
+  btree_t *tree;
+  long long_key;
+
+  tree = (btree_t *)index->opaque_data;
+
+  long_key = db_value_to_long(key);
+
+  if(insert_item(tree, (btree_key_t)long_key, value) == 0 &&
+     (!tree->exhausted || compact(index) == 0 ||
+      insert_item(tree, (btree_key_t)long_key, value) == 0)) {
+    PRINTF("DB: Failed to insert key %ld into a B+-tree index\n", long_key);
+    return DB_INDEX_ERROR;
+  }
+  return DB_OK;
+}
+
+static db_result_t
+delete(index_t *index, attribute_value_t *value)
+{
+  return DB_INDEX_ERROR;
+}
+
+static tuple_id_t
+get_next(index_iterator_t *iterator)
+{
+  struct iteration_cache {
+    index_iterator_t *index_iterator;
+    btree_key_t min;
+    btree_key_t max;
+    btree_page_t leaf;
+    uint8_t start;
+    uint8_t has_upper;
+    struct leaf_entry upper;
+  };
+  static struct iteration_cache cache;
+  struct path path;
+  struct node_cache *node;
+  struct leaf_entry *entry;
+  btree_t *tree;
+
+  tree = (btree_t *)iterator->index->opaque_data;
+
+  if(cache.index_iterator != iterator || iterator->next_item_no == 0) {
+    /* Initialize the cache for a new search. */
+    cache.index_iterator = iterator;
+    cache.min = (btree_key_t)db_value_to_long(&iterator->min_value);
+    cache.max = (btree_key_t)db_value_to_long(&iterator->max_value);
+
+    node = descend(tree, cache.min, 0, &path);
+    if(node == NULL) {
+      return INVALID_TUPLE;
+    }
+    cache.leaf = node->page;
+    cache.start = 0;
+    cache.has_upper = path.has_upper;
+    cache.upper = path.upper;
+  }
+
+  for(;;) {
+    node = node_load(tree, cache.leaf);
+    if(node == NULL) {
+      return INVALID_TUPLE;
+    }
+
+    /* The entries of a leaf are unsorted, so all of them are compared. */
+    while(cache.start < node->count) {
+      entry = &node->node.u.leaf[cache.start++];
+      if(entry->key >= cache.min && entry->key <= cache.max) {
+        iterator->next_item_no++;
+        PRINTF("DB: Found key %ld with value %lu\n", (long)entry->key,
+               (unsigned long)entry->value - 1);
+        return entry->value - 1;
+      }
+    }
+
+    /* Continue with the leaf that covers the following keys. */
+    if(!cache.has_upper || cache.upper.key > cache.max) {
+      return INVALID_TUPLE;
+    }
+
+    node = descend(tree, cache.upper.key, cache.upper.value, &path);
+    if(node == NULL) {
+      return INVALID_TUPLE;
+    }
+    cache.leaf = node->page;
+    cache.start = 0;
+    cache.has_upper = path.has_upper;
+    cache.upper = path.upper;
+  }
+}
@@ -637,7 +637,7 @@ release(index_t *index)
   storage_close(heap->bucket_storage);
   storage_close(heap->heap_storage);
   memb_free(&heaps, index->opaque_data);
-  return DB_INDEX_ERROR;
+  return DB_OK;
 }
 
 static db_result_t
@@ -733,6 +733,7 @@ get_next(index_iterator_t *iterator)
         }
       }
     }
+    cache.start = 0;
   }
 
   if(VALUE_INT(&iterator->min_value) == VALUE_INT(&iterator->max_value)) {
@@ -64,6 +64,14 @@
 #define LVM_USE_FLOATS			0
 #endif
 
+#ifndef LVM_MAX_INSTRUCTIONS
+#define LVM_MAX_INSTRUCTIONS		16
+#endif
+
+#ifndef LVM_STACK_SIZE
+#define LVM_STACK_SIZE			8
+#endif
+
 #define IS_CONNECTIVE(op) ((op) & LVM_CONNECTIVE)
 
 struct variable {
@@ -82,10 +90,49 @@ typedef struct derivation derivation_t;
 
 /* Registered variables for a LVM expression. Their values may be 
    changed between executions of the expression. */
-static variable_t variables[LVM_MAX_VARIABLE_ID - 1];
+static variable_t variables[LVM_MAX_VARIABLE_ID];
 
 /* Range derivations of variables that are used for index searches. */
-static derivation_t derivations[LVM_MAX_VARIABLE_ID - 1];
+static derivation_t derivations[LVM_MAX_VARIABLE_ID];
+
+/*
+ * A compiled program is a flat sequence of pre-decoded instructions in 
+ * postfix order that operate on a small stack of long values. The 
+ * comparison of a variable with a constant, which is the most common 
+ * condition, is a single instruction. The AND and OR instructions skip 
+ * their right operand when the left one decides the result.
+ */
+enum instruction_code {
+  INSTR_TEST_EQ,
+  INSTR_TEST_NEQ,
+  INSTR_TEST_GE,
+  INSTR_TEST_GEQ,
+  INSTR_TEST_LE,
+  INSTR_TEST_LEQ,
+  INSTR_PUSH_VARIABLE,
+  INSTR_PUSH_CONSTANT,
+  INSTR_ARITHMETIC,
+  INSTR_COMPARE,
+  INSTR_AND,
+  INSTR_OR,
+  INSTR_NOT
+};
+
+struct instruction {
+  uint8_t code;
+  uint8_t op;
+  variable_id_t id;
+  uint8_t skip;
+  long value;
+};
+
+static struct instruction program[LVM_MAX_INSTRUCTIONS];
+static uint8_t program_length;
+static uint8_t stack_depth;
+static uint8_t max_stack_depth;
+
+/* The instance that the compiled program was generated from. */
+static lvm_instance_t *compiled_instance;
 
 #if DEBUG
 static void
@@ -107,7 +154,7 @@ lookup(char *name)
 {
   variable_t *var;
 
-  for(var = variables; var <= &variables[LVM_MAX_VARIABLE_ID - 1] && var->name[0] != '\0'; var++) {
+  for(var = variables; var < &variables[LVM_MAX_VARIABLE_ID] && var->name[0] != '\0'; var++) {
     if(strcmp(var->name, name) == 0) {
       break;
     }
@@ -297,6 +344,339 @@ eval_logic(lvm_instance_t *p, operator_t *op)
   return EXECUTION_ERROR;
 }
 
+static struct instruction *
+emit(uint8_t code)
+{
+  struct instruction *instruction;
+
+  if(program_length == LVM_MAX_INSTRUCTIONS) {
+    return NULL;
+  }
+
+  instruction = &program[program_length++];
+  memset(instruction, 0, sizeof(*instruction));
+  instruction->code = code;
+
+  /* Track the stack usage of the program. */
+  switch(code) {
+  case INSTR_ARITHMETIC:
+  case INSTR_COMPARE:
+  case INSTR_AND:
+  case INSTR_OR:
+    stack_depth--;
+    break;
+  case INSTR_NOT:
+    break;
+  default:
+    if(++stack_depth > max_stack_depth) {
+      max_stack_depth = stack_depth;
+    }
+    break;
+  }
+
+  return instruction;
+}
+
+static int
+compile_expr(lvm_instance_t *p)
+{
+  struct instruction *instruction;
+  operator_t *operator;
+  operand_t operand;
+  int i;
+
+  switch(get_type(p)) {
+  case LVM_ARITH_OP:
+    operator = get_operator(p);
+    for(i = 0; i < 2; i++) {
+      if(!compile_expr(p)) {
+        return 0;
+      }
+    }
+    instruction = emit(INSTR_ARITHMETIC);
+    if(instruction == NULL) {
+      return 0;
+    }
+    instruction->op = *operator;
+    return 1;
+  case LVM_OPERAND:
+    get_operand(p, &operand);
+    if(operand.type == LVM_VARIABLE) {
+      instruction = emit(INSTR_PUSH_VARIABLE);
+      if(instruction == NULL) {
+        return 0;
+      }
+      instruction->id = operand.value.id;
+    } else {
+      instruction = emit(INSTR_PUSH_CONSTANT);
+      if(instruction == NULL) {
+        return 0;
+      }
+      instruction->value = operand_to_long(&operand);
+    }
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+/* Compile the comparison of a variable with a constant into a single
+   instruction. The operator is mirrored if the constant comes first. */
+static int
+compile_test(lvm_instance_t *p, operator_t op)
+{
+  struct instruction *instruction;
+  operand_t operand[2];
+  lvm_ip_t ip;
+  int variable;
+  int i;
+
+  ip = p->ip;
+  for(i = 0; i < 2; i++) {
+    if(get_type(p) != LVM_OPERAND) {
+      p->ip = ip;
+      return 0;
+    }
+    get_operand(p, &operand[i]);
+  }
+
+  if(operand[0].type == LVM_VARIABLE && operand[1].type != LVM_VARIABLE) {
+    variable = 0;
+  } else if(operand[0].type != LVM_VARIABLE &&
+            operand[1].type == LVM_VARIABLE) {
+    variable = 1;
+  } else {
+    p->ip = ip;
+    return 0;
+  }
+
+  instruction = emit(INSTR_TEST_EQ);
+  if(instruction == NULL) {
+    return -1;
+  }
+  instruction->id = operand[variable].value.id;
+  instruction->value = operand_to_long(&operand[!variable]);
+
+  switch(op) {
+  case LVM_EQ:
+    instruction->code = INSTR_TEST_EQ;
+    break;
+  case LVM_NEQ:
+    instruction->code = INSTR_TEST_NEQ;
+    break;
+  case LVM_GE:
+    instruction->code = variable == 0 ? INSTR_TEST_GE : INSTR_TEST_LE;
+    break;
+  case LVM_GEQ:
+    instruction->code = variable == 0 ? INSTR_TEST_GEQ : INSTR_TEST_LEQ;
+    break;
+  case LVM_LE:
+    instruction->code = variable == 0 ? INSTR_TEST_LE : INSTR_TEST_GE;
+    break;
+  case LVM_LEQ:
+    instruction->code = variable == 0 ? INSTR_TEST_LEQ : INSTR_TEST_GEQ;
+    break;
+  default:
+    return -1;
+  }
+
+  return 1;
+}
+
+static int
+compile_logic(lvm_instance_t *p)
+{
+  struct instruction *instruction;
+  operator_t *operator;
+  uint8_t start;
+  int i;
+  int r;
+
+  if(get_type(p) != LVM_CMP_OP) {
+    return 0;
+  }
+  operator = get_operator(p);
+
+  switch(*operator) {
+  case LVM_NOT:
+    return compile_logic(p) && emit(INSTR_NOT) != NULL;
+  case LVM_AND:
+  case LVM_OR:
+    if(!compile_logic(p)) {
+      return 0;
+    }
+    instruction = emit(*operator == LVM_AND ? INSTR_AND : INSTR_OR);
+    if(instruction == NULL) {
+      return 0;
+    }
+    start = program_length;
+    if(!compile_logic(p)) {
+      return 0;
+    }
+    instruction->skip = program_length - start;
+    return 1;
+  default:
+    break;
+  }
+
+  r = compile_test(p, *operator);
+  if(r != 0) {
+    return r > 0;
+  }
+
+  for(i = 0; i < 2; i++) {
+    if(!compile_expr(p)) {
+      return 0;
+    }
+  }
+  instruction = emit(INSTR_COMPARE);
+  if(instruction == NULL) {
+    return 0;
+  }
+  instruction->op = *operator;
+
+  return 1;
+}
+
+static int
+compare(operator_t op, long l1, long l2)
+{
+  switch(op) {
+  case LVM_EQ:
+    return l1 == l2;
+  case LVM_NEQ:
+    return l1 != l2;
+  case LVM_GE:
+    return l1 > l2;
+  case LVM_GEQ:
+    return l1 >= l2;
+  case LVM_LE:
+    return l1 < l2;
+  case LVM_LEQ:
+    return l1 <= l2;
+  default:
+    return 0;
+  }
+}
+
+static lvm_status_t
+execute_program(void)
+{
+  long stack[LVM_STACK_SIZE];
+  long *top;
+  struct instruction *instruction;
+  struct instruction *end;
+  long value;
+
+  top = stack - 1;
+  end = &program[program_length];
+
+  for(instruction = program; instruction < end; instruction++) {
+    value = variables[instruction->id].value.l;
+
+    switch(instruction->code) {
+    case INSTR_TEST_EQ:
+      *++top = value == instruction->value;
+      break;
+    case INSTR_TEST_NEQ:
+      *++top = value != instruction->value;
+      break;
+    case INSTR_TEST_GE:
+      *++top = value > instruction->value;
+      break;
+    case INSTR_TEST_GEQ:
+      *++top = value >= instruction->value;
+      break;
+    case INSTR_TEST_LE:
+      *++top = value < instruction->value;
+      break;
+    case INSTR_TEST_LEQ:
+      *++top = value <= instruction->value;
+      break;
+    case INSTR_PUSH_VARIABLE:
+      *++top = value;
+      break;
+    case INSTR_PUSH_CONSTANT:
+      *++top = instruction->value;
+      break;
+    case INSTR_ARITHMETIC:
+      top--;
+      switch(instruction->op) {
+      case LVM_ADD:
+        top[0] += top[1];
+        break;
+      case LVM_SUB:
+        top[0] -= top[1];
+        break;
+      case LVM_MUL:
+        top[0] *= top[1];
+        break;
+      case LVM_DIV:
+        if(top[1] == 0) {
+          return MATH_ERROR;
+        }
+        top[0] /= top[1];
+        break;
+      default:
+        return EXECUTION_ERROR;
+      }
+      break;
+    case INSTR_COMPARE:
+      top--;
+      top[0] = compare(instruction->op, top[0], top[1]);
+      break;
+    case INSTR_AND:
+      if(!*top) {
+        instruction += instruction->skip;
+      } else {
+        top--;
+      }
+      break;
+    case INSTR_OR:
+      if(*top) {
+        instruction += instruction->skip;
+      } else {
+        top--;
+      }
+      break;
+    case INSTR_NOT:
+      *top = !*top;
+      break;
+    default:
+      return EXECUTION_ERROR;
+    }
+  }
+
+  return *top ? TRUE : FALSE;
+}
+
+lvm_status_t
+lvm_compile(lvm_instance_t *p)
+{
+  lvm_ip_t ip;
+  int r;
+
+  compiled_instance = NULL;
+  program_length = 0;
+  stack_depth = 0;
+  max_stack_depth = 0;
+
+  ip = p->ip;
+  p->ip = 0;
+  r = compile_logic(p);
+  p->ip = ip;
+
+  if(!r || max_stack_depth > LVM_STACK_SIZE) {
+    PRINTF("The program could not be compiled; it will be interpreted\n");
+    return EXECUTION_ERROR;
+  }
+
+  PRINTF("Compiled %u instructions\n", (unsigned)program_length);
+  compiled_instance = p;
+
+  return TRUE;
+}
+
 void
 lvm_reset(lvm_instance_t *p, unsigned char *code, lvm_ip_t size)
 {
@@ -309,6 +689,10 @@ lvm_reset(lvm_instance_t *p, unsigned char *code, lvm_ip_t size)
 
   memset(variables, 0, sizeof(variables));
   memset(derivations, 0, sizeof(derivations));
+
+  if(compiled_instance == p) {
+    compiled_instance = NULL;
+  }
 }
 
 lvm_ip_t
@@ -383,6 +767,10 @@ lvm_execute(lvm_instance_t *p)
   operator_t *operator;
   lvm_status_t status;
 
+  if(p == compiled_instance) {
+    return execute_program();
+  }
+
   p->ip = 0;
   status = EXECUTION_ERROR;
   type = get_type(p);
@@ -459,6 +847,26 @@ lvm_register_variable(char *name, operand_type_t type)
   return TRUE;
 }
 
+variable_id_t
+lvm_get_variable_id(char *name)
+{
+  variable_id_t id;
+
+  id = lookup(name);
+  if(id == LVM_MAX_VARIABLE_ID || variables[id].name[0] == '\0') {
+    return LVM_INVALID_VARIABLE;
+  }
+  return id;
+}
+
+void
+lvm_set_variable_value_by_id(variable_id_t id, operand_value_t value)
+{
+  if(id < LVM_MAX_VARIABLE_ID) {
+    variables[id].value = value;
+  }
+}
+
 lvm_status_t
 lvm_set_variable_value(char *name, operand_value_t value)
 {
@@ -106,6 +106,8 @@ typedef enum operand_type operand_type_t;
 
 typedef unsigned char variable_id_t;
 
+#define LVM_INVALID_VARIABLE	((variable_id_t)-1)
+
 typedef union {
   long l;
 #if LVM_USE_FLOATS
@@ -127,9 +129,12 @@ lvm_status_t lvm_get_derived_range(lvm_instance_t *p, char *name,
                                    operand_value_t *min,
                                    operand_value_t *max);
 void lvm_print_derivations(lvm_instance_t *p);
+lvm_status_t lvm_compile(lvm_instance_t *p);
 lvm_status_t lvm_execute(lvm_instance_t *p);
 lvm_status_t lvm_register_variable(char *name, operand_type_t type);
 lvm_status_t lvm_set_variable_value(char *name, operand_value_t value);
+variable_id_t lvm_get_variable_id(char *name);
+void lvm_set_variable_value_by_id(variable_id_t id, operand_value_t value);
 void lvm_print_code(lvm_instance_t *p);
 lvm_ip_t lvm_jump_to_operand(lvm_instance_t *p);
 lvm_ip_t lvm_shift_for_operator(lvm_instance_t *p, lvm_ip_t end);
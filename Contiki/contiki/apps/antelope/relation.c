@@ -40,6 +40,7 @@
 #include "lib/crc16.h"
 #include "lib/list.h"
 #include "lib/memb.h"
+#include "lib/random.h"
 
 #define DEBUG DEBUG_NONE
 #include "net/uip-debug.h"
@@ -64,6 +65,7 @@ struct source_dest_map {
   attribute_t *to_attr;
   unsigned from_offset;
   unsigned to_offset;
+  variable_id_t variable_id;
 };
 
 static struct source_dest_map attr_map[AQL_ATTRIBUTE_LIMIT];
@@ -79,6 +81,40 @@ struct source_map {
 };
 
 static struct source_map source_map[AQL_ATTRIBUTE_LIMIT];
+
+/*
+ * The hash join keeps a chunk of the right relation in RAM. Each
+ * entry consists of a join_entry structure followed by a row. The
+ * entries are chained from the buckets by their 1-based numbers.
+ */
+struct join_entry {
+  long key;
+  uint16_t next;
+};
+
+#define JOIN_ENTRY(number) \
+  ((struct join_entry *)((unsigned char *)join_memory + \
+                         ((number) - 1) * join.entry_size))
+
+static long join_memory[DB_JOIN_MEMORY / sizeof(long)];
+static uint16_t join_buckets[DB_JOIN_HASH_BUCKETS];
+
+/* The state of a hash join or a merge join in progress. */
+static struct {
+  unsigned char *left_key_ptr;
+  unsigned char *right_key_ptr;
+  long left_key;
+  long run_key;
+  tuple_id_t right_tuple_id;
+  tuple_id_t run_start;
+  uint16_t entry;
+  uint16_t entry_size;
+  uint16_t capacity;
+  uint8_t left_needed;
+  uint8_t build_needed;
+  uint8_t build_done;
+  uint8_t run_valid;
+} join;
 #endif /* DB_FEATURE_JOIN */
 
 static unsigned char row[DB_MAX_ATTRIBUTES_PER_RELATION * DB_MAX_ELEMENT_SIZE];
@@ -266,7 +302,7 @@ relation_release(relation_t *rel)
   }
 
   if(rel->references == 0) {
-    storage_unload(rel);
+    return storage_unload(rel);
   }
 
   return DB_OK;
@@ -547,41 +583,350 @@ relation_insert(relation_t *rel, attribute_value_t *values)
   return storage_put_row(rel, record);
 }
 
+/*
+ * Aggregates are computed while the selection streams through the 
+ * relation, so the rows that match the predicate are never 
+ * materialized. A group keeps one accumulator for each result 
+ * attribute. The groups are stored in a small open-addressing hash 
+ * table keyed on the value of the GROUP BY attribute. A query without 
+ * GROUP BY uses only the first group.
+ */
+struct aggregation_group {
+  long key;
+  tuple_id_t count;
+  long values[AQL_ATTRIBUTE_LIMIT];
+};
+
+static struct aggregation_group groups[AQL_GROUP_LIMIT];
+static struct source_dest_map *group_map;
+static uint8_t groups_left;
+static uint8_t emitting_groups;
+
+/*
+ * The MEDIAN and QUANTILE aggregators summarize the input in a 
+ * compacting sketch of AQL_MEDIAN_SAMPLES values, in the manner of 
+ * Karnin, Lang and Liberty. The values are kept in levels, where a 
+ * value on level h stands for 2^h sampled input values. New values 
+ * enter level 0. When the sketch is full, the lowest level that has 
+ * reached its capacity is sorted, and every other value of it moves up 
+ * one level. The capacity of a level shrinks by a third for each level 
+ * below the top one, so that the values with the largest weights are 
+ * compacted the least. Until the sketch is full, the result is exact.
+ *
+ * Once SAMPLE_LEVELS levels are in use, level 0 is compacted into 
+ * level 1, the levels are shifted down, and from then on one input 
+ * value is sampled at a random position in each window of "weight" 
+ * input values. The requested quantile, in percent, is read from the 
+ * values ordered by value and weighted by their level; MEDIAN is the 
+ * 50% quantile.
+ */
+#define SAMPLE_LEVELS	(AQL_MEDIAN_SAMPLES / 4)
+
+static struct {
+  long values[AQL_MEDIAN_SAMPLES];
+  uint8_t sizes[SAMPLE_LEVELS];
+  tuple_id_t weight;
+  tuple_id_t position;
+  tuple_id_t target;
+  uint8_t count;
+  uint8_t levels;
+  uint8_t capacity;
+  uint8_t parity;
+  uint8_t quantile;
+} sample;
+
+/* random_rand() returns only 16 bits, so two calls are combined to
+   cover windows that are larger than that. */
+static tuple_id_t
+sample_position(tuple_id_t window)
+{
+  return (((tuple_id_t)random_rand() << 16) | random_rand()) & (window - 1);
+}
+
+static unsigned
+level_capacity(unsigned capacity, unsigned depth)
+{
+  while(depth-- > 0 && capacity > 2) {
+    capacity = (2 * capacity + 2) / 3;
+  }
+  return capacity < 2 ? 2 : capacity;
+}
+
+/* The top level gets the largest capacity with which the capacities of
+   all levels fit in the sketch. */
 static void
-aggregate(attribute_t *attr, attribute_value_t *value)
+sample_set_capacity(void)
 {
-  long long_value;
+  unsigned total;
+  unsigned i;
 
-  switch(value->domain) {
-  case DOMAIN_INT:
-    long_value = VALUE_INT(value);
-    break;
-  case DOMAIN_LONG:
-    long_value = VALUE_LONG(value);
-    break;
-  default:
-    return;
+  for(sample.capacity = AQL_MEDIAN_SAMPLES; sample.capacity > 2;
+      sample.capacity--) {
+    for(i = total = 0; i < sample.levels; i++) {
+      total += level_capacity(sample.capacity, i);
+    }
+    if(total <= AQL_MEDIAN_SAMPLES) {
+      break;
+    }
+  }
+}
+
+/* The levels are stored from the top one down, so that new values are
+   appended to level 0 at the end of the sketch. */
+static unsigned
+level_start(unsigned level)
+{
+  unsigned start;
+
+  for(start = 0; ++level < sample.levels;) {
+    start += sample.sizes[level];
+  }
+  return start;
+}
+
+static void
+sample_sort(long *values, unsigned count)
+{
+  unsigned i, j;
+  long value;
+
+  for(i = 1; i < count; i++) {
+    value = values[i];
+    for(j = i; j > 0 && values[j - 1] > value; j--) {
+      values[j] = values[j - 1];
+    }
+    values[j] = value;
+  }
+}
+
+static void
+sample_compact(unsigned level)
+{
+  long *values;
+  long leftover;
+  unsigned start, size, kept, first, i;
+
+  start = level_start(level);
+  size = sample.sizes[level];
+  values = &sample.values[start];
+  sample_sort(values, size);
+
+  /* With an odd number of values, either the smallest or the largest 
+     one stays on the level. */
+  first = 0;
+  leftover = 0;
+  if(size & 1) {
+    if(random_rand() & 1) {
+      leftover = values[first++];
+    } else {
+      leftover = values[size - 1];
+    }
+  }
+
+  /* Alternate between promoting the odd and the even values so that 
+     the estimate is not biased in either direction. The promoted values 
+     are appended to the level above, which ends where this one 
+     starts. */
+  kept = size / 2;
+  for(i = 0; i < kept; i++) {
+    values[i] = values[first + 2 * i + sample.parity];
+  }
+  sample.parity ^= 1;
+  sample.sizes[level + 1] += kept;
+  sample.sizes[level] = size & 1;
+  if(size & 1) {
+    values[kept++] = leftover;
+  }
+
+  memmove(&values[kept], &values[size],
+          (sample.count - start - size) * sizeof(long));
+  sample.count -= size - kept;
+}
+
+static void
+sample_make_room(void)
+{
+  unsigned level;
+  unsigned i;
+
+  for(level = 0; level < sample.levels - 1U; level++) {
+    if(sample.sizes[level] >= level_capacity(sample.capacity,
+                                             sample.levels - 1 - level)) {
+      break;
+    }
+  }
+
+  if(level < sample.levels - 1U) {
+    sample_compact(level);
+  } else if(sample.levels < SAMPLE_LEVELS) {
+    /* The top level is over its capacity, so a new level is added 
+       above it. */
+    sample.sizes[sample.levels++] = 0;
+    sample_set_capacity();
+    sample_compact(level);
+  } else {
+    /* No more levels can be added. Level 0 is halved into level 1 
+       after dropping the latest value if there is an odd number of 
+       them, and the levels are shifted down. Each input value on the 
+       new level 0 must then stand for twice as many as before, which 
+       the sampling accomplishes. */
+    if(sample.sizes[0] & 1) {
+      sample.sizes[0]--;
+      sample.count--;
+    }
+    sample_compact(0);
+    for(i = 0; i < sample.levels - 1U; i++) {
+      sample.sizes[i] = sample.sizes[i + 1];
+    }
+    sample.levels--;
+    sample_set_capacity();
+    sample.weight <<= 1;
+    sample.position = 0;
+    sample.target = sample_position(sample.weight);
+  }
+}
+
+static void
+sample_add(long value)
+{
+  if(sample.position++ == sample.target) {
+    if(sample.count == AQL_MEDIAN_SAMPLES) {
+      sample_make_room();
+    }
+    sample.values[sample.count++] = value;
+    sample.sizes[0]++;
+  }
+  if(sample.position == sample.weight) {
+    sample.position = 0;
+    sample.target = sample_position(sample.weight);
+  }
+}
+
+static tuple_id_t
+sample_weight(unsigned index)
+{
+  unsigned level;
+  unsigned end;
+
+  level = sample.levels;
+  end = 0;
+  do {
+    end += sample.sizes[--level];
+  } while(index >= end);
+
+  return sample.weight << level;
+}
+
+static long
+sample_get(void)
+{
+  tuple_id_t total, rank, below, equal, weight;
+  unsigned i, j;
+
+  if(sample.count == 0) {
+    return 0;
+  }
+
+  total = 0;
+  for(i = 0; i < sample.count; i++) {
+    total += sample_weight(i);
+  }
+  total--;
+  rank = total / 100 * sample.quantile + 
+         total % 100 * sample.quantile / 100;
+
+  /* Find the value whose weighted range of ranks contains the rank of 
+     the quantile. */
+  for(i = 0; i < sample.count; i++) {
+    below = equal = 0;
+    for(j = 0; j < sample.count; j++) {
+      weight = sample_weight(j);
+      if(sample.values[j] < sample.values[i]) {
+        below += weight;
+      } else if(sample.values[j] == sample.values[i]) {
+        equal += weight;
+      }
+    }
+    if(below <= rank && rank < below + equal) {
+      break;
+    }
+  }
+
+  return sample.values[i];
+}
+
+static void
+group_init(struct aggregation_group *group, long key, 
+           unsigned attribute_count)
+{
+  unsigned i;
+
+  group->key = key;
+  group->count = 0;
+
+  for(i = 0; i < attribute_count; i++) {
+    switch(attr_map[i].to_attr->aggregator) {
+    case AQL_MAX:
+      group->values[i] = LONG_MIN;
+      break;
+    case AQL_MIN:
+      group->values[i] = LONG_MAX;
+      break;
+    default:
+      group->values[i] = 0;
+      break;
+    }
   }
+}
 
-  switch(attr->aggregator) {
+static struct aggregation_group *
+group_find(long key, unsigned attribute_count)
+{
+  struct aggregation_group *group;
+  unsigned slot;
+  unsigned i;
+
+  slot = (unsigned long)key % AQL_GROUP_LIMIT;
+  for(i = 0; i < AQL_GROUP_LIMIT; i++) {
+    group = &groups[slot];
+    if(group->count == 0) {
+      group_init(group, key, attribute_count);
+      return group;
+    }
+    if(group->key == key) {
+      return group;
+    }
+    if(++slot == AQL_GROUP_LIMIT) {
+      slot = 0;
+    }
+  }
+
+  return NULL;
+}
+
+static void
+aggregate(aql_aggregator_t aggregator, long *accumulator, long value)
+{
+  switch(aggregator) {
   case AQL_COUNT:
-    attr->aggregation_value++;
+    (*accumulator)++;
     break;
   case AQL_SUM:
-    attr->aggregation_value += long_value;
-    break;
   case AQL_MEAN:
+    *accumulator += value;
     break;
   case AQL_MEDIAN:
+  case AQL_QUANTILE:
+    sample_add(value);
     break;
   case AQL_MAX:
-    if(long_value > attr->aggregation_value) {
-      attr->aggregation_value = long_value;
+    if(value > *accumulator) {
+      *accumulator = value;
     }
     break;
   case AQL_MIN:
-    if(long_value < attr->aggregation_value) {
-      attr->aggregation_value = long_value;
+    if(value < *accumulator) {
+      *accumulator = value;
     }
     break;
   default:
@@ -589,6 +934,166 @@ aggregate(attribute_t *attr, attribute_value_t *value)
   }
 }
 
+static db_result_t
+aggregate_row(unsigned attribute_count)
+{
+  struct aggregation_group *group;
+  struct source_dest_map *map;
+  attribute_value_t value;
+  db_result_t result;
+  unsigned i;
+
+  if(group_map == NULL) {
+    group = &groups[0];
+  } else {
+    result = db_phy_to_value(&value, group_map->from_attr,
+                             row + group_map->from_offset);
+    if(DB_ERROR(result)) {
+      return result;
+    }
+    group = group_find(db_value_to_long(&value), attribute_count);
+    if(group == NULL) {
+      PRINTF("DB: Too many groups in the aggregation\n");
+      return DB_LIMIT_ERROR;
+    }
+  }
+
+  group->count++;
+
+  for(i = 0, map = attr_map; i < attribute_count; i++, map++) {
+    if(map->to_attr->aggregator == AQL_NONE) {
+      continue;
+    }
+    result = db_phy_to_value(&value, map->from_attr, row + map->from_offset);
+    if(DB_ERROR(result)) {
+      return result;
+    }
+    if(value.domain == DOMAIN_INT || value.domain == DOMAIN_LONG) {
+      aggregate(map->to_attr->aggregator, &group->values[i],
+                db_value_to_long(&value));
+    }
+  }
+
+  return DB_OK;
+}
+
+static db_result_t
+emit_group(db_handle_t *handle, unsigned attribute_count)
+{
+  struct aggregation_group *group;
+  struct source_dest_map *map;
+  attribute_t *attr;
+  attribute_value_t value;
+  long result;
+  unsigned i;
+
+  if(groups_left == 0) {
+    emitting_groups = 0;
+    AQL_GET_FLAGS((aql_adt_t *)handle->adt) &= ~AQL_FLAG_AGGREGATE;
+    return DB_FINISHED;
+  }
+
+  /* Emit the groups in ascending order of their keys. */
+  group = &groups[0];
+  if(group_map != NULL) {
+    for(i = 0; i < AQL_GROUP_LIMIT; i++) {
+      if(groups[i].count > 0 &&
+         (group->count == 0 || groups[i].key < group->key)) {
+        group = &groups[i];
+      }
+    }
+  }
+
+  for(i = 0, map = attr_map; i < attribute_count; i++, map++) {
+    attr = map->to_attr;
+    if(attr->flags & ATTRIBUTE_FLAG_NO_STORE) {
+      continue;
+    }
+
+    switch(attr->aggregator) {
+    case AQL_NONE:
+      /* The grouping attribute. */
+      result = group->key;
+      break;
+    case AQL_MEAN:
+      result = group->count == 0 ? 0 : group->values[i] / (long)group->count;
+      break;
+    case AQL_MEDIAN:
+    case AQL_QUANTILE:
+      result = sample_get();
+      break;
+    default:
+      result = group->values[i];
+      break;
+    }
+
+    value.domain = attr->domain;
+    if(attr->domain == DOMAIN_INT) {
+      VALUE_INT(&value) = result;
+    } else {
+      VALUE_LONG(&value) = result;
+    }
+    db_value_to_phy(result_row + map->to_offset, attr, &value);
+  }
+
+  group->count = 0;
+  groups_left--;
+
+  if(AQL_GET_FLAGS((aql_adt_t *)handle->adt) & AQL_FLAG_ASSIGN) {
+    if(DB_ERROR(storage_put_row(handle->result_rel, result_row))) {
+      PRINTF("DB: Failed to store a row in the result relation!\n");
+      return DB_STORAGE_ERROR;
+    }
+  }
+
+  handle->current_row++;
+  return DB_GOT_ROW;
+}
+
+static void
+start_aggregation(aql_adt_t *adt, unsigned attribute_count)
+{
+  unsigned i;
+
+  memset(groups, 0, sizeof(groups));
+  memset(&sample, 0, sizeof(sample));
+  sample.weight = 1;
+  sample.levels = 1;
+  sample_set_capacity();
+  sample.quantile = adt->quantile;
+
+  group_map = NULL;
+  if(AQL_GET_FLAGS(adt) & AQL_FLAG_GROUP) {
+    for(i = 0; i < attribute_count; i++) {
+      if(attr_map[i].to_attr->aggregator == AQL_NONE &&
+         strcmp(attr_map[i].to_attr->name,
+                adt->attributes[AQL_GET_GROUP(adt)].name) == 0) {
+        group_map = &attr_map[i];
+        break;
+      }
+    }
+  } else {
+    group_init(&groups[0], 0, attribute_count);
+  }
+}
+
+static void
+end_scan(void)
+{
+  unsigned i;
+
+  emitting_groups = 1;
+  if(group_map == NULL) {
+    groups_left = 1;
+  } else {
+    for(i = groups_left = 0; i < AQL_GROUP_LIMIT; i++) {
+      if(groups[i].count > 0) {
+        groups_left++;
+      }
+    }
+  }
+}
+
 static db_result_t
 generate_attribute_map(struct source_dest_map *attr_map, unsigned attribute_count,
                        relation_t *from_rel, relation_t *to_rel, 
@@ -677,6 +1182,7 @@ generate_selection_result(db_handle_t *handle, relation_t *rel, aql_adt_t *adt)
   relation_t *result_rel;
   unsigned attribute_count;
   attribute_t *attr;
+  unsigned i;
 
   result_rel = handle->result_rel;
 
@@ -696,11 +1202,27 @@ generate_selection_result(db_handle_t *handle, relation_t *rel, aql_adt_t *adt)
     return DB_IMPLEMENTATION_ERROR;
   }
 
+  emitting_groups = 0;
+  if(AQL_GET_FLAGS(adt) & AQL_FLAG_AGGREGATE) {
+    start_aggregation(adt, attribute_count);
+  }
+
+  for(i = 0; i < attribute_count; i++) {
+    attr_map[i].variable_id = LVM_INVALID_VARIABLE;
+  }
+
   if(adt->lvm_instance != NULL) {
     /* Try to establish acceptable ranges for the attribute values. */
     if(!LVM_ERROR(lvm_derive(adt->lvm_instance))) {
       select_index(handle, adt->lvm_instance);
     }
+
+    /* Bind the attributes to the variables of the predicate, and compile
+       it so that it need not be decoded again for each row. */
+    for(i = 0; i < attribute_count; i++) {
+      attr_map[i].variable_id = lvm_get_variable_id(attr_map[i].to_attr->name);
+    }
+    lvm_compile(adt->lvm_instance);
   }
 
   handle->flags |= DB_HANDLE_FLAG_PROCESSING;
@@ -741,10 +1263,7 @@ relation_process_select(void *handle_ptr)
   struct source_dest_map *attr_map_ptr, *attr_map_end;
   attribute_t *result_attr;
   unsigned char *from_ptr;
-  unsigned char *to_ptr;
   operand_value_t operand_value;
-  uint8_t intbuf[2];
-  attribute_value_t value;
   lvm_status_t wanted_result;
 
   handle = (db_handle_t *)handle_ptr;
@@ -753,6 +1272,10 @@ relation_process_select(void *handle_ptr)
   attribute_count = handle->result_rel->attribute_count;
   attr_map_end = attr_map + attribute_count;
 
+  if(emitting_groups) {
+    return emit_group(handle, attribute_count);
+  }
+
   if(handle->flags & DB_HANDLE_FLAG_SEARCH_INDEX) {
     handle->tuple_id = index_get_next(&handle->index_iterator);
     if(handle->tuple_id == INVALID_TUPLE) {
@@ -788,16 +1311,19 @@ relation_process_select(void *handle_ptr)
     from_ptr = row + attr_map_ptr->from_offset;
     result_attr = attr_map_ptr->to_attr;
 
-    /* Update the internal state of the PLE. */
-    if(result_attr->domain == DOMAIN_INT) {
-      operand_value.l = from_ptr[0] << 8 | from_ptr[1];
-      lvm_set_variable_value(result_attr->name, operand_value);
-    } else if(result_attr->domain == DOMAIN_LONG) {
-      operand_value.l = (uint32_t)from_ptr[0] << 24 |
-                        (uint32_t)from_ptr[1] << 16 |
-                        (uint32_t)from_ptr[2] << 8 |
-                        from_ptr[3];
-      lvm_set_variable_value(result_attr->name, operand_value);
+    /* Update the internal state of the PLE. The domain of an aggregated 
+       result attribute differs from that of the source attribute. */
+    if(attr_map_ptr->variable_id != LVM_INVALID_VARIABLE) {
+      if(attr_map_ptr->from_attr->domain == DOMAIN_INT) {
+        operand_value.l = from_ptr[0] << 8 | from_ptr[1];
+        lvm_set_variable_value_by_id(attr_map_ptr->variable_id, operand_value);
+      } else if(attr_map_ptr->from_attr->domain == DOMAIN_LONG) {
+        operand_value.l = (uint32_t)from_ptr[0] << 24 |
+                          (uint32_t)from_ptr[1] << 16 |
+                          (uint32_t)from_ptr[2] << 8 |
+                          from_ptr[3];
+        lvm_set_variable_value_by_id(attr_map_ptr->variable_id, operand_value);
+      }
     }
 
     if(result_attr->flags & ATTRIBUTE_FLAG_NO_STORE) {
@@ -822,14 +1348,7 @@ relation_process_select(void *handle_ptr)
   if(adt->lvm_instance == NULL ||
      lvm_execute(adt->lvm_instance) == wanted_result) {
     if(AQL_GET_FLAGS(adt) & AQL_FLAG_AGGREGATE) {
-      for(attr_map_ptr = attr_map; attr_map_ptr < attr_map_end; attr_map_ptr++) {
-        from_ptr = row + attr_map_ptr->from_offset;
-        result = db_phy_to_value(&value, attr_map_ptr->to_attr, from_ptr);
-        if(DB_ERROR(result)) {
-	  return result;
-        }
-        aggregate(attr_map_ptr->to_attr, &value);
-      }
+      return aggregate_row(attribute_count);
     } else {
       if(AQL_GET_FLAGS(adt) & AQL_FLAG_ASSIGN) {
         if(DB_ERROR(storage_put_row(handle->result_rel, result_row))) {
@@ -845,28 +1364,9 @@ relation_process_select(void *handle_ptr)
   return DB_OK;
 
 end_aggregation:
-  /* Generate aggregated result if requested. */
-  for(attr_map_ptr = attr_map; attr_map_ptr < attr_map_end; attr_map_ptr++) {
-    result_attr = attr_map_ptr->to_attr;
-    to_ptr = result_row + attr_map_ptr->to_offset;
-
-    intbuf[0] = result_attr->aggregation_value >> 8;
-    intbuf[1] = result_attr->aggregation_value & 0xff;
-    from_ptr = intbuf;
-    memcpy(to_ptr, from_ptr, result_attr->element_size);
-  }
-
-  if(AQL_GET_FLAGS(adt) & AQL_FLAG_ASSIGN) {
-    if(DB_ERROR(storage_put_row(handle->result_rel, result_row))) {
-      PRINTF("DB: Failed to store a row in the result relation!\n");
-      return DB_STORAGE_ERROR;
-    }
-  }
-
-  handle->current_row = 1;
-  AQL_GET_FLAGS(adt) &= ~AQL_FLAG_AGGREGATE; /* Stop the aggregation. */
-
-  return DB_GOT_ROW;
+  /* Generate the aggregated result, one row for each group. */
+  end_scan();
+  return emit_group(handle, attribute_count);
 }
 
 db_result_t
@@ -880,6 +1380,8 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
   attribute_t *attr;
   int i;
   int normal_attributes;
+  int aggregated_attributes;
+  int sampled_attributes;
 
   adt = (aql_adt_t *)adt_ptr;
 
@@ -903,7 +1405,10 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
     return DB_ALLOCATION_ERROR;
   }
 
-  for(i = normal_attributes = 0; i < AQL_ATTRIBUTE_COUNT(adt); i++) {
+  sampled_attributes = 0;
+  for(i = normal_attributes = aggregated_attributes = 0;
+      i < AQL_ATTRIBUTE_COUNT(adt);
+      i++) {
     attribute_name = adt->attributes[i].name;
 
     attr = relation_attribute_get(rel, attribute_name);
@@ -916,10 +1421,16 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
     PRINTF("DB: Found attribute %s in relation %s\n",
 	attribute_name, rel->name);
 
-    attr = relation_attribute_add(handle->result_rel, dir,
-				  attribute_name, 
-				  adt->aggregators[i] ? DOMAIN_INT : attr->domain,
-				  attr->element_size);
+    /* Aggregated values are stored as long integers because they may 
+       exceed the range of the source attribute. */
+    if(adt->aggregators[i] != AQL_NONE) {
+      attr = relation_attribute_add(handle->result_rel, dir,
+                                    attribute_name, DOMAIN_LONG, 4);
+    } else {
+      attr = relation_attribute_add(handle->result_rel, dir,
+				    attribute_name, attr->domain,
+				    attr->element_size);
+    }
     if(attr == NULL) {
       PRINTF("DB: Failed to add a result attribute\n");
       relation_release(handle->result_rel);
@@ -927,38 +1438,237 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
     }
 
     attr->aggregator = adt->aggregators[i];
-    switch(attr->aggregator) {
-    case AQL_NONE:
-      if(!(adt->attributes[i].flags & ATTRIBUTE_FLAG_NO_STORE)) {
-        /* Only count attributes projected into the result set. */
-        normal_attributes++;
+    attr->flags = adt->attributes[i].flags;
+
+    if(attr->aggregator == AQL_MEDIAN || attr->aggregator == AQL_QUANTILE) {
+      /* There is only one sketch for approximating the median or the 
+         quantile. */
+      if(sampled_attributes++ > 0 || (AQL_GET_FLAGS(adt) & AQL_FLAG_GROUP)) {
+        relation_release(handle->result_rel);
+        return DB_LIMIT_ERROR;
       }
-      break;
-    case AQL_MAX:
-      attr->aggregation_value = LONG_MIN;
-      break;
-    case AQL_MIN:
-      attr->aggregation_value = LONG_MAX;
-      break;
-    default:
-      attr->aggregation_value = 0;
-      break;
     }
 
-    attr->flags = adt->attributes[i].flags;
+    if(attr->aggregator != AQL_NONE) {
+      aggregated_attributes++;
+    } else if(!(attr->flags & ATTRIBUTE_FLAG_NO_STORE)) {
+      /* Only count attributes projected into the result set. */
+      normal_attributes++;
+    }
   }
 
   /* Preclude mixes of normal attributes and aggregated ones in 
-     selection results. */
-  if(normal_attributes > 0 &&
-     handle->result_rel->attribute_count > normal_attributes) {
+     selection results. The only exception is the attribute by which 
+     the rows are grouped. */
+  if(aggregated_attributes > 0 &&
+     normal_attributes > ((AQL_GET_FLAGS(adt) & AQL_FLAG_GROUP) ? 1 : 0)) {
+     relation_release(handle->result_rel);
      return DB_RELATIONAL_ERROR;
   }
 
+  if(AQL_GET_FLAGS(adt) & AQL_FLAG_GROUP) {
+    attr = relation_attribute_get(rel, 
+                                  adt->attributes[AQL_GET_GROUP(adt)].name);
+    if(attr->domain != DOMAIN_INT && attr->domain != DOMAIN_LONG) {
+      relation_release(handle->result_rel);
+      return DB_TYPE_ERROR;
+    }
+  }
+
   return generate_selection_result(handle, rel, adt);
 }
 
 #if DB_FEATURE_JOIN
+static long
+join_key(attribute_t *attr, unsigned char *ptr)
+{
+  attribute_value_t value;
+
+  if(DB_ERROR(db_phy_to_value(&value, attr, ptr))) {
+    return 0;
+  }
+  return db_value_to_long(&value);
+}
+
+static db_result_t
+emit_join_row(db_handle_t *handle)
+{
+  unsigned char *join_next_attribute_ptr;
+  size_t element_size;
+  int i;
+
+  /* Use the source attribute map to fill in the physical representation
+     of the resulting tuple. */
+  join_next_attribute_ptr = join_row;
+
+  for(i = 0; i < handle->join_rel->attribute_count; i++) {
+    element_size = source_map[i].attr->element_size;
+
+    memcpy(join_next_attribute_ptr, source_map[i].from_ptr, element_size);
+    join_next_attribute_ptr += element_size;
+  }
+
+  if(((aql_adt_t *)handle->adt)->flags & AQL_FLAG_ASSIGN) {
+    if(DB_ERROR(storage_put_row(handle->join_rel, join_row))) {
+      return DB_STORAGE_ERROR;
+    }
+  }
+
+  handle->current_row++;
+  return DB_GOT_ROW;
+}
+
+/* Read the next chunk of the right relation into the hash table. */
+static db_result_t
+build_hash_table(db_handle_t *handle)
+{
+  struct join_entry *entry;
+  db_result_t result;
+  unsigned bucket;
+  uint16_t count;
+
+  memset(join_buckets, 0, sizeof(join_buckets));
+
+  for(count = 0; count < join.capacity;) {
+    entry = JOIN_ENTRY(count + 1);
+    result = storage_get_row(handle->right_rel, &join.right_tuple_id,
+                             (unsigned char *)(entry + 1));
+    if(DB_ERROR(result)) {
+      PRINTF("DB: Failed to get a row in right relation %s!\n",
+             handle->right_rel->name);
+      return result;
+    } else if(result == DB_FINISHED) {
+      join.build_done = 1;
+      break;
+    }
+    join.right_tuple_id++;
+
+    entry->key = join_key(handle->right_join_attr, 
+                          (unsigned char *)(entry + 1) +
+                          (join.right_key_ptr - right_row));
+    bucket = (unsigned long)entry->key % DB_JOIN_HASH_BUCKETS;
+    entry->next = join_buckets[bucket];
+    join_buckets[bucket] = ++count;
+  }
+
+  PRINTF("DB: Built a hash table of %u rows\n", (unsigned)count);
+
+  return count == 0 ? DB_FINISHED : DB_OK;
+}
+
+/*
+ * Hash join: the right relation is read into RAM in chunks of at most 
+ * join.capacity rows. The left relation is scanned once for each 
+ * chunk, so that no temporary data has to be written to flash.
+ */
+static db_result_t
+process_hash_join(db_handle_t *handle)
+{
+  struct join_entry *entry;
+  db_result_t result;
+
+  for(;;) {
+    /* Emit the remaining matches for the current left row. */
+    while(join.entry != 0) {
+      entry = JOIN_ENTRY(join.entry);
+      join.entry = entry->next;
+      if(entry->key == join.left_key) {
+        memcpy(right_row, entry + 1, handle->right_rel->row_length);
+        return emit_join_row(handle);
+      }
+    }
+
+    if(join.build_needed) {
+      result = build_hash_table(handle);
+      if(result != DB_OK) {
+        return result;
+      }
+      join.build_needed = 0;
+      handle->tuple_id = 0;
+    }
+
+    result = storage_get_row(handle->left_rel, &handle->tuple_id, left_row);
+    if(DB_ERROR(result)) {
+      PRINTF("DB: Failed to get a row in left relation %s!\n",
+             handle->left_rel->name);
+      return result;
+    } else if(result == DB_FINISHED) {
+      if(join.build_done) {
+        return DB_FINISHED;
+      }
+      join.build_needed = 1;
+      continue;
+    }
+    handle->tuple_id++;
+
+    join.left_key = join_key(handle->left_join_attr, join.left_key_ptr);
+    join.entry = join_buckets[(unsigned long)join.left_key %
+                              DB_JOIN_HASH_BUCKETS];
+  }
+}
+
+/*
+ * Merge join: both relations are stored in ascending order of the join 
+ * attribute. The rows of the right relation that match a left row form 
+ * a run, which is rescanned for each left row with the same key.
+ */
+static db_result_t
+process_merge_join(db_handle_t *handle)
+{
+  db_result_t result;
+  long right_key;
+
+  for(;;) {
+    if(join.left_needed) {
+      result = storage_get_row(handle->left_rel, &handle->tuple_id, left_row);
+      if(DB_ERROR(result)) {
+        PRINTF("DB: Failed to get a row in left relation %s!\n",
+               handle->left_rel->name);
+        return result;
+      } else if(result == DB_FINISHED) {
+        return DB_FINISHED;
+      }
+      handle->tuple_id++;
+      join.left_needed = 0;
+
+      join.left_key = join_key(handle->left_join_attr, join.left_key_ptr);
+      if(join.run_valid && join.left_key == join.run_key) {
+        join.right_tuple_id = join.run_start;
+      }
+    }
+
+    result = storage_get_row(handle->right_rel, &join.right_tuple_id,
+                             right_row);
+    if(DB_ERROR(result)) {
+      PRINTF("DB: Failed to get a row in right relation %s!\n",
+             handle->right_rel->name);
+      return result;
+    } else if(result == DB_FINISHED) {
+      /* Only the left rows that belong to the current run can match. */
+      if(!join.run_valid || join.left_key != join.run_key) {
+        return DB_FINISHED;
+      }
+      join.left_needed = 1;
+      continue;
+    }
+
+    right_key = join_key(handle->right_join_attr, join.right_key_ptr);
+    if(right_key < join.left_key) {
+      join.right_tuple_id++;
+    } else if(right_key > join.left_key) {
+      join.left_needed = 1;
+    } else {
+      if(!join.run_valid || join.run_key != join.left_key) {
+        join.run_valid = 1;
+        join.run_key = join.left_key;
+        join.run_start = join.right_tuple_id;
+      }
+      join.right_tuple_id++;
+      return emit_join_row(handle);
+    }
+  }
+}
+
 db_result_t
 relation_process_join(void *handle_ptr)
 {
@@ -966,17 +1676,21 @@ relation_process_join(void *handle_ptr)
   db_result_t result;
   relation_t *left_rel;
   relation_t *right_rel;
-  relation_t *join_rel;
-  unsigned char *join_next_attribute_ptr;
-  size_t element_size;
   tuple_id_t right_tuple_id;
   attribute_value_t value;
-  int i;
 
   handle = (db_handle_t *)handle_ptr;
   left_rel = handle->left_rel;
   right_rel = handle->right_rel;
-  join_rel = handle->join_rel;
+
+  switch(handle->join_strategy) {
+  case DB_JOIN_HASH:
+    return process_hash_join(handle);
+  case DB_JOIN_MERGE:
+    return process_merge_join(handle);
+  default:
+    break;
+  }
 
   if(!(handle->flags & DB_HANDLE_FLAG_INDEX_STEP)) {
     goto inner_loop;
@@ -1030,25 +1744,7 @@ inner_loop:
         return DB_IMPLEMENTATION_ERROR;
       }
 
-      /* Use the source attribute map to fill in the physical representation
-	 of the resulting tuple. */
-      join_next_attribute_ptr = join_row;
-
-      for(i = 0; i < join_rel->attribute_count; i++) {
-	element_size = source_map[i].attr->element_size;
-
-	memcpy(join_next_attribute_ptr, source_map[i].from_ptr, element_size);
-	join_next_attribute_ptr += element_size;
-      }
-
-      if(((aql_adt_t *)handle->adt)->flags & AQL_FLAG_ASSIGN) {
-        if(DB_ERROR(storage_put_row(join_rel, join_row))) {
-          return DB_STORAGE_ERROR;
-        }
-      }
-
-      handle->current_row++;
-      return DB_GOT_ROW;
+      return emit_join_row(handle);
     }
   }
 
@@ -1061,6 +1757,8 @@ generate_join_result(db_handle_t *handle)
   relation_t *left_rel;
   relation_t *right_rel;
   relation_t *join_rel;
+  unsigned char *left_ptr;
+  unsigned char *right_ptr;
   attribute_t *attr;
   attribute_t *result_attr;
   struct source_map *source_pair;
@@ -1071,8 +1769,19 @@ generate_join_result(db_handle_t *handle)
   handle->tuple = (tuple_t)join_row;
   handle->tuple_id = 0;
 
-  left_rel = handle->left_rel;
-  right_rel = handle->right_rel;
+  /* Attributes that exist in both relations are taken from the left
+     relation of the query, even if plan_join() has swapped them. */
+  if(handle->flags & DB_HANDLE_FLAG_JOIN_SWAPPED) {
+    left_rel = handle->right_rel;
+    left_ptr = right_row;
+    right_rel = handle->left_rel;
+    right_ptr = left_row;
+  } else {
+    left_rel = handle->left_rel;
+    left_ptr = left_row;
+    right_rel = handle->right_rel;
+    right_ptr = right_row;
+  }
   join_rel = handle->join_rel;
 
   /* Generate a map over the source attributes for each
@@ -1084,10 +1793,10 @@ generate_join_result(db_handle_t *handle)
     attr = attribute_find(left_rel, result_attr->name);
     if(attr != NULL) {
       offset = get_attribute_value_offset(left_rel, attr);
-      from_ptr = left_row + offset;
+      from_ptr = left_ptr + offset;
     } else if((attr = attribute_find(right_rel, result_attr->name)) != NULL) {
       offset = get_attribute_value_offset(right_rel, attr);
-      from_ptr = right_row + offset;
+      from_ptr = right_ptr + offset;
     } else {
       PRINTF("DB: The attribute %s could not be found\n", result_attr->name);
       return DB_NAME_ERROR;
@@ -1107,6 +1816,102 @@ generate_join_result(db_handle_t *handle)
   return DB_OK;
 }
 
+static int
+is_sorted(attribute_t *attr)
+{
+  /* An inline index declares that the attribute values are stored 
+     in ascending order. */
+  return index_exists(attr) && 
+         ((index_t *)attr->index)->type == INDEX_INLINE;
+}
+
+static void
+swap_join_relations(db_handle_t *handle)
+{
+  relation_t *rel;
+  attribute_t *attr;
+
+  rel = handle->left_rel;
+  handle->left_rel = handle->right_rel;
+  handle->right_rel = rel;
+
+  attr = handle->left_join_attr;
+  handle->left_join_attr = handle->right_join_attr;
+  handle->right_join_attr = attr;
+
+  handle->flags ^= DB_HANDLE_FLAG_JOIN_SWAPPED;
+}
+
+/*
+ * Choose a join strategy. A merge join is preferred when both 
+ * relations are sorted on the join attribute, because it needs neither 
+ * RAM nor random reads. Otherwise, an index on either attribute is used 
+ * for an index nested-loop join. Without indexes, the smaller relation 
+ * is put in a hash table.
+ */
+static db_result_t
+plan_join(db_handle_t *handle)
+{
+  attribute_t *left_attr;
+  attribute_t *right_attr;
+  unsigned entry_size;
+
+  left_attr = handle->left_join_attr;
+  right_attr = handle->right_join_attr;
+
+  if(is_sorted(left_attr) && is_sorted(right_attr)) {
+    handle->join_strategy = DB_JOIN_MERGE;
+  } else if(index_exists(right_attr)) {
+    handle->join_strategy = DB_JOIN_INDEX;
+  } else if(index_exists(left_attr)) {
+    handle->join_strategy = DB_JOIN_INDEX;
+    swap_join_relations(handle);
+  } else {
+    handle->join_strategy = DB_JOIN_HASH;
+    if(relation_cardinality(handle->left_rel) <
+       relation_cardinality(handle->right_rel)) {
+      swap_join_relations(handle);
+    }
+  }
+
+  PRINTF("DB: Join strategy %d\n", handle->join_strategy);
+
+  if(handle->join_strategy == DB_JOIN_INDEX) {
+    return DB_OK;
+  }
+
+  if((left_attr->domain != DOMAIN_INT && left_attr->domain != DOMAIN_LONG) ||
+     (right_attr->domain != DOMAIN_INT && right_attr->domain != DOMAIN_LONG)) {
+    PRINTF("DB: Only integer attributes can be joined without an index\n");
+    return DB_TYPE_ERROR;
+  }
+
+  memset(&join, 0, sizeof(join));
+  join.left_key_ptr = left_row + 
+    get_attribute_value_offset(handle->left_rel, handle->left_join_attr);
+  join.right_key_ptr = right_row + 
+    get_attribute_value_offset(handle->right_rel, handle->right_join_attr);
+  join.left_needed = 1;
+  join.build_needed = 1;
+
+  if(handle->join_strategy == DB_JOIN_HASH) {
+    entry_size = sizeof(struct join_entry) + handle->right_rel->row_length;
+    entry_size = (entry_size + sizeof(long) - 1) & ~(sizeof(long) - 1);
+    join.entry_size = entry_size;
+    if(sizeof(join_memory) / entry_size > 0xffff) {
+      join.capacity = 0xffff;
+    } else {
+      join.capacity = sizeof(join_memory) / entry_size;
+    }
+    if(join.capacity == 0) {
+      PRINTF("DB: The join memory cannot hold a single row\n");
+      return DB_LIMIT_ERROR;
+    }
+  }
+
+  return DB_OK;
+}
+
 db_result_t
 relation_join(void *query_result, void *adt_ptr)
 {
@@ -1120,6 +1925,7 @@ relation_join(void *query_result, void *adt_ptr)
   int i;
   char *attribute_name;
   attribute_t *attr;
+  db_result_t result;
 
   adt = (aql_adt_t *)adt_ptr;
 
@@ -1158,11 +1964,6 @@ relation_join(void *query_result, void *adt_ptr)
     return DB_RELATIONAL_ERROR;
   }
 
-  if(!index_exists(handle->right_join_attr)) {
-    PRINTF("DB: The attribute to join on is not indexed\n");
-    return DB_INDEX_ERROR;
-  }
-
   /*
    * Define the resulting relation. We start from 1 when counting attributes
    * because the first attribute is only the one to join, and is not included
@@ -1189,6 +1990,13 @@ relation_join(void *query_result, void *adt_ptr)
     handle->ncolumns++;
   }
 
+  /* The projection has been resolved against the relations in the
+     order of the query, so plan_join() may now swap them. */
+  result = plan_join(handle);
+  if(DB_ERROR(result)) {
+    return result;
+  }
+
   return generate_join_result(handle);
 }
 #endif /* DB_FEATURE_JOIN */
@@ -68,6 +68,35 @@ struct index_record {
 
 #define ROW_XOR 0xf6U
 
+struct storage_stats storage_stats;
+
+#if DB_STORAGE_BUFFER_SIZE > 0
+/*
+ * Rows are read from the tuple file in blocks, so that a sequential
+ * scan issues one file system call per block instead of several per
+ * row. If DB_STORAGE_WRITE_BUFFER is set, appended rows are collected 
+ * in a separate buffer and written as one block when the buffer is 
+ * full, when the relation is read from or unloaded, or when rows are 
+ * appended to another relation.
+ */
+struct row_buffer {
+  db_storage_id_t fd;
+  size_t row_length;
+  tuple_id_t first_row;
+  tuple_id_t row_count;
+  unsigned char data[DB_STORAGE_BUFFER_SIZE];
+};
+
+static struct row_buffer read_buffer = {-1};
+#if DB_STORAGE_WRITE_BUFFER
+static struct row_buffer write_buffer = {-1};
+#endif
+
+/* The number of rows in the file of the read buffer, cached during
+   a scan. */
+static tuple_id_t read_file_rows = INVALID_TUPLE;
+#endif /* DB_STORAGE_BUFFER_SIZE > 0 */
+
 static void
 merge_strings(char *dest, char *prefix, char *suffix)
 {
@@ -75,6 +104,149 @@ merge_strings(char *dest, char *prefix, char *suffix)
   strcat(dest, suffix);
 }
 
+#if DB_STORAGE_WRITE_BUFFER
+static db_result_t
+flush_write_buffer(void)
+{
+  cfs_offset_t end;
+  unsigned char *ptr;
+  unsigned remaining;
+  int r;
+#if DB_FEATURE_INTEGRITY
+  int missing_bytes;
+  unsigned char buf[write_buffer.row_length];
+#endif
+
+  if(write_buffer.fd < 0 || write_buffer.row_count == 0) {
+    return DB_OK;
+  }
+
+  end = cfs_seek(write_buffer.fd, 0, CFS_SEEK_END);
+  if(end == (cfs_offset_t)-1) {
+    return DB_STORAGE_ERROR;
+  }
+
+#if DB_FEATURE_INTEGRITY
+  missing_bytes = end % write_buffer.row_length;
+  if(missing_bytes > 0) {
+    memset(buf, 0xff, sizeof(buf));
+    r = cfs_write(write_buffer.fd, buf, sizeof(buf));
+    if(r != missing_bytes) {
+      return DB_STORAGE_ERROR;
+    }
+  }
+#endif
+
+  ptr = write_buffer.data;
+  remaining = write_buffer.row_count * write_buffer.row_length;
+  do {
+    r = cfs_write(write_buffer.fd, ptr, remaining);
+    if(r < 0) {
+      PRINTF("DB: Failed to store %u bytes\n", remaining);
+      return DB_STORAGE_ERROR;
+    }
+    ptr += r;
+    remaining -= r;
+  } while(remaining > 0);
+
+  PRINTF("DB: Stored %u rows of %u bytes\n",
+         (unsigned)write_buffer.row_count, (unsigned)write_buffer.row_length);
+
+  if(read_buffer.fd == write_buffer.fd) {
+    read_file_rows = INVALID_TUPLE;
+  }
+  write_buffer.row_count = 0;
+
+  return DB_OK;
+}
+#endif /* DB_STORAGE_WRITE_BUFFER */
+
+#if DB_STORAGE_BUFFER_SIZE > 0
+static db_result_t
+flush_rows(relation_t *rel)
+{
+#if DB_STORAGE_WRITE_BUFFER
+  if(write_buffer.fd == rel->tuple_storage) {
+    return flush_write_buffer();
+  }
+#endif
+  return DB_OK;
+}
+
+static void
+discard_rows(relation_t *rel)
+{
+  if(read_buffer.fd == rel->tuple_storage) {
+    read_buffer.fd = -1;
+    read_file_rows = INVALID_TUPLE;
+  }
+#if DB_STORAGE_WRITE_BUFFER
+  if(write_buffer.fd == rel->tuple_storage) {
+    write_buffer.fd = -1;
+    write_buffer.row_count = 0;
+  }
+#endif
+}
+
+static db_result_t
+fill_read_buffer(relation_t *rel, tuple_id_t tuple_id)
+{
+  tuple_id_t rows;
+  unsigned char *ptr;
+  unsigned remaining;
+  int r;
+
+  if(read_buffer.fd != rel->tuple_storage ||
+     read_buffer.row_length != rel->row_length) {
+    read_buffer.fd = rel->tuple_storage;
+    read_buffer.row_length = rel->row_length;
+    read_file_rows = INVALID_TUPLE;
+  }
+  read_buffer.row_count = 0;
+
+  if(read_file_rows == INVALID_TUPLE || tuple_id >= read_file_rows) {
+    if(DB_ERROR(storage_get_row_amount(rel, &read_file_rows))) {
+      read_file_rows = INVALID_TUPLE;
+      return DB_STORAGE_ERROR;
+    }
+  }
+
+  if(tuple_id >= read_file_rows) {
+    return DB_FINISHED;
+  }
+
+  rows = sizeof(read_buffer.data) / rel->row_length;
+  if(rows > read_file_rows - tuple_id) {
+    rows = read_file_rows - tuple_id;
+  }
+
+  if(cfs_seek(rel->tuple_storage, tuple_id * rel->row_length, CFS_SEEK_SET) ==
+              (cfs_offset_t)-1) {
+    return DB_STORAGE_ERROR;
+  }
+
+  ptr = read_buffer.data;
+  remaining = rows * rel->row_length;
+  while(remaining > 0) {
+    storage_stats.row_reads++;
+    r = cfs_read(rel->tuple_storage, ptr, remaining);
+    if(r <= 0) {
+      PRINTF("DB: Reading failed on fd %d\n", rel->tuple_storage);
+      return DB_STORAGE_ERROR;
+    }
+    ptr += r;
+    remaining -= r;
+  }
+
+  read_buffer.first_row = tuple_id;
+  read_buffer.row_count = rows;
+
+  PRINTF("DB: Read %u rows from relation %s\n", (unsigned)rows, rel->name);
+
+  return DB_OK;
+}
+#endif /* DB_STORAGE_BUFFER_SIZE > 0 */
+
 char *
 storage_generate_file(char *prefix, unsigned long size)
 {
@@ -103,6 +275,12 @@ storage_generate_file(char *prefix, unsigned long size)
 db_result_t
 storage_load(relation_t *rel)
 {
+  if(rel->tuple_storage >= 0) {
+    /* The relation is already loaded by another reference. Keeping the
+       open file also keeps the buffered rows of the relation valid. */
+    return DB_OK;
+  }
+
   PRINTF("DB: Opening the tuple file %s\n", rel->tuple_filename);
   rel->tuple_storage = cfs_open(rel->tuple_filename,
                                 CFS_READ | CFS_WRITE | CFS_APPEND);
@@ -114,15 +292,37 @@ storage_load(relation_t *rel)
   return DB_OK;
 }
 
-void
+db_result_t
 storage_unload(relation_t *rel)
 {
+  db_result_t result;
+
+  result = DB_OK;
   if(RELATION_HAS_TUPLES(rel)) {
     PRINTF("DB: Unload tuple file %s\n", rel->tuple_filename);
 
+#if DB_STORAGE_BUFFER_SIZE > 0
+    result = flush_rows(rel);
+    if(DB_ERROR(result)) {
+      PRINTF("DB: Failed to store the buffered rows of %s\n", rel->name);
+    }
+    discard_rows(rel);
+#endif /* DB_STORAGE_BUFFER_SIZE > 0 */
+
     cfs_close(rel->tuple_storage);
     rel->tuple_storage = -1;
   }
+  return result;
+}
+
+db_result_t
+storage_flush(void)
+{
+#if DB_STORAGE_WRITE_BUFFER
+  return flush_write_buffer();
+#else
+  return DB_OK;
+#endif /* DB_STORAGE_WRITE_BUFFER */
 }
 
 db_result_t
@@ -279,6 +479,15 @@ storage_put_attribute(relation_t *rel, attribute_t *attr)
 db_result_t
 storage_drop_relation(relation_t *rel, int remove_tuples)
 {
+#if DB_STORAGE_BUFFER_SIZE > 0
+  if(RELATION_HAS_TUPLES(rel)) {
+    if(!remove_tuples && DB_ERROR(flush_rows(rel))) {
+      return DB_STORAGE_ERROR;
+    }
+    discard_rows(rel);
+  }
+#endif /* DB_STORAGE_BUFFER_SIZE > 0 */
+
   if(remove_tuples && RELATION_HAS_TUPLES(rel)) {
     cfs_remove(rel->tuple_filename);
   }
@@ -406,6 +615,29 @@ storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row)
   int r;
   tuple_id_t nrows;
 
+#if DB_STORAGE_BUFFER_SIZE > 0
+  if(rel->row_length <= sizeof(read_buffer.data)) {
+    if(DB_ERROR(flush_rows(rel))) {
+      return DB_STORAGE_ERROR;
+    }
+
+    if(read_buffer.fd != rel->tuple_storage ||
+       read_buffer.row_length != rel->row_length ||
+       *tuple_id < read_buffer.first_row ||
+       *tuple_id >= read_buffer.first_row + read_buffer.row_count) {
+      r = fill_read_buffer(rel, *tuple_id);
+      if(r != DB_OK) {
+        return r;
+      }
+    }
+
+    memcpy(row, &read_buffer.data[(*tuple_id - read_buffer.first_row) *
+                                  rel->row_length], rel->row_length);
+    row[rel->row_length - 1] ^= ROW_XOR;
+    return DB_OK;
+  }
+#endif /* DB_STORAGE_BUFFER_SIZE > 0 */
+
   if(DB_ERROR(storage_get_row_amount(rel, &nrows))) {
     return DB_STORAGE_ERROR;
   }
@@ -419,6 +651,7 @@ storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row)
     return DB_STORAGE_ERROR;
   }
 
+  storage_stats.row_reads++;
   r = cfs_read(rel->tuple_storage, row, rel->row_length);
   if(r < 0) {
     PRINTF("DB: Reading failed on fd %d\n", rel->tuple_storage);
@@ -448,6 +681,33 @@ storage_put_row(relation_t *rel, storage_row_t row)
   int missing_bytes;
   char buf[rel->row_length];
 #endif
+#if DB_STORAGE_WRITE_BUFFER
+  unsigned char *buffered_row;
+#endif
+
+  storage_stats.rows_written++;
+
+#if DB_STORAGE_WRITE_BUFFER
+  if(rel->row_length <= sizeof(write_buffer.data)) {
+    if(write_buffer.fd != rel->tuple_storage ||
+       write_buffer.row_length != rel->row_length ||
+       (write_buffer.row_count + 1) * rel->row_length >
+       sizeof(write_buffer.data)) {
+      if(DB_ERROR(flush_write_buffer())) {
+        return DB_STORAGE_ERROR;
+      }
+      write_buffer.fd = rel->tuple_storage;
+      write_buffer.row_length = rel->row_length;
+    }
+
+    buffered_row = &write_buffer.data[write_buffer.row_count *
+                                      rel->row_length];
+    memcpy(buffered_row, row, rel->row_length);
+    buffered_row[rel->row_length - 1] ^= ROW_XOR;
+    write_buffer.row_count++;
+    return DB_OK;
+  }
+#endif /* DB_STORAGE_WRITE_BUFFER */
 
   end = cfs_seek(rel->tuple_storage, 0, CFS_SEEK_END);
   if(end == (cfs_offset_t)-1) {
@@ -494,6 +754,12 @@ storage_get_row_amount(relation_t *rel, tuple_id_t *amount)
 {
   cfs_offset_t offset;
 
+#if DB_STORAGE_BUFFER_SIZE > 0
+  if(DB_ERROR(flush_rows(rel))) {
+    return DB_STORAGE_ERROR;
+  }
+#endif /* DB_STORAGE_BUFFER_SIZE > 0 */
+
   if(rel->row_length == 0) {
     *amount = 0;
   } else {
@@ -535,6 +801,9 @@ storage_read(db_storage_id_t fd,
   char *ptr;
   int r;
 
+  storage_stats.reads++;
+  storage_stats.bytes_read += length;
+
   /* Extend the file if necessary, so that previously unwritten bytes
      will be read in as zeroes. */
   if(cfs_seek(fd, offset + length, CFS_SEEK_SET) == (cfs_offset_t)-1) {
@@ -565,6 +834,9 @@ storage_write(db_storage_id_t fd,
   char *ptr;
   int r;
 
+  storage_stats.writes++;
+  storage_stats.bytes_written += length;
+
   if(cfs_seek(fd, offset, CFS_SEEK_SET) == (cfs_offset_t)-1) {
     return DB_STORAGE_ERROR;
   }
@@ -50,10 +50,27 @@
 
 typedef unsigned char * storage_row_t;
 
+/* Counters for the I/O that indexes issue through storage_read() and
+   storage_write(), for the reads from tuple files, for the rows 
+   that are stored in relations, and for the index files that are
+   rewritten to reclaim space. */
+struct storage_stats {
+  unsigned long reads;
+  unsigned long writes;
+  unsigned long bytes_read;
+  unsigned long bytes_written;
+  unsigned long row_reads;
+  unsigned long rows_written;
+  unsigned long compactions;
+};
+
+extern struct storage_stats storage_stats;
+
 char *storage_generate_file(char *, unsigned long);
 
 db_result_t storage_load(relation_t *);
-void storage_unload(relation_t *);
+db_result_t storage_unload(relation_t *);
+db_result_t storage_flush(void);
 
 db_result_t storage_get_relation(relation_t *, char *);
 db_result_t storage_put_relation(relation_t *);
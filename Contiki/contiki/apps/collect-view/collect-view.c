@@ -104,3 +104,24 @@ collect_view_construct_message(struct collect_view_data_msg *msg,
   collect_view_arch_read_sensors(msg);
 }
 /*---------------------------------------------------------------------------*/
+int
+collect_view_batch_add(struct telemetry_batch *b, uint32_t seqno,
+                       const struct collect_view_data_msg *msg)
+{
+  uint32_t values[TELEMETRY_COLLECT_VIEW_FIELDS];
+  const uint16_t *fields;
+  int i;
+
+  /* The fields of the message after its length are in schema order. */
+  fields = &msg->clock;
+  for(i = 0; i < TELEMETRY_COLLECT_VIEW_FIELDS; i++) {
+    values[i] = fields[i];
+  }
+
+  if(telemetry_records(b) == 0) {
+    telemetry_start(b, &telemetry_collect_view_schema, seqno,
+                    TELEMETRY_FLAG_SKIP);
+  }
+  return telemetry_add(b, values);
+}
+/*---------------------------------------------------------------------------*/
@@ -4,6 +4,7 @@
 #include "contiki-conf.h"
 #include "net/rime/rimeaddr.h"
 #include "net/rime/collect.h"
+#include "telemetry.h"
 
 struct collect_view_data_msg {
   uint16_t len;
@@ -31,4 +32,18 @@ void collect_view_construct_message(struct collect_view_data_msg *msg,
 
 void collect_view_arch_read_sensors(struct collect_view_data_msg *msg);
 
+/**
+ * \brief      Add a message to a telemetry batch.
+ * \param b    The batch, which must have room for
+ *             TELEMETRY_COLLECT_VIEW_FIELDS fields.
+ * \param seqno The sequence number of the message.
+ * \param msg  The message.
+ * \return     1 if the message was added, or 0 if the batch is full.
+ *
+ *             A batch with no records is started anew, so that the
+ *             sequence number of its first record is seqno.
+ */
+int collect_view_batch_add(struct telemetry_batch *b, uint32_t seqno,
+                           const struct collect_view_data_msg *msg);
+
 #endif /* COLLECT_VIEW_H */
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2007, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *	A streaming patcher for Deluge delta updates.
+ */
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+#include "lib/crc16.h"
+#include "net/rime.h"
+#include "deluge.h"
+#include "deluge-patch.h"
+
+#include <string.h>
+
+#define DEBUG	0
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...)	printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+/* The number of bytes that are read from the patch at once. */
+#ifdef DELUGE_PATCH_CONF_READ_SIZE
+#define READ_SIZE	DELUGE_PATCH_CONF_READ_SIZE
+#else
+#define READ_SIZE	32
+#endif
+
+static const unsigned char magic[] = {'D', 'L', 'P', '1'};
+
+static struct {
+  int fd;
+  unsigned char buf[READ_SIZE];
+  unsigned char pos;
+  unsigned char len;
+} patch_in;
+
+/* The new file is written a page at a time from this buffer, which
+   also holds the base file while its CRC is checked. */
+static unsigned char page[S_PAGE];
+
+/*---------------------------------------------------------------------------*/
+static int
+next_byte(void)
+{
+  int len;
+
+  if(patch_in.pos == patch_in.len) {
+    len = cfs_read(patch_in.fd, patch_in.buf, sizeof(patch_in.buf));
+    if(len <= 0) {
+      return -1;
+    }
+    patch_in.len = len;
+    patch_in.pos = 0;
+  }
+  return patch_in.buf[patch_in.pos++];
+}
+/*---------------------------------------------------------------------------*/
+static int
+read_varint(uint32_t *value)
+{
+  int b, shift;
+
+  *value = 0;
+  for(shift = 0; shift < 32; shift += 7) {
+    b = next_byte();
+    if(b < 0) {
+      return -1;
+    }
+    *value |= (uint32_t)(b & 0x7f) << shift;
+    if(!(b & 0x80)) {
+      return 0;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+read_crc(uint16_t *crc)
+{
+  int lo, hi;
+
+  lo = next_byte();
+  hi = next_byte();
+  if(lo < 0 || hi < 0) {
+    return -1;
+  }
+  *crc = lo | hi << 8;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+check_base(int fd, uint32_t size, uint16_t crc)
+{
+  uint32_t offset;
+  int len;
+  uint16_t acc;
+
+  acc = 0;
+  for(offset = 0; offset < size; offset += len) {
+    len = size - offset > S_PAGE ? S_PAGE : size - offset;
+    if(cfs_read(fd, page, len) != len) {
+      return -1;
+    }
+    acc = crc16_data(page, len, acc);
+  }
+  return acc == crc ? 0 : -1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+apply(int base_fd, int target_fd, uint32_t base_size,
+      uint32_t target_size, uint16_t target_crc)
+{
+  uint32_t written, length, distance, aligned;
+  int32_t offset;
+  unsigned fill, n, i;
+  int op, c;
+  uint16_t crc;
+
+  written = aligned = 0;
+  fill = 0;
+  crc = 0;
+
+  while(written + fill < target_size) {
+    op = next_byte();
+    if(op < 0) {
+      return -1;
+    }
+    length = op & DELUGE_PATCH_LENGTH_MASK;
+    if(length == DELUGE_PATCH_LENGTH_MASK) {
+      if(read_varint(&distance) < 0) {
+	return -1;
+      }
+      length += distance;
+    }
+    if(length > target_size - written - fill) {
+      return -1;
+    }
+
+    if(op & DELUGE_PATCH_COPY) {
+      if(read_varint(&distance) < 0) {
+	return -1;
+      }
+      /* Zigzag decoding. */
+      offset = aligned + ((distance >> 1) ^ -(int32_t)(distance & 1));
+      if(offset < 0 || (uint32_t)offset > base_size ||
+	 length > base_size - offset ||
+	 cfs_seek(base_fd, offset, CFS_SEEK_SET) != offset) {
+	return -1;
+      }
+      aligned = offset + length;
+    } else {
+      aligned += length;
+    }
+
+    while(length > 0) {
+      n = S_PAGE - fill < length ? S_PAGE - fill : length;
+      if(op & DELUGE_PATCH_COPY) {
+	if(cfs_read(base_fd, &page[fill], n) != n) {
+	  return -1;
+	}
+      } else {
+	for(i = 0; i < n; i++) {
+	  c = next_byte();
+	  if(c < 0) {
+	    return -1;
+	  }
+	  page[fill + i] = c;
+	}
+      }
+      fill += n;
+      length -= n;
+
+      if(fill == S_PAGE || written + fill == target_size) {
+	if(cfs_write(target_fd, page, fill) != fill) {
+	  return -1;
+	}
+	crc = crc16_data(page, fill, crc);
+	written += fill;
+	fill = 0;
+      }
+    }
+  }
+
+  return crc == target_crc ? 0 : -1;
+}
+/*---------------------------------------------------------------------------*/
+int
+deluge_patch(const char *patch, const char *base, const char *target)
+{
+  unsigned char header[sizeof(magic)];
+  uint32_t base_size, target_size;
+  uint16_t base_crc, target_crc;
+  int base_fd, target_fd, i, ret;
+
+  if(strcmp(base, target) == 0) {
+    return -1;
+  }
+
+  patch_in.fd = cfs_open(patch, CFS_READ);
+  if(patch_in.fd < 0) {
+    return -1;
+  }
+  patch_in.pos = patch_in.len = 0;
+
+  ret = -1;
+  base_fd = target_fd = -1;
+
+  for(i = 0; i < sizeof(header); i++) {
+    header[i] = next_byte();
+  }
+  if(memcmp(header, magic, sizeof(magic)) != 0 ||
+     read_varint(&base_size) < 0 || read_crc(&base_crc) < 0 ||
+     read_varint(&target_size) < 0 || read_crc(&target_crc) < 0) {
+    PRINTF("deluge-patch: %s is not a patch\n", patch);
+    goto out;
+  }
+
+  base_fd = cfs_open(base, CFS_READ);
+  if(base_fd < 0 || check_base(base_fd, base_size, base_crc) < 0) {
+    PRINTF("deluge-patch: %s is not the base of %s\n", base, patch);
+    goto out;
+  }
+
+  /* Reserve the whole file, so that Coffee does not have to move it
+     to a larger area while the pages are written. */
+  cfs_remove(target);
+  if(cfs_coffee_reserve(target, target_size) < 0) {
+    PRINTF("deluge-patch: no room for %s\n", target);
+    goto out;
+  }
+  target_fd = cfs_open(target, CFS_WRITE);
+  if(target_fd < 0) {
+    goto out;
+  }
+
+  ret = apply(base_fd, target_fd, base_size, target_size, target_crc);
+  PRINTF("deluge-patch: %s %s\n", target, ret == 0 ? "written" : "failed");
+
+out:
+  cfs_close(patch_in.fd);
+  if(base_fd >= 0) {
+    cfs_close(base_fd);
+  }
+  if(target_fd >= 0) {
+    cfs_close(target_fd);
+    if(ret < 0) {
+      cfs_remove(target);
+    }
+  }
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
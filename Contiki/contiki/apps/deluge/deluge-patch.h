@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2007, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *	Delta updates for Deluge. A patch describes a new file as
+ *	copies from a base file and literal bytes, so that an update of
+ *	a module or an image only disseminates what has changed.
+ *
+ *	Patch format:
+ *	  4 bytes   magic "DLP1"
+ *	  varint    size of the base file
+ *	  2 bytes   CRC16 of the base file, little-endian
+ *	  varint    size of the new file
+ *	  2 bytes   CRC16 of the new file, little-endian
+ *	followed by instructions until the new file is complete. The first
+ *	byte of an instruction has the COPY flag in its top bit and a
+ *	length in the other bits; a length of 127 is followed by a varint
+ *	with the rest of the length. A copy is followed by a signed varint
+ *	with the distance of its base offset from the offset that is
+ *	aligned with the output, which is where the previous copy ended
+ *	plus the literal bytes since then. Other instructions are
+ *	followed by their literal bytes.
+ *
+ *	Varints hold 7 bits in each byte, least significant first, with
+ *	the top bit set in all bytes but the last. Signed values are
+ *	zigzag encoded.
+ *
+ *	Patches are made with tools/deluge-diff.
+ */
+
+#ifndef DELUGE_PATCH_H
+#define DELUGE_PATCH_H
+
+#define DELUGE_PATCH_COPY		0x80
+#define DELUGE_PATCH_LENGTH_MASK	0x7f
+
+/**
+ * \brief	Reconstruct a file from a base file and a patch.
+ * \param patch	The name of the patch file. The patch may be followed by
+ *		padding, such as the rest of a Deluge page.
+ * \param base	The name of the file that the patch was made from, which
+ *		may also be padded.
+ * \param target The name of the file to create, which must differ from
+ *		the base file.
+ * \return	0 if the new file was written and its CRC matches the
+ *		patch, or -1 otherwise.
+ *
+ *		The patch and the base file are read in small blocks and the
+ *		new file is written a Deluge page at a time, so that the RAM
+ *		that is needed does not depend on the size of the files.
+ */
+int deluge_patch(const char *patch, const char *base, const char *target);
+
+#endif /* !DELUGE_PATCH_H */
@@ -47,8 +47,8 @@
 #include "loader/elfloader.h"
 #include "lib/crc16.h"
 #include "lib/random.h"
-#include "node-id.h"
 #include "deluge.h"
+#include "deluge-patch.h"
 
 #if NETSIM
 #include "ether.h"
@@ -91,6 +91,12 @@ static struct ctimer profile_timer;
    the next_object_id parameter. */
 static deluge_object_id_t next_object_id;
 
+/* If the object is a patch, the file that it applies to and the file
+   that is built from them when an update has been received. The
+   object keeps its old version until the patch has been applied. */
+static char *patch_base;
+static char *patch_target;
+
 /* Rime callbacks. */
 static void broadcast_recv(struct broadcast_conn *, const rimeaddr_t *);
 static void unicast_recv(struct unicast_conn *, const rimeaddr_t *);
@@ -476,10 +482,16 @@ handle_packet(struct deluge_msg_packet *msg)
       current_object.current_rx_page++;
 
       if(packet.pagenum == OBJECT_PAGE_COUNT(current_object) - 1) {
-	current_object.version = current_object.update_version;
-	leds_on(LEDS_RED);
 	PRINTF("Update completed for object %u, version %u\n", 
 	       (unsigned)current_object.object_id, packet.version);
+	if(patch_target == NULL) {
+	  current_object.version = current_object.update_version;
+	  leds_on(LEDS_RED);
+	} else {
+	  /* Patching takes too long for a Rime callback, so the Deluge
+	     process does it. */
+	  process_post(&deluge_process, deluge_event, NULL);
+	}
       } else if(current_object.current_rx_page < OBJECT_PAGE_COUNT(current_object)) {
         if(ctimer_expired(&rx_timer)) {
 	  ctimer_set(&rx_timer,
@@ -497,6 +509,29 @@ handle_packet(struct deluge_msg_packet *msg)
   }
 }
 
+static int
+patch_pending(void)
+{
+  return patch_target != NULL &&
+    current_object.version != current_object.update_version &&
+    highest_available_page(&current_object) ==
+    OBJECT_PAGE_COUNT(current_object);
+}
+
+static void
+apply_patch(void)
+{
+  if(!patch_pending()) {
+    return;
+  }
+  if(deluge_patch(current_object.filename, patch_base, patch_target) == 0) {
+    current_object.version = current_object.update_version;
+    leds_on(LEDS_RED);
+  } else {
+    PRINTF("Failed to apply the patch to %s\n", patch_base);
+  }
+}
+
 static void
 send_profile(struct deluge_object *obj)
 {
@@ -639,6 +674,19 @@ deluge_disseminate(char *file, unsigned version)
   return 0;
 }
 
+int
+deluge_disseminate_patch(char *patch, char *base, char *target,
+			 unsigned version)
+{
+  if(deluge_disseminate(patch, version) < 0) {
+    return -1;
+  }
+  patch_base = base;
+  patch_target = target;
+
+  return 0;
+}
+
 PROCESS_THREAD(deluge_process, ev, data)
 {
   static struct etimer et;
@@ -682,7 +730,21 @@ PROCESS_THREAD(deluge_process, ev, data)
     ctimer_set(&profile_timer, r_rand * CLOCK_SECOND,
 	(void *)(void *)send_profile, &current_object);
 
-    LONG_TIMER(et, time_counter, r_interval);
+    /* A patch that could not be applied is tried again once per
+       round. */
+    if(patch_pending()) {
+      process_post(&deluge_process, deluge_event, NULL);
+    }
+
+    for(time_counter = 0; time_counter < r_interval; time_counter++) {
+      etimer_set(&et, CLOCK_SECOND);
+      do {
+	PROCESS_WAIT_EVENT();
+	if(ev == deluge_event) {
+	  apply_patch();
+	}
+      } while(!etimer_expired(&et));
+    }
   }
 
 exit:
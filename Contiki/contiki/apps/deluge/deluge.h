@@ -157,4 +157,10 @@ struct deluge_page {
 
 int deluge_disseminate(char *file, unsigned version);
 
+/* Disseminate a patch that was made with tools/deluge-diff. When a
+   node has received a new version of the patch, it builds the target
+   file from the base file and the patch. */
+int deluge_disseminate_patch(char *patch, char *base, char *target,
+			     unsigned version);
+
 #endif
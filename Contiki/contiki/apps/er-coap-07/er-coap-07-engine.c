@@ -153,7 +153,11 @@ coap_receive(void)
               if (coap_error_code==NO_ERROR)
               {
                 /* Apply blockwise transfers. */
-                if ( IS_OPTION(message, COAP_OPTION_BLOCK1) && response->code<BAD_REQUEST_4_00 && !IS_OPTION(response, COAP_OPTION_BLOCK1) )
+                if (response->code>=BAD_REQUEST_4_00)
+                {
+                  PRINTF("Blockwise: error response %u is sent as it is\n", response->code);
+                }
+                else if ( IS_OPTION(message, COAP_OPTION_BLOCK1) && !IS_OPTION(response, COAP_OPTION_BLOCK1) )
                 {
                   PRINTF("Block1 NOT IMPLEMENTED\n");
 
@@ -316,6 +320,27 @@ well_known_core_handler(void* request, void* response, uint8_t *buffer, uint16_t
     int len = coap_get_query_variable(request, "rt", &filter);
     char *rt = NULL;
 
+    /* Unfiltered requests are served block-wise from the cached link format. */
+    const char *link_format = NULL;
+    int link_format_len = len ? -1 : rest_get_link_format(&link_format);
+
+    if (link_format_len >= 0)
+    {
+      if (*offset >= link_format_len)
+      {
+        coap_set_status_code(response, BAD_OPTION_4_02);
+        coap_set_payload(response, "BlockOutOfScope", 15);
+        return;
+      }
+
+      bufpos = MIN(link_format_len - *offset, preferred_size);
+      coap_set_payload(response, link_format + *offset, bufpos);
+      coap_set_header_content_type(response, APPLICATION_LINK_FORMAT);
+
+      *offset = (*offset + bufpos < link_format_len) ? *offset + preferred_size : -1;
+      return;
+    }
+
     for (resource = (resource_t*)list_head(rest_get_resources()); resource; resource = resource->next)
     {
       /* Filtering */
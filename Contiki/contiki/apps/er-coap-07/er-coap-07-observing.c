@@ -56,6 +56,18 @@
 MEMB(observers_memb, coap_observer_t, COAP_MAX_OBSERVERS);
 LIST(observers_list);
 
+/*
+ * A notification is serialized once into this buffer, and only the token, MID and type are stamped for each
+ * observer.
+ */
+static uint8_t notification_buffer[COAP_MAX_PACKET_SIZE];
+
+/*-----------------------------------------------------------------------------------*/
+list_t
+coap_get_observers(void)
+{
+  return observers_list;
+}
 /*-----------------------------------------------------------------------------------*/
 coap_observer_t *
 coap_add_observer(uip_ipaddr_t *addr, uint16_t port, const uint8_t *token, size_t token_len, const char *url)
@@ -166,54 +178,155 @@ coap_remove_observer_by_mid(uip_ipaddr_t *addr, uint16_t port, uint16_t mid)
   return removed;
 }
 /*-----------------------------------------------------------------------------------*/
+/* Returns the offset of the Token option in a serialized message, or -1. */
+static int
+find_token_option(const uint8_t *buffer, uint16_t length)
+{
+  int count = buffer[0] & COAP_HEADER_OPTION_COUNT_MASK;
+  int number = 0;
+  uint16_t i = COAP_HEADER_LEN;
+  uint16_t option_len;
+
+  while (count-- > 0 && i < length)
+  {
+    number += buffer[i] >> 4;
+    if (number==COAP_OPTION_TOKEN)
+    {
+      return i;
+    }
+    option_len = buffer[i] & COAP_HEADER_OPTION_SHORT_LENGTH_MASK;
+    if (option_len==15)
+    {
+      option_len += buffer[++i];
+    }
+    i += 1 + option_len;
+  }
+  return -1;
+}
+
+/* Stamps the fields of an observer into the notification. Returns 0 if the token does not fit. */
+static int
+stamp_notification(coap_observer_t *obs, uint8_t type, uint16_t mid, int token_offset, uint16_t *length)
+{
+  uint8_t *token = notification_buffer + token_offset + 1;
+  int current_len = notification_buffer[token_offset] & COAP_HEADER_OPTION_SHORT_LENGTH_MASK;
+
+  if (obs->token_len!=current_len)
+  {
+    if (*length - current_len + obs->token_len > COAP_MAX_PACKET_SIZE)
+    {
+      return 0;
+    }
+    memmove(token + obs->token_len, token + current_len, *length - token_offset - 1 - current_len);
+    *length = *length - current_len + obs->token_len;
+    notification_buffer[token_offset] = (notification_buffer[token_offset] & COAP_HEADER_OPTION_DELTA_MASK) | obs->token_len;
+  }
+  memcpy(token, obs->token, obs->token_len);
+
+  notification_buffer[0] = (notification_buffer[0] & ~COAP_HEADER_TYPE_MASK) | (COAP_HEADER_TYPE_MASK & type<<COAP_HEADER_TYPE_POSITION);
+  notification_buffer[2] = 0xFF & mid>>8;
+  notification_buffer[3] = 0xFF & mid;
+  return 1;
+}
+
 void
 coap_notify_observers(resource_t *resource, uint16_t obs_counter, void *notification)
 {
   coap_packet_t *const coap_res = (coap_packet_t *) notification;
   coap_observer_t* obs = NULL;
+  coap_transaction_t *transaction = NULL;
   uint8_t preferred_type = coap_res->type;
+  uint8_t type;
+  uint8_t refresh;
+  uint16_t length;
+  int token_offset;
+  unsigned long now = clock_seconds(); /* for the refresh timers, read once for all observers */
 
   PRINTF("Observing: Notification from %s\n", resource->url);
 
+  /* Serialize the representation once, with an empty token. */
+  coap_res->mid = 0;
+  coap_set_header_observe(coap_res, obs_counter);
+  coap_set_header_token(coap_res, notification_buffer, 0);
+  if ((length = coap_serialize_message(coap_res, notification_buffer))==0
+      || (token_offset = find_token_option(notification_buffer, length)) < 0)
+  {
+    PRINTF("Observing: Cannot serialize notification\n");
+    return;
+  }
+
   /* Iterate over observers. */
   for (obs = (coap_observer_t*)list_head(observers_list); obs; obs = obs->next)
   {
     if (obs->url==resource->url) /* using RESOURCE url pointer as handle */
     {
-      coap_transaction_t *transaction = NULL;
-
-      /*TODO implement special transaction for CON, sharing the same buffer to allow for more observers. */
-
-      if ( (transaction = coap_new_transaction(coap_get_mid(), &obs->addr, obs->port)) )
+      PRINTF("           Observer ");
+      PRINT6ADDR(&obs->addr);
+      PRINTF(":%u\n", obs->port);
+
+      /*
+       * A CON notification that is still being retransmitted is replaced by the new state, which takes over its
+       * retransmission counter and timeout (RFC 7641, 4.5.2). This limits each observer to one notification in flight.
+       */
+      transaction = coap_get_transaction_by_mid(obs->last_mid);
+      if (transaction && transaction->port==obs->port && uip_ipaddr_cmp(&transaction->addr, &obs->addr))
       {
-        PRINTF("           Observer ");
-        PRINT6ADDR(&obs->addr);
-        PRINTF(":%u\n", obs->port);
-
-        /* Update last MID for RST matching. */
-        obs->last_mid = transaction->mid;
+        if (stamp_notification(obs, COAP_TYPE_CON, coap_get_mid(), token_offset, &length))
+        {
+          PRINTF("           Replacing CON in flight\n");
+          obs->last_mid = (notification_buffer[2]<<8) | notification_buffer[3];
+          coap_set_transaction_mid(transaction, obs->last_mid);
+          memcpy(transaction->packet, notification_buffer, length);
+          transaction->packet_len = length;
+        }
+        continue;
+      }
 
-        /* Prepare response */
-        coap_res->mid = transaction->mid;
-        coap_set_header_observe(coap_res, obs_counter);
-        coap_set_header_token(coap_res, obs->token, obs->token_len);
+      /* Use CON to check whether client is still there/interested after COAP_OBSERVING_REFRESH_INTERVAL. */
+      refresh = (unsigned long)(now - obs->refresh_timer.start) >= obs->refresh_timer.interval;
+      if (refresh)
+      {
+        PRINTF("           Refreshing with CON\n");
+        type = COAP_TYPE_CON;
+      }
+      else
+      {
+        type = preferred_type;
+      }
 
-        /* Use CON to check whether client is still there/interested after COAP_OBSERVING_REFRESH_INTERVAL. */
-        if (stimer_expired(&obs->refresh_timer))
+      if (type==COAP_TYPE_CON)
+      {
+        /* Only confirmable notifications are kept for retransmission. */
+        if ( !(transaction = coap_new_transaction(coap_get_mid(), &obs->addr, obs->port)) )
         {
-          PRINTF("           Refreshing with CON\n");
-          coap_res->type = COAP_TYPE_CON;
-          stimer_restart(&obs->refresh_timer);
+          continue;
         }
-        else
+        if (!stamp_notification(obs, type, transaction->mid, token_offset, &length))
         {
-          coap_res->type = preferred_type;
+          coap_clear_transaction(transaction);
+          continue;
+        }
+        if (refresh)
+        {
+          stimer_restart(&obs->refresh_timer);
         }
 
-        transaction->packet_len = coap_serialize_message(coap_res, transaction->packet);
+        /* Update last MID for RST matching. */
+        obs->last_mid = transaction->mid;
 
+        memcpy(transaction->packet, notification_buffer, length);
+        transaction->packet_len = length;
         coap_send_transaction(transaction);
       }
+      else
+      {
+        if (!stamp_notification(obs, type, coap_get_mid(), token_offset, &length))
+        {
+          continue;
+        }
+        obs->last_mid = (notification_buffer[2]<<8) | notification_buffer[3];
+        coap_send_message(&obs->addr, obs->port, notification_buffer, length);
+      }
     }
   }
 }
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2011, Institute for Pervasive Computing, ETH Zurich
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *      CoAP client for streaming block-wise transfers into CFS
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "er-coap-07-stream.h"
+#include "cfs/cfs.h"
+
+#define DEBUG 0
+#if DEBUG
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+/*----------------------------------------------------------------------------*/
+static void
+coap_stream_request_callback(void *callback_data, void *response)
+{
+  struct coap_stream_state *state = (struct coap_stream_state *) callback_data;
+  state->response = (coap_packet_t *) response;
+  process_poll(state->process);
+}
+/*----------------------------------------------------------------------------*/
+/* Writes a received block at its offset, so that a repeated block does no harm. */
+static int
+write_block(struct coap_stream_state *state)
+{
+  uint32_t res_block = 0;
+  uint16_t res_size = state->block_size;
+  uint8_t *payload;
+  int len;
+
+  state->more = 0;
+  if (!coap_get_header_block2(state->response, &res_block, &state->more, &res_size, NULL) && state->block_num>0)
+  {
+    PRINTF("Stream: block option missing\n");
+    return 0;
+  }
+
+  /* The server may answer with a smaller block size. */
+  if (res_size>state->block_size || res_block*res_size!=state->block_num*state->block_size)
+  {
+    PRINTF("Stream: WRONG BLOCK %lu/%u for %lu/%u\n", res_block, res_size, state->block_num, state->block_size);
+    return 0;
+  }
+
+  len = coap_get_payload(state->response, &payload);
+  if (state->more && len!=res_size)
+  {
+    PRINTF("Stream: short block %lu (%d bytes)\n", res_block, len);
+    return 0;
+  }
+
+  if (cfs_seek(state->fd, res_block*res_size, CFS_SEEK_SET)!=(cfs_offset_t) (res_block*res_size)
+      || cfs_write(state->fd, payload, len)!=len)
+  {
+    PRINTF("Stream: cannot write block %lu\n", res_block);
+    state->more = 0;
+    state->errors = COAP_MAX_ATTEMPTS;
+    return 0;
+  }
+
+  state->length = res_block*res_size + len;
+  state->block_num = res_block + 1;
+  state->block_size = res_size;
+  return 1;
+}
+/*----------------------------------------------------------------------------*/
+PT_THREAD(coap_stream_request(struct coap_stream_state *state, process_event_t ev,
+                              uip_ipaddr_t *remote_ipaddr, uint16_t remote_port,
+                              coap_packet_t *request, int fd))
+{
+  PT_BEGIN(&state->pt);
+
+  state->process = PROCESS_CURRENT();
+  state->block_num = 0;
+  state->block_size = COAP_STREAM_BLOCK_SIZE;
+  state->errors = 0;
+  state->fd = fd;
+  state->length = 0;
+  state->complete = 0;
+
+  do {
+    request->mid = coap_get_mid();
+    if (!(state->transaction = coap_new_transaction(request->mid, remote_ipaddr, remote_port)))
+    {
+      PRINTF("Stream: could not allocate transaction buffer\n");
+      PT_EXIT(&state->pt);
+    }
+    state->transaction->callback = coap_stream_request_callback;
+    state->transaction->callback_data = state;
+    state->response = NULL;
+
+    /* Also the first block is requested explicitly to propose the block size. */
+    coap_set_header_block2(request, state->block_num, 0, state->block_size);
+    state->transaction->packet_len = coap_serialize_message(request, state->transaction->packet);
+    coap_send_transaction(state->transaction);
+
+    PT_YIELD_UNTIL(&state->pt, ev == PROCESS_EVENT_POLL);
+
+    if (!state->response)
+    {
+      PRINTF("Stream: server not responding\n");
+      PT_EXIT(&state->pt);
+    }
+    if (state->response->code!=CONTENT_2_05)
+    {
+      PRINTF("Stream: response code %u\n", state->response->code);
+      PT_EXIT(&state->pt);
+    }
+
+    if (!write_block(state))
+    {
+      /* Ask again for the same block. */
+      state->more = 1;
+      ++(state->errors);
+    }
+  } while (state->more && state->errors<COAP_MAX_ATTEMPTS);
+
+  state->complete = (state->errors<COAP_MAX_ATTEMPTS);
+
+  PT_END(&state->pt);
+}
+/*----------------------------------------------------------------------------*/
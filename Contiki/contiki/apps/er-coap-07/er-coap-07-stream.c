@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2011, Institute for Pervasive Computing, ETH Zurich
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *      CoAP module for streaming block-wise transfers
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "er-coap-07-stream.h"
+
+#define DEBUG 0
+#if DEBUG
+#define PRINTF(...) printf(__VA_ARGS__)
+#define PRINT6ADDR(addr) PRINTF("[%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x]", ((uint8_t *)addr)[0], ((uint8_t *)addr)[1], ((uint8_t *)addr)[2], ((uint8_t *)addr)[3], ((uint8_t *)addr)[4], ((uint8_t *)addr)[5], ((uint8_t *)addr)[6], ((uint8_t *)addr)[7], ((uint8_t *)addr)[8], ((uint8_t *)addr)[9], ((uint8_t *)addr)[10], ((uint8_t *)addr)[11], ((uint8_t *)addr)[12], ((uint8_t *)addr)[13], ((uint8_t *)addr)[14], ((uint8_t *)addr)[15])
+#define PRINTLLADDR(lladdr) PRINTF("[%02x:%02x:%02x:%02x:%02x:%02x]",(lladdr)->addr[0], (lladdr)->addr[1], (lladdr)->addr[2], (lladdr)->addr[3],(lladdr)->addr[4], (lladdr)->addr[5])
+#else
+#define PRINTF(...)
+#define PRINT6ADDR(addr)
+#define PRINTLLADDR(addr)
+#endif
+
+typedef struct coap_stream_cursor {
+  const coap_stream_t *stream; /* NULL for an unused cursor */
+
+  uip_ipaddr_t addr;
+  uint16_t port;
+  uint8_t token_len;
+  uint8_t token[COAP_TOKEN_LEN];
+
+  uint32_t offset; /* the offset in the representation at which the cursor is */
+  uint16_t last_used;
+
+  union {
+    uint8_t bytes[COAP_STREAM_CURSOR_SIZE];
+    void *align_pointer;
+    uint32_t align_long;
+  } cursor;
+} coap_stream_cursor_t;
+
+static coap_stream_cursor_t cursors[COAP_MAX_STREAM_CURSORS];
+static uint16_t use_counter;
+
+/*----------------------------------------------------------------------------*/
+static void
+release_cursor(coap_stream_cursor_t *c)
+{
+  if (c->stream && c->stream->close)
+  {
+    c->stream->close(c->cursor.bytes);
+  }
+  c->stream = NULL;
+}
+/*----------------------------------------------------------------------------*/
+static coap_stream_cursor_t *
+find_cursor(const coap_stream_t *stream, uip_ipaddr_t *addr, uint16_t port, const uint8_t *token, uint8_t token_len)
+{
+  int i;
+
+  for (i = 0; i < COAP_MAX_STREAM_CURSORS; ++i)
+  {
+    if (cursors[i].stream==stream && cursors[i].port==port && uip_ipaddr_cmp(&cursors[i].addr, addr)
+        && cursors[i].token_len==token_len && memcmp(cursors[i].token, token, token_len)==0)
+    {
+      return &cursors[i];
+    }
+  }
+  return NULL;
+}
+/*----------------------------------------------------------------------------*/
+/* Takes a free cursor, or the least recently used one of another transfer. */
+static coap_stream_cursor_t *
+new_cursor(uip_ipaddr_t *addr, uint16_t port, const uint8_t *token, uint8_t token_len)
+{
+  coap_stream_cursor_t *c = &cursors[0];
+  int i;
+
+  for (i = 0; i < COAP_MAX_STREAM_CURSORS; ++i)
+  {
+    if (cursors[i].stream==NULL)
+    {
+      c = &cursors[i];
+      break;
+    }
+    if ((uint16_t)(use_counter - cursors[i].last_used) > (uint16_t)(use_counter - c->last_used))
+    {
+      c = &cursors[i];
+    }
+  }
+
+  PRINTF("Stream: new cursor %u for ", (unsigned) (c - cursors));
+  PRINT6ADDR(addr);
+  PRINTF(":%u\n", uip_ntohs(port));
+
+  release_cursor(c);
+  uip_ipaddr_copy(&c->addr, addr);
+  c->port = port;
+  c->token_len = token_len;
+  memcpy(c->token, token, token_len);
+  return c;
+}
+/*----------------------------------------------------------------------------*/
+/* Reads until the block is full or the representation ends, as only the last block may be smaller. */
+static int
+read_block(coap_stream_cursor_t *c, uint8_t *buffer, uint16_t size, uint8_t *more)
+{
+  int len = 0;
+  int n;
+
+  *more = 1;
+  while (len < size && *more)
+  {
+    n = c->stream->read(c->cursor.bytes, buffer + len, size - len, more);
+    if (n<0 || (n==0 && *more))
+    {
+      return -1;
+    }
+    len += n;
+  }
+  return len;
+}
+/*----------------------------------------------------------------------------*/
+void
+coap_stream_handler(const coap_stream_t *stream, void *request, void *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  coap_packet_t *const coap_req = (coap_packet_t *) request;
+  coap_stream_cursor_t *c = find_cursor(stream, &UIP_IP_BUF->srcipaddr, UIP_UDP_BUF->srcport, coap_req->token, coap_req->token_len);
+  uint32_t block_offset = *offset;
+  uint8_t more = 1;
+  int len;
+
+  if (c==NULL)
+  {
+    c = new_cursor(&UIP_IP_BUF->srcipaddr, UIP_UDP_BUF->srcport, coap_req->token, coap_req->token_len);
+  }
+  else if (c->offset!=block_offset && stream->seek && stream->seek(c->cursor.bytes, block_offset))
+  {
+    c->offset = block_offset;
+  }
+  c->last_used = ++use_counter;
+
+  if (c->stream==NULL || c->offset!=block_offset)
+  {
+    /* A new transfer, a repeated block, or a cursor that was taken by another transfer. */
+    PRINTF("Stream: reopening for offset %lu\n", block_offset);
+
+    release_cursor(c);
+    if (!stream->open(c->cursor.bytes, request))
+    {
+      coap_set_status_code(response, NOT_FOUND_4_04);
+      return;
+    }
+    c->stream = stream;
+    c->offset = 0;
+
+    if (block_offset>0 && stream->seek && stream->seek(c->cursor.bytes, block_offset))
+    {
+      c->offset = block_offset;
+    }
+
+    /* Skip the blocks that the client already has, using the response buffer. */
+    while (c->offset<block_offset && more)
+    {
+      if ((len = read_block(c, buffer, MIN(preferred_size, block_offset - c->offset), &more))<0)
+      {
+        break;
+      }
+      c->offset += len;
+    }
+
+    if (c->offset<block_offset || !more)
+    {
+      release_cursor(c);
+      coap_set_status_code(response, BAD_OPTION_4_02);
+      coap_set_payload(response, "BlockOutOfScope", 15);
+      return;
+    }
+  }
+
+  if ((len = read_block(c, buffer, preferred_size, &more))<0)
+  {
+    release_cursor(c);
+    coap_set_status_code(response, INTERNAL_SERVER_ERROR_5_00);
+    return;
+  }
+
+  coap_set_payload(response, buffer, len);
+
+  if (more)
+  {
+    c->offset += len;
+    *offset = c->offset;
+  }
+  else
+  {
+    PRINTF("Stream: done after %lu bytes\n", c->offset + len);
+    release_cursor(c);
+    *offset = -1;
+  }
+}
+/*----------------------------------------------------------------------------*/
+void
+coap_stream_reset(const coap_stream_t *stream)
+{
+  int i;
+
+  for (i = 0; i < COAP_MAX_STREAM_CURSORS; ++i)
+  {
+    if (cursors[i].stream==stream)
+    {
+      release_cursor(&cursors[i]);
+    }
+  }
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2011, Institute for Pervasive Computing, ETH Zurich
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *      CoAP module for streaming block-wise transfers
+ */
+
+#ifndef COAP_STREAM_H_
+#define COAP_STREAM_H_
+
+#include "er-coap-07.h"
+#include "er-coap-07-transactions.h"
+
+#include "pt.h"
+
+/* The number of block-wise transfers for which the server keeps the cursor between two blocks. */
+#ifndef COAP_MAX_STREAM_CURSORS
+#define COAP_MAX_STREAM_CURSORS         2
+#endif /* COAP_MAX_STREAM_CURSORS */
+
+/* The largest cursor of a stream in bytes. */
+#ifndef COAP_STREAM_CURSOR_SIZE
+#define COAP_STREAM_CURSOR_SIZE         16
+#endif /* COAP_STREAM_CURSOR_SIZE */
+
+/* The block size that the streaming client asks for. The server may answer with smaller blocks. */
+#ifndef COAP_STREAM_BLOCK_SIZE
+#define COAP_STREAM_BLOCK_SIZE          REST_MAX_CHUNK_SIZE
+#endif /* COAP_STREAM_BLOCK_SIZE */
+
+/*
+ * A representation that is generated block by block. The cursor is opaque to the engine and at most
+ * COAP_STREAM_CURSOR_SIZE bytes large. It is kept for each client between two blocks, so that block N is written
+ * into the response buffer without generating the blocks before it again.
+ */
+typedef struct coap_stream {
+  /* Sets the cursor to the start of the representation. Returns 0 if the representation is not available. */
+  int (* open)(void *cursor, void *request);
+
+  /* Writes at most size bytes at the cursor into buffer and advances the cursor. Clears *more at the end of the
+   * representation. Returns the number of bytes written, or -1 on an error. */
+  int (* read)(void *cursor, uint8_t *buffer, uint16_t size, uint8_t *more);
+
+  /* Optional. Moves the cursor to offset and returns 1, or returns 0 to let the engine reopen the stream and read
+   * up to offset instead. */
+  int (* seek)(void *cursor, uint32_t offset);
+
+  /* Optional. Releases the cursor, e.g., closes a file. */
+  void (* close)(void *cursor);
+} coap_stream_t;
+
+/*
+ * Serves a block of the stream as response to a request. To be called from a resource handler with the handler's
+ * arguments.
+ */
+void coap_stream_handler(const coap_stream_t *stream, void *request, void *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset);
+
+/* Releases all cursors of a stream, e.g., when the representation changed. */
+void coap_stream_reset(const coap_stream_t *stream);
+
+/*-----------------------------------------------------------------------------------*/
+/*- Client part ---------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------------*/
+struct coap_stream_state {
+    struct pt pt;
+    struct process *process;
+    coap_transaction_t *transaction;
+    coap_packet_t *response;
+    uint32_t block_num;
+    uint16_t block_size;
+    uint8_t more;
+    uint8_t errors;
+    int fd;
+    uint32_t length; /* bytes written to the file */
+    uint8_t complete; /* set when the last block was written */
+};
+
+/*
+ * Requests a representation block by block and writes each block at its offset into the CFS file fd, which must
+ * be opened for writing.
+ */
+PT_THREAD(coap_stream_request(struct coap_stream_state *state, process_event_t ev,
+                              uip_ipaddr_t *remote_ipaddr, uint16_t remote_port,
+                              coap_packet_t *request, int fd));
+
+#define COAP_STREAM_TO_FILE(server_addr, server_port, request, fd) \
+{ \
+  static struct coap_stream_state stream_state; \
+  PT_SPAWN(process_pt, &stream_state.pt, \
+           coap_stream_request(&stream_state, ev, \
+                               server_addr, server_port, \
+                               request, fd) \
+  ); \
+}
+
+#endif /* COAP_STREAM_H_ */
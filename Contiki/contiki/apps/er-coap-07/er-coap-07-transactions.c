@@ -63,7 +63,13 @@
 
 
 MEMB(transactions_memb, coap_transaction_t, COAP_MAX_OPEN_TRANSACTIONS);
-LIST(transactions_list);
+
+/* Transactions that wait for a retransmission, in the slot of the wheel tick in which they are due. */
+static void *wheel[COAP_TRANSACTION_WHEEL_SLOTS];
+static clock_time_t wheel_checked; /* the last wheel tick that was checked */
+static struct etimer wheel_timer;
+
+static coap_transaction_t *mid_buckets[COAP_TRANSACTION_MID_BUCKETS];
 
 
 static struct process *transaction_handler_process = NULL;
@@ -74,6 +80,79 @@ coap_register_as_transaction_handler()
   transaction_handler_process = PROCESS_CURRENT();
 }
 
+/*-----------------------------------------------------------------------------------*/
+static void
+mid_bucket_remove(coap_transaction_t *t)
+{
+  coap_transaction_t **p;
+
+  for (p = &mid_buckets[t->mid % COAP_TRANSACTION_MID_BUCKETS]; *p; p = &(*p)->next_mid)
+  {
+    if (*p==t)
+    {
+      *p = t->next_mid;
+      break;
+    }
+  }
+}
+
+static void
+mid_bucket_add(coap_transaction_t *t)
+{
+  t->next_mid = mid_buckets[t->mid % COAP_TRANSACTION_MID_BUCKETS];
+  mid_buckets[t->mid % COAP_TRANSACTION_MID_BUCKETS] = t;
+}
+/*-----------------------------------------------------------------------------------*/
+/* The wheel tick in which a transaction is due, rounded up so that it has expired once the tick is checked. */
+static clock_time_t
+due_tick(coap_transaction_t *t)
+{
+  return (clock_time_t)(t->retrans_timer.start + t->retrans_timer.interval + COAP_TRANSACTION_WHEEL_TICK - 1) / COAP_TRANSACTION_WHEEL_TICK;
+}
+
+static void
+wheel_set_timer(clock_time_t tick)
+{
+  clock_time_t interval = (clock_time_t)(tick * COAP_TRANSACTION_WHEEL_TICK - clock_time());
+
+  /* The tick may already have begun. */
+  if (interval > COAP_TRANSACTION_WHEEL_TICK * COAP_TRANSACTION_WHEEL_SLOTS)
+  {
+    interval = 0;
+  }
+
+  /*FIXME
+   * Hack: Setting timer for responsible process.
+   * Maybe there is a better way, but avoid posting everything to the process.
+   */
+  struct process *process_actual = PROCESS_CURRENT();
+  process_current = transaction_handler_process;
+  etimer_set(&wheel_timer, interval);
+  process_current = process_actual;
+}
+
+static void
+wheel_add(coap_transaction_t *t)
+{
+  clock_time_t tick = due_tick(t);
+  clock_time_t due = tick * COAP_TRANSACTION_WHEEL_TICK;
+
+  /* Wake up earlier if the transaction is due before the next wake-up. */
+  if (etimer_expired(&wheel_timer)
+      || (clock_time_t)(etimer_expiration_time(&wheel_timer) - due - 1) < (clock_time_t)~0 / 2)
+  {
+    wheel_set_timer(tick);
+  }
+
+  list_push((list_t) &wheel[tick % COAP_TRANSACTION_WHEEL_SLOTS], t);
+}
+
+static void
+wheel_remove(coap_transaction_t *t)
+{
+  list_remove((list_t) &wheel[due_tick(t) % COAP_TRANSACTION_WHEEL_SLOTS], t);
+}
+/*-----------------------------------------------------------------------------------*/
 coap_transaction_t *
 coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr, uint16_t port)
 {
@@ -83,12 +162,13 @@ coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr, uint16_t port)
   {
     t->mid = mid;
     t->retrans_counter = 0;
+    t->retrans_timer.interval = 0; /* not in the wheel until it is sent as CON */
 
     /* save client address */
     uip_ipaddr_copy(&t->addr, addr);
     t->port = port;
 
-    list_add(transactions_list, t); /* List itself makes sure same element is not added twice. */
+    mid_bucket_add(t);
   }
 
   return t;
@@ -110,23 +190,16 @@ coap_send_transaction(coap_transaction_t *t)
 
       if (t->retrans_counter==0)
       {
-        t->retrans_timer.timer.interval = COAP_RESPONSE_TIMEOUT_TICKS + (random_rand() % (clock_time_t) COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
-        PRINTF("Initial interval %f\n", (float)t->retrans_timer.timer.interval/CLOCK_SECOND);
+        timer_set(&t->retrans_timer, COAP_RESPONSE_TIMEOUT_TICKS + (random_rand() % (clock_time_t) COAP_RESPONSE_TIMEOUT_BACKOFF_MASK));
+        PRINTF("Initial interval %f\n", (float)t->retrans_timer.interval/CLOCK_SECOND);
       }
       else
       {
-        t->retrans_timer.timer.interval <<= 1; /* double */
-        PRINTF("Doubled (%u) interval %f\n", t->retrans_counter, (float)t->retrans_timer.timer.interval/CLOCK_SECOND);
+        timer_set(&t->retrans_timer, t->retrans_timer.interval << 1); /* double */
+        PRINTF("Doubled (%u) interval %f\n", t->retrans_counter, (float)t->retrans_timer.interval/CLOCK_SECOND);
       }
 
-      /*FIXME
-       * Hack: Setting timer for responsible process.
-       * Maybe there is a better way, but avoid posting everything to the process.
-       */
-      struct process *process_actual = PROCESS_CURRENT();
-      process_current = transaction_handler_process;
-      etimer_restart(&t->retrans_timer); /* interval updated above */
-      process_current = process_actual;
+      wheel_add(t);
 
       t = NULL;
     }
@@ -160,8 +233,11 @@ coap_clear_transaction(coap_transaction_t *t)
   {
     PRINTF("Freeing transaction %u: %p\n", t->mid, t);
 
-    etimer_stop(&t->retrans_timer);
-    list_remove(transactions_list, t);
+    if (t->retrans_timer.interval)
+    {
+      wheel_remove(t);
+    }
+    mid_bucket_remove(t);
     memb_free(&transactions_memb, t);
   }
 }
@@ -171,7 +247,7 @@ coap_get_transaction_by_mid(uint16_t mid)
 {
   coap_transaction_t *t = NULL;
 
-  for (t = (coap_transaction_t*)list_head(transactions_list); t; t = t->next)
+  for (t = mid_buckets[mid % COAP_TRANSACTION_MID_BUCKETS]; t; t = t->next_mid)
   {
     if (t->mid==mid)
     {
@@ -182,18 +258,61 @@ coap_get_transaction_by_mid(uint16_t mid)
   return NULL;
 }
 
+void
+coap_set_transaction_mid(coap_transaction_t *t, uint16_t mid)
+{
+  mid_bucket_remove(t);
+  t->mid = mid;
+  mid_bucket_add(t);
+}
+
 void
 coap_check_transactions()
 {
   coap_transaction_t *t = NULL;
+  clock_time_t now = clock_time() / COAP_TRANSACTION_WHEEL_TICK;
+  clock_time_t tick;
+  void **slot;
+  int i;
+
+  /* Check the ticks since the last check, each slot at most once. */
+  tick = wheel_checked;
+  if ((clock_time_t)(now - tick) > COAP_TRANSACTION_WHEEL_SLOTS)
+  {
+    tick = now - COAP_TRANSACTION_WHEEL_SLOTS;
+  }
+  while (tick!=now)
+  {
+    ++tick;
+    slot = &wheel[tick % COAP_TRANSACTION_WHEEL_SLOTS];
+
+    /* Retransmitting may clear other transactions, so the slot is walked again after each one. */
+    for (t = (coap_transaction_t*)list_head((list_t) slot); t; )
+    {
+      if (timer_expired(&t->retrans_timer))
+      {
+        list_remove((list_t) slot, t);
+        ++(t->retrans_counter);
+        PRINTF("Retransmitting %u (%u)\n", t->mid, t->retrans_counter);
+        coap_send_transaction(t);
+        t = (coap_transaction_t*)list_head((list_t) slot);
+      }
+      else
+      {
+        t = t->next;
+      }
+    }
+  }
+  wheel_checked = now;
 
-  for (t = (coap_transaction_t*)list_head(transactions_list); t; t = t->next)
+  /* Wake up for the next slot with transactions. */
+  etimer_stop(&wheel_timer);
+  for (i = 1; i <= COAP_TRANSACTION_WHEEL_SLOTS; ++i)
   {
-    if (etimer_expired(&t->retrans_timer))
+    if (wheel[(now + i) % COAP_TRANSACTION_WHEEL_SLOTS])
     {
-      ++(t->retrans_counter);
-      PRINTF("Retransmitting %u (%u)\n", t->mid, t->retrans_counter);
-      coap_send_transaction(t);
+      wheel_set_timer(now + i);
+      break;
     }
   }
 }
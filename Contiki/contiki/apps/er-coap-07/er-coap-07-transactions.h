@@ -48,12 +48,33 @@
 #define COAP_MAX_OPEN_TRANSACTIONS 4 
 #endif /* COAP_MAX_OPEN_TRANSACTIONS */
 
+/*
+ * The number of hash buckets for finding transactions by MID. MIDs are given out in sequence, so open transactions
+ * spread evenly over the buckets.
+ */
+#ifndef COAP_TRANSACTION_MID_BUCKETS
+#define COAP_TRANSACTION_MID_BUCKETS 8
+#endif /* COAP_TRANSACTION_MID_BUCKETS */
+
+/*
+ * Retransmissions are kept in a timer wheel of this many slots, each COAP_TRANSACTION_WHEEL_TICK clock ticks long,
+ * and one etimer wakes the transaction handler for the next slot that is due.
+ */
+#ifndef COAP_TRANSACTION_WHEEL_SLOTS
+#define COAP_TRANSACTION_WHEEL_SLOTS 8
+#endif /* COAP_TRANSACTION_WHEEL_SLOTS */
+
+#ifndef COAP_TRANSACTION_WHEEL_TICK
+#define COAP_TRANSACTION_WHEEL_TICK  (CLOCK_SECOND/4 ? CLOCK_SECOND/4 : 1)
+#endif /* COAP_TRANSACTION_WHEEL_TICK */
+
 /* container for transactions with message buffer and retransmission info */
 typedef struct coap_transaction {
-  struct coap_transaction *next; /* for LIST */
+  struct coap_transaction *next; /* for the LIST of a timer wheel slot */
+  struct coap_transaction *next_mid; /* next transaction in the MID hash bucket */
 
   uint16_t mid;
-  struct etimer retrans_timer;
+  struct timer retrans_timer;
   uint8_t retrans_counter;
 
   uip_ipaddr_t addr;
@@ -72,6 +93,7 @@ coap_transaction_t *coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr, uint1
 void coap_send_transaction(coap_transaction_t *t);
 void coap_clear_transaction(coap_transaction_t *t);
 coap_transaction_t *coap_get_transaction_by_mid(uint16_t mid);
+void coap_set_transaction_mid(coap_transaction_t *t, uint16_t mid);
 
 void coap_check_transactions();
 
@@ -58,12 +58,217 @@ PROCESS_NAME(rest_manager_process);
 LIST(restful_services);
 LIST(restful_periodic_services);
 
+#if REST_TRIE_SIZE
+/*
+ * A trie of the URI-path segments of the resources. The edges are kept in a hash table that is keyed by the
+ * parent node and the segment, so that a request takes one lookup per segment however many resources there are.
+ * Nodes are numbered from one, and zero stands for the root or the end of a chain.
+ */
+struct rest_trie_node {
+  const char *segment; /* points into the URL of the resource that added the node */
+  resource_t *resource; /* the resource with the path that ends here, if any */
+  uint16_t parent;
+  uint16_t next; /* next node in the hash bucket */
+  uint8_t length;
+};
+
+static struct rest_trie_node trie[REST_TRIE_SIZE];
+static uint16_t trie_buckets[REST_TRIE_BUCKETS];
+static uint16_t trie_used;
+/* Set when a resource did not fit, so that a miss must also walk the resource list. */
+static uint8_t trie_incomplete;
+#endif /* REST_TRIE_SIZE */
+
+#if REST_LINK_FORMAT_SIZE
+/* The link format of the resources, which is appended to as they are activated. */
+static char link_format[REST_LINK_FORMAT_SIZE];
+static uint16_t link_format_len;
+static uint8_t link_format_incomplete;
+#endif /* REST_LINK_FORMAT_SIZE */
+
+/*-----------------------------------------------------------------------------------*/
+#if REST_TRIE_SIZE
+static uint16_t
+trie_bucket(uint16_t parent, const char *segment, int length)
+{
+  uint16_t hash = parent;
+
+  while (length-- > 0)
+  {
+    hash = hash * 31 + (uint8_t)*segment++;
+  }
+  return hash % REST_TRIE_BUCKETS;
+}
+
+static uint16_t
+trie_find(uint16_t parent, const char *segment, int length)
+{
+  uint16_t n;
+
+  for (n = trie_buckets[trie_bucket(parent, segment, length)]; n; n = trie[n-1].next)
+  {
+    if (trie[n-1].parent==parent && trie[n-1].length==length && memcmp(trie[n-1].segment, segment, length)==0)
+    {
+      break;
+    }
+  }
+  return n;
+}
+
+static int
+trie_insert(resource_t* resource)
+{
+  const char *segment = resource->url;
+  const char *end = segment + strlen(segment);
+  const char *slash;
+  uint16_t parent = 0;
+  uint16_t n, bucket;
+
+  while (1)
+  {
+    slash = memchr(segment, '/', end - segment);
+    if (slash==NULL)
+    {
+      slash = end;
+    }
+    if (slash - segment > 255)
+    {
+      return 0;
+    }
+
+    n = trie_find(parent, segment, slash - segment);
+    if (!n)
+    {
+      if (trie_used >= REST_TRIE_SIZE)
+      {
+        return 0;
+      }
+      n = ++trie_used;
+      bucket = trie_bucket(parent, segment, slash - segment);
+      trie[n-1].segment = segment;
+      trie[n-1].length = slash - segment;
+      trie[n-1].parent = parent;
+      trie[n-1].resource = NULL;
+      trie[n-1].next = trie_buckets[bucket];
+      trie_buckets[bucket] = n;
+    }
+    parent = n;
+
+    if (slash==end)
+    {
+      break;
+    }
+    segment = slash + 1;
+  }
+
+  /* Like the list, the trie keeps the first resource with a URL. */
+  if (trie[parent-1].resource==NULL)
+  {
+    trie[parent-1].resource = resource;
+  }
+  return 1;
+}
+
+/* Returns the resource with the exact URL, or else the resource with the longest prefix of whole segments that
+ * handles sub-resources. */
+static resource_t*
+trie_lookup(const char *url, int url_len)
+{
+  const char *segment = url;
+  const char *end = url + url_len;
+  const char *slash;
+  resource_t* sub_resource = NULL;
+  uint16_t n = 0;
+
+  while (1)
+  {
+    slash = memchr(segment, '/', end - segment);
+    if (slash==NULL)
+    {
+      slash = end;
+    }
+    n = trie_find(n, segment, slash - segment);
+    if (!n)
+    {
+      break;
+    }
+    if (slash==end)
+    {
+      if (trie[n-1].resource)
+      {
+        return trie[n-1].resource;
+      }
+      break;
+    }
+    if (trie[n-1].resource && (trie[n-1].resource->flags & HAS_SUB_RESOURCES))
+    {
+      sub_resource = trie[n-1].resource;
+    }
+    segment = slash + 1;
+  }
+  return sub_resource;
+}
+#endif /* REST_TRIE_SIZE */
+/*-----------------------------------------------------------------------------------*/
+#if REST_LINK_FORMAT_SIZE
+static void
+link_format_append(resource_t* resource)
+{
+  size_t url_len = strlen(resource->url);
+  size_t attributes_len = strlen(resource->attributes);
+  size_t needed = (link_format_len ? 1 : 0) + url_len + 3 + (attributes_len ? attributes_len + 1 : 0);
+
+  if (link_format_incomplete || link_format_len + needed > REST_LINK_FORMAT_SIZE)
+  {
+    link_format_incomplete = 1;
+    return;
+  }
+
+  if (link_format_len)
+  {
+    link_format[link_format_len++] = ',';
+  }
+  link_format[link_format_len++] = '<';
+  link_format[link_format_len++] = '/';
+  memcpy(link_format + link_format_len, resource->url, url_len);
+  link_format_len += url_len;
+  link_format[link_format_len++] = '>';
+  if (attributes_len)
+  {
+    link_format[link_format_len++] = ';';
+    memcpy(link_format + link_format_len, resource->attributes, attributes_len);
+    link_format_len += attributes_len;
+  }
+}
+#endif /* REST_LINK_FORMAT_SIZE */
+/*-----------------------------------------------------------------------------------*/
+/* Checks whether a resource handles a URL, which is not null-terminated. */
+static int
+url_matches(resource_t* resource, const char *url, int url_len)
+{
+  int len = strlen(resource->url);
+
+  return (url_len==len || (url_len>len && (resource->flags & HAS_SUB_RESOURCES) && url[len]=='/'))
+      && strncmp(resource->url, url, len) == 0;
+}
+/*-----------------------------------------------------------------------------------*/
+
 
 void
 rest_init_engine(void)
 {
   list_init(restful_services);
 
+#if REST_TRIE_SIZE
+  memset(trie_buckets, 0, sizeof(trie_buckets));
+  trie_used = 0;
+  trie_incomplete = 0;
+#endif
+#if REST_LINK_FORMAT_SIZE
+  link_format_len = 0;
+  link_format_incomplete = 0;
+#endif
+
   REST.set_service_callback(rest_invoke_restful_service);
 
   /* Start the RESTful server implementation. */
@@ -88,6 +293,17 @@ rest_activate_resource(resource_t* resource)
   }
 
   list_add(restful_services, resource);
+
+#if REST_TRIE_SIZE
+  if (!trie_insert(resource))
+  {
+    PRINTF("Trie full: %s\n", resource->url);
+    trie_incomplete = 1;
+  }
+#endif
+#if REST_LINK_FORMAT_SIZE
+  link_format_append(resource);
+#endif
 }
 
 void
@@ -112,6 +328,19 @@ rest_get_resources(void)
   return restful_services;
 }
 
+int
+rest_get_link_format(const char **format)
+{
+#if REST_LINK_FORMAT_SIZE
+  if (!link_format_incomplete)
+  {
+    *format = link_format;
+    return link_format_len;
+  }
+#endif
+  return -1;
+}
+
 
 void*
 rest_get_user_data(resource_t* resource)
@@ -149,42 +378,52 @@ rest_invoke_restful_service(void* request, void* response, uint8_t *buffer, uint
   uint8_t found = 0;
   uint8_t allowed = 0;
 
-  PRINTF("rest_invoke_restful_service url /%.*s -->\n", url_len, url);
-
   resource_t* resource = NULL;
   const char *url = NULL;
+  int url_len = REST.get_url(request, &url);
+
+  PRINTF("rest_invoke_restful_service url /%.*s -->\n", url_len, url);
 
-  for (resource = (resource_t*)list_head(restful_services); resource; resource = resource->next)
+#if REST_TRIE_SIZE
+  resource = trie_lookup(url, url_len);
+  if (resource==NULL && trie_incomplete)
+#endif
   {
-    /*if the web service handles that kind of requests and urls matches*/
-    if ((REST.get_url(request, &url)==strlen(resource->url) || (REST.get_url(request, &url)>strlen(resource->url) && (resource->flags & HAS_SUB_RESOURCES)))
-        && strncmp(resource->url, url, strlen(resource->url)) == 0)
+    for (resource = (resource_t*)list_head(restful_services); resource; resource = resource->next)
     {
-      found = 1;
-      rest_resource_flags_t method = REST.get_method_type(request);
+      if (url_matches(resource, url, url_len))
+      {
+        break;
+      }
+    }
+  }
 
-      PRINTF("method %u, resource->flags %u\n", (uint16_t)method, resource->flags);
+  /*if the web service handles that kind of requests and urls matches*/
+  if (resource)
+  {
+    found = 1;
+    rest_resource_flags_t method = REST.get_method_type(request);
 
-      if (resource->flags & method)
+    PRINTF("method %u, resource->flags %u\n", (uint16_t)method, resource->flags);
+
+    if (resource->flags & method)
+    {
+      allowed = 1;
+
+      /*call pre handler if it exists*/
+      if (!resource->pre_handler || resource->pre_handler(resource, request, response))
       {
-        allowed = 1;
+        /* call handler function*/
+        resource->handler(request, response, buffer, buffer_size, offset);
 
-        /*call pre handler if it exists*/
-        if (!resource->pre_handler || resource->pre_handler(resource, request, response))
+        /*call post handler if it exists*/
+        if (resource->post_handler)
         {
-          /* call handler function*/
-          resource->handler(request, response, buffer, buffer_size, offset);
-
-          /*call post handler if it exists*/
-          if (resource->post_handler)
-          {
-            resource->post_handler(resource, request, response);
-          }
+          resource->post_handler(resource, request, response);
         }
-      } else {
-        REST.set_response_status(response, REST.status.METHOD_NOT_ALLOWED);
       }
-      break;
+    } else {
+      REST.set_response_status(response, REST.status.METHOD_NOT_ALLOWED);
     }
   }
 
@@ -52,6 +52,28 @@
 #define REST_MAX_CHUNK_SIZE     128
 #endif
 
+/*
+ * The number of path segments in the trie that requests are dispatched with. Resources that do not fit are
+ * found by walking the resource list. Zero, the default, disables the trie to save RAM on nodes; the native
+ * and minimal-net platforms enable it for gateways that serve many resources.
+ */
+#ifndef REST_TRIE_SIZE
+#define REST_TRIE_SIZE          0
+#endif
+
+/* The number of hash buckets for the edges of the trie. */
+#ifndef REST_TRIE_BUCKETS
+#define REST_TRIE_BUCKETS       16
+#endif
+
+/*
+ * The size of the cached link format of all resources for /.well-known/core. If the resources do not fit, the
+ * link format is built for every request. Zero, the default, disables the cache.
+ */
+#ifndef REST_LINK_FORMAT_SIZE
+#define REST_LINK_FORMAT_SIZE   0
+#endif
+
 #ifndef MIN
 #define MIN(a, b) ((a) < (b)? (a) : (b))
 #endif /* MIN */
@@ -309,6 +331,12 @@ int rest_invoke_restful_service(void* request, void* response, uint8_t *buffer,
  */
 list_t rest_get_resources(void);
 
+/*
+ * Returns the length of the link format of all activated resources and points link_format to it, or -1 if it is
+ * not cached.
+ */
+int rest_get_link_format(const char **link_format);
+
 /*
  * Getter and setter methods for user specific data.
  */
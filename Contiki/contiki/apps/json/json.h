@@ -66,5 +66,14 @@ enum {
 };
 
 #define JSON_CONTENT_TYPE "application/json"
+#define JSON_CBOR_CONTENT_TYPE "application/cbor"
+
+/* Support for CBOR (RFC 7049), a compact binary encoding of the same
+   data model, in jsonparse and jsontree. */
+#ifdef JSON_CONF_CBOR
+#define JSON_CBOR JSON_CONF_CBOR
+#else
+#define JSON_CBOR 0
+#endif
 
 #endif /* __JSON_H__ */
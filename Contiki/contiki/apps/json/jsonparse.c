@@ -54,36 +54,55 @@ pop(struct jsonparse_state *state)
 }
 /*--------------------------------------------------------------------*/
 /* will pass by the value and store the start and length of the value for
-   atomic types */
+   atomic types; the integer part of a number is computed on the way */
 /*--------------------------------------------------------------------*/
 static void
 atomic(struct jsonparse_state *state, char type)
 {
+  const char *json = state->json;
+  int pos = state->pos;
+  int len = state->len;
+  long n;
   char c;
 
-  state->vstart = state->pos;
+  state->vstart = pos;
   state->vtype = type;
   if(type == JSON_TYPE_STRING || type == JSON_TYPE_PAIR_NAME) {
-    while((c = state->json[state->pos++]) && c != '"') {
+    while(pos < len && (c = json[pos]) != '"' && c != '\0') {
       if(c == '\\') {
-        state->pos++;           /* skip current char */
+        pos++;                  /* skip current char */
       }
+      pos++;
     }
-    state->vlen = state->pos - state->vstart - 1;
-  } else if(type == JSON_TYPE_NUMBER) {
-    do {
-      c = state->json[state->pos];
-      if((c < '0' || c > '9') && c != '.') {
-        c = 0;
-      } else {
-        state->pos++;
-      }
-    } while(c);
+    state->vlen = (pos < len ? pos : len) - state->vstart;
+    pos++;                      /* skip the quote */
+  } else {
     /* need to back one step since first char is already gone */
-    state->vstart--;
-    state->vlen = state->pos - state->vstart;
+    state->vstart = --pos;
+    if(type == JSON_TYPE_NUMBER) {
+      if(json[pos] == '-') {
+        pos++;
+      }
+      for(n = 0; pos < len && (c = json[pos]) >= '0' && c <= '9'; pos++) {
+        n = n * 10 + (c - '0');
+      }
+      state->vnum = json[state->vstart] == '-' ? -n : n;
+      /* the fraction and the exponent are only part of the text */
+      while(pos < len && (((c = json[pos]) >= '0' && c <= '9') ||
+                          c == '.' || c == 'e' || c == 'E' ||
+                          c == '+' || c == '-')) {
+        pos++;
+      }
+    } else {
+      /* true, false or null */
+      while(pos < len && (c = json[pos]) >= 'a' && c <= 'z') {
+        pos++;
+      }
+      state->vnum = type == JSON_TYPE_TRUE;
+    }
+    state->vlen = pos - state->vstart;
   }
-  /* no other types for now... */
+  state->pos = pos;
 }
 /*--------------------------------------------------------------------*/
 static void
@@ -92,11 +111,217 @@ skip_ws(struct jsonparse_state *state)
   char c;
 
   while(state->pos < state->len &&
-        ((c = state->json[state->pos]) == ' ' || c == '\n')) {
+        ((c = state->json[state->pos]) == ' ' || c == '\n' ||
+         c == '\r' || c == '\t')) {
     state->pos++;
   }
 }
 /*--------------------------------------------------------------------*/
+#if JSON_CBOR
+static int
+cbor_error(struct jsonparse_state *state)
+{
+  state->error = JSON_ERROR_SYNTAX;
+  return JSON_TYPE_ERROR;
+}
+/*--------------------------------------------------------------------*/
+/* read the argument that follows the initial byte of a data item; only
+   the low 32 bits of 64-bit arguments are kept */
+static int
+cbor_argument(struct jsonparse_state *state, uint8_t info, uint32_t *arg)
+{
+  const uint8_t *cbor = (const uint8_t *)state->json;
+  int n;
+
+  if(info < 24) {
+    *arg = info;
+    return 1;
+  }
+  n = info == 24 ? 1 : info == 25 ? 2 : info == 26 ? 4 : info == 27 ? 8 : 0;
+  if(n == 0 || state->pos + n > state->len) {
+    return 0;
+  }
+  for(*arg = 0; n > 0; n--) {
+    *arg = (*arg << 8) | cbor[state->pos++];
+  }
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+static int
+cbor_int(struct jsonparse_state *state, long *value)
+{
+  uint8_t initial;
+  uint32_t arg;
+
+  if(state->pos >= state->len) {
+    return 0;
+  }
+  initial = state->json[state->pos++];
+  if((initial >> 5) > 1 || !cbor_argument(state, initial & 0x1f, &arg)) {
+    return 0;
+  }
+  *value = (initial >> 5) == 0 ? (long)arg : -1 - (long)arg;
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+static int
+cbor_next(struct jsonparse_state *state)
+{
+  uint8_t initial;
+  uint32_t arg;
+  long exponent;
+  char s;
+  int name;
+
+  /* close the containers that have all their items */
+  if(state->depth > 0 && state->remaining[state->depth - 1] == 0) {
+    s = pop(state) + 2;
+    state->vtype = s;
+    state->vlen = 0;
+    return s;
+  }
+  if(state->pos >= state->len) {
+    return 0;
+  }
+
+  s = jsonparse_get_type(state);
+  name = 0;
+  if(state->depth > 0) {
+    name = s == '{' && (state->remaining[state->depth - 1] & 1) == 0;
+    state->remaining[state->depth - 1]--;
+  }
+
+  initial = state->json[state->pos++];
+  state->vstart = state->pos;
+  state->vlen = 0;
+  state->vexp = 0;
+
+  if((initial >> 5) == 7) {
+    switch(initial & 0x1f) {
+    case 20:
+      state->vtype = JSON_TYPE_FALSE;
+      break;
+    case 21:
+      state->vtype = JSON_TYPE_TRUE;
+      break;
+    case 22:
+      state->vtype = JSON_TYPE_NULL;
+      break;
+    default:
+      /* floats are not supported */
+      return cbor_error(state);
+    }
+    state->vnum = state->vmantissa = state->vtype == JSON_TYPE_TRUE;
+    return state->vtype;
+  }
+
+  if(!cbor_argument(state, initial & 0x1f, &arg)) {
+    return cbor_error(state);
+  }
+
+  switch(initial >> 5) {
+  case 0:
+  case 1:
+    state->vnum = (initial >> 5) == 0 ? (long)arg : -1 - (long)arg;
+    state->vmantissa = state->vnum;
+    state->vtype = JSON_TYPE_NUMBER;
+    return JSON_TYPE_NUMBER;
+  case 2:
+  case 3:
+    if(arg > (uint32_t)(state->len - state->pos)) {
+      return cbor_error(state);
+    }
+    state->vstart = state->pos;
+    state->vlen = arg;
+    state->pos += arg;
+    state->vtype = name ? JSON_TYPE_PAIR_NAME : JSON_TYPE_STRING;
+    return state->vtype;
+  case 4:
+  case 5:
+    if(state->depth + 1 >= JSONPARSE_MAX_DEPTH) {
+      return cbor_error(state);
+    }
+    s = (initial >> 5) == 4 ? JSON_TYPE_ARRAY : JSON_TYPE_OBJECT;
+    push(state, s);
+    state->remaining[state->depth - 1] = s == JSON_TYPE_ARRAY ? arg : 2 * arg;
+    return s;
+  case 6:
+    if(arg == 4) {
+      /* a decimal fraction: [exponent, mantissa] */
+      if(state->pos >= state->len || (uint8_t)state->json[state->pos] != 0x82) {
+        return cbor_error(state);
+      }
+      state->pos++;
+      if(!cbor_int(state, &exponent) || !cbor_int(state, &state->vmantissa) ||
+         exponent < -18 || exponent > 18) {
+        return cbor_error(state);
+      }
+      state->vexp = exponent;
+      for(state->vnum = state->vmantissa; exponent < 0; exponent++) {
+        state->vnum /= 10;
+      }
+      for(; exponent > 0; exponent--) {
+        state->vnum *= 10;
+      }
+      state->vtype = JSON_TYPE_NUMBER;
+      return JSON_TYPE_NUMBER;
+    }
+    /* other tags are ignored and the tagged item is returned */
+    if(state->depth > 0) {
+      state->remaining[state->depth - 1]++;
+    }
+    return cbor_next(state);
+  default:
+    return cbor_error(state);
+  }
+}
+/*--------------------------------------------------------------------*/
+/* format a CBOR value that has no text in the data */
+static int
+cbor_format(struct jsonparse_state *state, char *buf)
+{
+  char digits[24];
+  unsigned long m;
+  int n, len, point;
+
+  if(state->vtype == JSON_TYPE_TRUE) {
+    strcpy(buf, "true");
+    return 4;
+  } else if(state->vtype == JSON_TYPE_FALSE) {
+    strcpy(buf, "false");
+    return 5;
+  } else if(state->vtype != JSON_TYPE_NUMBER) {
+    strcpy(buf, "null");
+    return 4;
+  }
+
+  m = state->vmantissa < 0 ? -(unsigned long)state->vmantissa :
+    (unsigned long)state->vmantissa;
+  n = 0;
+  do {
+    digits[n++] = '0' + m % 10;
+    m /= 10;
+  } while(m > 0 || n <= -state->vexp);
+
+  len = 0;
+  if(state->vmantissa < 0) {
+    buf[len++] = '-';
+  }
+  point = state->vexp < 0 ? -state->vexp : 0;
+  while(n > 0) {
+    buf[len++] = digits[--n];
+    if(n == point && n > 0) {
+      buf[len++] = '.';
+    }
+  }
+  for(n = state->vexp; n > 0; n--) {
+    buf[len++] = '0';
+  }
+  buf[len] = 0;
+  return len;
+}
+#endif /* JSON_CBOR */
+/*--------------------------------------------------------------------*/
 void
 jsonparse_setup(struct jsonparse_state *state, const char *json, int len)
 {
@@ -105,8 +330,26 @@ jsonparse_setup(struct jsonparse_state *state, const char *json, int len)
   state->pos = 0;
   state->depth = 0;
   state->error = 0;
+  state->vtype = 0;
+  state->vlen = 0;
+  state->vnum = 0;
   state->stack[0] = 0;
+#if JSON_CBOR
+  state->cbor = 0;
+#endif /* JSON_CBOR */
+}
+/*--------------------------------------------------------------------*/
+#if JSON_CBOR
+void
+jsonparse_setup_cbor(struct jsonparse_state *state, const uint8_t *cbor,
+                     int len)
+{
+  jsonparse_setup(state, (const char *)cbor, len);
+  state->cbor = 1;
+  state->vexp = 0;
+  state->vmantissa = 0;
 }
+#endif /* JSON_CBOR */
 /*--------------------------------------------------------------------*/
 int
 jsonparse_next(struct jsonparse_state *state)
@@ -114,7 +357,16 @@ jsonparse_next(struct jsonparse_state *state)
   char c;
   char s;
 
+#if JSON_CBOR
+  if(state->cbor) {
+    return cbor_next(state);
+  }
+#endif /* JSON_CBOR */
+
   skip_ws(state);
+  if(state->pos >= state->len) {
+    return 0;
+  }
   c = state->json[state->pos];
   s = jsonparse_get_type(state);
   state->pos++;
@@ -135,6 +387,9 @@ jsonparse_next(struct jsonparse_state *state)
       state->error = JSON_ERROR_SYNTAX;
       return JSON_TYPE_ERROR;
     }
+    /* a closed container is the value of an enclosing pair */
+    state->vtype = c;
+    state->vlen = 0;
     return c;
   case ']':
     if(s == '[') {
@@ -143,6 +398,8 @@ jsonparse_next(struct jsonparse_state *state)
       state->error = JSON_ERROR_UNEXPECTED_END_OF_ARRAY;
       return JSON_TYPE_ERROR;
     }
+    state->vtype = c;
+    state->vlen = 0;
     return c;
   case ':':
     push(state, c);
@@ -176,10 +433,14 @@ jsonparse_next(struct jsonparse_state *state)
     return c;
   default:
     if(s == ':' || s == '[') {
-      if(c <= '9' && c >= '0') {
+      if((c <= '9' && c >= '0') || c == '-') {
         atomic(state, JSON_TYPE_NUMBER);
         return JSON_TYPE_NUMBER;
       }
+      if(c == JSON_TYPE_TRUE || c == JSON_TYPE_FALSE || c == JSON_TYPE_NULL) {
+        atomic(state, c);
+        return c;
+      }
     }
   }
   return 0;
@@ -192,26 +453,44 @@ jsonparse_next(struct jsonparse_state *state)
 int
 jsonparse_copy_value(struct jsonparse_state *state, char *str, int size)
 {
+  const char *value;
   int i;
+#if JSON_CBOR
+  char buf[24];
+#endif /* JSON_CBOR */
 
   if(state->vtype == 0) {
     return 0;
   }
-  size = size <= state->vlen ? (size - 1) : state->vlen;
-  for(i = 0; i < size; i++) {
-    str[i] = state->json[state->vstart + i];
+  value = &state->json[state->vstart];
+  i = state->vlen;
+#if JSON_CBOR
+  if(state->cbor && state->vtype != JSON_TYPE_STRING &&
+     state->vtype != JSON_TYPE_PAIR_NAME) {
+    i = cbor_format(state, buf);
+    value = buf;
   }
-  str[i] = 0;
+#endif /* JSON_CBOR */
+  size = size <= i ? (size - 1) : i;
+  memcpy(str, value, size);
+  str[size] = 0;
   return state->vtype;
 }
 /*--------------------------------------------------------------------*/
 int
+jsonparse_get_value_slice(struct jsonparse_state *state, const char **value)
+{
+  *value = &state->json[state->vstart];
+  return state->vtype == 0 ? 0 : state->vlen;
+}
+/*--------------------------------------------------------------------*/
+int
 jsonparse_get_value_as_int(struct jsonparse_state *state)
 {
   if(state->vtype != JSON_TYPE_NUMBER) {
     return 0;
   }
-  return atoi(&state->json[state->vstart]);
+  return (int)state->vnum;
 }
 /*--------------------------------------------------------------------*/
 long
@@ -220,7 +499,7 @@ jsonparse_get_value_as_long(struct jsonparse_state *state)
   if(state->vtype != JSON_TYPE_NUMBER) {
     return 0;
   }
-  return atol(&state->json[state->vstart]);
+  return state->vnum;
 }
 /*--------------------------------------------------------------------*/
 /* strcmp - assume no strange chars that needs to be stuffed in string... */
@@ -255,3 +534,132 @@ jsonparse_has_next(struct jsonparse_state *state)
   return state->pos < state->len;
 }
 /*--------------------------------------------------------------------*/
+/* skip the rest of an array or object whose start was just returned */
+static int
+skip_value(struct jsonparse_state *state, int type)
+{
+  int depth;
+
+  if(type != JSON_TYPE_OBJECT && type != JSON_TYPE_ARRAY) {
+    return 1;
+  }
+  depth = state->depth - 1;
+  while(state->depth > depth) {
+    type = jsonparse_next(state);
+    if(type == 0 || type == JSON_TYPE_ERROR) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+static void
+store_int(uint8_t *member, int size, long value)
+{
+  switch(size) {
+  case 1:
+    *(int8_t *)member = value;
+    break;
+  case 2:
+    *(int16_t *)member = value;
+    break;
+  case 4:
+    *(int32_t *)member = value;
+    break;
+  default:
+    *(long *)member = value;
+    break;
+  }
+}
+/*--------------------------------------------------------------------*/
+static int
+bind_object(struct jsonparse_state *state,
+            const struct jsonparse_binding *bindings, int count, uint8_t *obj)
+{
+  const struct jsonparse_binding *b;
+  int depth, type, stored, i, next, n;
+
+  depth = state->depth;
+  stored = 0;
+  next = 0;
+
+  while((type = jsonparse_next(state)) != 0 && type != JSON_TYPE_ERROR) {
+    if(type == '}' && state->depth < depth) {
+      return stored;
+    }
+    if(type != JSON_TYPE_PAIR_NAME) {
+      continue;
+    }
+
+    /* Documents mostly follow the order of the bindings, so the search
+       starts after the previous match. */
+    b = NULL;
+    for(i = 0; i < count; i++) {
+      n = next + i < count ? next + i : next + i - count;
+      if(bindings[n].name_len == state->vlen &&
+         memcmp(bindings[n].name, &state->json[state->vstart],
+                state->vlen) == 0) {
+        b = &bindings[n];
+        next = n + 1 < count ? n + 1 : 0;
+        break;
+      }
+    }
+
+    type = jsonparse_next(state);
+    if(type == JSON_TYPE_PAIR) {
+      type = jsonparse_next(state);
+    }
+    if(type == 0 || type == JSON_TYPE_ERROR) {
+      break;
+    }
+
+    if(b == NULL) {
+      /* skip pairs without binding */
+    } else if(b->type == JSONPARSE_BIND_TYPE_INT && type == JSON_TYPE_NUMBER) {
+      store_int(obj + b->offset, b->size, state->vnum);
+      stored++;
+      continue;
+    } else if(b->type == JSONPARSE_BIND_TYPE_BOOL &&
+              (type == JSON_TYPE_TRUE || type == JSON_TYPE_FALSE ||
+               type == JSON_TYPE_NUMBER)) {
+      obj[b->offset] = state->vnum != 0;
+      stored++;
+      continue;
+    } else if(b->type == JSONPARSE_BIND_TYPE_STRING &&
+              type == JSON_TYPE_STRING) {
+      n = state->vlen < b->size ? state->vlen : b->size - 1;
+      memcpy(obj + b->offset, &state->json[state->vstart], n);
+      obj[b->offset + n] = '\0';
+      stored++;
+      continue;
+    } else if(b->type == JSONPARSE_BIND_TYPE_OBJECT &&
+              type == JSON_TYPE_OBJECT) {
+      if((n = bind_object(state, b->bindings, b->size, obj + b->offset)) < 0) {
+        return -1;
+      }
+      stored += n;
+      continue;
+    }
+
+    if(!skip_value(state, type)) {
+      break;
+    }
+  }
+  return -1;
+}
+/*--------------------------------------------------------------------*/
+int
+jsonparse_bind(struct jsonparse_state *state,
+               const struct jsonparse_binding *bindings, int count, void *obj)
+{
+  int type;
+
+  while((type = jsonparse_next(state)) == ',' || type == JSON_TYPE_PAIR) {
+    /* the object may be the value of a pair or an array element */
+  }
+  if(type != JSON_TYPE_OBJECT) {
+    return -1;
+  }
+  return bind_object(state, bindings, count, obj);
+}
+/*--------------------------------------------------------------------*/
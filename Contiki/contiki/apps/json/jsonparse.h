@@ -34,6 +34,7 @@
 
 #include "contiki-conf.h"
 #include "json.h"
+#include <stddef.h>
 
 #ifdef JSONPARSE_CONF_MAX_DEPTH
 #define JSONPARSE_MAX_DEPTH JSONPARSE_CONF_MAX_DEPTH
@@ -49,11 +50,48 @@ struct jsonparse_state {
   /* for handling atomic values */
   int vstart;
   int vlen;
+  long vnum; /* the integer part of a number, computed while scanning it */
   char vtype;
   char error;
   char stack[JSONPARSE_MAX_DEPTH];
+#if JSON_CBOR
+  uint8_t cbor;
+  int8_t vexp; /* the exponent of a CBOR decimal fraction */
+  long vmantissa;
+  uint16_t remaining[JSONPARSE_MAX_DEPTH]; /* items left in CBOR containers */
+#endif /* JSON_CBOR */
 };
 
+/* The types of struct members that jsonparse_bind() stores values in. */
+#define JSONPARSE_BIND_TYPE_INT    'I' /* signed integer of any size */
+#define JSONPARSE_BIND_TYPE_BOOL   'B' /* uint8_t, set to 0 or 1 */
+#define JSONPARSE_BIND_TYPE_STRING 'S' /* char array, always terminated */
+#define JSONPARSE_BIND_TYPE_OBJECT 'O' /* nested object with own bindings */
+
+/* Maps the name of a pair to a member of a struct. */
+struct jsonparse_binding {
+  const char *name;
+  uint8_t name_len;
+  uint8_t type;
+  uint16_t offset;
+  uint16_t size; /* of the member, or the number of nested bindings */
+  const struct jsonparse_binding *bindings;
+};
+
+#define JSONPARSE_BIND_INT(type, member, name)                          \
+  {(name), sizeof(name) - 1, JSONPARSE_BIND_TYPE_INT,                   \
+   offsetof(type, member), sizeof(((type *)0)->member), NULL}
+#define JSONPARSE_BIND_BOOL(type, member, name)                         \
+  {(name), sizeof(name) - 1, JSONPARSE_BIND_TYPE_BOOL,                  \
+   offsetof(type, member), sizeof(((type *)0)->member), NULL}
+#define JSONPARSE_BIND_STRING(type, member, name)                       \
+  {(name), sizeof(name) - 1, JSONPARSE_BIND_TYPE_STRING,                \
+   offsetof(type, member), sizeof(((type *)0)->member), NULL}
+#define JSONPARSE_BIND_OBJECT(type, member, name, bindings)             \
+  {(name), sizeof(name) - 1, JSONPARSE_BIND_TYPE_OBJECT,                \
+   offsetof(type, member),                                              \
+   sizeof(bindings) / sizeof(struct jsonparse_binding), (bindings)}
+
 /**
  * \brief      Initialize a JSON parser state.
  * \param state A pointer to a JSON parser state
@@ -66,6 +104,22 @@ struct jsonparse_state {
 void jsonparse_setup(struct jsonparse_state *state, const char *json,
                      int len);
 
+#if JSON_CBOR
+/**
+ * \brief      Initialize a JSON parser state for CBOR.
+ * \param state A pointer to a JSON parser state
+ * \param cbor The CBOR data item to parse
+ * \param len  The length of the data
+ *
+ *             This function initializes a JSON parser state for
+ *             parsing CBOR. jsonparse_next() returns the same types as
+ *             for JSON text, but no ':' or ',' separators. Strings are
+ *             not terminated by a quote.
+ */
+void jsonparse_setup_cbor(struct jsonparse_state *state, const uint8_t *cbor,
+                          int len);
+#endif /* JSON_CBOR */
+
 /* move to next JSON element */
 int jsonparse_next(struct jsonparse_state *state);
 
@@ -73,6 +127,11 @@ int jsonparse_next(struct jsonparse_state *state);
 int jsonparse_copy_value(struct jsonparse_state *state, char *buf,
                          int buf_size);
 
+/* get a pointer to the current JSON value in the parsed data, and its
+   length; the value is not copied and not terminated */
+int jsonparse_get_value_slice(struct jsonparse_state *state,
+                              const char **value);
+
 /* get the current JSON value parsed as an int */
 int jsonparse_get_value_as_int(struct jsonparse_state *state);
 
@@ -88,4 +147,20 @@ int jsonparse_get_type(struct jsonparse_state *state);
 /* compare the JSON value with the specified string */
 int jsonparse_strcmp_value(struct jsonparse_state *state, const char *str);
 
+/**
+ * \brief      Parse an object into a struct.
+ * \param state A pointer to a JSON parser state before the object
+ * \param bindings The members of the struct that pairs are stored in
+ * \param count The number of bindings
+ * \param obj  A pointer to the struct
+ * \return     The number of values stored, or -1 on an error
+ *
+ *             This function parses the next object in one pass and
+ *             stores the values of pairs that have a binding in the
+ *             struct. Other pairs are skipped.
+ */
+int jsonparse_bind(struct jsonparse_state *state,
+                   const struct jsonparse_binding *bindings, int count,
+                   void *obj);
+
 #endif /* __JSONPARSE_H__ */
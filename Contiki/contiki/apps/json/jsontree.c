@@ -50,53 +50,309 @@
 #define PRINTF(...)
 #endif
 
+#if JSON_CBOR
+#define IS_CBOR(js_ctx) ((js_ctx)->writer != NULL &&                    \
+                         (js_ctx)->format == JSONTREE_FORMAT_CBOR)
+#else
+#define IS_CBOR(js_ctx) 0
+#endif /* JSON_CBOR */
+
+/* The buffer in which short strings are assembled with their quotes. */
+#ifdef JSONTREE_CONF_STRING_BUFFER_SIZE
+#define JSONTREE_STRING_BUFFER_SIZE JSONTREE_CONF_STRING_BUFFER_SIZE
+#else
+#define JSONTREE_STRING_BUFFER_SIZE 32
+#endif /* JSONTREE_CONF_STRING_BUFFER_SIZE */
+
+/* The context whose writer the putchar of a writer context feeds. */
+static const struct jsontree_context *writer_ctx;
+
+/*---------------------------------------------------------------------------*/
+void
+jsontree_flush(const struct jsontree_context *js_ctx)
+{
+  struct jsontree_writer *writer = js_ctx->writer;
+
+  if(writer != NULL && writer->len > 0) {
+    writer->write(writer->buf, writer->len);
+    writer->len = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+jsontree_write_span(const struct jsontree_context *js_ctx, const char *data,
+                    int len)
+{
+  struct jsontree_writer *writer = js_ctx->writer;
+  char *p;
+
+  if(writer == NULL) {
+    while(len-- > 0) {
+      js_ctx->putchar(*data++);
+    }
+  } else if(len > 0) {
+    if(writer->len + len > writer->size) {
+      jsontree_flush(js_ctx);
+      if(len >= writer->size) {
+        writer->write(data, len);
+        return;
+      }
+    }
+    /* Most spans are a few bytes long and are not worth a memcpy. */
+    p = writer->buf + writer->len;
+    writer->len += len;
+    while(len-- > 0) {
+      *p++ = *data++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+jsontree_putchar(const struct jsontree_context *js_ctx, int c)
+{
+  char ch = c;
+
+  if(js_ctx->writer == NULL) {
+    js_ctx->putchar(c);
+  } else {
+    jsontree_write_span(js_ctx, &ch, 1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The putchar of a writer context, for callbacks that write through
+   js_ctx->putchar. */
+static int
+writer_putchar(int c)
+{
+  jsontree_putchar(writer_ctx, c);
+  return c;
+}
+/*---------------------------------------------------------------------------*/
+#if JSON_CBOR
+/* write the initial byte of a data item with its argument */
+static void
+cbor_head(const struct jsontree_context *js_ctx, uint8_t major, uint32_t arg)
+{
+  char head[5];
+  int len, i;
+
+  if(arg < 24) {
+    head[0] = major << 5 | arg;
+    len = 1;
+  } else if(arg < 0x100) {
+    head[0] = major << 5 | 24;
+    len = 2;
+  } else if(arg < 0x10000) {
+    head[0] = major << 5 | 25;
+    len = 3;
+  } else {
+    head[0] = major << 5 | 26;
+    len = 5;
+  }
+  for(i = len - 1; i > 0; i--) {
+    head[i] = arg & 0xff;
+    arg >>= 8;
+  }
+  jsontree_write_span(js_ctx, head, len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+cbor_int(const struct jsontree_context *js_ctx, long value)
+{
+  if(value < 0) {
+    cbor_head(js_ctx, 1, -1 - value);
+  } else {
+    cbor_head(js_ctx, 0, value);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Decimal numbers become integers or decimal fractions, the literals
+   become simple values, and other atoms are written as text. */
+static void
+cbor_atom(const struct jsontree_context *js_ctx, const char *text)
+{
+  const char *p;
+  long mantissa;
+  int exponent, digits, point;
+
+  if(strcmp(text, "true") == 0) {
+    cbor_head(js_ctx, 7, 21);
+    return;
+  } else if(strcmp(text, "false") == 0) {
+    cbor_head(js_ctx, 7, 20);
+    return;
+  } else if(strcmp(text, "null") == 0) {
+    cbor_head(js_ctx, 7, 22);
+    return;
+  }
+
+  mantissa = 0;
+  exponent = digits = point = 0;
+  for(p = *text == '-' ? text + 1 : text; *p != '\0'; p++) {
+    if(*p >= '0' && *p <= '9' && digits < 9) {
+      mantissa = mantissa * 10 + (*p - '0');
+      digits++;
+      exponent -= point;
+    } else if(*p == '.' && !point) {
+      point = 1;
+    } else {
+      break;
+    }
+  }
+
+  if(*p != '\0' || digits == 0) {
+    cbor_head(js_ctx, 3, strlen(text));
+    jsontree_write_span(js_ctx, text, strlen(text));
+    return;
+  }
+  if(*text == '-') {
+    mantissa = -mantissa;
+  }
+  if(exponent == 0) {
+    cbor_int(js_ctx, mantissa);
+  } else {
+    cbor_head(js_ctx, 6, 4);
+    cbor_head(js_ctx, 4, 2);
+    cbor_int(js_ctx, exponent);
+    cbor_int(js_ctx, mantissa);
+  }
+}
+#endif /* JSON_CBOR */
 /*---------------------------------------------------------------------------*/
 void
 jsontree_write_atom(const struct jsontree_context *js_ctx, const char *text)
 {
   if(text == NULL) {
-    js_ctx->putchar('0');
-  } else {
+    text = "0";
+  }
+  if(js_ctx->writer == NULL) {
     while(*text != '\0') {
       js_ctx->putchar(*text++);
     }
+    return;
   }
+#if JSON_CBOR
+  if(IS_CBOR(js_ctx)) {
+    cbor_atom(js_ctx, text);
+    return;
+  }
+#endif /* JSON_CBOR */
+  jsontree_write_span(js_ctx, text, strlen(text));
 }
 /*---------------------------------------------------------------------------*/
-void
-jsontree_write_string(const struct jsontree_context *js_ctx, const char *text)
+/* Write a quoted string between an optional prefix and suffix. Short
+   strings without characters to escape are written as one span. */
+static void
+write_string(const struct jsontree_context *js_ctx, const char *prefix,
+             const char *text, char suffix)
 {
-  js_ctx->putchar('"');
-  if(text != NULL) {
+  char buf[JSONTREE_STRING_BUFFER_SIZE];
+  const char *start;
+  int len;
+
+  if(text == NULL) {
+    text = "";
+  }
+
+  /* Without a writer, the characters go to putchar one at a time
+     anyway and are not assembled first. */
+  if(js_ctx->writer == NULL) {
+    if(prefix != NULL) {
+      while(*prefix != '\0') {
+        js_ctx->putchar(*prefix++);
+      }
+    }
+    js_ctx->putchar('"');
     while(*text != '\0') {
-      if(*text == '"') {
+      if(*text == '"' || *text == '\\') {
         js_ctx->putchar('\\');
       }
       js_ctx->putchar(*text++);
     }
+    js_ctx->putchar('"');
+    if(suffix != '\0') {
+      js_ctx->putchar(suffix);
+    }
+    return;
+  }
+
+#if JSON_CBOR
+  if(IS_CBOR(js_ctx)) {
+    len = strlen(text);
+    cbor_head(js_ctx, 3, len);
+    jsontree_write_span(js_ctx, text, len);
+    return;
+  }
+#endif /* JSON_CBOR */
+
+  len = 0;
+  if(prefix != NULL) {
+    while(*prefix != '\0') {
+      buf[len++] = *prefix++;
+    }
   }
-  js_ctx->putchar('"');
+  buf[len++] = '"';
+  while(*text != '\0' && *text != '"' && *text != '\\' &&
+        len < sizeof(buf) - 2) {
+    buf[len++] = *text++;
+  }
+
+  if(*text != '\0') {
+    jsontree_write_span(js_ctx, buf, len);
+    for(start = text; *text != '\0'; text++) {
+      if(*text == '"' || *text == '\\') {
+        jsontree_write_span(js_ctx, start, text - start);
+        jsontree_putchar(js_ctx, '\\');
+        start = text;
+      }
+    }
+    jsontree_write_span(js_ctx, start, text - start);
+    len = 0;
+  }
+
+  buf[len++] = '"';
+  if(suffix != '\0') {
+    buf[len++] = suffix;
+  }
+  jsontree_write_span(js_ctx, buf, len);
+}
+/*---------------------------------------------------------------------------*/
+void
+jsontree_write_string(const struct jsontree_context *js_ctx, const char *text)
+{
+  write_string(js_ctx, NULL, text, '\0');
 }
 /*---------------------------------------------------------------------------*/
 void
 jsontree_write_int(const struct jsontree_context *js_ctx, int value)
 {
-  char buf[10];
+  char buf[12];
+  unsigned int u;
   int l;
 
-  if(value < 0) {
-    js_ctx->putchar('-');
-    value = -value;
+#if JSON_CBOR
+  if(IS_CBOR(js_ctx)) {
+    cbor_int(js_ctx, value);
+    return;
   }
+#endif /* JSON_CBOR */
 
-  l = sizeof(buf) - 1;
+  u = value < 0 ? -(unsigned int)value : (unsigned int)value;
+  l = sizeof(buf);
   do {
-    buf[l--] = '0' + (value % 10);
-    value /= 10;
-  } while(value > 0 && l >= 0);
+    buf[--l] = '0' + (u % 10);
+    u /= 10;
+  } while(u > 0);
+  if(value < 0) {
+    buf[--l] = '-';
+  }
 
-  while(++l < sizeof(buf)) {
-    js_ctx->putchar(buf[l]);
+  if(js_ctx->writer == NULL) {
+    while(l < sizeof(buf)) {
+      js_ctx->putchar(buf[l++]);
+    }
+  } else {
+    jsontree_write_span(js_ctx, buf + l, sizeof(buf) - l);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -106,11 +362,28 @@ jsontree_setup(struct jsontree_context *js_ctx, struct jsontree_value *root,
 {
   js_ctx->values[0] = root;
   js_ctx->putchar = putchar;
+  js_ctx->writer = NULL;
+  js_ctx->format = JSONTREE_FORMAT_JSON;
   js_ctx->path = 0;
   jsontree_reset(js_ctx);
 }
 /*---------------------------------------------------------------------------*/
 void
+jsontree_setup_writer(struct jsontree_context *js_ctx,
+                      struct jsontree_value *root,
+                      struct jsontree_writer *writer, uint8_t format)
+{
+  jsontree_setup(js_ctx, root, writer_putchar);
+  writer->len = 0;
+  if(writer->buf == NULL) {
+    writer->size = 0;
+  }
+  js_ctx->writer = writer;
+  js_ctx->format = format;
+  writer_ctx = js_ctx;
+}
+/*---------------------------------------------------------------------------*/
+void
 jsontree_reset(struct jsontree_context *js_ctx)
 {
   js_ctx->depth = 0;
@@ -134,6 +407,9 @@ jsontree_print_next(struct jsontree_context *js_ctx)
   int index;
 
   v = js_ctx->values[js_ctx->depth];
+  if(js_ctx->writer != NULL) {
+    writer_ctx = js_ctx;
+  }
 
   /* Default operation after switch is to back up one level */
   switch(v->type) {
@@ -141,27 +417,60 @@ jsontree_print_next(struct jsontree_context *js_ctx)
   case JSON_TYPE_ARRAY: {
     struct jsontree_array *o = (struct jsontree_array *)v;
     struct jsontree_value *ov;
+    const char *prefix;
 
     index = js_ctx->index[js_ctx->depth];
-    if(index == 0) {
-      js_ctx->putchar(v->type);
-      js_ctx->putchar('\n');
-    }
-    if(index >= o->count) {
-      js_ctx->putchar('\n');
-      js_ctx->putchar(v->type + 2);
-      /* Default operation: back up one level! */
-      break;
+    prefix = NULL;
+    if(js_ctx->writer == NULL) {
+      /* Without a writer, every character goes to putchar directly. */
+      if(index == 0) {
+        js_ctx->putchar(v->type);
+        js_ctx->putchar('\n');
+      }
+      if(index >= o->count) {
+        js_ctx->putchar('\n');
+        js_ctx->putchar(v->type + 2);
+        /* Default operation: back up one level! */
+        break;
+      }
+      if(index > 0) {
+        js_ctx->putchar(',');
+        js_ctx->putchar('\n');
+      }
+    } else if(IS_CBOR(js_ctx)) {
+#if JSON_CBOR
+      /* Containers are prefixed with their size and need no separators. */
+      if(index == 0) {
+        cbor_head(js_ctx, v->type == JSON_TYPE_OBJECT ? 5 : 4, o->count);
+      }
+      if(index >= o->count) {
+        break;
+      }
+#endif /* JSON_CBOR */
+    } else {
+      if(index == 0) {
+        char start[2] = { v->type, '\n' };
+        jsontree_write_span(js_ctx, start, 2);
+      }
+      if(index >= o->count) {
+        char end[2] = { '\n', v->type + 2 };
+        jsontree_write_span(js_ctx, end, 2);
+        /* Default operation: back up one level! */
+        break;
+      }
+      if(index > 0) {
+        /* The separator goes out in the same span as the next name. */
+        if(v->type == JSON_TYPE_OBJECT) {
+          prefix = ",\n";
+        } else {
+          jsontree_write_span(js_ctx, ",\n", 2);
+        }
+      }
     }
 
-    if(index > 0) {
-      js_ctx->putchar(',');
-      js_ctx->putchar('\n');
-    }
     if(v->type == JSON_TYPE_OBJECT) {
-      jsontree_write_string(js_ctx,
-                            ((struct jsontree_object *)o)->pairs[index].name);
-      js_ctx->putchar(':');
+      write_string(js_ctx, prefix,
+                   ((struct jsontree_object *)o)->pairs[index].name, ':');
       ov = ((struct jsontree_object *)o)->pairs[index].value;
     } else {
       ov = o->values[index];
@@ -209,6 +518,9 @@ jsontree_print_next(struct jsontree_context *js_ctx)
     js_ctx->index[js_ctx->depth]++;
     return 1;
   }
+  if(js_ctx->writer != NULL) {
+    jsontree_flush(js_ctx);
+  }
   return 0;
 }
 /*---------------------------------------------------------------------------*/
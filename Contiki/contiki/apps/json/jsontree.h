@@ -49,10 +49,26 @@
 #define JSONTREE_MAX_DEPTH 10
 #endif /* JSONTREE_CONF_MAX_DEPTH */
 
+/* The output formats of a writer. */
+#define JSONTREE_FORMAT_JSON 0
+#define JSONTREE_FORMAT_CBOR 1
+
+/* Collects the spans of the output in buf and passes them to write
+   when buf is full. Spans are written directly if buf is NULL. */
+struct jsontree_writer {
+  int (* write)(const char *data, int len);
+  char *buf;
+  uint16_t size;
+  uint16_t len;
+};
+
 struct jsontree_context {
   struct jsontree_value *values[JSONTREE_MAX_DEPTH];
   uint16_t index[JSONTREE_MAX_DEPTH];
   int (* putchar)(int);
+  /* receives the output if set up, and putchar then feeds it */
+  struct jsontree_writer *writer;
+  uint8_t format;
   uint8_t depth;
   uint8_t path;
   int callback_state;
@@ -118,11 +134,35 @@ struct jsontree_array {
 
 void jsontree_setup(struct jsontree_context *js_ctx,
                     struct jsontree_value *root, int (* putchar)(int));
+
+/**
+ * \brief      Set up a context that writes whole spans.
+ * \param js_ctx A pointer to a JSON tree context
+ * \param root The root of the tree
+ * \param writer The function and the buffer that the output goes to
+ * \param format JSONTREE_FORMAT_JSON, or JSONTREE_FORMAT_CBOR if JSON_CBOR
+ *
+ *             Output is collected in the buffer of the writer in spans
+ *             such as a string or a number instead of one character at
+ *             a time. The buffer is flushed when it is full and when
+ *             jsontree_print_next() has printed the tree. Callbacks of
+ *             the tree should write through the jsontree_write functions
+ *             and jsontree_putchar(). The putchar of the context also
+ *             writes to the writer, one character at a time. For CBOR,
+ *             a callback writes a single value.
+ */
+void jsontree_setup_writer(struct jsontree_context *js_ctx,
+                           struct jsontree_value *root,
+                           struct jsontree_writer *writer, uint8_t format);
+void jsontree_flush(const struct jsontree_context *js_ctx);
 void jsontree_reset(struct jsontree_context *js_ctx);
 
 const char *jsontree_path_name(const struct jsontree_context *js_ctx,
                                int depth);
 
+void jsontree_putchar(const struct jsontree_context *js_ctx, int c);
+void jsontree_write_span(const struct jsontree_context *js_ctx,
+                         const char *data, int len);
 void jsontree_write_int(const struct jsontree_context *js_ctx, int value);
 void jsontree_write_atom(const struct jsontree_context *js_ctx,
                          const char *text);
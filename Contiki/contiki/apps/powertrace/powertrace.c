@@ -43,6 +43,9 @@
 #include "sys/compower.h"
 #include "powertrace.h"
 #include "net/rime.h"
+#if POWERTRACE_BATCH_RECORDS > 0
+#include "telemetry.h"
+#endif
 
 #include <stdio.h>
 #include <string.h>
@@ -68,6 +71,8 @@ struct powertrace_sniff_stats {
 MEMB(stats_memb, struct powertrace_sniff_stats, MAX_NUM_STATS);
 LIST(stats_list);
 
+static uint32_t seqno;
+
 PROCESS(powertrace_process, "Periodic power output");
 /*---------------------------------------------------------------------------*/
 void
@@ -81,8 +86,6 @@ powertrace_print(char *str)
   uint32_t idle_transmit, idle_listen;
   uint32_t all_idle_transmit, all_idle_listen;
 
-  static uint32_t seqno;
-
   uint32_t time, all_time, radio, all_radio;
   
   struct powertrace_sniff_stats *s;
@@ -192,6 +195,85 @@ powertrace_print(char *str)
   seqno++;
 }
 /*---------------------------------------------------------------------------*/
+#if POWERTRACE_BATCH_RECORDS > 0
+TELEMETRY_BATCH(batch, TELEMETRY_POWERTRACE_FIELDS, POWERTRACE_BATCH_SIZE);
+
+static void (*batch_output)(const uint8_t *data, int len);
+/*---------------------------------------------------------------------------*/
+void
+powertrace_output(void (*output)(const uint8_t *data, int len))
+{
+  batch_output = output;
+}
+/*---------------------------------------------------------------------------*/
+void
+powertrace_flush(void)
+{
+  static const char hex[16] = "0123456789abcdef";
+  const uint8_t *data;
+  char line[2 * 16 + 1];
+  int i, n;
+
+  if(telemetry_records(&batch) == 0) {
+    return;
+  }
+
+  if(batch_output != NULL) {
+    batch_output(telemetry_data(&batch), telemetry_len(&batch));
+  } else {
+    /* The digits are printed 16 bytes at a time, rather than with a
+       printf() for each byte. */
+    data = telemetry_data(&batch);
+    printf("TB ");
+    for(i = n = 0; i < telemetry_len(&batch); i++) {
+      line[n++] = hex[data[i] >> 4];
+      line[n++] = hex[data[i] & 0xf];
+      if(n == sizeof(line) - 1 || i == telemetry_len(&batch) - 1) {
+        line[n] = '\0';
+        printf("%s", line);
+        n = 0;
+      }
+    }
+    printf("\n");
+  }
+  telemetry_clear(&batch);
+}
+/*---------------------------------------------------------------------------*/
+void
+powertrace_record(void)
+{
+  uint32_t values[TELEMETRY_POWERTRACE_FIELDS];
+
+  energest_flush();
+
+  values[0] = clock_time();
+  values[1] = (rimeaddr_node_addr.u8[0] << 8) | rimeaddr_node_addr.u8[1];
+  values[2] = energest_type_time(ENERGEST_TYPE_CPU);
+  values[3] = energest_type_time(ENERGEST_TYPE_LPM);
+  values[4] = energest_type_time(ENERGEST_TYPE_TRANSMIT);
+  values[5] = energest_type_time(ENERGEST_TYPE_LISTEN);
+  values[6] = compower_idle_activity.transmit;
+  values[7] = compower_idle_activity.listen;
+
+  if(telemetry_records(&batch) == 0) {
+    telemetry_start(&batch, &telemetry_powertrace_schema, seqno,
+                    TELEMETRY_FLAG_SKIP);
+  }
+  if(!telemetry_add(&batch, values)) {
+    /* The batch is full before its number of records was reached. */
+    powertrace_flush();
+    telemetry_start(&batch, &telemetry_powertrace_schema, seqno,
+                    TELEMETRY_FLAG_SKIP);
+    telemetry_add(&batch, values);
+  }
+  seqno++;
+
+  if(telemetry_records(&batch) >= POWERTRACE_BATCH_RECORDS) {
+    powertrace_flush();
+  }
+}
+#endif /* POWERTRACE_BATCH_RECORDS > 0 */
+/*---------------------------------------------------------------------------*/
 PROCESS_THREAD(powertrace_process, ev, data)
 {
   static struct etimer periodic;
@@ -208,7 +290,11 @@ PROCESS_THREAD(powertrace_process, ev, data)
   while(1) {
     PROCESS_WAIT_UNTIL(etimer_expired(&periodic));
     etimer_reset(&periodic);
+#if POWERTRACE_BATCH_RECORDS > 0
+    powertrace_record();
+#else
     powertrace_print("");
+#endif
   }
 
   PROCESS_END();
@@ -224,6 +310,9 @@ void
 powertrace_stop(void)
 {
   process_exit(&powertrace_process);
+#if POWERTRACE_BATCH_RECORDS > 0
+  powertrace_flush();
+#endif
 }
 /*---------------------------------------------------------------------------*/
 static void
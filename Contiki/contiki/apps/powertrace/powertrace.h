@@ -43,6 +43,20 @@
 
 #include "sys/clock.h"
 
+/* The number of periods that are batched into one binary telemetry
+   record, instead of printing a line of text every period. */
+#ifdef POWERTRACE_CONF_BATCH_RECORDS
+#define POWERTRACE_BATCH_RECORDS POWERTRACE_CONF_BATCH_RECORDS
+#else
+#define POWERTRACE_BATCH_RECORDS 0
+#endif
+
+#ifdef POWERTRACE_CONF_BATCH_SIZE
+#define POWERTRACE_BATCH_SIZE POWERTRACE_CONF_BATCH_SIZE
+#else
+#define POWERTRACE_BATCH_SIZE 96
+#endif
+
 void powertrace_start(clock_time_t perioc);
 void powertrace_stop(void);
 
@@ -55,4 +69,27 @@ void powertrace_sniff(powertrace_onoff_t onoff);
 
 void powertrace_print(char *str);
 
+#if POWERTRACE_BATCH_RECORDS > 0
+/**
+ * \brief      Add the current counters to the telemetry batch.
+ *
+ *             The batch is output when it has POWERTRACE_BATCH_RECORDS
+ *             records, or when it is full. The format is described
+ *             in apps/telemetry/telemetry.h.
+ */
+void powertrace_record(void);
+
+/**
+ * \brief      Output the records of the telemetry batch, if any.
+ */
+void powertrace_flush(void);
+
+/**
+ * \brief      Set the function that outputs telemetry batches.
+ * \param output The function, or NULL to print each batch as a
+ *             "TB" line of hexadecimal digits.
+ */
+void powertrace_output(void (*output)(const uint8_t *data, int len));
+#endif /* POWERTRACE_BATCH_RECORDS > 0 */
+
 #endif /* POWERTRACE_H */
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2012, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *	COBS encoding and decoding of the frames of the serial
+ *	multiplexer.
+ */
+
+#include "serial-mux-frame.h"
+#include "lib/crc16.h"
+
+/*---------------------------------------------------------------------------*/
+static void
+put(struct serial_mux_encoder *e, uint8_t c)
+{
+  if(c == 0) {
+    e->buf[e->code_pos] = e->code;
+    e->code_pos = e->len++;
+    e->code = 1;
+  } else {
+    e->buf[e->len++] = c;
+    if(++e->code == 0xff) {
+      e->buf[e->code_pos] = e->code;
+      e->code_pos = e->len++;
+      e->code = 1;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+serial_mux_encode_start(struct serial_mux_encoder *e,
+			uint8_t *buf, int size, uint8_t stream)
+{
+  e->buf = buf;
+  e->size = size;
+  e->code_pos = 0;
+  e->len = 1;
+  e->code = 1;
+  e->crc = crc16_add(stream, 0);
+  put(e, stream);
+}
+/*---------------------------------------------------------------------------*/
+int
+serial_mux_encode_add(struct serial_mux_encoder *e,
+		      const void *data, int len)
+{
+  const uint8_t *p;
+  uint16_t crc;
+  int i;
+
+  /* Each byte of the payload and the CRC takes one byte, a code byte
+     is added whenever a block reaches 254 bytes, and the frame ends
+     with a zero byte. */
+  if(e->len + len + 3 + (e->code + len + 1) / 254 > e->size) {
+    return 0;
+  }
+
+  p = data;
+  crc = e->crc;
+  for(i = 0; i < len; i++) {
+    crc = crc16_add(p[i], crc);
+    put(e, p[i]);
+  }
+  e->crc = crc;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+serial_mux_encode_end(struct serial_mux_encoder *e)
+{
+  put(e, e->crc & 0xff);
+  put(e, e->crc >> 8);
+  e->buf[e->code_pos] = e->code;
+  e->buf[e->len++] = 0;
+  return e->len;
+}
+/*---------------------------------------------------------------------------*/
+void
+serial_mux_decoder_init(struct serial_mux_decoder *d, uint8_t *buf, int size)
+{
+  d->buf = buf;
+  d->size = size;
+  d->len = 0;
+  d->left = 0;
+  d->zero = 0;
+  d->error = 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+serial_mux_decode(struct serial_mux_decoder *d,
+		  const uint8_t *data, int len, int *used)
+{
+  int i, n;
+  uint8_t c;
+
+  for(i = 0; i < len; i++) {
+    c = data[i];
+    if(c == 0) {
+      /* The end of a frame. The zero that would follow its last
+         block is not part of it. */
+      n = d->len;
+      if(n == 0 && d->left == 0 && !d->error) {
+        continue;
+      }
+      *used = i + 1;
+      if(d->error || d->left != 0 || n < 3 ||
+         crc16_data(d->buf, n - 2, 0) !=
+         (d->buf[n - 2] | (d->buf[n - 1] << 8))) {
+        serial_mux_decoder_init(d, d->buf, d->size);
+        return -1;
+      }
+      d->len = 0;
+      d->zero = 0;
+      return n - 3;
+    }
+    if(d->error) {
+      continue;
+    }
+    if(d->left == 0) {
+      /* A code byte, which ends the previous block. */
+      if(d->zero) {
+        if(d->len == d->size) {
+          d->error = 1;
+          continue;
+        }
+        d->buf[d->len++] = 0;
+      }
+      d->zero = c != 0xff;
+      d->left = c - 1;
+    } else if(d->len == d->size) {
+      d->error = 1;
+    } else {
+      d->buf[d->len++] = c;
+      d->left--;
+    }
+  }
+  *used = len;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
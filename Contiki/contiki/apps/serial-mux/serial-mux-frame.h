@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2012, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *	Framing of the serial multiplexer. The encoder and the decoder
+ *	use nothing but standard C and lib/crc16.c, so that they can be
+ *	built into host tools.
+ *
+ *	A frame has a one-byte stream identifier, the payload, and the
+ *	CRC16 of lib/crc16.c over the identifier and the payload, least
+ *	significant byte first. Frames are encoded with Consistent
+ *	Overhead Byte Stuffing (COBS), which removes all zero bytes at a
+ *	cost of one byte in 254, and each frame is followed by a zero
+ *	byte. A receiver thus finds the start of the next frame after
+ *	any error by waiting for a zero byte, and zero bytes alone are
+ *	ignored.
+ */
+
+#ifndef SERIAL_MUX_FRAME_H
+#define SERIAL_MUX_FRAME_H
+
+#include <stdint.h>
+
+/* The largest size of an encoded frame with a payload of len bytes. */
+#define SERIAL_MUX_ENCODED_SIZE(len)	((len) + 3 + ((len) + 3) / 254 + 2)
+
+struct serial_mux_encoder {
+  uint8_t *buf;
+  uint16_t size;
+  uint16_t len;
+  uint16_t code_pos;
+  uint16_t crc;
+  uint8_t code;
+};
+
+/**
+ * \brief	Start encoding a frame.
+ * \param e	The encoder.
+ * \param buf	The buffer of the encoded frame.
+ * \param size	The size of the buffer.
+ * \param stream The stream identifier.
+ */
+void serial_mux_encode_start(struct serial_mux_encoder *e,
+			     uint8_t *buf, int size, uint8_t stream);
+
+/**
+ * \brief	Add payload to a frame.
+ * \param e	The encoder.
+ * \param data	The payload.
+ * \param len	The number of bytes of payload.
+ * \return	1 if the payload was added, or 0 if the frame could
+ *		not be ended in the buffer with it.
+ */
+int serial_mux_encode_add(struct serial_mux_encoder *e,
+			  const void *data, int len);
+
+/**
+ * \brief	End a frame.
+ * \param e	The encoder.
+ * \return	The size of the encoded frame at e->buf, including the
+ *		zero byte that ends it.
+ */
+int serial_mux_encode_end(struct serial_mux_encoder *e);
+
+struct serial_mux_decoder {
+  uint8_t *buf;
+  uint16_t size;
+  uint16_t len;
+  uint8_t left;
+  uint8_t zero;
+  uint8_t error;
+};
+
+/**
+ * \brief	Initialize a decoder.
+ * \param d	The decoder.
+ * \param buf	The buffer of the decoded frame. A frame with a payload
+ *		of n bytes needs n + 3 bytes.
+ * \param size	The size of the buffer.
+ */
+void serial_mux_decoder_init(struct serial_mux_decoder *d,
+			     uint8_t *buf, int size);
+
+/**
+ * \brief	Decode received bytes.
+ * \param d	The decoder.
+ * \param data	The received bytes.
+ * \param len	The number of received bytes.
+ * \param used	Set to the number of bytes that were decoded.
+ * \return	The payload size of a frame that was decoded, 0 if all
+ *		bytes were decoded without ending a frame, or -1 if a
+ *		frame was malformed, too large or had the wrong CRC.
+ *
+ *		A decoded frame has the stream identifier at d->buf[0]
+ *		and the payload from d->buf[1], until the next call.
+ *		The bytes after the first *used ones are passed in the
+ *		next call.
+ */
+int serial_mux_decode(struct serial_mux_decoder *d,
+		      const uint8_t *data, int len, int *used);
+
+#endif /* SERIAL_MUX_FRAME_H */
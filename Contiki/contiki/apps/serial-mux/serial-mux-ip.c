@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2012, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *	IP packets on the IP stream of the serial multiplexer, in place
+ *	of SLIP. The host side is tools/serial-demux, which turns the
+ *	stream back into SLIP for tunslip6.
+ */
+
+#include <string.h>
+
+#include "contiki.h"
+#include "net/uip.h"
+#include "net/uip-fw.h"
+#include "serial-mux.h"
+
+static void ip_input(const uint8_t *data, int len);
+
+static struct serial_mux_stream ip_stream = {NULL, SERIAL_MUX_IP, ip_input};
+
+/*---------------------------------------------------------------------------*/
+static void
+ip_input(const uint8_t *data, int len)
+{
+  if(len > UIP_BUFSIZE - UIP_LLH_LEN) {
+    return;
+  }
+  memcpy(&uip_buf[UIP_LLH_LEN], data, len);
+  uip_len = len;
+#ifdef SLIP_CONF_TCPIP_INPUT
+  SLIP_CONF_TCPIP_INPUT();
+#else
+  tcpip_input();
+#endif
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+serial_mux_ip_send(void)
+{
+  int hlen;
+
+  /* The headers and the data may be apart, as in slip_send(). */
+  hlen = uip_len < UIP_TCPIP_HLEN ? uip_len : UIP_TCPIP_HLEN;
+  if(uip_len > SERIAL_MUX_FRAME_SIZE) {
+    return UIP_FW_TOOLARGE;
+  }
+  serial_mux_flush();
+  serial_mux_queue(SERIAL_MUX_IP, &uip_buf[UIP_LLH_LEN], hlen);
+  if(uip_len > hlen) {
+    serial_mux_queue(SERIAL_MUX_IP, uip_appdata, uip_len - hlen);
+  }
+  serial_mux_flush();
+  return UIP_FW_OK;
+}
+/*---------------------------------------------------------------------------*/
+void
+serial_mux_ip_init(void)
+{
+  serial_mux_register(&ip_stream);
+}
+/*---------------------------------------------------------------------------*/
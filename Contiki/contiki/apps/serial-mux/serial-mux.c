@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2012, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *	A serial multiplexer of framed binary streams.
+ */
+
+#include <string.h>
+
+#include "contiki.h"
+#include "lib/list.h"
+#include "serial-mux.h"
+
+#if (SERIAL_MUX_RX_SIZE & (SERIAL_MUX_RX_SIZE - 1)) != 0
+#error SERIAL_MUX_CONF_RX_SIZE must be a power of two.
+#endif
+
+#define TX_SIZE SERIAL_MUX_ENCODED_SIZE(SERIAL_MUX_FRAME_SIZE)
+
+PROCESS(serial_mux_process, "Serial multiplexer");
+
+LIST(streams);
+
+struct serial_mux_stats serial_mux_stats;
+
+static void (*output)(const uint8_t *data, int len);
+
+/* The receive buffer is written by serial_mux_input() and read by the
+   process, each of which moves only its own index. */
+static uint8_t rx_buf[SERIAL_MUX_RX_SIZE];
+static volatile uint16_t rx_put, rx_get;
+static volatile uint8_t rx_overflow;
+
+static struct serial_mux_decoder decoder;
+static uint8_t frame[SERIAL_MUX_FRAME_SIZE + 3];
+
+/* Frames are encoded in one of two buffers in turn, so that the
+   previous one can still be transmitted. */
+static uint8_t tx_buf[2][TX_SIZE];
+static uint8_t tx_current;
+static struct serial_mux_encoder encoder;
+static uint16_t queued_len;
+static int16_t queued_stream = -1;
+
+/*---------------------------------------------------------------------------*/
+void
+serial_mux_register(struct serial_mux_stream *s)
+{
+  list_add(streams, s);
+}
+/*---------------------------------------------------------------------------*/
+/* Bytes that do not fit are lost until there is room again, and a
+   zero byte is then put in their place. It ends the frame that they
+   were part of, which thus fails its CRC. */
+static int
+mark_overflow(uint16_t put)
+{
+  if(((put + 1) & (SERIAL_MUX_RX_SIZE - 1)) == rx_get) {
+    return 0;
+  }
+  rx_buf[put] = 0;
+  rx_put = (put + 1) & (SERIAL_MUX_RX_SIZE - 1);
+  rx_overflow = 0;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+serial_mux_input(const uint8_t *data, int len)
+{
+  uint16_t put, room, n;
+
+  if(rx_overflow && !mark_overflow(rx_put)) {
+    return 0;
+  }
+
+  put = rx_put;
+  room = (rx_get - put - 1) & (SERIAL_MUX_RX_SIZE - 1);
+  if(len > room) {
+    len = room;
+    rx_overflow = 1;
+    serial_mux_stats.rx_overflows++;
+  }
+  while(len > 0) {
+    n = SERIAL_MUX_RX_SIZE - put;
+    if(n > len) {
+      n = len;
+    }
+    memcpy(&rx_buf[put], data, n);
+    put = (put + n) & (SERIAL_MUX_RX_SIZE - 1);
+    data += n;
+    len -= n;
+  }
+  rx_put = put;
+
+  process_poll(&serial_mux_process);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+serial_mux_input_byte(unsigned char c)
+{
+  uint16_t put;
+
+  if(rx_overflow && !mark_overflow(rx_put)) {
+    return 0;
+  }
+
+  put = rx_put;
+  if(((put + 1) & (SERIAL_MUX_RX_SIZE - 1)) == rx_get) {
+    rx_overflow = 1;
+    serial_mux_stats.rx_overflows++;
+    process_poll(&serial_mux_process);
+    return 1;
+  }
+  rx_buf[put] = c;
+  put = (put + 1) & (SERIAL_MUX_RX_SIZE - 1);
+  rx_put = put;
+
+  /* The process is needed at the end of a frame, or to make room for
+     a frame that is longer than half of the buffer. */
+  if(c == 0 ||
+     ((put - rx_get) & (SERIAL_MUX_RX_SIZE - 1)) == SERIAL_MUX_RX_SIZE / 2) {
+    process_poll(&serial_mux_process);
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+dispatch(int len)
+{
+  struct serial_mux_stream *s;
+
+  serial_mux_stats.rx_frames++;
+  for(s = list_head(streams); s != NULL; s = list_item_next(s)) {
+    if(s->id == frame[0]) {
+      s->input(&frame[1], len);
+      return;
+    }
+  }
+  serial_mux_stats.rx_unknown++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+receive(void)
+{
+  uint16_t get, put;
+  int len, used;
+
+  get = rx_get;
+  while(get != (put = rx_put)) {
+    len = (put > get ? put : SERIAL_MUX_RX_SIZE) - get;
+    len = serial_mux_decode(&decoder, &rx_buf[get], len, &used);
+    get = (get + used) & (SERIAL_MUX_RX_SIZE - 1);
+    rx_get = get;
+    if(len > 0) {
+      dispatch(len);
+    } else if(len < 0) {
+      serial_mux_stats.rx_errors++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+start_frame(uint8_t stream)
+{
+  serial_mux_encode_start(&encoder, tx_buf[tx_current], TX_SIZE, stream);
+  queued_stream = stream;
+  queued_len = 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+serial_mux_flush(void)
+{
+  int len;
+
+  if(queued_stream < 0) {
+    return;
+  }
+  len = serial_mux_encode_end(&encoder);
+  queued_stream = -1;
+  serial_mux_stats.tx_frames++;
+  serial_mux_stats.tx_bytes += len;
+  if(output != NULL) {
+    output(tx_buf[tx_current], len);
+  }
+  tx_current ^= 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+serial_mux_queue(uint8_t stream, const void *data, int len)
+{
+  if(len > SERIAL_MUX_FRAME_SIZE) {
+    return 0;
+  }
+  if(queued_stream != stream ||
+     queued_len + len > SERIAL_MUX_FRAME_SIZE) {
+    serial_mux_flush();
+  }
+  if(queued_stream < 0) {
+    start_frame(stream);
+    process_poll(&serial_mux_process);
+  }
+  serial_mux_encode_add(&encoder, data, len);
+  queued_len += len;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+serial_mux_send(uint8_t stream, const void *data, int len)
+{
+  if(len > SERIAL_MUX_FRAME_SIZE) {
+    return 0;
+  }
+  serial_mux_flush();
+  start_frame(stream);
+  serial_mux_encode_add(&encoder, data, len);
+  serial_mux_flush();
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(serial_mux_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+    receive();
+    serial_mux_flush();
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+void
+serial_mux_init(void (*out)(const uint8_t *data, int len))
+{
+  output = out;
+  list_init(streams);
+  serial_mux_decoder_init(&decoder, frame, sizeof(frame));
+  process_start(&serial_mux_process, NULL);
+}
+/*---------------------------------------------------------------------------*/
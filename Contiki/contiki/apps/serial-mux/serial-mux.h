@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2012, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *	A serial multiplexer. Logical streams, such as the shell, IP
+ *	packets, sensor samples and logs, share a serial line in
+ *	binary frames with a CRC16, in the format that
+ *	serial-mux-frame.h describes.
+ *
+ *	The UART driver passes received bytes to serial_mux_input(),
+ *	either in blocks, as from a DMA transfer, or one at a time from
+ *	an interrupt handler, and the frames are decoded and handed to
+ *	the streams by the serial_mux_process. Outgoing frames are
+ *	passed to the output function of the driver as whole blocks.
+ *
+ *	On the host, tools/serial-demux separates the streams of a
+ *	node again.
+ */
+
+#ifndef SERIAL_MUX_H
+#define SERIAL_MUX_H
+
+#include "contiki.h"
+#include "serial-mux-frame.h"
+
+#define SERIAL_MUX_SHELL	1
+#define SERIAL_MUX_IP		2
+#define SERIAL_MUX_SAMPLES	3
+#define SERIAL_MUX_LOG		4
+
+/* The largest payload of a frame. IP packets need frames as large
+   as the uIP buffer. */
+#ifdef SERIAL_MUX_CONF_FRAME_SIZE
+#define SERIAL_MUX_FRAME_SIZE SERIAL_MUX_CONF_FRAME_SIZE
+#else
+#define SERIAL_MUX_FRAME_SIZE 128
+#endif
+
+/* The size of the buffer of received bytes that are not decoded yet. */
+#ifdef SERIAL_MUX_CONF_RX_SIZE
+#define SERIAL_MUX_RX_SIZE SERIAL_MUX_CONF_RX_SIZE
+#else
+#define SERIAL_MUX_RX_SIZE 256
+#endif
+
+struct serial_mux_stream {
+  struct serial_mux_stream *next;
+  uint8_t id;
+  void (*input)(const uint8_t *data, int len);
+};
+
+struct serial_mux_stats {
+  unsigned long rx_frames, rx_errors, rx_overflows, rx_unknown;
+  unsigned long tx_frames, tx_bytes;
+};
+
+extern struct serial_mux_stats serial_mux_stats;
+
+/**
+ * \brief	Start the serial multiplexer.
+ * \param output The function that transmits a block of bytes.
+ *
+ *		The bytes of a call stay unchanged until the next call
+ *		returns, so that a driver may transmit them with DMA
+ *		while the next frame is being encoded.
+ */
+void serial_mux_init(void (*output)(const uint8_t *data, int len));
+
+/**
+ * \brief	Register a stream.
+ * \param s	The stream. Its input function is called with the
+ *		payload of each frame that is received on the stream.
+ */
+void serial_mux_register(struct serial_mux_stream *s);
+
+/**
+ * \brief	Pass received bytes to the multiplexer.
+ * \param data	The bytes.
+ * \param len	The number of bytes.
+ * \return	Non-zero if the CPU should be powered up.
+ *
+ *		This function may be called from an interrupt handler.
+ *		Bytes that do not fit in the receive buffer are lost,
+ *		and so is the frame that they were part of.
+ */
+int serial_mux_input(const uint8_t *data, int len);
+
+/**
+ * \brief	Pass one received byte to the multiplexer.
+ */
+int serial_mux_input_byte(unsigned char c);
+
+/**
+ * \brief	Send a frame.
+ * \param stream The stream identifier.
+ * \param data	The payload.
+ * \param len	The size of the payload.
+ * \return	1 if the frame was sent, or 0 if it is too large.
+ */
+int serial_mux_send(uint8_t stream, const void *data, int len);
+
+/**
+ * \brief	Queue data to be sent on a stream.
+ * \param stream The stream identifier.
+ * \param data	The data.
+ * \param len	The number of bytes, at most SERIAL_MUX_FRAME_SIZE.
+ * \return	1 if the data was queued, or 0 if it is too large.
+ *
+ *		Data that is queued on the same stream is sent in one
+ *		frame, until the frame is full. The frame is sent when
+ *		data is queued on another stream, by serial_mux_flush(),
+ *		or when the multiplexer process runs next.
+ */
+int serial_mux_queue(uint8_t stream, const void *data, int len);
+
+/**
+ * \brief	Send the queued frame, if any.
+ */
+void serial_mux_flush(void);
+
+/**
+ * \brief	Send the IP packet in the uIP buffer on the IP stream,
+ *		as slip_send() does with SLIP.
+ */
+uint8_t serial_mux_ip_send(void);
+
+/**
+ * \brief	Pass the IP packets of the IP stream to tcpip_input().
+ */
+void serial_mux_ip_init(void);
+
+PROCESS_NAME(serial_mux_process);
+
+#endif /* SERIAL_MUX_H */
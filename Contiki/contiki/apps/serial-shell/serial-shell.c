@@ -50,10 +50,84 @@
 #include <stdio.h>
 #include <string.h>
 
+/* With the serial multiplexer, the shell is a stream of its frames
+   instead of the lines of the serial port. The platform starts the
+   multiplexer with the output function of its UART. */
+#ifdef SERIAL_SHELL_CONF_MUX
+#define WITH_MUX SERIAL_SHELL_CONF_MUX
+#else
+#define WITH_MUX 0
+#endif
+
+#if WITH_MUX
+#include "serial-mux.h"
+
+static void mux_input(const uint8_t *data, int len);
+
+static struct serial_mux_stream shell_stream =
+  {NULL, SERIAL_MUX_SHELL, mux_input};
+#endif /* WITH_MUX */
 
 /*---------------------------------------------------------------------------*/
 PROCESS(serial_shell_process, "Contiki serial shell");
 /*---------------------------------------------------------------------------*/
+#if WITH_MUX
+/* The output is queued, so that the lines of a command are sent
+   together in as few frames as possible. */
+static void
+queue_output(const char *text, int len)
+{
+  int n;
+
+  while(len > 0) {
+    n = len < SERIAL_MUX_FRAME_SIZE ? len : SERIAL_MUX_FRAME_SIZE;
+    serial_mux_queue(SERIAL_MUX_SHELL, text, n);
+    text += n;
+    len -= n;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+shell_default_output(const char *text1, int len1, const char *text2, int len2)
+{
+  if(text1 != NULL) {
+    queue_output(text1, len1);
+  }
+  if(text2 != NULL) {
+    queue_output(text2, len2);
+  }
+  queue_output("\r\n", 2);
+}
+/*---------------------------------------------------------------------------*/
+void
+shell_prompt(char *str)
+{
+  char buf[12];
+
+  sprintf(buf, "%d.%d: ", rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1]);
+  shell_default_output(buf, strlen(buf), str, strlen(str));
+}
+/*---------------------------------------------------------------------------*/
+/* The frames of the shell stream may end in the middle of a line, or
+   hold several lines. */
+static void
+mux_input(const uint8_t *data, int len)
+{
+  static char line[SERIAL_MUX_FRAME_SIZE + 1];
+  static int line_len;
+  int i;
+
+  for(i = 0; i < len; i++) {
+    if(data[i] == '\n') {
+      line[line_len] = '\0';
+      process_post_synch(&serial_shell_process, PROCESS_EVENT_CONTINUE, line);
+      line_len = 0;
+    } else if(data[i] != '\r' && line_len < SERIAL_MUX_FRAME_SIZE) {
+      line[line_len++] = data[i];
+    }
+  }
+}
+#else /* WITH_MUX */
 void
 shell_default_output(const char *text1, int len1, const char *text2, int len2)
 {
@@ -84,6 +158,7 @@ shell_prompt(char *str)
   printf("%d.%d: %s\r\n", rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
 	 str);
 }
+#endif /* WITH_MUX */
 /*---------------------------------------------------------------------------*/
 void
 shell_exit(void)
@@ -97,7 +172,9 @@ PROCESS_THREAD(serial_shell_process, ev, data)
   shell_init();
 
   while(1) {
-    PROCESS_WAIT_EVENT_UNTIL(ev == serial_line_event_message && data != NULL);
+    PROCESS_WAIT_EVENT_UNTIL((ev == serial_line_event_message ||
+                              (WITH_MUX && ev == PROCESS_EVENT_CONTINUE)) &&
+                             data != NULL);
     shell_input(data, strlen(data));
   }
 
@@ -107,6 +184,9 @@ PROCESS_THREAD(serial_shell_process, ev, data)
 void
 serial_shell_init(void)
 {
+#if WITH_MUX
+  serial_mux_register(&shell_stream);
+#endif /* WITH_MUX */
   process_start(&serial_shell_process, NULL);
 }
 /*---------------------------------------------------------------------------*/
@@ -57,9 +57,15 @@ SHELL_COMMAND(dec64_command,
 	      &shell_dec64_process);
 /*---------------------------------------------------------------------------*/
 #define BASE64_MAX_LINELEN 76
+#define BASE64_MAX_DATALEN (3 * BASE64_MAX_LINELEN / 4)
+
+#if SHELL_PIPE_SIZE < BASE64_MAX_DATALEN
+#error SHELL_PIPE_SIZE must fit a decoded line of base64
+#endif
 
 struct base64_decoder_state {
-  uint8_t data[3 * BASE64_MAX_LINELEN / 4];
+  uint8_t *data;
+  int size;
   int dataptr;
   unsigned long tmpdata;
   int sextets;
@@ -91,7 +97,7 @@ base64_add_char(struct base64_decoder_state *s, char c)
     return 0;
   }
 
-  if(s->dataptr >= sizeof(s->data)) {
+  if(s->dataptr + 3 > s->size) {
     return 0;
   }
   if(c == '=') {
@@ -106,7 +112,7 @@ base64_add_char(struct base64_decoder_state *s, char c)
     s->data[s->dataptr + 1] = (uint8_t)(s->tmpdata >> 8);
     s->data[s->dataptr + 2] = (uint8_t)(s->tmpdata);
     s->dataptr += 3;
-    if(s->dataptr == sizeof(s->data)) {
+    if(s->dataptr + 3 > s->size) {
       return 0;
     } else {
       return 1;
@@ -119,18 +125,34 @@ PROCESS_THREAD(shell_dec64_process, ev, data)
 {
   struct shell_input *input;
   struct base64_decoder_state s;
+  char *buf;
   int i;
 
   PROCESS_BEGIN();
 
   while(1) {
-    PROCESS_WAIT_EVENT_UNTIL(ev == shell_event_input);
+    PROCESS_WAIT_EVENT_UNTIL(ev == shell_event_input || ev == shell_event_pipe);
+    if(ev == shell_event_pipe) {
+      shell_input_resume(&dec64_command);
+      continue;
+    }
     input = data;
 
     if(input->len1 + input->len2 == 0) {
       PROCESS_EXIT();
     }
 
+    /* Decode straight into the pipe of the next command, and wait
+       until there is room for a full line. */
+    s.size = shell_output_reserve(&dec64_command, &buf, BASE64_MAX_DATALEN);
+    if(s.size == 0) {
+      shell_input_keep(&dec64_command, input->len1 + input->len2);
+      continue;
+    }
+    if(s.size > BASE64_MAX_DATALEN) {
+      s.size = BASE64_MAX_DATALEN;
+    }
+    s.data = (uint8_t *)buf;
     s.sextets = s.dataptr = s.padding = 0;
 
     for(i = 0; i < input->len1; ++i) {
@@ -139,7 +161,7 @@ PROCESS_THREAD(shell_dec64_process, ev, data)
     for(i = 0; i < input->len2; ++i) {
       base64_add_char(&s, input->data2[i]);
     }
-    shell_output(&dec64_command, s.data, s.dataptr - s.padding, "", 0);
+    shell_output_commit(&dec64_command, s.dataptr - s.padding);
   }
   PROCESS_END();
 }
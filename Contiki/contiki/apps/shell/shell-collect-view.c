@@ -43,22 +43,41 @@
 #include "collect-view.h"
 #include "net/rime/broadcast-announcement.h"
 
+/* The number of messages in each batch of collect-view-batch. */
+#ifdef SHELL_COLLECT_VIEW_CONF_BATCH_RECORDS
+#define BATCH_RECORDS SHELL_COLLECT_VIEW_CONF_BATCH_RECORDS
+#else
+#define BATCH_RECORDS 8
+#endif
+
+#ifdef SHELL_COLLECT_VIEW_CONF_BATCH_SIZE
+#define BATCH_SIZE SHELL_COLLECT_VIEW_CONF_BATCH_SIZE
+#else
+#define BATCH_SIZE 128
+#endif
+
+TELEMETRY_BATCH(batch, TELEMETRY_COLLECT_VIEW_FIELDS, BATCH_SIZE);
+static uint32_t batch_seqno;
+
 /*---------------------------------------------------------------------------*/
 PROCESS(collect_view_data_process, "collect-view-data");
 SHELL_COMMAND(collect_view_data_command,
 	      "collect-view-data",
 	      "collect-view-data: sensor data, power consumption, network stats",
 	      &collect_view_data_process);
+PROCESS(collect_view_batch_process, "collect-view-batch");
+SHELL_COMMAND(collect_view_batch_command,
+	      "collect-view-batch",
+	      "collect-view-batch: collect-view-data batched in binary telemetry",
+	      &collect_view_batch_process);
 /*---------------------------------------------------------------------------*/
-PROCESS_THREAD(collect_view_data_process, ev, data)
+static void
+construct_message(struct collect_view_data_msg *msg)
 {
-  struct collect_view_data_msg msg;
   struct collect_neighbor *n;
   uint16_t parent_etx;
   uint16_t num_neighbors;
   uint16_t beacon_interval;
-  
-  PROCESS_BEGIN();
 
   n = collect_neighbor_list_find(&shell_collect_conn.neighbor_list,
                                  &shell_collect_conn.parent);
@@ -70,17 +89,56 @@ PROCESS_THREAD(collect_view_data_process, ev, data)
   num_neighbors = collect_neighbor_list_num(&shell_collect_conn.neighbor_list);
   beacon_interval = broadcast_announcement_beacon_interval() / CLOCK_SECOND;
 
-  collect_view_construct_message(&msg, &shell_collect_conn.parent,
+  collect_view_construct_message(msg, &shell_collect_conn.parent,
                                  parent_etx, shell_collect_conn.rtmetric,
                                  num_neighbors, beacon_interval);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(collect_view_data_process, ev, data)
+{
+  struct collect_view_data_msg msg;
+
+  PROCESS_BEGIN();
+
+  construct_message(&msg);
   shell_output(&collect_view_data_command, &msg, sizeof(msg), "", 0);
 
   PROCESS_END();
 }
 /*---------------------------------------------------------------------------*/
+static void
+output_batch(void)
+{
+  shell_output(&collect_view_batch_command, batch_telemetry_buf,
+               telemetry_len(&batch), "", 0);
+  telemetry_clear(&batch);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(collect_view_batch_process, ev, data)
+{
+  struct collect_view_data_msg msg;
+
+  PROCESS_BEGIN();
+
+  /* A batch is output only when it has BATCH_RECORDS messages, so the
+     command is meant to be run periodically, as with "repeat". */
+  construct_message(&msg);
+  if(!collect_view_batch_add(&batch, batch_seqno, &msg)) {
+    output_batch();
+    collect_view_batch_add(&batch, batch_seqno, &msg);
+  }
+  batch_seqno++;
+  if(telemetry_records(&batch) >= BATCH_RECORDS) {
+    output_batch();
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
 void
 shell_collect_view_init(void)
 {
   shell_register_command(&collect_view_data_command);
+  shell_register_command(&collect_view_batch_command);
 }
 /*---------------------------------------------------------------------------*/
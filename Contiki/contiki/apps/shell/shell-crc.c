@@ -100,36 +100,58 @@ fromhex(unsigned char c1, unsigned char c2)
   return (fromhexchar(c1)<<4) + fromhexchar(c2);
 }
 /*---------------------------------------------------------------------------*/
+/* Get a byte of the input, as if the two halves were one. */
+static unsigned char
+input_byte(struct shell_input *input, int i)
+{
+  if(i < input->len1) {
+    return input->data1[i];
+  }
+  return input->data2[i - input->len1];
+}
+/*---------------------------------------------------------------------------*/
 PROCESS_THREAD(shell_bin2hex_process, ev, data)
 {
+  static const char hexchars[] = "0123456789abcdef";
   struct shell_input *input;
-  int i;
-  char *bufptr;
+  int i, j, n, len;
+  unsigned char c;
   char *buf;
 
   PROCESS_BEGIN();
 
   while(1) {
-    PROCESS_WAIT_EVENT_UNTIL(ev == shell_event_input);
+    PROCESS_WAIT_EVENT_UNTIL(ev == shell_event_input || ev == shell_event_pipe);
+    if(ev == shell_event_pipe) {
+      shell_input_resume(&bin2hex_command);
+      continue;
+    }
     input = data;
 
     if(input->len1 + input->len2 == 0) {
       PROCESS_EXIT();
     }
 
-    buf = alloca((input->len1 + input->len2)*2);
-
-    bufptr = buf;
-    for(i = 0; i < input->len1; i++) {
-      bufptr += sprintf(bufptr, "%02x", 0xff&((char*)input->data1)[i]);
+    /* Write the hexadecimal straight into the pipe of the next
+       command, and keep the rest of the input when the pipe is
+       full. */
+    len = input->len1 + input->len2;
+    for(i = 0; i < len; i += n) {
+      n = shell_output_reserve(&bin2hex_command, &buf, 2) / 2;
+      if(n == 0) {
+        shell_input_keep(&bin2hex_command, len - i);
+        break;
+      }
+      if(n > len - i) {
+        n = len - i;
+      }
+      for(j = 0; j < n; j++) {
+        c = input_byte(input, i + j);
+        buf[2 * j] = hexchars[c >> 4];
+        buf[2 * j + 1] = hexchars[c & 0xf];
+      }
+      shell_output_commit(&bin2hex_command, 2 * n);
     }
-    for(i = 0; i < input->len2; i++) {
-      bufptr += sprintf(bufptr, "%02x", 0xff&((char*)input->data2)[i]);
-    }
-
-    shell_output(
-        &bin2hex_command,
-        buf, ((input->len1 + input->len2)*2), "", 0);
   }
 
   PROCESS_END();
@@ -138,45 +160,45 @@ PROCESS_THREAD(shell_bin2hex_process, ev, data)
 PROCESS_THREAD(shell_hex2bin_process, ev, data)
 {
   struct shell_input *input;
-  int i, cnt;
-  char* buf;
+  int i, j, n, len;
+  char *buf;
 
   PROCESS_BEGIN();
 
   /* Reads data in hexadecimal format and prints in binary */
 
   while(1) {
-    PROCESS_WAIT_EVENT_UNTIL(ev == shell_event_input);
+    PROCESS_WAIT_EVENT_UNTIL(ev == shell_event_input || ev == shell_event_pipe);
+    if(ev == shell_event_pipe) {
+      shell_input_resume(&hex2bin_command);
+      continue;
+    }
     input = data;
 
     if(input->len1 + input->len2 == 0) {
       PROCESS_EXIT();
     }
 
-    if(input->len1 % 2 != 0) {
-      PRINTF("Bad input length 1: %d\n", input->len1);
-      continue;
+    /* The digits of a byte may be split between the halves or between
+       inputs. An odd digit at the end is kept for the next input. */
+    len = input->len1 + input->len2;
+    for(i = 0; i + 1 < len; i += 2 * n) {
+      n = shell_output_reserve(&hex2bin_command, &buf, 1);
+      if(n == 0) {
+        break;
+      }
+      if(n > (len - i) / 2) {
+        n = (len - i) / 2;
+      }
+      for(j = 0; j < n; j++) {
+        buf[j] = fromhex(input_byte(input, i + 2 * j),
+                         input_byte(input, i + 2 * j + 1));
+      }
+      shell_output_commit(&hex2bin_command, n);
     }
-    if(input->len2 % 2 != 0) {
-      PRINTF("Bad input length 2: %d\n", input->len2);
-      continue;
+    if(i < len && !shell_input_keep(&hex2bin_command, len - i)) {
+      PRINTF("Bad input length: %d\n", len);
     }
-
-    buf = alloca((input->len1 + input->len2)/2+1);
-
-    cnt = 0;
-    for(i = 0; i < input->len1; i += 2) {
-      buf[cnt++] = fromhex(
-          ((char*)input->data1)[i],
-          ((char*)input->data1)[i+1]);
-    }
-    for(i = 0; i < input->len2; i += 2) {
-      buf[cnt++] = fromhex(
-          ((char*)input->data2)[i],
-          ((char*)input->data2)[i+1]);
-    }
-
-    shell_output(&hex2bin_command, buf, cnt, "", 0);
   }
 
   PROCESS_END();
@@ -184,23 +206,37 @@ PROCESS_THREAD(shell_hex2bin_process, ev, data)
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(shell_crc_process, ev, data)
 {
+  static char buf[SHELL_PIPE_SIZE + 2];
   struct shell_input *input;
   int i;
   uint16_t crc;
-  char *buf;
 
   PROCESS_BEGIN();
 
   /* Append per-block 16-bit CRC */
 
   while(1) {
-    PROCESS_WAIT_EVENT_UNTIL(ev == shell_event_input);
+    PROCESS_WAIT_EVENT_UNTIL(ev == shell_event_input || ev == shell_event_pipe);
+    if(ev == shell_event_pipe) {
+      shell_input_resume(&crc_command);
+      continue;
+    }
     input = data;
 
     if(input->len1 + input->len2 == 0) {
       PROCESS_EXIT();
     }
 
+    /* Wait until the block and its CRC can be output together. */
+    if(!shell_output_ready(&crc_command, input->len1 + input->len2 + 2)) {
+      shell_input_keep(&crc_command, input->len1 + input->len2);
+      continue;
+    }
+    if(input->len2 > SHELL_PIPE_SIZE) {
+      PRINTF("Too long input: %d\n", input->len2);
+      continue;
+    }
+
     /* calculate crc */
     crc = 0;
     for(i = 0; i < input->len1; i++) {
@@ -210,9 +246,8 @@ PROCESS_THREAD(shell_crc_process, ev, data)
       crc = crc16_add(((char*)(input->data2))[i], crc);
     }
 
-    /* input + 16-bit CRC */
-    buf = alloca(input->len2+2);
-
+    /* input + 16-bit CRC. The first half is output in place, and only
+       the second half, which usually is empty, is copied. */
     memcpy(buf, input->data2, input->len2);
     buf[input->len2] = crc&0xff;
     buf[input->len2+1] = (crc>>8)&0xff;
@@ -236,7 +271,11 @@ PROCESS_THREAD(shell_crcvalidate_process, ev, data)
    * outputs data without CRCs matches, otherwise nothing */
 
   while(1) {
-    PROCESS_WAIT_EVENT_UNTIL(ev == shell_event_input);
+    PROCESS_WAIT_EVENT_UNTIL(ev == shell_event_input || ev == shell_event_pipe);
+    if(ev == shell_event_pipe) {
+      shell_input_resume(&crcvalidate_command);
+      continue;
+    }
     input = data;
 
     if(input->len1 + input->len2 == 0) {
@@ -249,6 +288,12 @@ PROCESS_THREAD(shell_crcvalidate_process, ev, data)
       continue;
     }
 
+    if(!shell_output_ready(&crcvalidate_command,
+                           input->len1 + input->len2 - 2)) {
+      shell_input_keep(&crcvalidate_command, input->len1 + input->len2);
+      continue;
+    }
+
     if(input->len2 == 1) {
       crc1 = ((char*)input->data1)[input->len1-1];
       crc2 = ((char*)input->data2)[input->len2-1];
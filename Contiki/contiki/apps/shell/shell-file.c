@@ -46,7 +46,8 @@
 #include <string.h>
 
 #define MAX_FILENAME_LEN 40
-#define MAX_BLOCKSIZE 40
+#define DEFAULT_BLOCKSIZE 40
+#define MAX_BLOCKSIZE SHELL_PIPE_SIZE
 
 /*---------------------------------------------------------------------------*/
 PROCESS(shell_ls_process, "ls");
@@ -187,17 +188,18 @@ PROCESS_THREAD(shell_write_process, ev, data)
 PROCESS_THREAD(shell_read_process, ev, data)
 {
   static int fd = 0;
-  static int block_size = MAX_BLOCKSIZE;
+  static int block_size;
   char *next;
   char filename[MAX_FILENAME_LEN];
-  int len;
+  int len, total;
   int offset = 0;
-  char buf[MAX_BLOCKSIZE];
+  char *buf;
   struct shell_input *input;
 
   PROCESS_EXITHANDLER(cfs_close(fd));
   PROCESS_BEGIN();
 
+  block_size = DEFAULT_BLOCKSIZE;
   if(data != NULL) {
     next = strchr(data, ' ');
     if(next == NULL) {
@@ -239,16 +241,29 @@ PROCESS_THREAD(shell_read_process, ev, data)
     } else {
       
       while(1) {
-	len = cfs_read(fd, buf, block_size);
-	if(len <= 0) {
-	  cfs_close(fd);
-	  PROCESS_EXIT();
+	/* Read the blocks straight into the pipe of the next command,
+	   up to a pipe full at a time. Wait for room if the pipe is
+	   full. */
+	total = 0;
+	while(total < SHELL_PIPE_SIZE &&
+	      (len = shell_output_reserve(&read_command, &buf, 1)) > 0) {
+	  if(len > block_size) {
+	    len = block_size;
+	  }
+	  len = cfs_read(fd, buf, len);
+	  if(len <= 0) {
+	    cfs_close(fd);
+	    PROCESS_EXIT();
+	  }
+	  shell_output_commit(&read_command, len);
+	  total += len;
+	}
+
+	if(total > 0) {
+	  process_post(&shell_read_process, PROCESS_EVENT_CONTINUE, NULL);
 	}
-	shell_output(&read_command,
-		     buf, len, "", 0);
-	
-	process_post(&shell_read_process, PROCESS_EVENT_CONTINUE, NULL);
 	PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_CONTINUE ||
+				 ev == shell_event_pipe ||
 				 ev == shell_event_input);
 	
 	if(ev == shell_event_input) {
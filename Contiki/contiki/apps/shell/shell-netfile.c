@@ -81,13 +81,13 @@ write_chunk_pt(struct rudolph0_conn *c, int offset, int flag,
 
   do {
     if(datalen > 0) {
-      shell_output(&recvnetfile_command, data, datalen, "", 0);
+      shell_output_ref(&recvnetfile_command, data, datalen);
       /*      printf("write_chunk wrote %d bytes at %d\n", datalen, offset);*/
     }
     PT_YIELD(&recvnetfilept);
   } while(flag != RUDOLPH0_FLAG_LASTCHUNK);
 
-  shell_output(&recvnetfile_command, data, datalen, "", 0);
+  shell_output_ref(&recvnetfile_command, data, datalen);
   /*  printf("write_chunk wrote %d bytes at %d\n", datalen, offset);*/
   shell_output(&recvnetfile_command, "", 0, "", 0);
   leds_off(LEDS_YELLOW);
@@ -87,22 +87,21 @@ telnet_newdata(struct telnet_state *s, char *data, uint16_t len)
   shell_output(&tcpsend_command, data, len, "", 0);
 }
 /*---------------------------------------------------------------------------*/
-static void
+static int
 send_line(struct telnet_state *s, char *data, int len)
 {
-  if(!sending) {
-    strncpy(outputline, data, MIN(sizeof(outputline), len));
-    telnet_send(s, data, len);
-    sending = 1;
-  } else {
-    shell_output_str(&tcpsend_command, "Cannot send data, still sending previous data", "");
-  }
+  len = MIN(sizeof(outputline), len);
+  memcpy(outputline, data, len);
+  telnet_send(s, outputline, len);
+  sending = 1;
+  return len;
 }
 /*---------------------------------------------------------------------------*/
 void
 telnet_sent(struct telnet_state *s)
 {
   sending = 0;
+  shell_input_resume(&tcpsend_command);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -135,7 +134,8 @@ telnet_connected(struct telnet_state *s)
 PROCESS_THREAD(shell_tcpsend_process, ev, data)
 {
   char *next;
-  const char *dummy; 
+  const char *dummy;
+  int len;
   struct shell_input *input;
   uint16_t port;
   
@@ -165,8 +165,18 @@ PROCESS_THREAD(shell_tcpsend_process, ev, data)
 	PROCESS_EXIT();
       }
 
-      if(input->len1 > 0) {
-	send_line(&s, input->data1, input->len1);
+      /* Keep the input in the pipe until the previous data has
+	 been sent. */
+      len = 0;
+      if(sending) {
+	if(!shell_input_keep(&tcpsend_command, input->len1 + input->len2)) {
+	  shell_output_str(&tcpsend_command, "Cannot send data, still sending previous data", "");
+	}
+      } else if(input->len1 > 0) {
+	len = send_line(&s, input->data1, input->len1);
+      }
+      if(len > 0 && input->len1 + input->len2 > len) {
+	shell_input_keep(&tcpsend_command, input->len1 + input->len2 - len);
       }
     } else if(ev == tcpip_event) {
       telnet_app(data);
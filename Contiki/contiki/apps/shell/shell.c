@@ -69,6 +69,28 @@ static char shell_banner_text[] = "Contiki command shell";
 LIST(commands);
 
 int shell_event_input;
+int shell_event_pipe;
+
+/* The input of a command in a pipeline. The indices run freely and are
+   masked, and they are rewound when the pipe is emptied, so that a
+   command usually gets its whole input in data1. */
+struct shell_pipe {
+  struct process *writer;     /* waits for room */
+  unsigned short get, put;
+  int kept;
+  uint8_t eof;                /* end of input after the data */
+  uint8_t stalled;            /* the command took none of its input */
+  char data[SHELL_PIPE_SIZE];
+};
+
+#define PIPE_MASK (SHELL_PIPE_SIZE - 1)
+
+#if SHELL_PIPES > 0
+MEMB(pipes, struct shell_pipe, SHELL_PIPES);
+#endif /* SHELL_PIPES > 0 */
+
+/* The output of a command that outputs to no pipe. */
+static char output_buf[SHELL_PIPE_SIZE];
 
 static struct process *front_process;
 
@@ -237,6 +259,24 @@ find_pipe(char *commandline)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+/* Free the pipes of the commands that are not running. A command that
+   exits at the end of its input exits while the shell server process
+   runs, and the server does not get the exit event. */
+static void
+free_pipes(void)
+{
+#if SHELL_PIPES > 0
+  struct shell_command *c;
+
+  for(c = list_head(commands); c != NULL; c = c->next) {
+    if(c->pipe != NULL && !process_is_running(c->process)) {
+      memb_free(&pipes, c->pipe);
+      c->pipe = NULL;
+    }
+  }
+#endif /* SHELL_PIPES > 0 */
+}
+/*---------------------------------------------------------------------------*/
 static struct shell_command *
 start_command(char *commandline, struct shell_command *child)
 {
@@ -297,6 +337,14 @@ start_command(char *commandline, struct shell_command *child)
     c = NULL;
   } else {
     c->child = child;
+#if SHELL_PIPES > 0
+    if(child != NULL && child->pipe == NULL) {
+      child->pipe = memb_alloc(&pipes);
+      if(child->pipe != NULL) {
+	memset(child->pipe, 0, sizeof(struct shell_pipe));
+      }
+    }
+#endif /* SHELL_PIPES > 0 */
     /*    printf("shell: start_command starting '%s'\n", c->process->name);*/
     /* Start a new process for the command. */
     process_start(c->process, args);
@@ -326,6 +374,7 @@ shell_start_command(char *commandline, int commandline_len,
     commandline_len--;
   }
 
+  free_pipes();
   c = start_command(commandline, child);
 
   /* Return a pointer to the started process, so that the caller can
@@ -356,6 +405,197 @@ input_to_child_command(struct shell_command *c,
   }
 }
 /*---------------------------------------------------------------------------*/
+static int
+pipe_len(struct shell_pipe *p)
+{
+  return (unsigned short)(p->put - p->get);
+}
+/*---------------------------------------------------------------------------*/
+/* Get the room in a pipe. A command that takes none of its input
+   waits for something else than more input, such as room for a block
+   of output, and a pipe takes no more data until the command has taken
+   some. This keeps blocks apart for commands that work on blocks. */
+static int
+pipe_room(struct shell_pipe *p)
+{
+  if(p->stalled) {
+    return 0;
+  }
+  return SHELL_PIPE_SIZE - pipe_len(p);
+}
+/*---------------------------------------------------------------------------*/
+/* Copy data into a pipe, and return how much of it there was room for. */
+static int
+pipe_copy(struct shell_pipe *p, const char *data, int len)
+{
+  int n, put;
+
+  if(len > pipe_room(p)) {
+    len = pipe_room(p);
+  }
+  put = p->put & PIPE_MASK;
+  n = SHELL_PIPE_SIZE - put;
+  if(n > len) {
+    n = len;
+  }
+  memcpy(&p->data[put], data, n);
+  memcpy(p->data, data + n, len - n);
+  p->put += len;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+/* Give input to a command with a pipe, and return how much of it the
+   command kept. */
+static int
+pipe_post(struct shell_command *c,
+	  char *data1, int len1, const char *data2, int len2)
+{
+  struct shell_input input;
+
+  if(!process_is_running(c->process)) {
+    return 0;
+  }
+  c->pipe->kept = 0;
+  input.data1 = data1;
+  input.len1 = len1;
+  input.data2 = data2;
+  input.len2 = len2;
+  process_post_synch(c->process, shell_event_input, &input);
+  if(c->pipe == NULL || !process_is_running(c->process)) {
+    /* The command exited. */
+    return 0;
+  }
+  if(c->pipe->kept > len1 + len2) {
+    return len1 + len2;
+  }
+  return c->pipe->kept;
+}
+/*---------------------------------------------------------------------------*/
+/* Check if a command waits for room in the pipe that it outputs to. */
+static int
+pipe_waiting(struct shell_command *c)
+{
+  return c->child != NULL && c->child->pipe != NULL &&
+    c->child->pipe->writer == c->process;
+}
+/*---------------------------------------------------------------------------*/
+static int pipe_close(struct shell_command *c);
+/*---------------------------------------------------------------------------*/
+/* End the input of the commands down the pipeline of a command that
+   has exited, up to one that has data left in its pipe. That command
+   ends the input of the rest when it exits. */
+static void
+close_pipeline(struct shell_command *c)
+{
+  while(c != NULL) {
+    if(c->child != NULL && c->child->process != NULL) {
+      if(!pipe_close(c->child)) {
+	break;
+      }
+    }
+    c = c->child;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Give the data in the pipe of a command to the command. */
+static void
+pipe_deliver(struct shell_command *c)
+{
+  struct shell_pipe *p = c->pipe;
+  struct process *writer;
+  int len, n;
+
+  len = pipe_len(p);
+  if(len > 0) {
+    n = SHELL_PIPE_SIZE - (p->get & PIPE_MASK);
+    if(n > len) {
+      n = len;
+    }
+    len -= pipe_post(c, &p->data[p->get & PIPE_MASK], n, p->data, len - n);
+    p = c->pipe;
+    if(p == NULL) {
+      return;
+    }
+    p->get += len;
+    p->stalled = len == 0;
+    if(pipe_len(p) == 0) {
+      p->get = p->put = 0;
+    }
+    if(len > 0 && p->writer != NULL) {
+      writer = p->writer;
+      p->writer = NULL;
+      process_post(writer, shell_event_pipe, NULL);
+    }
+    if(len == 0 && p->eof && !pipe_waiting(c)) {
+      /* The command keeps the end of its input without waiting for
+	 anything that would let it take it. */
+      p->get = p->put = 0;
+    }
+  }
+  if(p->eof && pipe_len(p) == 0) {
+    p->eof = 0;
+    input_to_child_command(c, "", 0, "", 0);
+    /* The shell server does not get the exit event of a command that
+       exits while the server runs. */
+    if(!process_is_running(c->process)) {
+      close_pipeline(c);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Give output to the next command through its pipe, and return how
+   much of it the pipe took. The output is handed over in place if the
+   pipe is empty. */
+static int
+pipe_output(struct shell_command *c,
+	    char *data1, int len1, const char *data2, int len2)
+{
+  struct shell_pipe *p = c->pipe;
+  int kept, taken, stalled;
+
+  if(pipe_len(p) == 0) {
+    kept = pipe_post(c, data1, len1, data2, len2);
+    p = c->pipe;
+    if(p == NULL) {
+      return len1 + len2;
+    }
+    taken = len1 + len2 - kept;
+    stalled = taken == 0 && kept > 0;
+    if(kept > len2) {
+      taken += pipe_copy(p, data1 + len1 - (kept - len2), kept - len2);
+      kept = len2;
+    }
+    if(taken == len1 + len2 - kept) {
+      taken += pipe_copy(p, data2 + len2 - kept, kept);
+    }
+    p->stalled = stalled;
+  } else {
+    taken = pipe_copy(p, data1, len1);
+    if(taken == len1) {
+      taken += pipe_copy(p, data2, len2);
+    }
+    pipe_deliver(c);
+  }
+  if(taken < len1 + len2 && c->pipe != NULL) {
+    c->pipe->writer = PROCESS_CURRENT();
+  }
+  return taken;
+}
+/*---------------------------------------------------------------------------*/
+/* Tell a command that its input has ended, and return 0 if the
+   command still has data in its pipe to take first. */
+static int
+pipe_close(struct shell_command *c)
+{
+  if(c->pipe != NULL && pipe_len(c->pipe) > 0) {
+    c->pipe->eof = 1;
+    pipe_deliver(c);
+    return c->pipe == NULL || pipe_len(c->pipe) == 0;
+  }
+  input_to_child_command(c, "", 0, "", 0);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
 void
 shell_input(char *commandline, int commandline_len)
 {
@@ -398,12 +638,107 @@ shell_output(struct shell_command *c,
 	     const void *data2, int len2)
 {
   if(c != NULL && c->child != NULL) {
-    input_to_child_command(c->child, data1, len1, data2, len2);
+    if(c->child->pipe != NULL) {
+      pipe_output(c->child, data1, len1, data2, len2);
+    } else {
+      input_to_child_command(c->child, data1, len1, data2, len2);
+    }
   } else {
     shell_default_output(data1, len1, data2, len2);
   }
 }
 /*---------------------------------------------------------------------------*/
+int
+shell_output_ref(struct shell_command *c, const void *data, int len)
+{
+  if(c != NULL && c->child != NULL && c->child->pipe != NULL) {
+    return pipe_output(c->child, (char *)data, len, "", 0);
+  }
+  shell_output(c, (void *)data, len, "", 0);
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+int
+shell_output_ready(struct shell_command *c, int len)
+{
+  struct shell_pipe *p;
+
+  /* An empty pipe takes any output, as it is handed over in place. */
+  if(c == NULL || c->child == NULL || c->child->pipe == NULL ||
+     pipe_len(c->child->pipe) == 0 ||
+     pipe_room(c->child->pipe) >= len) {
+    return 1;
+  }
+  p = c->child->pipe;
+  p->writer = PROCESS_CURRENT();
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+shell_output_reserve(struct shell_command *c, char **ptr, int min)
+{
+  struct shell_pipe *p;
+  int len;
+
+  if(c == NULL || c->child == NULL || c->child->pipe == NULL) {
+    *ptr = output_buf;
+    return sizeof(output_buf);
+  }
+
+  p = c->child->pipe;
+  *ptr = &p->data[p->put & PIPE_MASK];
+  len = pipe_room(p);
+  if(len > SHELL_PIPE_SIZE - (p->put & PIPE_MASK)) {
+    len = SHELL_PIPE_SIZE - (p->put & PIPE_MASK);
+  }
+  if(len < min) {
+    p->writer = PROCESS_CURRENT();
+    return 0;
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+/* Hand the output buffer to a command that has no pipe. The next
+   command may produce its own output in the buffer while it handles
+   its input, so the input is given to it in a copy. */
+static void
+commit_copy(struct shell_command *c, int len)
+{
+  char buf[SHELL_PIPE_SIZE];
+
+  memcpy(buf, output_buf, len);
+  input_to_child_command(c->child, buf, len, "", 0);
+}
+/*---------------------------------------------------------------------------*/
+void
+shell_output_commit(struct shell_command *c, int len)
+{
+  if(c == NULL || c->child == NULL) {
+    shell_output(c, output_buf, len, "", 0);
+  } else if(c->child->pipe == NULL) {
+    commit_copy(c, len);
+  } else if(len > 0) {
+    c->child->pipe->put += len;
+    pipe_deliver(c->child);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+shell_input_keep(struct shell_command *c, int len)
+{
+  if(c->pipe == NULL) {
+    return 0;
+  }
+  c->pipe->kept = len;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+shell_input_resume(struct shell_command *c)
+{
+  process_post(&shell_server_process, shell_event_pipe, c);
+}
+/*---------------------------------------------------------------------------*/
 void
 shell_unregister_command(struct shell_command *c)
 {
@@ -481,13 +816,12 @@ PROCESS_THREAD(shell_server_process, ev, data)
       for(c = list_head(commands);
 	  c != NULL && c->process != p;
 	  c = c->next);
-      while(c != NULL) {
-	if(c->child != NULL && c->child->process != NULL) {
-	  /*	  printf("Killing '%s'\n", c->process->name);*/
-	  input_to_child_command(c->child, "", 0, "", 0);
-	  /*	  process_exit(c->process);*/
-	}
-	c = c->child;
+      close_pipeline(c);
+      free_pipes();
+    } else if(ev == shell_event_pipe) {
+      c = data;
+      if(c->pipe != NULL && process_is_running(c->process)) {
+	pipe_deliver(c);
       }
     } else if(ev == PROCESS_EVENT_TIMER) {
       etimer_reset(&etimer);
@@ -511,6 +845,10 @@ shell_init(void)
   shell_register_command(&quit_command);
   
   shell_event_input = process_alloc_event();
+  shell_event_pipe = process_alloc_event();
+#if SHELL_PIPES > 0
+  memb_init(&pipes);
+#endif /* SHELL_PIPES > 0 */
   
   process_start(&shell_process, NULL);
   process_start(&shell_server_process, NULL);
@@ -63,6 +63,31 @@
 
 #include "sys/process.h"
 
+/**
+ * \brief      The number of pipes between the commands of pipelines
+ *
+ *             Each command that reads the output of another command
+ *             in a pipeline gets a pipe from a pool of this many
+ *             pipes. A command that gets no pipe has its input handed
+ *             to it as before, without flow control.
+ */
+#ifdef SHELL_CONF_PIPES
+#define SHELL_PIPES SHELL_CONF_PIPES
+#else /* SHELL_CONF_PIPES */
+#define SHELL_PIPES 4
+#endif /* SHELL_CONF_PIPES */
+
+/**
+ * \brief      The size of a pipe, in bytes; a power of two
+ */
+#ifdef SHELL_CONF_PIPE_SIZE
+#define SHELL_PIPE_SIZE SHELL_CONF_PIPE_SIZE
+#else /* SHELL_CONF_PIPE_SIZE */
+#define SHELL_PIPE_SIZE 128
+#endif /* SHELL_CONF_PIPE_SIZE */
+
+struct shell_pipe;
+
 /**
  * \brief      Holds a information about a shell command
  *
@@ -77,6 +102,7 @@ struct shell_command {
   char *description;
   struct process *process;
   struct shell_command *child;
+  struct shell_pipe *pipe;
 };
 
 /**
@@ -258,6 +284,93 @@ void shell_output(struct shell_command *c,
 void shell_output_str(struct shell_command *c,
 		      char *str1, const char *str2);
 
+/**
+ * \brief      Output data from a shell command without copying it
+ * \param c    The command that outputs data
+ * \param data A pointer to the data
+ * \param len  The size of the data
+ * \retval     The number of bytes that were taken
+ *
+ *             This function hands the data over to the next command
+ *             in the pipeline in place. Only the data that the next
+ *             command keeps is copied into its pipe. If the pipe
+ *             cannot take all of the data, the function returns how
+ *             much it took, and the command gets a
+ *             shell_event_pipe event when there is room again.
+ *
+ */
+int shell_output_ref(struct shell_command *c, const void *data, int len);
+
+/**
+ * \brief      Check if the next command can take output
+ * \param c    The command that outputs data
+ * \param len  The size of the output
+ * \retval     Non-zero if the output can be given with shell_output() without loss
+ *
+ *             This function lets a command that outputs blocks that
+ *             must not be split, such as data with a checksum, wait
+ *             until the pipe of the next command has room for a
+ *             block. If it returns zero, the command gets a
+ *             shell_event_pipe event when there is room again.
+ *
+ */
+int shell_output_ready(struct shell_command *c, int len);
+
+/**
+ * \brief      Get room for output in the pipe of the next command
+ * \param c    The command that outputs data
+ * \param ptr  A pointer to a pointer that is filled in with a pointer to the room
+ * \param min  The least number of bytes of room that the command can use
+ * \retval     The number of bytes of room, or 0 if there is less than min
+ *
+ *             This function lets a command produce its output
+ *             directly in the pipe of the next command in the
+ *             pipeline. The output is handed over with
+ *             shell_output_commit(). If there is too little room,
+ *             the command gets a shell_event_pipe event when the
+ *             next command has taken some of its input.
+ *             A command that outputs to no pipe, such as the last
+ *             command of a pipeline, gets a buffer of
+ *             SHELL_PIPE_SIZE bytes instead.
+ *
+ */
+int shell_output_reserve(struct shell_command *c, char **ptr, int min);
+
+/**
+ * \brief      Hand over output that was produced with shell_output_reserve()
+ * \param c    The command that outputs data
+ * \param len  The number of bytes of output
+ *
+ */
+void shell_output_commit(struct shell_command *c, int len);
+
+/**
+ * \brief      Keep a part of the input in the pipe
+ * \param c    The command that got the input
+ * \param len  The number of bytes at the end of the input to keep
+ * \retval     Zero if the command has no pipe, and the input is lost
+ *
+ *             This function is called by a command that cannot take
+ *             all of its input while it handles a shell_event_input
+ *             event, such as when the pipe that it outputs to is
+ *             full. The kept input stays in the pipe of the command,
+ *             and is given to it again, followed by any new input,
+ *             when more input arrives or when the command calls
+ *             shell_input_resume(). The command that outputs to the
+ *             pipe waits when the pipe is full. At the end of the
+ *             input, input that a command keeps without waiting for
+ *             room for its own output is dropped.
+ *
+ */
+int shell_input_keep(struct shell_command *c, int len);
+
+/**
+ * \brief      Ask for kept input to be given to a command again
+ * \param c    The command that kept input
+ *
+ */
+void shell_input_resume(struct shell_command *c);
+
 /**
  * \brief      Register a command with the shell
  * \param c    A pointer to a shell command structure, defined with SHELL_COMMAND()
@@ -353,6 +466,16 @@ enum shell_retval {
  */
 extern int shell_event_input;
 
+/**
+ * \brief      The event number for room in a pipe
+ *
+ *             This event is posted to a command when there is room
+ *             again in the pipe that it outputs to, after the pipe
+ *             was full.
+ *
+ */
+extern int shell_event_pipe;
+
 /**
  * \brief      Structure for shell input data
  *
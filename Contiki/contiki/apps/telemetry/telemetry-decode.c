@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2012, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *	Decoding of telemetry batches. The decoder uses nothing but
+ *	standard C, so that it can be built into host tools.
+ */
+
+#include <stddef.h>
+
+#include "telemetry.h"
+
+/*---------------------------------------------------------------------------*/
+static int
+get_varint(struct telemetry_reader *r, uint32_t *value)
+{
+  int shift;
+  uint8_t c;
+
+  *value = 0;
+  for(shift = 0; shift < 35; shift += 7) {
+    if(r->pos >= r->len) {
+      return 0;
+    }
+    c = r->data[r->pos++];
+    *value |= (uint32_t)(c & 0x7f) << shift;
+    if((c & 0x80) == 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+telemetry_read_start(struct telemetry_reader *r,
+		     const uint8_t *data, int len)
+{
+  int i;
+
+  r->data = data;
+  r->len = len;
+  r->pos = 2;
+  r->record = 0;
+  if(len < 4) {
+    return -1;
+  }
+  r->schema = telemetry_schema(data[0]);
+  r->flags = data[1];
+  if(r->schema == NULL || r->schema->fields > TELEMETRY_MAX_FIELDS ||
+     !get_varint(r, &r->seqno) || r->pos >= len) {
+    return -1;
+  }
+  r->records = data[r->pos++];
+  for(i = 0; i < 2 * r->schema->fields; i++) {
+    r->state[i] = 0;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+telemetry_read_next(struct telemetry_reader *r, uint32_t *values)
+{
+  const struct telemetry_schema *s = r->schema;
+  uint32_t *last = r->state;
+  uint32_t *delta = r->state + s->fields;
+  uint32_t residual, prediction;
+  int bitmap;
+  int i;
+
+  if(r->record >= r->records) {
+    return 0;
+  }
+
+  bitmap = r->pos;
+  if(r->flags & TELEMETRY_FLAG_SKIP) {
+    r->pos += (s->fields + 7) / 8;
+    if(r->pos > r->len) {
+      return -1;
+    }
+  }
+
+  for(i = 0; i < s->fields; i++) {
+    prediction = 0;
+    if(s->kinds[i] == TELEMETRY_DELTA) {
+      prediction = last[i];
+    } else if(s->kinds[i] == TELEMETRY_DELTA2) {
+      prediction = last[i] + delta[i];
+    }
+    if((r->flags & TELEMETRY_FLAG_SKIP) &&
+       (r->data[bitmap + i / 8] & (1 << (i % 8)))) {
+      residual = 0;
+    } else if(!get_varint(r, &residual)) {
+      return -1;
+    }
+    values[i] = prediction + ((residual >> 1) ^ (0 - (residual & 1)));
+  }
+
+  for(i = 0; i < s->fields; i++) {
+    if(r->record > 0) {
+      delta[i] = values[i] - last[i];
+    }
+    last[i] = values[i];
+  }
+  r->record++;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
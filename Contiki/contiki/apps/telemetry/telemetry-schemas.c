@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2012, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *	The schemas of the telemetry records. The field order is
+ *	documented in telemetry.h, and must not be changed for an
+ *	existing schema identifier.
+ */
+
+#include <stddef.h>
+
+#include "telemetry.h"
+
+/* Energest counters grow at a nearly constant rate, and the clock
+   advances by one period per record, so their differences are
+   predicted as well as their values. */
+static const uint8_t powertrace_kinds[TELEMETRY_POWERTRACE_FIELDS] = {
+  TELEMETRY_DELTA2, TELEMETRY_DELTA,
+  TELEMETRY_DELTA2, TELEMETRY_DELTA2, TELEMETRY_DELTA2,
+  TELEMETRY_DELTA2, TELEMETRY_DELTA2, TELEMETRY_DELTA2
+};
+
+const struct telemetry_schema telemetry_powertrace_schema = {
+  TELEMETRY_SCHEMA_POWERTRACE, TELEMETRY_POWERTRACE_FIELDS,
+  powertrace_kinds
+};
+
+/* The collect-view energy values are already per-period differences,
+   so they are predicted to repeat, as are the routing values and the
+   sensor readings. */
+static const uint8_t collect_view_kinds[TELEMETRY_COLLECT_VIEW_FIELDS] = {
+  TELEMETRY_DELTA2, TELEMETRY_DELTA2,
+  TELEMETRY_DELTA, TELEMETRY_DELTA, TELEMETRY_DELTA, TELEMETRY_DELTA,
+  TELEMETRY_DELTA, TELEMETRY_DELTA, TELEMETRY_DELTA, TELEMETRY_DELTA,
+  TELEMETRY_DELTA,
+  TELEMETRY_DELTA, TELEMETRY_DELTA, TELEMETRY_DELTA, TELEMETRY_DELTA,
+  TELEMETRY_DELTA, TELEMETRY_DELTA, TELEMETRY_DELTA, TELEMETRY_DELTA,
+  TELEMETRY_DELTA, TELEMETRY_DELTA
+};
+
+const struct telemetry_schema telemetry_collect_view_schema = {
+  TELEMETRY_SCHEMA_COLLECT_VIEW, TELEMETRY_COLLECT_VIEW_FIELDS,
+  collect_view_kinds
+};
+
+/*---------------------------------------------------------------------------*/
+const struct telemetry_schema *
+telemetry_schema(uint8_t id)
+{
+  switch(id) {
+  case TELEMETRY_SCHEMA_POWERTRACE:
+    return &telemetry_powertrace_schema;
+  case TELEMETRY_SCHEMA_COLLECT_VIEW:
+    return &telemetry_collect_view_schema;
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2012, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *	Encoding of telemetry batches.
+ */
+
+#include "telemetry.h"
+
+/*---------------------------------------------------------------------------*/
+static int
+put_varint(struct telemetry_batch *b, uint32_t value)
+{
+  do {
+    if(b->len >= b->size) {
+      return 0;
+    }
+    b->buf[b->len++] = (value & 0x7f) | (value > 0x7f ? 0x80 : 0);
+    value >>= 7;
+  } while(value != 0);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+telemetry_start(struct telemetry_batch *b,
+		const struct telemetry_schema *schema,
+		uint32_t seqno, uint8_t flags)
+{
+  int i;
+
+  b->schema = schema;
+  b->flags = flags;
+  b->records = 0;
+  b->buf[0] = schema->id;
+  b->buf[1] = flags;
+  b->len = 2;
+  put_varint(b, seqno);
+  b->count_offset = b->len;
+  b->buf[b->len++] = 0;
+  for(i = 0; i < 2 * schema->fields; i++) {
+    b->state[i] = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+telemetry_add(struct telemetry_batch *b, const uint32_t *values)
+{
+  const struct telemetry_schema *s = b->schema;
+  uint32_t *last = b->state;
+  uint32_t *delta = b->state + s->fields;
+  uint32_t prediction;
+  int32_t residual;
+  uint16_t start, bitmap;
+  int i;
+
+  if(b->records == 0xff) {
+    return 0;
+  }
+
+  start = b->len;
+  bitmap = b->len;
+  if(b->flags & TELEMETRY_FLAG_SKIP) {
+    if(b->len + (s->fields + 7) / 8 > b->size) {
+      return 0;
+    }
+    for(i = 0; i < (s->fields + 7) / 8; i++) {
+      b->buf[b->len++] = 0;
+    }
+  }
+
+  for(i = 0; i < s->fields; i++) {
+    prediction = 0;
+    if(s->kinds[i] == TELEMETRY_DELTA) {
+      prediction = last[i];
+    } else if(s->kinds[i] == TELEMETRY_DELTA2) {
+      prediction = last[i] + delta[i];
+    }
+    residual = (int32_t)(values[i] - prediction);
+    if(residual == 0 && (b->flags & TELEMETRY_FLAG_SKIP)) {
+      b->buf[bitmap + i / 8] |= 1 << (i % 8);
+    } else if(!put_varint(b, ((uint32_t)residual << 1) ^
+			  (uint32_t)(residual >> 31))) {
+      b->len = start;
+      return 0;
+    }
+  }
+
+  /* The record fits, so the predictions can be updated. The difference
+     of the first record is not known, and is left at zero. */
+  for(i = 0; i < s->fields; i++) {
+    if(b->records > 0) {
+      delta[i] = values[i] - last[i];
+    }
+    last[i] = values[i];
+  }
+  b->records++;
+  b->buf[b->count_offset] = b->records;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
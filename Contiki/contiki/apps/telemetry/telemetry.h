@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2012, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *	Compact binary telemetry. Periodic records of counters and
+ *	readings, such as those of powertrace and collect-view, are
+ *	batched over several periods and encoded as small differences
+ *	from predicted values.
+ *
+ *	Batch format:
+ *	  1 byte    schema identifier
+ *	  1 byte    flags
+ *	  varint    sequence number of the first record
+ *	  1 byte    number of records
+ *	followed by the records. A record has a value for each field of
+ *	the schema. If the batch has the TELEMETRY_FLAG_SKIP flag, each
+ *	record starts with a bitmap of one bit per field, least
+ *	significant bit first, padded to whole bytes. A set bit means that
+ *	the value of the field is the predicted one, and that it is left
+ *	out. Each value is the difference from its prediction, as a signed
+ *	varint. A field is predicted according to its kind in the schema:
+ *	  TELEMETRY_RAW     zero
+ *	  TELEMETRY_DELTA   the previous value of the field
+ *	  TELEMETRY_DELTA2  the previous value plus the previous
+ *	                    difference between values of the field
+ *	Predictions start from zero in each batch, so that a batch can be
+ *	decoded even if the batches before it were lost. Values are 32
+ *	bits, and all arithmetic is modulo 2^32.
+ *
+ *	Varints hold 7 bits in each byte, least significant first, with
+ *	the top bit set in all bytes but the last. Signed values are
+ *	zigzag encoded.
+ *
+ *	Schemas:
+ *	  1  powertrace: clock, node, all_cpu, all_lpm, all_transmit,
+ *	     all_listen, all_idle_transmit, all_idle_listen
+ *	  2  collect-view: clock, timesynch_time, cpu, lpm, transmit,
+ *	     listen, parent, parent_etx, current_rtmetric,
+ *	     num_neighbors, beacon_interval, sensors[0] to sensors[9]
+ *
+ *	Batches are decoded on hosts with telemetry-decode.c, which
+ *	tools/telemetry2csv is built from.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#define TELEMETRY_RAW		0
+#define TELEMETRY_DELTA		1
+#define TELEMETRY_DELTA2	2
+
+#define TELEMETRY_FLAG_SKIP	0x01
+
+#define TELEMETRY_SCHEMA_POWERTRACE	1
+#define TELEMETRY_SCHEMA_COLLECT_VIEW	2
+
+#define TELEMETRY_POWERTRACE_FIELDS	8
+#define TELEMETRY_COLLECT_VIEW_FIELDS	21
+
+/* The largest number of fields in a schema that can be decoded. */
+#define TELEMETRY_MAX_FIELDS		24
+
+struct telemetry_schema {
+  uint8_t id;
+  uint8_t fields;
+  const uint8_t *kinds;
+};
+
+extern const struct telemetry_schema telemetry_powertrace_schema;
+extern const struct telemetry_schema telemetry_collect_view_schema;
+
+struct telemetry_batch {
+  uint8_t *buf;
+  uint16_t size;
+  uint32_t *state;
+  const struct telemetry_schema *schema;
+  uint16_t len;
+  uint8_t count_offset;
+  uint8_t records;
+  uint8_t flags;
+};
+
+/**
+ * \brief	Declare a batch.
+ * \param name	The name of the batch.
+ * \param fields The largest number of fields of the schemas that the
+ *		batch is used with.
+ * \param size	The largest size of an encoded batch, in bytes.
+ */
+#define TELEMETRY_BATCH(name, fields, size)				\
+  static uint8_t name##_telemetry_buf[size];				\
+  static uint32_t name##_telemetry_state[2 * (fields)];			\
+  static struct telemetry_batch name = {name##_telemetry_buf, size,	\
+					name##_telemetry_state}
+
+/**
+ * \brief	Start a new batch.
+ * \param b	The batch.
+ * \param schema The schema of the records.
+ * \param seqno	The sequence number of the first record.
+ * \param flags	TELEMETRY_FLAG_SKIP to leave out predicted values.
+ */
+void telemetry_start(struct telemetry_batch *b,
+		     const struct telemetry_schema *schema,
+		     uint32_t seqno, uint8_t flags);
+
+/**
+ * \brief	Add a record to a batch.
+ * \param b	The batch.
+ * \param values The values of the fields of the record.
+ * \return	1 if the record was added, or 0 if the batch is full.
+ */
+int telemetry_add(struct telemetry_batch *b, const uint32_t *values);
+
+/** \brief The number of records in a batch. */
+#define telemetry_records(b)	((b)->records)
+/** \brief The encoded batch. */
+#define telemetry_data(b)	((const uint8_t *)(b)->buf)
+/** \brief The size of the encoded batch, in bytes. */
+#define telemetry_len(b)	((b)->len)
+/** \brief Empty a batch. It must be started again before records are
+    added to it. */
+#define telemetry_clear(b)	((b)->records = 0)
+
+struct telemetry_reader {
+  const uint8_t *data;
+  int len, pos;
+  const struct telemetry_schema *schema;
+  uint32_t seqno;
+  uint8_t flags;
+  uint8_t records, record;
+  uint32_t state[2 * TELEMETRY_MAX_FIELDS];
+};
+
+/**
+ * \brief	Get a schema.
+ * \param id	The schema identifier.
+ * \return	The schema, or NULL if the identifier is unknown.
+ */
+const struct telemetry_schema *telemetry_schema(uint8_t id);
+
+/**
+ * \brief	Start decoding a batch.
+ * \param r	The reader.
+ * \param data	The batch, which may be followed by other data.
+ * \param len	The number of bytes at data.
+ * \return	0 if the header of the batch was read, or -1 if it is
+ *		malformed or of an unknown schema.
+ */
+int telemetry_read_start(struct telemetry_reader *r,
+			 const uint8_t *data, int len);
+
+/**
+ * \brief	Decode the next record of a batch.
+ * \param r	The reader.
+ * \param values Filled in with the values of the fields.
+ * \return	1 if a record was decoded, 0 at the end of the batch, or
+ *		-1 if the batch is malformed.
+ *
+ *		The sequence number of the record is r->seqno +
+ *		r->record - 1 after the call. At the end of the batch,
+ *		r->pos is the size of the batch.
+ */
+int telemetry_read_next(struct telemetry_reader *r, uint32_t *values);
+
+#endif /* TELEMETRY_H */
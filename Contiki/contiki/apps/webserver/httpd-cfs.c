@@ -103,27 +103,34 @@ PT_THREAD(send_string(struct httpd_state *s, const char *str))
   PSOCK_END(&s->sout);
 }
 /*---------------------------------------------------------------------------*/
+static const struct {
+  const char *extension;
+  const char *content_type;
+} content_types[] = {
+  {http_htm, http_content_type_html},
+  {http_html, http_content_type_html},
+  {http_css, http_content_type_css},
+  {http_png, http_content_type_png},
+  {http_gif, http_content_type_gif},
+  {http_jpg, http_content_type_jpg},
+};
+/*---------------------------------------------------------------------------*/
 static const char *
 get_content_type(const char *filename)
 {
   const char *ptr;
+  int i;
+
   ptr = strrchr(filename, ISO_period);
   if(ptr == NULL) {
-    ptr = http_content_type_plain;
-  } else if(strcmp(http_htm, ptr) == 0) {
-    ptr = http_content_type_html;
-  } else if(strcmp(http_css, ptr) == 0) {
-    ptr = http_content_type_css;
-  } else if(strcmp(http_png, ptr) == 0) {
-    ptr = http_content_type_png;
-  } else if(strcmp(http_gif, ptr) == 0) {
-    ptr = http_content_type_gif;
-  } else if(strcmp(http_jpg, ptr) == 0) {
-    ptr = http_content_type_jpg;
-  } else {
-    ptr = http_content_type_binary;
+    return http_content_type_plain;
+  }
+  for(i = 0; i < sizeof(content_types) / sizeof(content_types[0]); i++) {
+    if(strcmp(content_types[i].extension, ptr) == 0) {
+      return content_types[i].content_type;
+    }
   }
-  return ptr;
+  return http_content_type_binary;
 }
 /*---------------------------------------------------------------------------*/
 static
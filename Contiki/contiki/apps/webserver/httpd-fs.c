@@ -37,13 +37,79 @@
 #include "httpd.h"
 #include "httpd-fs.h"
 #include "httpd-fsdata.h"
+#include "http-strings.h"
 
 #include "httpd-fsdata.c"
 
+#ifdef HTTPD_FS_GZIP_WINDOW
+#include "httpd-inflate.h"
+#if HTTPD_FS_GZIP_WINDOW > HTTPD_INFLATE_WINDOW
+#error "httpd-fsdata.c was deflated with a window larger than HTTPD_INFLATE_WINDOW"
+#endif
+#endif /* HTTPD_FS_GZIP_WINDOW */
+
 #if HTTPD_FS_STATISTICS
 static uint16_t count[HTTPD_FS_NUMFILES];
 #endif /* HTTPD_FS_STATISTICS */
 
+#ifdef HTTPD_FS_HASH_SIZE
+/*-----------------------------------------------------------------------------------*/
+/* The hash that makefsdata -x builds the index with. A name also ends
+   at the end of a line, as in the include lines of scripts. */
+static uint16_t
+httpd_fs_hash(const char *name)
+{
+  uint16_t h;
+
+  for(h = 5381; *name != 0 && *name != '\r' && *name != '\n'; name++) {
+    h = (h << 5) + h + (uint8_t)*name;
+  }
+  return h;
+}
+/*-----------------------------------------------------------------------------------*/
+/* Returns the index of the file, or -1. Names that hash to the same
+   slot are in the slots that follow it. */
+static int
+httpd_fs_find(const char *name)
+{
+  const char *n;
+  uint8_t i, index, j;
+
+  i = httpd_fs_hash(name) & (HTTPD_FS_HASH_SIZE - 1);
+  while((index = httpd_fs_index[i]) != 0) {
+    n = httpd_fs_entries[index - 1].name;
+    for(j = 0; n[j] != 0 && name[j] == n[j]; j++);
+    if(n[j] == 0 && (name[j] == 0 || name[j] == '\r' || name[j] == '\n')) {
+      return index - 1;
+    }
+    i = (i + 1) & (HTTPD_FS_HASH_SIZE - 1);
+  }
+  return -1;
+}
+/*-----------------------------------------------------------------------------------*/
+int
+httpd_fs_open(const char *name, struct httpd_fs_file *file)
+{
+  const struct httpd_fsdata_entry *e;
+  int i;
+
+  i = httpd_fs_find(name);
+  if(i < 0) {
+    return 0;
+  }
+  e = &httpd_fs_entries[i];
+  file->data = (char *)e->data;
+  file->len = e->len;
+  file->content_type = e->content_type;
+  file->etag = e->etag;
+  file->plain_len = e->plain_len;
+  file->flags = (e->flags & HTTPD_FSDATA_GZIP) ? HTTPD_FS_GZIP : 0;
+#if HTTPD_FS_STATISTICS
+  ++count[i];
+#endif /* HTTPD_FS_STATISTICS */
+  return 1;
+}
+#else /* HTTPD_FS_HASH_SIZE */
 /*-----------------------------------------------------------------------------------*/
 static uint8_t
 httpd_fs_strcmp(const char *str1, const char *str2)
@@ -81,6 +147,10 @@ httpd_fs_open(const char *name, struct httpd_fs_file *file)
     if(httpd_fs_strcmp(name, f->name) == 0) {
       file->data = f->data;
       file->len = f->len;
+      file->content_type = NULL;
+      file->etag = NULL;
+      file->plain_len = f->len;
+      file->flags = 0;
 #if HTTPD_FS_STATISTICS
       ++count[i];
 #endif /* HTTPD_FS_STATISTICS */
@@ -93,6 +163,7 @@ httpd_fs_open(const char *name, struct httpd_fs_file *file)
   }
   return 0;
 }
+#endif /* HTTPD_FS_HASH_SIZE */
 /*-----------------------------------------------------------------------------------*/
 void
 httpd_fs_init(void)
@@ -109,6 +180,12 @@ httpd_fs_init(void)
 uint16_t
 httpd_fs_count(char *name)
 {
+#ifdef HTTPD_FS_HASH_SIZE
+  int i;
+
+  i = httpd_fs_find(name);
+  return i < 0 ? 0 : count[i];
+#else /* HTTPD_FS_HASH_SIZE */
   struct httpd_fsdata_file_noconst *f;
   uint16_t i;
 
@@ -123,6 +200,7 @@ httpd_fs_count(char *name)
     ++i;
   }
   return 0;
+#endif /* HTTPD_FS_HASH_SIZE */
 }
 #endif /* HTTPD_FS_STATISTICS */
 /*-----------------------------------------------------------------------------------*/
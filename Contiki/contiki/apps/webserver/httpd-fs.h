@@ -39,9 +39,16 @@
 
 #define HTTPD_FS_STATISTICS 1
 
+#define HTTPD_FS_GZIP 0x01  /* data is a gzip file of plain_len bytes */
+
 struct httpd_fs_file {
   char *data;
   int len;
+  /* The following are NULL and 0 for files without metadata. */
+  const char *content_type;
+  const char *etag;
+  uint16_t plain_len;
+  uint8_t flags;
 };
 
 /* file must be allocated by caller and will be filled in
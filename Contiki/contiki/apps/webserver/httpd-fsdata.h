@@ -61,4 +61,18 @@ struct httpd_fsdata_file_noconst {
 #endif /* HTTPD_FS_STATISTICS */
 };
 
+/* Files generated by makefsdata -x or -z are found through a hash of
+   their names and carry the headers that they are sent with. */
+#define HTTPD_FSDATA_GZIP 0x01  /* the data is a gzip file */
+
+struct httpd_fsdata_entry {
+  const char *name;
+  const char *data;
+  uint16_t len;
+  uint16_t plain_len;         /* the length of the data when inflated */
+  const char *content_type;   /* the Content-type header line */
+  const char *etag;           /* quoted, or NULL for scripts */
+  uint8_t flags;
+};
+
 #endif /* __HTTPD_FSDATA_H__ */
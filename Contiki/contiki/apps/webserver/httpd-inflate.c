@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         A streaming inflater for the gzip files of httpd-fs. The output
+ *         is produced in parts that end where the window wraps, so that
+ *         the window is the only output buffer that is needed.
+ */
+
+#include <string.h>
+
+#include "httpd-inflate.h"
+
+#define STATE_BLOCK   0
+#define STATE_STORED  1
+#define STATE_CODES   2
+#define STATE_DONE    3
+#define STATE_ERROR   4
+
+#define GZIP_FEXTRA   0x04
+#define GZIP_FNAME    0x08
+#define GZIP_FCOMMENT 0x10
+#define GZIP_FHCRC    0x02
+
+static const uint16_t length_base[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t length_extra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t dist_base[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+  8193, 12289, 16385, 24577
+};
+static const uint8_t dist_extra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+/* The order in which the code length code lengths are stored. */
+static const uint8_t clen_order[19] = {
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/* The code lengths of a block are only needed while its codes are
+   built, which never yields. */
+static uint8_t lengths[288 + 30];
+
+/*---------------------------------------------------------------------------*/
+static unsigned
+bits(struct httpd_inflate *z, uint8_t n)
+{
+  unsigned value;
+
+  while(z->bitcount < n) {
+    if(z->in == z->end) {
+      z->state = STATE_ERROR;
+      return 0;
+    }
+    z->bitbuf |= (uint32_t)*z->in++ << z->bitcount;
+    z->bitcount += 8;
+  }
+  value = z->bitbuf & ((1UL << n) - 1);
+  z->bitbuf >>= n;
+  z->bitcount -= n;
+  return value;
+}
+/*---------------------------------------------------------------------------*/
+/* Build a canonical code from code lengths. Returns zero if the lengths
+   describe more codes than there is room for. */
+static int
+build(uint16_t *counts, uint16_t *symbols, const uint8_t *length, int n)
+{
+  uint16_t offsets[16];
+  int i, left;
+
+  memset(counts, 0, 16 * sizeof(uint16_t));
+  for(i = 0; i < n; i++) {
+    counts[length[i]]++;
+  }
+  counts[0] = 0;
+
+  left = 1;
+  offsets[1] = 0;
+  for(i = 1; i < 16; i++) {
+    left = (left << 1) - counts[i];
+    if(left < 0) {
+      return 0;
+    }
+    if(i < 15) {
+      offsets[i + 1] = offsets[i] + counts[i];
+    }
+  }
+
+  for(i = 0; i < n; i++) {
+    if(length[i] != 0) {
+      symbols[offsets[length[i]]++] = i;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Decode a symbol one bit at a time. Codes of each length follow the
+   codes of the previous length, so the code is compared with the range
+   of each length in turn. */
+static int
+decode(struct httpd_inflate *z, const uint16_t *counts,
+       const uint16_t *symbols)
+{
+  int code, first, index, len;
+
+  code = first = index = 0;
+  for(len = 1; len < 16; len++) {
+    code |= bits(z, 1);
+    if(code - first < counts[len]) {
+      return symbols[index + code - first];
+    }
+    index += counts[len];
+    first = (first + counts[len]) << 1;
+    code <<= 1;
+  }
+  z->state = STATE_ERROR;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+fixed_codes(struct httpd_inflate *z)
+{
+  int i;
+
+  for(i = 0; i < 144; i++) {
+    lengths[i] = 8;
+  }
+  for(; i < 256; i++) {
+    lengths[i] = 9;
+  }
+  for(; i < 280; i++) {
+    lengths[i] = 7;
+  }
+  for(; i < 288; i++) {
+    lengths[i] = 8;
+  }
+  build(z->lencode.counts, z->lencode.symbols, lengths, 288);
+  memset(lengths, 5, 30);
+  build(z->distcode.counts, z->distcode.symbols, lengths, 30);
+}
+/*---------------------------------------------------------------------------*/
+static int
+dynamic_codes(struct httpd_inflate *z)
+{
+  int nlen, ndist, ncode, i, symbol, repeat;
+  uint8_t value;
+
+  nlen = bits(z, 5) + 257;
+  ndist = bits(z, 5) + 1;
+  ncode = bits(z, 4) + 4;
+  if(nlen > 286 || ndist > 30) {
+    return 0;
+  }
+
+  /* The code of the code lengths is kept in the distance code for
+     now. */
+  memset(lengths, 0, 19);
+  for(i = 0; i < ncode; i++) {
+    lengths[clen_order[i]] = bits(z, 3);
+  }
+  if(!build(z->distcode.counts, z->distcode.symbols, lengths, 19)) {
+    return 0;
+  }
+
+  for(i = 0; i < nlen + ndist && z->state != STATE_ERROR;) {
+    symbol = decode(z, z->distcode.counts, z->distcode.symbols);
+    if(symbol < 16) {
+      lengths[i++] = symbol;
+      continue;
+    }
+    if(symbol == 16) {
+      if(i == 0) {
+        return 0;
+      }
+      value = lengths[i - 1];
+      repeat = 3 + bits(z, 2);
+    } else {
+      value = 0;
+      repeat = symbol == 17 ? 3 + bits(z, 3) : 11 + bits(z, 7);
+    }
+    if(i + repeat > nlen + ndist) {
+      return 0;
+    }
+    while(repeat-- > 0) {
+      lengths[i++] = value;
+    }
+  }
+
+  return z->state != STATE_ERROR && lengths[256] != 0 &&
+    build(z->lencode.counts, z->lencode.symbols, lengths, nlen) &&
+    build(z->distcode.counts, z->distcode.symbols, lengths + nlen, ndist);
+}
+/*---------------------------------------------------------------------------*/
+static void
+block_header(struct httpd_inflate *z)
+{
+  unsigned len;
+
+  z->last = bits(z, 1);
+  switch(bits(z, 2)) {
+  case 0:
+    /* Stored blocks start at a byte boundary. */
+    z->bitbuf = 0;
+    z->bitcount = 0;
+    if(z->end - z->in < 4) {
+      z->state = STATE_ERROR;
+      return;
+    }
+    len = z->in[0] | z->in[1] << 8;
+    if((len ^ (z->in[2] | z->in[3] << 8)) != 0xffff) {
+      z->state = STATE_ERROR;
+      return;
+    }
+    z->in += 4;
+    z->left = len;
+    z->state = STATE_STORED;
+    break;
+  case 1:
+    fixed_codes(z);
+    z->left = 0;
+    z->state = STATE_CODES;
+    break;
+  case 2:
+    z->left = 0;
+    z->state = dynamic_codes(z) ? STATE_CODES : STATE_ERROR;
+    break;
+  default:
+    z->state = STATE_ERROR;
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+httpd_inflate_init(struct httpd_inflate *z, const char *data, int len)
+{
+  const uint8_t *p = (const uint8_t *)data;
+  const uint8_t *end = p + len;
+  uint8_t flags;
+
+  if(len < 18 || p[0] != 0x1f || p[1] != 0x8b || p[2] != 8) {
+    return 0;
+  }
+  flags = p[3];
+  p += 10;
+  if(flags & GZIP_FEXTRA) {
+    p += 2 + (p[0] | p[1] << 8);
+  }
+  if(flags & GZIP_FNAME) {
+    while(p < end && *p++ != 0);
+  }
+  if(flags & GZIP_FCOMMENT) {
+    while(p < end && *p++ != 0);
+  }
+  if(flags & GZIP_FHCRC) {
+    p += 2;
+  }
+  if(p > end - 8) {
+    return 0;
+  }
+
+  z->in = p;
+  /* The trailer with the CRC and the size is not inflated. */
+  z->end = end - 8;
+  z->bitbuf = 0;
+  z->bitcount = 0;
+  z->state = STATE_BLOCK;
+  z->last = 0;
+  z->left = 0;
+  z->pos = 0;
+  z->total = 0;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+httpd_inflate_next(struct httpd_inflate *z, char **data, int max)
+{
+  int n, symbol;
+  uint16_t from;
+
+  if(z->pos == HTTPD_INFLATE_WINDOW) {
+    z->pos = 0;
+  }
+  if(max > HTTPD_INFLATE_WINDOW - z->pos) {
+    max = HTTPD_INFLATE_WINDOW - z->pos;
+  }
+  *data = &z->window[z->pos];
+
+  for(n = 0; n < max;) {
+    if(z->state == STATE_BLOCK) {
+      if(z->last) {
+        z->state = STATE_DONE;
+        break;
+      }
+      block_header(z);
+
+    } else if(z->state == STATE_STORED) {
+      if(z->left == 0) {
+        z->state = STATE_BLOCK;
+      } else if(z->in == z->end) {
+        z->state = STATE_ERROR;
+      } else {
+        z->window[z->pos++] = *z->in++;
+        z->left--;
+        n++;
+      }
+
+    } else if(z->state == STATE_CODES) {
+      if(z->left > 0) {
+        /* Copy the match. The window holds at least the distance, as
+           checked when the match was decoded. */
+        from = z->pos >= z->dist ? z->pos - z->dist :
+          z->pos + HTTPD_INFLATE_WINDOW - z->dist;
+        z->window[z->pos++] = z->window[from];
+        z->left--;
+        n++;
+        continue;
+      }
+
+      symbol = decode(z, z->lencode.counts, z->lencode.symbols);
+      if(symbol < 256) {
+        z->window[z->pos++] = symbol;
+        n++;
+      } else if(symbol == 256) {
+        z->state = STATE_BLOCK;
+      } else if(symbol < 286) {
+        symbol -= 257;
+        z->left = length_base[symbol] + bits(z, length_extra[symbol]);
+        symbol = decode(z, z->distcode.counts, z->distcode.symbols);
+        if(symbol >= 30) {
+          z->state = STATE_ERROR;
+          break;
+        }
+        z->dist = dist_base[symbol] + bits(z, dist_extra[symbol]);
+        if(z->dist > HTTPD_INFLATE_WINDOW || z->dist > z->total + n) {
+          z->state = STATE_ERROR;
+        }
+      } else {
+        z->state = STATE_ERROR;
+      }
+
+    } else {
+      break;
+    }
+  }
+
+  z->total += n;
+  if(z->state == STATE_ERROR) {
+    return -1;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         A streaming inflater for the gzip files of httpd-fs, used for
+ *         clients that do not accept gzip and for included files.
+ */
+
+#ifndef __HTTPD_INFLATE_H__
+#define __HTTPD_INFLATE_H__
+
+#include "contiki-conf.h"
+
+/* The size of the output window. It must be at least the window of the
+   deflate streams, which makefsdata -w sets. */
+#ifdef WEBSERVER_CONF_INFLATE_WINDOW
+#define HTTPD_INFLATE_WINDOW WEBSERVER_CONF_INFLATE_WINDOW
+#else
+#define HTTPD_INFLATE_WINDOW 1024
+#endif /* WEBSERVER_CONF_INFLATE_WINDOW */
+
+/* A canonical Huffman code: the number of codes of each length, and the
+   symbols in the order of their codes. */
+struct httpd_inflate_code {
+  uint16_t counts[16];
+  uint16_t symbols[288];
+};
+
+struct httpd_inflate_dist_code {
+  uint16_t counts[16];
+  uint16_t symbols[30];
+};
+
+struct httpd_inflate {
+  const uint8_t *in;
+  const uint8_t *end;
+  uint32_t bitbuf;
+  uint8_t bitcount;
+  uint8_t state;
+  uint8_t last;
+  uint16_t left;     /* bytes left of a stored block or a match */
+  uint16_t dist;     /* the distance of the current match */
+  uint16_t pos;      /* where the next byte goes in the window */
+  uint32_t total;    /* the number of bytes inflated so far */
+  struct httpd_inflate_code lencode;
+  struct httpd_inflate_dist_code distcode;
+  char window[HTTPD_INFLATE_WINDOW];
+};
+
+/**
+ * \brief      Start inflating a gzip file.
+ * \param z    The inflater
+ * \param data The gzip file, with its header
+ * \param len  The length of the gzip file
+ * \return     Zero if the header is not one of a deflated gzip file
+ */
+int httpd_inflate_init(struct httpd_inflate *z, const char *data, int len);
+
+/**
+ * \brief      Inflate the next part of the file.
+ * \param z    The inflater
+ * \param data Set to the inflated bytes, which are in the window
+ * \param max  The maximum number of bytes to inflate
+ * \return     The number of bytes, 0 at the end of the file or -1 if the
+ *             file is corrupt
+ *
+ *             The inflated bytes stay valid until the next call. They
+ *             end at the end of the window, so that they can be sent
+ *             from the window as they are.
+ */
+int httpd_inflate_next(struct httpd_inflate *z, char **data, int max);
+
+#endif /* __HTTPD_INFLATE_H__ */
@@ -52,11 +52,25 @@
 #define CONNS WEBSERVER_CONF_CGI_CONNS
 #endif /* WEBSERVER_CONF_CGI_CONNS */
 
+/* The number of gzip files that can be inflated at the same time, for
+   clients that do not accept gzip. Each takes the inflater window and
+   its tables in static RAM, so there are none unless the platform or
+   project opts in. With none, gzip files are sent to all clients as
+   they are. */
+#ifndef WEBSERVER_CONF_INFLATE_CONNS
+#define INFLATE_CONNS 0
+#else /* WEBSERVER_CONF_INFLATE_CONNS */
+#define INFLATE_CONNS WEBSERVER_CONF_INFLATE_CONNS
+#endif /* WEBSERVER_CONF_INFLATE_CONNS */
+
 #define STATE_WAITING 0
 #define STATE_OUTPUT  1
 
 #define SEND_STRING(s, str) PSOCK_SEND(s, (uint8_t *)str, (unsigned int)strlen(str))
 MEMB(conns, struct httpd_state, CONNS);
+#if INFLATE_CONNS > 0
+MEMB(inflaters, struct httpd_inflate, INFLATE_CONNS);
+#endif /* INFLATE_CONNS > 0 */
 
 #define ISO_nl      0x0a
 #define ISO_space   0x20
@@ -96,6 +110,31 @@ PT_THREAD(send_file(struct httpd_state *s))
   PSOCK_END(&s->sout);
 }
 /*---------------------------------------------------------------------------*/
+#if INFLATE_CONNS > 0
+static
+PT_THREAD(send_inflated(struct httpd_state *s))
+{
+  PSOCK_BEGIN(&s->sout);
+
+  PSOCK_WAIT_UNTIL(&s->sout,
+                   (s->inflate = memb_alloc(&inflaters)) != NULL);
+
+  /* The inflater keeps its own pointer into the file, and file.data
+     points to the inflated bytes that are being sent. */
+  if(httpd_inflate_init(s->inflate, s->file.data, s->file.len)) {
+    while((s->len = httpd_inflate_next(s->inflate, &s->file.data,
+                                       HTTPD_INFLATE_WINDOW)) > 0) {
+      PSOCK_SEND(&s->sout, (uint8_t *)s->file.data, s->len);
+    }
+  }
+
+  memb_free(&inflaters, s->inflate);
+  s->inflate = NULL;
+
+  PSOCK_END(&s->sout);
+}
+#endif /* INFLATE_CONNS > 0 */
+/*---------------------------------------------------------------------------*/
 static
 PT_THREAD(send_part_of_file(struct httpd_state *s))
 {
@@ -140,6 +179,11 @@ PT_THREAD(handle_script(struct httpd_state *s))
       s->scriptlen = s->file.len - 3;
       if(*(s->scriptptr - 1) == ISO_colon) {
 	httpd_fs_open(s->scriptptr + 1, &s->file);
+#if INFLATE_CONNS > 0
+	if(s->file.flags & HTTPD_FS_GZIP) {
+	  PT_WAIT_THREAD(&s->scriptpt, send_inflated(s));
+	} else
+#endif /* INFLATE_CONNS > 0 */
 	PT_WAIT_THREAD(&s->scriptpt, send_file(s));
       } else {
 	PT_WAIT_THREAD(&s->scriptpt,
@@ -182,19 +226,12 @@ PT_THREAD(handle_script(struct httpd_state *s))
   PT_END(&s->scriptpt);
 }
 /*---------------------------------------------------------------------------*/
-static
-PT_THREAD(send_headers(struct httpd_state *s, const char *statushdr))
+static const char *
+get_content_type(const char *filename)
 {
-/* gcc warning if not initialized. 
- * If initialized, minimal-net platform segmentation fault if not static...
- */
-  static const char *ptr = NULL;
+  const char *ptr;
 
-  PSOCK_BEGIN(&s->sout);
-
-  SEND_STRING(&s->sout, statushdr);
-
-  ptr = strrchr(s->filename, ISO_period);
+  ptr = strrchr(filename, ISO_period);
   if(ptr == NULL) {
     ptr = http_content_type_binary;
   } else if(strncmp(http_html, ptr, 5) == 0 ||
@@ -211,7 +248,94 @@ PT_THREAD(send_headers(struct httpd_state *s, const char *statushdr))
   } else {
     ptr = http_content_type_plain;
   }
-  SEND_STRING(&s->sout, ptr);
+  return ptr;
+}
+/*---------------------------------------------------------------------------*/
+/* Add the part of a string that falls within the segment that starts at
+   s->sent, and return the position after the string in the response. */
+static unsigned short
+add(struct httpd_state *s, unsigned short pos, const char *str, int len)
+{
+  int skip, n;
+
+  if(pos + len > s->sent && s->len < uip_mss()) {
+    skip = pos < s->sent ? s->sent - pos : 0;
+    n = len - skip;
+    if(n > uip_mss() - s->len) {
+      n = uip_mss() - s->len;
+    }
+    memcpy((char *)uip_appdata + s->len, str + skip, n);
+    s->len += n;
+  }
+  return pos + len;
+}
+/*---------------------------------------------------------------------------*/
+/* Generate a segment of the headers, followed by the file unless it is
+   a script or is inflated. The headers and the start of the file share
+   segments, and a segment is generated again if it is retransmitted. */
+static unsigned short
+generate_response(void *state)
+{
+  struct httpd_state *s = (struct httpd_state *)state;
+  unsigned short pos;
+  char buf[8];
+  const char *type;
+
+  s->len = 0;
+
+  /* Once the headers are sent, only the file is left. */
+  if(s->sent > 0 &&
+     !(s->flags & (HTTPD_SCRIPT | HTTPD_INFLATE | HTTPD_NOT_MODIFIED)) &&
+     s->sent >= s->total - s->file.len) {
+    add(s, s->total - s->file.len, s->file.data, s->file.len);
+    return s->len;
+  }
+
+  pos = add(s, 0, s->statushdr, strlen(s->statushdr));
+
+  if(!(s->flags & (HTTPD_SCRIPT | HTTPD_NOT_MODIFIED))) {
+    pos = add(s, pos, http_content_length, sizeof(http_content_length) - 1);
+    pos = add(s, pos, buf, sprintf(buf, "%u\r\n", (s->flags & HTTPD_INFLATE) ?
+                                   s->file.plain_len : s->file.len));
+  }
+  /* The ETag is that of the file as it is stored. */
+  if(s->file.etag != NULL && s->statushdr != http_header_404 &&
+     !(s->flags & HTTPD_INFLATE)) {
+    pos = add(s, pos, http_etag, sizeof(http_etag) - 1);
+    pos = add(s, pos, s->file.etag, strlen(s->file.etag));
+    pos = add(s, pos, http_crnl, 2);
+  }
+  if(s->flags & HTTPD_SEND_GZIP) {
+    pos = add(s, pos, http_content_encoding_gzip,
+              sizeof(http_content_encoding_gzip) - 1);
+  }
+
+  if(s->flags & HTTPD_NOT_MODIFIED) {
+    pos = add(s, pos, http_crnl, 2);
+  } else {
+    type = s->file.content_type != NULL ? s->file.content_type :
+      get_content_type(s->filename);
+    pos = add(s, pos, type, strlen(type));
+    if(!(s->flags & (HTTPD_SCRIPT | HTTPD_INFLATE))) {
+      pos = add(s, pos, s->file.data, s->file.len);
+    }
+  }
+
+  s->total = pos;
+  return s->len;
+}
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(send_response(struct httpd_state *s))
+{
+  PSOCK_BEGIN(&s->sout);
+
+  s->sent = 0;
+  do {
+    PSOCK_GENERATOR_SEND(&s->sout, generate_response, s);
+    s->sent += s->len;
+  } while(s->sent < s->total);
+
   PSOCK_END(&s->sout);
 }
 /*---------------------------------------------------------------------------*/
@@ -222,27 +346,40 @@ PT_THREAD(handle_output(struct httpd_state *s))
   
   PT_BEGIN(&s->outputpt);
  
+  s->statushdr = http_header_200;
   if(!httpd_fs_open(s->filename, &s->file)) {
     strcpy(s->filename, http_404_html);
     httpd_fs_open(s->filename, &s->file);
-    PT_WAIT_THREAD(&s->outputpt,
-		   send_headers(s,
-		   http_header_404));
-    PT_WAIT_THREAD(&s->outputpt,
-		   send_file(s));
+    s->statushdr = http_header_404;
+  } else if(s->file.etag != NULL &&
+            (!(s->file.flags & HTTPD_FS_GZIP) ||
+             (s->flags & HTTPD_ACCEPT_GZIP)) &&
+            strcmp(s->file.etag, s->etag) == 0) {
+    s->flags |= HTTPD_NOT_MODIFIED;
+    s->statushdr = http_header_304;
   } else {
-    PT_WAIT_THREAD(&s->outputpt,
-		   send_headers(s,
-		   http_header_200));
     ptr = strrchr(s->filename, ISO_period);
     if(ptr != NULL && strncmp(ptr, http_shtml, 6) == 0) {
-      PT_INIT(&s->scriptpt);
-      PT_WAIT_THREAD(&s->outputpt, handle_script(s));
+      s->flags |= HTTPD_SCRIPT;
+    }
+  }
+  if((s->file.flags & HTTPD_FS_GZIP) && !(s->flags & HTTPD_NOT_MODIFIED)) {
+    if((s->flags & HTTPD_ACCEPT_GZIP) || INFLATE_CONNS == 0) {
+      s->flags |= HTTPD_SEND_GZIP;
     } else {
-      PT_WAIT_THREAD(&s->outputpt,
-		     send_file(s));
+      s->flags |= HTTPD_INFLATE;
     }
   }
+
+  PT_WAIT_THREAD(&s->outputpt, send_response(s));
+  if(s->flags & HTTPD_SCRIPT) {
+    PT_INIT(&s->scriptpt);
+    PT_WAIT_THREAD(&s->outputpt, handle_script(s));
+#if INFLATE_CONNS > 0
+  } else if(s->flags & HTTPD_INFLATE) {
+    PT_WAIT_THREAD(&s->outputpt, send_inflated(s));
+#endif /* INFLATE_CONNS > 0 */
+  }
   PSOCK_CLOSE(&s->sout);
   PT_END(&s->outputpt);
 }
@@ -250,6 +387,8 @@ PT_THREAD(handle_output(struct httpd_state *s))
 static
 PT_THREAD(handle_input(struct httpd_state *s))
 {
+  char *ptr;
+
   PSOCK_BEGIN(&s->sin);
 
   PSOCK_READTO(&s->sin, ISO_space);
@@ -273,15 +412,27 @@ PT_THREAD(handle_input(struct httpd_state *s))
   petsciiconv_topetscii(s->filename, sizeof(s->filename));
   webserver_log_file(&uip_conn->ripaddr, s->filename);
   petsciiconv_toascii(s->filename, sizeof(s->filename));
-  s->state = STATE_OUTPUT;
 
   while(1) {
     PSOCK_READTO(&s->sin, ISO_nl);
 
-    if(strncmp(s->inputbuf, http_referer, 8) == 0) {
+    if(PSOCK_DATALEN(&s->sin) <= 2) {
+      /* The empty line after the headers. */
+      s->state = STATE_OUTPUT;
+    } else if(strncmp(s->inputbuf, http_referer, 8) == 0) {
       s->inputbuf[PSOCK_DATALEN(&s->sin) - 2] = 0;
       petsciiconv_topetscii(s->inputbuf, PSOCK_DATALEN(&s->sin) - 2);
       webserver_log(s->inputbuf);
+    } else if(strncmp(s->inputbuf, http_accept_encoding, 16) == 0) {
+      s->inputbuf[PSOCK_DATALEN(&s->sin)] = 0;
+      if(strstr(s->inputbuf + 16, http_gzip) != NULL) {
+        s->flags |= HTTPD_ACCEPT_GZIP;
+      }
+    } else if(strncmp(s->inputbuf, http_if_none_match, 14) == 0) {
+      s->inputbuf[PSOCK_DATALEN(&s->sin)] = 0;
+      for(ptr = s->inputbuf + 14; *ptr == ISO_space; ptr++);
+      strncpy(s->etag, ptr, sizeof(s->etag) - 1);
+      s->etag[strcspn(s->etag, "\r\n, ")] = 0;
     }
   }
   
@@ -304,6 +455,11 @@ httpd_appcall(void *state)
 
   if(uip_closed() || uip_aborted() || uip_timedout()) {
     if(s != NULL) {
+#if INFLATE_CONNS > 0
+      if(s->inflate != NULL) {
+        memb_free(&inflaters, s->inflate);
+      }
+#endif /* INFLATE_CONNS > 0 */
       memb_free(&conns, s);
     }
   } else if(uip_connected()) {
@@ -317,6 +473,9 @@ httpd_appcall(void *state)
     PSOCK_INIT(&s->sout, (uint8_t *)s->inputbuf, sizeof(s->inputbuf) - 1);
     PT_INIT(&s->outputpt);
     s->state = STATE_WAITING;
+    s->flags = 0;
+    s->etag[0] = 0;
+    s->inflate = NULL;
     /*    timer_set(&s->timer, CLOCK_SECOND * 100);*/
     s->timer = 0;
     handle_connection(s);
@@ -325,6 +484,11 @@ httpd_appcall(void *state)
       ++s->timer;
       if(s->timer >= 20) {
 	uip_abort();
+#if INFLATE_CONNS > 0
+	if(s->inflate != NULL) {
+	  memb_free(&inflaters, s->inflate);
+	}
+#endif /* INFLATE_CONNS > 0 */
 	memb_free(&conns, s);
       }
     } else {
@@ -341,6 +505,9 @@ httpd_init(void)
 {
   tcp_listen(UIP_HTONS(80));
   memb_init(&conns);
+#if INFLATE_CONNS > 0
+  memb_init(&inflaters);
+#endif /* INFLATE_CONNS > 0 */
   httpd_cgi_init();
 }
 #if UIP_CONF_IPV6
@@ -38,6 +38,14 @@
 
 #include "contiki-net.h"
 #include "httpd-fs.h"
+#include "httpd-inflate.h"
+
+/* The flags of a request and its response. */
+#define HTTPD_ACCEPT_GZIP   0x01  /* the client accepts gzip */
+#define HTTPD_SEND_GZIP     0x02  /* a gzip file is sent as it is */
+#define HTTPD_INFLATE       0x04  /* a gzip file is sent inflated */
+#define HTTPD_SCRIPT        0x08
+#define HTTPD_NOT_MODIFIED  0x10
 
 struct httpd_state {
   unsigned char timer;
@@ -46,6 +54,11 @@ struct httpd_state {
   char inputbuf[50];
   char filename[20];
   char state;
+  uint8_t flags;
+  char etag[11];              /* the ETag of If-None-Match */
+  const char *statushdr;
+  unsigned short sent, total; /* how much of the headers and file is sent */
+  struct httpd_inflate *inflate;
   struct httpd_fs_file file;  
   int len;
   char *scriptptr;
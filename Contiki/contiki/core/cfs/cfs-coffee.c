@@ -58,6 +58,7 @@
 #include "cfs/cfs.h"
 #include "cfs-coffee-arch.h"
 #include "cfs/cfs-coffee.h"
+#include "sys/process.h"
 
 /* Micro logs enable modifications on storage types that do not support
    in-place updates. This applies primarily to flash memories. */
@@ -90,6 +91,108 @@
 #define COFFEE_EXTENDED_WEAR_LEVELLING	1
 #endif
 
+/*
+ * The name index is a hash table in RAM that maps file names to the
+ * pages where the files start, so that files can be opened without 
+ * scanning the headers in the flash memory. Each entry takes a page 
+ * number and a one-byte fingerprint of the file name. If there are 
+ * more files than entries, names that cannot be found in the index 
+ * are searched for in the flash memory as before. The size can be set 
+ * to 0 in order to disable the index.
+ */
+#ifndef COFFEE_NAME_INDEX_SIZE
+#define COFFEE_NAME_INDEX_SIZE	16
+#endif
+
+/*
+ * Collect garbage in a process that erases one sector at a time, so
+ * that file operations seldom have to wait for the garbage collector.
+ * The process is started when a file is removed. It is off by default
+ * until the moving of files has seen more use on real flash memory.
+ */
+#ifndef COFFEE_GC_INCREMENTAL
+#define COFFEE_GC_INCREMENTAL	0
+#endif
+
+/*
+ * The incremental garbage collector moves files out of the least 
+ * erased sector once the most erased sector has been erased this many 
+ * more times, so that sectors holding static files also take their 
+ * share of the erasures. This is not wear levelling: the erase counts 
+ * are kept in RAM only and start from zero at boot, see 
+ * cfs_coffee_get_erase_count(), so only the erasures since boot are 
+ * balanced. The value 0 disables the moving of files.
+ */
+#ifndef COFFEE_GC_BALANCE_THRESHOLD
+#define COFFEE_GC_BALANCE_THRESHOLD	16
+#endif
+
+/*
+ * When fewer free pages than this many sectors hold remain, the 
+ * incremental garbage collector moves the files out of the sector that 
+ * has the most obsolete pages per active page, so that the sector can 
+ * be erased. The value 0 disables the cleaning of sectors.
+ */
+#ifndef COFFEE_GC_CLEAN_THRESHOLD
+#define COFFEE_GC_CLEAN_THRESHOLD	2
+#endif
+
+/* Moving files to balance the erasures would fragment the free space 
+   if sectors were not cleaned. */
+#if COFFEE_GC_CLEAN_THRESHOLD == 0
+#undef COFFEE_GC_BALANCE_THRESHOLD
+#define COFFEE_GC_BALANCE_THRESHOLD	0
+#endif
+
+/*
+ * The number of flash pages that are cached in RAM for reading file 
+ * data. When a read continues where the previous one ended, the pages 
+ * that it misses are cached together with the next COFFEE_READ_AHEAD 
+ * pages, which are fetched in the same flash read. Other reads go 
+ * directly to the flash memory. The value 0 disables the cache.
+ */
+#ifndef COFFEE_PAGE_CACHE_SIZE
+#define COFFEE_PAGE_CACHE_SIZE	0
+#endif
+
+#ifndef COFFEE_READ_AHEAD
+#define COFFEE_READ_AHEAD	1
+#endif
+
+/*
+ * The record table of the log of an open file is kept in RAM if the 
+ * log has at most this many records, so that reads and writes need 
+ * not search the table in the flash memory. The value 0 disables the 
+ * log index.
+ */
+#ifndef COFFEE_LOG_INDEX_LIMIT
+#define COFFEE_LOG_INDEX_LIMIT	16
+#endif
+
+/*
+ * Keep the log record that was written last in RAM until a write goes 
+ * to another record or the file is closed, so that successive small 
+ * writes to the same record produce a single log record. A successful 
+ * cfs_write() then no longer means that the data is in the flash: the 
+ * buffered record is lost if the node resets before the file is 
+ * closed. The buffer is therefore off by default.
+ */
+#ifndef COFFEE_LOG_WRITE_BUFFER
+#define COFFEE_LOG_WRITE_BUFFER	0
+#endif
+
+#if !COFFEE_MICRO_LOGS
+#undef COFFEE_LOG_INDEX_LIMIT
+#define COFFEE_LOG_INDEX_LIMIT	0
+#undef COFFEE_LOG_WRITE_BUFFER
+#define COFFEE_LOG_WRITE_BUFFER	0
+#endif
+
+/* Count the flash accesses in cfs_coffee_stats. */
+#ifndef COFFEE_STATS
+#define COFFEE_STATS		0
+#endif
+
 #if COFFEE_START & (COFFEE_SECTOR_SIZE - 1)
 #error COFFEE_START must point to the first byte in a sector.
 #endif
@@ -113,6 +216,25 @@
 /* "Reluctant" garbage collection stops after erasing one sector. */
 #define GC_RELUCTANT		1
 
+/* Page types for the sector counters. */
+#define PAGES_ACTIVE		0
+#define PAGES_OBSOLETE		1
+#define PAGES_REMOVED		2
+
+/* Name index states. */
+#define NAME_INDEX_COMPLETE	0
+#define NAME_INDEX_PARTIAL	1
+
+/* Fingerprints of unused name index entries. */
+#define NAME_ENTRY_FREE		0
+#define NAME_ENTRY_REMOVED	1
+
+#if COFFEE_STATS
+#define COFFEE_STATS_ADD(field, n)	(cfs_coffee_stats.field += (n))
+#else
+#define COFFEE_STATS_ADD(field, n)
+#endif
+
 /* File descriptor macros. */
 #define FD_VALID(fd)					\
 	((fd) >= 0 && (fd) < COFFEE_FD_SET_SIZE && 	\
@@ -125,6 +247,11 @@
 #define FILE_MODIFIED(file)	((file)->flags & COFFEE_FILE_MODIFIED)
 #define FILE_FREE(file)		((file)->max_pages == 0)
 #define FILE_UNREFERENCED(file)	((file)->references == 0)
+#if COFFEE_LOG_WRITE_BUFFER
+#define FILE_BUFFERED(f)	(log_buffer.file == (f))
+#else
+#define FILE_BUFFERED(f)	0
+#endif
 
 /* File header flags. */
 #define HDR_FLAG_VALID		0x1	/* Completely written header. */
@@ -133,6 +260,8 @@
 #define HDR_FLAG_MODIFIED	0x8	/* Modified file, log exists. */
 #define HDR_FLAG_LOG		0x10	/* Log file. */
 #define HDR_FLAG_ISOLATED	0x20	/* Isolated page. */
+#define HDR_FLAG_COPY		0x40	/* Copy of a relocated file. */
+#define HDR_FLAG_COPIED		0x80	/* The original of the copy is gone. */
 
 /* File header macros. */
 #define CHECK_FLAG(hdr, flag)	((hdr).flags & (flag))
@@ -146,6 +275,11 @@
 #define HDR_ACTIVE(hdr)		(HDR_ALLOCATED(hdr) && \
 				!HDR_OBSOLETE(hdr)  && \
 				!HDR_ISOLATED(hdr))
+#define HDR_COPYING(hdr)	(CHECK_FLAG(hdr, HDR_FLAG_COPY) && \
+				!CHECK_FLAG(hdr, HDR_FLAG_COPIED))
+
+/* File data is scanned and copied through a buffer of this size. */
+#define COFFEE_CHUNK_SIZE	32
 
 /* Shortcuts derived from the hardware-dependent configuration of Coffee. */
 #define COFFEE_SECTOR_COUNT	(unsigned)(COFFEE_SIZE / COFFEE_SECTOR_SIZE)
@@ -154,11 +288,15 @@
 #define COFFEE_PAGES_PER_SECTOR	\
 	((coffee_page_t)(COFFEE_SECTOR_SIZE / COFFEE_PAGE_SIZE))
 
-/* This structure is used for garbage collection statistics. */
+/* The page counters of a sector, which are kept in RAM so that the
+   garbage collector does not have to read the file headers. */
 struct sector_status {
   coffee_page_t active;
   coffee_page_t obsolete;
-  coffee_page_t free;
+  /* The pages at the start of the sector that belong to a file 
+     starting in a previous sector. */
+  coffee_page_t covered;
+  uint16_t erase_count;
 };
 
 /* The structure of cached file objects. */
@@ -217,18 +355,212 @@ static struct file_desc * const coffee_fd_set = protected_mem.coffee_fd_set;
 static coffee_page_t * const next_free = &protected_mem.next_free;
 static char * const gc_wait = &protected_mem.gc_wait;
 
+#if COFFEE_NAME_INDEX_SIZE > 0
+/*
+ * The name index uses linear probing. An entry is unused if its page
+ * is INVALID_PAGE, in which case the fingerprint tells whether the 
+ * probing for a name can stop at the entry or must continue past it.
+ */
+static coffee_page_t name_index_pages[COFFEE_NAME_INDEX_SIZE];
+static uint8_t name_index_fingerprints[COFFEE_NAME_INDEX_SIZE];
+static uint8_t name_index_state;
+#endif
+
+/* The sector counters, and whether they and the name index have been
+   loaded from the file headers. */
+static struct sector_status sectors[COFFEE_SECTOR_COUNT];
+static char state_loaded;
+
+#if COFFEE_PAGE_CACHE_SIZE > 0
+/* The cached pages are replaced in FIFO order. A slot is unused if its 
+   page is INVALID_PAGE. */
+static coffee_page_t page_cache_pages[COFFEE_PAGE_CACHE_SIZE];
+static unsigned char page_cache_data[COFFEE_PAGE_CACHE_SIZE][COFFEE_PAGE_SIZE];
+static unsigned page_cache_next;
+static cfs_offset_t page_cache_read_end;
+static char page_cache_ready;
+#endif
+
+#if COFFEE_LOG_INDEX_LIMIT > 0
+/* The record table of a log, with one entry per file object. */
+struct log_index {
+  coffee_page_t log_page;
+  uint16_t records;
+  uint16_t regions[COFFEE_LOG_INDEX_LIMIT];
+};
+static struct log_index log_indexes[COFFEE_MAX_OPEN_FILES];
+#endif
+
+#if COFFEE_LOG_WRITE_BUFFER
+/* A log record that has not been written yet. The file is NULL if the 
+   buffer is empty. */
+static struct {
+  struct file *file;
+  uint16_t region;
+  char data[COFFEE_PAGE_SIZE];
+} log_buffer;
+#endif
+
+#if COFFEE_STATS
+struct cfs_coffee_stats cfs_coffee_stats;
+#endif
+
+static unsigned char chunk[COFFEE_CHUNK_SIZE];
+
+static void load_state(void);
+static void collect_garbage(int mode);
+static int remove_by_page(coffee_page_t page, int remove_log, int close_fds,
+                          int gc_allowed);
+
+#if COFFEE_GC_INCREMENTAL
+PROCESS(coffee_gc_process, "Coffee GC");
+#endif
+
+/*---------------------------------------------------------------------------*/
+#if COFFEE_PAGE_CACHE_SIZE > 0
+static void
+page_cache_invalidate(coffee_page_t first, coffee_page_t last)
+{
+  unsigned i;
+
+  if(!page_cache_ready) {
+    page_cache_ready = 1;
+    first = 0;
+    last = COFFEE_PAGE_COUNT - 1;
+  }
+
+  for(i = 0; i < COFFEE_PAGE_CACHE_SIZE; i++) {
+    if(page_cache_pages[i] >= first && page_cache_pages[i] <= last) {
+      page_cache_pages[i] = INVALID_PAGE;
+    }
+  }
+}
+#endif /* COFFEE_PAGE_CACHE_SIZE > 0 */
+/*---------------------------------------------------------------------------*/
+static void
+flash_read(void *buf, cfs_offset_t size, cfs_offset_t offset)
+{
+  COFFEE_READ(buf, size, offset);
+  COFFEE_STATS_ADD(flash_reads, 1);
+  COFFEE_STATS_ADD(flash_read_bytes, size);
+}
+/*---------------------------------------------------------------------------*/
+static void
+flash_write(const void *buf, cfs_offset_t size, cfs_offset_t offset)
+{
+  COFFEE_WRITE(buf, size, offset);
+  COFFEE_STATS_ADD(flash_writes, 1);
+  COFFEE_STATS_ADD(flash_written_bytes, size);
+#if COFFEE_PAGE_CACHE_SIZE > 0
+  page_cache_invalidate(offset / COFFEE_PAGE_SIZE,
+                        (offset + size - 1) / COFFEE_PAGE_SIZE);
+#endif
+}
+/*---------------------------------------------------------------------------*/
+#if COFFEE_PAGE_CACHE_SIZE > 0
+static int
+page_cache_fill(coffee_page_t page)
+{
+  coffee_page_t count;
+  unsigned i;
+
+  count = 1 + COFFEE_READ_AHEAD;
+  if(count > COFFEE_PAGE_CACHE_SIZE) {
+    count = COFFEE_PAGE_CACHE_SIZE;
+  }
+  if(page + count > COFFEE_PAGE_COUNT) {
+    count = COFFEE_PAGE_COUNT - page;
+  }
+
+  /* The pages are read into consecutive slots in a single read. */
+  page_cache_invalidate(page, page + count - 1);
+  if(page_cache_next + count > COFFEE_PAGE_CACHE_SIZE) {
+    page_cache_next = 0;
+  }
+  flash_read(page_cache_data[page_cache_next], count * COFFEE_PAGE_SIZE,
+             page * COFFEE_PAGE_SIZE);
+  for(i = 0; i < count; i++) {
+    page_cache_pages[page_cache_next + i] = page + i;
+  }
+
+  i = page_cache_next;
+  page_cache_next = (page_cache_next + count) % COFFEE_PAGE_CACHE_SIZE;
+  return i;
+}
+#endif /* COFFEE_PAGE_CACHE_SIZE > 0 */
+/*---------------------------------------------------------------------------*/
+/* Read file data, which goes through the page cache if there is one. */
+static void
+read_data(void *buf, cfs_offset_t size, cfs_offset_t offset)
+{
+#if COFFEE_PAGE_CACHE_SIZE > 0
+  coffee_page_t page;
+  cfs_offset_t start, chunk, direct;
+  int i, sequential;
+
+  if(!page_cache_ready) {
+    page_cache_invalidate(0, 0);
+  }
+
+  sequential = offset == page_cache_read_end;
+  page_cache_read_end = offset + size;
+
+  /* The pieces that are not cached are read from the flash memory 
+     together. */
+  for(direct = 0; size > 0; size -= chunk) {
+    page = offset / COFFEE_PAGE_SIZE;
+    start = offset % COFFEE_PAGE_SIZE;
+    chunk = COFFEE_PAGE_SIZE - start;
+    if(chunk > size) {
+      chunk = size;
+    }
+
+    for(i = 0; i < COFFEE_PAGE_CACHE_SIZE; i++) {
+      if(page_cache_pages[i] == page) {
+        break;
+      }
+    }
+    if(i < COFFEE_PAGE_CACHE_SIZE) {
+      COFFEE_STATS_ADD(cache_hits, 1);
+    } else if(sequential && chunk < COFFEE_PAGE_SIZE) {
+      i = page_cache_fill(page);
+    } else {
+      direct += chunk;
+    }
+
+    if(i < COFFEE_PAGE_CACHE_SIZE) {
+      if(direct > 0) {
+        flash_read((char *)buf - direct, direct, offset - direct);
+        direct = 0;
+      }
+      memcpy(buf, &page_cache_data[i][start], chunk);
+    }
+
+    buf = (char *)buf + chunk;
+    offset += chunk;
+  }
+
+  if(direct > 0) {
+    flash_read((char *)buf - direct, direct, offset - direct);
+  }
+#else
+  flash_read(buf, size, offset);
+#endif /* COFFEE_PAGE_CACHE_SIZE > 0 */
+}
 /*---------------------------------------------------------------------------*/
 static void
 write_header(struct file_header *hdr, coffee_page_t page)
 {
   hdr->flags |= HDR_FLAG_VALID;
-  COFFEE_WRITE(hdr, sizeof(*hdr), page * COFFEE_PAGE_SIZE);
+  flash_write(hdr, sizeof(*hdr), page * COFFEE_PAGE_SIZE);
+  COFFEE_STATS_ADD(header_writes, 1);
 }
 /*---------------------------------------------------------------------------*/
 static void
 read_header(struct file_header *hdr, coffee_page_t page)
 {
-  COFFEE_READ(hdr, sizeof(*hdr), page * COFFEE_PAGE_SIZE);
+  flash_read(hdr, sizeof(*hdr), page * COFFEE_PAGE_SIZE);
+  COFFEE_STATS_ADD(header_reads, 1);
 #if DEBUG
   if(HDR_ACTIVE(*hdr) && !HDR_VALID(*hdr)) {
     PRINTF("Invalid header at page %u!\n", (unsigned)page);
@@ -242,104 +574,39 @@ absolute_offset(coffee_page_t page, cfs_offset_t offset)
   return page * COFFEE_PAGE_SIZE + sizeof(struct file_header) + offset;
 }
 /*---------------------------------------------------------------------------*/
-static coffee_page_t
-get_sector_status(uint16_t sector, struct sector_status *stats)
+/* Update the counters of the sectors that a range of pages is in. */
+static void
+count_pages(coffee_page_t page, coffee_page_t count, int type)
 {
-  static coffee_page_t skip_pages;
-  static char last_pages_are_active;
-  struct file_header hdr;
-  coffee_page_t active, obsolete, free;
-  coffee_page_t sector_start, sector_end;
-  coffee_page_t page;
-
-  memset(stats, 0, sizeof(*stats));
-  active = obsolete = free = 0;
-
-  /*
-   * get_sector_status() is an iterative function using local static 
-   * state. It therefore requires the the caller loops starts from 
-   * sector 0 in order to reset the internal state.
-   */
-  if(sector == 0) {
-    skip_pages = 0;
-    last_pages_are_active = 0;
-  }
-
-  sector_start = sector * COFFEE_PAGES_PER_SECTOR;
-  sector_end = sector_start + COFFEE_PAGES_PER_SECTOR;
-
-  /*
-   * Account for pages belonging to a file starting in a previous 
-   * segment that extends into this segment. If the whole segment is 
-   * covered, we do not need to continue counting pages in this iteration.
-   */
-  if(last_pages_are_active) {
-    if(skip_pages >= COFFEE_PAGES_PER_SECTOR) {
-      stats->active = COFFEE_PAGES_PER_SECTOR;
-      skip_pages -= COFFEE_PAGES_PER_SECTOR;
-      return 0;
-    }
-    active = skip_pages;
-  } else {
-    if(skip_pages >= COFFEE_PAGES_PER_SECTOR) {
-      stats->obsolete = COFFEE_PAGES_PER_SECTOR;
-      skip_pages -= COFFEE_PAGES_PER_SECTOR;
-      return skip_pages >= COFFEE_PAGES_PER_SECTOR ? 0 : skip_pages;
+  struct sector_status *sector, *first;
+  coffee_page_t n;
+
+  first = &sectors[page / COFFEE_PAGES_PER_SECTOR];
+  for(sector = first; count > 0; sector++) {
+    n = COFFEE_PAGES_PER_SECTOR - page % COFFEE_PAGES_PER_SECTOR;
+    if(n > count) {
+      n = count;
     }
-    obsolete = skip_pages;
-  }
 
-  /* Determine the amount of pages of each type that have not been 
-     accounted for yet in the current sector. */
-  for(page = sector_start + skip_pages; page < sector_end;) {
-    read_header(&hdr, page);
-    last_pages_are_active = 0;
-    if(HDR_ACTIVE(hdr)) {
-      last_pages_are_active = 1;
-      page += hdr.max_pages;
-      active += hdr.max_pages;
-    } else if(HDR_ISOLATED(hdr)) {
-      page++;
-      obsolete++;
-    } else if(HDR_OBSOLETE(hdr)) {
-      page += hdr.max_pages;
-      obsolete += hdr.max_pages;
-    } else {
-      free = sector_end - page;
+    switch(type) {
+    case PAGES_ACTIVE:
+      sector->active += n;
+      break;
+    case PAGES_OBSOLETE:
+      sector->obsolete += n;
+      break;
+    case PAGES_REMOVED:
+      sector->active -= n;
+      sector->obsolete += n;
       break;
     }
-  }
-
-  /*
-   * Determine the amount of pages in the following sectors that
-   * should be remembered for the next iteration. This is necessary 
-   * because no page except the first of a file contains information 
-   * about what type of page it is. A side effect of remembering this
-   * amount is that there is no need to read in the headers of each 
-   * of these pages from the storage.
-   */
-  skip_pages = active + obsolete + free - COFFEE_PAGES_PER_SECTOR;
-  if(skip_pages > 0) {
-    if(last_pages_are_active) {
-      active = COFFEE_PAGES_PER_SECTOR - obsolete;
-    } else {
-      obsolete = COFFEE_PAGES_PER_SECTOR - active;
+    if(sector != first && type != PAGES_REMOVED) {
+      sector->covered = n;
     }
-  }
-
-  stats->active = active;
-  stats->obsolete = obsolete;
-  stats->free = free;
 
-  /*
-   * To avoid unnecessary page isolation, we notify the callee that 
-   * "skip_pages" pages should be isolated only if the current file extent 
-   * ends in the next sector. If the file extent ends in a more distant 
-   * sector, however, the garbage collection can free the next sector 
-   * immediately without requiring page isolation. 
-   */
-  return (last_pages_are_active || (skip_pages >= COFFEE_PAGES_PER_SECTOR)) ?
-	0 : skip_pages;
+    page += n;
+    count -= n;
+  }
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -362,50 +629,6 @@ isolate_pages(coffee_page_t start, coffee_page_t skip_pages)
 
 }
 /*---------------------------------------------------------------------------*/
-static void
-collect_garbage(int mode)
-{
-  uint16_t sector;
-  struct sector_status stats;
-  coffee_page_t first_page, isolation_count;
-
-  PRINTF("Coffee: Running the file system garbage collector in %s mode\n",
-	 mode == GC_RELUCTANT ? "reluctant" : "greedy");
-  /*
-   * The garbage collector erases as many sectors as possible. A sector is
-   * erasable if there are only free or obsolete pages in it.
-   */
-  for(sector = 0; sector < COFFEE_SECTOR_COUNT; sector++) {
-    isolation_count = get_sector_status(sector, &stats);
-    PRINTF("Coffee: Sector %u has %u active, %u obsolete, and %u free pages.\n",
-        sector, (unsigned)stats.active,
-	(unsigned)stats.obsolete, (unsigned)stats.free);
-
-    if(stats.active > 0) {
-      continue;
-    }
-
-    if((mode == GC_RELUCTANT && stats.free == 0) ||
-       (mode == GC_GREEDY && stats.obsolete > 0)) {
-      first_page = sector * COFFEE_PAGES_PER_SECTOR;
-      if(first_page < *next_free) {
-        *next_free = first_page;
-      }
-
-      if(isolation_count > 0) {
-        isolate_pages(first_page + COFFEE_PAGES_PER_SECTOR, isolation_count);
-      }
-
-      COFFEE_ERASE(sector);
-      PRINTF("Coffee: Erased sector %d!\n", sector);
-
-      if(mode == GC_RELUCTANT && isolation_count > 0) {
-        break;
-      }
-    }
-  }
-}
-/*---------------------------------------------------------------------------*/
 static coffee_page_t
 next_file(coffee_page_t page, struct file_header *hdr)
 {
@@ -442,7 +665,8 @@ load_file(coffee_page_t start, struct file_header *hdr)
     if(FILE_FREE(&coffee_files[i])) {
       free = i;
       break;
-    } else if(FILE_UNREFERENCED(&coffee_files[i])) {
+    } else if(FILE_UNREFERENCED(&coffee_files[i]) &&
+              !FILE_BUFFERED(&coffee_files[i])) {
       unreferenced = i;
     }
   }
@@ -465,16 +689,225 @@ load_file(coffee_page_t start, struct file_header *hdr)
   }
   /* We don't know the amount of records yet. */
   file->record_count = -1;
+#if COFFEE_LOG_INDEX_LIMIT > 0
+  log_indexes[i].log_page = INVALID_PAGE;
+#endif
 
   return file;
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_NAME_INDEX_SIZE > 0
+static uint16_t
+name_hash(const char *name)
+{
+  uint16_t hash;
+
+  for(hash = 5381; *name != '\0'; name++) {
+    hash = (hash << 5) + hash + (unsigned char)*name;
+  }
+
+  /* Spread names that differ only in the last character, such as 
+     numbered files, over the whole index. */
+  return (uint16_t)(hash * 40503U);
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_insert(const char *name, coffee_page_t page)
+{
+  uint16_t hash;
+  unsigned i, n;
+
+  hash = name_hash(name);
+  for(n = 0, i = hash % COFFEE_NAME_INDEX_SIZE;
+      n < COFFEE_NAME_INDEX_SIZE;
+      n++, i = (i + 1) % COFFEE_NAME_INDEX_SIZE) {
+    if(name_index_pages[i] == INVALID_PAGE) {
+      name_index_pages[i] = page;
+      name_index_fingerprints[i] = hash >> 8;
+      return;
+    }
+  }
+
+  PRINTF("Coffee: The name index is full\n");
+  name_index_state = NAME_INDEX_PARTIAL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_remove(const char *name, coffee_page_t page)
+{
+  unsigned i, n;
+
+  for(n = 0, i = name_hash(name) % COFFEE_NAME_INDEX_SIZE;
+      n < COFFEE_NAME_INDEX_SIZE;
+      n++, i = (i + 1) % COFFEE_NAME_INDEX_SIZE) {
+    if(name_index_pages[i] == page) {
+      name_index_pages[i] = INVALID_PAGE;
+      name_index_fingerprints[i] = NAME_ENTRY_REMOVED;
+      return;
+    } else if(name_index_pages[i] == INVALID_PAGE &&
+              name_index_fingerprints[i] == NAME_ENTRY_FREE) {
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_clear(void)
+{
+  unsigned i;
+
+  for(i = 0; i < COFFEE_NAME_INDEX_SIZE; i++) {
+    name_index_pages[i] = INVALID_PAGE;
+    name_index_fingerprints[i] = NAME_ENTRY_FREE;
+  }
+  name_index_state = NAME_INDEX_COMPLETE;
+}
+/*---------------------------------------------------------------------------*/
+static struct file *
+name_index_find(const char *name, int *found)
+{
+  struct file_header hdr;
+  coffee_page_t page;
+  uint16_t hash;
+  unsigned i, n;
+  int j;
+
+  load_state();
+
+  hash = name_hash(name);
+  for(n = 0, i = hash % COFFEE_NAME_INDEX_SIZE;
+      n < COFFEE_NAME_INDEX_SIZE;
+      n++, i = (i + 1) % COFFEE_NAME_INDEX_SIZE) {
+    page = name_index_pages[i];
+    if(page == INVALID_PAGE) {
+      if(name_index_fingerprints[i] == NAME_ENTRY_FREE) {
+        break;
+      }
+      continue;
+    }
+    if(name_index_fingerprints[i] != (uint8_t)(hash >> 8)) {
+      continue;
+    }
+
+    /* The fingerprint matches, but the name must be checked. */
+    read_header(&hdr, page);
+    if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr) && strcmp(name, hdr.name) == 0) {
+      *found = 1;
+      for(j = 0; j < COFFEE_MAX_OPEN_FILES; j++) {
+        if(!FILE_FREE(&coffee_files[j]) && coffee_files[j].page == page) {
+          return &coffee_files[j];
+        }
+      }
+      return load_file(page, &hdr);
+    }
+  }
+
+  /* A name that is missing from a complete index does not exist. */
+  *found = name_index_state == NAME_INDEX_COMPLETE;
+  return NULL;
+}
+#endif /* COFFEE_NAME_INDEX_SIZE > 0 */
+/*---------------------------------------------------------------------------*/
+/*
+ * Complete the relocations that were interrupted after the copy of a 
+ * file had been written, by removing the original. The original is 
+ * the other active file with the same name.
+ */
+static void
+finish_relocations(void)
+{
+  struct file_header hdr, other;
+  coffee_page_t page, original;
+
+  for(page = 0; page < COFFEE_PAGE_COUNT; page = next_file(page, &hdr)) {
+    read_header(&hdr, page);
+    if(!HDR_ACTIVE(hdr) || !HDR_COPYING(hdr)) {
+      continue;
+    }
+
+    for(original = 0;
+        original < COFFEE_PAGE_COUNT;
+        original = next_file(original, &other)) {
+      read_header(&other, original);
+      if(original != page && HDR_ACTIVE(other) && !HDR_LOG(other) &&
+         strcmp(hdr.name, other.name) == 0) {
+        remove_by_page(original, !REMOVE_LOG, !CLOSE_FDS, !ALLOW_GC);
+        break;
+      }
+    }
+
+    hdr.flags |= HDR_FLAG_COPIED;
+    write_header(&hdr, page);
+#if COFFEE_NAME_INDEX_SIZE > 0
+    name_index_insert(hdr.name, page);
+#endif
+    PRINTF("Coffee: Finished moving file %s to page %u\n",
+           hdr.name, (unsigned)page);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+load_state(void)
+{
+  struct file_header hdr;
+  coffee_page_t page;
+  unsigned i;
+  int copying;
+
+  if(state_loaded) {
+    return;
+  }
+  state_loaded = 1;
+
+  for(i = 0; i < COFFEE_SECTOR_COUNT; i++) {
+    sectors[i].active = sectors[i].obsolete = sectors[i].covered = 0;
+  }
+#if COFFEE_NAME_INDEX_SIZE > 0
+  name_index_clear();
+#endif
+
+  /* Count the pages and index the files in a single pass over the 
+     file headers. */
+  copying = 0;
+  for(page = 0; page < COFFEE_PAGE_COUNT; page = next_file(page, &hdr)) {
+    read_header(&hdr, page);
+    if(HDR_ACTIVE(hdr)) {
+      count_pages(page, hdr.max_pages, PAGES_ACTIVE);
+      if(HDR_COPYING(hdr)) {
+        copying = 1;
+      }
+#if COFFEE_NAME_INDEX_SIZE > 0
+      if(!HDR_LOG(hdr)) {
+        name_index_insert(hdr.name, page);
+      }
+#endif
+    } else if(HDR_ISOLATED(hdr)) {
+      count_pages(page, 1, PAGES_OBSOLETE);
+    } else if(HDR_OBSOLETE(hdr)) {
+      count_pages(page, hdr.max_pages, PAGES_OBSOLETE);
+    }
+  }
+
+  if(copying) {
+    finish_relocations();
+  }
+}
+/*---------------------------------------------------------------------------*/
 static struct file *
 find_file(const char *name)
 {
   int i;
   struct file_header hdr;
   coffee_page_t page;
+#if COFFEE_NAME_INDEX_SIZE > 0
+  struct file *file;
+  int found;
+
+  file = name_index_find(name, &found);
+  if(found) {
+    return file;
+  }
+#endif /* COFFEE_NAME_INDEX_SIZE > 0 */
   
   /* First check if the file metadata is cached. */
   for(i = 0; i < COFFEE_MAX_OPEN_FILES; i++) {
@@ -503,8 +936,7 @@ static cfs_offset_t
 file_end(coffee_page_t start)
 {
   struct file_header hdr;
-  unsigned char buf[COFFEE_PAGE_SIZE];
-  coffee_page_t page;
+  cfs_offset_t offset, size;
   int i;
 
   read_header(&hdr, start);
@@ -517,14 +949,15 @@ file_end(coffee_page_t start)
    * are zeroes, then these are skipped from the calculation.
    */
 
-  for(page = hdr.max_pages - 1; page >= 0; page--) {
-    COFFEE_READ(buf, sizeof(buf), (start + page) * COFFEE_PAGE_SIZE);
-    for(i = COFFEE_PAGE_SIZE - 1; i >= 0; i--) {
-      if(buf[i] != 0) {
-	if(page == 0 && i < sizeof(hdr)) {
-	  return 0;
-	}
-	return 1 + i + (page * COFFEE_PAGE_SIZE) - sizeof(hdr);
+  for(offset = (cfs_offset_t)hdr.max_pages * COFFEE_PAGE_SIZE;
+      offset > sizeof(hdr);
+      offset -= size) {
+    size = offset - sizeof(hdr) < sizeof(chunk) ?
+           offset - sizeof(hdr) : sizeof(chunk);
+    flash_read(chunk, size, start * COFFEE_PAGE_SIZE + offset - size);
+    for(i = size - 1; i >= 0; i--) {
+      if(chunk[i] != 0) {
+	return offset - size + i + 1 - sizeof(hdr);
       }
     }
   }
@@ -576,6 +1009,8 @@ remove_by_page(coffee_page_t page, int remove_log, int close_fds,
   struct file_header hdr;
   int i;
 
+  load_state();
+
   read_header(&hdr, page);
   if(!HDR_ACTIVE(hdr)) {
     return -1;
@@ -589,9 +1024,22 @@ remove_by_page(coffee_page_t page, int remove_log, int close_fds,
 
   hdr.flags |= HDR_FLAG_OBSOLETE;
   write_header(&hdr, page);
+  count_pages(page, hdr.max_pages, PAGES_REMOVED);
+
+#if COFFEE_NAME_INDEX_SIZE > 0
+  if(!HDR_LOG(hdr)) {
+    name_index_remove(hdr.name, page);
+  }
+#endif
 
   *gc_wait = 0;
 
+#if COFFEE_GC_INCREMENTAL
+  if(!process_is_running(&coffee_gc_process)) {
+    process_start(&coffee_gc_process, NULL);
+  }
+#endif
+
   /* Close all file descriptors that reference the removed file. */
   if(close_fds) {
     for(i = 0; i < COFFEE_FD_SET_SIZE; i++) {
@@ -601,6 +1049,13 @@ remove_by_page(coffee_page_t page, int remove_log, int close_fds,
     }
   }
 
+#if COFFEE_LOG_WRITE_BUFFER
+  /* A buffered record of a removed file is no longer needed. */
+  if(log_buffer.file != NULL && log_buffer.file->page == page) {
+    log_buffer.file = NULL;
+  }
+#endif
+
   for(i = 0; i < COFFEE_MAX_OPEN_FILES; i++) {
     if(coffee_files[i].page == page) {
       coffee_files[i].page = INVALID_PAGE;
@@ -631,13 +1086,27 @@ reserve(const char *name, coffee_page_t pages,
 {
   struct file_header hdr;
   coffee_page_t page;
+#if COFFEE_GC_INCREMENTAL
+  coffee_page_t saved_next_free;
+#endif
   struct file *file;
 
+  load_state();
+
   if(!allow_duplicates && find_file(name) != NULL) {
     return NULL;
   }
 
   page = find_contiguous_pages(pages);
+#if COFFEE_GC_INCREMENTAL
+  if(page == INVALID_PAGE && *next_free > 0) {
+    /* The allocation point may have been moved past free pages. */
+    saved_next_free = *next_free;
+    *next_free = 0;
+    page = find_contiguous_pages(pages);
+    *next_free = saved_next_free;
+  }
+#endif
   if(page == INVALID_PAGE) {
     if(*gc_wait) {
       return NULL;
@@ -655,6 +1124,13 @@ reserve(const char *name, coffee_page_t pages,
   hdr.max_pages = pages;
   hdr.flags = HDR_FLAG_ALLOCATED | flags;
   write_header(&hdr, page);
+  count_pages(page, pages, PAGES_ACTIVE);
+
+#if COFFEE_NAME_INDEX_SIZE > 0
+  if(!HDR_LOG(hdr)) {
+    name_index_insert(hdr.name, page);
+  }
+#endif
 
   PRINTF("Coffee: Reserved %u pages starting from %u for file %s\n",
       pages, page, name);
@@ -667,6 +1143,412 @@ reserve(const char *name, coffee_page_t pages,
   return file;
 }
 /*---------------------------------------------------------------------------*/
+static void
+erase_sector(unsigned sector)
+{
+  COFFEE_ERASE(sector);
+#if COFFEE_PAGE_CACHE_SIZE > 0
+  page_cache_invalidate(sector * COFFEE_PAGES_PER_SECTOR,
+                        (sector + 1) * COFFEE_PAGES_PER_SECTOR - 1);
+#endif
+  sectors[sector].active = 0;
+  sectors[sector].obsolete = 0;
+  sectors[sector].covered = 0;
+  sectors[sector].erase_count++;
+  COFFEE_STATS_ADD(sector_erases, 1);
+  PRINTF("Coffee: Erased sector %u!\n", sector);
+}
+/*---------------------------------------------------------------------------*/
+/* Erase a sector without active pages, together with the following 
+   sectors that are completely covered by an obsolete file in it. */
+static void
+erase_victim(unsigned sector)
+{
+  unsigned last, i;
+  coffee_page_t covered;
+
+  for(last = sector;
+      last + 1 < COFFEE_SECTOR_COUNT &&
+      sectors[last + 1].covered == COFFEE_PAGES_PER_SECTOR;
+      last++);
+
+  /* Split an obsolete file that ends in the sector after the erased 
+     ones, and mark its remaining pages as isolated. */
+  if(last + 1 < COFFEE_SECTOR_COUNT && sectors[last + 1].covered > 0) {
+    isolate_pages((last + 1) * COFFEE_PAGES_PER_SECTOR,
+                  sectors[last + 1].covered);
+    sectors[last + 1].covered = 0;
+  }
+
+  covered = sectors[sector].covered;
+  for(i = sector; i <= last; i++) {
+    erase_sector(i);
+  }
+
+  /*
+   * The header of an obsolete file that ends in the first erased 
+   * sector remains in a previous sector. Its pages in the erased 
+   * sector are isolated, so that they are not allocated to a new file.
+   */
+  if(covered > 0) {
+    isolate_pages(sector * COFFEE_PAGES_PER_SECTOR, covered);
+    sectors[sector].obsolete = covered;
+    sectors[sector].covered = covered;
+  }
+
+  if(sector * COFFEE_PAGES_PER_SECTOR < *next_free) {
+    *next_free = sector * COFFEE_PAGES_PER_SECTOR;
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if COFFEE_GC_INCREMENTAL
+static coffee_page_t
+free_pages(void)
+{
+  coffee_page_t free;
+  unsigned sector;
+
+  free = 0;
+  for(sector = 0; sector < COFFEE_SECTOR_COUNT; sector++) {
+    free += COFFEE_PAGES_PER_SECTOR - sectors[sector].active - 
+            sectors[sector].obsolete;
+  }
+  return free;
+}
+#endif /* COFFEE_GC_INCREMENTAL */
+/*---------------------------------------------------------------------------*/
+static uint16_t
+min_erase_count(void)
+{
+  uint16_t min;
+  unsigned sector;
+
+  min = sectors[0].erase_count;
+  for(sector = 1; sector < COFFEE_SECTOR_COUNT; sector++) {
+    if(sectors[sector].erase_count < min) {
+      min = sectors[sector].erase_count;
+    }
+  }
+  return min;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Choose the sector to erase by weighing the number of pages that are
+ * reclaimed against the erasures of the sector since boot, counted 
+ * above those of the least erased sector. In reluctant mode, sectors 
+ * that still have free pages ahead of the allocation point are left 
+ * to be filled first.
+ */
+static int
+find_victim(int mode)
+{
+  struct sector_status *status;
+  unsigned sector, last;
+  unsigned long score, best_score;
+  coffee_page_t reclaimed, free;
+  uint16_t min_erase;
+  int victim;
+
+  min_erase = min_erase_count();
+  victim = -1;
+  best_score = 0;
+  for(sector = 0; sector < COFFEE_SECTOR_COUNT; sector++) {
+    status = &sectors[sector];
+    if(status->active > 0 || status->covered == COFFEE_PAGES_PER_SECTOR) {
+      continue;
+    }
+
+    reclaimed = status->obsolete - status->covered;
+    for(last = sector + 1;
+        last < COFFEE_SECTOR_COUNT &&
+        sectors[last].covered == COFFEE_PAGES_PER_SECTOR;
+        last++) {
+      reclaimed += COFFEE_PAGES_PER_SECTOR;
+    }
+    if(reclaimed <= 0) {
+      continue;
+    }
+
+    free = COFFEE_PAGES_PER_SECTOR - status->active - status->obsolete;
+    if(mode == GC_RELUCTANT && free > 0 &&
+       (sector + 1) * COFFEE_PAGES_PER_SECTOR > *next_free) {
+      continue;
+    }
+
+    score = (unsigned long)reclaimed * COFFEE_PAGES_PER_SECTOR /
+            (1 + status->erase_count - min_erase);
+    if(score > best_score) {
+      best_score = score;
+      victim = sector;
+    }
+  }
+
+  return victim;
+}
+/*---------------------------------------------------------------------------*/
+static void
+collect_garbage(int mode)
+{
+  int sector;
+
+  PRINTF("Coffee: Running the file system garbage collector in %s mode\n",
+	 mode == GC_RELUCTANT ? "reluctant" : "greedy");
+
+  load_state();
+  COFFEE_STATS_ADD(gc_runs, 1);
+
+  while((sector = find_victim(mode)) >= 0) {
+    erase_victim(sector);
+    if(mode == GC_RELUCTANT) {
+      break;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if COFFEE_GC_INCREMENTAL
+/*
+ * Move a file that is neither open nor modified to pages outside the 
+ * given sector. The header of the copy is written after its data and 
+ * is marked as a copy until the original has been removed, so that 
+ * finish_relocations() can remove the original if the system stops in 
+ * between.
+ */
+static int
+relocate_file(coffee_page_t page, struct file_header *hdr, unsigned sector)
+{
+  coffee_page_t new_page, saved_next_free;
+  cfs_offset_t offset, end, size;
+  int j;
+
+  if(!HDR_ACTIVE(*hdr) || HDR_LOG(*hdr) || HDR_MODIFIED(*hdr)) {
+    return 0;
+  }
+  for(j = 0; j < COFFEE_MAX_OPEN_FILES; j++) {
+    if(coffee_files[j].page == page && !FILE_UNREFERENCED(&coffee_files[j])) {
+      return 0;
+    }
+  }
+
+  /* Fill the gaps that allocation has left behind. */
+  saved_next_free = *next_free;
+  *next_free = 0;
+  new_page = find_contiguous_pages(hdr->max_pages);
+  *next_free = saved_next_free;
+  if(new_page == INVALID_PAGE ||
+     (new_page < (sector + 1) * COFFEE_PAGES_PER_SECTOR &&
+      new_page + hdr->max_pages > sector * COFFEE_PAGES_PER_SECTOR)) {
+    return 0;
+  }
+
+  /* Copy the data, and write the header last. */
+  end = (cfs_offset_t)hdr->max_pages * COFFEE_PAGE_SIZE;
+  for(offset = sizeof(*hdr); offset < end; offset += size) {
+    size = end - offset < sizeof(chunk) ? end - offset : sizeof(chunk);
+    flash_read(chunk, size, page * COFFEE_PAGE_SIZE + offset);
+    flash_write(chunk, size, new_page * COFFEE_PAGE_SIZE + offset);
+  }
+  hdr->flags = (hdr->flags & ~HDR_FLAG_COPIED) | HDR_FLAG_COPY;
+  write_header(hdr, new_page);
+  count_pages(new_page, hdr->max_pages, PAGES_ACTIVE);
+#if COFFEE_NAME_INDEX_SIZE > 0
+  name_index_insert(hdr->name, new_page);
+#endif
+
+  for(j = 0; j < COFFEE_MAX_OPEN_FILES; j++) {
+    if(coffee_files[j].page == page) {
+      coffee_files[j].page = new_page;
+    }
+  }
+
+  remove_by_page(page, !REMOVE_LOG, !CLOSE_FDS, !ALLOW_GC);
+  hdr->flags |= HDR_FLAG_COPIED;
+  write_header(hdr, new_page);
+  COFFEE_STATS_ADD(relocated_pages, hdr->max_pages);
+
+  PRINTF("Coffee: Moved file %s from page %u to page %u\n",
+         hdr->name, (unsigned)page, (unsigned)new_page);
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Free a sector by moving one of its files elsewhere, starting with 
+ * the file that begins in a previous sector and covers the first pages 
+ * of this one. A sector that only has obsolete pages left is erased.
+ */
+static int
+clean_sector(unsigned sector)
+{
+  struct file_header hdr;
+  coffee_page_t page, start, end;
+  unsigned first;
+
+  if(sectors[sector].active == 0) {
+    if(sectors[sector].covered == COFFEE_PAGES_PER_SECTOR ||
+       sectors[sector].obsolete == sectors[sector].covered) {
+      return 0;
+    }
+    erase_victim(sector);
+    return 1;
+  }
+
+  start = sector * COFFEE_PAGES_PER_SECTOR;
+  end = start + COFFEE_PAGES_PER_SECTOR;
+
+  if(sectors[sector].covered > 0) {
+    for(first = sector - 1;
+        first > 0 && sectors[first].covered == COFFEE_PAGES_PER_SECTOR;
+        first--);
+    for(page = first * COFFEE_PAGES_PER_SECTOR + sectors[first].covered;
+        page < start;
+        page = next_file(page, &hdr)) {
+      read_header(&hdr, page);
+      if(!HDR_FREE(hdr) && page + hdr.max_pages > start) {
+        if(HDR_ACTIVE(hdr)) {
+          return relocate_file(page, &hdr, sector);
+        }
+        break;
+      }
+    }
+  }
+
+  for(page = start + sectors[sector].covered; page < end;
+      page = next_file(page, &hdr)) {
+    read_header(&hdr, page);
+    if(HDR_FREE(hdr)) {
+      break;
+    }
+    if(relocate_file(page, &hdr, sector)) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+#if COFFEE_GC_CLEAN_THRESHOLD > 0
+/*
+ * When free pages run low, clean the sector that has the most obsolete 
+ * pages for each active page that must be copied, weighed against the 
+ * erasures of the sector since boot. The sector that is being allocated is skipped.
+ */
+static int
+clean(void)
+{
+  struct sector_status *status;
+  unsigned sector;
+  unsigned long score, best_score, limit;
+  uint16_t min_erase;
+  int victim;
+
+  if(free_pages() >= COFFEE_GC_CLEAN_THRESHOLD * COFFEE_PAGES_PER_SECTOR) {
+    return 0;
+  }
+
+  /* Try the next best sector if no file can be moved out of one. */
+  min_erase = min_erase_count();
+  for(limit = ~0UL;; limit = best_score) {
+    victim = -1;
+    best_score = 0;
+    for(sector = 0; sector < COFFEE_SECTOR_COUNT; sector++) {
+      status = &sectors[sector];
+      if(status->obsolete == 0 ||
+         sector == *next_free / COFFEE_PAGES_PER_SECTOR) {
+        continue;
+      }
+      score = (unsigned long)status->obsolete * COFFEE_PAGES_PER_SECTOR /
+              (1 + status->active) / (1 + status->erase_count - min_erase);
+      if(score > best_score && score < limit) {
+        best_score = score;
+        victim = sector;
+      }
+    }
+    if(victim < 0) {
+      return 0;
+    }
+    if(clean_sector(victim)) {
+      return 1;
+    }
+  }
+}
+#endif /* COFFEE_GC_CLEAN_THRESHOLD > 0 */
+/*---------------------------------------------------------------------------*/
+#if COFFEE_GC_BALANCE_THRESHOLD > 0
+/*
+ * Balance the erasures if the least erased sector has been erased 
+ * COFFEE_GC_BALANCE_THRESHOLD times fewer than the most erased one, by 
+ * cleaning the least erased sector so that it can be allocated again, 
+ * or by allocating from it if it is free already.
+ */
+static int
+balance_erasures(void)
+{
+  unsigned sector;
+  uint16_t max_erase_count;
+  int coldest;
+
+  coldest = -1;
+  max_erase_count = 0;
+  for(sector = 0; sector < COFFEE_SECTOR_COUNT; sector++) {
+    if(sectors[sector].erase_count > max_erase_count) {
+      max_erase_count = sectors[sector].erase_count;
+    }
+    if(coldest < 0 ||
+       sectors[sector].erase_count < sectors[coldest].erase_count) {
+      coldest = sector;
+    }
+  }
+
+  if(max_erase_count - sectors[coldest].erase_count < COFFEE_GC_BALANCE_THRESHOLD) {
+    return 0;
+  }
+
+  /* Allocate the following files from a sector that is free already. */
+  if(sectors[coldest].active == 0 &&
+     sectors[coldest].obsolete == sectors[coldest].covered) {
+    *next_free = coldest * COFFEE_PAGES_PER_SECTOR + sectors[coldest].covered;
+    return 0;
+  }
+
+  /* Keep a sector's worth of free pages for the files in use. */
+  if(free_pages() < sectors[coldest].active + COFFEE_PAGES_PER_SECTOR) {
+    return 0;
+  }
+
+  return clean_sector(coldest);
+}
+#endif /* COFFEE_GC_BALANCE_THRESHOLD > 0 */
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coffee_gc_process, ev, data)
+{
+  static int sector;
+
+  PROCESS_BEGIN();
+
+  for(;;) {
+    /* Let the process that started the collection continue first. */
+    PROCESS_PAUSE();
+
+    load_state();
+    sector = find_victim(GC_RELUCTANT);
+    if(sector >= 0) {
+      erase_victim(sector);
+#if COFFEE_GC_CLEAN_THRESHOLD > 0
+    } else if(clean()) {
+#endif
+#if COFFEE_GC_BALANCE_THRESHOLD > 0
+    } else if(balance_erasures()) {
+#endif
+    } else {
+      break;
+    }
+    COFFEE_STATS_ADD(gc_slices, 1);
+  }
+
+  PROCESS_END();
+}
+#endif /* COFFEE_GC_INCREMENTAL */
+/*---------------------------------------------------------------------------*/
 #if COFFEE_MICRO_LOGS
 static void
 adjust_log_config(struct file_header *hdr,
@@ -722,7 +1604,7 @@ get_record_index(coffee_page_t log_page, uint16_t search_records,
     }
 
     base -= batch_size * sizeof(indices[0]);
-    COFFEE_READ(&indices, sizeof(indices[0]) * batch_size, base);
+    flash_read(&indices, sizeof(indices[0]) * batch_size, base);
 
     for(i = batch_size - 1; i >= 0; i--) {
       if(indices[i] - 1 == region) {
@@ -739,10 +1621,36 @@ get_record_index(coffee_page_t log_page, uint16_t search_records,
 }
 #endif /* COFFEE_MICRO_LOGS */
 /*---------------------------------------------------------------------------*/
+#if COFFEE_LOG_INDEX_LIMIT > 0
+/* Get the record table of a file's log from RAM, or NULL if the log 
+   has too many records to be indexed. */
+static struct log_index *
+get_log_index(struct file *file, coffee_page_t log_page,
+              uint16_t log_records)
+{
+  struct log_index *index;
+
+  if(log_records > COFFEE_LOG_INDEX_LIMIT) {
+    return NULL;
+  }
+
+  index = &log_indexes[file - coffee_files];
+  if(index->log_page != log_page) {
+    flash_read(index->regions, log_records * sizeof(index->regions[0]),
+               absolute_offset(log_page, 0));
+    for(index->records = 0;
+        index->records < log_records && index->regions[index->records] != 0;
+        index->records++);
+    index->log_page = log_page;
+  }
+  return index;
+}
+#endif /* COFFEE_LOG_INDEX_LIMIT > 0 */
+/*---------------------------------------------------------------------------*/
 #if COFFEE_MICRO_LOGS
 static int
-read_log_page(struct file_header *hdr, int16_t record_count,
-              struct log_param *lp)
+read_log_page(struct file *file, struct file_header *hdr,
+              int16_t record_count, struct log_param *lp)
 {
   uint16_t region;
   int16_t match_index;
@@ -750,11 +1658,32 @@ read_log_page(struct file_header *hdr, int16_t record_count,
   uint16_t log_records;
   cfs_offset_t base;
   uint16_t search_records;
+#if COFFEE_LOG_INDEX_LIMIT > 0
+  struct log_index *index;
+#endif
 
   adjust_log_config(hdr, &log_record_size, &log_records);
   region = modify_log_buffer(log_record_size, &lp->offset, &lp->size);
 
+#if COFFEE_LOG_WRITE_BUFFER
+  if(log_buffer.file == file && log_buffer.region == region) {
+    memcpy((char *)lp->buf, &log_buffer.data[lp->offset], lp->size);
+    return lp->size;
+  }
+#endif
+
   search_records = record_count < 0 ? log_records : record_count;
+#if COFFEE_LOG_INDEX_LIMIT > 0
+  index = get_log_index(file, hdr->log_page, log_records);
+  if(index != NULL) {
+    if(search_records > index->records) {
+      search_records = index->records;
+    }
+    for(match_index = search_records - 1;
+        match_index >= 0 && index->regions[match_index] - 1 != region;
+        match_index--);
+  } else
+#endif
   match_index = get_record_index(hdr->log_page, search_records, region);
   if(match_index < 0) {
     return -1;
@@ -763,7 +1692,7 @@ read_log_page(struct file_header *hdr, int16_t record_count,
   base = absolute_offset(hdr->log_page, log_records * sizeof(region));
   base += (cfs_offset_t)match_index * log_record_size;
   base += lp->offset;
-  COFFEE_READ(lp->buf, lp->size, base);
+  read_data((char *)lp->buf, lp->size, base);
 
   return lp->size;
 }
@@ -833,7 +1762,7 @@ merge_log(coffee_page_t file_page, int extend)
       cfs_close(fd);
       return -1;
     } else if(n > 0) {
-      COFFEE_WRITE(buf, n, absolute_offset(new_file->page, offset));
+      flash_write(buf, n, absolute_offset(new_file->page, offset));
       offset += n;
     }
   } while(n != 0);
@@ -873,10 +1802,21 @@ find_next_record(struct file *file, coffee_page_t log_page,
 {
   int log_record, preferred_batch_size;
 
+#if COFFEE_LOG_INDEX_LIMIT > 0
+  struct log_index *index;
+#endif
+
   if(file->record_count >= 0) {
     return file->record_count;
   }
 
+#if COFFEE_LOG_INDEX_LIMIT > 0
+  index = get_log_index(file, log_page, log_records);
+  if(index != NULL) {
+    return index->records;
+  }
+#endif
+
   preferred_batch_size = log_records > COFFEE_LOG_TABLE_LIMIT ?
 			 COFFEE_LOG_TABLE_LIMIT : log_records;
   {
@@ -890,7 +1830,7 @@ find_next_record(struct file *file, coffee_page_t log_page,
       batch_size = log_records - processed >= preferred_batch_size ?
 	preferred_batch_size : log_records - processed;
 
-      COFFEE_READ(&indices, batch_size * sizeof(indices[0]),
+      flash_read(&indices, batch_size * sizeof(indices[0]),
 		  absolute_offset(log_page, processed * sizeof(indices[0])));
       for(log_record = 0; log_record < batch_size; log_record++) {
 	if(indices[log_record] == 0) {
@@ -906,6 +1846,78 @@ find_next_record(struct file *file, coffee_page_t log_page,
 #endif /* COFFEE_MICRO_LOGS */
 /*---------------------------------------------------------------------------*/
 #if COFFEE_MICRO_LOGS
+static void
+append_log_record(struct file *file, struct file_header *hdr,
+                  int16_t log_record, uint16_t region, const char *data)
+{
+  uint16_t log_record_size, log_records;
+  cfs_offset_t offset;
+#if COFFEE_LOG_INDEX_LIMIT > 0
+  struct log_index *index;
+#endif
+
+  adjust_log_config(hdr, &log_record_size, &log_records);
+
+  /*
+   * Write the region number in the region index table.
+   * The region number is incremented to avoid values of zero.
+   */
+  offset = absolute_offset(hdr->log_page, 0);
+  ++region;
+  flash_write(&region, sizeof(region),
+	      offset + log_record * sizeof(region));
+
+  offset += log_records * sizeof(region);
+  flash_write(data, log_record_size,
+	      offset + log_record * log_record_size);
+  file->record_count = log_record + 1;
+
+#if COFFEE_LOG_INDEX_LIMIT > 0
+  index = get_log_index(file, hdr->log_page, log_records);
+  if(index != NULL) {
+    index->regions[log_record] = region;
+    index->records = log_record + 1;
+  }
+#endif
+}
+#endif /* COFFEE_MICRO_LOGS */
+/*---------------------------------------------------------------------------*/
+#if COFFEE_LOG_WRITE_BUFFER
+/*
+ * Write the buffered log record. Returns 1 if the buffer is empty 
+ * afterwards, 0 if the file was merged with its log, and -1 if the 
+ * record could not be written.
+ */
+static int
+flush_log_buffer(void)
+{
+  struct file_header hdr;
+  struct file *file;
+  uint16_t log_record_size, log_records;
+  int16_t log_record;
+
+  file = log_buffer.file;
+  if(file == NULL) {
+    return 1;
+  }
+
+  read_header(&hdr, file->page);
+  adjust_log_config(&hdr, &log_record_size, &log_records);
+  log_record = find_next_record(file, hdr.log_page, log_records);
+  if(log_record >= log_records) {
+    /* The merge reads the buffered record along with the file. */
+    PRINTF("Coffee: Merging the file %s with its log\n", hdr.name);
+    return merge_log(file->page, 0) < 0 ? -1 : 0;
+  }
+
+  append_log_record(file, &hdr, log_record, log_buffer.region,
+                    log_buffer.data);
+  log_buffer.file = NULL;
+  return 1;
+}
+#endif /* COFFEE_LOG_WRITE_BUFFER */
+/*---------------------------------------------------------------------------*/
+#if COFFEE_MICRO_LOGS
 static int
 write_log_page(struct file *file, struct log_param *lp)
 {
@@ -917,12 +1929,28 @@ write_log_page(struct file *file, struct log_param *lp)
   uint16_t log_records;
   cfs_offset_t offset;
   struct log_param lp_out;
+#if COFFEE_LOG_WRITE_BUFFER
+  int r;
+#endif
 
   read_header(&hdr, file->page);
 
   adjust_log_config(&hdr, &log_record_size, &log_records);
   region = modify_log_buffer(log_record_size, &lp->offset, &lp->size);
 
+#if COFFEE_LOG_WRITE_BUFFER
+  if(log_buffer.file == file && log_buffer.region == region) {
+    memcpy(&log_buffer.data[lp->offset], lp->buf, lp->size);
+    return lp->size;
+  }
+
+  /* Make room for the record that is written now. */
+  r = flush_log_buffer();
+  if(r <= 0) {
+    return r;
+  }
+#endif
+
   log_page = 0;
   if(HDR_MODIFIED(hdr)) {
     /* A log structure has already been created. */
@@ -946,33 +1974,30 @@ write_log_page(struct file *file, struct log_param *lp)
   }
 
   {
+#if COFFEE_LOG_WRITE_BUFFER
+    char *copy_buf = log_buffer.data;
+#else
     char copy_buf[log_record_size];
+#endif
 
     lp_out.offset = offset = region * log_record_size;
     lp_out.buf = copy_buf;
     lp_out.size = log_record_size;
 
     if((lp->offset > 0 || lp->size != log_record_size) &&
-	read_log_page(&hdr, log_record, &lp_out) < 0) {
-      COFFEE_READ(copy_buf, sizeof(copy_buf),
+	read_log_page(file, &hdr, log_record, &lp_out) < 0) {
+      read_data(copy_buf, log_record_size,
 	  absolute_offset(file->page, offset));
     }
 
     memcpy(&copy_buf[lp->offset], lp->buf, lp->size);
 
-    /*
-     * Write the region number in the region index table.
-     * The region number is incremented to avoid values of zero.
-     */
-    offset = absolute_offset(log_page, 0);
-    ++region;
-    COFFEE_WRITE(&region, sizeof(region),
-		 offset + log_record * sizeof(region));
-
-    offset += log_records * sizeof(region);
-    COFFEE_WRITE(copy_buf, sizeof(copy_buf),
-		 offset + log_record * log_record_size);
-    file->record_count = log_record + 1;
+#if COFFEE_LOG_WRITE_BUFFER
+    log_buffer.file = file;
+    log_buffer.region = region;
+#else
+    append_log_record(file, &hdr, log_record, region, copy_buf);
+#endif
   }
 
   return lp->size;
@@ -1032,6 +2057,11 @@ void
 cfs_close(int fd)
 {
   if(FD_VALID(fd)) {
+#if COFFEE_LOG_WRITE_BUFFER
+    if(FILE_BUFFERED(coffee_fd_set[fd].file)) {
+      flush_log_buffer();
+    }
+#endif
     coffee_fd_set[fd].flags = COFFEE_FD_FREE;
     coffee_fd_set[fd].file->references--;
     coffee_fd_set[fd].file = NULL;
@@ -1113,7 +2143,7 @@ cfs_read(int fd, void *buf, unsigned size)
 
   /* If the file is allocated, read directly in the file. */
   if(!FILE_MODIFIED(file)) {
-    COFFEE_READ(buf, size, absolute_offset(file->page, fdp->offset));
+    read_data(buf, size, absolute_offset(file->page, fdp->offset));
     fdp->offset += size;
     return size;
   }
@@ -1131,11 +2161,11 @@ cfs_read(int fd, void *buf, unsigned size)
     lp.offset = fdp->offset;
     lp.buf = buf;
     lp.size = bytes_left;
-    r = read_log_page(&hdr, file->record_count, &lp);
+    r = read_log_page(file, &hdr, file->record_count, &lp);
 
     /* Read from the original file if we cannot find the data in the log. */
     if(r < 0) {
-      COFFEE_READ(buf, lp.size, absolute_offset(file->page, fdp->offset));
+      read_data(buf, lp.size, absolute_offset(file->page, fdp->offset));
       r = lp.size;
     }
     fdp->offset += r;
@@ -1218,7 +2248,7 @@ cfs_write(int fd, const void *buf, unsigned size)
 
     if(fdp->offset > file->end) {
       /* Update the original file's end with a dummy write. */
-      COFFEE_WRITE(dummy, 1, absolute_offset(file->page, fdp->offset));
+      flash_write(dummy, 1, absolute_offset(file->page, fdp->offset));
     }
   } else {
 #endif /* COFFEE_MICRO_LOGS */
@@ -1228,7 +2258,7 @@ cfs_write(int fd, const void *buf, unsigned size)
     }
 #endif /* COFFEE_APPEND_ONLY */
 
-    COFFEE_WRITE(buf, size, absolute_offset(file->page, fdp->offset));
+    flash_write(buf, size, absolute_offset(file->page, fdp->offset));
     fdp->offset += size;
 #if COFFEE_MICRO_LOGS
   }
@@ -1344,18 +2374,34 @@ cfs_coffee_format(void)
   *next_free = 0;
 
   for(i = 0; i < COFFEE_SECTOR_COUNT; i++) {
-    COFFEE_ERASE(i);
+    erase_sector(i);
     PRINTF(".");
   }
 
   /* Formatting invalidates the file information. */
   memset(&protected_mem, 0, sizeof(protected_mem));
+#if COFFEE_LOG_WRITE_BUFFER
+  log_buffer.file = NULL;
+#endif
+  state_loaded = 1;
+#if COFFEE_NAME_INDEX_SIZE > 0
+  name_index_clear();
+#endif
 
   PRINTF(" done!\n");
 
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+long
+cfs_coffee_get_erase_count(unsigned sector)
+{
+  if(sector >= COFFEE_SECTOR_COUNT) {
+    return -1;
+  }
+  return sectors[sector].erase_count;
+}
+/*---------------------------------------------------------------------------*/
 void *
 cfs_coffee_get_protected_mem(unsigned *size)
 {
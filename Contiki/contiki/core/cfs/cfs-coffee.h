@@ -126,6 +126,21 @@ int cfs_coffee_set_io_semantics(int fd, unsigned flags);
  */
 int cfs_coffee_format(void);
 
+/**
+ * \brief Get the number of times that a sector has been erased.
+ * \param sector The sector number, counted from the start of Coffee.
+ * \return The erase count, or -1 if there is no such sector.
+ *
+ * The erase counts are kept in RAM, and count the erasures since the 
+ * system was started. The incremental garbage collector uses them to 
+ * balance the erasures of the sectors. They are not stored in the 
+ * flash memory, because the Coffee format has no per-sector metadata,
+ * so they restart at zero after every reboot. This is therefore not 
+ * wear levelling: a node that reboots often before 
+ * COFFEE_GC_BALANCE_THRESHOLD is reached gets no balancing at all.
+ */
+long cfs_coffee_get_erase_count(unsigned sector);
+
 /**
  * \brief Points out a memory region that may not be altered during
  * checkpointing operations that use the file system.
@@ -138,6 +153,31 @@ int cfs_coffee_format(void);
  */
 void *cfs_coffee_get_protected_mem(unsigned *size);
 
+/**
+ * \brief Counters of the flash accesses of Coffee.
+ *
+ * The counters are updated if Coffee is compiled with COFFEE_STATS
+ * set to 1, and may be reset by the application at any time.
+ */
+struct cfs_coffee_stats {
+  unsigned long header_reads;
+  unsigned long header_writes;
+  unsigned long sector_erases;
+  /* Garbage collections that file operations had to wait for. */
+  unsigned long gc_runs;
+  /* Sectors erased or files moved by the garbage collection process. */
+  unsigned long gc_slices;
+  unsigned long relocated_pages;
+  unsigned long flash_reads;
+  unsigned long flash_read_bytes;
+  unsigned long flash_writes;
+  unsigned long flash_written_bytes;
+  /* Reads of file data that were served by the page cache. */
+  unsigned long cache_hits;
+};
+
+extern struct cfs_coffee_stats cfs_coffee_stats;
+
 /** @} */
 /** @} */
 
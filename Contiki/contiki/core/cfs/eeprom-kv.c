@@ -0,0 +1,677 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *	A log-structured key/value store for EEPROM.
+ *
+ *	The EEPROM area is divided into segments that are used as a ring.
+ *	Each segment starts with a header that holds its sequence number,
+ *	and records are appended to the newest segment. A record holds a
+ *	key, a value and a checksum that includes the sequence number of
+ *	its segment, so that records left over from an earlier use of the
+ *	segment are never mistaken for new ones. When the ring is full,
+ *	the live records of the oldest segment are copied to the newest
+ *	one, which spreads the writes over the whole area.
+ */
+
+#include <string.h>
+
+#include "contiki-conf.h"
+#include "dev/eeprom.h"
+#include "lib/crc16.h"
+#include "cfs/eeprom-kv.h"
+
+#define DEBUG 0
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+#ifdef EEPROM_KV_CONF_OFFSET
+#define EEPROM_KV_OFFSET EEPROM_KV_CONF_OFFSET
+#else
+#define EEPROM_KV_OFFSET 0
+#endif
+
+#ifdef EEPROM_KV_CONF_SIZE
+#define EEPROM_KV_SIZE EEPROM_KV_CONF_SIZE
+#else
+#define EEPROM_KV_SIZE 1024
+#endif
+
+/* The area is used in segments of this size. A record must fit in a
+   segment. */
+#ifdef EEPROM_KV_CONF_SEGMENT_SIZE
+#define EEPROM_KV_SEGMENT_SIZE EEPROM_KV_CONF_SEGMENT_SIZE
+#else
+#define EEPROM_KV_SEGMENT_SIZE 256
+#endif
+
+/* The size of the pages that writes are collected in before they are
+   written to the EEPROM. Zero writes each piece of a record at once. */
+#ifdef EEPROM_KV_CONF_PAGE_SIZE
+#define EEPROM_KV_PAGE_SIZE EEPROM_KV_CONF_PAGE_SIZE
+#else
+#define EEPROM_KV_PAGE_SIZE 32
+#endif
+
+/* The number of keys that the RAM index has room for. */
+#ifdef EEPROM_KV_CONF_KEYS
+#define EEPROM_KV_KEYS EEPROM_KV_CONF_KEYS
+#else
+#define EEPROM_KV_KEYS 16
+#endif
+
+#ifdef EEPROM_KV_CONF_KEY_SIZE
+#define EEPROM_KV_KEY_SIZE EEPROM_KV_CONF_KEY_SIZE
+#else
+#define EEPROM_KV_KEY_SIZE 16
+#endif
+
+#define SEGMENTS	(EEPROM_KV_SIZE / EEPROM_KV_SEGMENT_SIZE)
+
+#if SEGMENTS < 3
+#error "The EEPROM key/value store needs at least three segments."
+#endif
+
+#if EEPROM_KV_PAGE_SIZE > 0 && EEPROM_KV_SEGMENT_SIZE % EEPROM_KV_PAGE_SIZE
+#error "The segment size must be a multiple of the page size."
+#endif
+
+/* Segment header: magic, sequence number, sequence number of the
+   oldest segment in use, and a checksum of the preceding fields. */
+#define SEGMENT_MAGIC		0x4b56
+#define SEGMENT_HEADER_SIZE	8
+
+/* Record: key length, flags and value length, followed by the key,
+   the value and a checksum. */
+#define RECORD_HEADER_SIZE	4
+#define RECORD_SIZE(key_len, value_len)	\
+	(RECORD_HEADER_SIZE + (key_len) + (value_len) + 2)
+#define FLAG_REMOVED		0x1
+
+#define SEGMENT_ADDR(segment)	((unsigned)(segment) * EEPROM_KV_SEGMENT_SIZE)
+#define NEXT_SEGMENT(segment)	(((segment) + 1) % SEGMENTS)
+
+#define COPY_BUFFER_SIZE	16
+
+struct record {
+  unsigned addr;
+  unsigned char key_len;
+  unsigned char flags;
+  unsigned value_len;
+};
+
+struct index_entry {
+  unsigned short hash;
+  eeprom_addr_t addr;
+};
+
+static struct index_entry key_index[EEPROM_KV_KEYS];
+static int keys;
+
+/* The oldest and the newest segment in use, and the end of the data
+   in the newest one. */
+static int head, tail;
+static unsigned short head_seq, tail_seq;
+static unsigned tail_end;
+
+#if EEPROM_KV_PAGE_SIZE > 0
+static unsigned char page_buffer[EEPROM_KV_PAGE_SIZE];
+static unsigned buffer_start, buffer_end;
+#endif
+
+/*---------------------------------------------------------------------------*/
+static void
+put16(unsigned char *p, unsigned short value)
+{
+  p[0] = value & 0xff;
+  p[1] = value >> 8;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+get16(const unsigned char *p)
+{
+  return p[0] | (p[1] << 8);
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+hash_key(const char *key, int len)
+{
+  unsigned short hash;
+
+  for(hash = 0; len > 0; len--) {
+    hash = hash * 31 + (unsigned char)*key++;
+  }
+  return hash;
+}
+/*---------------------------------------------------------------------------*/
+/* Read from the EEPROM, including data that is still in the page
+   buffer. */
+static void
+read_bytes(unsigned addr, void *buf, int len)
+{
+#if EEPROM_KV_PAGE_SIZE > 0
+  unsigned start, end;
+#endif
+
+  eeprom_read(EEPROM_KV_OFFSET + addr, buf, len);
+
+#if EEPROM_KV_PAGE_SIZE > 0
+  start = addr > buffer_start ? addr : buffer_start;
+  end = addr + len < buffer_end ? addr + len : buffer_end;
+  if(start < end) {
+    memcpy((unsigned char *)buf + (start - addr),
+           &page_buffer[start % EEPROM_KV_PAGE_SIZE], end - start);
+  }
+#endif
+}
+/*---------------------------------------------------------------------------*/
+void
+eeprom_kv_flush(void)
+{
+#if EEPROM_KV_PAGE_SIZE > 0
+  if(buffer_start < buffer_end) {
+    eeprom_write(EEPROM_KV_OFFSET + buffer_start,
+                 &page_buffer[buffer_start % EEPROM_KV_PAGE_SIZE],
+                 buffer_end - buffer_start);
+  }
+  buffer_start = buffer_end = 0;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+/* Write to the EEPROM through the page buffer. Data is only ever 
+   appended to the log, so the buffer holds a contiguous range of a 
+   single page. */
+static void
+write_bytes(unsigned addr, const void *buf, int len)
+{
+#if EEPROM_KV_PAGE_SIZE > 0
+  int n;
+
+  while(len > 0) {
+    if(buffer_start < buffer_end && addr != buffer_end) {
+      eeprom_kv_flush();
+    }
+    if(buffer_start == buffer_end) {
+      buffer_start = buffer_end = addr;
+    }
+
+    n = EEPROM_KV_PAGE_SIZE - addr % EEPROM_KV_PAGE_SIZE;
+    if(n > len) {
+      n = len;
+    }
+    memcpy(&page_buffer[addr % EEPROM_KV_PAGE_SIZE], buf, n);
+    buffer_end += n;
+    if(buffer_end % EEPROM_KV_PAGE_SIZE == 0) {
+      eeprom_kv_flush();
+    }
+
+    addr += n;
+    buf = (const unsigned char *)buf + n;
+    len -= n;
+  }
+#else
+  eeprom_write(EEPROM_KV_OFFSET + addr, (unsigned char *)buf, len);
+#endif
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+checksum(unsigned addr, unsigned len, unsigned short acc)
+{
+  unsigned char buf[COPY_BUFFER_SIZE];
+  unsigned n;
+
+  for(; len > 0; len -= n, addr += n) {
+    n = len < sizeof(buf) ? len : sizeof(buf);
+    read_bytes(addr, buf, n);
+    acc = crc16_data(buf, n, acc);
+  }
+  return acc;
+}
+/*---------------------------------------------------------------------------*/
+static int
+read_segment_header(int segment, unsigned short *seq, unsigned short *first)
+{
+  unsigned char hdr[SEGMENT_HEADER_SIZE];
+
+  read_bytes(SEGMENT_ADDR(segment), hdr, sizeof(hdr));
+  if(get16(hdr) != SEGMENT_MAGIC ||
+     get16(&hdr[6]) != crc16_data(hdr, 6, 0)) {
+    return 0;
+  }
+  *seq = get16(&hdr[2]);
+  *first = get16(&hdr[4]);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+open_segment(void)
+{
+  unsigned char hdr[SEGMENT_HEADER_SIZE];
+
+  tail = NEXT_SEGMENT(tail);
+  tail_seq++;
+  tail_end = SEGMENT_HEADER_SIZE;
+
+  put16(hdr, SEGMENT_MAGIC);
+  put16(&hdr[2], tail_seq);
+  put16(&hdr[4], head_seq);
+  put16(&hdr[6], crc16_data(hdr, 6, 0));
+  write_bytes(SEGMENT_ADDR(tail), hdr, sizeof(hdr));
+
+  PRINTF("eeprom-kv: opened segment %d, seq %u\n", tail, tail_seq);
+}
+/*---------------------------------------------------------------------------*/
+/* Read the record at addr. If key is not NULL, the key is copied to it
+   and the checksum of the record is verified against the sequence
+   number of its segment. */
+static int
+read_record(struct record *r, unsigned addr, unsigned short seq, char *key)
+{
+  unsigned char hdr[RECORD_HEADER_SIZE + 2];
+  unsigned offset;
+  unsigned short crc;
+
+  offset = addr % EEPROM_KV_SEGMENT_SIZE;
+  if(offset + RECORD_SIZE(1, 0) > EEPROM_KV_SEGMENT_SIZE) {
+    return 0;
+  }
+
+  read_bytes(addr, hdr, RECORD_HEADER_SIZE);
+  r->addr = addr;
+  r->key_len = hdr[0];
+  r->flags = hdr[1];
+  r->value_len = get16(&hdr[2]);
+  if(r->key_len == 0 || r->key_len > EEPROM_KV_KEY_SIZE ||
+     (r->flags & ~FLAG_REMOVED) != 0 ||
+     offset + RECORD_SIZE(r->key_len, r->value_len) > EEPROM_KV_SEGMENT_SIZE) {
+    return 0;
+  }
+
+  if(key != NULL) {
+    put16(&hdr[RECORD_HEADER_SIZE], seq);
+    crc = crc16_data(&hdr[RECORD_HEADER_SIZE], 2, 0);
+    crc = crc16_data(hdr, RECORD_HEADER_SIZE, crc);
+    read_bytes(addr + RECORD_HEADER_SIZE, key, r->key_len);
+    crc = crc16_data((unsigned char *)key, r->key_len, crc);
+    crc = checksum(addr + RECORD_HEADER_SIZE + r->key_len, r->value_len, crc);
+    read_bytes(addr + RECORD_HEADER_SIZE + r->key_len + r->value_len, hdr, 2);
+    if(get16(hdr) != crc) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Find the index entry of a key, and read its record. */
+static int
+find(const char *key, int key_len, unsigned short hash, struct record *r)
+{
+  char stored[EEPROM_KV_KEY_SIZE];
+  int i;
+
+  for(i = 0; i < keys; i++) {
+    if(key_index[i].hash == hash &&
+       read_record(r, key_index[i].addr, 0, NULL) && r->key_len == key_len) {
+      read_bytes(r->addr + RECORD_HEADER_SIZE, stored, key_len);
+      if(memcmp(stored, key, key_len) == 0) {
+        return i;
+      }
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+static int reserve(unsigned size, int compacting);
+
+/* Append a record to the log. The key and the value are taken from 
+   RAM if key is not NULL, and otherwise copied from the record at 
+   from. */
+static int
+append(unsigned char *hdr, const char *key, const void *value,
+       unsigned from, int compacting)
+{
+  unsigned char buf[COPY_BUFFER_SIZE];
+  unsigned key_len, value_len, len, n, to;
+  unsigned short crc;
+  int addr;
+
+  key_len = hdr[0];
+  value_len = get16(&hdr[2]);
+  addr = reserve(RECORD_SIZE(key_len, value_len), compacting);
+  if(addr < 0) {
+    return -1;
+  }
+
+  /* The checksum covers the sequence number of the segment that the
+     record is written to. */
+  put16(buf, tail_seq);
+  crc = crc16_data(buf, 2, 0);
+  crc = crc16_data(hdr, RECORD_HEADER_SIZE, crc);
+  write_bytes(addr, hdr, RECORD_HEADER_SIZE);
+  to = addr + RECORD_HEADER_SIZE;
+
+  if(key != NULL) {
+    crc = crc16_data((unsigned char *)key, key_len, crc);
+    write_bytes(to, key, key_len);
+    crc = crc16_data((unsigned char *)value, value_len, crc);
+    write_bytes(to + key_len, value, value_len);
+    to += key_len + value_len;
+  } else {
+    from += RECORD_HEADER_SIZE;
+    for(len = key_len + value_len; len > 0; len -= n) {
+      n = len < sizeof(buf) ? len : sizeof(buf);
+      read_bytes(from, buf, n);
+      crc = crc16_data(buf, n, crc);
+      write_bytes(to, buf, n);
+      from += n;
+      to += n;
+    }
+  }
+
+  put16(buf, crc);
+  write_bytes(to, buf, 2);
+  tail_end += RECORD_SIZE(key_len, value_len);
+
+  return addr;
+}
+/*---------------------------------------------------------------------------*/
+/* Move the live records of the oldest segment to the newest one, and
+   release the oldest segment. Records of removed keys and replaced 
+   values are dropped. */
+static void
+compact(void)
+{
+  unsigned char hdr[RECORD_HEADER_SIZE];
+  struct record r;
+  unsigned addr;
+  int i, new_addr;
+
+  PRINTF("eeprom-kv: compacting segment %d\n", head);
+
+  addr = SEGMENT_ADDR(head) + SEGMENT_HEADER_SIZE;
+  while(read_record(&r, addr, head_seq, NULL)) {
+    for(i = 0; i < keys; i++) {
+      if(key_index[i].addr == addr) {
+        hdr[0] = r.key_len;
+        hdr[1] = r.flags;
+        put16(&hdr[2], r.value_len);
+        new_addr = append(hdr, NULL, NULL, addr, 1);
+        if(new_addr >= 0) {
+          key_index[i].addr = new_addr;
+        }
+        break;
+      }
+    }
+    addr += RECORD_SIZE(r.key_len, r.value_len);
+  }
+
+  head = NEXT_SEGMENT(head);
+  head_seq++;
+}
+/*---------------------------------------------------------------------------*/
+/* Make room for a record at the end of the log, and return its 
+   address. Compacting keeps one segment free, so that the live records
+   of the oldest segment always have room. */
+static int
+reserve(unsigned size, int compacting)
+{
+  int attempts;
+
+  if(size > EEPROM_KV_SEGMENT_SIZE - SEGMENT_HEADER_SIZE) {
+    return -1;
+  }
+
+  for(attempts = 0; tail_end + size > EEPROM_KV_SEGMENT_SIZE; attempts++) {
+    if(compacting ||
+       SEGMENTS - (unsigned short)(tail_seq - head_seq + 1) > 1) {
+      open_segment();
+      break;
+    }
+    if(attempts == SEGMENTS) {
+      PRINTF("eeprom-kv: full\n");
+      return -1;
+    }
+    compact();
+  }
+
+  return SEGMENT_ADDR(tail) + tail_end;
+}
+/*---------------------------------------------------------------------------*/
+/* Apply the records of a segment to the index, and return the end of
+   its data. */
+static unsigned
+replay(int segment, unsigned short seq)
+{
+  struct record r, old;
+  char key[EEPROM_KV_KEY_SIZE];
+  unsigned short hash;
+  unsigned addr;
+  int i;
+
+  addr = SEGMENT_ADDR(segment) + SEGMENT_HEADER_SIZE;
+  while(read_record(&r, addr, seq, key)) {
+    hash = hash_key(key, r.key_len);
+    i = find(key, r.key_len, hash, &old);
+    if(r.flags & FLAG_REMOVED) {
+      if(i >= 0) {
+        key_index[i] = key_index[--keys];
+      }
+    } else {
+      if(i < 0 && keys < EEPROM_KV_KEYS) {
+        i = keys++;
+        key_index[i].hash = hash;
+      }
+      if(i >= 0) {
+        key_index[i].addr = addr;
+      }
+    }
+    addr += RECORD_SIZE(r.key_len, r.value_len);
+  }
+
+  return addr - SEGMENT_ADDR(segment);
+}
+/*---------------------------------------------------------------------------*/
+int
+eeprom_kv_init(void)
+{
+  unsigned short seq, segment_seq, first, newest_first;
+  int i, found;
+
+  keys = 0;
+#if EEPROM_KV_PAGE_SIZE > 0
+  buffer_start = buffer_end = 0;
+#endif
+
+  /* The newest segment holds the sequence number of the oldest one. */
+  found = 0;
+  newest_first = 0;
+  for(i = 0; i < SEGMENTS; i++) {
+    if(read_segment_header(i, &seq, &first) &&
+       (!found || (short)(seq - tail_seq) > 0)) {
+      found = 1;
+      tail = i;
+      tail_seq = seq;
+      newest_first = first;
+    }
+  }
+  if(!found || (unsigned short)(tail_seq - newest_first) >= SEGMENTS) {
+    eeprom_kv_format();
+    return -1;
+  }
+
+  head_seq = newest_first;
+  head = (tail + SEGMENTS - (unsigned short)(tail_seq - head_seq)) % SEGMENTS;
+
+  for(i = head, seq = head_seq;; i = NEXT_SEGMENT(i), seq++) {
+    if(!read_segment_header(i, &segment_seq, &first) || segment_seq != seq) {
+      /* The log is broken; start it after this segment. */
+      keys = 0;
+      head = NEXT_SEGMENT(i);
+      head_seq = seq + 1;
+      continue;
+    }
+    tail_end = replay(i, seq);
+    if(i == tail) {
+      break;
+    }
+  }
+
+  PRINTF("eeprom-kv: %d keys in segments %d to %d\n", keys, head, tail);
+  return keys;
+}
+/*---------------------------------------------------------------------------*/
+int
+eeprom_kv_get(const char *key, void *buf, int size)
+{
+  struct record r;
+  int key_len;
+
+  key_len = strlen(key);
+  if(find(key, key_len, hash_key(key, key_len), &r) < 0) {
+    return -1;
+  }
+
+  if(size > r.value_len) {
+    size = r.value_len;
+  }
+  read_bytes(r.addr + RECORD_HEADER_SIZE + key_len, buf, size);
+  return r.value_len;
+}
+/*---------------------------------------------------------------------------*/
+static int
+same_value(unsigned addr, const unsigned char *value, unsigned len)
+{
+  unsigned char buf[COPY_BUFFER_SIZE];
+  unsigned n;
+
+  for(; len > 0; len -= n, addr += n, value += n) {
+    n = len < sizeof(buf) ? len : sizeof(buf);
+    read_bytes(addr, buf, n);
+    if(memcmp(buf, value, n) != 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+eeprom_kv_put(const char *key, const void *value, int len)
+{
+  unsigned char hdr[RECORD_HEADER_SIZE];
+  struct record r;
+  unsigned short hash;
+  int i, key_len, addr;
+
+  key_len = strlen(key);
+  if(key_len == 0 || key_len > EEPROM_KV_KEY_SIZE || len < 0 ||
+     RECORD_SIZE(key_len, len) > EEPROM_KV_SEGMENT_SIZE - SEGMENT_HEADER_SIZE) {
+    return -1;
+  }
+
+  hash = hash_key(key, key_len);
+  i = find(key, key_len, hash, &r);
+  if(i >= 0 && r.value_len == len &&
+     same_value(r.addr + RECORD_HEADER_SIZE + key_len, value, len)) {
+    return len;
+  }
+  if(i < 0 && keys == EEPROM_KV_KEYS) {
+    return -1;
+  }
+
+  hdr[0] = key_len;
+  hdr[1] = 0;
+  put16(&hdr[2], len);
+  addr = append(hdr, key, value, 0, 0);
+  if(addr < 0) {
+    return -1;
+  }
+
+  if(i < 0) {
+    i = keys++;
+    key_index[i].hash = hash;
+  }
+  key_index[i].addr = addr;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+int
+eeprom_kv_remove(const char *key)
+{
+  unsigned char hdr[RECORD_HEADER_SIZE];
+  struct record r;
+  int i, key_len;
+
+  key_len = strlen(key);
+  i = find(key, key_len, hash_key(key, key_len), &r);
+  if(i < 0) {
+    return -1;
+  }
+
+  hdr[0] = key_len;
+  hdr[1] = FLAG_REMOVED;
+  put16(&hdr[2], 0);
+  if(append(hdr, key, NULL, 0, 0) < 0) {
+    return -1;
+  }
+
+  key_index[i] = key_index[--keys];
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+eeprom_kv_format(void)
+{
+  unsigned char zero[2] = {0, 0};
+  int i;
+
+  keys = 0;
+#if EEPROM_KV_PAGE_SIZE > 0
+  buffer_start = buffer_end = 0;
+#endif
+
+  for(i = 0; i < SEGMENTS; i++) {
+    eeprom_write(EEPROM_KV_OFFSET + SEGMENT_ADDR(i), zero, sizeof(zero));
+  }
+
+  head = 0;
+  head_seq = 0;
+  tail = SEGMENTS - 1;
+  tail_seq = head_seq - 1;
+  open_segment();
+  eeprom_kv_flush();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *	A log-structured key/value store for EEPROM.
+ *
+ *	Values are appended to a log that rotates through the EEPROM
+ *	area in segments, so that repeated updates of the same key wear
+ *	all cells evenly. Writes are collected in a page-sized buffer,
+ *	and an index of the keys is kept in RAM.
+ *
+ * \name Functions called from application programs
+ * @{
+ */
+
+#ifndef EEPROM_KV_H
+#define EEPROM_KV_H
+
+/**
+ * \brief Build the index from the contents of the EEPROM.
+ * \return The number of keys found, or -1 if the store was empty 
+ *         and has been formatted.
+ *
+ * This function must be called before any other function of the
+ * store. It reads the log once, in order.
+ */
+int eeprom_kv_init(void);
+
+/**
+ * \brief Read the value of a key.
+ * \param key The key, a string of at most EEPROM_KV_KEY_SIZE characters.
+ * \param buf The buffer that the value is copied to.
+ * \param size The size of the buffer.
+ * \return The length of the value, or -1 if the key does not exist.
+ *
+ * If the value is longer than the buffer, only the first size bytes
+ * are copied.
+ */
+int eeprom_kv_get(const char *key, void *buf, int size);
+
+/**
+ * \brief Set the value of a key.
+ * \param key The key, a string of at most EEPROM_KV_KEY_SIZE characters.
+ * \param value The value.
+ * \param len The length of the value.
+ * \return len on success, -1 on failure.
+ *
+ * Nothing is written if the key already has the same value. The last
+ * partly written page stays in RAM until eeprom_kv_flush() is called
+ * or the log moves past it.
+ */
+int eeprom_kv_put(const char *key, const void *value, int len);
+
+/**
+ * \brief Remove a key.
+ * \param key The key.
+ * \return 0 on success, -1 if the key does not exist.
+ */
+int eeprom_kv_remove(const char *key);
+
+/**
+ * \brief Write any buffered data to the EEPROM.
+ */
+void eeprom_kv_flush(void);
+
+/**
+ * \brief Remove all keys.
+ */
+void eeprom_kv_format(void);
+
+/** @} */
+
+#endif /* !EEPROM_KV_H */
@@ -50,6 +50,7 @@
 #define ELF32_R_TYPE(info)      ((unsigned char)(info))
 
 static char datamemory[ELFLOADER_DATAMEMORY_SIZE];
+static char *textmemory;
 
 /*---------------------------------------------------------------------------*/
 void *
@@ -61,9 +62,16 @@ elfloader_arch_allocate_ram(int size)
 void *
 elfloader_arch_allocate_rom(int size)
 {
-  int fd = open("/dev/zero", O_RDWR);
-  char *mem = mmap(0, ELFLOADER_TEXTMEMORY_SIZE, PROT_WRITE | PROT_EXEC, MAP_PRIVATE, fd, 0);
-  return mem;
+  /* The text memory is mapped once and reused by later loads. */
+  if(textmemory == NULL) {
+    textmemory = mmap(0, ELFLOADER_TEXTMEMORY_SIZE,
+                      PROT_READ | PROT_WRITE | PROT_EXEC,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(textmemory == MAP_FAILED) {
+      textmemory = NULL;
+    }
+  }
+  return textmemory;
 }
 /*---------------------------------------------------------------------------*/
 void
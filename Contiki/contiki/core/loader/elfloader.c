@@ -38,6 +38,8 @@
 
 #include "cfs/cfs.h"
 #include "loader/symtab.h"
+#include "loader/symbols.h"
+#include "lib/crc16.h"
 
 #include <stddef.h>
 #include <string.h>
@@ -51,6 +53,36 @@
 #define PRINTF(...) do {} while (0)
 #endif
 
+/* The number of resolved symbol addresses that are kept during a
+   load, so that a symbol that many relocations refer to is only read
+   and looked up once. Zero disables the cache. */
+#ifdef ELFLOADER_CONF_SYMBOL_CACHE_SIZE
+#define SYMBOL_CACHE_SIZE ELFLOADER_CONF_SYMBOL_CACHE_SIZE
+#else
+#define SYMBOL_CACHE_SIZE 32
+#endif
+
+/* The size in bytes of the buffer that relocation entries and symbols
+   are read into in blocks. It holds at least one symbol. */
+#ifdef ELFLOADER_CONF_READ_BUFFER_SIZE
+#define READ_BUFFER_SIZE ELFLOADER_CONF_READ_BUFFER_SIZE
+#else
+#define READ_BUFFER_SIZE 96
+#endif
+
+#if READ_BUFFER_SIZE < 16
+#error "The ELF loader read buffer must be at least 16 bytes."
+#endif
+
+/* Use the symbol indexes of a .prelink section, which the
+   elfloader-prelink tool adds for a particular core, instead of
+   looking up symbols by name. */
+#ifdef ELFLOADER_CONF_PRELINK
+#define PRELINK ELFLOADER_CONF_PRELINK
+#else
+#define PRELINK 1
+#endif
+
 #define EI_NIDENT 16
 
 
@@ -126,6 +158,8 @@ struct elf32_sym {
 #define ELF32_R_SYM(info)       ((info) >> 8)
 #define ELF32_R_TYPE(info)      ((unsigned char)(info))
 
+#define SHN_UNDEF       0
+
 struct relevant_section {
   unsigned char number;
   unsigned int offset;
@@ -138,6 +172,30 @@ struct process * const * elfloader_autostart_processes;
 
 static struct relevant_section bss, data, rodata, text;
 
+#if SYMBOL_CACHE_SIZE > 0
+static struct {
+  unsigned short symbol;
+  char *address;
+} symbol_cache[SYMBOL_CACHE_SIZE];
+#endif /* SYMBOL_CACHE_SIZE > 0 */
+
+static union {
+  struct elf32_rela relas[READ_BUFFER_SIZE / sizeof(struct elf32_rela)];
+  struct elf32_sym syms[READ_BUFFER_SIZE / sizeof(struct elf32_sym)];
+  char bytes[READ_BUFFER_SIZE];
+} read_buffer;
+
+#if PRELINK
+/* The .prelink section starts with a magic number, the number of
+   entries of the symbols[] array of the core and a CRC of their names,
+   followed by the little-endian index into symbols[] of each symbol
+   in the symbol table, or 0xffff. */
+#define PRELINK_HEADER_SIZE 8
+static const unsigned char prelink_magic[] = {'P', 'L', 'N', 'K'};
+static unsigned int prelink;
+static unsigned short symbols_crc;
+#endif /* PRELINK */
+
 static const unsigned char elf_magic_header[] =
   {0x7f, 0x45, 0x4c, 0x46,  /* 0x7f, 'E', 'L', 'F' */
    0x01,                    /* Only 32-bit objects. */
@@ -173,56 +231,182 @@ seek_write(int fd, unsigned int offset, char *buf, int len)
 }
 */
 /*---------------------------------------------------------------------------*/
+static struct relevant_section *
+find_section(unsigned int number)
+{
+  if(number == SHN_UNDEF) {
+    return NULL;
+  } else if(number == bss.number) {
+    return &bss;
+  } else if(number == data.number) {
+    return &data;
+  } else if(number == rodata.number) {
+    return &rodata;
+  } else if(number == text.number) {
+    return &text;
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
 static void *
 find_local_symbol(int fd, const char *symbol,
 		  unsigned int symtab, unsigned short symtabsize,
 		  unsigned int strtab)
 {
-  struct elf32_sym s;
+  struct elf32_sym *s;
   unsigned int a;
+  int i, n, len;
   char name[30];
   struct relevant_section *sect;
-  
-  for(a = symtab; a < symtab + symtabsize; a += sizeof(s)) {
-    seek_read(fd, a, (char *)&s, sizeof(s));
 
-    if(s.st_name != 0) {
-      seek_read(fd, strtab + s.st_name, name, sizeof(name));
-      if(strcmp(name, symbol) == 0) {
-	if(s.st_shndx == bss.number) {
-	  sect = &bss;
-	} else if(s.st_shndx == data.number) {
-	  sect = &data;
-	} else if(s.st_shndx == text.number) {
-	  sect = &text;
-	} else {
-	  return NULL;
+  /* Only the names of the symbols that the module defines are read,
+     and no more of them than what is needed for the comparison. */
+  len = strlen(symbol) + 1;
+  if(len > sizeof(name)) {
+    return NULL;
+  }
+  for(a = symtab; a < symtab + symtabsize; a += n * sizeof(*s)) {
+    n = (symtab + symtabsize - a) / sizeof(*s);
+    if(n > sizeof(read_buffer.syms) / sizeof(*s)) {
+      n = sizeof(read_buffer.syms) / sizeof(*s);
+    } else if(n == 0) {
+      break;
+    }
+    seek_read(fd, a, read_buffer.bytes, n * sizeof(*s));
+
+    for(i = 0; i < n; i++) {
+      s = &read_buffer.syms[i];
+      sect = find_section(s->st_shndx);
+      if(s->st_name != 0 && sect != NULL) {
+	seek_read(fd, strtab + s->st_name, name, len);
+	if(memcmp(name, symbol, len) == 0) {
+	  return &(sect->address[s->st_value]);
 	}
-	return &(sect->address[s.st_value]);
       }
     }
   }
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if PRELINK
+static unsigned short
+names_crc(void)
+{
+  unsigned short crc;
+  int i;
+
+  crc = 0;
+  for(i = 0; i < symbols_nelts - 1; i++) {
+    crc = crc16_data((const unsigned char *)symbols[i].name,
+		     strlen(symbols[i].name) + 1, crc);
+  }
+  return crc;
+}
+/*---------------------------------------------------------------------------*/
+/* Use a .prelink section only if it was made for this core. */
+static unsigned int
+check_prelink(int fd, unsigned int offset, unsigned int size,
+	      unsigned short symtabsize)
+{
+  unsigned char header[PRELINK_HEADER_SIZE];
+
+  if(size < PRELINK_HEADER_SIZE +
+     2 * (symtabsize / sizeof(struct elf32_sym))) {
+    return 0;
+  }
+  seek_read(fd, offset, (char *)header, sizeof(header));
+  if(memcmp(header, prelink_magic, sizeof(prelink_magic)) != 0 ||
+     (header[4] | header[5] << 8) != symbols_nelts) {
+    return 0;
+  }
+  if(symbols_crc == 0) {
+    symbols_crc = names_crc();
+  }
+  if((header[6] | header[7] << 8) != symbols_crc) {
+    PRINTF("elfloader: .prelink is for another core\n");
+    return 0;
+  }
+  return offset + PRELINK_HEADER_SIZE;
+}
+#endif /* PRELINK */
+/*---------------------------------------------------------------------------*/
+static int
+resolve_symbol(int fd, unsigned int symbol,
+	       unsigned int strtab, unsigned int symtab, char **addr)
+{
+  struct elf32_sym s;
+  char name[30];
+  struct relevant_section *sect;
+#if PRELINK
+  unsigned char index[2];
+  unsigned int i;
+#endif /* PRELINK */
+
+#if SYMBOL_CACHE_SIZE > 0
+  if(symbol != 0 &&
+     symbol_cache[symbol % SYMBOL_CACHE_SIZE].symbol == symbol) {
+    *addr = symbol_cache[symbol % SYMBOL_CACHE_SIZE].address;
+    return ELFLOADER_OK;
+  }
+#endif /* SYMBOL_CACHE_SIZE > 0 */
+
+  seek_read(fd, symtab + sizeof(struct elf32_sym) * symbol,
+	    (char *)&s, sizeof(s));
+
+  /* Symbols that the module defines, including the section symbols,
+     are resolved without looking at their names. */
+  sect = find_section(s.st_shndx);
+  if(sect != NULL) {
+    *addr = &sect->address[s.st_value];
+  } else if(s.st_name == 0) {
+    return ELFLOADER_SEGMENT_NOT_FOUND;
+  } else {
+    *addr = NULL;
+#if PRELINK
+    if(prelink != 0) {
+      seek_read(fd, prelink + 2 * symbol, (char *)index, sizeof(index));
+      i = index[0] | index[1] << 8;
+      if(i < symbols_nelts - 1) {
+	*addr = symbols[i].value;
+      }
+    }
+    if(*addr == NULL)
+#endif /* PRELINK */
+    {
+      seek_read(fd, strtab + s.st_name, name, sizeof(name));
+      PRINTF("name: %s\n", name);
+      *addr = (char *)symtab_lookup(name);
+      if(*addr == NULL) {
+	PRINTF("elfloader unknown name: '%30s'\n", name);
+	memcpy(elfloader_unknown, name, sizeof(elfloader_unknown));
+	elfloader_unknown[sizeof(elfloader_unknown) - 1] = 0;
+	return ELFLOADER_SYMBOL_NOT_FOUND;
+      }
+    }
+  }
+
+#if SYMBOL_CACHE_SIZE > 0
+  symbol_cache[symbol % SYMBOL_CACHE_SIZE].symbol = symbol;
+  symbol_cache[symbol % SYMBOL_CACHE_SIZE].address = *addr;
+#endif /* SYMBOL_CACHE_SIZE > 0 */
+  return ELFLOADER_OK;
+}
+/*---------------------------------------------------------------------------*/
 static int
 relocate_section(int fd,
 		 unsigned int section, unsigned short size,
 		 unsigned int sectionaddr,
 		 char *sectionbase,
-		 unsigned int strs,
 		 unsigned int strtab,
-		 unsigned int symtab, unsigned short symtabsize,
+		 unsigned int symtab,
 		 unsigned char using_relas)
 {
   /* sectionbase added; runtime start address of current section */
   struct elf32_rela rela; /* Now used both for rel and rela data! */
   int rel_size = 0;
-  struct elf32_sym s;
   unsigned int a;
-  char name[30];
+  int i, n, ret;
   char *addr;
-  struct relevant_section *sect;
 
   /* determine correct relocation entry sizes */
   if(using_relas) {
@@ -230,61 +414,32 @@ relocate_section(int fd,
   } else {
     rel_size = sizeof(struct elf32_rel);
   }
-  
-  for(a = section; a < section + size; a += rel_size) {
-    seek_read(fd, a, (char *)&rela, rel_size);
-    seek_read(fd,
-	      symtab + sizeof(struct elf32_sym) * ELF32_R_SYM(rela.r_info),
-	      (char *)&s, sizeof(s));
-    if(s.st_name != 0) {
-      seek_read(fd, strtab + s.st_name, name, sizeof(name));
-      PRINTF("name: %s\n", name);
-      addr = (char *)symtab_lookup(name);
-      /* ADDED */
-      if(addr == NULL) {
-	PRINTF("name not found in global: %s\n", name);
-	addr = find_local_symbol(fd, name, symtab, symtabsize, strtab);
-	PRINTF("found address %p\n", addr);
-      }
-      if(addr == NULL) {
-	if(s.st_shndx == bss.number) {
-	  sect = &bss;
-	} else if(s.st_shndx == data.number) {
-	  sect = &data;
-	} else if(s.st_shndx == rodata.number) {
-	  sect = &rodata;
-	} else if(s.st_shndx == text.number) {
-	  sect = &text;
-	} else {
-	  PRINTF("elfloader unknown name: '%30s'\n", name);
-	  memcpy(elfloader_unknown, name, sizeof(elfloader_unknown));
-	  elfloader_unknown[sizeof(elfloader_unknown) - 1] = 0;
-	  return ELFLOADER_SYMBOL_NOT_FOUND;
-	}
-	addr = sect->address;
+
+  /* The relocation entries are read in blocks. */
+  for(a = section; a < section + size; a += n * rel_size) {
+    n = (section + size - a) / rel_size;
+    if(n > sizeof(read_buffer) / rel_size) {
+      n = sizeof(read_buffer) / rel_size;
+    } else if(n == 0) {
+      break;
+    }
+    seek_read(fd, a, read_buffer.bytes, n * rel_size);
+
+    for(i = 0; i < n; i++) {
+      memcpy(&rela, &read_buffer.bytes[i * rel_size], rel_size);
+      ret = resolve_symbol(fd, ELF32_R_SYM(rela.r_info), strtab, symtab,
+			   &addr);
+      if(ret != ELFLOADER_OK) {
+	return ret;
       }
-    } else {
-      if(s.st_shndx == bss.number) {
-	sect = &bss;
-      } else if(s.st_shndx == data.number) {
-	sect = &data;
-      } else if(s.st_shndx == rodata.number) {
-	sect = &rodata;
-      } else if(s.st_shndx == text.number) {
-	sect = &text;
-      } else {
-	return ELFLOADER_SEGMENT_NOT_FOUND;
+
+      if(!using_relas) {
+	/* copy addend to rela structure */
+	seek_read(fd, sectionaddr + rela.r_offset, (char *)&rela.r_addend, 4);
       }
-      
-      addr = sect->address;
-    }
 
-    if(!using_relas) {
-      /* copy addend to rela structure */
-      seek_read(fd, sectionaddr + rela.r_offset, (char *)&rela.r_addend, 4);
+      elfloader_arch_relocate(fd, sectionaddr, sectionbase, &rela, addr);
     }
-
-    elfloader_arch_relocate(fd, sectionaddr, sectionbase, &rela, addr);
   }
   return ELFLOADER_OK;
 }
@@ -355,11 +510,18 @@ elfloader_load(int fd)
   unsigned short symtaboff = 0, symtabsize;
   unsigned short strtaboff = 0, strtabsize;
   unsigned short bsssize = 0;
+  unsigned int symtablink = 0;
+#if PRELINK
+  unsigned int prelinkoff = 0, prelinksize = 0;
+#endif /* PRELINK */
 
   struct process **process;
   int ret;
 
   elfloader_unknown[0] = 0;
+#if SYMBOL_CACHE_SIZE > 0
+  memset(symbol_cache, 0, sizeof(symbol_cache));
+#endif /* SYMBOL_CACHE_SIZE > 0 */
 
   /* The ELF header is located at the start of the buffer. */
   seek_read(fd, 0, (char *)&ehdr, sizeof(ehdr));
@@ -437,10 +599,17 @@ elfloader_load(int fd)
       PRINTF("symtab\n");
       symtaboff = shdr.sh_offset;
       symtabsize = shdr.sh_size;
+      symtablink = shdr.sh_link;
     } else if(shdr.sh_type == SHT_STRTAB/*strncmp(name, ".strtab", 7) == 0*/) {
+      /* The string table of the symbols is found through the link of
+	 the symbol table below, since the section names are in a
+	 string table too. */
       PRINTF("strtab\n");
-      strtaboff = shdr.sh_offset;
-      strtabsize = shdr.sh_size;
+#if PRELINK
+    } else if(strncmp(name, ".prelink", 8) == 0) {
+      prelinkoff = shdr.sh_offset;
+      prelinksize = shdr.sh_size;
+#endif /* PRELINK */
     } else if(strncmp(name, ".text", 5) == 0) {
       textoff = shdr.sh_offset;
       textsize = shdr.sh_size;
@@ -496,6 +665,12 @@ elfloader_load(int fd)
   if(symtabsize == 0) {
     return ELFLOADER_NO_SYMTAB;
   }
+  seek_read(fd, ehdr.e_shoff + shdrsize * symtablink,
+	    (char *)&shdr, sizeof(shdr));
+  if(shdr.sh_type == SHT_STRTAB) {
+    strtaboff = shdr.sh_offset;
+    strtabsize = shdr.sh_size;
+  }
   if(strtabsize == 0) {
     return ELFLOADER_NO_STRTAB;
   }
@@ -516,6 +691,12 @@ elfloader_load(int fd)
   PRINTF("text base address: text.address = 0x%08x\n", text.address);
   PRINTF("rodata base address: rodata.address = 0x%08x\n", rodata.address);
 
+#if PRELINK
+  prelink = 0;
+  if(prelinksize > 0) {
+    prelink = check_prelink(fd, prelinkoff, prelinksize, symtabsize);
+  }
+#endif /* PRELINK */
 
   /* If we have text segment relocations, we process them. */
   PRINTF("elfloader: relocate text\n");
@@ -524,9 +705,8 @@ elfloader_load(int fd)
 			   textrelaoff, textrelasize,
 			   textoff,
 			   text.address,
-			   strs,
 			   strtaboff,
-			   symtaboff, symtabsize, using_relas);
+			   symtaboff, using_relas);
     if(ret != ELFLOADER_OK) {
       return ret;
     }
@@ -539,9 +719,8 @@ elfloader_load(int fd)
 			   rodatarelaoff, rodatarelasize,
 			   rodataoff,
 			   rodata.address,
-			   strs,
 			   strtaboff,
-			   symtaboff, symtabsize, using_relas);
+			   symtaboff, using_relas);
     if(ret != ELFLOADER_OK) {
       PRINTF("elfloader: data failed\n");
       return ret;
@@ -555,9 +734,8 @@ elfloader_load(int fd)
 			   datarelaoff, datarelasize,
 			   dataoff,
 			   data.address,
-			   strs,
 			   strtaboff,
-			   symtaboff, symtabsize, using_relas);
+			   symtaboff, using_relas);
     if(ret != ELFLOADER_OK) {
       PRINTF("elfloader: data failed\n");
       return ret;
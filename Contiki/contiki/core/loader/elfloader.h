@@ -75,6 +75,8 @@
 #ifndef __ELFLOADER_H__
 #define __ELFLOADER_H__
 
+#include <stdint.h>
+
 #include "cfs/cfs.h"
 
 /**
@@ -175,11 +177,12 @@ extern char elfloader_unknown[30];
 #endif
 #endif /* ELFLOADER_TEXTMEMORY_SIZE */
 
-typedef unsigned long  elf32_word;
-typedef   signed long  elf32_sword;
-typedef unsigned short elf32_half;
-typedef unsigned long  elf32_off;
-typedef unsigned long  elf32_addr;
+/* The ELF types have fixed sizes, also on hosts with 64-bit longs. */
+typedef uint32_t elf32_word;
+typedef int32_t  elf32_sword;
+typedef uint16_t elf32_half;
+typedef uint32_t elf32_off;
+typedef uint32_t elf32_addr;
 
 struct elf32_rela {
   elf32_addr      r_offset;       /* Location to be relocated. */
@@ -77,6 +77,24 @@
 #error Change CSMA_CONF_MAX_MAC_TRANSMISSIONS in contiki-conf.h or in your Makefile.
 #endif /* CSMA_CONF_MAX_MAC_TRANSMISSIONS < 1 */
 
+/* When several packets are queued for the same neighbor, they are
+   handed to the RDC layer as a packet train, which sends them
+   back-to-back with the frame pending bit set so that the receiver
+   stays awake for the whole train. CSMA_BURST_MAX limits the length
+   of a train so that bulk traffic to one neighbor does not starve
+   traffic to others. A value of one disables packet trains. */
+#ifdef CSMA_CONF_BURST_MAX
+#define CSMA_BURST_MAX CSMA_CONF_BURST_MAX
+#else
+#define CSMA_BURST_MAX 4
+#endif /* CSMA_CONF_BURST_MAX */
+
+#if CSMA_BURST_MAX < 1
+#error CSMA_CONF_BURST_MAX must be at least 1.
+#endif /* CSMA_BURST_MAX < 1 */
+
+struct csma_stats csma_stats;
+
 /* Packet metadata */
 struct qbuf_metadata {
   mac_callback_t sent;
@@ -92,6 +110,8 @@ struct neighbor_queue {
   uint8_t transmissions;
   uint8_t collisions, deferrals;
   LIST_STRUCT(queued_packet_list);
+  /* The packet train that currently is handed to the RDC layer. */
+  struct rdc_buf_list burst[CSMA_BURST_MAX];
 };
 
 /* The maximum number of co-existing neighbor queues */
@@ -140,6 +160,38 @@ default_timebase(void)
   return time;
 }
 /*---------------------------------------------------------------------------*/
+/**
+ * Build a packet train of at most CSMA_BURST_MAX packets from the
+ * head of the neighbor's queue. The train is a separate list that
+ * shares the queuebufs of the queue, so that the RDC layer stops at
+ * the end of the train while packet_sent() keeps working on the
+ * head of the queue.
+ */
+static struct rdc_buf_list *
+prepare_burst(struct neighbor_queue *n, struct rdc_buf_list *q)
+{
+  int i;
+
+  for(i = 0; q != NULL && i < CSMA_BURST_MAX; i++) {
+    n->burst[i].buf = q->buf;
+    n->burst[i].ptr = q->ptr;
+    n->burst[i].next = NULL;
+    if(i > 0) {
+      n->burst[i - 1].next = &n->burst[i];
+    }
+    q = list_item_next(q);
+  }
+
+  if(i > 1) {
+    csma_stats.bursts++;
+    csma_stats.burst_packets += i;
+  }
+  if(i > csma_stats.max_burst) {
+    csma_stats.max_burst = i;
+  }
+  return &n->burst[0];
+}
+/*---------------------------------------------------------------------------*/
 static void
 transmit_packet_list(void *ptr)
 {
@@ -149,6 +201,8 @@ transmit_packet_list(void *ptr)
     if(q != NULL) {
       PRINTF("csma: preparing number %d %p, queue len %d\n", n->transmissions, q,
           list_length(n->queued_packet_list));
+      csma_stats.wakeups++;
+      q = prepare_burst(n, q);
       /* Send packets in the neighbor's list */
       NETSTACK_RDC.send_list(packet_sent, n, q);
     }
@@ -263,6 +317,7 @@ packet_sent(void *ptr, int status, int num_transmissions)
   } else {
     if(status == MAC_TX_OK) {
       PRINTF("csma: rexmit ok %d\n", n->transmissions);
+      csma_stats.packets++;
     } else {
       PRINTF("csma: rexmit failed %d: %d\n", n->transmissions, status);
     }
@@ -47,6 +47,18 @@
 
 extern const struct mac_driver csma_driver;
 
+/* Packet train statistics. The ratio of wakeups to packets tells how
+   many times the receiver had to be woken up per delivered packet. */
+struct csma_stats {
+  unsigned long wakeups;       /* Neighbor queues handed to the RDC layer. */
+  unsigned long packets;       /* Unicast packets successfully sent. */
+  unsigned long bursts;        /* Packet trains of more than one packet. */
+  unsigned long burst_packets; /* Packets handed to the RDC layer in trains. */
+  unsigned char max_burst;     /* Longest packet train. */
+};
+
+extern struct csma_stats csma_stats;
+
 const struct mac_driver *csma_init(const struct mac_driver *r);
 
 #endif /* __CSMA_H__ */
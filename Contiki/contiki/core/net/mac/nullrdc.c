@@ -42,6 +42,7 @@
 #include "net/mac/nullrdc.h"
 #include "net/packetbuf.h"
 #include "net/queuebuf.h"
+#include "lib/list.h"
 #include "net/netstack.h"
 #include <string.h>
 
@@ -100,8 +101,8 @@ static struct seqno received_seqnos[MAX_SEQNOS];
 #endif /* NULLRDC_802154_AUTOACK || NULLRDC_802154_AUTOACK_HW */
 
 /*---------------------------------------------------------------------------*/
-static void
-send_packet(mac_callback_t sent, void *ptr)
+static int
+send_one_packet(mac_callback_t sent, void *ptr)
 {
   int ret;
   packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &rimeaddr_node_addr);
@@ -200,14 +201,32 @@ send_packet(mac_callback_t sent, void *ptr)
 #endif /* ! NULLRDC_802154_AUTOACK */
   }
   mac_call_sent_callback(sent, ptr, ret, 1);
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  send_one_packet(sent, ptr);
 }
 /*---------------------------------------------------------------------------*/
 static void
 send_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
 {
-  if(buf_list != NULL) {
+  struct rdc_buf_list *next;
+
+  /* Send the packets in the list back-to-back, with the frame pending
+     bit set on all but the last one, until one of them fails. */
+  while(buf_list != NULL) {
+    next = list_item_next(buf_list);
     queuebuf_to_packetbuf(buf_list->buf);
-    send_packet(sent, ptr);
+    if(next != NULL) {
+      packetbuf_set_attr(PACKETBUF_ATTR_PENDING, 1);
+    }
+    if(send_one_packet(sent, ptr) != MAC_TX_OK) {
+      break;
+    }
+    buf_list = next;
   }
 }
 /*---------------------------------------------------------------------------*/
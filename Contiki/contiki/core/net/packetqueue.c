@@ -123,6 +123,14 @@ packetqueue_dequeue(struct packetqueue *q)
   }
 }
 /*---------------------------------------------------------------------------*/
+void
+packetqueue_remove(struct packetqueue *q, struct packetqueue_item *i)
+{
+  if(i != NULL && i->queue == q) {
+    remove_queued_packet(i);
+  }
+}
+/*---------------------------------------------------------------------------*/
 int
 packetqueue_len(struct packetqueue *q)
 {
@@ -179,6 +179,20 @@ struct packetqueue_item *packetqueue_first(struct packetqueue *q);
  */
 void packetqueue_dequeue(struct packetqueue *q);
 
+/**
+ * \brief      Remove an arbitrary item from the packet queue.
+ * \param q    A pointer to a struct packetqueue.
+ * \param i    A pointer to an item on the packet queue.
+ *
+ *             This function removes the item pointed to by i from
+ *             the packet queue, regardless of its position in the
+ *             queue. It is used by modules that keep more than one
+ *             packet outstanding and may have them acknowledged out
+ *             of order.
+ *
+ */
+void packetqueue_remove(struct packetqueue *q, struct packetqueue_item *i);
+
 /**
  * \brief      Get the length of the packet queue
  * \param q    A pointer to a struct packetqueue.
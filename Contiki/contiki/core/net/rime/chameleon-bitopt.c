@@ -53,6 +53,30 @@
 #define CHAMELEON_WITH_MAC_LINK_ADDRESSES 0
 #endif /* !CHAMELEON_CONF_WITH_MAC_LINK_ADDRESSES */
 
+/* Attribute lists are compiled into header layouts when a channel's
+   attributes are set. A layout holds the byte offset, bit position
+   and packing method of each attribute, so that packing and
+   unpacking a header does not compute them for every packet, and
+   byte-aligned attributes are copied as whole bytes.
+   CHAMELEON_BITOPT_LAYOUTS is the number of attribute lists that can
+   have a layout at the same time, and CHAMELEON_BITOPT_LAYOUT_FIELDS
+   the maximum number of attributes in a layout. The layout of an
+   attribute list that no open channel uses any more is reused for
+   the next list. Channels without a layout use the generic bit
+   packer. Setting CHAMELEON_CONF_BITOPT_LAYOUTS to zero
+   disables layouts. */
+#ifdef CHAMELEON_CONF_BITOPT_LAYOUTS
+#define CHAMELEON_BITOPT_LAYOUTS CHAMELEON_CONF_BITOPT_LAYOUTS
+#else /* CHAMELEON_CONF_BITOPT_LAYOUTS */
+#define CHAMELEON_BITOPT_LAYOUTS 4
+#endif /* CHAMELEON_CONF_BITOPT_LAYOUTS */
+
+#ifdef CHAMELEON_CONF_BITOPT_LAYOUT_FIELDS
+#define CHAMELEON_BITOPT_LAYOUT_FIELDS CHAMELEON_CONF_BITOPT_LAYOUT_FIELDS
+#else /* CHAMELEON_CONF_BITOPT_LAYOUT_FIELDS */
+#define CHAMELEON_BITOPT_LAYOUT_FIELDS 10
+#endif /* CHAMELEON_CONF_BITOPT_LAYOUT_FIELDS */
+
 struct bitopt_hdr {
   uint8_t channel[2];
 };
@@ -192,6 +216,203 @@ set_bits(uint8_t *ptr, int bitpos, uint8_t *val, int vallen)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if CHAMELEON_BITOPT_LAYOUTS > 0
+enum {
+  FIELD_BYTES,            /* Whole bytes on a byte boundary */
+  FIELD_UNALIGNED_BYTES,  /* Whole bytes not on a byte boundary */
+  FIELD_BITS,             /* Less than a byte */
+  FIELD_GENERIC,          /* Anything else, handled by set_bits() */
+};
+
+struct layout_field {
+  uint8_t type;
+  uint8_t len;
+  uint8_t byte;
+  uint8_t bitpos;
+  uint8_t kind;
+};
+
+struct layout {
+  const struct packetbuf_attrlist *attrlist;
+  uint8_t nfields;
+  struct layout_field fields[CHAMELEON_BITOPT_LAYOUT_FIELDS];
+};
+
+static struct layout layouts[CHAMELEON_BITOPT_LAYOUTS];
+/*---------------------------------------------------------------------------*/
+static struct layout *
+find_layout(const struct packetbuf_attrlist *attrlist)
+{
+  int i;
+
+  for(i = 0; i < CHAMELEON_BITOPT_LAYOUTS; ++i) {
+    if(layouts[i].attrlist == attrlist) {
+      return &layouts[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static struct layout *
+unused_layout(void)
+{
+  int i;
+
+  for(i = 0; i < CHAMELEON_BITOPT_LAYOUTS; ++i) {
+    if(layouts[i].attrlist == NULL ||
+       channel_lookup_attributes(layouts[i].attrlist) == NULL) {
+      return &layouts[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+compile_layout(const struct packetbuf_attrlist *attrlist)
+{
+  const struct packetbuf_attrlist *a;
+  struct layout *l;
+  struct layout_field *f;
+  int bitptr;
+
+  /* Recompile the layout if the attribute list already has one, as
+     the list may have changed since. */
+  l = find_layout(attrlist);
+  if(l == NULL) {
+    l = unused_layout();
+    if(l == NULL) {
+      PRINTF("chameleon-bitopt: no free layout\n");
+      return 0;
+    }
+  }
+
+  l->nfields = 0;
+  bitptr = 0;
+  for(a = attrlist; a->type != PACKETBUF_ATTR_NONE; ++a) {
+#if CHAMELEON_WITH_MAC_LINK_ADDRESSES
+    if(a->type == PACKETBUF_ADDR_SENDER ||
+       a->type == PACKETBUF_ADDR_RECEIVER) {
+      /* Let the link layer handle sender and receiver */
+      continue;
+    }
+#endif /* CHAMELEON_WITH_MAC_LINK_ADDRESSES */
+    if(l->nfields == CHAMELEON_BITOPT_LAYOUT_FIELDS) {
+      PRINTF("chameleon-bitopt: too many attributes for a layout\n");
+      l->attrlist = NULL;
+      return 0;
+    }
+    f = &l->fields[l->nfields++];
+    f->type = a->type;
+    f->len = a->len;
+    f->byte = bitptr / 8;
+    f->bitpos = bitptr & 7;
+    if(a->len < 8) {
+      f->kind = FIELD_BITS;
+    } else if((a->len & 7) != 0) {
+      f->kind = FIELD_GENERIC;
+    } else if(f->bitpos == 0) {
+      f->kind = FIELD_BYTES;
+    } else {
+      f->kind = FIELD_UNALIGNED_BYTES;
+    }
+    bitptr += a->len;
+  }
+  l->attrlist = attrlist;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+pack_layout(const struct layout *l, uint8_t *hdrptr)
+{
+  const struct layout_field *f;
+  packetbuf_attr_t val;
+  uint8_t *from, *to;
+  uint16_t shifted_val;
+  int i;
+
+  for(f = l->fields; f < &l->fields[l->nfields]; ++f) {
+    if(PACKETBUF_IS_ADDR(f->type)) {
+      from = (uint8_t *)packetbuf_addr(f->type);
+    } else {
+      val = packetbuf_attr(f->type);
+      from = (uint8_t *)&val;
+    }
+    to = &hdrptr[f->byte];
+    switch(f->kind) {
+    case FIELD_BYTES:
+      memcpy(to, from, f->len / 8);
+      break;
+    case FIELD_UNALIGNED_BYTES:
+      for(i = 0; i < f->len / 8; ++i) {
+        shifted_val = from[i] << (8 - f->bitpos);
+        to[i] |= shifted_val >> 8;
+        to[i + 1] |= shifted_val & 0xff;
+      }
+      break;
+    case FIELD_BITS:
+      shifted_val = (from[0] & (bitmask[f->len] >> (8 - f->len))) <<
+        (16 - f->bitpos - f->len);
+      to[0] |= shifted_val >> 8;
+      if(f->bitpos + f->len > 8) {
+        to[1] |= shifted_val & 0xff;
+      }
+      break;
+    default:
+      set_bits(to, f->bitpos, from, f->len);
+      break;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+unpack_layout(const struct layout *l, uint8_t *hdrptr)
+{
+  const struct layout_field *f;
+  packetbuf_attr_t val;
+  rimeaddr_t addr;
+  uint8_t *from, *to;
+  uint16_t shifted_val;
+  int i;
+
+  for(f = l->fields; f < &l->fields[l->nfields]; ++f) {
+    if(PACKETBUF_IS_ADDR(f->type)) {
+      to = (uint8_t *)&addr;
+    } else {
+      val = 0;
+      to = (uint8_t *)&val;
+    }
+    from = &hdrptr[f->byte];
+    switch(f->kind) {
+    case FIELD_BYTES:
+      memcpy(to, from, f->len / 8);
+      break;
+    case FIELD_UNALIGNED_BYTES:
+      for(i = 0; i < f->len / 8; ++i) {
+        shifted_val = (from[i] << 8) | from[i + 1];
+        to[i] = shifted_val >> (8 - f->bitpos);
+      }
+      break;
+    case FIELD_BITS:
+      shifted_val = from[0] << 8;
+      if(f->bitpos + f->len > 8) {
+        shifted_val |= from[1];
+      }
+      to[0] = (shifted_val >> (16 - f->bitpos - f->len)) &
+        (bitmask[f->len] >> (8 - f->len));
+      break;
+    default:
+      get_bits(to, from, f->bitpos, f->len);
+      break;
+    }
+    if(PACKETBUF_IS_ADDR(f->type)) {
+      packetbuf_set_addr(f->type, &addr);
+    } else {
+      packetbuf_set_attr(f->type, val);
+    }
+  }
+}
+#endif /* CHAMELEON_BITOPT_LAYOUTS > 0 */
+/*---------------------------------------------------------------------------*/
 #if 0
 static void
 printbin(int n, int digits)
@@ -253,7 +474,17 @@ pack_header(struct channel *c)
 
   hdrptr = ((uint8_t *)packetbuf_hdrptr()) + sizeof(struct bitopt_hdr);
   memset(hdrptr, 0, hdrbytesize);
-  
+
+#if CHAMELEON_BITOPT_LAYOUTS > 0
+  {
+    struct layout *l = find_layout(c->attrlist);
+    if(l != NULL) {
+      pack_layout(l, hdrptr);
+      return 1; /* Send out packet */
+    }
+  }
+#endif /* CHAMELEON_BITOPT_LAYOUTS > 0 */
+
   byteptr = bitptr = 0;
   
   for(a = c->attrlist; a->type != PACKETBUF_ATTR_NONE; ++a) {
@@ -326,6 +557,17 @@ unpack_header(void)
     PRINTF("chameleon-bitopt: too short packet\n");
     return NULL;
   }
+
+#if CHAMELEON_BITOPT_LAYOUTS > 0
+  {
+    struct layout *l = find_layout(c->attrlist);
+    if(l != NULL) {
+      unpack_layout(l, hdrptr);
+      return c;
+    }
+  }
+#endif /* CHAMELEON_BITOPT_LAYOUTS > 0 */
+
   byteptr = bitptr = 0;
   for(a = c->attrlist; a->type != PACKETBUF_ATTR_NONE; ++a) {
 #if CHAMELEON_WITH_MAC_LINK_ADDRESSES
@@ -363,9 +605,22 @@ unpack_header(void)
   return c;
 }
 /*---------------------------------------------------------------------------*/
+static int
+attrlist_size(const struct packetbuf_attrlist *a)
+{
+#if CHAMELEON_BITOPT_LAYOUTS > 0
+  /* The attributes are set on an open channel, so it is found. */
+  if(!compile_layout(a)) {
+    PRINTF("chameleon-bitopt: channel %d uses the generic packer\n",
+           channel_lookup_attributes(a)->channelno);
+  }
+#endif /* CHAMELEON_BITOPT_LAYOUTS > 0 */
+  return header_size(a);
+}
+/*---------------------------------------------------------------------------*/
 CC_CONST_FUNCTION struct chameleon_module chameleon_bitopt = {
   unpack_header,
   pack_header,
-  header_size
+  attrlist_size
 };
 /*---------------------------------------------------------------------------*/
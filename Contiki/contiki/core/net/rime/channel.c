@@ -88,3 +88,15 @@ channel_lookup(uint16_t channelno)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+struct channel *
+channel_lookup_attributes(const struct packetbuf_attrlist attrlist[])
+{
+  struct channel *c;
+  for(c = list_head(channel_list); c != NULL; c = list_item_next(c)) {
+    if(c->attrlist == attrlist) {
+      return c;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
@@ -55,6 +55,7 @@ struct channel {
 };
 
 struct channel *channel_lookup(uint16_t channelno);
+struct channel *channel_lookup_attributes(const struct packetbuf_attrlist attrlist[]);
 
 void channel_set_attributes(uint16_t channelno,
 			    const struct packetbuf_attrlist attrlist[]);
@@ -85,12 +85,17 @@ static uint8_t recent_packet_ptr;
 /* This is the header of data packets. The header comtains the routing
    metric of the last hop sender. This is used to avoid routing loops:
    if a node receives a packet with a lower routing metric than its
-   own, it drops the packet. */
+   own, it drops the packet. The DATA_FLAGS_WINDOW flag tells the
+   receiver that the sender uses windowed forwarding and accepts
+   aggregated, selective ACKs. Packets from other senders are
+   acknowledged one by one. */
 struct data_msg_hdr {
   uint8_t flags, dummy;
   uint16_t rtmetric;
 };
 
+#define DATA_FLAGS_WINDOW               0x80
+
 
 /* This is the header of ACK packets. It contains a flags field that
    indicates if the node is congested (ACK_FLAGS_CONGESTED), if the
@@ -100,9 +105,12 @@ struct data_msg_hdr {
    (ACK_FLAGS_RTMETRIC_NEEDS_UPDATE). The flags can contain any
    combination of the flags. The ACK header also contains the routing
    metric of the node that sends tha ACK. This is used to keep an
-   up-to-date routing state in the network. */
+   up-to-date routing state in the network. When windowed forwarding
+   is used (COLLECT_WINDOW_SIZE > 1), the acked field is a selective
+   ACK bitmap: bit n set means that the packet with packet ID
+   PACKETBUF_ATTR_PACKET_ID - 1 - n was received as well. */
 struct ack_msg {
-  uint8_t flags, dummy;
+  uint8_t flags, acked;
   uint16_t rtmetric;
 };
 
@@ -189,6 +197,8 @@ struct {
   uint32_t ttldrop;
   uint32_t ackdrop;
   uint32_t timedout;
+
+  uint32_t ackaggr;
 } stats;
 
 /* Debug definition: draw routing tree in Cooja. */
@@ -203,9 +213,17 @@ struct {
 
 /* Forward declarations. */
 static void send_queued_packet(struct collect_conn *c);
+#if COLLECT_ANNOUNCEMENTS && COLLECT_CONF_WITH_LISTEN
+static void send_queued_packet_callback(void *ptr);
+#endif /* COLLECT_ANNOUNCEMENTS && COLLECT_CONF_WITH_LISTEN */
 static void retransmit_callback(void *ptr);
 static void retransmit_not_sent_callback(void *ptr);
 static void set_keepalive_timer(struct collect_conn *c);
+#if COLLECT_WINDOW_SIZE > 1
+static int window_send_queued(struct collect_conn *c);
+static void window_packet_sent(struct collect_conn *c, int transmissions);
+static void window_handle_ack(struct collect_conn *c);
+#endif /* COLLECT_WINDOW_SIZE > 1 */
 
 /*---------------------------------------------------------------------------*/
 /**
@@ -557,6 +575,15 @@ send_queued_packet(struct collect_conn *c)
   struct data_msg_hdr hdr;
   int max_mac_rexmits;
 
+#if COLLECT_WINDOW_SIZE > 1
+  /* With windowed forwarding, the window code sends as many packets
+     as the window allows. It only falls through to the code below
+     when we have no parent to send to. */
+  if(window_send_queued(c)) {
+    return;
+  }
+#endif /* COLLECT_WINDOW_SIZE > 1 */
+
   /* If we are currently sending a packet, we do not attempt to send
      another one. */
   if(c->sending) {
@@ -639,7 +666,7 @@ send_queued_packet(struct collect_conn *c)
       PRINTF("listen\n");
       announcement_listen(1);
       ctimer_set(&c->transmit_after_scan_timer, ANNOUNCEMENT_SCAN_TIME,
-                 send_queued_packet, c);
+                 send_queued_packet_callback, c);
 #else /* COLLECT_CONF_WITH_LISTEN */
       announcement_set_value(&c->announcement, RTMETRIC_MAX);
       announcement_bump(&c->announcement);
@@ -649,6 +676,14 @@ send_queued_packet(struct collect_conn *c)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if COLLECT_ANNOUNCEMENTS && COLLECT_CONF_WITH_LISTEN
+static void
+send_queued_packet_callback(void *ptr)
+{
+  send_queued_packet(ptr);
+}
+#endif /* COLLECT_ANNOUNCEMENTS && COLLECT_CONF_WITH_LISTEN */
+/*---------------------------------------------------------------------------*/
 /**
  * This function is called to retransmit the first packet on the send
  * queue.
@@ -761,6 +796,11 @@ handle_ack(struct collect_conn *tc)
   struct ack_msg msg;
   struct collect_neighbor *n;
 
+#if COLLECT_WINDOW_SIZE > 1
+  window_handle_ack(tc);
+  return;
+#endif /* COLLECT_WINDOW_SIZE > 1 */
+
   PRINTF("handle_ack: sender %d.%d current_parent %d.%d, id %d seqno %d\n",
          packetbuf_addr(PACKETBUF_ADDR_SENDER)->u8[0],
          packetbuf_addr(PACKETBUF_ADDR_SENDER)->u8[1],
@@ -853,10 +893,10 @@ handle_ack(struct collect_conn *tc)
 }
 /*---------------------------------------------------------------------------*/
 static void
-send_ack(struct collect_conn *tc, const rimeaddr_t *to, int flags)
+send_ack(struct collect_conn *tc, const rimeaddr_t *to,
+         uint8_t packet_seqno, int flags, uint8_t acked)
 {
   struct ack_msg *ack;
-  uint16_t packet_seqno = packetbuf_attr(PACKETBUF_ATTR_PACKET_ID);
 
   packetbuf_clear();
   packetbuf_set_datalen(sizeof(struct ack_msg));
@@ -864,6 +904,7 @@ send_ack(struct collect_conn *tc, const rimeaddr_t *to, int flags)
   memset(ack, 0, sizeof(struct ack_msg));
   ack->rtmetric = tc->rtmetric;
   ack->flags = flags;
+  ack->acked = acked;
 
   packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, to);
   packetbuf_set_attr(PACKETBUF_ATTR_PACKET_TYPE, PACKETBUF_ATTR_PACKET_TYPE_ACK);
@@ -899,6 +940,480 @@ add_packet_to_recent_packets(struct collect_conn *tc)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if COLLECT_WINDOW_SIZE > 1
+/* Windowed forwarding. Up to COLLECT_WINDOW_SIZE packets from the
+   send queue are in flight to the parent at the same time. Each of
+   them is tagged with its own PACKETBUF_ATTR_PACKET_ID and is tracked
+   in a window slot until it is acknowledged, times out, or expires
+   from the send queue. A single retransmission timer serves the
+   whole window. The receiver collects the packet IDs it receives
+   from a sender and acknowledges them in a single aggregated ACK. */
+
+/* A slot is either handed to the MAC layer and waiting for the MAC
+   callback, or has been sent and is waiting for a network layer ACK. */
+#define WINDOW_SLOT_MAC            1
+#define WINDOW_SLOT_ACK            2
+
+/* The time a receiver waits for more packets from the same sender
+   before it sends an aggregated ACK. */
+#define ACK_AGGREGATION_TIME       (REXMIT_TIME / 8)
+
+static void window_retransmit_callback(void *ptr);
+/*---------------------------------------------------------------------------*/
+static int
+window_find_item(struct collect_conn *c, struct packetqueue_item *i)
+{
+  int slot;
+
+  for(slot = 0; slot < c->window_len; slot++) {
+    if(c->window[slot].item == i) {
+      return slot;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+window_remove(struct collect_conn *c, int slot)
+{
+  packetqueue_remove(&c->send_queue, c->window[slot].item);
+  c->window_len--;
+  memmove(&c->window[slot], &c->window[slot + 1],
+          (c->window_len - slot) * sizeof(struct collect_window_slot));
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Packets on the send queue have a limited lifetime and may be
+ * removed from the queue while they are in flight. This function
+ * drops the window slots whose packets no longer are on the queue.
+ */
+static void
+window_purge(struct collect_conn *c)
+{
+  struct packetqueue_item *i;
+  int slot;
+
+  for(slot = 0; slot < c->window_len;) {
+    for(i = packetqueue_first(&c->send_queue);
+        i != NULL && i != c->window[slot].item;
+        i = list_item_next(i));
+    if(i == NULL) {
+      c->window_len--;
+      memmove(&c->window[slot], &c->window[slot + 1],
+              (c->window_len - slot) * sizeof(struct collect_window_slot));
+    } else {
+      slot++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static clock_time_t
+window_time_left(struct collect_window_slot *s)
+{
+  clock_time_t left;
+
+  /* Deadlines are never set further away than 16 * REXMIT_TIME, so a
+     larger difference means that the deadline has passed. */
+  left = s->timeout - clock_time();
+  return left > 16 * REXMIT_TIME ? 0 : left;
+}
+/*---------------------------------------------------------------------------*/
+static void
+window_set_timer(struct collect_conn *c)
+{
+  clock_time_t left, next;
+  int slot;
+
+  if(c->window_len == 0) {
+    ctimer_stop(&c->retransmission_timer);
+    return;
+  }
+
+  next = 16 * REXMIT_TIME;
+  for(slot = 0; slot < c->window_len; slot++) {
+    left = window_time_left(&c->window[slot]);
+    if(left < next) {
+      next = left;
+    }
+  }
+  ctimer_set(&c->retransmission_timer, next > 0 ? next : 1,
+             window_retransmit_callback, c);
+}
+/*---------------------------------------------------------------------------*/
+static void
+window_transmit(struct collect_conn *c, struct collect_window_slot *s,
+                struct collect_neighbor *n)
+{
+  struct data_msg_hdr hdr;
+  int max_mac_rexmits;
+
+  queuebuf_to_packetbuf(packetqueue_queuebuf(s->item));
+
+  PRINTF("%d.%d: window: sending packet %d to %d.%d with eseqno %d\n",
+         rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
+         s->seqno, n->addr.u8[0], n->addr.u8[1],
+         packetbuf_attr(PACKETBUF_ATTR_EPACKET_ID));
+
+  packetbuf_set_attr(PACKETBUF_ATTR_RELIABLE, 1);
+  max_mac_rexmits = s->max_rexmits - s->transmissions > MAX_MAC_REXMITS?
+    MAX_MAC_REXMITS : s->max_rexmits - s->transmissions;
+  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, max_mac_rexmits);
+  packetbuf_set_attr(PACKETBUF_ATTR_PACKET_ID, s->seqno);
+
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.flags = DATA_FLAGS_WINDOW;
+  hdr.rtmetric = c->rtmetric;
+  memcpy(packetbuf_dataptr(), &hdr, sizeof(struct data_msg_hdr));
+
+  /* As in send_packet(), we guard against a MAC layer that never
+     calls us back by setting a long deadline until the MAC callback
+     has been received. */
+  s->state = WINDOW_SLOT_MAC;
+  s->timeout = clock_time() + 16 * REXMIT_TIME;
+  c->send_time = clock_time();
+
+  unicast_send(&c->unicast_conn, &n->addr);
+}
+/*---------------------------------------------------------------------------*/
+static void
+window_timedout(struct collect_conn *c, int slot)
+{
+  struct collect_neighbor *n;
+
+  PRINTF("%d.%d: window: packet %d timedout after %d transmissions to %d.%d\n",
+         rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
+         c->window[slot].seqno, c->window[slot].transmissions,
+         c->current_parent.u8[0], c->current_parent.u8[1]);
+
+  n = collect_neighbor_list_find(&c->neighbor_list, &c->current_parent);
+  if(n != NULL) {
+    collect_neighbor_tx_fail(n, c->window[slot].max_rexmits);
+  }
+  window_remove(c, slot);
+  stats.timedout++;
+  update_rtmetric(c);
+  set_keepalive_timer(c);
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Fill the window with packets from the send queue. Returns zero if
+ * there is no parent to send to, in which case the caller deals with
+ * finding a route.
+ */
+static int
+window_send_queued(struct collect_conn *c)
+{
+  struct collect_neighbor *n;
+  struct collect_window_slot *s;
+  struct packetqueue_item *i;
+
+  /* The sending flag guards against recursion: the MAC layer may call
+     us back from within unicast_send(). */
+  if(c->sending) {
+    return 1;
+  }
+
+  window_purge(c);
+
+  n = collect_neighbor_list_find(&c->neighbor_list, &c->parent);
+  if(n == NULL) {
+    return packetqueue_first(&c->send_queue) == NULL;
+  }
+
+  /* Packets already in flight were sent to the current parent. If we
+     have switched parents, we wait until the retransmission timer has
+     moved the window over to the new parent. */
+  if(c->window_len > 0 && !rimeaddr_cmp(&c->current_parent, &c->parent)) {
+    return 1;
+  }
+  rimeaddr_copy(&c->current_parent, &c->parent);
+
+  c->sending = 1;
+  while(c->window_len < COLLECT_WINDOW_SIZE) {
+    /* Find the first packet on the queue that is not in flight. We
+       restart from the head of the queue every time, since sending a
+       packet may remove other packets from the queue. */
+    for(i = packetqueue_first(&c->send_queue);
+        i != NULL && window_find_item(c, i) >= 0;
+        i = list_item_next(i));
+    if(i == NULL) {
+      break;
+    }
+
+    s = &c->window[c->window_len++];
+    s->item = i;
+    s->seqno = c->seqno;
+    s->transmissions = 0;
+    s->max_rexmits = queuebuf_attr(packetqueue_queuebuf(i),
+                                   PACKETBUF_ATTR_MAX_REXMIT);
+    c->seqno = (c->seqno + 1) % (1 << COLLECT_PACKET_ID_BITS);
+
+    stats.datasent++;
+    window_transmit(c, s, n);
+  }
+  c->sending = 0;
+
+  window_set_timer(c);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+window_packet_sent(struct collect_conn *c, int transmissions)
+{
+  struct collect_window_slot *s;
+  int slot;
+
+  for(slot = 0; slot < c->window_len; slot++) {
+    if(c->window[slot].seqno == packetbuf_attr(PACKETBUF_ATTR_PACKET_ID)) {
+      break;
+    }
+  }
+  if(slot == c->window_len) {
+    /* The packet was acknowledged before the MAC layer called back. */
+    return;
+  }
+
+  s = &c->window[slot];
+  s->transmissions += transmissions;
+  if(s->transmissions >= s->max_rexmits) {
+    window_timedout(c, slot);
+    window_send_queued(c);
+  } else {
+    s->state = WINDOW_SLOT_ACK;
+    s->timeout = clock_time() + REXMIT_TIME / 2 +
+      (random_rand() % (REXMIT_TIME / 2));
+  }
+  window_set_timer(c);
+}
+/*---------------------------------------------------------------------------*/
+static void
+window_retransmit_callback(void *ptr)
+{
+  struct collect_conn *c = ptr;
+  struct collect_neighbor *n;
+  struct collect_window_slot *s;
+  int slot;
+
+  window_purge(c);
+  update_rtmetric(c);
+
+  /* If we have found a better parent while the window was in flight,
+     we move the whole window over to the new parent. */
+  if(!rimeaddr_cmp(&c->current_parent, &c->parent)) {
+    PRINTF("window: parent change from %d.%d to %d.%d\n",
+           c->current_parent.u8[0], c->current_parent.u8[1],
+           c->parent.u8[0], c->parent.u8[1]);
+    rimeaddr_copy(&c->current_parent, &c->parent);
+    for(slot = 0; slot < c->window_len; slot++) {
+      c->window[slot].transmissions = 0;
+      c->window[slot].state = WINDOW_SLOT_ACK;
+      c->window[slot].timeout = clock_time();
+    }
+  }
+  n = collect_neighbor_list_find(&c->neighbor_list, &c->current_parent);
+
+  c->sending = 1;
+  for(slot = 0; slot < c->window_len;) {
+    s = &c->window[slot];
+    if(window_time_left(s) > 0) {
+      slot++;
+      continue;
+    }
+    if(s->state == WINDOW_SLOT_MAC) {
+      /* The MAC layer never called us back. */
+      s->transmissions += MAX_MAC_REXMITS + 1;
+    }
+    if(s->transmissions >= s->max_rexmits) {
+      window_timedout(c, slot);
+      continue;
+    }
+    if(n != NULL) {
+      window_transmit(c, s, n);
+    } else {
+      s->timeout = clock_time() + REXMIT_TIME;
+    }
+    slot++;
+  }
+  c->sending = 0;
+
+  window_send_queued(c);
+}
+/*---------------------------------------------------------------------------*/
+static void
+window_handle_ack(struct collect_conn *tc)
+{
+  struct ack_msg msg;
+  struct collect_neighbor *n;
+  struct collect_window_slot *s;
+  uint8_t packet_seqno, d;
+  int slot, found, penalty;
+
+  if(!rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_SENDER),
+                   &tc->current_parent)) {
+    stats.badack++;
+    return;
+  }
+
+  memcpy(&msg, packetbuf_dataptr(), sizeof(struct ack_msg));
+  packet_seqno = packetbuf_attr(PACKETBUF_ATTR_PACKET_ID);
+  n = collect_neighbor_list_find(&tc->neighbor_list,
+                                 packetbuf_addr(PACKETBUF_ADDR_SENDER));
+
+  PRINTF("%d.%d: window: ACK from %d.%d for %d, acked %02x, flags %02x\n",
+         rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
+         tc->current_parent.u8[0], tc->current_parent.u8[1],
+         packet_seqno, msg.acked, msg.flags);
+
+  found = 0;
+  penalty = MAX_REXMITS;
+  for(slot = 0; slot < tc->window_len;) {
+    s = &tc->window[slot];
+    d = packet_seqno - s->seqno;
+    if(d != 0 && (d > 8 || (msg.acked & (1 << (d - 1))) == 0)) {
+      slot++;
+      continue;
+    }
+    found = 1;
+    if(d == 0) {
+      penalty = s->max_rexmits;
+    }
+
+    if(d == 0 && (msg.flags & ACK_FLAGS_DROPPED) &&
+       (msg.flags & ACK_FLAGS_LIFETIME_EXCEEDED) == 0) {
+      /* The parent dropped the packet without its lifetime being
+         exceeded, so we penalize the parent and try again later. */
+      if(n != NULL) {
+        collect_neighbor_tx(n, s->max_rexmits);
+      }
+      s->state = WINDOW_SLOT_ACK;
+      s->timeout = clock_time() + REXMIT_TIME +
+        (random_rand() % (REXMIT_TIME));
+      slot++;
+      continue;
+    }
+
+    /* See handle_ack() for why zero transmissions are counted as
+       MAX_MAC_REXMITS. */
+    if(s->transmissions == 0) {
+      s->transmissions = MAX_MAC_REXMITS;
+    }
+    if(n != NULL) {
+      collect_neighbor_tx(n, s->transmissions);
+    }
+    window_remove(tc, slot);
+  }
+
+  if(!found) {
+    stats.badack++;
+    return;
+  }
+  stats.ackrecv++;
+
+  if(n != NULL) {
+    collect_neighbor_update_rtmetric(n, msg.rtmetric);
+    if(msg.flags & ACK_FLAGS_CONGESTED) {
+      PRINTF("ACK flag indicated parent was congested.\n");
+      collect_neighbor_set_congested(n);
+      collect_neighbor_tx(n, penalty * 2);
+    }
+  }
+  update_rtmetric(tc);
+
+  if(msg.flags & ACK_FLAGS_RTMETRIC_NEEDS_UPDATE) {
+    bump_advertisement(tc);
+  }
+
+  window_send_queued(tc);
+  window_set_timer(tc);
+  set_keepalive_timer(tc);
+}
+/*---------------------------------------------------------------------------*/
+static void
+flush_ack(struct collect_conn *tc)
+{
+  if(tc->ack_pending) {
+    tc->ack_pending = 0;
+    ctimer_stop(&tc->ack_timer);
+    send_ack(tc, &tc->ack_to, tc->ack_seqno, tc->ack_flags, tc->ack_bits);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+flush_ack_callback(void *ptr)
+{
+  flush_ack(ptr);
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Record a positive ACK for a packet and send it later, together with
+ * the ACKs for other packets that arrive from the same sender within
+ * ACK_AGGREGATION_TIME. The ACK is sent immediately when it covers a
+ * full window.
+ */
+static void
+aggregate_ack(struct collect_conn *tc, const rimeaddr_t *to,
+              uint8_t packet_seqno, int flags)
+{
+  uint8_t d, bits;
+  int num;
+
+  if(tc->ack_pending && rimeaddr_cmp(&tc->ack_to, to)) {
+    d = tc->ack_seqno - packet_seqno;
+    if(d == 0) {
+      tc->ack_flags |= flags;
+      return;
+    } else if(d <= 8) {
+      tc->ack_bits |= 1 << (d - 1);
+      tc->ack_flags |= flags;
+      stats.ackaggr++;
+      goto check_full;
+    }
+    d = packet_seqno - tc->ack_seqno;
+    if(d <= 8 && (tc->ack_bits >> (8 - d)) == 0) {
+      /* The new packet becomes the base of the ACK and the previous
+         base moves into the bitmap. */
+      tc->ack_bits = (tc->ack_bits << d) | (1 << (d - 1));
+      tc->ack_seqno = packet_seqno;
+      tc->ack_flags |= flags;
+      stats.ackaggr++;
+      goto check_full;
+    }
+  }
+
+  flush_ack(tc);
+  rimeaddr_copy(&tc->ack_to, to);
+  tc->ack_seqno = packet_seqno;
+  tc->ack_bits = 0;
+  tc->ack_flags = flags;
+  tc->ack_pending = 1;
+  ctimer_set(&tc->ack_timer, ACK_AGGREGATION_TIME, flush_ack_callback, tc);
+
+ check_full:
+  for(num = 1, bits = tc->ack_bits; bits != 0; bits >>= 1) {
+    num += bits & 1;
+  }
+  if(num >= COLLECT_WINDOW_SIZE) {
+    flush_ack(tc);
+  }
+}
+#endif /* COLLECT_WINDOW_SIZE > 1 */
+/*---------------------------------------------------------------------------*/
+static void
+ack_packet(struct collect_conn *tc, const rimeaddr_t *to,
+           uint8_t packet_seqno, int flags, int windowed)
+{
+#if COLLECT_WINDOW_SIZE > 1
+  /* Positive ACKs to windowed senders are aggregated, negative ACKs
+     and ACKs to senders without a window are sent right away. */
+  if(windowed && (flags & ACK_FLAGS_DROPPED) == 0) {
+    aggregate_ack(tc, to, packet_seqno, flags);
+    return;
+  }
+  flush_ack(tc);
+#endif /* COLLECT_WINDOW_SIZE > 1 */
+  send_ack(tc, to, packet_seqno, flags, 0);
+}
+/*---------------------------------------------------------------------------*/
 static void
 node_packet_received(struct unicast_conn *c, const rimeaddr_t *from)
 {
@@ -930,6 +1445,7 @@ node_packet_received(struct unicast_conn *c, const rimeaddr_t *from)
      PACKETBUF_ATTR_PACKET_TYPE_DATA) {
     rimeaddr_t ack_to;
     uint8_t packet_seqno;
+    int windowed;
 
     stats.datarecv++;
 
@@ -937,6 +1453,7 @@ node_packet_received(struct unicast_conn *c, const rimeaddr_t *from)
        packet buffer and its attributes when sending the ACK. */
     rimeaddr_copy(&ack_to, packetbuf_addr(PACKETBUF_ADDR_SENDER));
     packet_seqno = packetbuf_attr(PACKETBUF_ATTR_PACKET_ID);
+    windowed = hdr.flags & DATA_FLAGS_WINDOW;
 
     /* If the queue is more than half filled, we add the CONGESTED
        flag to our outgoing acks. */
@@ -960,7 +1477,7 @@ node_packet_received(struct unicast_conn *c, const rimeaddr_t *from)
                packetbuf_attr(PACKETBUF_ATTR_EPACKET_ID),
                packetbuf_addr(PACKETBUF_ADDR_SENDER)->u8[0],
                packetbuf_addr(PACKETBUF_ADDR_SENDER)->u8[1]);
-        send_ack(tc, &ack_to, ackflags);
+        ack_packet(tc, &ack_to, packet_seqno, ackflags, windowed);
         stats.duprecv++;
         return;
       }
@@ -977,7 +1494,7 @@ node_packet_received(struct unicast_conn *c, const rimeaddr_t *from)
          first. */
       q = queuebuf_new_from_packetbuf();
       if(q != NULL) {
-        send_ack(tc, &ack_to, 0);
+        ack_packet(tc, &ack_to, packet_seqno, 0, windowed);
         queuebuf_to_packetbuf(q);
         queuebuf_free(q);
       } else {
@@ -1044,11 +1561,12 @@ node_packet_received(struct unicast_conn *c, const rimeaddr_t *from)
                                        packetbuf_attr(PACKETBUF_ATTR_MAX_REXMIT),
                                        tc)) {
         add_packet_to_recent_packets(tc);
-        send_ack(tc, &ack_to, ackflags);
+        ack_packet(tc, &ack_to, packet_seqno, ackflags, windowed);
         send_queued_packet(tc);
       } else {
-        send_ack(tc, &ack_to,
-                 ackflags | ACK_FLAGS_DROPPED | ACK_FLAGS_CONGESTED);
+        ack_packet(tc, &ack_to, packet_seqno,
+                   ackflags | ACK_FLAGS_DROPPED | ACK_FLAGS_CONGESTED,
+                   windowed);
         PRINTF("%d.%d: packet dropped: no queue buffer available\n",
                   rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1]);
         stats.qdrop++;
@@ -1057,8 +1575,9 @@ node_packet_received(struct unicast_conn *c, const rimeaddr_t *from)
       PRINTF("%d.%d: packet dropped: ttl %d\n",
              rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
              packetbuf_attr(PACKETBUF_ATTR_TTL));
-      send_ack(tc, &ack_to, ackflags |
-               ACK_FLAGS_DROPPED | ACK_FLAGS_LIFETIME_EXCEEDED);
+      ack_packet(tc, &ack_to, packet_seqno, ackflags |
+                 ACK_FLAGS_DROPPED | ACK_FLAGS_LIFETIME_EXCEEDED,
+                 windowed);
       stats.ttldrop++;
     }
   } else if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
@@ -1111,6 +1630,11 @@ node_packet_sent(struct unicast_conn *c, int status, int transmissions)
   if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
      PACKETBUF_ATTR_PACKET_TYPE_DATA) {
 
+#if COLLECT_WINDOW_SIZE > 1
+    window_packet_sent(tc, transmissions);
+    return;
+#endif /* COLLECT_WINDOW_SIZE > 1 */
+
     tc->transmissions += transmissions;
     PRINTF("tx %d\n", tc->transmissions);    
     PRINTF("%d.%d: MAC sent %d transmissions to %d.%d, status %d, total transmissions %d\n",
@@ -1279,6 +1803,10 @@ collect_open(struct collect_conn *tc, uint16_t channels,
   tc->is_router = is_router;
   tc->seqno = 10;
   tc->eseqno = 0;
+#if COLLECT_WINDOW_SIZE > 1
+  tc->window_len = 0;
+  tc->ack_pending = 0;
+#endif /* COLLECT_WINDOW_SIZE > 1 */
   LIST_STRUCT_INIT(tc, send_queue_list);
   collect_neighbor_list_new(&tc->neighbor_list);
   tc->send_queue.list = &(tc->send_queue_list);
@@ -1357,6 +1885,12 @@ collect_close(struct collect_conn *tc)
   while(packetqueue_first(&tc->send_queue) != NULL) {
     packetqueue_dequeue(&tc->send_queue);
   }
+  ctimer_stop(&tc->retransmission_timer);
+#if COLLECT_WINDOW_SIZE > 1
+  tc->window_len = 0;
+  tc->ack_pending = 0;
+  ctimer_stop(&tc->ack_timer);
+#endif /* COLLECT_WINDOW_SIZE > 1 */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -1372,6 +1906,9 @@ collect_set_sink(struct collect_conn *tc, int should_be_sink)
     while(packetqueue_len(&tc->send_queue) > 0) {
       packetqueue_dequeue(&tc->send_queue);
     }
+#if COLLECT_WINDOW_SIZE > 1
+    tc->window_len = 0;
+#endif /* COLLECT_WINDOW_SIZE > 1 */
 
     /* Stop the retransmission timer. */
     ctimer_stop(&tc->retransmission_timer);
@@ -1466,7 +2003,7 @@ collect_send(struct collect_conn *tc, int rexmits)
       PRINTF("listen\n");
       announcement_listen(1);
       ctimer_set(&tc->transmit_after_scan_timer, ANNOUNCEMENT_SCAN_TIME,
-                 send_queued_packet, tc);
+                 send_queued_packet_callback, tc);
 #else /* COLLECT_CONF_WITH_LISTEN */
       announcement_set_value(&tc->announcement, RTMETRIC_MAX);
       announcement_bump(&tc->announcement);
@@ -1516,12 +2053,12 @@ collect_purge(struct collect_conn *tc)
 void
 collect_print_stats(void)
 {
-  PRINTF("collect stats foundroute %lu newparent %lu routelost %lu acksent %lu datasent %lu datarecv %lu ackrecv %lu badack %lu duprecv %lu qdrop %lu rtdrop %lu ttldrop %lu ackdrop %lu timedout %lu\n",
+  PRINTF("collect stats foundroute %lu newparent %lu routelost %lu acksent %lu datasent %lu datarecv %lu ackrecv %lu badack %lu duprecv %lu qdrop %lu rtdrop %lu ttldrop %lu ackdrop %lu timedout %lu ackaggr %lu\n",
          stats.foundroute, stats.newparent, stats.routelost,
          stats.acksent, stats.datasent, stats.datarecv,
          stats.ackrecv, stats.badack, stats.duprecv,
          stats.qdrop, stats.rtdrop, stats.ttldrop, stats.ackdrop,
-         stats.timedout);
+         stats.timedout, stats.ackaggr);
 }
 /*---------------------------------------------------------------------------*/
 /** @} */
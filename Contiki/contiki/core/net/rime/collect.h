@@ -93,6 +93,34 @@ struct collect_callbacks {
 #define COLLECT_ANNOUNCEMENTS COLLECT_CONF_ANNOUNCEMENTS
 #endif /* COLLECT_CONF_ANNOUNCEMENTS */
 
+/* COLLECT_CONF_WINDOW_SIZE defines how many data packets a node may
+   have outstanding towards its parent at the same time. With the
+   default window size of one, the next packet on the send queue is
+   sent only when the previous one has been acknowledged. With a
+   larger window, a forwarding node pipelines several packets per
+   parent wake-up and the parent acknowledges them with aggregated,
+   selective ACKs. Nodes with different window sizes can share a
+   network: a parent only aggregates the ACKs to children that use a
+   window. The selective ACK bitmap limits the window to nine
+   packets. */
+#ifdef COLLECT_CONF_WINDOW_SIZE
+#define COLLECT_WINDOW_SIZE COLLECT_CONF_WINDOW_SIZE
+#else /* COLLECT_CONF_WINDOW_SIZE */
+#define COLLECT_WINDOW_SIZE 1
+#endif /* COLLECT_CONF_WINDOW_SIZE */
+
+#if COLLECT_WINDOW_SIZE > 9
+#error COLLECT_CONF_WINDOW_SIZE must not be larger than 9
+#endif
+
+#if COLLECT_WINDOW_SIZE > 1
+struct collect_window_slot {
+  struct packetqueue_item *item;
+  clock_time_t timeout;
+  uint8_t seqno, transmissions, max_rexmits, state;
+};
+#endif /* COLLECT_WINDOW_SIZE > 1 */
+
 struct collect_conn {
   struct unicast_conn unicast_conn;
 #if ! COLLECT_ANNOUNCEMENTS
@@ -120,6 +148,17 @@ struct collect_conn {
   uint8_t is_router;
 
   clock_time_t send_time;
+
+#if COLLECT_WINDOW_SIZE > 1
+  /* Sender side: the packets currently in flight to the parent. */
+  struct collect_window_slot window[COLLECT_WINDOW_SIZE];
+  uint8_t window_len;
+
+  /* Receiver side: the pending aggregated ACK. */
+  struct ctimer ack_timer;
+  rimeaddr_t ack_to;
+  uint8_t ack_seqno, ack_bits, ack_flags, ack_pending;
+#endif /* COLLECT_WINDOW_SIZE > 1 */
 };
 
 enum {
@@ -154,4 +154,51 @@
 #define RPL_DIO_REDUNDANCY          10
 #endif
 
+/*
+ * DAO aggregation. By default, a router forwards every DAO that it
+ * receives from a child to its own preferred parent as a separate
+ * message. With DAO aggregation, the targets from the children are
+ * instead held back and sent upwards together with the router's own
+ * target, packing as many target/transit option pairs as fit into
+ * RPL_DAO_MAX_LENGTH bytes into each DAO. The DAO timer then acts as
+ * a coalescing window that grows when many child DAOs arrive, for
+ * example after a global repair, and shrinks back to the default DAO
+ * latency when the network is quiet.
+ */
+#ifdef RPL_CONF_DAO_AGGREGATION
+#define RPL_DAO_AGGREGATION RPL_CONF_DAO_AGGREGATION
+#else
+#define RPL_DAO_AGGREGATION 0
+#endif /* RPL_CONF_DAO_AGGREGATION */
+
+/*
+ * The number of child targets that can wait for aggregation. When
+ * they are all in use, further DAOs are forwarded unaggregated.
+ */
+#ifdef RPL_CONF_DAO_AGGREGATION_TARGETS
+#define RPL_DAO_AGGREGATION_TARGETS RPL_CONF_DAO_AGGREGATION_TARGETS
+#else
+#define RPL_DAO_AGGREGATION_TARGETS 8
+#endif /* RPL_CONF_DAO_AGGREGATION_TARGETS */
+
+/*
+ * The maximum size of an aggregated DAO message, not counting the IPv6
+ * and ICMPv6 headers.
+ */
+#ifdef RPL_CONF_DAO_MAX_LENGTH
+#define RPL_DAO_MAX_LENGTH RPL_CONF_DAO_MAX_LENGTH
+#else
+#define RPL_DAO_MAX_LENGTH (UIP_BUFSIZE - UIP_LLH_LEN - UIP_IPICMPH_LEN)
+#endif /* RPL_CONF_DAO_MAX_LENGTH */
+
+/*
+ * The maximum number of times a DAO is retransmitted when no DAO ACK
+ * is received for it. Only used when RPL_CONF_DAO_ACK is set.
+ */
+#ifdef RPL_CONF_DAO_MAX_RETRANSMISSIONS
+#define RPL_DAO_MAX_RETRANSMISSIONS RPL_CONF_DAO_MAX_RETRANSMISSIONS
+#else
+#define RPL_DAO_MAX_RETRANSMISSIONS 3
+#endif /* RPL_CONF_DAO_MAX_RETRANSMISSIONS */
+
 #endif /* RPL_CONF_H */
@@ -544,6 +544,163 @@ dio_output(rpl_instance_t *instance, uip_ipaddr_t *uc_addr)
 #endif /* RPL_LEAF_ONLY */
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_DAO_AGGREGATION
+/* Targets from child DAOs that wait to be sent upwards in an
+   aggregated DAO. With DAO ACKs, a target stays in the table until
+   the DAO that carried it has been acknowledged. */
+#define DAO_TARGET_FREE                  0
+#define DAO_TARGET_PENDING               1
+#define DAO_TARGET_SENT                  2
+
+struct dao_target {
+  rpl_instance_t *instance;
+  uip_ipaddr_t prefix;
+  uint8_t length;
+  uint8_t lifetime;
+  uint8_t state;
+  uint8_t sequence;
+};
+
+static struct dao_target dao_targets[RPL_DAO_AGGREGATION_TARGETS];
+/*---------------------------------------------------------------------------*/
+static int
+dao_aggregate(rpl_instance_t *instance, uip_ipaddr_t *prefix,
+              uint8_t length, uint8_t lifetime)
+{
+  struct dao_target *t, *free_target;
+
+  free_target = NULL;
+  for(t = dao_targets; t < &dao_targets[RPL_DAO_AGGREGATION_TARGETS]; t++) {
+    if(t->state == DAO_TARGET_FREE) {
+      if(free_target == NULL) {
+        free_target = t;
+      }
+    } else if(t->instance == instance && t->length == length &&
+              uip_ipaddr_cmp(&t->prefix, prefix)) {
+      /* The target is already waiting; refresh its lifetime. */
+      t->lifetime = lifetime;
+      t->state = DAO_TARGET_PENDING;
+      return 1;
+    }
+  }
+
+  if(free_target == NULL) {
+    return 0;
+  }
+
+  free_target->instance = instance;
+  uip_ipaddr_copy(&free_target->prefix, prefix);
+  free_target->length = length;
+  free_target->lifetime = lifetime;
+  free_target->state = DAO_TARGET_PENDING;
+  instance->dao_aggregated++;
+  RPL_STAT(rpl_stats.dao_aggregated++);
+  return 1;
+}
+#endif /* RPL_DAO_AGGREGATION */
+/*---------------------------------------------------------------------------*/
+int
+dao_output_pending(rpl_instance_t *instance)
+{
+  int pending;
+#if RPL_DAO_AGGREGATION
+  struct dao_target *t;
+#endif /* RPL_DAO_AGGREGATION */
+
+  pending = 0;
+#if RPL_DAO_AGGREGATION
+  for(t = dao_targets; t < &dao_targets[RPL_DAO_AGGREGATION_TARGETS]; t++) {
+    if(t->state == DAO_TARGET_PENDING && t->instance == instance) {
+      pending++;
+    }
+  }
+#endif /* RPL_DAO_AGGREGATION */
+  return pending;
+}
+/*---------------------------------------------------------------------------*/
+void
+dao_output_requeue(rpl_instance_t *instance)
+{
+#if RPL_DAO_AGGREGATION
+  struct dao_target *t;
+
+  /* The DAO that carried these targets was never acknowledged. */
+  for(t = dao_targets; t < &dao_targets[RPL_DAO_AGGREGATION_TARGETS]; t++) {
+    if(t->state == DAO_TARGET_SENT && t->instance == instance) {
+      t->state = DAO_TARGET_PENDING;
+    }
+  }
+#endif /* RPL_DAO_AGGREGATION */
+}
+/*---------------------------------------------------------------------------*/
+#define DAO_FORWARD                      1
+#define DAO_AGGREGATED                   2
+
+static int
+dao_input_target(rpl_instance_t *instance, uip_ipaddr_t *from,
+                 int learned_from, uip_ipaddr_t *prefix, uint8_t prefixlen,
+                 uint8_t lifetime)
+{
+  rpl_dag_t *dag;
+  uip_ds6_route_t *rep;
+  rpl_parent_t *p;
+
+  dag = instance->current_dag;
+
+  PRINTF("RPL: DAO lifetime: %u, prefix length: %u prefix: ",
+          (unsigned)lifetime, (unsigned)prefixlen);
+  PRINT6ADDR(prefix);
+  PRINTF("\n");
+
+  rep = uip_ds6_route_lookup(prefix);
+
+  if(lifetime == RPL_ZERO_LIFETIME) {
+    /* No-Path DAO received; invoke the route purging routine. */
+    if(rep != NULL && rep->state.saved_lifetime == 0 && rep->length == prefixlen) {
+      PRINTF("RPL: Setting expiration timer for prefix ");
+      PRINT6ADDR(prefix);
+      PRINTF("\n");
+      rep->state.saved_lifetime = rep->state.lifetime;
+      rep->state.lifetime = DAO_EXPIRATION_TIMEOUT;
+    }
+    return 0;
+  }
+
+  if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
+    /* Check whether this is a DAO forwarding loop. */
+    p = rpl_find_parent(dag, from);
+    /* check if this is a new DAO registration with an "illegal" rank */
+    /* if we already route to this node it is likely */
+    if(p != NULL && DAG_RANK(p->rank, instance) < DAG_RANK(dag->rank, instance)) {
+      PRINTF("RPL: Loop detected when receiving a unicast DAO from a node with a lower rank! (%u < %u)\n",
+          DAG_RANK(p->rank, instance), DAG_RANK(dag->rank, instance));
+      p->rank = INFINITE_RANK;
+      p->updated = 1;
+      return -1;
+    }
+  }
+
+  rep = rpl_add_route(dag, prefix, prefixlen, from);
+  if(rep == NULL) {
+    RPL_STAT(rpl_stats.mem_overflows++);
+    PRINTF("RPL: Could not add a route after receiving a DAO\n");
+    return 0;
+  }
+
+  rep->state.lifetime = RPL_LIFETIME(instance, lifetime);
+  rep->state.learned_from = learned_from;
+
+  if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO && dag->preferred_parent) {
+#if RPL_DAO_AGGREGATION
+    if(dao_aggregate(instance, prefix, prefixlen, lifetime)) {
+      return DAO_AGGREGATED;
+    }
+#endif /* RPL_DAO_AGGREGATION */
+    return DAO_FORWARD;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
 static void
 dao_input(void)
 {
@@ -556,19 +713,19 @@ dao_input(void)
   uint8_t lifetime;
   uint8_t prefixlen;
   uint8_t flags;
-  uint8_t subopt_type;
-  uint8_t pathcontrol;
-  uint8_t pathsequence;
   uip_ipaddr_t prefix;
-  uip_ds6_route_t *rep;
   uint8_t buffer_length;
   int pos;
   int len;
   int i;
+  int j;
+  int group;
+  int out;
+  int optlen;
+  int forwarded;
   int learned_from;
-  rpl_parent_t *p;
-
-  prefixlen = 0;
+  int ret;
+  int action;
 
   uip_ipaddr_copy(&dao_sender_addr, &UIP_IP_BUF->srcipaddr);
 
@@ -609,87 +766,78 @@ dao_input(void)
     /* Perhaps, there are verification to do but ... */
   }
 
-  /* Check if there are any RPL options present. */
-  i = pos;
-  for(; i < buffer_length; i += len) {
-    subopt_type = buffer[i];
-    if(subopt_type == RPL_OPTION_PAD1) {
-      len = 1;
-    } else {
-      /* The option consists of a two-byte header and a payload. */
-      len = 2 + buffer[i + 1];
-    }
+  learned_from = uip_is_addr_mcast(&dao_sender_addr) ?
+                 RPL_ROUTE_FROM_MULTICAST_DAO : RPL_ROUTE_FROM_UNICAST_DAO;
 
-    switch(subopt_type) {
-    case RPL_OPTION_TARGET:
-      /* Handle the target option. */
-      prefixlen = buffer[i + 3];
-      memset(&prefix, 0, sizeof(prefix));
-      memcpy(&prefix, buffer + i + 4, (prefixlen + 7) / CHAR_BIT);
-      break;
-    case RPL_OPTION_TRANSIT:
-      /* The path sequence and control are ignored. */
-      pathcontrol = buffer[i + 3];
-      pathsequence = buffer[i + 4];
+  /* A DAO may carry several groups of target options, each followed
+     by a transit information option that applies to the targets in
+     the group. We process a group when we reach its transit option,
+     or the end of the message. Targets that we aggregate are removed
+     from the DAO, so that only the rest is forwarded to our parent. */
+  action = 0;
+  group = pos;
+  out = pos;
+  for(i = pos; i <= buffer_length; i += len) {
+    if(i < buffer_length) {
+      if(buffer[i] == RPL_OPTION_PAD1) {
+        len = 1;
+      } else {
+        /* The option consists of a two-byte header and a payload. */
+        len = 2 + buffer[i + 1];
+      }
+      if(buffer[i] != RPL_OPTION_TRANSIT) {
+        continue;
+      }
+      /* The path sequence, path control and parent address are
+         ignored. */
       lifetime = buffer[i + 5];
-      /* The parent address is also ignored. */
-      break;
+    } else {
+      len = 1;
     }
-  }
 
-  PRINTF("RPL: DAO lifetime: %u, prefix length: %u prefix: ",
-          (unsigned)lifetime, (unsigned)prefixlen);
-  PRINT6ADDR(&prefix);
-  PRINTF("\n");
-
-  rep = uip_ds6_route_lookup(&prefix);
-
-  if(lifetime == RPL_ZERO_LIFETIME) {
-    /* No-Path DAO received; invoke the route purging routine. */
-    if(rep != NULL && rep->state.saved_lifetime == 0 && rep->length == prefixlen) {
-      PRINTF("RPL: Setting expiration timer for prefix ");
-      PRINT6ADDR(&prefix);
-      PRINTF("\n");
-      rep->state.saved_lifetime = rep->state.lifetime;
-      rep->state.lifetime = DAO_EXPIRATION_TIMEOUT;
+    forwarded = 0;
+    for(j = group; j < i; j += optlen) {
+      optlen = buffer[j] == RPL_OPTION_PAD1 ? 1 : 2 + buffer[j + 1];
+      if(buffer[j] == RPL_OPTION_TARGET) {
+        prefixlen = buffer[j + 3];
+        memset(&prefix, 0, sizeof(prefix));
+        memcpy(&prefix, buffer + j + 4, (prefixlen + 7) / CHAR_BIT);
+        ret = dao_input_target(instance, &dao_sender_addr, learned_from,
+                               &prefix, prefixlen, lifetime);
+        if(ret < 0) {
+          return;
+        }
+        action |= ret;
+        if(ret == DAO_FORWARD) {
+          memmove(buffer + out, buffer + j, optlen);
+          out += optlen;
+          forwarded = 1;
+        }
+      }
     }
-    return;
-  }
-
-  learned_from = uip_is_addr_mcast(&dao_sender_addr) ?
-                 RPL_ROUTE_FROM_MULTICAST_DAO : RPL_ROUTE_FROM_UNICAST_DAO;
-
-  if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
-    /* Check whether this is a DAO forwarding loop. */
-    p = rpl_find_parent(dag, &dao_sender_addr);
-    /* check if this is a new DAO registration with an "illegal" rank */
-    /* if we already route to this node it is likely */
-    if(p != NULL && DAG_RANK(p->rank, instance) < DAG_RANK(dag->rank, instance)) {
-      PRINTF("RPL: Loop detected when receiving a unicast DAO from a node with a lower rank! (%u < %u)\n",
-          DAG_RANK(p->rank, instance), DAG_RANK(dag->rank, instance));
-      p->rank = INFINITE_RANK;
-      p->updated = 1;
-      return;
+    if(forwarded && i < buffer_length) {
+      memmove(buffer + out, buffer + i, len);
+      out += len;
     }
-  }
 
-  rep = rpl_add_route(dag, &prefix, prefixlen, &dao_sender_addr);
-  if(rep == NULL) {
-    RPL_STAT(rpl_stats.mem_overflows++);
-    PRINTF("RPL: Could not add a route after receiving a DAO\n");
-    return;
+    /* Targets after the last transit option have the default
+       lifetime. */
+    group = i + len;
+    lifetime = instance->default_lifetime;
   }
 
-  rep->state.lifetime = RPL_LIFETIME(instance, lifetime);
-  rep->state.learned_from = learned_from;
-
   if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
-    if(dag->preferred_parent) {
+    if(action & DAO_FORWARD) {
       PRINTF("RPL: Forwarding DAO to parent ");
       PRINT6ADDR(&dag->preferred_parent->addr);
       PRINTF("\n");
+      RPL_STAT(rpl_stats.dao_forwarded++);
       uip_icmp6_send(&dag->preferred_parent->addr,
-                     ICMP6_RPL, RPL_CODE_DAO, buffer_length);
+                     ICMP6_RPL, RPL_CODE_DAO, out);
+    }
+    if(action & DAO_AGGREGATED) {
+      PRINTF("RPL: Aggregating DAO targets\n");
+      rpl_schedule_dao(instance);
     }
     if(flags & RPL_DAO_K_FLAG) {
       dao_ack_output(instance, &dao_sender_addr, sequence);
@@ -697,15 +845,40 @@ dao_input(void)
   }
 }
 /*---------------------------------------------------------------------------*/
+static int
+dao_add_target(unsigned char *buffer, int pos, uip_ipaddr_t *prefix,
+               uint8_t prefixlen, uint8_t lifetime)
+{
+  /* create target subopt */
+  buffer[pos++] = RPL_OPTION_TARGET;
+  buffer[pos++] = 2 + ((prefixlen + 7) / CHAR_BIT);
+  buffer[pos++] = 0; /* reserved */
+  buffer[pos++] = prefixlen;
+  memcpy(buffer + pos, prefix, (prefixlen + 7) / CHAR_BIT);
+  pos += ((prefixlen + 7) / CHAR_BIT);
+
+  /* Create a transit information sub-option. */
+  buffer[pos++] = RPL_OPTION_TRANSIT;
+  buffer[pos++] = 4;
+  buffer[pos++] = 0; /* flags - ignored */
+  buffer[pos++] = 0; /* path control - ignored */
+  buffer[pos++] = 0; /* path seq - ignored */
+  buffer[pos++] = lifetime;
+
+  return pos;
+}
+/*---------------------------------------------------------------------------*/
 void
 dao_output(rpl_parent_t *n, uint8_t lifetime)
 {
   rpl_dag_t *dag;
   rpl_instance_t *instance;
   unsigned char *buffer;
-  uint8_t prefixlen;
   uip_ipaddr_t prefix;
   int pos;
+#if RPL_DAO_AGGREGATION
+  struct dao_target *t;
+#endif /* RPL_DAO_AGGREGATION */
 
   /* Destination Advertisement Object */
 
@@ -742,22 +915,8 @@ dao_output(rpl_parent_t *n, uint8_t lifetime)
   pos+=sizeof(dag->dag_id);
 #endif /* RPL_DAO_SPECIFY_DAG */
 
-  /* create target subopt */
-  prefixlen = sizeof(prefix) * CHAR_BIT;
-  buffer[pos++] = RPL_OPTION_TARGET;
-  buffer[pos++] = 2 + ((prefixlen + 7) / CHAR_BIT);
-  buffer[pos++] = 0; /* reserved */
-  buffer[pos++] = prefixlen;
-  memcpy(buffer + pos, &prefix, (prefixlen + 7) / CHAR_BIT);
-  pos += ((prefixlen + 7) / CHAR_BIT);
-
-  /* Create a transit information sub-option. */
-  buffer[pos++] = RPL_OPTION_TRANSIT;
-  buffer[pos++] = 4;
-  buffer[pos++] = 0; /* flags - ignored */
-  buffer[pos++] = 0; /* path control - ignored */
-  buffer[pos++] = 0; /* path seq - ignored */
-  buffer[pos++] = lifetime;
+  pos = dao_add_target(buffer, pos, &prefix, sizeof(prefix) * CHAR_BIT,
+                       lifetime);
 
   PRINTF("RPL: Sending DAO with prefix ");
   PRINT6ADDR(&prefix);
@@ -765,6 +924,36 @@ dao_output(rpl_parent_t *n, uint8_t lifetime)
   PRINT6ADDR(&n->addr);
   PRINTF("\n");
 
+  if(lifetime != RPL_ZERO_LIFETIME) {
+#if RPL_DAO_AGGREGATION
+    /* Append the targets of our children. Targets that were sent in
+       an earlier DAO that has not been acknowledged are sent again. */
+    for(t = dao_targets; t < &dao_targets[RPL_DAO_AGGREGATION_TARGETS]; t++) {
+      if(t->instance != instance || t->state == DAO_TARGET_FREE) {
+        continue;
+      }
+      if(pos + 10 + (t->length + 7) / CHAR_BIT > RPL_DAO_MAX_LENGTH) {
+        t->state = DAO_TARGET_PENDING;
+        continue;
+      }
+      pos = dao_add_target(buffer, pos, &t->prefix, t->length, t->lifetime);
+#if RPL_CONF_DAO_ACK
+      t->state = DAO_TARGET_SENT;
+      t->sequence = dao_sequence;
+#else /* RPL_CONF_DAO_ACK */
+      t->state = DAO_TARGET_FREE;
+#endif /* RPL_CONF_DAO_ACK */
+      PRINTF("RPL: Aggregating target ");
+      PRINT6ADDR(&t->prefix);
+      PRINTF("\n");
+    }
+#endif /* RPL_DAO_AGGREGATION */
+#if RPL_CONF_DAO_ACK
+    instance->dao_seqno = dao_sequence;
+#endif /* RPL_CONF_DAO_ACK */
+  }
+
+  RPL_STAT(rpl_stats.dao_sent++);
   uip_icmp6_send(&n->addr, ICMP6_RPL, RPL_CODE_DAO, pos);
 }
 /*---------------------------------------------------------------------------*/
@@ -776,6 +965,9 @@ dao_ack_input(void)
   uint8_t instance_id;
   uint8_t sequence;
   uint8_t status;
+#if RPL_CONF_DAO_ACK
+  rpl_instance_t *instance;
+#endif /* RPL_CONF_DAO_ACK */
 
   buffer = UIP_ICMP_PAYLOAD;
   buffer_length = uip_len - uip_l3_icmp_hdr_len;
@@ -788,6 +980,36 @@ dao_ack_input(void)
     sequence, status);
   PRINT6ADDR(&UIP_IP_BUF->srcipaddr);
   PRINTF("\n");
+
+#if RPL_CONF_DAO_ACK
+  instance = rpl_get_instance(instance_id);
+  if(instance == NULL || instance->dao_transmissions == 0 ||
+     sequence != instance->dao_seqno) {
+    return;
+  }
+
+  /* The DAO has reached our parent, or has been rejected by it. In
+     either case there is no point in retransmitting it. */
+  instance->dao_transmissions = 0;
+  rpl_cancel_dao_retransmission(instance);
+
+#if RPL_DAO_AGGREGATION
+  {
+    struct dao_target *t;
+
+    for(t = dao_targets; t < &dao_targets[RPL_DAO_AGGREGATION_TARGETS]; t++) {
+      if(t->state == DAO_TARGET_SENT && t->instance == instance &&
+         t->sequence == sequence) {
+        t->state = DAO_TARGET_FREE;
+      }
+    }
+  }
+#endif /* RPL_DAO_AGGREGATION */
+
+  if(dao_output_pending(instance)) {
+    rpl_schedule_dao(instance);
+  }
+#endif /* RPL_CONF_DAO_ACK */
 }
 /*---------------------------------------------------------------------------*/
 void
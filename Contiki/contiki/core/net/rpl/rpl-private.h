@@ -105,6 +105,16 @@
 /* The default value for the DAO timer. */
 #define RPL_DAO_LATENCY                 (CLOCK_SECOND * 4)
 
+/* The longest DAO coalescing window used with DAO aggregation. */
+#define RPL_DAO_MAX_LATENCY             (RPL_DAO_LATENCY * 8)
+
+/* The number of aggregated child targets per DAO timer period above
+   which the coalescing window is widened. */
+#define RPL_DAO_AGGREGATION_HIGH        4
+
+/* The time to wait for a DAO ACK before retransmitting the DAO. */
+#define RPL_DAO_RETRANSMISSION_TIMEOUT  (CLOCK_SECOND * 5)
+
 /* Special value indicating immediate removal. */
 #define RPL_ZERO_LIFETIME               0
 
@@ -248,6 +258,10 @@ struct rpl_stats {
   uint16_t malformed_msgs;
   uint16_t resets;
   uint16_t parent_switch;
+  uint16_t dao_sent;
+  uint16_t dao_forwarded;
+  uint16_t dao_aggregated;
+  uint16_t dao_retransmissions;
 };
 typedef struct rpl_stats rpl_stats_t;
 
@@ -271,6 +285,8 @@ void dis_output(uip_ipaddr_t *addr);
 void dio_output(rpl_instance_t *, uip_ipaddr_t *uc_addr);
 void dao_output(rpl_parent_t *, uint8_t lifetime);
 void dao_ack_output(rpl_instance_t *, uip_ipaddr_t *, uint8_t);
+int dao_output_pending(rpl_instance_t *);
+void dao_output_requeue(rpl_instance_t *);
 
 /* RPL logic functions. */
 void rpl_join_dag(uip_ipaddr_t *from, rpl_dio_t *dio);
@@ -308,6 +324,8 @@ rpl_of_t *rpl_find_of(rpl_ocp_t);
 
 /* Timer functions. */
 void rpl_schedule_dao(rpl_instance_t *);
+void rpl_schedule_dao_retransmission(rpl_instance_t *);
+void rpl_cancel_dao_retransmission(rpl_instance_t *);
 void rpl_reset_dio_timer(rpl_instance_t *);
 void rpl_reset_periodic_timer(void);
 
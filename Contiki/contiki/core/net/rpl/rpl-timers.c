@@ -191,6 +191,28 @@ rpl_reset_dio_timer(rpl_instance_t *instance)
 #endif /* RPL_LEAF_ONLY */
 }
 /************************************************************************/
+#if RPL_DAO_AGGREGATION
+static void
+adapt_dao_window(rpl_instance_t *instance)
+{
+  /* Adapt the coalescing window to the number of child targets that
+     arrived during it: widen it while our children are busy sending
+     DAOs, and narrow it again when they have quieted down. */
+  if(instance->dao_aggregated >= RPL_DAO_AGGREGATION_HIGH) {
+    instance->dao_window *= 2;
+    if(instance->dao_window > RPL_DAO_MAX_LATENCY) {
+      instance->dao_window = RPL_DAO_MAX_LATENCY;
+    }
+  } else if(instance->dao_aggregated == 0) {
+    instance->dao_window /= 2;
+  }
+  if(instance->dao_window < RPL_DAO_LATENCY) {
+    instance->dao_window = RPL_DAO_LATENCY;
+  }
+  instance->dao_aggregated = 0;
+}
+#endif /* RPL_DAO_AGGREGATION */
+/************************************************************************/
 static void
 handle_dao_timer(void *ptr)
 {
@@ -204,15 +226,51 @@ handle_dao_timer(void *ptr)
     return;
   }
 
+#if RPL_DAO_AGGREGATION && RPL_CONF_DAO_ACK
+  /* A retransmission does not end a coalescing window, so only the
+     first transmission of a DAO adapts it. */
+  if(instance->dao_transmissions == 0) {
+    adapt_dao_window(instance);
+  }
+#elif RPL_DAO_AGGREGATION
+  adapt_dao_window(instance);
+#endif /* RPL_DAO_AGGREGATION */
+
   /* Send the DAO to the DAO parent set -- the preferred parent in our case. */
   if(instance->current_dag->preferred_parent != NULL) {
+#if RPL_CONF_DAO_ACK
+    if(instance->dao_transmissions > RPL_DAO_MAX_RETRANSMISSIONS) {
+      PRINTF("RPL: No DAO ACK received - giving up\n");
+      instance->dao_transmissions = 0;
+      /* The child targets of the lost DAO go out in the next one. */
+      dao_output_requeue(instance);
+    } else {
+      if(instance->dao_transmissions > 0) {
+        PRINTF("RPL: No DAO ACK received - retransmitting DAO\n");
+        RPL_STAT(rpl_stats.dao_retransmissions++);
+      }
+      instance->dao_transmissions++;
+      PRINTF("RPL: handle_dao_timer - sending DAO\n");
+      /* Set the route lifetime to the default value. */
+      dao_output(instance->current_dag->preferred_parent, instance->default_lifetime);
+      rpl_schedule_dao_retransmission(instance);
+      return;
+    }
+#else /* RPL_CONF_DAO_ACK */
     PRINTF("RPL: handle_dao_timer - sending DAO\n");
     /* Set the route lifetime to the default value. */
     dao_output(instance->current_dag->preferred_parent, instance->default_lifetime);
+#endif /* RPL_CONF_DAO_ACK */
   } else {
     PRINTF("RPL: No suitable DAO parent\n");
   }
   ctimer_stop(&instance->dao_timer);
+
+  /* Targets that did not fit into the DAO go out in the next one. */
+  if(instance->current_dag->preferred_parent != NULL &&
+     dao_output_pending(instance)) {
+    rpl_schedule_dao(instance);
+  }
 }
 /************************************************************************/
 void
@@ -225,8 +283,16 @@ rpl_schedule_dao(rpl_instance_t *instance)
   if(!etimer_expired(&instance->dao_timer.etimer)) {
     PRINTF("RPL: DAO timer already scheduled\n");
   } else {
+#if RPL_DAO_AGGREGATION
+    if(instance->dao_window < RPL_DAO_LATENCY) {
+      instance->dao_window = RPL_DAO_LATENCY;
+    }
+    expiration_time = instance->dao_window / 2 +
+      (random_rand() % (instance->dao_window));
+#else /* RPL_DAO_AGGREGATION */
     expiration_time = RPL_DAO_LATENCY / 2 +
       (random_rand() % (RPL_DAO_LATENCY));
+#endif /* RPL_DAO_AGGREGATION */
     PRINTF("RPL: Scheduling DAO timer %u ticks in the future\n",
            (unsigned)expiration_time);
     ctimer_set(&instance->dao_timer, expiration_time,
@@ -234,3 +300,16 @@ rpl_schedule_dao(rpl_instance_t *instance)
   }
 }
 /************************************************************************/
+void
+rpl_schedule_dao_retransmission(rpl_instance_t *instance)
+{
+  ctimer_set(&instance->dao_timer, RPL_DAO_RETRANSMISSION_TIMEOUT,
+             handle_dao_timer, instance);
+}
+/************************************************************************/
+void
+rpl_cancel_dao_retransmission(rpl_instance_t *instance)
+{
+  ctimer_stop(&instance->dao_timer);
+}
+/************************************************************************/
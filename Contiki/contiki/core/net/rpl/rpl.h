@@ -224,6 +224,14 @@ struct rpl_instance {
   uint32_t dio_next_delay; /* delay for completion of dio interval */
   struct ctimer dio_timer;
   struct ctimer dao_timer;
+#if RPL_DAO_AGGREGATION
+  clock_time_t dao_window; /* current DAO coalescing window */
+  uint8_t dao_aggregated; /* child targets aggregated in this window */
+#endif /* RPL_DAO_AGGREGATION */
+#if RPL_CONF_DAO_ACK
+  uint8_t dao_seqno; /* sequence number of the unacknowledged DAO */
+  uint8_t dao_transmissions;
+#endif /* RPL_CONF_DAO_ACK */
 };
 
 /*---------------------------------------------------------------------------*/
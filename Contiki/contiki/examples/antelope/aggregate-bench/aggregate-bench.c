@@ -0,0 +1,433 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark and correctness check for the aggregation queries
+ *         of Antelope. The results are compared with a brute-force
+ *         evaluation of the same queries.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "cfs/cfs-coffee.h"
+
+#include "antelope.h"
+#include "relation.h"
+#include "storage.h"
+
+#define ROWS		2000
+#define NODES		6
+#define COLUMNS		5
+#define THRESHOLD	500
+
+
+static int nodes[ROWS];
+static int temps[ROWS];
+static unsigned long seed;
+
+static long result[NODES + 1][COLUMNS];
+static long expected[NODES + 1][COLUMNS];
+static int failures;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(aggregate_bench_process, "Antelope aggregation benchmark");
+AUTOSTART_PROCESSES(&aggregate_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+next_random(void)
+{
+  seed = seed * 1103515245UL + 12345;
+  return (unsigned)(seed >> 16) & 0x7fff;
+}
+/*---------------------------------------------------------------------------*/
+static int
+setup(void)
+{
+  relation_t *rel;
+  attribute_value_t values[3];
+  int i;
+
+  cfs_coffee_format();
+
+  if(DB_ERROR(db_query(NULL, "CREATE RELATION readings;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE node DOMAIN INT IN readings;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE temp DOMAIN INT IN readings;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE time DOMAIN LONG IN readings;"))) {
+    printf("Failed to create the relation\n");
+    return 0;
+  }
+
+  rel = relation_load("readings");
+  if(rel == NULL) {
+    printf("Failed to load the relation\n");
+    return 0;
+  }
+
+  values[0].domain = DOMAIN_INT;
+  values[1].domain = DOMAIN_INT;
+  values[2].domain = DOMAIN_LONG;
+
+  seed = 1;
+  for(i = 0; i < ROWS; i++) {
+    nodes[i] = next_random() % NODES;
+    temps[i] = next_random() % 1000;
+    VALUE_INT(&values[0]) = nodes[i];
+    VALUE_INT(&values[1]) = temps[i];
+    VALUE_LONG(&values[2]) = i;
+    if(DB_ERROR(relation_insert(rel, values))) {
+      printf("Insert failed at row %d\n", i);
+      relation_release(rel);
+      return 0;
+    }
+  }
+
+  relation_release(rel);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Run a query to completion and collect its result rows. */
+static int
+run_query(const char *query, unsigned long long *us)
+{
+  db_handle_t handle;
+  attribute_value_t value;
+  db_result_t r;
+  int rows;
+  int col;
+
+  *us = now_us();
+  r = db_query(&handle, "%s", query);
+  if(DB_ERROR(r)) {
+    printf("Query \"%s\" failed: %s\n", query, db_get_result_message(r));
+    db_free(&handle);
+    return -1;
+  }
+
+  rows = 0;
+  while(db_processing(&handle)) {
+    r = db_process(&handle);
+    if(r == DB_GOT_ROW) {
+      for(col = 0; rows <= NODES && col < handle.ncolumns; col++) {
+        if(DB_ERROR(db_get_value(&value, &handle, col))) {
+          break;
+        }
+        result[rows][col] = db_value_to_long(&value);
+      }
+      rows++;
+    } else if(r == DB_FINISHED) {
+      break;
+    } else if(DB_ERROR(r)) {
+      printf("Query \"%s\" failed: %s\n", query, db_get_result_message(r));
+      db_free(&handle);
+      return -1;
+    }
+  }
+  *us = now_us() - *us;
+
+  db_free(&handle);
+  return rows;
+}
+/*---------------------------------------------------------------------------*/
+/* Compute COUNT, SUM, MIN and MAX of temp for the rows with
+   temp > min, either grouped by node or not. */
+static int
+brute_force(int min, int grouped)
+{
+  long *row;
+  int groups;
+  int i, j;
+
+  groups = grouped ? NODES : 1;
+  for(i = 0; i < groups; i++) {
+    row = expected[i];
+    row[0] = i;
+    row[1] = 0;
+    row[2] = 0;
+    row[3] = 1000;
+    row[4] = -1;
+  }
+
+  for(j = 0; j < ROWS; j++) {
+    if(temps[j] <= min) {
+      continue;
+    }
+    row = expected[grouped ? nodes[j] : 0];
+    row[1]++;
+    row[2] += temps[j];
+    if(temps[j] < row[3]) {
+      row[3] = temps[j];
+    }
+    if(temps[j] > row[4]) {
+      row[4] = temps[j];
+    }
+  }
+
+  return groups;
+}
+/*---------------------------------------------------------------------------*/
+/* Compare the result columns with the brute-force columns in map. A
+   negative map entry denotes the mean of the group. */
+static void
+check(int rows, int columns, const int *map, int groups)
+{
+  long value;
+  int i, j;
+
+  if(rows != groups) {
+    printf("  FAIL: %d rows instead of %d\n", rows, groups);
+    failures++;
+    return;
+  }
+
+  for(i = 0; i < rows; i++) {
+    for(j = 0; j < columns; j++) {
+      if(map[j] < 0) {
+        value = expected[i][1] == 0 ? 0 : expected[i][2] / expected[i][1];
+      } else {
+        value = expected[i][map[j]];
+      }
+      if(result[i][j] != value) {
+        printf("  FAIL: row %d, column %d is %ld instead of %ld\n",
+               i, j, result[i][j], value);
+        failures++;
+        return;
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *query, int rows, unsigned long long us)
+{
+  printf("%s\n  %d rows, %lu us, %lu rows written\n", query, rows,
+         (unsigned long)us, storage_stats.rows_written);
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_aggregates(void)
+{
+  static const char totals[] =
+    "SELECT COUNT(temp), SUM(temp), MIN(temp), MAX(temp), MEAN(temp) "
+    "FROM readings;";
+  static const char filtered[] =
+    "SELECT COUNT(temp), SUM(temp), MIN(temp), MAX(temp) FROM readings "
+    "WHERE temp > 500;";
+  static const char grouped[] =
+    "SELECT node, COUNT(temp), MEAN(temp), MAX(temp) FROM readings "
+    "GROUP BY node;";
+  static const char grouped_filtered[] =
+    "SELECT MIN(temp), node FROM readings WHERE temp > 500 GROUP BY node;";
+  static const int totals_map[] = {1, 2, 3, 4, -1};
+  static const int grouped_map[] = {0, 1, -1, 4};
+  static const int grouped_filtered_map[] = {3, 0};
+  unsigned long long us;
+  int rows;
+
+  memset(&storage_stats, 0, sizeof(storage_stats));
+  rows = run_query(totals, &us);
+  report(totals, rows, us);
+  check(rows, 5, totals_map, brute_force(-1, 0));
+
+  memset(&storage_stats, 0, sizeof(storage_stats));
+  rows = run_query(filtered, &us);
+  report(filtered, rows, us);
+  check(rows, 4, totals_map, brute_force(THRESHOLD, 0));
+
+  memset(&storage_stats, 0, sizeof(storage_stats));
+  rows = run_query(grouped, &us);
+  report(grouped, rows, us);
+  check(rows, 4, grouped_map, brute_force(-1, 1));
+
+  memset(&storage_stats, 0, sizeof(storage_stats));
+  rows = run_query(grouped_filtered, &us);
+  report(grouped_filtered, rows, us);
+  check(rows, 2, grouped_filtered_map, brute_force(THRESHOLD, 1));
+}
+/*---------------------------------------------------------------------------*/
+/* Compute the per-node aggregates by storing the rows of each node in
+   a temporary relation, which was the only way before GROUP BY. */
+static void
+test_materialized(void)
+{
+  static const int map[] = {1, -1, 4};
+  unsigned long long us, total_us;
+  unsigned long rows_written;
+  char query[AQL_MAX_QUERY_LENGTH];
+  long groups[NODES][COLUMNS];
+  int node;
+
+  total_us = 0;
+  rows_written = 0;
+  for(node = 0; node < NODES; node++) {
+    memset(&storage_stats, 0, sizeof(storage_stats));
+    snprintf(query, sizeof(query),
+             "tmp <- SELECT temp FROM readings WHERE node = %d;", node);
+    if(run_query(query, &us) < 0) {
+      failures++;
+      return;
+    }
+    total_us += us;
+    rows_written += storage_stats.rows_written;
+
+    if(run_query("SELECT COUNT(temp), MEAN(temp), MAX(temp) FROM tmp;",
+                 &us) != 1) {
+      failures++;
+      return;
+    }
+    total_us += us;
+    memcpy(groups[node], result[0], sizeof(groups[node]));
+  }
+  db_query(NULL, "REMOVE RELATION tmp;");
+
+  printf("Per-node aggregates through a temporary relation\n"
+         "  %d rows, %lu us, %lu rows written\n",
+         NODES, (unsigned long)total_us, rows_written);
+
+  memcpy(result, groups, sizeof(groups));
+  check(NODES, 3, map, brute_force(-1, 1));
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_quantile(const char *query, int count, int quantile)
+{
+  unsigned long long us;
+  long estimate;
+  int below, equal;
+  int rank;
+  int error;
+  int rows;
+  int i;
+
+  memset(&storage_stats, 0, sizeof(storage_stats));
+  rows = run_query(query, &us);
+  report(query, rows, us);
+  if(rows != 1) {
+    printf("  FAIL: %d rows instead of 1\n", rows);
+    failures++;
+    return;
+  }
+  estimate = result[0][0];
+
+  /* Determine the distance between the rank of the reported value and
+     the rank of the quantile, which for the median is the lower
+     median. */
+  rank = (count - 1) * quantile / 100;
+  for(i = below = equal = 0; i < count; i++) {
+    if(temps[i] < estimate) {
+      below++;
+    } else if(temps[i] == estimate) {
+      equal++;
+    }
+  }
+  error = 0;
+  if(rank < below) {
+    error = below - rank;
+  } else if(rank >= below + equal) {
+    error = rank - (below + equal) + 1;
+  }
+
+  printf("  %d%% quantile %ld, rank error %d of %d rows\n",
+         quantile, estimate, error, count);
+
+  /* Up to AQL_MEDIAN_SAMPLES rows, the quantile is exact. Beyond that,
+     the sketch must keep the rank within 5% of the number of rows. */
+  if(count <= AQL_MEDIAN_SAMPLES ? error != 0 :
+     (long)error * 100 > (long)count * 5) {
+    printf("  FAIL: the quantile is not accurate enough\n");
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_quantiles(void)
+{
+  static const int quantiles[] = {10, 25, 75, 90};
+  char query[AQL_MAX_QUERY_LENGTH];
+  db_handle_t handle;
+  int i;
+
+  /* A median over up to AQL_MEDIAN_SAMPLES rows is exact. */
+  snprintf(query, sizeof(query),
+           "SELECT MEDIAN(temp) FROM readings WHERE time < %d;",
+           AQL_MEDIAN_SAMPLES);
+  check_quantile(query, AQL_MEDIAN_SAMPLES, 50);
+
+  check_quantile("SELECT MEDIAN(temp) FROM readings;", ROWS, 50);
+
+  for(i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); i++) {
+    snprintf(query, sizeof(query),
+             "SELECT QUANTILE(temp, %d) FROM readings WHERE time < %d;",
+             quantiles[i], AQL_MEDIAN_SAMPLES);
+    check_quantile(query, AQL_MEDIAN_SAMPLES, quantiles[i]);
+
+    snprintf(query, sizeof(query),
+             "SELECT QUANTILE(temp, %d) FROM readings;", quantiles[i]);
+    check_quantile(query, ROWS, quantiles[i]);
+  }
+
+  /* The quantile is given in percent. */
+  if(!DB_ERROR(db_query(&handle, "SELECT QUANTILE(temp, 101) FROM readings;"))) {
+    printf("  FAIL: a quantile above 100%% was accepted\n");
+    failures++;
+  }
+  db_free(&handle);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(aggregate_bench_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  db_init();
+
+  if(setup()) {
+    test_aggregates();
+    test_materialized();
+    test_quantiles();
+    printf("%d failures\n", failures);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
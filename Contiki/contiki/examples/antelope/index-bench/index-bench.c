@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark that compares the B+-tree index with the max-heap
+ *         index in Antelope: flash writes per inserted key, the time
+ *         to look up keys and ranges of keys, and the cost of loading
+ *         an index for an existing relation.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "cfs/cfs-coffee.h"
+
+#include "antelope.h"
+#include "index.h"
+#include "relation.h"
+#include "storage.h"
+
+#define MAX_ROWS	16000
+#define QUERIES		500
+#define RANGE		32
+
+static const char *index_types[] = {"MAXHEAP", "BTREE"};
+
+/* The larger relation needs more B+-tree nodes over its insertions
+   than DB_BTREE_NODE_LIMIT, so the B+-tree has to be compacted. */
+static const struct {
+  int rows;
+  int key_mask;
+} runs[] = {
+  {4000, 0x3fff},
+  {MAX_ROWS, 0xffff}
+};
+
+static int rows;
+static int key_mask;
+static int keys[MAX_ROWS];
+static int failures;
+static unsigned long seed;
+static relation_t *rel;
+static attribute_t *attr;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(index_bench_process, "Antelope index benchmark");
+AUTOSTART_PROCESSES(&index_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+/* The max-heap index reseeds the random generator of Contiki, so the
+   benchmark uses a generator of its own. */
+static unsigned
+next_random(void)
+{
+  seed = seed * 1103515245UL + 12345;
+  return (unsigned)(seed >> 16) & 0x7fff;
+}
+/*---------------------------------------------------------------------------*/
+static int
+setup(const char *type)
+{
+  db_query(NULL, "REMOVE RELATION samples;");
+  cfs_coffee_format();
+
+  if(DB_ERROR(db_query(NULL, "CREATE RELATION samples;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE id DOMAIN LONG IN samples;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE value DOMAIN INT IN samples;"))) {
+    printf("Failed to create the relation\n");
+    return 0;
+  }
+
+  if(type != NULL &&
+     DB_ERROR(db_query(NULL, "CREATE INDEX samples.value TYPE %s;", type))) {
+    printf("Failed to create a %s index\n", type);
+    return 0;
+  }
+
+  rel = relation_load("samples");
+  if(rel == NULL) {
+    printf("Failed to load the relation\n");
+    return 0;
+  }
+  attr = relation_attribute_get(rel, "value");
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+insert_rows(void)
+{
+  attribute_value_t values[2];
+  int i;
+
+  values[0].domain = DOMAIN_LONG;
+  values[1].domain = DOMAIN_INT;
+
+  seed = 1;
+  for(i = 0; i < rows; i++) {
+    keys[i] = next_random() & key_mask;
+    VALUE_LONG(&values[0]) = i;
+    VALUE_INT(&values[1]) = keys[i];
+    if(DB_ERROR(relation_insert(rel, values))) {
+      printf("Insert failed at row %d\n", i);
+      failures++;
+      return 0;
+    }
+  }
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report_writes(const char *what, unsigned long long us)
+{
+  printf("  %s: %lu us, %lu.%02lu writes and %lu bytes per key, "
+         "%lu compactions\n",
+         what, (unsigned long)us,
+         storage_stats.writes / rows,
+         storage_stats.writes * 100 / rows % 100,
+         storage_stats.bytes_written / rows, storage_stats.compactions);
+}
+/*---------------------------------------------------------------------------*/
+/* Look up the keys in [min, max] and check the result against the
+   keys that were inserted. */
+static int
+query(int min, int max)
+{
+  index_iterator_t iterator;
+  attribute_value_t min_value, max_value;
+  tuple_id_t tuple_id;
+  int expected;
+  int found;
+  int i;
+
+  min_value.domain = max_value.domain = DOMAIN_INT;
+  VALUE_INT(&min_value) = min;
+  VALUE_INT(&max_value) = max;
+
+  if(DB_ERROR(index_get_iterator(&iterator, attr->index,
+                                 &min_value, &max_value))) {
+    return -1;
+  }
+
+  found = 0;
+  while((tuple_id = index_get_next(&iterator)) != INVALID_TUPLE) {
+    if(tuple_id >= rows || keys[tuple_id] < min || keys[tuple_id] > max) {
+      return -1;
+    }
+    found++;
+  }
+
+  for(i = expected = 0; i < rows; i++) {
+    if(keys[i] >= min && keys[i] <= max) {
+      expected++;
+    }
+  }
+
+  return found == expected ? found : -1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_queries(int range)
+{
+  unsigned long long us;
+  unsigned long found;
+  int key;
+  int i, r;
+
+  memset(&storage_stats, 0, sizeof(storage_stats));
+  found = 0;
+  us = 0;
+  seed = 2;
+  for(i = 0; i < QUERIES; i++) {
+    key = keys[next_random() % rows];
+    us -= now_us();
+    r = query(key, key + range);
+    us += now_us();
+    if(r < 0) {
+      printf("  Wrong result for the range (%d,%d)\n", key, key + range);
+      failures++;
+      return;
+    }
+    found += r;
+  }
+
+  printf("  %s: %lu us and %lu reads per query, %lu.%02lu keys found\n",
+         range == 0 ? "lookup" : "range ", (unsigned long)(us / QUERIES),
+         storage_stats.reads / QUERIES,
+         found / QUERIES, found * 100 / QUERIES % 100);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(index_bench_process, ev, data)
+{
+  static unsigned long long us;
+  static int i, r;
+
+  PROCESS_BEGIN();
+
+  db_init();
+
+  for(r = 0; r < sizeof(runs) / sizeof(runs[0]); r++) {
+    rows = runs[r].rows;
+    key_mask = runs[r].key_mask;
+
+    for(i = 0; i < sizeof(index_types) / sizeof(index_types[0]); i++) {
+      printf("%s index, %d keys:\n", index_types[i], rows);
+
+      /* Insert rows into a relation with an index. */
+      if(!setup(index_types[i])) {
+        failures++;
+        continue;
+      }
+      memset(&storage_stats, 0, sizeof(storage_stats));
+      us = now_us();
+      if(insert_rows()) {
+        report_writes("insert", now_us() - us);
+        bench_queries(0);
+        bench_queries(RANGE);
+      }
+      relation_release(rel);
+
+      /* Create the index after the rows have been inserted. */
+      if(!setup(NULL)) {
+        failures++;
+        continue;
+      }
+      if(!insert_rows()) {
+        relation_release(rel);
+        continue;
+      }
+      memset(&storage_stats, 0, sizeof(storage_stats));
+      us = now_us();
+      if(DB_ERROR(db_query(NULL, "CREATE INDEX samples.value TYPE %s;",
+                           index_types[i]))) {
+        printf("Failed to create a %s index\n", index_types[i]);
+        failures++;
+        relation_release(rel);
+        continue;
+      }
+      while(!index_exists(attr)) {
+        PROCESS_PAUSE();
+      }
+      report_writes("load  ", now_us() - us);
+      bench_queries(0);
+      relation_release(rel);
+    }
+  }
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,367 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for the join strategies of Antelope. A relation of
+ *         readings is joined with a relation of node metadata, and the
+ *         result is compared with a brute-force evaluation.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "cfs/cfs-coffee.h"
+
+#include "antelope.h"
+#include "relation.h"
+#include "storage.h"
+
+#define READINGS	2000
+
+static const int meta_sizes[] = {50, 200, 800};
+
+static const struct {
+  const char *name;
+  const char *index_type;
+  int sorted;
+  int strategy;
+} strategies[] = {
+  {"index", "BTREE", 0, DB_JOIN_INDEX},
+  {"hash ", NULL, 0, DB_JOIN_HASH},
+  {"merge", "INLINE", 1, DB_JOIN_MERGE}
+};
+
+static int reading_nodes[READINGS];
+static int reading_temps[READINGS];
+static int rooms[800];
+static int meta_order[800];
+static int reading_order[READINGS];
+static unsigned long seed;
+static int failures;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(join_bench_process, "Antelope join benchmark");
+AUTOSTART_PROCESSES(&join_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+next_random(void)
+{
+  seed = seed * 1103515245UL + 12345;
+  return (unsigned)(seed >> 16) & 0x7fff;
+}
+/*---------------------------------------------------------------------------*/
+static void
+shuffle(int *order, int count)
+{
+  int i, j, tmp;
+
+  for(i = count - 1; i > 0; i--) {
+    j = next_random() % (i + 1);
+    tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Generate the data for a metadata relation of the given size. About
+   a fifth of the readings refer to nodes that have no metadata. */
+static void
+generate(int meta_size)
+{
+  int i, node, n;
+
+  seed = meta_size;
+  for(i = 0; i < meta_size; i++) {
+    rooms[i] = next_random() % 100;
+  }
+  for(i = 0; i < READINGS; i++) {
+    reading_nodes[i] = next_random() % (meta_size + meta_size / 4);
+    reading_temps[i] = next_random() % 1000;
+  }
+
+  /* Store the readings and the metadata either in ascending order of
+     the node, or in a random order. */
+  for(node = n = 0; node < meta_size + meta_size / 4; node++) {
+    for(i = 0; i < READINGS; i++) {
+      if(reading_nodes[i] == node) {
+        reading_order[n++] = i;
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+setup(int meta_size, const char *index_type, int sorted)
+{
+  relation_t *rel;
+  attribute_value_t values[2];
+  int i, j;
+
+  db_query(NULL, "REMOVE RELATION readings;");
+  db_query(NULL, "REMOVE RELATION meta;");
+  cfs_coffee_format();
+
+  if(DB_ERROR(db_query(NULL, "CREATE RELATION readings;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE node DOMAIN INT IN readings;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE temp DOMAIN INT IN readings;")) ||
+     DB_ERROR(db_query(NULL, "CREATE RELATION meta;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE node DOMAIN INT IN meta;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE room DOMAIN INT IN meta;"))) {
+    printf("Failed to create the relations\n");
+    return 0;
+  }
+
+  /* A merge join needs both relations to be declared as sorted. */
+  if(index_type != NULL &&
+     (DB_ERROR(db_query(NULL, "CREATE INDEX meta.node TYPE %s;", index_type)) ||
+      (sorted && DB_ERROR(db_query(NULL, "CREATE INDEX readings.node TYPE %s;",
+                                   index_type))))) {
+    printf("Failed to create a %s index\n", index_type);
+    return 0;
+  }
+
+  values[0].domain = DOMAIN_INT;
+  values[1].domain = DOMAIN_INT;
+
+  for(i = 0; i < meta_size; i++) {
+    meta_order[i] = i;
+  }
+  if(!sorted) {
+    shuffle(meta_order, meta_size);
+  }
+  rel = relation_load("meta");
+  for(i = 0; rel != NULL && i < meta_size; i++) {
+    VALUE_INT(&values[0]) = meta_order[i];
+    VALUE_INT(&values[1]) = rooms[meta_order[i]];
+    if(DB_ERROR(relation_insert(rel, values))) {
+      break;
+    }
+  }
+  if(rel == NULL || i < meta_size) {
+    printf("Failed to insert the metadata\n");
+    return 0;
+  }
+  relation_release(rel);
+
+  rel = relation_load("readings");
+  for(i = 0; rel != NULL && i < READINGS; i++) {
+    j = sorted ? reading_order[i] : i;
+    VALUE_INT(&values[0]) = reading_nodes[j];
+    VALUE_INT(&values[1]) = reading_temps[j];
+    if(DB_ERROR(relation_insert(rel, values))) {
+      break;
+    }
+  }
+  if(rel == NULL || i < READINGS) {
+    printf("Failed to insert the readings\n");
+    return 0;
+  }
+  relation_release(rel);
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_join(int meta_size, int s)
+{
+  db_handle_t handle;
+  attribute_value_t temp, room;
+  unsigned long long us;
+  unsigned long sum, expected_sum;
+  long rows, expected_rows;
+  db_result_t r;
+  int i;
+
+  memset(&storage_stats, 0, sizeof(storage_stats));
+  us = now_us();
+  r = db_query(&handle, "JOIN meta, readings ON node PROJECT temp, room;");
+  if(DB_ERROR(r)) {
+    printf("  %s: the join failed: %s\n", strategies[s].name,
+           db_get_result_message(r));
+    db_free(&handle);
+    failures++;
+    return;
+  }
+
+  rows = 0;
+  sum = 0;
+  while(db_processing(&handle)) {
+    r = db_process(&handle);
+    if(r == DB_GOT_ROW) {
+      if(DB_ERROR(db_get_value(&temp, &handle, 0)) ||
+         DB_ERROR(db_get_value(&room, &handle, 1))) {
+        break;
+      }
+      sum += db_value_to_long(&temp) * db_value_to_long(&room);
+      rows++;
+    } else if(r == DB_FINISHED) {
+      break;
+    } else if(DB_ERROR(r)) {
+      printf("  %s: processing failed: %s\n", strategies[s].name,
+             db_get_result_message(r));
+      break;
+    }
+  }
+  us = now_us() - us;
+
+  for(i = 0, expected_rows = expected_sum = 0; i < READINGS; i++) {
+    if(reading_nodes[i] < meta_size) {
+      expected_rows++;
+      expected_sum += reading_temps[i] * rooms[reading_nodes[i]];
+    }
+  }
+
+  printf("  %s: %8lu us, %5lu tuple reads, %5lu index reads, %ld rows\n",
+         strategies[s].name, (unsigned long)us, storage_stats.row_reads,
+         storage_stats.reads, rows);
+
+  if(handle.join_strategy != strategies[s].strategy) {
+    printf("  FAIL: the planner chose strategy %d\n", handle.join_strategy);
+    failures++;
+  }
+  if(rows != expected_rows || sum != expected_sum) {
+    printf("  FAIL: expected %ld rows with checksum %lu, got checksum %lu\n",
+           expected_rows, expected_sum, sum);
+    failures++;
+  }
+
+  db_free(&handle);
+}
+/*---------------------------------------------------------------------------*/
+/* Both relations have a val attribute. It must be taken from the left
+   relation of the query, also when the planner swaps the relations
+   because the left one is indexed or smaller. */
+static void
+check_projection(int s)
+{
+  db_handle_t handle;
+  attribute_value_t val;
+  db_result_t r;
+  long rows;
+
+  db_query(NULL, "REMOVE RELATION readings;");
+  db_query(NULL, "REMOVE RELATION meta;");
+  db_query(NULL, "REMOVE RELATION lhs;");
+  db_query(NULL, "REMOVE RELATION rhs;");
+  cfs_coffee_format();
+  if(DB_ERROR(db_query(NULL, "CREATE RELATION lhs;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE id DOMAIN INT IN lhs;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE val DOMAIN INT IN lhs;")) ||
+     DB_ERROR(db_query(NULL, "CREATE RELATION rhs;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE id DOMAIN INT IN rhs;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE val DOMAIN INT IN rhs;")) ||
+     (strategies[s].index_type != NULL &&
+      DB_ERROR(db_query(NULL, "CREATE INDEX lhs.id TYPE %s;",
+                        strategies[s].index_type))) ||
+     (strategies[s].sorted &&
+      DB_ERROR(db_query(NULL, "CREATE INDEX rhs.id TYPE %s;",
+                        strategies[s].index_type))) ||
+     DB_ERROR(db_query(NULL, "INSERT (1, 101) INTO lhs;")) ||
+     DB_ERROR(db_query(NULL, "INSERT (2, 102) INTO lhs;")) ||
+     DB_ERROR(db_query(NULL, "INSERT (1, 201) INTO rhs;")) ||
+     DB_ERROR(db_query(NULL, "INSERT (2, 202) INTO rhs;")) ||
+     DB_ERROR(db_query(NULL, "INSERT (3, 203) INTO rhs;"))) {
+    printf("  %s: failed to create the projection test\n", strategies[s].name);
+    failures++;
+    return;
+  }
+
+  r = db_query(&handle, "JOIN lhs, rhs ON id PROJECT val;");
+  rows = 0;
+  while(!DB_ERROR(r) && db_processing(&handle)) {
+    r = db_process(&handle);
+    if(r == DB_GOT_ROW) {
+      if(DB_ERROR(db_get_value(&val, &handle, 0)) ||
+         db_value_to_long(&val) / 100 != 1) {
+        printf("  FAIL: %s join projected val from the right relation\n",
+               strategies[s].name);
+        failures++;
+        db_free(&handle);
+        return;
+      }
+      rows++;
+    } else if(r == DB_FINISHED) {
+      break;
+    }
+  }
+  if(DB_ERROR(r) || rows != 2) {
+    printf("  FAIL: %s join of lhs and rhs returned %ld rows\n",
+           strategies[s].name, rows);
+    failures++;
+  }
+
+  db_free(&handle);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(join_bench_process, ev, data)
+{
+  static int i, s;
+
+  PROCESS_BEGIN();
+
+  db_init();
+
+  for(i = 0; i < sizeof(meta_sizes) / sizeof(meta_sizes[0]); i++) {
+    printf("%d readings joined with %d metadata rows:\n",
+           READINGS, meta_sizes[i]);
+    generate(meta_sizes[i]);
+    for(s = 0; s < sizeof(strategies) / sizeof(strategies[0]); s++) {
+      if(!setup(meta_sizes[i], strategies[s].index_type,
+                strategies[s].sorted)) {
+        failures++;
+        continue;
+      }
+      run_join(meta_sizes[i], s);
+    }
+  }
+
+  for(s = 0; s < sizeof(strategies) / sizeof(strategies[0]); s++) {
+    check_projection(s);
+  }
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,324 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark that compares the interpreted evaluation of WHERE
+ *         predicates in Antelope with the evaluation of the programs
+ *         that lvm_compile() generates, and checks that both agree.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "cfs/cfs-coffee.h"
+
+#include "antelope.h"
+#include "aql.h"
+#include "lvm.h"
+#include "relation.h"
+#include "storage.h"
+
+#define EVALUATIONS	20000
+#define ROWS		2000
+#define VALUE_MASK	0x3ff
+
+struct predicate {
+  const char *condition;
+  int (*evaluate)(long a, long b, long c);
+};
+
+static int
+simple(long a, long b, long c)
+{
+  return a > 500;
+}
+
+static int
+range(long a, long b, long c)
+{
+  return a >= 100 && a < 300;
+}
+
+static int
+compound(long a, long b, long c)
+{
+  return (a > 100 && b < 50) || c == 7;
+}
+
+static int
+arithmetic(long a, long b, long c)
+{
+  return a + b > 1000;
+}
+
+static int
+reversed(long a, long b, long c)
+{
+  return 700 > b && a != 3;
+}
+
+static const struct predicate predicates[] = {
+  {"a > 500", simple},
+  {"a >= 100 AND a < 300", range},
+  {"a > 100 AND b < 50 OR c = 7", compound},
+  {"a + b > 1000", arithmetic},
+  {"700 > b AND a <> 3", reversed}
+};
+
+#define PREDICATE_COUNT	(sizeof(predicates) / sizeof(predicates[0]))
+
+static long values[EVALUATIONS][3];
+static unsigned char results[EVALUATIONS];
+static long rows[ROWS][3];
+static unsigned long seed;
+static int failures;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(predicate_bench_process, "Antelope predicate benchmark");
+AUTOSTART_PROCESSES(&predicate_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+next_random(void)
+{
+  seed = seed * 1103515245UL + 12345;
+  return (unsigned)(seed >> 16) & 0x7fff;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+rate(unsigned long long us)
+{
+  return us == 0 ? 0 : (unsigned long)(EVALUATIONS * 1000000ULL / us);
+}
+/*---------------------------------------------------------------------------*/
+/* Evaluate all value triples with the current program of the instance,
+   and check the results against the C version of the predicate. */
+static unsigned long long
+evaluate(lvm_instance_t *p, const struct predicate *predicate)
+{
+  static const char *names[] = {"a", "b", "c"};
+  variable_id_t ids[3];
+  operand_value_t value;
+  unsigned long long us;
+  lvm_status_t status;
+  int i, j;
+
+  for(j = 0; j < 3; j++) {
+    ids[j] = lvm_get_variable_id((char *)names[j]);
+  }
+
+  us = now_us();
+  for(i = 0; i < EVALUATIONS; i++) {
+    for(j = 0; j < 3; j++) {
+      value.l = values[i][j];
+      lvm_set_variable_value_by_id(ids[j], value);
+    }
+    status = lvm_execute(p);
+    results[i] = status == TRUE;
+  }
+  us = now_us() - us;
+
+  for(i = 0; i < EVALUATIONS; i++) {
+    if(results[i] != predicate->evaluate(values[i][0], values[i][1],
+                                         values[i][2])) {
+      printf("  FAIL: wrong result for a=%ld b=%ld c=%ld\n",
+             values[i][0], values[i][1], values[i][2]);
+      failures++;
+      break;
+    }
+  }
+
+  return us;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_predicate(const struct predicate *predicate)
+{
+  static aql_adt_t adt;
+  static char query[AQL_MAX_QUERY_LENGTH];
+  unsigned long long interpreted, compiled;
+  lvm_instance_t *p;
+
+  snprintf(query, sizeof(query), "SELECT a FROM samples WHERE %s;",
+           predicate->condition);
+  if(AQL_ERROR(aql_parse(&adt, query)) || adt.lvm_instance == NULL) {
+    printf("  FAIL: could not parse \"%s\"\n", query);
+    failures++;
+    return;
+  }
+  p = adt.lvm_instance;
+
+  interpreted = evaluate(p, predicate);
+  if(LVM_ERROR(lvm_compile(p))) {
+    printf("  FAIL: could not compile \"%s\"\n", predicate->condition);
+    failures++;
+    return;
+  }
+  compiled = evaluate(p, predicate);
+
+  printf("  %-32s %9lu/s interpreted, %9lu/s compiled\n",
+         predicate->condition, rate(interpreted), rate(compiled));
+}
+/*---------------------------------------------------------------------------*/
+static int
+setup(void)
+{
+  relation_t *rel;
+  attribute_value_t row[3];
+  int i, j;
+
+  db_query(NULL, "REMOVE RELATION samples;");
+  cfs_coffee_format();
+
+  if(DB_ERROR(db_query(NULL, "CREATE RELATION samples;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE a DOMAIN INT IN samples;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE b DOMAIN INT IN samples;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE c DOMAIN INT IN samples;"))) {
+    printf("Failed to create the relation\n");
+    return 0;
+  }
+
+  rel = relation_load("samples");
+  if(rel == NULL) {
+    printf("Failed to load the relation\n");
+    return 0;
+  }
+
+  for(i = 0; i < ROWS; i++) {
+    for(j = 0; j < 3; j++) {
+      rows[i][j] = next_random() & VALUE_MASK;
+      row[j].domain = DOMAIN_INT;
+      VALUE_INT(&row[j]) = rows[i][j];
+    }
+    if(DB_ERROR(relation_insert(rel, row))) {
+      printf("Insert failed at row %d\n", i);
+      relation_release(rel);
+      return 0;
+    }
+  }
+  relation_release(rel);
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_select(const struct predicate *predicate)
+{
+  db_handle_t handle;
+  unsigned long long us;
+  long count, expected;
+  db_result_t r;
+  int i;
+
+  us = now_us();
+  r = db_query(&handle, "SELECT a FROM samples WHERE %s;",
+               predicate->condition);
+  if(DB_ERROR(r)) {
+    printf("  FAIL: the query failed: %s\n", db_get_result_message(r));
+    db_free(&handle);
+    failures++;
+    return;
+  }
+
+  count = 0;
+  while(db_processing(&handle)) {
+    r = db_process(&handle);
+    if(r == DB_GOT_ROW) {
+      count++;
+    } else if(r == DB_FINISHED) {
+      break;
+    } else if(DB_ERROR(r)) {
+      printf("  FAIL: processing failed: %s\n", db_get_result_message(r));
+      failures++;
+      break;
+    }
+  }
+  us = now_us() - us;
+  db_free(&handle);
+
+  for(i = expected = 0; i < ROWS; i++) {
+    expected += predicate->evaluate(rows[i][0], rows[i][1], rows[i][2]);
+  }
+
+  printf("  %-32s %8lu us, %ld rows\n", predicate->condition,
+         (unsigned long)us, count);
+  if(count != expected) {
+    printf("  FAIL: expected %ld rows\n", expected);
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(predicate_bench_process, ev, data)
+{
+  static int i, j;
+
+  PROCESS_BEGIN();
+
+  db_init();
+
+  seed = 1;
+  for(i = 0; i < EVALUATIONS; i++) {
+    for(j = 0; j < 3; j++) {
+      values[i][j] = next_random() & VALUE_MASK;
+    }
+  }
+
+  printf("Predicate evaluations, %d value sets:\n", EVALUATIONS);
+  for(i = 0; i < PREDICATE_COUNT; i++) {
+    bench_predicate(&predicates[i]);
+  }
+
+  if(setup()) {
+    printf("SELECT queries over %d rows:\n", ROWS);
+    for(i = 0; i < PREDICATE_COUNT; i++) {
+      bench_select(&predicates[i]);
+    }
+  } else {
+    failures++;
+  }
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
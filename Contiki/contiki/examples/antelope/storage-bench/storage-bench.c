@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for inserting and scanning rows in Antelope
+ *         relations stored in Coffee. Build with
+ *         DB_STORAGE_BUFFER_SIZE=0 to compare with reading and
+ *         writing one row at a time, or with DB_STORAGE_WRITE_BUFFER=1
+ *         to append rows in blocks as well.
+ */
+
+#include <stdio.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "cfs/cfs-coffee.h"
+
+#include "antelope.h"
+#include "relation.h"
+#include "storage.h"
+
+static const unsigned long sizes[] = {10000, 50000, 100000};
+
+/*---------------------------------------------------------------------------*/
+PROCESS(storage_bench_process, "Antelope storage benchmark");
+AUTOSTART_PROCESSES(&storage_bench_process);
+/*---------------------------------------------------------------------------*/
+/* The native clock ticks in milliseconds, which is too coarse for
+   the smaller relations, so the time is taken from the host. */
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+rate(unsigned long rows, unsigned long long us)
+{
+  if(us == 0) {
+    us = 1;
+  }
+  return (unsigned long)(rows * 1000000ULL / us);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(unsigned long rows)
+{
+  relation_t *rel;
+  attribute_value_t values[2];
+  unsigned char row[DB_MAX_ATTRIBUTES_PER_RELATION * DB_MAX_ELEMENT_SIZE];
+  unsigned long long insert_time, scan_time;
+  tuple_id_t tuple_id;
+  unsigned long i;
+
+  /* Start from an empty file system, so that each tuple file can be
+     reserved in one piece. */
+  db_query(NULL, "REMOVE RELATION samples;");
+  cfs_coffee_format();
+
+  if(DB_ERROR(db_query(NULL, "CREATE RELATION samples;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE id DOMAIN LONG IN samples;")) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE value DOMAIN INT IN samples;"))) {
+    printf("Failed to create the relation\n");
+    return;
+  }
+
+  rel = relation_load("samples");
+  if(rel == NULL) {
+    printf("Failed to load the relation\n");
+    return;
+  }
+
+  values[0].domain = DOMAIN_LONG;
+  values[1].domain = DOMAIN_INT;
+
+  insert_time = now_us();
+  for(i = 0; i < rows; i++) {
+    VALUE_LONG(&values[0]) = i;
+    VALUE_INT(&values[1]) = i & 0x7fff;
+    if(DB_ERROR(relation_insert(rel, values))) {
+      printf("Insert failed at row %lu\n", i);
+      break;
+    }
+  }
+  /* Write out the buffered rows; they must all be in the tuple file
+     afterwards. */
+  if(DB_ERROR(db_flush())) {
+    printf("Failed to flush the buffered rows\n");
+  }
+  insert_time = now_us() - insert_time;
+
+  if(cfs_seek(rel->tuple_storage, 0, CFS_SEEK_END) !=
+     (cfs_offset_t)(rows * rel->row_length)) {
+    printf("The tuple file lacks rows after db_flush()\n");
+  }
+  storage_get_row_amount(rel, &tuple_id);
+  if(tuple_id != rows) {
+    printf("Stored %lu of %lu rows\n", (unsigned long)tuple_id, rows);
+  }
+
+  scan_time = now_us();
+  for(tuple_id = 0;
+      storage_get_row(rel, &tuple_id, row) == DB_OK;
+      tuple_id++) {
+  }
+  scan_time = now_us() - scan_time;
+
+  printf("%lu rows: insert %lu rows/s, scan %lu rows/s (%lu rows)\n",
+         rows, rate(i, insert_time), rate(tuple_id, scan_time),
+         (unsigned long)tuple_id);
+
+  relation_release(rel);
+}
+/*---------------------------------------------------------------------------*/
+/* Insert rows with queries until the tuple file is full. Every insert
+   that succeeded must have stored its row. */
+static void
+fill_relation(void)
+{
+  relation_t *rel;
+  tuple_id_t before, after;
+  unsigned long i;
+  db_result_t result;
+
+  rel = relation_load("samples");
+  if(rel == NULL || DB_ERROR(storage_get_row_amount(rel, &before))) {
+    printf("Failed to load the relation\n");
+    return;
+  }
+  relation_release(rel);
+
+  for(i = 0; i < 1000000; i++) {
+    result = db_query(NULL, "INSERT (%lu, 1) INTO samples;", i);
+    if(DB_ERROR(result)) {
+      break;
+    }
+  }
+
+  rel = relation_load("samples");
+  if(rel == NULL || DB_ERROR(storage_get_row_amount(rel, &after))) {
+    printf("Failed to load the relation\n");
+    return;
+  }
+  relation_release(rel);
+
+  printf("Full relation: %lu inserts succeeded, %lu rows stored; %s\n",
+         i, (unsigned long)(after - before),
+         DB_ERROR(result) && after - before == i ? "OK" : "FAIL");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(storage_bench_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  db_init();
+
+  for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    bench(sizes[i]);
+  }
+  fill_relation();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
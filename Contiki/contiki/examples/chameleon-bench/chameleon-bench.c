@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for packing and unpacking Chameleon headers for
+ *         the collect, runicast and mesh channels. Build with
+ *         CHAMELEON_CONF_BITOPT_LAYOUTS=0 to compare with the generic
+ *         bit packer; the header checksums must be the same.
+ */
+
+#include "contiki.h"
+#include "net/rime.h"
+#include "lib/crc16.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define ROUNDS 200000UL
+
+static const struct packetbuf_attrlist collect_attributes[] =
+  { COLLECT_ATTRIBUTES PACKETBUF_ATTR_LAST };
+static const struct packetbuf_attrlist runicast_attributes[] =
+  { RUNICAST_ATTRIBUTES PACKETBUF_ATTR_LAST };
+static const struct packetbuf_attrlist mesh_attributes[] =
+  { MULTIHOP_ATTRIBUTES PACKETBUF_ATTR_LAST };
+
+/*---------------------------------------------------------------------------*/
+PROCESS(chameleon_bench_process, "Chameleon benchmark");
+AUTOSTART_PROCESSES(&chameleon_bench_process);
+/*---------------------------------------------------------------------------*/
+static void
+set_attributes(const struct packetbuf_attrlist *a)
+{
+  rimeaddr_t addr;
+  int i;
+
+  for(; a->type != PACKETBUF_ATTR_NONE; ++a) {
+    if(PACKETBUF_IS_ADDR(a->type)) {
+      for(i = 0; i < sizeof(rimeaddr_t); ++i) {
+        addr.u8[i] = random_rand();
+      }
+      packetbuf_set_addr(a->type, &addr);
+    } else if(a->len < 16) {
+      packetbuf_set_attr(a->type, random_rand() & ((1 << a->len) - 1));
+    } else {
+      packetbuf_set_attr(a->type, random_rand());
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static packetbuf_attr_t attrs[PACKETBUF_ATTR_MAX];
+static rimeaddr_t addrs[PACKETBUF_NUM_ADDRS];
+/*---------------------------------------------------------------------------*/
+static void
+save_attributes(const struct packetbuf_attrlist *a)
+{
+  for(; a->type != PACKETBUF_ATTR_NONE; ++a) {
+    if(PACKETBUF_IS_ADDR(a->type)) {
+      rimeaddr_copy(&addrs[a->type - PACKETBUF_ADDR_FIRST],
+                    packetbuf_addr(a->type));
+    } else {
+      attrs[a->type] = packetbuf_attr(a->type);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+check_attributes(const struct packetbuf_attrlist *a)
+{
+  for(; a->type != PACKETBUF_ATTR_NONE; ++a) {
+    if(PACKETBUF_IS_ADDR(a->type)) {
+      if(!rimeaddr_cmp(packetbuf_addr(a->type),
+                       &addrs[a->type - PACKETBUF_ADDR_FIRST])) {
+        return 0;
+      }
+    } else if(packetbuf_attr(a->type) != attrs[a->type]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(const char *name, uint16_t channelno,
+      const struct packetbuf_attrlist *attrlist)
+{
+  static struct channel c;
+  static uint8_t frame[PACKETBUF_SIZE + PACKETBUF_HDR_SIZE];
+  clock_time_t pack_time, unpack_time;
+  unsigned long i;
+  int len, ok;
+
+  channel_open(&c, channelno);
+  channel_set_attributes(channelno, attrlist);
+
+  packetbuf_clear();
+  set_attributes(attrlist);
+  save_attributes(attrlist);
+
+  pack_time = clock_time();
+  for(i = 0; i < ROUNDS; ++i) {
+    packetbuf_clear_hdr();
+    chameleon_create(&c);
+  }
+  pack_time = clock_time() - pack_time;
+  len = packetbuf_copyto(frame);
+
+  unpack_time = clock_time();
+  for(i = 0; i < ROUNDS; ++i) {
+    packetbuf_copyfrom(frame, len);
+    chameleon_parse();
+  }
+  unpack_time = clock_time() - unpack_time;
+  ok = check_attributes(attrlist);
+
+  printf("%s: header %d bits, checksum 0x%04x, %s, pack %lu ns, unpack %lu ns\n",
+         name, c.hdrsize, crc16_data(frame, len, 0), ok ? "ok" : "MISMATCH",
+         (unsigned long)(pack_time * (1000000000UL / CLOCK_SECOND) / ROUNDS),
+         (unsigned long)(unpack_time * (1000000000UL / CLOCK_SECOND) / ROUNDS));
+
+  channel_close(&c);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(chameleon_bench_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  random_init(0);
+  bench("collect", 130, collect_attributes);
+  bench("runicast", 144, runicast_attributes);
+  bench("mesh", 132, mesh_attributes);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for observe notifications of er-coap-07 on the
+ *         native platform. Notifications are sent to many observers
+ *         with mixed token lengths, and every datagram is parsed and
+ *         checked. Confirmable notifications are retransmitted from
+ *         the timer wheel, replaced while in flight and acknowledged.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "er-coap-07.h"
+#include "er-coap-07-observing.h"
+#include "er-coap-07-transactions.h"
+
+#define MAX_OBSERVERS	500
+#define ROUNDS		200
+#define BASE_PORT	20000
+
+static const int observer_counts[] = {10, 100, 500};
+
+static struct {
+  uip_ipaddr_t addr;
+  uint8_t token[COAP_TOKEN_LEN];
+  uint8_t token_len;
+  uint16_t mid;
+  uint8_t type;
+  unsigned long messages;
+} clients[MAX_OBSERVERS];
+
+static int checking;
+static uint32_t expected_observe;
+static char payload[64];
+static unsigned long sent;
+static int failures;
+
+RESOURCE(sensor, METHOD_GET, "sensors/temp", "obs");
+
+/*---------------------------------------------------------------------------*/
+PROCESS(coap_observe_bench_process, "CoAP observe benchmark");
+AUTOSTART_PROCESSES(&coap_observe_bench_process);
+/*---------------------------------------------------------------------------*/
+void
+sensor_handler(void *request, void *response, uint8_t *buffer,
+               uint16_t preferred_size, int32_t *offset)
+{
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+fail(const char *message, int client)
+{
+  if(failures++ < 10) {
+    printf("  FAIL: %s (observer %d)\n", message, client);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+check_message(coap_packet_t *message, uint8_t *data, int len, int i)
+{
+  const uint8_t *token;
+  uint8_t *body;
+  uint32_t observe;
+
+  if(coap_parse_message(message, data, len) != NO_ERROR) {
+    fail("the message does not parse", i);
+    return 0;
+  }
+  if(coap_get_header_token(message, &token) != clients[i].token_len ||
+     memcmp(token, clients[i].token, clients[i].token_len) != 0) {
+    fail("wrong token", i);
+  }
+  if(!coap_get_header_observe(message, &observe) ||
+     observe != expected_observe) {
+    fail("wrong observe counter", i);
+  }
+  if(coap_get_payload(message, &body) != strlen(payload) ||
+     memcmp(body, payload, strlen(payload)) != 0) {
+    fail("wrong payload", i);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* er-coap-07.c sends its datagrams through this function. */
+void
+bench_udp_packet_send(struct uip_udp_conn *c, const void *data, int len)
+{
+  static coap_packet_t message[1];
+  static uint8_t buf[COAP_MAX_PACKET_SIZE];
+  int i;
+
+  sent++;
+  if(!checking) {
+    return;
+  }
+
+  i = uip_ntohs(c->rport) - BASE_PORT;
+  if(i < 0 || i >= MAX_OBSERVERS || !uip_ipaddr_cmp(&c->ripaddr,
+                                                     &clients[i].addr)) {
+    fail("sent to an unknown client", i);
+    return;
+  }
+  memcpy(buf, data, len);
+  if(check_message(message, buf, len, i)) {
+    clients[i].mid = message->mid;
+    clients[i].type = message->type;
+    clients[i].messages++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_observers(int count)
+{
+  int i, j;
+
+  while(list_head(coap_get_observers()) != NULL) {
+    coap_remove_observer(list_head(coap_get_observers()));
+  }
+
+  for(i = 0; i < count; i++) {
+    uip_ip6addr(&clients[i].addr, 0xfe80, 0, 0, 0, 0, 0, i >> 8, i & 0xff);
+    clients[i].token_len = (i % 3 == 0) ? 2 : (i % 3 == 1) ? 4 : 8;
+    for(j = 0; j < clients[i].token_len; j++) {
+      clients[i].token[j] = i + j;
+    }
+    clients[i].messages = 0;
+    if(coap_add_observer(&clients[i].addr, uip_htons(BASE_PORT + i),
+                         clients[i].token, clients[i].token_len,
+                         resource_sensor.url) == NULL) {
+      fail("could not add the observer", i);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+init_notification(coap_packet_t *notification, coap_message_type_t type,
+                  uint32_t counter)
+{
+  coap_init_message(notification, type, CONTENT_2_05, 0);
+  coap_set_header_content_type(notification, TEXT_PLAIN);
+  coap_set_header_max_age(notification, 30);
+  snprintf(payload, sizeof(payload),
+           "{\"node\":\"gw-17\",\"temp\":%lu.5,\"unit\":\"C\"}",
+           (unsigned long)counter);
+  coap_set_payload(notification, payload, strlen(payload));
+  expected_observe = counter;
+}
+/*---------------------------------------------------------------------------*/
+/* How notifications were sent before: a transaction and a complete
+   serialization for every observer. */
+static void
+notify_each(resource_t *resource, uint32_t counter, coap_packet_t *notification)
+{
+  coap_observer_t *obs;
+  coap_transaction_t *t;
+
+  for(obs = list_head(coap_get_observers()); obs != NULL; obs = obs->next) {
+    if(obs->url == resource->url &&
+       (t = coap_new_transaction(coap_get_mid(), &obs->addr, obs->port))) {
+      obs->last_mid = t->mid;
+      notification->mid = t->mid;
+      notification->type = stimer_expired(&obs->refresh_timer) ?
+        COAP_TYPE_CON : COAP_TYPE_NON;
+      coap_set_header_observe(notification, counter);
+      coap_set_header_token(notification, obs->token, obs->token_len);
+      t->packet_len = coap_serialize_message(notification, t->packet);
+      coap_send_transaction(t);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_non(int count, int baseline)
+{
+  coap_packet_t notification[1];
+  unsigned long long us;
+  int i, r;
+
+  /* The first round is checked, the others are timed. */
+  for(i = 0; i < count; i++) {
+    clients[i].messages = 0;
+  }
+  checking = 1;
+  init_notification(notification, COAP_TYPE_NON, 1);
+  if(baseline) {
+    notify_each(&resource_sensor, 1, notification);
+  } else {
+    coap_notify_observers(&resource_sensor, 1, notification);
+  }
+  for(i = 0; i < count; i++) {
+    if(clients[i].messages != 1 || clients[i].type != COAP_TYPE_NON) {
+      fail("expected one NON notification", i);
+    }
+  }
+  checking = 0;
+
+  sent = 0;
+  us = now_us();
+  for(r = 2; r < ROUNDS + 2; r++) {
+    init_notification(notification, COAP_TYPE_NON, r);
+    if(baseline) {
+      notify_each(&resource_sensor, r, notification);
+    } else {
+      coap_notify_observers(&resource_sensor, r, notification);
+    }
+  }
+  us = now_us() - us;
+
+  printf("  %s %8lu notifications/s\n", baseline ? "per observer: " : "shared:       ",
+         (unsigned long)(sent * 1000000ULL / (us ? us : 1)));
+  if(sent != (unsigned long)count * ROUNDS) {
+    printf("  FAIL: %lu notifications sent\n", sent);
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Acknowledge the CON notification in flight to every observer, and
+   check that it carries the expected state. */
+static int
+ack_all(int count)
+{
+  static coap_packet_t message[1];
+  static uint8_t buf[COAP_MAX_PACKET_SIZE];
+  coap_observer_t *obs;
+  coap_transaction_t *t;
+  int acked;
+
+  acked = 0;
+  for(obs = list_head(coap_get_observers()); obs != NULL; obs = obs->next) {
+    t = coap_get_transaction_by_mid(obs->last_mid);
+    if(t == NULL) {
+      fail("no CON notification in flight", uip_ntohs(obs->port) - BASE_PORT);
+      continue;
+    }
+    memcpy(buf, t->packet, t->packet_len);
+    check_message(message, buf, t->packet_len, uip_ntohs(obs->port) - BASE_PORT);
+    coap_clear_transaction(t);
+    acked++;
+  }
+  return acked;
+}
+/*---------------------------------------------------------------------------*/
+static void
+start_con(int count)
+{
+  coap_packet_t notification[1];
+  int i;
+
+  checking = 1;
+  sent = 0;
+  for(i = 0; i < count; i++) {
+    clients[i].messages = 0;
+  }
+  init_notification(notification, COAP_TYPE_CON, ROUNDS + 10);
+  coap_notify_observers(&resource_sensor, ROUNDS + 10, notification);
+  for(i = 0; i < count; i++) {
+    if(clients[i].messages != 1 || clients[i].type != COAP_TYPE_CON) {
+      fail("expected one CON notification", i);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+replace_con(int count)
+{
+  coap_packet_t notification[1];
+
+  /* A new state replaces the notifications in flight instead of being
+     sent at once. */
+  sent = 0;
+  init_notification(notification, COAP_TYPE_CON, ROUNDS + 11);
+  coap_notify_observers(&resource_sensor, ROUNDS + 11, notification);
+  if(sent != 0) {
+    printf("  FAIL: %lu notifications sent while others were in flight\n",
+           sent);
+    failures++;
+  }
+  if(ack_all(count) != count) {
+    printf("  FAIL: not all notifications were acknowledged\n");
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_retransmissions(int count)
+{
+  int i;
+
+  for(i = 0; i < count; i++) {
+    if(clients[i].messages != 2) {
+      fail("expected one retransmission", i);
+    }
+  }
+  if(ack_all(count) != count) {
+    printf("  FAIL: not all notifications were acknowledged\n");
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coap_observe_bench_process, ev, data)
+{
+  static struct etimer wait;
+  static int i;
+
+  PROCESS_BEGIN();
+
+  coap_register_as_transaction_handler();
+  coap_init_connection(uip_htons(COAP_DEFAULT_PORT));
+
+  printf("%u bytes per observer, %u bytes per transaction\n",
+         (unsigned)sizeof(coap_observer_t),
+         (unsigned)sizeof(coap_transaction_t));
+
+  for(i = 0; i < sizeof(observer_counts) / sizeof(observer_counts[0]); i++) {
+    printf("%d observers:\n", observer_counts[i]);
+    add_observers(observer_counts[i]);
+    run_non(observer_counts[i], 1);
+    run_non(observer_counts[i], 0);
+
+    start_con(observer_counts[i]);
+    replace_con(observer_counts[i]);
+
+    /* The first retransmission is due after 2 to 3 seconds. */
+    start_con(observer_counts[i]);
+    etimer_set(&wait, CLOCK_SECOND * 4);
+    while(!etimer_expired(&wait)) {
+      PROCESS_WAIT_EVENT();
+      if(ev == PROCESS_EVENT_TIMER && data != &wait) {
+        coap_check_transactions();
+      }
+    }
+    check_retransmissions(observer_counts[i]);
+  }
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,453 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for streaming block-wise transfers of er-coap-07 on
+ *         the native platform. A large log is transferred into a file
+ *         through the engine, with the datagrams looped back, once by a
+ *         handler that regenerates the log up to each block and once as
+ *         a stream with a cursor that is kept between blocks.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "cfs/cfs.h"
+#include "erbium.h"
+#include "er-coap-07-engine.h"
+
+#define LOG_LENGTH	65536UL
+#define FILENAME	"coap-stream-bench.out"
+#define QUEUE_SIZE	4
+
+struct log_cursor {
+  uint32_t line;
+  uint32_t offset;
+  uint8_t pos;
+};
+
+static struct {
+  uint8_t data[UIP_BUFSIZE];
+  uint16_t len;
+} queue[QUEUE_SIZE];
+static int queue_head, queue_count;
+
+static uip_ipaddr_t server_addr, client_addr;
+static uint8_t expected[LOG_LENGTH];
+static uint8_t file_data[LOG_LENGTH + 1];
+static unsigned long generated;
+static int fd;
+static int failures;
+
+static int log_open(void *cursor, void *request);
+static int log_read(void *cursor, uint8_t *buffer, uint16_t size,
+                    uint8_t *more);
+
+static const coap_stream_t log_stream = { log_open, log_read, NULL, NULL };
+
+RESOURCE(legacy, METHOD_GET, "log/legacy", "ct=0");
+RESOURCE(stream, METHOD_GET, "log/stream", "ct=0");
+
+/*---------------------------------------------------------------------------*/
+PROCESS(coap_stream_bench_process, "CoAP stream benchmark");
+AUTOSTART_PROCESSES(&coap_stream_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+/* A line of the log, which is the same for every call. */
+static int
+format_line(uint32_t line, char *buf)
+{
+  int n;
+
+  n = sprintf(buf, "%06lu node=%u temp=%d.%u\n", (unsigned long)line,
+              (unsigned)(line * 7 % 23 + 1), (int)(line * 13 % 50) - 10,
+              (unsigned)(line % 10));
+  generated += n;
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static int
+log_open(void *cursor, void *request)
+{
+  struct log_cursor *c = cursor;
+
+  c->line = 0;
+  c->offset = 0;
+  c->pos = 0;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+log_read(void *cursor, uint8_t *buffer, uint16_t size, uint8_t *more)
+{
+  struct log_cursor *c = cursor;
+  char line[40];
+  int len, n;
+
+  len = 0;
+  while(len < size && c->offset < LOG_LENGTH) {
+    n = format_line(c->line, line) - c->pos;
+    n = MIN(n, size - len);
+    n = MIN(n, LOG_LENGTH - c->offset);
+    memcpy(buffer + len, line + c->pos, n);
+    len += n;
+    c->offset += n;
+    c->pos += n;
+    if(line[c->pos - 1] == '\n') {
+      c->line++;
+      c->pos = 0;
+    }
+  }
+  *more = c->offset < LOG_LENGTH;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+void
+stream_handler(void *request, void *response, uint8_t *buffer,
+               uint16_t preferred_size, int32_t *offset)
+{
+  REST.set_header_content_type(response, REST.type.TEXT_PLAIN);
+  coap_stream_handler(&log_stream, request, response, buffer,
+                      preferred_size, offset);
+}
+/*---------------------------------------------------------------------------*/
+/* How block-wise resources were written before: the representation is
+   generated from the start, and only the part from the offset on is
+   copied. */
+void
+legacy_handler(void *request, void *response, uint8_t *buffer,
+               uint16_t preferred_size, int32_t *offset)
+{
+  char line[40];
+  uint32_t strpos, line_num;
+  int bufpos, n, skip;
+
+  strpos = 0;
+  bufpos = 0;
+  for(line_num = 0; strpos < LOG_LENGTH && bufpos < preferred_size;
+      line_num++) {
+    n = format_line(line_num, line);
+    n = MIN(n, LOG_LENGTH - strpos);
+    if(strpos + n > *offset) {
+      skip = *offset > strpos ? *offset - strpos : 0;
+      n -= skip;
+      n = MIN(n, preferred_size - bufpos);
+      memcpy(buffer + bufpos, line + skip, n);
+      bufpos += n;
+      strpos += skip;
+    }
+    strpos += n;
+  }
+
+  REST.set_header_content_type(response, REST.type.TEXT_PLAIN);
+  REST.set_response_payload(response, buffer, bufpos);
+  *offset = *offset + bufpos < LOG_LENGTH ? *offset + bufpos : -1;
+}
+/*---------------------------------------------------------------------------*/
+/* er-coap-07.c sends its datagrams through this function. */
+void
+bench_udp_packet_send(struct uip_udp_conn *c, const void *data, int len)
+{
+  int i;
+
+  if(queue_count == QUEUE_SIZE || len > UIP_BUFSIZE - UIP_LLH_LEN - UIP_IPUDPH_LEN) {
+    printf("FAIL: cannot queue a datagram of %d bytes\n", len);
+    failures++;
+    return;
+  }
+  i = (queue_head + queue_count++) % QUEUE_SIZE;
+  memcpy(queue[i].data, data, len);
+  queue[i].len = len;
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_source(uip_ipaddr_t *addr, uint16_t port)
+{
+  uip_ext_len = 0;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, addr);
+  UIP_UDP_BUF->srcport = port;
+}
+/*---------------------------------------------------------------------------*/
+/* Hand the queued datagrams to the engine as if they were received.
+   Requests come from the client and responses from the server. */
+static void
+deliver(void)
+{
+  while(queue_count > 0) {
+    set_source(queue[queue_head].data[0] & 0x20 ? &server_addr : &client_addr,
+               UIP_HTONS(COAP_DEFAULT_PORT));
+    uip_appdata = &uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN];
+    memcpy(uip_appdata, queue[queue_head].data, queue[queue_head].len);
+    uip_len = queue[queue_head].len;
+    queue_head = (queue_head + 1) % QUEUE_SIZE;
+    queue_count--;
+
+    uip_flags = UIP_NEWDATA;
+    process_post_synch(&coap_receiver, tcpip_event, NULL);
+    uip_flags = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+chunk_handler(void *response)
+{
+  uint8_t *chunk;
+  int len;
+
+  len = coap_get_payload(response, &chunk);
+  if(cfs_write(fd, chunk, len) != len) {
+    printf("FAIL: cannot write a block\n");
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_file(const char *name)
+{
+  int n;
+
+  fd = cfs_open(FILENAME, CFS_READ);
+  n = cfs_read(fd, file_data, sizeof(file_data));
+  cfs_close(fd);
+  cfs_remove(FILENAME);
+
+  if(n != LOG_LENGTH || memcmp(file_data, expected, LOG_LENGTH) != 0) {
+    printf("  FAIL: %s: the file has %d bytes and does not match the log\n",
+           name, n);
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, unsigned long long us, clock_t cpu)
+{
+  unsigned long cpu_us;
+
+  cpu_us = (unsigned long)((unsigned long long)cpu * 1000000 / CLOCKS_PER_SEC);
+  printf("  %s %8lu us, %6lu us CPU per KB, %6.1f bytes generated per byte\n",
+         name, (unsigned long)us, cpu_us / (LOG_LENGTH / 1024),
+         (double)generated / LOG_LENGTH);
+}
+/*---------------------------------------------------------------------------*/
+static void
+init_request(coap_packet_t *request, const char *url)
+{
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_set_header_uri_path(request, url);
+  coap_set_header_token(request, (uint8_t *)"\x12\x34", 2);
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_legacy(void)
+{
+  static struct request_state_t state;
+  coap_packet_t request[1];
+  unsigned long long us;
+  process_event_t ev;
+  clock_t cpu;
+
+  init_request(request, "log/legacy");
+  fd = cfs_open(FILENAME, CFS_WRITE);
+  generated = 0;
+
+  us = now_us();
+  cpu = clock();
+  ev = PROCESS_EVENT_NONE;
+  PT_INIT(&state.pt);
+  while(PT_SCHEDULE(coap_blocking_request(&state, ev, &server_addr,
+                                          UIP_HTONS(COAP_DEFAULT_PORT),
+                                          request, chunk_handler))) {
+    deliver();
+    ev = PROCESS_EVENT_POLL;
+  }
+  cpu = clock() - cpu;
+  us = now_us() - us;
+
+  cfs_close(fd);
+  report("legacy:", us, cpu);
+  check_file("legacy");
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_stream(void)
+{
+  static struct coap_stream_state state;
+  coap_packet_t request[1];
+  unsigned long long us;
+  process_event_t ev;
+  clock_t cpu;
+
+  init_request(request, "log/stream");
+  fd = cfs_open(FILENAME, CFS_WRITE);
+  generated = 0;
+
+  us = now_us();
+  cpu = clock();
+  ev = PROCESS_EVENT_NONE;
+  PT_INIT(&state.pt);
+  while(PT_SCHEDULE(coap_stream_request(&state, ev, &server_addr,
+                                        UIP_HTONS(COAP_DEFAULT_PORT),
+                                        request, fd))) {
+    deliver();
+    ev = PROCESS_EVENT_POLL;
+  }
+  cpu = clock() - cpu;
+  us = now_us() - us;
+
+  cfs_close(fd);
+  report("stream:", us, cpu);
+  if(!state.complete || state.length != LOG_LENGTH) {
+    printf("  FAIL: the transfer stopped after %lu bytes\n",
+           (unsigned long)state.length);
+    failures++;
+  }
+  check_file("stream");
+}
+/*---------------------------------------------------------------------------*/
+/* Request a block of the stream directly from the handler for the
+   client with the given token, and check it. Returns the bytes that
+   were generated for it. */
+static unsigned long
+request_block(uint8_t token, uint32_t block_offset, unsigned int code)
+{
+  static coap_packet_t request[1], response[1];
+  static uint8_t buffer[REST_MAX_CHUNK_SIZE];
+  int32_t offset;
+  uint8_t *payload;
+  int len;
+
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_set_header_token(request, &token, 1);
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, 0);
+  set_source(&client_addr, UIP_HTONS(COAP_DEFAULT_PORT + token));
+
+  generated = 0;
+  offset = block_offset;
+  stream_handler(request, response, buffer, REST_MAX_CHUNK_SIZE, &offset);
+
+  len = coap_get_payload(response, &payload);
+  if(response->code != code) {
+    printf("  FAIL: client %u, offset %lu: response code %u\n", token,
+           (unsigned long)block_offset, response->code);
+    failures++;
+  } else if(code == CONTENT_2_05 &&
+            (len != MIN(REST_MAX_CHUNK_SIZE, LOG_LENGTH - block_offset) ||
+             memcmp(payload, expected + block_offset, len) != 0 ||
+             offset != (block_offset + len < LOG_LENGTH ?
+                        (int32_t)(block_offset + len) : -1))) {
+    printf("  FAIL: client %u, offset %lu: wrong block\n", token,
+           (unsigned long)block_offset);
+    failures++;
+  }
+  return generated;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_cursor(const char *what, unsigned long n, int cached)
+{
+  /* A cached cursor formats at most one line again. */
+  if((n <= REST_MAX_CHUNK_SIZE + 40) != cached) {
+    printf("  FAIL: %s: %lu bytes generated\n", what, n);
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_cursors(void)
+{
+  const uint32_t b = REST_MAX_CHUNK_SIZE;
+
+  printf("%d cursors:\n", COAP_MAX_STREAM_CURSORS);
+
+  request_block(1, 0, CONTENT_2_05);
+  request_block(2, 0, CONTENT_2_05);
+  check_cursor("next block", request_block(1, b, CONTENT_2_05), 1);
+  check_cursor("next block", request_block(1, 2 * b, CONTENT_2_05), 1);
+  check_cursor("repeated block", request_block(1, 2 * b, CONTENT_2_05), 0);
+  check_cursor("next block", request_block(1, 3 * b, CONTENT_2_05), 1);
+
+  /* A third client takes the cursor of the second one. */
+  request_block(3, 0, CONTENT_2_05);
+  check_cursor("next block", request_block(3, b, CONTENT_2_05), 1);
+  check_cursor("taken cursor", request_block(2, b, CONTENT_2_05), 0);
+  check_cursor("next block", request_block(2, 2 * b, CONTENT_2_05), 1);
+
+  request_block(1, LOG_LENGTH - b, CONTENT_2_05);
+  request_block(1, LOG_LENGTH, BAD_OPTION_4_02);
+  request_block(3, 4 * LOG_LENGTH, BAD_OPTION_4_02);
+  coap_stream_reset(&log_stream);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coap_stream_bench_process, ev, data)
+{
+  static struct log_cursor cursor;
+  static uint32_t i;
+  uint8_t more;
+
+  PROCESS_BEGIN();
+
+  uip_ip6addr(&server_addr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+  uip_ip6addr(&client_addr, 0xfe80, 0, 0, 0, 0, 0, 0, 2);
+
+  log_open(&cursor, NULL);
+  for(i = 0; i < LOG_LENGTH; i += 1024) {
+    log_read(&cursor, expected + i, 1024, &more);
+  }
+
+  rest_init_engine();
+  rest_activate_resource(&resource_legacy);
+  rest_activate_resource(&resource_stream);
+
+  printf("%lu bytes in blocks of %u bytes:\n", LOG_LENGTH, REST_MAX_CHUNK_SIZE);
+  run_legacy();
+  run_stream();
+
+  check_cursors();
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,516 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for Coffee over the xmem emulation of the native
+ *         platform: the throughput of writing, reading and modifying
+ *         files, and the recovery from power failures in the middle 
+ *         of writes and erasures.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+#include "cfs-coffee-arch.h"
+#include "dev/xmem-native.h"
+
+#define FILE_SIZE	32768
+#define FILES		(COFFEE_SIZE / 4 / FILE_SIZE)
+#define CHUNK_SIZE	256
+#define UPDATES		2000
+#define UPDATE_SIZE	16
+
+#define CUT_ROUNDS	100
+#define CUT_FILE_SIZE	8192
+#define CUT_KEEP	4
+
+/* Files that the garbage collector moves out of full sectors, and the 
+   obsolete files that fill the rest of the sectors. */
+#define MOVE_SECTORS	(COFFEE_SIZE / COFFEE_SECTOR_SIZE)
+#define MOVE_FILE_SIZE	(3 * COFFEE_PAGE_SIZE)
+#define MOVE_FILE	10000
+#define FILLER_FILE	20000
+#define TRIGGER_FILE	30000
+#define MOVE_SLICES	10000
+
+static unsigned char buf[CHUNK_SIZE];
+static unsigned long seed;
+static int failures;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(flash_bench_process, "Coffee flash benchmark");
+AUTOSTART_PROCESSES(&flash_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+next_random(void)
+{
+  seed = seed * 1103515245UL + 12345;
+  return (unsigned)(seed >> 16) & 0x7fff;
+}
+/*---------------------------------------------------------------------------*/
+/* The contents of a file are never zero, because Coffee finds the end
+   of a file from its last non-zero byte. */
+static unsigned char
+file_byte(int file, unsigned long offset)
+{
+  return ((file * 31 + offset) % 255) + 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+fill(int file, unsigned long offset, int size)
+{
+  int i;
+
+  for(i = 0; i < size; i++) {
+    buf[i] = file_byte(file, offset + i);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+write_file(int file, unsigned long size)
+{
+  char name[16];
+  unsigned long offset;
+  int fd;
+
+  sprintf(name, "f%d", file);
+  cfs_coffee_reserve(name, size);
+  fd = cfs_open(name, CFS_WRITE);
+  if(fd < 0) {
+    return 0;
+  }
+  for(offset = 0; offset < size; offset += CHUNK_SIZE) {
+    fill(file, offset, CHUNK_SIZE);
+    if(cfs_write(fd, buf, CHUNK_SIZE) != CHUNK_SIZE) {
+      cfs_close(fd);
+      return 0;
+    }
+  }
+  cfs_close(fd);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Return 1 if the file has the right contents, 0 if it has not, and -1
+   if it does not exist. */
+static int
+check_file(int file, unsigned long size)
+{
+  unsigned char expected[CHUNK_SIZE];
+  char name[16];
+  unsigned long offset;
+  int fd, r;
+
+  sprintf(name, "f%d", file);
+  fd = cfs_open(name, CFS_READ);
+  if(fd < 0) {
+    return -1;
+  }
+  r = 1;
+  for(offset = 0; offset < size && r; offset += CHUNK_SIZE) {
+    fill(file, offset, CHUNK_SIZE);
+    memcpy(expected, buf, CHUNK_SIZE);
+    if(cfs_read(fd, buf, CHUNK_SIZE) != CHUNK_SIZE ||
+       memcmp(buf, expected, CHUNK_SIZE) != 0) {
+      r = 0;
+    }
+  }
+  if(r && cfs_read(fd, buf, 1) > 0) {
+    r = 0;
+  }
+  cfs_close(fd);
+  return r;
+}
+/*---------------------------------------------------------------------------*/
+static void
+print_phase(const char *name, unsigned long long us, unsigned long bytes)
+{
+  printf("%-8s %8lu us, %7.1f MB/s, %7lu reads, %7lu writes, %4lu erases\n",
+         name, (unsigned long)us, us > 0 ? bytes / (double)us : 0.0,
+         xmem_stats.reads, xmem_stats.writes, xmem_stats.erases);
+  memset(&xmem_stats, 0, sizeof(xmem_stats));
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_throughput(void)
+{
+  unsigned long long us;
+  unsigned long offset, min, max, overwrites;
+  unsigned char expected[UPDATE_SIZE];
+  char name[16];
+  int i, file, fd;
+
+  cfs_coffee_format();
+  memset(&xmem_stats, 0, sizeof(xmem_stats));
+  printf("%d files of %d bytes in %lu KB of flash:\n",
+         (int)FILES, FILE_SIZE, (unsigned long)(COFFEE_SIZE / 1024));
+
+  us = now_us();
+  for(file = 0; file < FILES; file++) {
+    if(!write_file(file, FILE_SIZE)) {
+      printf("FAIL: could not write file %d\n", file);
+      failures++;
+      return;
+    }
+  }
+  us = now_us() - us;
+  overwrites = xmem_stats.overwrites;
+  print_phase("write", us, (unsigned long)FILES * FILE_SIZE);
+
+  us = now_us();
+  for(file = 0; file < FILES; file++) {
+    if(check_file(file, FILE_SIZE) != 1) {
+      printf("FAIL: file %d has the wrong contents\n", file);
+      failures++;
+    }
+  }
+  us = now_us() - us;
+  print_phase("read", us, (unsigned long)FILES * FILE_SIZE);
+
+  /* Modify files in place, which goes through micro logs. The new
+     data is the same as the old, so the files can still be checked. */
+  us = now_us();
+  for(i = 0; i < UPDATES; i++) {
+    file = next_random() % FILES;
+    offset = (next_random() % (FILE_SIZE / UPDATE_SIZE)) * UPDATE_SIZE;
+    sprintf(name, "f%d", file);
+    fd = cfs_open(name, CFS_READ | CFS_WRITE);
+    fill(file, offset, UPDATE_SIZE);
+    memcpy(expected, buf, UPDATE_SIZE);
+    if(fd < 0 || cfs_seek(fd, offset, CFS_SEEK_SET) != offset ||
+       cfs_write(fd, buf, UPDATE_SIZE) != UPDATE_SIZE ||
+       cfs_seek(fd, offset, CFS_SEEK_SET) != offset ||
+       cfs_read(fd, buf, UPDATE_SIZE) != UPDATE_SIZE ||
+       memcmp(buf, expected, UPDATE_SIZE) != 0) {
+      printf("FAIL: could not update file %d at offset %lu\n", file, offset);
+      failures++;
+    }
+    cfs_close(fd);
+  }
+  us = now_us() - us;
+  overwrites += xmem_stats.overwrites;
+  print_phase("update", us, (unsigned long)UPDATES * UPDATE_SIZE);
+
+  for(file = 0; file < FILES; file++) {
+    if(check_file(file, FILE_SIZE) != 1) {
+      printf("FAIL: file %d has the wrong contents after the updates\n", file);
+      failures++;
+    }
+  }
+
+  min = max = xmem_sector_erases(0);
+  for(i = 1; i < COFFEE_SIZE / XMEM_SECTOR_SIZE; i++) {
+    if(xmem_sector_erases(i) < min) {
+      min = xmem_sector_erases(i);
+    }
+    if(xmem_sector_erases(i) > max) {
+      max = xmem_sector_erases(i);
+    }
+  }
+  printf("Sector erasures: min %lu, max %lu; bytes overwritten without erasure: %lu\n",
+         min, max, overwrites);
+}
+/*---------------------------------------------------------------------------*/
+#if XMEM_MMAP
+/* Run a function in a child process, which starts with no state of 
+   Coffee in RAM, as after a reboot. */
+static int
+run_child(int (*function)(int), int round)
+{
+  pid_t pid;
+  int status;
+
+  pid = fork();
+  if(pid == 0) {
+    _exit(function(round));
+  }
+  if(pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) {
+    return -1;
+  }
+  return WEXITSTATUS(status);
+}
+/*---------------------------------------------------------------------------*/
+static int
+format(int round)
+{
+  cfs_coffee_format();
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_file(int file)
+{
+  char name[16];
+
+  sprintf(name, "f%d", file);
+  cfs_remove(name);
+}
+/*---------------------------------------------------------------------------*/
+/* Write a new file and remove an old one, with the power cut at a 
+   random write or erasure. Return 1 if the power was cut. */
+static int
+cut_power(int round)
+{
+  seed = round + 1;
+  xmem_power_cut(1 + next_random() % (2 * CUT_FILE_SIZE / CHUNK_SIZE));
+  write_file(round, CUT_FILE_SIZE);
+  if(round >= CUT_KEEP) {
+    remove_file(round - CUT_KEEP);
+  }
+  return !xmem_powered();
+}
+/*---------------------------------------------------------------------------*/
+/* Check the files after a power cut. The files that were complete 
+   before the cut must be intact. The new file is written again if it
+   is incomplete. Return twice the number of failures, plus one if the
+   new file had to be written again. */
+static int
+recover(int round)
+{
+  int file, r, errors;
+
+  errors = 0;
+  for(file = round - CUT_KEEP + 1; file < round; file++) {
+    if(file >= 0 && check_file(file, CUT_FILE_SIZE) != 1) {
+      printf("FAIL: file %d was damaged by a power cut in round %d\n",
+             file, round);
+      errors++;
+    }
+  }
+
+  /* The old file was either removed or is still intact. */
+  if(round >= CUT_KEEP &&
+     check_file(round - CUT_KEEP, CUT_FILE_SIZE) == 0) {
+    printf("FAIL: file %d was damaged while it was removed\n",
+           round - CUT_KEEP);
+    errors++;
+  }
+  if(round >= CUT_KEEP) {
+    remove_file(round - CUT_KEEP);
+  }
+
+  r = check_file(round, CUT_FILE_SIZE);
+  if(r != 1) {
+    remove_file(round);
+    if(!write_file(round, CUT_FILE_SIZE) ||
+       check_file(round, CUT_FILE_SIZE) != 1) {
+      printf("FAIL: could not write file %d again after a power cut\n",
+             round);
+      errors++;
+    }
+  }
+
+  return (errors < 100 ? errors : 100) * 2 + (r != 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_power_cuts(void)
+{
+  int round, cuts, rewrites, r;
+
+  run_child(format, 0);
+
+  cuts = rewrites = 0;
+  for(round = 0; round < CUT_ROUNDS; round++) {
+    r = run_child(cut_power, round);
+    if(r < 0) {
+      printf("FAIL: the process of round %d crashed\n", round);
+      failures++;
+      return;
+    }
+    cuts += r;
+
+    r = run_child(recover, round);
+    if(r < 0) {
+      printf("FAIL: the recovery of round %d crashed\n", round);
+      failures++;
+      return;
+    }
+    failures += r / 2;
+    rewrites += r & 1;
+  }
+
+  printf("%d power cuts in %d rounds, %d files written again\n",
+         cuts, CUT_ROUNDS, rewrites);
+}
+/*---------------------------------------------------------------------------*/
+/* Fill the flash memory with a small file at the start of each sector
+   and obsolete files after it. The last sector holds only an obsolete 
+   file, and one page is left free. */
+static int
+prepare_moves(int round)
+{
+  int sector;
+
+  cfs_coffee_format();
+  for(sector = 0; sector < MOVE_SECTORS - 1; sector++) {
+    if(!write_file(MOVE_FILE + sector, MOVE_FILE_SIZE) ||
+       !write_file(FILLER_FILE + sector,
+                   COFFEE_SECTOR_SIZE - 5 * COFFEE_PAGE_SIZE)) {
+      return 1;
+    }
+  }
+  if(!write_file(FILLER_FILE + sector,
+                 COFFEE_SECTOR_SIZE - 2 * COFFEE_PAGE_SIZE)) {
+    return 1;
+  }
+  for(sector = 0; sector < MOVE_SECTORS; sector++) {
+    remove_file(FILLER_FILE + sector);
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Write a file, which makes Coffee erase the last sector, and remove 
+   it. The garbage collection process then moves files out of the 
+   other sectors, since few pages are free. The power is cut before
+   or in the middle of an operation that depends on the round. Return
+   1 if the power was cut, plus 2 if any file was moved. */
+static int
+move_files(int round)
+{
+  int slices;
+
+  if(round % 2 == 1) {
+    xmem_power_cut_before((round + 1) / 2);
+  } else {
+    xmem_power_cut(round / 2);
+  }
+  cfs_coffee_stats.relocated_pages = 0;
+
+  write_file(TRIGGER_FILE, COFFEE_PAGE_SIZE);
+  remove_file(TRIGGER_FILE);
+  for(slices = 0; slices < MOVE_SLICES && process_run() > 0; slices++);
+
+  return !xmem_powered() + 2 * (cfs_coffee_stats.relocated_pages > 0);
+}
+/*---------------------------------------------------------------------------*/
+/* Each moved file must exist once with its contents after a power 
+   cut, so that no copy is left behind when the file is removed. */
+static int
+check_moves(int round)
+{
+  int sector, errors;
+
+  errors = 0;
+  for(sector = 0; sector < MOVE_SECTORS - 1; sector++) {
+    if(check_file(MOVE_FILE + sector, MOVE_FILE_SIZE) != 1) {
+      printf("FAIL: file %d was damaged while it was moved in round %d\n",
+             MOVE_FILE + sector, round);
+      errors++;
+    }
+    remove_file(MOVE_FILE + sector);
+    if(check_file(MOVE_FILE + sector, MOVE_FILE_SIZE) != -1) {
+      printf("FAIL: file %d was left twice by a move in round %d\n",
+             MOVE_FILE + sector, round);
+      errors++;
+    }
+  }
+  return errors < 100 ? errors : 100;
+}
+/*---------------------------------------------------------------------------*/
+/* Cut the power at every write and erasure in turn while the garbage 
+   collector moves files, until the files are moved without a cut. */
+static void
+run_move_cuts(void)
+{
+  int round, cuts, cut, r;
+
+  cuts = 0;
+  for(round = 0;; round++) {
+    if(run_child(prepare_moves, round) != 0) {
+      printf("FAIL: could not fill the flash memory in round %d\n", round);
+      failures++;
+      return;
+    }
+    r = run_child(move_files, round);
+    if(r < 0) {
+      printf("FAIL: the process of round %d crashed\n", round);
+      failures++;
+      return;
+    }
+    if(round == 0 && !(r & 2)) {
+      printf("No files were moved; the incremental garbage collector is off\n");
+      return;
+    }
+    cut = r & 1;
+    cuts += cut;
+
+    r = run_child(check_moves, round);
+    if(r < 0) {
+      printf("FAIL: the recovery of round %d crashed\n", round);
+      failures++;
+      return;
+    }
+    failures += r;
+    if(round > 0 && !cut) {
+      break;
+    }
+  }
+
+  printf("%d power cuts in %d rounds while files were moved\n",
+         cuts, round + 1);
+}
+#endif /* XMEM_MMAP */
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(flash_bench_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+#if XMEM_MMAP
+  /* Coffee must not have run in this process before the power cuts,
+     so that each child process starts from the flash memory alone. */
+  run_power_cuts();
+  run_move_cuts();
+#endif
+  seed = 1;
+  run_throughput();
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for the garbage collection of Coffee: a long
+ *         workload of random file rewrites next to static files,
+ *         reporting the worst-case cost of a rewrite in flash
+ *         operations and estimated flash time, and the spread of the
+ *         erase counts of the sectors.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+
+#define SECTORS		16
+#define COLD_FILES	48
+#define COLD_SIZE	4096
+#define HOT_FILES	16
+#define MAX_HOT_SIZE	8192
+#define REWRITES	20000
+
+/* The latency of a rewrite is estimated from the flash operations
+   that Coffee issues for it, with the timing of the M25P80 on the Sky
+   mote: a sector erase takes 0.6 s and programming 256 bytes 0.8 ms,
+   and the SPI bus moves a byte in 2 us, after a 4-byte command. */
+#define ERASE_US		600000UL
+#define PROGRAM_US_PER_PAGE	800UL
+#define SPI_US_PER_BYTE		2UL
+#define SPI_COMMAND_BYTES	4UL
+
+static unsigned hot_sizes[HOT_FILES];
+static unsigned char hot_generations[HOT_FILES];
+static unsigned char buf[MAX_HOT_SIZE];
+static unsigned long seed;
+static int failures;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(gc_bench_process, "Coffee GC benchmark");
+AUTOSTART_PROCESSES(&gc_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long
+flash_ops(const struct cfs_coffee_stats *s)
+{
+  return s->flash_reads + s->flash_writes + s->sector_erases;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+flash_us(const struct cfs_coffee_stats *s)
+{
+  return (s->flash_reads + s->flash_writes) * SPI_COMMAND_BYTES *
+    SPI_US_PER_BYTE +
+    (s->flash_read_bytes + s->flash_written_bytes) * SPI_US_PER_BYTE +
+    s->flash_written_bytes * PROGRAM_US_PER_PAGE / 256 +
+    (unsigned long long)s->sector_erases * ERASE_US;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+next_random(void)
+{
+  seed = seed * 1103515245UL + 12345;
+  return (unsigned)(seed >> 16) & 0x7fff;
+}
+/*---------------------------------------------------------------------------*/
+/* File contents are non-zero, since Coffee finds the end of a file by
+   its last non-zero byte. */
+static void
+fill(unsigned char *data, unsigned size, unsigned pattern)
+{
+  unsigned i;
+
+  for(i = 0; i < size; i++) {
+    data[i] = ((pattern + i) % 255) + 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+write_file(const char *name, unsigned size, unsigned pattern)
+{
+  int fd, r;
+
+  if(cfs_coffee_reserve(name, size) < 0) {
+    return 0;
+  }
+  fd = cfs_open(name, CFS_WRITE);
+  if(fd < 0) {
+    return 0;
+  }
+  fill(buf, size, pattern);
+  r = cfs_write(fd, buf, size);
+  cfs_close(fd);
+
+  return r == size;
+}
+/*---------------------------------------------------------------------------*/
+static int
+check_file(const char *name, unsigned size, unsigned pattern)
+{
+  static unsigned char expected[MAX_HOT_SIZE];
+  int fd, r;
+
+  fd = cfs_open(name, CFS_READ);
+  if(fd < 0) {
+    return 0;
+  }
+  r = cfs_read(fd, buf, sizeof(buf));
+  cfs_close(fd);
+
+  fill(expected, size, pattern);
+  return r == size && memcmp(buf, expected, size) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_files(void)
+{
+  char name[20];
+  int i;
+
+  for(i = 0; i < COLD_FILES; i++) {
+    sprintf(name, "cold-%d", i);
+    if(!check_file(name, COLD_SIZE, i)) {
+      printf("FAIL: the contents of %s are wrong\n", name);
+      failures++;
+    }
+  }
+  for(i = 0; i < HOT_FILES; i++) {
+    sprintf(name, "hot-%d", i);
+    if(hot_sizes[i] > 0 &&
+       !check_file(name, hot_sizes[i], i + hot_generations[i])) {
+      printf("FAIL: the contents of %s are wrong\n", name);
+      failures++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+report_erasures(void)
+{
+  long count, min, max;
+  int i;
+
+  min = max = cfs_coffee_get_erase_count(0);
+  for(i = 1; i < SECTORS; i++) {
+    count = cfs_coffee_get_erase_count(i);
+    if(count < min) {
+      min = count;
+    }
+    if(count > max) {
+      max = count;
+    }
+  }
+
+  printf("Erase counts: min %ld, max %ld, spread %ld\n", min, max, max - min);
+  printf("Erasures: %lu, blocking collections: %lu, GC slices: %lu, "
+         "moved pages: %lu\n",
+         cfs_coffee_stats.sector_erases, cfs_coffee_stats.gc_runs,
+         cfs_coffee_stats.gc_slices, cfs_coffee_stats.relocated_pages);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(gc_bench_process, ev, data)
+{
+  static char name[20];
+  static struct cfs_coffee_stats before;
+  static unsigned long long us, max_us, total_us;
+  static unsigned long ops, max_ops, total_ops;
+  static unsigned long erases, max_erases, stalled;
+  static int i, slot;
+
+  PROCESS_BEGIN();
+
+  cfs_coffee_format();
+  memset(&cfs_coffee_stats, 0, sizeof(cfs_coffee_stats));
+
+  /* Static files that are never changed. */
+  for(i = 0; i < COLD_FILES; i++) {
+    sprintf(name, "cold-%d", i);
+    if(!write_file(name, COLD_SIZE, i)) {
+      printf("FAIL: could not create %s\n", name);
+      failures++;
+    }
+  }
+
+  printf("%d rewrites of %d files next to %d static files:\n",
+         REWRITES, HOT_FILES, COLD_FILES);
+
+  seed = 1;
+  max_us = total_us = 0;
+  max_ops = total_ops = 0;
+  max_erases = stalled = 0;
+  for(i = 0; i < REWRITES; i++) {
+    slot = next_random() % HOT_FILES;
+    sprintf(name, "hot-%d", slot);
+
+    before = cfs_coffee_stats;
+    cfs_remove(name);
+    hot_sizes[slot] = 1 + next_random() % MAX_HOT_SIZE;
+    hot_generations[slot]++;
+    if(!write_file(name, hot_sizes[slot], slot + hot_generations[slot])) {
+      printf("FAIL: could not rewrite %s\n", name);
+      failures++;
+      hot_sizes[slot] = 0;
+    }
+    us = flash_us(&cfs_coffee_stats) - flash_us(&before);
+    ops = flash_ops(&cfs_coffee_stats) - flash_ops(&before);
+    erases = cfs_coffee_stats.sector_erases - before.sector_erases;
+
+    total_us += us;
+    if(us > max_us) {
+      max_us = us;
+    }
+    total_ops += ops;
+    if(ops > max_ops) {
+      max_ops = ops;
+    }
+    if(erases > 0) {
+      stalled++;
+    }
+    if(erases > max_erases) {
+      max_erases = erases;
+    }
+
+    /* Give the garbage collector some idle time. */
+    PROCESS_PAUSE();
+  }
+
+  printf("Rewrite flash operations: mean %lu, max %lu\n",
+         total_ops / REWRITES, max_ops);
+  printf("Rewrite flash time on the Sky: mean %lu us, max %lu us\n",
+         (unsigned long)(total_us / REWRITES), (unsigned long)max_us);
+  printf("Rewrites that erased sectors: %lu, at most %lu sectors\n",
+         stalled, max_erases);
+  report_erasures();
+
+  check_files();
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
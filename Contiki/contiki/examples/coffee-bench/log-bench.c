@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+
+/**
+ * \file
+ *         Benchmark for small reads and writes in a file that Coffee
+ *         modifies through a micro log, reporting the flash memory
+ *         accesses and the time of each workload.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+
+#define FILE_NAME	"data"
+#define FILE_SIZE	8192
+#define RECORD_SIZE	256
+#define FIELD_SIZE	16
+
+static unsigned char mirror[FILE_SIZE];
+static unsigned char buf[FILE_SIZE];
+static unsigned long seed;
+static int failures;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(log_bench_process, "Coffee log benchmark");
+AUTOSTART_PROCESSES(&log_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+next_random(void)
+{
+  seed = seed * 1103515245UL + 12345;
+  return (unsigned)(seed >> 16) & 0x7fff;
+}
+/*---------------------------------------------------------------------------*/
+/* File contents are non-zero, since Coffee finds the end of a file by
+   its last non-zero byte. */
+static void
+fill(unsigned char *data, unsigned size, unsigned pattern)
+{
+  unsigned i;
+
+  for(i = 0; i < size; i++) {
+    data[i] = ((pattern + i) % 255) + 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_at(int fd, unsigned offset, unsigned size)
+{
+  fill(&mirror[offset], size, next_random());
+  if(cfs_seek(fd, offset, CFS_SEEK_SET) != offset ||
+     cfs_write(fd, &mirror[offset], size) != size) {
+    printf("FAIL: could not write %u bytes at offset %u\n", size, offset);
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+read_at(int fd, unsigned offset, unsigned size)
+{
+  if(cfs_seek(fd, offset, CFS_SEEK_SET) != offset ||
+     cfs_read(fd, buf, size) != size ||
+     memcmp(buf, &mirror[offset], size) != 0) {
+    printf("FAIL: wrong data in %u bytes at offset %u\n", size, offset);
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Update every field of randomly chosen records, one field at a time. */
+static void
+update_records(int fd)
+{
+  unsigned i, j, record;
+
+  for(i = 0; i < 500; i++) {
+    record = next_random() % (FILE_SIZE / RECORD_SIZE);
+    for(j = 0; j < RECORD_SIZE / FIELD_SIZE; j++) {
+      write_at(fd, record * RECORD_SIZE + j * FIELD_SIZE, FIELD_SIZE);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Write and read small pieces at random offsets. */
+static void
+random_access(int fd)
+{
+  unsigned i;
+
+  for(i = 0; i < 2000; i++) {
+    write_at(fd, next_random() % (FILE_SIZE - FIELD_SIZE), FIELD_SIZE);
+    read_at(fd, next_random() % (FILE_SIZE - FIELD_SIZE), FIELD_SIZE);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Read the whole file sequentially in small pieces. */
+static void
+scan(int fd)
+{
+  unsigned i, offset;
+
+  for(i = 0; i < 20; i++) {
+    for(offset = 0; offset < FILE_SIZE; offset += 32) {
+      read_at(fd, offset, 32);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+run(const char *name, void (*workload)(int))
+{
+  unsigned long long us;
+  int fd;
+
+  fd = cfs_open(FILE_NAME, CFS_READ | CFS_WRITE);
+  if(fd < 0) {
+    printf("FAIL: could not open the file\n");
+    failures++;
+    return;
+  }
+
+  memset(&cfs_coffee_stats, 0, sizeof(cfs_coffee_stats));
+  us = now_us();
+  workload(fd);
+  cfs_close(fd);
+  us = now_us() - us;
+
+  printf("%-15s %7lu us, %6lu reads of %7lu bytes, "
+         "%6lu writes of %7lu bytes, %6lu cache hits\n",
+         name, (unsigned long)us,
+         cfs_coffee_stats.flash_reads, cfs_coffee_stats.flash_read_bytes,
+         cfs_coffee_stats.flash_writes, cfs_coffee_stats.flash_written_bytes,
+         cfs_coffee_stats.cache_hits);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(log_bench_process, ev, data)
+{
+  int fd;
+
+  PROCESS_BEGIN();
+
+  cfs_coffee_format();
+
+  /* A file with a fixed size, so that all changes go to the log. */
+  fill(mirror, sizeof(mirror), 0);
+  fd = -1;
+  if(cfs_coffee_reserve(FILE_NAME, FILE_SIZE) == 0) {
+    fd = cfs_open(FILE_NAME, CFS_WRITE);
+  }
+  if(fd < 0 || cfs_write(fd, mirror, sizeof(mirror)) != sizeof(mirror)) {
+    printf("FAIL: could not create the file\n");
+    failures++;
+  }
+  cfs_close(fd);
+
+  seed = 1;
+  run("record updates", update_records);
+  run("random access", random_access);
+  run("scan", scan);
+
+  /* Check the whole file through a new file descriptor. */
+  fd = cfs_open(FILE_NAME, CFS_READ);
+  if(fd < 0 || cfs_read(fd, buf, sizeof(buf)) != sizeof(buf) ||
+     memcmp(buf, mirror, sizeof(mirror)) != 0) {
+    printf("FAIL: the contents of the file are wrong\n");
+    failures++;
+  }
+  cfs_close(fd);
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
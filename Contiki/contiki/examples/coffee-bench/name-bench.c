@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for looking up file names in Coffee: the number of
+ *         file headers read and the time per cfs_open() for existing
+ *         and missing files, with an increasing number of files.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+
+#define OPENS		1000
+#define MAX_FILES	500
+
+static const int file_counts[] = {10, 50, 100, 250, 500};
+
+static unsigned char removed[MAX_FILES];
+static unsigned long seed;
+static int failures;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(name_bench_process, "Coffee name benchmark");
+AUTOSTART_PROCESSES(&name_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+next_random(void)
+{
+  seed = seed * 1103515245UL + 12345;
+  return (unsigned)(seed >> 16) & 0x7fff;
+}
+/*---------------------------------------------------------------------------*/
+static void
+file_name(char *name, int i)
+{
+  sprintf(name, "file-%d", i);
+}
+/*---------------------------------------------------------------------------*/
+static int
+create_file(int i)
+{
+  char name[16];
+  int fd, r;
+
+  file_name(name, i);
+  if(cfs_coffee_reserve(name, 64) < 0) {
+    return 0;
+  }
+  fd = cfs_open(name, CFS_WRITE);
+  if(fd < 0) {
+    return 0;
+  }
+  r = cfs_write(fd, name, strlen(name));
+  cfs_close(fd);
+
+  return r == strlen(name);
+}
+/*---------------------------------------------------------------------------*/
+/* Open a file and check that it exists if and only if it should. */
+static int
+check_file(int i, int exists)
+{
+  char name[16];
+  char buf[16];
+  int fd, r;
+
+  file_name(name, i);
+  fd = cfs_open(name, CFS_READ);
+  if(fd < 0) {
+    return !exists;
+  }
+  /* Coffee finds the end of a file by the last non-zero byte, so the
+     contents are stored without the terminating zero. */
+  r = cfs_read(fd, buf, sizeof(buf));
+  cfs_close(fd);
+
+  return exists && r == strlen(name) && memcmp(buf, name, r) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_opens(const char *what, int files, int missing)
+{
+  unsigned long long us;
+  int i;
+
+  memset(&cfs_coffee_stats, 0, sizeof(cfs_coffee_stats));
+  us = now_us();
+  for(i = 0; i < OPENS; i++) {
+    if(!check_file(missing ? files + i : next_random() % files, !missing)) {
+      printf("  FAIL: wrong result for an open of a%s file\n",
+             missing ? " missing" : "n existing");
+      failures++;
+      break;
+    }
+  }
+  us = now_us() - us;
+
+  printf("  %s: %5lu.%02lu headers and %6lu ns per open\n", what,
+         cfs_coffee_stats.header_reads / OPENS,
+         cfs_coffee_stats.header_reads * 100 / OPENS % 100,
+         (unsigned long)(us * 1000 / OPENS));
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a random half of the files, check that exactly those are gone,
+   and recreate them. */
+static void
+check_removal(int files)
+{
+  char name[16];
+  int i;
+
+  memset(removed, 0, sizeof(removed));
+  for(i = 0; i < files / 2; i++) {
+    removed[next_random() % files] = 1;
+  }
+  for(i = 0; i < files; i++) {
+    if(removed[i]) {
+      file_name(name, i);
+      cfs_remove(name);
+    }
+  }
+
+  for(i = 0; i < files; i++) {
+    if(!check_file(i, !removed[i])) {
+      printf("  FAIL: file %d should %sexist after removals\n", i,
+             removed[i] ? "not " : "");
+      failures++;
+      return;
+    }
+  }
+
+  for(i = 0; i < files; i++) {
+    if(removed[i] && !create_file(i)) {
+      printf("  FAIL: could not recreate file %d\n", i);
+      failures++;
+      return;
+    }
+  }
+
+  for(i = 0; i < files; i++) {
+    if(!check_file(i, 1)) {
+      printf("  FAIL: file %d is missing after recreation\n", i);
+      failures++;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(name_bench_process, ev, data)
+{
+  static int i, n;
+
+  PROCESS_BEGIN();
+
+  for(n = 0; n < sizeof(file_counts) / sizeof(file_counts[0]); n++) {
+    printf("%d files:\n", file_counts[n]);
+    cfs_coffee_format();
+    seed = n + 1;
+
+    for(i = 0; i < file_counts[n]; i++) {
+      if(!create_file(i)) {
+        printf("  FAIL: could not create file %d\n", i);
+        failures++;
+        break;
+      }
+    }
+
+    bench_opens("existing", file_counts[n], 0);
+    bench_opens("missing ", file_counts[n], 1);
+    check_removal(file_counts[n]);
+  }
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
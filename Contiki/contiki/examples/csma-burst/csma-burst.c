@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for csma packet trains: a bulk transfer to one
+ *         neighbor competes with a few packets to another neighbor.
+ *         Build with CSMA_CONF_BURST_MAX=1 to compare with one
+ *         packet per wake-up.
+ */
+
+#include "contiki.h"
+#include "net/rime.h"
+#include "net/mac/csma.h"
+
+#include <stdio.h>
+
+#define ROUNDS       5
+#define BULK_PACKETS 12
+#define OTHER_PACKETS 2
+
+/*---------------------------------------------------------------------------*/
+PROCESS(csma_burst_process, "csma burst benchmark");
+AUTOSTART_PROCESSES(&csma_burst_process);
+/*---------------------------------------------------------------------------*/
+static struct unicast_conn bulk_uc, other_uc;
+static int bulk_sent, other_sent;
+static clock_time_t start, bulk_done, other_done;
+/*---------------------------------------------------------------------------*/
+static void
+sent_bulk(struct unicast_conn *c, int status, int num_tx)
+{
+  if(++bulk_sent == BULK_PACKETS) {
+    bulk_done = clock_time() - start;
+  }
+}
+static const struct unicast_callbacks bulk_callbacks = {NULL, sent_bulk};
+/*---------------------------------------------------------------------------*/
+static void
+sent_other(struct unicast_conn *c, int status, int num_tx)
+{
+  if(++other_sent == OTHER_PACKETS) {
+    other_done = clock_time() - start;
+  }
+}
+static const struct unicast_callbacks other_callbacks = {NULL, sent_other};
+/*---------------------------------------------------------------------------*/
+static void
+send(struct unicast_conn *c, uint8_t dest, int i)
+{
+  rimeaddr_t addr;
+
+  packetbuf_clear();
+  packetbuf_set_datalen(sprintf(packetbuf_dataptr(), "packet %d", i));
+  addr.u8[0] = dest;
+  addr.u8[1] = 0;
+  unicast_send(c, &addr);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(csma_burst_process, ev, data)
+{
+  static struct etimer et;
+  static int round;
+  int i;
+
+  PROCESS_EXITHANDLER(unicast_close(&bulk_uc); unicast_close(&other_uc);)
+
+  PROCESS_BEGIN();
+
+  unicast_open(&bulk_uc, 146, &bulk_callbacks);
+  unicast_open(&other_uc, 147, &other_callbacks);
+
+  for(round = 0; round < ROUNDS; round++) {
+    bulk_sent = other_sent = 0;
+    start = clock_time();
+
+    /* Queue the bulk transfer first, so that the other neighbor only
+       gets its turn if the trains are kept short. */
+    for(i = 0; i < BULK_PACKETS; i++) {
+      send(&bulk_uc, 2, i);
+    }
+    for(i = 0; i < OTHER_PACKETS; i++) {
+      send(&other_uc, 3, i);
+    }
+
+    etimer_set(&et, CLOCK_SECOND * 2);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+    printf("round %d: bulk %d/%d in %lu ticks, other %d/%d in %lu ticks\n",
+           round, bulk_sent, BULK_PACKETS, (unsigned long)bulk_done,
+           other_sent, OTHER_PACKETS, (unsigned long)other_done);
+  }
+
+  printf("wakeups %lu packets %lu bursts %lu burst packets %lu max burst %u\n",
+         csma_stats.wakeups, csma_stats.packets, csma_stats.bursts,
+         csma_stats.burst_packets, csma_stats.max_burst);
+  if(csma_stats.packets > 0) {
+    printf("wakeups per 100 packets %lu\n",
+           100 * csma_stats.wakeups / csma_stats.packets);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for Deluge delta updates on the native platform.
+ *         Patches between builds of a module are applied to the base
+ *         module in Coffee, and the result is compared with the new
+ *         module.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+#include "dev/xmem-native.h"
+#include "deluge.h"
+#include "deluge-patch.h"
+
+#define MAX_FILE_SIZE	32768
+#define RUNS		20
+
+static const char *updates[] = {
+  "collect-window", "collect-listen"
+};
+
+static unsigned char data[MAX_FILE_SIZE];
+static unsigned char check[MAX_FILE_SIZE];
+static int failures;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(deluge_patch_bench_process, "Deluge patch benchmark");
+AUTOSTART_PROCESSES(&deluge_patch_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static long
+read_host_file(const char *name, unsigned char *buf)
+{
+  FILE *f;
+  long size;
+
+  f = fopen(name, "rb");
+  if(f == NULL) {
+    printf("Failed to open %s, which make builds\n", name);
+    return -1;
+  }
+  size = fread(buf, 1, MAX_FILE_SIZE, f);
+  fclose(f);
+  return size;
+}
+/*---------------------------------------------------------------------------*/
+/* Copy a file of the host into Coffee, padded to whole Deluge pages
+   like a file that Deluge has received. */
+static long
+store(const char *host_name, const char *name)
+{
+  long size, padded;
+  int fd;
+
+  size = read_host_file(host_name, data);
+  if(size < 0) {
+    return -1;
+  }
+  padded = (size + S_PAGE - 1) / S_PAGE * S_PAGE;
+  memset(data + size, 0, padded - size);
+
+  cfs_remove(name);
+  fd = cfs_open(name, CFS_WRITE);
+  if(fd < 0 || cfs_write(fd, data, padded) != padded) {
+    printf("Failed to write %s\n", name);
+    if(fd >= 0) {
+      cfs_close(fd);
+    }
+    return -1;
+  }
+  cfs_close(fd);
+  return size;
+}
+/*---------------------------------------------------------------------------*/
+static int
+same_as(const char *host_name, const char *name)
+{
+  long size;
+  int fd, len;
+
+  size = read_host_file(host_name, data);
+  fd = cfs_open(name, CFS_READ);
+  if(size < 0 || fd < 0) {
+    return 0;
+  }
+  len = cfs_read(fd, check, sizeof(check));
+  cfs_close(fd);
+  return len == size && memcmp(data, check, size) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_update(const char *update)
+{
+  char module[32], patch[32];
+  long base_size, target_size, patch_size;
+  unsigned long long us;
+  unsigned long reads, read_bytes, written_bytes;
+  int i, r;
+
+  snprintf(module, sizeof(module), "%s.ce", update);
+  snprintf(patch, sizeof(patch), "%s.patch", update);
+
+  base_size = store("collect.ce", "base");
+  patch_size = store(patch, "patch");
+  target_size = read_host_file(module, data);
+  if(base_size < 0 || patch_size < 0 || target_size < 0) {
+    failures++;
+    return;
+  }
+
+  reads = read_bytes = written_bytes = 0;
+  us = 0;
+  r = 0;
+  for(i = 0; i < RUNS && r == 0; i++) {
+    cfs_remove("target");
+    memset(&xmem_stats, 0, sizeof(xmem_stats));
+    us -= now_us();
+    r = deluge_patch("patch", "base", "target");
+    us += now_us();
+    reads += xmem_stats.reads;
+    read_bytes += xmem_stats.read_bytes;
+    written_bytes += xmem_stats.written_bytes;
+  }
+
+  printf("%s: %ld bytes, patch %ld bytes (%.1f%%), %ld pages instead of %ld\n",
+         update, target_size, patch_size, 100.0 * patch_size / target_size,
+         (patch_size + S_PAGE - 1) / S_PAGE,
+         (target_size + S_PAGE - 1) / S_PAGE);
+  if(r != 0) {
+    printf("  FAIL: the patch could not be applied\n");
+    failures++;
+    return;
+  }
+  printf("  applied in %lu us, %lu flash reads of %lu bytes, "
+         "%lu bytes written\n",
+         (unsigned long)(us / RUNS), reads / RUNS, read_bytes / RUNS,
+         written_bytes / RUNS);
+
+  if(!same_as(module, "target")) {
+    printf("  FAIL: the new file differs from %s\n", module);
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_wrong_base(void)
+{
+  /* A patch that is applied to another base must not produce a file. */
+  if(store("collect-listen.ce", "base") < 0 ||
+     store("collect-window.patch", "patch") < 0) {
+    failures++;
+    return;
+  }
+  cfs_remove("target");
+  if(deluge_patch("patch", "base", "target") != -1) {
+    printf("FAIL: a patch was applied to the wrong base\n");
+    failures++;
+  }
+  if(cfs_open("target", CFS_READ) >= 0) {
+    printf("FAIL: a file was left after a failed patch\n");
+    failures++;
+  }
+
+  /* A patch can not write over its base. */
+  if(deluge_patch("patch", "base", "base") != -1) {
+    printf("FAIL: a patch was applied to its own base\n");
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(deluge_patch_bench_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  cfs_coffee_format();
+
+  for(i = 0; i < sizeof(updates) / sizeof(updates[0]); i++) {
+    run_update(updates[i]);
+  }
+  check_wrong_base();
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
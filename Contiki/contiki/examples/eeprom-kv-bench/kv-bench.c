@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for the EEPROM key/value store. A set of 
+ *         configuration values is saved over and over on an emulated
+ *         EEPROM that counts the writes to each cell. The store is 
+ *         reloaded regularly, also after losing the unwritten page
+ *         buffer, and compared with a copy in RAM.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "dev/eeprom.h"
+#include "cfs/eeprom-kv.h"
+
+#define EEPROM_SIZE	1024
+#define SAVES		20000
+#define KEYS		8
+#define VALUE_SIZE	24
+#define LOOKUPS		100000
+
+static const char *keys[KEYS] = {
+  "channel", "txpower", "pan-id", "name",
+  "interval", "threshold", "gateway", "calibration"
+};
+
+static unsigned char eeprom[EEPROM_SIZE];
+static unsigned long cell_writes[EEPROM_SIZE];
+static unsigned long write_ops, written_bytes, read_ops, read_bytes;
+
+static unsigned char values[KEYS][VALUE_SIZE];
+static int lengths[KEYS];
+static unsigned char saved_values[KEYS][VALUE_SIZE];
+static int saved_lengths[KEYS];
+static unsigned long updates[KEYS];
+
+static unsigned long seed;
+static int failures;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(kv_bench_process, "EEPROM key/value benchmark");
+AUTOSTART_PROCESSES(&kv_bench_process);
+/*---------------------------------------------------------------------------*/
+/* The emulated EEPROM replaces the driver of the platform. */
+void
+eeprom_write(eeprom_addr_t addr, unsigned char *buf, int size)
+{
+  int i;
+
+  for(i = 0; i < size; i++) {
+    eeprom[addr + i] = buf[i];
+    cell_writes[addr + i]++;
+  }
+  write_ops++;
+  written_bytes += size;
+}
+/*---------------------------------------------------------------------------*/
+void
+eeprom_read(eeprom_addr_t addr, unsigned char *buf, int size)
+{
+  memcpy(buf, &eeprom[addr], size);
+  read_ops++;
+  read_bytes += size;
+}
+/*---------------------------------------------------------------------------*/
+void
+eeprom_init(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+next_random(void)
+{
+  seed = seed * 1103515245UL + 12345;
+  return (unsigned)(seed >> 16) & 0x7fff;
+}
+/*---------------------------------------------------------------------------*/
+static void
+reset_counters(void)
+{
+  write_ops = written_bytes = read_ops = read_bytes = 0;
+  memset(cell_writes, 0, sizeof(cell_writes));
+}
+/*---------------------------------------------------------------------------*/
+/* Compare the store with the values in RAM. After a lost page buffer,
+   a key may also have its value from the last flush. */
+static void
+verify(const char *when, int allow_saved)
+{
+  unsigned char buf[VALUE_SIZE];
+  int i, len;
+
+  for(i = 0; i < KEYS; i++) {
+    len = eeprom_kv_get(keys[i], buf, sizeof(buf));
+    if(len == lengths[i] && (len < 0 || memcmp(buf, values[i], len) == 0)) {
+      continue;
+    }
+    if(allow_saved && len == saved_lengths[i] &&
+       (len < 0 || memcmp(buf, saved_values[i], len) == 0)) {
+      lengths[i] = len;
+      memcpy(values[i], buf, len > 0 ? len : 0);
+      continue;
+    }
+    printf("FAIL: wrong value of %s %s (length %d, expected %d)\n",
+           keys[i], when, len, lengths[i]);
+    failures++;
+    lengths[i] = len;
+    if(len > 0) {
+      memcpy(values[i], buf, len);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+save(int i)
+{
+  int j;
+
+  if(next_random() % 16 == 0) {
+    /* Remove the key now and then. */
+    if(eeprom_kv_remove(keys[i]) < 0 && lengths[i] >= 0) {
+      printf("FAIL: could not remove %s\n", keys[i]);
+      failures++;
+    }
+    lengths[i] = -1;
+    return;
+  }
+
+  lengths[i] = 1 + next_random() % VALUE_SIZE;
+  for(j = 0; j < lengths[i]; j++) {
+    values[i][j] = next_random();
+  }
+  if(eeprom_kv_put(keys[i], values[i], lengths[i]) != lengths[i]) {
+    printf("FAIL: could not save %s\n", keys[i]);
+    failures++;
+  }
+  updates[i]++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_saves(void)
+{
+  unsigned long long us;
+  unsigned long max_writes, max_updates, total;
+  int s, i, n, first;
+
+  reset_counters();
+  us = now_us();
+  for(s = 0; s < SAVES; s++) {
+    /* Change one to three different values, and write them in one
+       batch. */
+    first = next_random();
+    for(n = 1 + next_random() % 3; n > 0; n--) {
+      save((first + n) % KEYS);
+    }
+
+    if(s % 97 == 0) {
+      /* Lose the page buffer, as in a power failure. */
+      eeprom_kv_init();
+      verify("after a power failure", 1);
+    } else {
+      eeprom_kv_flush();
+    }
+    memcpy(saved_values, values, sizeof(values));
+    memcpy(saved_lengths, lengths, sizeof(lengths));
+
+    if(s % 1000 == 0) {
+      eeprom_kv_init();
+      verify("after a reload", 0);
+    }
+  }
+  us = now_us() - us;
+
+  max_writes = total = 0;
+  for(i = 0; i < EEPROM_SIZE; i++) {
+    total += cell_writes[i];
+    if(cell_writes[i] > max_writes) {
+      max_writes = cell_writes[i];
+    }
+  }
+  max_updates = 0;
+  for(i = 0; i < KEYS; i++) {
+    if(updates[i] > max_updates) {
+      max_updates = updates[i];
+    }
+  }
+
+  printf("%d saves of %d keys in %lu us\n", SAVES, KEYS, (unsigned long)us);
+  printf("Writes: %lu of %lu bytes\n", write_ops, written_bytes);
+  printf("Writes per cell: max %lu, mean %lu (%lu in place)\n",
+         max_writes, total / EEPROM_SIZE, max_updates);
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_lookups(void)
+{
+  unsigned char buf[VALUE_SIZE];
+  unsigned long long us;
+  int i;
+
+  reset_counters();
+  us = now_us();
+  eeprom_kv_init();
+  us = now_us() - us;
+  printf("Load: %lu us, %lu reads of %lu bytes\n",
+         (unsigned long)us, read_ops, read_bytes);
+
+  reset_counters();
+  us = now_us();
+  for(i = 0; i < LOOKUPS; i++) {
+    eeprom_kv_get(keys[i % KEYS], buf, sizeof(buf));
+  }
+  us = now_us() - us;
+  printf("Lookup: %lu ns, %lu reads per lookup\n",
+         (unsigned long)(us * 1000 / LOOKUPS), read_ops / LOOKUPS);
+  verify("after the lookups", 0);
+}
+/*---------------------------------------------------------------------------*/
+/* Fill the store with large values until it is full, and check that
+   the values that were saved survive a reload. */
+static void
+run_fill(void)
+{
+  static const char *fill_keys[] = {
+    "a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m", "n"
+  };
+  unsigned char value[100], buf[100];
+  int i, saved;
+
+  eeprom_kv_format();
+  memset(value, 0x5a, sizeof(value));
+  for(saved = 0; saved < sizeof(fill_keys) / sizeof(fill_keys[0]); saved++) {
+    if(eeprom_kv_put(fill_keys[saved], value, sizeof(value)) < 0) {
+      break;
+    }
+  }
+  eeprom_kv_flush();
+  printf("Capacity: %d values of %d bytes\n", saved, (int)sizeof(value));
+
+  eeprom_kv_init();
+  for(i = 0; i < saved; i++) {
+    if(eeprom_kv_get(fill_keys[i], buf, sizeof(buf)) != sizeof(buf) ||
+       memcmp(buf, value, sizeof(buf)) != 0) {
+      printf("FAIL: %s was lost when the store became full\n", fill_keys[i]);
+      failures++;
+    }
+  }
+  if(saved == 0 || saved == sizeof(fill_keys) / sizeof(fill_keys[0])) {
+    printf("FAIL: the store did not fill up as expected\n");
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(kv_bench_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  memset(eeprom, 0xff, sizeof(eeprom));
+  if(eeprom_kv_init() >= 0) {
+    printf("FAIL: an erased EEPROM was not formatted\n");
+    failures++;
+  }
+  for(i = 0; i < KEYS; i++) {
+    lengths[i] = saved_lengths[i] = -1;
+  }
+
+  seed = 1;
+  run_saves();
+  run_lookups();
+  run_fill();
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
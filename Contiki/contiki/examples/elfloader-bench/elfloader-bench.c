@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for the ELF loader over Coffee on the native
+ *         platform. 32-bit x86 modules are written to the flash
+ *         emulation and loaded repeatedly. The time, the flash reads
+ *         and the bytes read per load are reported, and every
+ *         relocation is checked against the original module.
+ */
+
+#include <elf.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+#include "dev/xmem-native.h"
+#include "loader/elfloader.h"
+#include "loader/elfloader-arch.h"
+#include "loader/symtab.h"
+
+#define LOADS		20
+#define MAX_MODULE_SIZE	32768
+
+static const char *modules[] = {
+  "hello-world.ce", "collect.ce", "collect-prelinked.ce"
+};
+
+static unsigned char original[MAX_MODULE_SIZE];
+static unsigned char loaded[MAX_MODULE_SIZE];
+static int failures;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(elfloader_bench_process, "ELF loader benchmark");
+AUTOSTART_PROCESSES(&elfloader_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static long
+read_module(const char *name)
+{
+  FILE *f;
+  long size;
+
+  f = fopen(name, "rb");
+  if(f == NULL) {
+    printf("Failed to open %s, which make builds\n", name);
+    return -1;
+  }
+  size = fread(original, 1, sizeof(original), f);
+  fclose(f);
+  return size;
+}
+/*---------------------------------------------------------------------------*/
+static int
+write_module(long size)
+{
+  int fd;
+
+  cfs_remove("module");
+  fd = cfs_open("module", CFS_WRITE);
+  if(fd < 0) {
+    return -1;
+  }
+  if(cfs_write(fd, original, size) != size) {
+    cfs_close(fd);
+    return -1;
+  }
+  cfs_close(fd);
+  return cfs_open("module", CFS_READ | CFS_WRITE);
+}
+/*---------------------------------------------------------------------------*/
+static int
+find_section(Elf32_Shdr *shdrs, int shnum, const char *strings,
+             const char *name)
+{
+  int i;
+
+  for(i = 0; i < shnum; i++) {
+    if(strcmp(strings + shdrs[i].sh_name, name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+/* Apply the relocations of the original module independently of the
+   loader, with the section addresses that the x86 loader allocates,
+   and compare with the module that the loader relocated. */
+static int
+check_relocations(long size)
+{
+  Elf32_Ehdr *ehdr;
+  Elf32_Shdr *shdrs, *rel;
+  Elf32_Sym *syms, *sym;
+  const char *strings, *names;
+  uint32_t base[4], address[64], s, p, a, value;
+  int sections[4], i, j, errors;
+  char *ram, *rom;
+
+  ehdr = (Elf32_Ehdr *)original;
+  shdrs = (Elf32_Shdr *)(original + ehdr->e_shoff);
+  strings = (const char *)original + shdrs[ehdr->e_shstrndx].sh_offset;
+
+  /* The loader puts .bss before .data in RAM and .rodata after .text
+     in ROM. */
+  sections[0] = find_section(shdrs, ehdr->e_shnum, strings, ".text");
+  sections[1] = find_section(shdrs, ehdr->e_shnum, strings, ".rodata");
+  sections[2] = find_section(shdrs, ehdr->e_shnum, strings, ".data");
+  sections[3] = find_section(shdrs, ehdr->e_shnum, strings, ".bss");
+  rom = elfloader_arch_allocate_rom(0);
+  ram = elfloader_arch_allocate_ram(0);
+  base[0] = (uintptr_t)rom;
+  base[1] = base[0] + shdrs[sections[0]].sh_size;
+  base[3] = (uintptr_t)ram;
+  base[2] = base[3] + (sections[3] >= 0 ? shdrs[sections[3]].sh_size : 0);
+  memset(address, 0, sizeof(address));
+  for(i = 0; i < 4; i++) {
+    if(sections[i] >= 0 && sections[i] < 64) {
+      address[sections[i]] = base[i];
+    }
+  }
+
+  if(memcmp(rom, loaded + shdrs[sections[0]].sh_offset,
+            shdrs[sections[0]].sh_size) != 0) {
+    printf("  FAIL: the text in memory differs from the file\n");
+    return 1;
+  }
+
+  errors = 0;
+  for(i = 0; i < ehdr->e_shnum; i++) {
+    rel = &shdrs[i];
+    if(rel->sh_type != SHT_REL || (rel->sh_info != sections[0] &&
+                                   rel->sh_info != sections[1] &&
+                                   rel->sh_info != sections[2])) {
+      continue;
+    }
+    syms = (Elf32_Sym *)(original + shdrs[rel->sh_link].sh_offset);
+    names = (const char *)original + shdrs[shdrs[rel->sh_link].sh_link].sh_offset;
+    for(j = 0; j < rel->sh_size / sizeof(Elf32_Rel); j++) {
+      Elf32_Rel *r = (Elf32_Rel *)(original + rel->sh_offset) + j;
+      sym = &syms[ELF32_R_SYM(r->r_info)];
+      if(sym->st_shndx == SHN_UNDEF) {
+        s = (uintptr_t)symtab_lookup(names + sym->st_name);
+      } else if(sym->st_shndx < 64) {
+        s = address[sym->st_shndx] + sym->st_value;
+      } else {
+        s = 0;
+      }
+      p = shdrs[rel->sh_info].sh_offset + r->r_offset;
+      memcpy(&a, original + p, 4);
+      memcpy(&value, loaded + p, 4);
+      if(ELF32_R_TYPE(r->r_info) == R_386_PC32) {
+        s -= address[rel->sh_info] + r->r_offset;
+      }
+      if(value != s + a) {
+        errors++;
+      }
+    }
+  }
+  if(errors > 0) {
+    printf("  FAIL: %d relocations differ\n", errors);
+  }
+  return errors > 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(const char *name)
+{
+  unsigned long long us;
+  unsigned long reads, read_bytes;
+  long size;
+  int i, fd, ret;
+
+  size = read_module(name);
+  if(size <= 0) {
+    failures++;
+    return;
+  }
+
+  us = 0;
+  reads = read_bytes = 0;
+  ret = ELFLOADER_OK;
+  for(i = 0; i < LOADS; i++) {
+    fd = write_module(size);
+    if(fd < 0) {
+      printf("  FAIL: could not write %s\n", name);
+      failures++;
+      return;
+    }
+
+    memset(&xmem_stats, 0, sizeof(xmem_stats));
+    us -= now_us();
+    ret = elfloader_load(fd);
+    us += now_us();
+    reads += xmem_stats.reads;
+    read_bytes += xmem_stats.read_bytes;
+
+    cfs_seek(fd, 0, CFS_SEEK_SET);
+    cfs_read(fd, loaded, size);
+    cfs_close(fd);
+
+    if(ret != ELFLOADER_OK || elfloader_autostart_processes == NULL) {
+      printf("  FAIL: %s did not load: %d %s\n", name, ret,
+             elfloader_unknown);
+      failures++;
+      return;
+    }
+  }
+
+  printf("%-22s %6ld bytes: %7lu us, %6lu reads, %8lu bytes read per load\n",
+         name, size, (unsigned long)(us / LOADS), reads / LOADS,
+         read_bytes / LOADS);
+  failures += check_relocations(size);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(elfloader_bench_process, ev, data)
+{
+  static int i;
+
+  PROCESS_BEGIN();
+
+  elfloader_init();
+  cfs_coffee_format();
+
+  for(i = 0; i < sizeof(modules) / sizeof(modules[0]); i++) {
+    bench(modules[i]);
+  }
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for the resource dispatch of Erbium on the native
+ *         platform. Requests for random resources, sub-resources and
+ *         missing resources are dispatched with a stub REST
+ *         implementation, and every result is checked against a
+ *         brute-force match.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "erbium.h"
+
+#define MAX_RESOURCES	1024
+#define REQUESTS	200000
+#define URL_SIZE	32
+
+static const int resource_counts[] = {10, 50, 200, 1000};
+
+struct bench_request {
+  const char *url;
+  int url_len;
+  rest_resource_flags_t method;
+  unsigned int status;
+};
+
+static resource_t resources[MAX_RESOURCES];
+static char urls[MAX_RESOURCES][URL_SIZE];
+static char request_urls[1024][URL_SIZE];
+static resource_t *expected[1024];
+static resource_t *invoked;
+static unsigned long seed;
+static int failures;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(erbium_bench_process, "Erbium dispatch benchmark");
+AUTOSTART_PROCESSES(&erbium_bench_process);
+/*---------------------------------------------------------------------------*/
+static void
+bench_init(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_set_service_callback(service_callback_t callback)
+{
+}
+/*---------------------------------------------------------------------------*/
+static int
+bench_get_url(void *request, const char **url)
+{
+  *url = ((struct bench_request *)request)->url;
+  return ((struct bench_request *)request)->url_len;
+}
+/*---------------------------------------------------------------------------*/
+static rest_resource_flags_t
+bench_get_method_type(void *request)
+{
+  return ((struct bench_request *)request)->method;
+}
+/*---------------------------------------------------------------------------*/
+static int
+bench_set_response_status(void *response, unsigned int code)
+{
+  ((struct bench_request *)response)->status = code;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+bench_pre_handler(resource_t *resource, void *request, void *response)
+{
+  invoked = resource;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_handler(void *request, void *response, uint8_t *buffer,
+              uint16_t preferred_size, int32_t *offset)
+{
+}
+/*---------------------------------------------------------------------------*/
+const struct rest_implementation bench_rest_implementation = {
+  .name = "bench",
+  .init = bench_init,
+  .set_service_callback = bench_set_service_callback,
+  .get_url = bench_get_url,
+  .get_method_type = bench_get_method_type,
+  .set_response_status = bench_set_response_status,
+  .default_pre_handler = bench_pre_handler,
+  .status = {.NOT_FOUND = 404, .METHOD_NOT_ALLOWED = 405}
+};
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+next_random(void)
+{
+  seed = seed * 1103515245UL + 12345;
+  return (unsigned)(seed >> 16) & 0x7fff;
+}
+/*---------------------------------------------------------------------------*/
+/* The resources look like those of a proxy for many nodes. Every
+   tenth resource handles its sub-resources. */
+static void
+activate(int count)
+{
+  int i;
+
+  rest_init_engine();
+  for(i = 0; i < count; i++) {
+    switch(i % 3) {
+    case 0:
+      snprintf(urls[i], URL_SIZE, "nodes/%d/sensors/temp", i / 3);
+      break;
+    case 1:
+      snprintf(urls[i], URL_SIZE, "nodes/%d/sensors/light", i / 3);
+      break;
+    default:
+      snprintf(urls[i], URL_SIZE, "nodes/%d/actuators/leds", i / 3);
+      break;
+    }
+    memset(&resources[i], 0, sizeof(resources[i]));
+    resources[i].flags = METHOD_GET | METHOD_PUT;
+    if(i % 10 == 9) {
+      resources[i].flags |= HAS_SUB_RESOURCES;
+    }
+    resources[i].url = urls[i];
+    resources[i].attributes = (i % 3 == 2) ? "" : "rt=\"sensor\"";
+    resources[i].handler = bench_handler;
+    rest_activate_resource(&resources[i]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The resource with the URL, or else the one with the longest prefix
+   that handles sub-resources. */
+static resource_t *
+brute_force(const char *url, int count)
+{
+  resource_t *best;
+  int i, len, best_len;
+
+  best = NULL;
+  best_len = 0;
+  for(i = 0; i < count; i++) {
+    len = strlen(resources[i].url);
+    if(strcmp(url, resources[i].url) == 0) {
+      return &resources[i];
+    }
+    if((resources[i].flags & HAS_SUB_RESOURCES) && len > best_len &&
+       strncmp(url, resources[i].url, len) == 0 && url[len] == '/') {
+      best = &resources[i];
+      best_len = len;
+    }
+  }
+  return best;
+}
+/*---------------------------------------------------------------------------*/
+/* Two thirds of the requests are for resources, and the rest are for
+   sub-resources or for missing resources. */
+static void
+generate(int count)
+{
+  int i, r;
+
+  for(i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+    r = next_random() % count;
+    switch(next_random() % 6) {
+    case 0:
+      snprintf(request_urls[i], URL_SIZE, "%s/x/%d", urls[r], i);
+      break;
+    case 1:
+      snprintf(request_urls[i], URL_SIZE, "nodes/%d/sensors", r);
+      break;
+    default:
+      snprintf(request_urls[i], URL_SIZE, "%s", urls[r]);
+      break;
+    }
+    expected[i] = brute_force(request_urls[i], count);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+run(int count)
+{
+  struct bench_request request;
+  unsigned long long us;
+  unsigned long found;
+  int i, n;
+
+  activate(count);
+  generate(count);
+
+  found = 0;
+  us = now_us();
+  for(i = 0; i < REQUESTS; i++) {
+    n = i % (sizeof(expected) / sizeof(expected[0]));
+    request.url = request_urls[n];
+    request.url_len = strlen(request_urls[n]);
+    request.method = METHOD_GET;
+    request.status = 0;
+    invoked = NULL;
+    found += rest_invoke_restful_service(&request, &request, NULL, 0, NULL);
+    if(invoked != expected[n] ||
+       (invoked == NULL && request.status != 404)) {
+      if(failures++ < 5) {
+        printf("  FAIL: /%s dispatched to /%s\n", request_urls[n],
+               invoked ? invoked->url : "(none)");
+      }
+    }
+  }
+  us = now_us() - us;
+
+  printf("%4d resources: %8lu requests/s, %lu found\n", count,
+         (unsigned long)(REQUESTS * 1000000ULL / (us ? us : 1)), found);
+
+  /* A method that the resource does not handle. */
+  request.url = urls[0];
+  request.url_len = strlen(urls[0]);
+  request.method = METHOD_POST;
+  request.status = 0;
+  if(rest_invoke_restful_service(&request, &request, NULL, 0, NULL) ||
+     request.status != 405) {
+    printf("  FAIL: POST was allowed\n");
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_link_format(int count)
+{
+  static char expected_format[MAX_RESOURCES * (URL_SIZE + 16)];
+  const char *format;
+  int i, len;
+
+  for(i = len = 0; i < count; i++) {
+    len += sprintf(expected_format + len, "%s</%s>%s%s", i ? "," : "",
+                   resources[i].url, resources[i].attributes[0] ? ";" : "",
+                   resources[i].attributes);
+  }
+  if(rest_get_link_format(&format) != len ||
+     memcmp(format, expected_format, len) != 0) {
+    printf("  FAIL: the cached link format differs\n");
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(erbium_bench_process, ev, data)
+{
+  static int i;
+
+  PROCESS_BEGIN();
+
+  for(i = 0; i < sizeof(resource_counts) / sizeof(resource_counts[0]); i++) {
+    seed = resource_counts[i];
+    run(resource_counts[i]);
+    check_link_format(resource_counts[i]);
+  }
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2014, Contiki-Sensor-Node contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         A node of the DAO convergence simulation. It joins the DAG
+ *         and reports how many DAOs it has sent and forwarded.
+ */
+
+#include "contiki.h"
+#include "net/uip.h"
+#include "net/uip-ds6.h"
+
+#include "net/rpl/rpl-private.h"
+
+#include <stdio.h>
+
+/*---------------------------------------------------------------------------*/
+PROCESS(dao_node_process, "DAO node process");
+AUTOSTART_PROCESSES(&dao_node_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(dao_node_process, ev, data)
+{
+  static struct etimer et;
+  static uint16_t sent, forwarded;
+  uip_ipaddr_t ipaddr;
+
+  PROCESS_BEGIN();
+
+  uip_ip6addr(&ipaddr, 0xaaaa, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&ipaddr, &uip_lladdr);
+  uip_ds6_addr_add(&ipaddr, 0, ADDR_AUTOCONF);
+
+  sent = forwarded = 0;
+  etimer_set(&et, CLOCK_SECOND);
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+
+    /* Report only when the counters have changed, to keep the log
+       short. */
+    if(rpl_stats.dao_sent != sent || rpl_stats.dao_forwarded != forwarded) {
+      sent = rpl_stats.dao_sent;
+      forwarded = rpl_stats.dao_forwarded;
+      printf("DAO %u %u %u %u\n", rpl_stats.dao_sent,
+             rpl_stats.dao_forwarded, rpl_stats.dao_aggregated,
+             rpl_stats.dao_retransmissions);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2014, Contiki-Sensor-Node contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         The root of the DAO convergence simulation. It reports the
+ *         number of downward routes that it has learned from DAOs.
+ */
+
+#include "contiki.h"
+#include "net/uip.h"
+#include "net/uip-ds6.h"
+#include "net/netstack.h"
+
+#include "net/rpl/rpl.h"
+
+#include <stdio.h>
+
+extern uip_ds6_route_t uip_ds6_routing_table[];
+
+/*---------------------------------------------------------------------------*/
+PROCESS(dao_root_process, "DAO root process");
+AUTOSTART_PROCESSES(&dao_root_process);
+/*---------------------------------------------------------------------------*/
+static int
+count_routes(void)
+{
+  int i;
+  int routes;
+
+  routes = 0;
+  for(i = 0; i < UIP_DS6_ROUTE_NB; i++) {
+    if(uip_ds6_routing_table[i].isused) {
+      routes++;
+    }
+  }
+  return routes;
+}
+/*---------------------------------------------------------------------------*/
+static void
+create_rpl_dag(void)
+{
+  uip_ipaddr_t ipaddr;
+  rpl_dag_t *dag;
+
+  uip_ip6addr(&ipaddr, 0xaaaa, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&ipaddr, &uip_lladdr);
+  uip_ds6_addr_add(&ipaddr, 0, ADDR_MANUAL);
+
+  dag = rpl_set_root(RPL_DEFAULT_INSTANCE, &ipaddr);
+  if(dag == NULL) {
+    printf("Failed to create a new RPL DAG\n");
+    return;
+  }
+  uip_ip6addr(&ipaddr, 0xaaaa, 0, 0, 0, 0, 0, 0, 0);
+  rpl_set_prefix(dag, &ipaddr, 64);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(dao_root_process, ev, data)
+{
+  static struct etimer et;
+  static int routes;
+  int r;
+
+  PROCESS_BEGIN();
+
+  create_rpl_dag();
+
+  /* The root listens all the time, so that DAOs are not lost to its
+     duty cycle. */
+  NETSTACK_MAC.off(1);
+
+  routes = 0;
+  etimer_set(&et, CLOCK_SECOND);
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+
+    r = count_routes();
+    if(r != routes) {
+      routes = r;
+      printf("ROUTES %d\n", routes);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
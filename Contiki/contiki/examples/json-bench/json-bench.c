@@ -0,0 +1,598 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for the JSON tokenizer, the struct binder, the span
+ *         writer and CBOR of apps/json on the native platform, compared
+ *         with the parser and the output of jsontree as they were before.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "jsonparse.h"
+#include "jsontree.h"
+#include "legacy-json.h"
+
+#define READINGS	1000
+/* Each measurement is the best of this many passes over the readings. */
+#define ROUNDS		100
+#define BUFFER_SIZE	(READINGS * 256)
+
+static int write_out(const char *data, int len);
+
+struct location {
+  int16_t x;
+  int16_t y;
+};
+
+struct reading {
+  char node[12];
+  int32_t seq;
+  int16_t temp;
+  uint8_t hum;
+  uint8_t ok;
+  struct location loc;
+  char unit[4];
+};
+
+static const struct jsonparse_binding location_bindings[] = {
+  JSONPARSE_BIND_INT(struct location, x, "x"),
+  JSONPARSE_BIND_INT(struct location, y, "y")
+};
+
+static const struct jsonparse_binding reading_bindings[] = {
+  JSONPARSE_BIND_STRING(struct reading, node, "node"),
+  JSONPARSE_BIND_INT(struct reading, seq, "seq"),
+  JSONPARSE_BIND_INT(struct reading, temp, "temp"),
+  JSONPARSE_BIND_INT(struct reading, hum, "hum"),
+  JSONPARSE_BIND_BOOL(struct reading, ok, "ok"),
+  JSONPARSE_BIND_OBJECT(struct reading, loc, "loc", location_bindings),
+  JSONPARSE_BIND_STRING(struct reading, unit, "unit")
+};
+
+#define BINDINGS (sizeof(reading_bindings) / sizeof(struct jsonparse_binding))
+
+/* The tree that a reading is serialized from. The samples are not part
+   of the struct and are skipped by the parsers. */
+static struct jsontree_string node_value = JSONTREE_STRING("");
+static struct jsontree_int seq_value = { JSON_TYPE_INT, 0 };
+static struct jsontree_int temp_value = { JSON_TYPE_INT, 0 };
+static struct jsontree_int hum_value = { JSON_TYPE_INT, 0 };
+static struct jsontree_int ok_value = { JSON_TYPE_INT, 0 };
+static struct jsontree_int x_value = { JSON_TYPE_INT, 0 };
+static struct jsontree_int y_value = { JSON_TYPE_INT, 0 };
+static struct jsontree_string unit_value = JSONTREE_STRING("C");
+static struct jsontree_int sample_values[4] = {
+  { JSON_TYPE_INT, 0 }, { JSON_TYPE_INT, 0 },
+  { JSON_TYPE_INT, 0 }, { JSON_TYPE_INT, 0 }
+};
+static struct jsontree_value *samples_list[] = {
+  (struct jsontree_value *)&sample_values[0],
+  (struct jsontree_value *)&sample_values[1],
+  (struct jsontree_value *)&sample_values[2],
+  (struct jsontree_value *)&sample_values[3]
+};
+static struct jsontree_array samples_array = {
+  JSON_TYPE_ARRAY, 4, samples_list
+};
+
+JSONTREE_OBJECT(loc_tree,
+                JSONTREE_PAIR("x", &x_value),
+                JSONTREE_PAIR("y", &y_value));
+JSONTREE_OBJECT(reading_tree,
+                JSONTREE_PAIR("node", &node_value),
+                JSONTREE_PAIR("seq", &seq_value),
+                JSONTREE_PAIR("temp", &temp_value),
+                JSONTREE_PAIR("hum", &hum_value),
+                JSONTREE_PAIR("ok", &ok_value),
+                JSONTREE_PAIR("samples", &samples_array),
+                JSONTREE_PAIR("loc", &loc_tree),
+                JSONTREE_PAIR("unit", &unit_value));
+
+static struct reading readings[READINGS];
+static struct reading parsed[READINGS];
+static char node_names[READINGS][12];
+
+static char json_text[BUFFER_SIZE];
+static int json_offsets[READINGS + 1];
+static char cbor_data[BUFFER_SIZE];
+static int cbor_offsets[READINGS + 1];
+static char out[BUFFER_SIZE];
+static int out_len;
+static int failures;
+
+static char write_buffer[128];
+static struct jsontree_writer buffered_writer = {
+  write_out, write_buffer, sizeof(write_buffer)
+};
+static struct jsontree_writer direct_writer = { write_out, NULL };
+
+/*---------------------------------------------------------------------------*/
+PROCESS(json_bench_process, "JSON benchmark");
+AUTOSTART_PROCESSES(&json_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+fail(const char *message)
+{
+  if(failures++ < 10) {
+    printf("  FAIL: %s\n", message);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The output functions check the space left, as the putchar of
+   examples/ipv6/json-ws does. */
+static int
+putchar_out(int c)
+{
+  if(out_len < sizeof(out)) {
+    out[out_len++] = c;
+    return c;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+write_out(const char *data, int len)
+{
+  if(out_len + len <= sizeof(out)) {
+    memcpy(out + out_len, data, len);
+    out_len += len;
+    return len;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+generate(void)
+{
+  unsigned long seed = 1;
+  int i;
+
+  for(i = 0; i < READINGS; i++) {
+    seed = seed * 1103515245UL + 12345;
+    snprintf(node_names[i], sizeof(node_names[i]), "node-%u",
+             (unsigned)(seed >> 16) % 500);
+    strcpy(readings[i].node, node_names[i]);
+    readings[i].seq = i * 37;
+    readings[i].temp = (seed >> 8) % 400;
+    readings[i].hum = (seed >> 4) % 100;
+    readings[i].ok = i % 7 != 0;
+    readings[i].loc.x = (seed >> 12) % 1000;
+    readings[i].loc.y = (seed >> 20) % 1000;
+    strcpy(readings[i].unit, "C");
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_tree(int i)
+{
+  int j;
+
+  node_value.value = node_names[i];
+  seq_value.value = readings[i].seq;
+  temp_value.value = readings[i].temp;
+  hum_value.value = readings[i].hum;
+  ok_value.value = readings[i].ok;
+  x_value.value = readings[i].loc.x;
+  y_value.value = readings[i].loc.y;
+  for(j = 0; j < 4; j++) {
+    sample_values[j].value = readings[i].temp + j;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Serialize all readings in one of the modes, recording where each
+   one starts. */
+static void
+serialize(int mode, int *offsets)
+{
+  struct legacy_jsontree_context legacy;
+  struct jsontree_context js_ctx;
+  int i;
+
+  out_len = 0;
+  for(i = 0; i < READINGS; i++) {
+    set_tree(i);
+    if(offsets != NULL) {
+      offsets[i] = out_len;
+    }
+    switch(mode) {
+    case 0:
+      legacy.values[0] = (struct jsontree_value *)&reading_tree;
+      legacy.putchar = putchar_out;
+      legacy.path = 0;
+      legacy.depth = 0;
+      legacy.index[0] = 0;
+      while(legacy_jsontree_print_next(&legacy));
+      break;
+    case 1:
+      jsontree_setup(&js_ctx, (struct jsontree_value *)&reading_tree,
+                     putchar_out);
+      while(jsontree_print_next(&js_ctx));
+      break;
+    case 2:
+    case 3:
+      jsontree_setup_writer(&js_ctx, (struct jsontree_value *)&reading_tree,
+                            &buffered_writer, mode == 2 ?
+                            JSONTREE_FORMAT_JSON : JSONTREE_FORMAT_CBOR);
+      while(jsontree_print_next(&js_ctx));
+      break;
+    case 4:
+      jsontree_setup_writer(&js_ctx, (struct jsontree_value *)&reading_tree,
+                            &direct_writer, JSONTREE_FORMAT_JSON);
+      while(jsontree_print_next(&js_ctx));
+      break;
+    }
+  }
+  if(offsets != NULL) {
+    offsets[READINGS] = out_len;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_serialize(const char *name, int mode)
+{
+  unsigned long long us, best;
+  int r;
+
+  best = ~0ULL;
+  for(r = 0; r < ROUNDS; r++) {
+    us = now_us();
+    serialize(mode, NULL);
+    us = now_us() - us;
+    best = us < best ? us : best;
+  }
+  printf("  %s %7.1f MB/s, %4d bytes per reading\n", name,
+         (double)out_len / (best ? best : 1), out_len / READINGS);
+}
+/*---------------------------------------------------------------------------*/
+/* How documents were parsed before: the names are compared one after
+   the other, and the values are copied and converted. */
+static void
+parse_legacy(const char *json, int len, struct reading *r)
+{
+  struct legacy_jsonparse_state state;
+  char buf[16];
+  int type;
+
+  legacy_jsonparse_setup(&state, json, len);
+  while((type = legacy_jsonparse_next(&state)) != 0) {
+    if(type != JSON_TYPE_PAIR_NAME) {
+      continue;
+    }
+    if(legacy_jsonparse_strcmp_value(&state, "node") == 0) {
+      legacy_jsonparse_next(&state);
+      legacy_jsonparse_next(&state);
+      legacy_jsonparse_copy_value(&state, r->node, sizeof(r->node));
+    } else if(legacy_jsonparse_strcmp_value(&state, "seq") == 0) {
+      legacy_jsonparse_next(&state);
+      legacy_jsonparse_next(&state);
+      legacy_jsonparse_copy_value(&state, buf, sizeof(buf));
+      r->seq = atol(buf);
+    } else if(legacy_jsonparse_strcmp_value(&state, "temp") == 0) {
+      legacy_jsonparse_next(&state);
+      legacy_jsonparse_next(&state);
+      r->temp = legacy_jsonparse_get_value_as_int(&state);
+    } else if(legacy_jsonparse_strcmp_value(&state, "hum") == 0) {
+      legacy_jsonparse_next(&state);
+      legacy_jsonparse_next(&state);
+      r->hum = legacy_jsonparse_get_value_as_int(&state);
+    } else if(legacy_jsonparse_strcmp_value(&state, "ok") == 0) {
+      legacy_jsonparse_next(&state);
+      legacy_jsonparse_next(&state);
+      r->ok = legacy_jsonparse_get_value_as_int(&state) != 0;
+    } else if(legacy_jsonparse_strcmp_value(&state, "x") == 0) {
+      legacy_jsonparse_next(&state);
+      legacy_jsonparse_next(&state);
+      r->loc.x = legacy_jsonparse_get_value_as_int(&state);
+    } else if(legacy_jsonparse_strcmp_value(&state, "y") == 0) {
+      legacy_jsonparse_next(&state);
+      legacy_jsonparse_next(&state);
+      r->loc.y = legacy_jsonparse_get_value_as_int(&state);
+    } else if(legacy_jsonparse_strcmp_value(&state, "unit") == 0) {
+      legacy_jsonparse_next(&state);
+      legacy_jsonparse_next(&state);
+      legacy_jsonparse_copy_value(&state, r->unit, sizeof(r->unit));
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The same loop with the new tokenizer. */
+static void
+parse_tokens(const char *json, int len, struct reading *r)
+{
+  struct jsonparse_state state;
+  char buf[16];
+  int type;
+
+  jsonparse_setup(&state, json, len);
+  while((type = jsonparse_next(&state)) != 0) {
+    if(type != JSON_TYPE_PAIR_NAME) {
+      continue;
+    }
+    if(jsonparse_strcmp_value(&state, "node") == 0) {
+      jsonparse_next(&state);
+      jsonparse_next(&state);
+      jsonparse_copy_value(&state, r->node, sizeof(r->node));
+    } else if(jsonparse_strcmp_value(&state, "seq") == 0) {
+      jsonparse_next(&state);
+      jsonparse_next(&state);
+      jsonparse_copy_value(&state, buf, sizeof(buf));
+      r->seq = atol(buf);
+    } else if(jsonparse_strcmp_value(&state, "temp") == 0) {
+      jsonparse_next(&state);
+      jsonparse_next(&state);
+      r->temp = jsonparse_get_value_as_int(&state);
+    } else if(jsonparse_strcmp_value(&state, "hum") == 0) {
+      jsonparse_next(&state);
+      jsonparse_next(&state);
+      r->hum = jsonparse_get_value_as_int(&state);
+    } else if(jsonparse_strcmp_value(&state, "ok") == 0) {
+      jsonparse_next(&state);
+      jsonparse_next(&state);
+      r->ok = jsonparse_get_value_as_int(&state) != 0;
+    } else if(jsonparse_strcmp_value(&state, "x") == 0) {
+      jsonparse_next(&state);
+      jsonparse_next(&state);
+      r->loc.x = jsonparse_get_value_as_int(&state);
+    } else if(jsonparse_strcmp_value(&state, "y") == 0) {
+      jsonparse_next(&state);
+      jsonparse_next(&state);
+      r->loc.y = jsonparse_get_value_as_int(&state);
+    } else if(jsonparse_strcmp_value(&state, "unit") == 0) {
+      jsonparse_next(&state);
+      jsonparse_next(&state);
+      jsonparse_copy_value(&state, r->unit, sizeof(r->unit));
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+parse_bind(const char *data, int len, struct reading *r, int cbor)
+{
+  struct jsonparse_state state;
+
+  if(cbor) {
+    jsonparse_setup_cbor(&state, (const uint8_t *)data, len);
+  } else {
+    jsonparse_setup(&state, data, len);
+  }
+  if(jsonparse_bind(&state, reading_bindings, BINDINGS, r) != BINDINGS + 1) {
+    fail("not all pairs were bound");
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_parse(const char *name, int mode)
+{
+  const char *data = mode == 3 ? cbor_data : json_text;
+  const int *offsets = mode == 3 ? cbor_offsets : json_offsets;
+  unsigned long long us, best;
+  int i, r;
+
+  memset(parsed, 0, sizeof(parsed));
+  best = ~0ULL;
+  for(r = 0; r < ROUNDS; r++) {
+    us = now_us();
+    for(i = 0; i < READINGS; i++) {
+      switch(mode) {
+      case 0:
+        parse_legacy(data + offsets[i], offsets[i + 1] - offsets[i],
+                     &parsed[i]);
+        break;
+      case 1:
+        parse_tokens(data + offsets[i], offsets[i + 1] - offsets[i],
+                     &parsed[i]);
+        break;
+      default:
+        parse_bind(data + offsets[i], offsets[i + 1] - offsets[i],
+                   &parsed[i], mode == 3);
+        break;
+      }
+    }
+    us = now_us() - us;
+    best = us < best ? us : best;
+  }
+  printf("  %s %7.1f MB/s\n", name,
+         (double)offsets[READINGS] / (best ? best : 1));
+
+  if(memcmp(parsed, readings, sizeof(readings)) != 0) {
+    printf("  FAIL: %s: the parsed readings differ\n", name);
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+decimal_output(struct jsontree_context *js_ctx)
+{
+  jsontree_write_atom(js_ctx, "-21.05");
+  return 0;
+}
+static struct jsontree_callback decimal_callback =
+  JSONTREE_CALLBACK(decimal_output, NULL);
+JSONTREE_OBJECT(decimal_tree,
+                JSONTREE_PAIR("t", &decimal_callback),
+                JSONTREE_PAIR("on", &decimal_callback));
+
+/* A callback as older code writes it, through the putchar of the
+   context. */
+static int
+putchar_output(struct jsontree_context *js_ctx)
+{
+  const char *text = "[1,2]";
+
+  while(*text != '\0') {
+    js_ctx->putchar(*text++);
+  }
+  return 0;
+}
+static struct jsontree_callback putchar_callback =
+  JSONTREE_CALLBACK(putchar_output, NULL);
+JSONTREE_OBJECT(putchar_tree,
+                JSONTREE_PAIR("v", &putchar_callback));
+/*---------------------------------------------------------------------------*/
+static void
+check_extensions(void)
+{
+  static const char doc[] =
+    "{\"a\":-42,\"b\":true,\"c\":false,\"d\":null,\"e\":{},\"f\":[],"
+    "\"g\":{\"h\":[1,[2,{}],\"x\"]},\"loc\":{\"y\":-7,\"x\":3},"
+    "\"node\":\"a-very-long-node-name\",\"seq\":1.5e3}";
+  static const uint8_t bad_cbor[] = { 0xa2, 0x61, 'a', 0xfb, 0, 0 };
+  static const char putchar_doc[] = "{\n\"v\":[1,2]\n}";
+  struct jsontree_context js_ctx;
+  struct jsonparse_state state;
+  struct reading r;
+  char buf[16];
+  int types[16], n, type;
+
+  printf("checks:\n");
+
+  /* Literals, negative numbers and empty containers are tokens. */
+  jsonparse_setup(&state, doc, sizeof(doc) - 1);
+  n = 0;
+  while((type = jsonparse_next(&state)) != 0 && n < 16) {
+    if(type == JSON_TYPE_ERROR) {
+      fail("the document does not parse");
+      break;
+    }
+    if(type != ',' && type != ':' && type != JSON_TYPE_PAIR_NAME) {
+      types[n++] = type;
+    }
+    if(n == 1 && type == JSON_TYPE_NUMBER &&
+       jsonparse_get_value_as_int(&state) != -42) {
+      fail("wrong negative number");
+    }
+  }
+  if(n < 7 || types[1] != '0' || types[2] != 't' || types[3] != 'f' ||
+     types[4] != 'n' || types[5] != '{' || types[6] != '}') {
+    fail("wrong token types");
+  }
+
+  /* Unknown pairs are skipped, and long strings are truncated. */
+  memset(&r, 0, sizeof(r));
+  jsonparse_setup(&state, doc, sizeof(doc) - 1);
+  if(jsonparse_bind(&state, reading_bindings, BINDINGS, &r) != 4 ||
+     r.loc.x != 3 || r.loc.y != -7 || r.seq != 1 ||
+     strcmp(r.node, "a-very-long") != 0) {
+    fail("wrong binding of the document");
+  }
+
+  /* Decimal atoms become CBOR decimal fractions. */
+  out_len = 0;
+  jsontree_setup_writer(&js_ctx, (struct jsontree_value *)&decimal_tree,
+                        &buffered_writer, JSONTREE_FORMAT_CBOR);
+  while(jsontree_print_next(&js_ctx));
+  jsonparse_setup_cbor(&state, (uint8_t *)out, out_len);
+  if(jsonparse_next(&state) != '{' ||
+     jsonparse_next(&state) != JSON_TYPE_PAIR_NAME ||
+     jsonparse_strcmp_value(&state, "t") != 0 ||
+     jsonparse_next(&state) != JSON_TYPE_NUMBER ||
+     jsonparse_get_value_as_long(&state) != -21 ||
+     jsonparse_copy_value(&state, buf, sizeof(buf)) != JSON_TYPE_NUMBER ||
+     strcmp(buf, "-21.05") != 0) {
+    fail("wrong decimal fraction");
+  }
+
+  /* The putchar of a writer context feeds the writer. */
+  out_len = 0;
+  jsontree_setup_writer(&js_ctx, (struct jsontree_value *)&putchar_tree,
+                        &buffered_writer, JSONTREE_FORMAT_JSON);
+  while(jsontree_print_next(&js_ctx));
+  if(out_len != sizeof(putchar_doc) - 1 ||
+     memcmp(out, putchar_doc, out_len) != 0) {
+    fail("wrong output of putchar in a writer context");
+  }
+
+  /* Floats are not supported. */
+  jsonparse_setup_cbor(&state, bad_cbor, sizeof(bad_cbor));
+  if(jsonparse_bind(&state, reading_bindings, BINDINGS, &r) != -1) {
+    fail("a float was accepted");
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(json_bench_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  generate();
+
+  serialize(0, NULL);
+  memcpy(json_text, out, out_len);
+  serialize(1, NULL);
+  if(memcmp(json_text, out, out_len) != 0) {
+    fail("putchar output differs from the legacy output");
+  }
+  serialize(3, cbor_offsets);
+  memcpy(cbor_data, out, out_len);
+  serialize(2, json_offsets);
+  if(memcmp(json_text, out, out_len) != 0) {
+    fail("span output differs from the legacy output");
+  }
+  serialize(4, NULL);
+  if(memcmp(json_text, out, out_len) != 0) {
+    fail("unbuffered output differs from the legacy output");
+  }
+
+  printf("%d readings, serialize:\n", READINGS);
+  run_serialize("legacy:     ", 0);
+  run_serialize("putchar:    ", 1);
+  run_serialize("unbuffered: ", 4);
+  run_serialize("span writer:", 2);
+  run_serialize("CBOR writer:", 3);
+
+  printf("%d readings, parse:\n", READINGS);
+  run_parse("legacy:     ", 0);
+  run_parse("tokenizer:  ", 1);
+  run_parse("bind JSON:  ", 2);
+  run_parse("bind CBOR:  ", 3);
+
+  check_extensions();
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
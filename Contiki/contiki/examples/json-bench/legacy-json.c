@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         The JSON parser and the JSON output of jsontree as they were
+ *         before the tokenizer and the span writer, renamed with a
+ *         legacy_ prefix as the baseline of the benchmark.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "legacy-json.h"
+
+
+/*--------------------------------------------------------------------*/
+static int
+push(struct legacy_jsonparse_state *state, char c)
+{
+  state->stack[state->depth] = c;
+  state->depth++;
+  state->vtype = 0;
+  return state->depth < JSONPARSE_MAX_DEPTH;
+}
+/*--------------------------------------------------------------------*/
+static char
+pop(struct legacy_jsonparse_state *state)
+{
+  if(state->depth == 0) {
+    return JSON_TYPE_ERROR;
+  }
+  state->depth--;
+  return state->stack[state->depth];
+}
+/*--------------------------------------------------------------------*/
+/* will pass by the value and store the start and length of the value for
+   atomic types */
+/*--------------------------------------------------------------------*/
+static void
+atomic(struct legacy_jsonparse_state *state, char type)
+{
+  char c;
+
+  state->vstart = state->pos;
+  state->vtype = type;
+  if(type == JSON_TYPE_STRING || type == JSON_TYPE_PAIR_NAME) {
+    while((c = state->json[state->pos++]) && c != '"') {
+      if(c == '\\') {
+        state->pos++;           /* skip current char */
+      }
+    }
+    state->vlen = state->pos - state->vstart - 1;
+  } else if(type == JSON_TYPE_NUMBER) {
+    do {
+      c = state->json[state->pos];
+      if((c < '0' || c > '9') && c != '.') {
+        c = 0;
+      } else {
+        state->pos++;
+      }
+    } while(c);
+    /* need to back one step since first char is already gone */
+    state->vstart--;
+    state->vlen = state->pos - state->vstart;
+  }
+  /* no other types for now... */
+}
+/*--------------------------------------------------------------------*/
+static void
+skip_ws(struct legacy_jsonparse_state *state)
+{
+  char c;
+
+  while(state->pos < state->len &&
+        ((c = state->json[state->pos]) == ' ' || c == '\n')) {
+    state->pos++;
+  }
+}
+/*--------------------------------------------------------------------*/
+void
+legacy_jsonparse_setup(struct legacy_jsonparse_state *state, const char *json, int len)
+{
+  state->json = json;
+  state->len = len;
+  state->pos = 0;
+  state->depth = 0;
+  state->error = 0;
+  state->stack[0] = 0;
+}
+/*--------------------------------------------------------------------*/
+int
+legacy_jsonparse_next(struct legacy_jsonparse_state *state)
+{
+  char c;
+  char s;
+
+  skip_ws(state);
+  c = state->json[state->pos];
+  s = legacy_jsonparse_get_type(state);
+  state->pos++;
+
+  switch(c) {
+  case '{':
+    push(state, c);
+    return c;
+  case '}':
+    if(s == ':' && state->vtype != 0) {
+/*       printf("Popping vtype: '%c'\n", state->vtype); */
+      pop(state);
+      s = legacy_jsonparse_get_type(state);
+    }
+    if(s == '{') {
+      pop(state);
+    } else {
+      state->error = JSON_ERROR_SYNTAX;
+      return JSON_TYPE_ERROR;
+    }
+    return c;
+  case ']':
+    if(s == '[') {
+      pop(state);
+    } else {
+      state->error = JSON_ERROR_UNEXPECTED_END_OF_ARRAY;
+      return JSON_TYPE_ERROR;
+    }
+    return c;
+  case ':':
+    push(state, c);
+    return c;
+  case ',':
+    /* if x:y ... , */
+    if(s == ':' && state->vtype != 0) {
+      pop(state);
+    } else if(s == '[') {
+      /* ok! */
+    } else {
+      state->error = JSON_ERROR_SYNTAX;
+      return JSON_TYPE_ERROR;
+    }
+    return c;
+  case '"':
+    if(s == '{' || s == '[' || s == ':') {
+      atomic(state, c = (s == '{' ? JSON_TYPE_PAIR_NAME : c));
+    } else {
+      state->error = JSON_ERROR_UNEXPECTED_STRING;
+      return JSON_TYPE_ERROR;
+    }
+    return c;
+  case '[':
+    if(s == '{' || s == '[' || s == ':') {
+      push(state, c);
+    } else {
+      state->error = JSON_ERROR_UNEXPECTED_ARRAY;
+      return JSON_TYPE_ERROR;
+    }
+    return c;
+  default:
+    if(s == ':' || s == '[') {
+      if(c <= '9' && c >= '0') {
+        atomic(state, JSON_TYPE_NUMBER);
+        return JSON_TYPE_NUMBER;
+      }
+    }
+  }
+  return 0;
+}
+/*--------------------------------------------------------------------*/
+/* get the json value of the current position
+ * works only on "atomic" values such as string, number, null, false, true
+ */
+/*--------------------------------------------------------------------*/
+int
+legacy_jsonparse_copy_value(struct legacy_jsonparse_state *state, char *str, int size)
+{
+  int i;
+
+  if(state->vtype == 0) {
+    return 0;
+  }
+  size = size <= state->vlen ? (size - 1) : state->vlen;
+  for(i = 0; i < size; i++) {
+    str[i] = state->json[state->vstart + i];
+  }
+  str[i] = 0;
+  return state->vtype;
+}
+/*--------------------------------------------------------------------*/
+int
+legacy_jsonparse_get_value_as_int(struct legacy_jsonparse_state *state)
+{
+  if(state->vtype != JSON_TYPE_NUMBER) {
+    return 0;
+  }
+  return atoi(&state->json[state->vstart]);
+}
+/*--------------------------------------------------------------------*/
+long
+legacy_jsonparse_get_value_as_long(struct legacy_jsonparse_state *state)
+{
+  if(state->vtype != JSON_TYPE_NUMBER) {
+    return 0;
+  }
+  return atol(&state->json[state->vstart]);
+}
+/*--------------------------------------------------------------------*/
+/* strcmp - assume no strange chars that needs to be stuffed in string... */
+/*--------------------------------------------------------------------*/
+int
+legacy_jsonparse_strcmp_value(struct legacy_jsonparse_state *state, const char *str)
+{
+  if(state->vtype == 0) {
+    return -1;
+  }
+  return strncmp(str, &state->json[state->vstart], state->vlen);
+}
+/*--------------------------------------------------------------------*/
+int
+legacy_jsonparse_get_len(struct legacy_jsonparse_state *state)
+{
+  return state->vlen;
+}
+/*--------------------------------------------------------------------*/
+int
+legacy_jsonparse_get_type(struct legacy_jsonparse_state *state)
+{
+  if(state->depth == 0) {
+    return 0;
+  }
+  return state->stack[state->depth - 1];
+}
+/*--------------------------------------------------------------------*/
+int
+legacy_jsonparse_has_next(struct legacy_jsonparse_state *state)
+{
+  return state->pos < state->len;
+}
+/*---------------------------------------------------------------------------*/
+void
+legacy_jsontree_write_atom(const struct legacy_jsontree_context *js_ctx, const char *text)
+{
+  if(text == NULL) {
+    js_ctx->putchar('0');
+  } else {
+    while(*text != '\0') {
+      js_ctx->putchar(*text++);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+legacy_jsontree_write_string(const struct legacy_jsontree_context *js_ctx, const char *text)
+{
+  js_ctx->putchar('"');
+  if(text != NULL) {
+    while(*text != '\0') {
+      if(*text == '"') {
+        js_ctx->putchar('\\');
+      }
+      js_ctx->putchar(*text++);
+    }
+  }
+  js_ctx->putchar('"');
+}
+/*---------------------------------------------------------------------------*/
+void
+legacy_jsontree_write_int(const struct legacy_jsontree_context *js_ctx, int value)
+{
+  char buf[10];
+  int l;
+
+  if(value < 0) {
+    js_ctx->putchar('-');
+    value = -value;
+  }
+
+  l = sizeof(buf) - 1;
+  do {
+    buf[l--] = '0' + (value % 10);
+    value /= 10;
+  } while(value > 0 && l >= 0);
+
+  while(++l < sizeof(buf)) {
+    js_ctx->putchar(buf[l]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+legacy_jsontree_print_next(struct legacy_jsontree_context *js_ctx)
+{
+  struct jsontree_value *v;
+  int index;
+
+  v = js_ctx->values[js_ctx->depth];
+
+  /* Default operation after switch is to back up one level */
+  switch(v->type) {
+  case JSON_TYPE_OBJECT:
+  case JSON_TYPE_ARRAY: {
+    struct jsontree_array *o = (struct jsontree_array *)v;
+    struct jsontree_value *ov;
+
+    index = js_ctx->index[js_ctx->depth];
+    if(index == 0) {
+      js_ctx->putchar(v->type);
+      js_ctx->putchar('\n');
+    }
+    if(index >= o->count) {
+      js_ctx->putchar('\n');
+      js_ctx->putchar(v->type + 2);
+      /* Default operation: back up one level! */
+      break;
+    }
+
+    if(index > 0) {
+      js_ctx->putchar(',');
+      js_ctx->putchar('\n');
+    }
+    if(v->type == JSON_TYPE_OBJECT) {
+      legacy_jsontree_write_string(js_ctx,
+                            ((struct jsontree_object *)o)->pairs[index].name);
+      js_ctx->putchar(':');
+      ov = ((struct jsontree_object *)o)->pairs[index].value;
+    } else {
+      ov = o->values[index];
+    }
+    /* TODO check max depth */
+    js_ctx->depth++;          /* step down to value... */
+    js_ctx->index[js_ctx->depth] = 0; /* and init index */
+    js_ctx->values[js_ctx->depth] = ov;
+    /* Continue on this new level */
+    return 1;
+  }
+  case JSON_TYPE_STRING:
+    legacy_jsontree_write_string(js_ctx, ((struct jsontree_string *)v)->value);
+    /* Default operation: back up one level! */
+    break;
+  case JSON_TYPE_INT:
+    legacy_jsontree_write_int(js_ctx, ((struct jsontree_int *)v)->value);
+    /* Default operation: back up one level! */
+    break;
+  case JSON_TYPE_CALLBACK: {   /* pre-formatted json string currently */
+    struct jsontree_callback *callback;
+
+    callback = (struct jsontree_callback *)v;
+    if(js_ctx->index[js_ctx->depth] == 0) {
+      /* First call: reset the callback status */
+      js_ctx->callback_state = 0;
+    }
+    if(callback->output == NULL) {
+      legacy_jsontree_write_string(js_ctx, "");
+    } else if(callback->output((struct jsontree_context *)js_ctx)) {
+      /* The callback wants to output more */
+      js_ctx->index[js_ctx->depth]++;
+      return 1;
+    }
+    /* Default operation: back up one level! */
+    break;
+  }
+  default:
+    /* illegal type */
+    return 0;
+  }
+  /* Done => back up one level! */
+  if(js_ctx->depth > 0) {
+    js_ctx->depth--;
+    js_ctx->index[js_ctx->depth]++;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         The JSON parser and the JSON output of jsontree as they were
+ *         before the tokenizer and the span writer.
+ */
+
+#ifndef LEGACY_JSON_H
+#define LEGACY_JSON_H
+
+#include "jsonparse.h"
+#include "jsontree.h"
+
+struct legacy_jsonparse_state {
+  const char *json;
+  int pos;
+  int len;
+  int depth;
+  int vstart;
+  int vlen;
+  char vtype;
+  char error;
+  char stack[JSONPARSE_MAX_DEPTH];
+};
+
+struct legacy_jsontree_context {
+  struct jsontree_value *values[JSONTREE_MAX_DEPTH];
+  uint16_t index[JSONTREE_MAX_DEPTH];
+  int (* putchar)(int);
+  uint8_t depth;
+  uint8_t path;
+  int callback_state;
+};
+
+void legacy_jsonparse_setup(struct legacy_jsonparse_state *state,
+                            const char *json, int len);
+int legacy_jsonparse_next(struct legacy_jsonparse_state *state);
+int legacy_jsonparse_copy_value(struct legacy_jsonparse_state *state,
+                                char *buf, int buf_size);
+int legacy_jsonparse_get_value_as_int(struct legacy_jsonparse_state *state);
+long legacy_jsonparse_get_value_as_long(struct legacy_jsonparse_state *state);
+int legacy_jsonparse_get_len(struct legacy_jsonparse_state *state);
+int legacy_jsonparse_get_type(struct legacy_jsonparse_state *state);
+int legacy_jsonparse_strcmp_value(struct legacy_jsonparse_state *state,
+                                  const char *str);
+
+void legacy_jsontree_write_int(const struct legacy_jsontree_context *js_ctx,
+                               int value);
+void legacy_jsontree_write_atom(const struct legacy_jsontree_context *js_ctx,
+                                const char *text);
+void legacy_jsontree_write_string(const struct legacy_jsontree_context *js_ctx,
+                                  const char *text);
+int legacy_jsontree_print_next(struct legacy_jsontree_context *js_ctx);
+
+#endif /* LEGACY_JSON_H */
@@ -0,0 +1,438 @@
+/*
+ * Copyright (c) 2012, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Loopback benchmark for the serial multiplexer. Samples are
+ *         streamed as text, with SLIP and in frames, and frames are
+ *         received in blocks and one byte at a time.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "dev/serial-line.h"
+#include "dev/slip.h"
+#include "serial-mux.h"
+
+#define SAMPLES		20000
+#define PASSES		5
+#define RX_FRAMES	2000
+#define RX_PAYLOAD	32
+#define RX_BLOCK	64
+
+/* The bytes per second of a UART at 115200 bit/s with one start bit
+   and one stop bit. */
+#define UART_BYTES	11520
+
+struct sample {
+  uint16_t seqno;
+  int16_t x, y, z;
+};
+
+static struct sample samples[SAMPLES];
+
+static uint8_t wire[SAMPLES * 24];
+static int wire_len;
+
+static uint8_t rx_data[RX_FRAMES * SERIAL_MUX_ENCODED_SIZE(RX_PAYLOAD)];
+static int rx_len;
+static unsigned long rx_count, rx_sum;
+
+static int failures;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(serial_mux_bench_process, "Serial multiplexer benchmark");
+AUTOSTART_PROCESSES(&serial_mux_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+generate(void)
+{
+  unsigned long seed;
+  int i;
+
+  seed = 1;
+  for(i = 0; i < SAMPLES; i++) {
+    seed = seed * 1103515245UL + 12345;
+    samples[i].seqno = i;
+    samples[i].x = (int16_t)(seed >> 16) % 2048;
+    samples[i].y = (int16_t)(seed >> 8) % 2048;
+    samples[i].z = -1024 + (int)(seed >> 20) % 64;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The UART of the node, one byte at a time and in blocks. */
+void
+slip_arch_writeb(unsigned char c)
+{
+  if(wire_len < sizeof(wire)) {
+    wire[wire_len++] = c;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+uart_write(const uint8_t *data, int len)
+{
+  if(wire_len + len <= sizeof(wire)) {
+    memcpy(wire + wire_len, data, len);
+    wire_len += len;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_text(int i)
+{
+  char line[32];
+  int j, len;
+
+  len = sprintf(line, "S %u %d %d %d\n", samples[i].seqno,
+                samples[i].x, samples[i].y, samples[i].z);
+  for(j = 0; j < len; j++) {
+    slip_arch_writeb(line[j]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_slip(int i)
+{
+  slip_write(&samples[i], sizeof(samples[i]));
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_frame(int i)
+{
+  serial_mux_send(SERIAL_MUX_SAMPLES, &samples[i], sizeof(samples[i]));
+}
+/*---------------------------------------------------------------------------*/
+static void
+queue_frame(int i)
+{
+  serial_mux_queue(SERIAL_MUX_SAMPLES, &samples[i], sizeof(samples[i]));
+}
+/*---------------------------------------------------------------------------*/
+static int
+check_text(void)
+{
+  unsigned seqno;
+  int x, y, z, n, pos, i;
+
+  for(pos = i = 0; pos < wire_len && i < SAMPLES; i++) {
+    if(sscanf((char *)wire + pos, "S %u %d %d %d\n%n",
+              &seqno, &x, &y, &z, &n) != 4 ||
+       seqno != samples[i].seqno || x != samples[i].x ||
+       y != samples[i].y || z != samples[i].z) {
+      break;
+    }
+    pos += n;
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+static int
+check_slip(void)
+{
+  uint8_t packet[sizeof(struct sample)];
+  int pos, len, esc, i;
+  uint8_t c;
+
+  len = esc = 0;
+  for(pos = i = 0; pos < wire_len && i < SAMPLES; pos++) {
+    c = wire[pos];
+    if(c == 0300) {
+      if(len == sizeof(packet)) {
+        if(memcmp(packet, &samples[i], sizeof(packet)) != 0) {
+          break;
+        }
+        i++;
+      } else if(len != 0) {
+        break;
+      }
+      len = 0;
+    } else if(c == 0333) {
+      esc = 1;
+    } else if(len < sizeof(packet)) {
+      if(esc) {
+        c = c == 0334 ? 0300 : 0333;
+        esc = 0;
+      }
+      packet[len++] = c;
+    }
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+static int
+check_frames(void)
+{
+  static uint8_t buf[SERIAL_MUX_FRAME_SIZE + 3];
+  struct serial_mux_decoder d;
+  int pos, used, len, i, j;
+
+  serial_mux_decoder_init(&d, buf, sizeof(buf));
+  for(pos = i = 0; pos < wire_len; pos += used) {
+    len = serial_mux_decode(&d, wire + pos, wire_len - pos, &used);
+    if(len < 0 || (len > 0 && (buf[0] != SERIAL_MUX_SAMPLES ||
+                               len % sizeof(struct sample) != 0))) {
+      break;
+    }
+    for(j = 0; j < len && i < SAMPLES; j += sizeof(struct sample), i++) {
+      if(memcmp(&buf[1 + j], &samples[i], sizeof(struct sample)) != 0) {
+        return i;
+      }
+    }
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+static const struct {
+  const char *name;
+  void (*send)(int i);
+  int (*check)(void);
+} senders[] = {
+  {"text lines", send_text, check_text},
+  {"SLIP packets", send_slip, check_slip},
+  {"frames, one per sample", send_frame, check_frames},
+  {"frames, queued", queue_frame, check_frames}
+};
+/*---------------------------------------------------------------------------*/
+static void
+run_sender(int s)
+{
+  unsigned long long us, best;
+  unsigned long frames;
+  double per_sample;
+  int pass, i;
+
+  best = ~0ULL;
+  frames = 0;
+  for(pass = 0; pass < PASSES; pass++) {
+    wire_len = 0;
+    frames = serial_mux_stats.tx_frames;
+    us = now_us();
+    for(i = 0; i < SAMPLES; i++) {
+      senders[s].send(i);
+    }
+    serial_mux_flush();
+    us = now_us() - us;
+    frames = serial_mux_stats.tx_frames - frames;
+    if(us < best) {
+      best = us;
+    }
+  }
+
+  per_sample = (double)best / SAMPLES;
+  printf("  %-24s %6.3f us/sample %5.2f bytes/sample %6.0f samples/s",
+         senders[s].name, per_sample, (double)wire_len / SAMPLES,
+         (double)UART_BYTES * SAMPLES / wire_len);
+  if(frames > 0) {
+    printf(" %6.3f us/frame", (double)best / frames);
+  }
+  printf("\n");
+
+  i = senders[s].check();
+  if(i != SAMPLES) {
+    printf("  FAIL: %d of %d samples were received\n", i, SAMPLES);
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+rx_input(const uint8_t *data, int len)
+{
+  rx_count++;
+  rx_sum += len + data[0] + data[len - 1];
+}
+/*---------------------------------------------------------------------------*/
+static struct serial_mux_stream rx_stream = {NULL, SERIAL_MUX_SAMPLES, rx_input};
+/*---------------------------------------------------------------------------*/
+/* Make the lines or the frames that the node receives, with the
+   number of each at its start. */
+static void
+make_rx_data(int frames)
+{
+  static uint8_t buf[SERIAL_MUX_ENCODED_SIZE(RX_PAYLOAD)];
+  struct serial_mux_encoder e;
+  uint8_t payload[RX_PAYLOAD];
+  int i, j;
+
+  rx_len = 0;
+  for(i = 0; i < RX_FRAMES; i++) {
+    sprintf((char *)payload, "%04d", i);
+    for(j = 4; j < RX_PAYLOAD - 1; j++) {
+      payload[j] = 'a' + (i + j) % 26;
+    }
+    payload[RX_PAYLOAD - 1] = '\n';
+    if(!frames) {
+      memcpy(rx_data + rx_len, payload, RX_PAYLOAD);
+      rx_len += RX_PAYLOAD;
+    } else {
+      serial_mux_encode_start(&e, buf, sizeof(buf), SERIAL_MUX_SAMPLES);
+      serial_mux_encode_add(&e, payload, RX_PAYLOAD);
+      j = serial_mux_encode_end(&e);
+      memcpy(rx_data + rx_len, buf, j);
+      rx_len += j;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(line_counter_process, "Line counter");
+PROCESS_THREAD(line_counter_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == serial_line_event_message);
+    rx_input((uint8_t *)data, strlen(data));
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(serial_mux_bench_process, ev, data)
+{
+  static const char *rx_names[] = {"serial-line, bytes", "frames, bytes",
+                                   "frames, blocks"};
+  static unsigned long long us, best;
+  static unsigned long expected;
+  static int s, pass, pos, i, n;
+
+  PROCESS_BEGIN();
+
+  generate();
+  serial_mux_init(uart_write);
+  serial_mux_register(&rx_stream);
+  process_start(&line_counter_process, NULL);
+
+  printf("%d samples of %d bytes sent:\n", SAMPLES, (int)sizeof(struct sample));
+  for(s = 0; s < sizeof(senders) / sizeof(senders[0]); s++) {
+    run_sender(s);
+  }
+
+  printf("%d lines or frames of %d bytes received in blocks of %d bytes:\n",
+         RX_FRAMES, RX_PAYLOAD, RX_BLOCK);
+  for(s = 0; s < 3; s++) {
+    make_rx_data(s > 0);
+    best = ~0ULL;
+    for(pass = 0; pass < PASSES; pass++) {
+      rx_count = rx_sum = 0;
+      us = now_us();
+      for(pos = 0; pos < rx_len; pos += n) {
+        n = rx_len - pos < RX_BLOCK ? rx_len - pos : RX_BLOCK;
+        if(s == 2) {
+          serial_mux_input(rx_data + pos, n);
+        } else {
+          for(i = 0; i < n; i++) {
+            if(s == 0) {
+              serial_line_input_byte(rx_data[pos + i]);
+            } else {
+              serial_mux_input_byte(rx_data[pos + i]);
+            }
+          }
+        }
+        /* Wait until the receiver has what was passed so far. */
+        expected = s == 0 ? (pos + n) / RX_PAYLOAD :
+          (pos + n) / SERIAL_MUX_ENCODED_SIZE(RX_PAYLOAD);
+        while(rx_count < expected) {
+          PROCESS_PAUSE();
+        }
+      }
+      us = now_us() - us;
+      if(us < best) {
+        best = us;
+      }
+      if(rx_count != RX_FRAMES) {
+        printf("  FAIL: %lu of %d were received\n", rx_count, RX_FRAMES);
+        failures++;
+      }
+    }
+    printf("  %-24s %6.3f us/frame\n", rx_names[s], (double)best / RX_FRAMES);
+  }
+
+  /* Corrupt every tenth frame, and pass all frames at once so that
+     the receive buffer overflows. */
+  make_rx_data(1);
+  for(i = 0; i < RX_FRAMES; i += 10) {
+    rx_data[i * SERIAL_MUX_ENCODED_SIZE(RX_PAYLOAD) + 10] ^= 0x20;
+  }
+  rx_count = 0;
+  serial_mux_stats.rx_errors = 0;
+  for(pos = 0; pos < rx_len; pos += RX_BLOCK) {
+    serial_mux_input(rx_data + pos, rx_len - pos < RX_BLOCK ?
+                     rx_len - pos : RX_BLOCK);
+    PROCESS_PAUSE();
+  }
+  PROCESS_PAUSE();
+  if(rx_count != RX_FRAMES - RX_FRAMES / 10 ||
+     serial_mux_stats.rx_errors != RX_FRAMES / 10) {
+    printf("FAIL: %lu frames and %lu errors with corrupted frames\n",
+           rx_count, serial_mux_stats.rx_errors);
+    failures++;
+  }
+
+  make_rx_data(1);
+  rx_count = 0;
+  serial_mux_stats.rx_errors = serial_mux_stats.rx_overflows = 0;
+  serial_mux_input(rx_data, 4 * SERIAL_MUX_RX_SIZE);
+  PROCESS_PAUSE();
+  serial_mux_input(rx_data, rx_len < 4096 ? rx_len : 4096);
+  PROCESS_PAUSE();
+  n = rx_count;
+  for(pos = 0; pos < rx_len; pos += RX_BLOCK) {
+    serial_mux_input(rx_data + pos, rx_len - pos < RX_BLOCK ?
+                     rx_len - pos : RX_BLOCK);
+    PROCESS_PAUSE();
+  }
+  PROCESS_PAUSE();
+  if(serial_mux_stats.rx_overflows == 0 || rx_count - n != RX_FRAMES) {
+    printf("FAIL: %lu frames after %lu overflows\n",
+           rx_count - n, serial_mux_stats.rx_overflows);
+    failures++;
+  }
+  printf("overflows: %lu, errors: %lu, frames kept through them: %d\n",
+         serial_mux_stats.rx_overflows, serial_mux_stats.rx_errors, n);
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for the pipes between the commands of shell
+ *         pipelines. Pipelines of the file, CRC and base64 commands
+ *         are run on a file, and their output is checked.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "lib/crc16.h"
+#include "shell.h"
+#include "shell-crc.h"
+
+#define FILE_SIZE	(64 * 1024)
+#define PASSES		5
+
+/* The base64 encoding has 57 bytes of data in each line of 77
+   characters. */
+#define B64_DATA	57
+#define B64_LINE	77
+
+static const struct {
+  const char *command;
+  int b64;
+  int block_size;
+  int crc_per_block;
+} pipelines[] = {
+  {"read bench.dat | count", 0, 40, 0},
+  {"read bench.dat 0 128 | count", 0, 128, 0},
+  {"read bench.dat | crc | count", 0, 40, 1},
+  {"read bench.dat | crc | crc-v | count", 0, 40, 0},
+  {"read bench.dat | bin2hex | hex2bin | count", 0, 40, 0},
+  {"read bench.b64 0 77 | dec64 | count", 1, B64_LINE, 0}
+};
+
+static const char *slow_pipelines[] = {
+  "read bench.dat | slow",
+  "read bench.dat 0 100 | crc | crc-v | slow",
+  "read bench.dat | bin2hex | hex2bin | slow",
+  "read bench.b64 0 77 | dec64 | slow"
+};
+
+static unsigned char file_data[FILE_SIZE];
+static char commandline[64];
+static unsigned long count_bytes;
+static uint16_t count_crc;
+static int failures;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(shell_pipe_bench_process, "Shell pipe benchmark");
+PROCESS(bench_count_process, "count");
+SHELL_COMMAND(count_command,
+	      "count",
+	      "count: count the input",
+	      &bench_count_process);
+PROCESS(bench_slow_process, "slow");
+SHELL_COMMAND(slow_command,
+	      "slow",
+	      "slow: count the input, seven bytes at a time",
+	      &bench_slow_process);
+AUTOSTART_PROCESSES(&shell_pipe_bench_process);
+/*---------------------------------------------------------------------------*/
+void
+shell_default_output(const char *text1, int len1, const char *text2, int len2)
+{
+  printf("  %.*s%.*s\n", len1, text1, len2, text2);
+}
+/*---------------------------------------------------------------------------*/
+void
+shell_prompt(char *str)
+{
+}
+/*---------------------------------------------------------------------------*/
+void
+shell_exit(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+/* Add the first len bytes of an input to the count. */
+static void
+count_input(struct shell_input *input, int len)
+{
+  int i;
+
+  for(i = 0; i < len && i < input->len1; i++) {
+    count_crc = crc16_add(input->data1[i], count_crc);
+  }
+  for(; i < len; i++) {
+    count_crc = crc16_add(input->data2[i - input->len1], count_crc);
+  }
+  count_bytes += len;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(bench_count_process, ev, data)
+{
+  struct shell_input *input;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == shell_event_input);
+    input = data;
+    if(input->len1 + input->len2 == 0) {
+      process_post(&shell_pipe_bench_process, PROCESS_EVENT_CONTINUE, NULL);
+      PROCESS_EXIT();
+    }
+    count_input(input, input->len1 + input->len2);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(bench_slow_process, ev, data)
+{
+  static uint8_t resume_posted;
+  struct shell_input *input;
+  int len;
+
+  PROCESS_BEGIN();
+
+  resume_posted = 0;
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == shell_event_input ||
+			     ev == PROCESS_EVENT_CONTINUE);
+    if(ev == PROCESS_EVENT_CONTINUE) {
+      resume_posted = 0;
+      shell_input_resume(&slow_command);
+      continue;
+    }
+    input = data;
+    if(input->len1 + input->len2 == 0) {
+      process_post(&shell_pipe_bench_process, PROCESS_EVENT_CONTINUE, NULL);
+      PROCESS_EXIT();
+    }
+    len = input->len1 + input->len2;
+    if(len > 7) {
+      shell_input_keep(&slow_command, len - 7);
+      if(!resume_posted) {
+	resume_posted = 1;
+	process_post(PROCESS_CURRENT(), PROCESS_EVENT_CONTINUE, NULL);
+      }
+      len = 7;
+    }
+    count_input(input, len);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static int
+write_file(const char *name, const void *data, int len)
+{
+  int fd;
+
+  cfs_remove(name);
+  fd = cfs_open(name, CFS_WRITE);
+  if(fd < 0 || cfs_write(fd, data, len) != len) {
+    printf("Failed to write %s\n", name);
+    cfs_close(fd);
+    return 0;
+  }
+  cfs_close(fd);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Write the data of the benchmark and its base64 encoding in lines. */
+static int
+write_files(void)
+{
+  static const char b64[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  static char text[(FILE_SIZE + B64_DATA - 1) / B64_DATA * B64_LINE];
+  unsigned long seed, v;
+  int i, j, n, len;
+
+  seed = 1;
+  for(i = 0; i < FILE_SIZE; i++) {
+    seed = seed * 1103515245UL + 12345;
+    file_data[i] = (seed >> 16) & 0xff;
+  }
+
+  for(i = len = 0; i < FILE_SIZE; i += B64_DATA) {
+    for(j = i; j < i + B64_DATA && j < FILE_SIZE; j += 3) {
+      n = FILE_SIZE - j < 3 ? FILE_SIZE - j : 3;
+      v = (unsigned long)file_data[j] << 16;
+      v |= n > 1 ? (unsigned long)file_data[j + 1] << 8 : 0;
+      v |= n > 2 ? file_data[j + 2] : 0;
+      text[len++] = b64[(v >> 18) & 0x3f];
+      text[len++] = b64[(v >> 12) & 0x3f];
+      text[len++] = n > 1 ? b64[(v >> 6) & 0x3f] : '=';
+      text[len++] = n > 2 ? b64[v & 0x3f] : '=';
+    }
+    text[len++] = '\n';
+  }
+
+  return write_file("bench.dat", file_data, FILE_SIZE) &&
+    write_file("bench.b64", text, len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+start(const char *command)
+{
+  count_bytes = 0;
+  count_crc = 0;
+  strncpy(commandline, command, sizeof(commandline) - 1);
+  shell_input(commandline, (int)strlen(commandline));
+}
+/*---------------------------------------------------------------------------*/
+static void
+check(const char *command, unsigned long bytes, uint16_t crc)
+{
+  if(count_bytes != bytes || (crc != 0 && count_crc != crc)) {
+    printf("  FAIL: %s: expected %lu bytes with CRC %04x, got %lu with %04x\n",
+	   command, bytes, crc, count_bytes, count_crc);
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(shell_pipe_bench_process, ev, data)
+{
+  static unsigned long long us, best;
+  static unsigned long bytes;
+  static uint16_t crc;
+  static int i, pass;
+
+  PROCESS_BEGIN();
+
+  shell_init();
+  shell_file_init();
+  shell_crc_init();
+  shell_base64_init();
+  shell_register_command(&count_command);
+  shell_register_command(&slow_command);
+
+  if(!write_files()) {
+    failures++;
+    printf("%d failures\n", failures);
+    PROCESS_EXIT();
+  }
+  crc = crc16_data(file_data, FILE_SIZE, 0);
+
+  /* Let the shell start up before giving it input. */
+  for(i = 0; i < 3; i++) {
+    PROCESS_PAUSE();
+  }
+
+  printf("Pipelines on %d bytes with %d pipes of %d bytes:\n",
+	 FILE_SIZE, SHELL_PIPES, SHELL_PIPE_SIZE);
+  for(i = 0; i < sizeof(pipelines) / sizeof(pipelines[0]); i++) {
+    bytes = FILE_SIZE;
+    if(pipelines[i].crc_per_block) {
+      bytes += 2 * ((FILE_SIZE + pipelines[i].block_size - 1) /
+		    pipelines[i].block_size);
+    }
+
+    best = 0;
+    for(pass = 0; pass < PASSES; pass++) {
+      us = now_us();
+      start(pipelines[i].command);
+      PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_CONTINUE);
+      us = now_us() - us;
+      if(best == 0 || us < best) {
+	best = us;
+      }
+      check(pipelines[i].command, bytes,
+	    pipelines[i].crc_per_block ? 0 : crc);
+    }
+    printf("  %-44s %7.2f MB/s\n", pipelines[i].command,
+	   (double)FILE_SIZE / best);
+  }
+
+#if SHELL_PIPES > 0
+  printf("Flow control:\n");
+  for(i = 0; i < sizeof(slow_pipelines) / sizeof(slow_pipelines[0]); i++) {
+    us = now_us();
+    start(slow_pipelines[i]);
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_CONTINUE);
+    us = now_us() - us;
+    printf("  %-44s %7lu us\n", slow_pipelines[i], (unsigned long)us);
+    check(slow_pipelines[i], FILE_SIZE, crc);
+  }
+#endif /* SHELL_PIPES > 0 */
+
+  cfs_remove("bench.dat");
+  cfs_remove("bench.b64");
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2012, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for binary telemetry. Simulated powertrace and
+ *         collect-view periods are output as text or structs and as
+ *         batches, and the batches are decoded and checked.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "sys/compower.h"
+#include "net/rime.h"
+#include "powertrace.h"
+#include "collect-view.h"
+#include "telemetry.h"
+
+#define PERIODS		4096
+#define PASSES		5
+
+/* The periods are of one minute of 32768 ticks per second, as on
+   Tmote Sky. */
+#define PERIOD_TICKS	(60 * 32768UL)
+
+#define OUTPUT_SIZE	(PERIODS * 64)
+
+static uint32_t counters[PERIODS][6];
+static struct collect_view_data_msg msgs[PERIODS];
+
+static uint8_t output[OUTPUT_SIZE];
+static int output_len;
+static int failures;
+static unsigned long seed;
+
+TELEMETRY_BATCH(cv_batch, TELEMETRY_COLLECT_VIEW_FIELDS, 128);
+
+/*---------------------------------------------------------------------------*/
+PROCESS(telemetry_bench_process, "Telemetry benchmark");
+AUTOSTART_PROCESSES(&telemetry_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+next_random(void)
+{
+  seed = seed * 1103515245UL + 12345;
+  return (unsigned)(seed >> 16) & 0x7fff;
+}
+/*---------------------------------------------------------------------------*/
+/* Generate the energest counters of each period, and the collect-view
+   messages that a node would send for them. */
+static void
+generate(void)
+{
+  uint32_t cpu, lpm, transmit, listen, idle_transmit, idle_listen;
+  uint32_t d_cpu, d_transmit, d_listen;
+  int i;
+
+  seed = 1;
+  cpu = lpm = transmit = listen = idle_transmit = idle_listen = 0;
+  for(i = 0; i < PERIODS; i++) {
+    d_cpu = 29000 + next_random() % 2000;
+    d_transmit = next_random() % 400;
+    d_listen = 19000 + next_random() % 1000 + d_transmit;
+    cpu += d_cpu;
+    lpm += PERIOD_TICKS - d_cpu;
+    transmit += d_transmit;
+    listen += d_listen;
+    idle_transmit += d_transmit / 4;
+    idle_listen += 18000 + next_random() % 100;
+
+    counters[i][0] = cpu;
+    counters[i][1] = lpm;
+    counters[i][2] = transmit;
+    counters[i][3] = listen;
+    counters[i][4] = idle_transmit;
+    counters[i][5] = idle_listen;
+
+    /* The energy values of collect-view are scaled down to 16 bits,
+       as by collect_view_construct_message(). */
+    msgs[i].len = sizeof(msgs[i]) / sizeof(uint16_t);
+    msgs[i].clock = i * 60 * CLOCK_SECOND;
+    msgs[i].timesynch_time = i * 60 * CLOCK_SECOND + 17;
+    msgs[i].cpu = d_cpu / 32;
+    msgs[i].lpm = (PERIOD_TICKS - d_cpu) / 32;
+    msgs[i].transmit = d_transmit / 32;
+    msgs[i].listen = d_listen / 32;
+    msgs[i].parent = i < PERIODS / 2 ? 0x0201 : 0x0501;
+    msgs[i].parent_etx = 16 + next_random() % 3;
+    msgs[i].current_rtmetric = 48 + next_random() % 5;
+    msgs[i].num_neighbors = 6 + (next_random() % 8 == 0);
+    msgs[i].beacon_interval = 60;
+    memset(msgs[i].sensors, 0, sizeof(msgs[i].sensors));
+    msgs[i].sensors[0] = 6500 + next_random() % 8;
+    msgs[i].sensors[1] = 300 + next_random() % 50;
+    msgs[i].sensors[2] = 2900 - i / 256;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_counters(int i)
+{
+  energest_type_set(ENERGEST_TYPE_CPU, counters[i][0]);
+  energest_type_set(ENERGEST_TYPE_LPM, counters[i][1]);
+  energest_type_set(ENERGEST_TYPE_TRANSMIT, counters[i][2]);
+  energest_type_set(ENERGEST_TYPE_LISTEN, counters[i][3]);
+  compower_idle_activity.transmit = counters[i][4];
+  compower_idle_activity.listen = counters[i][5];
+}
+/*---------------------------------------------------------------------------*/
+static void
+save_batch(const uint8_t *data, int len)
+{
+  if(output_len + len <= OUTPUT_SIZE) {
+    memcpy(output + output_len, data, len);
+  }
+  output_len += len;
+}
+/*---------------------------------------------------------------------------*/
+/* Run the powertrace periods with stdout redirected to a temporary
+   file, and return the number of bytes written to it. */
+static long
+run_powertrace(int binary, unsigned long long *best_us)
+{
+  unsigned long long us;
+  FILE *f;
+  long bytes;
+  int saved, pass, i;
+
+  f = tmpfile();
+  if(f == NULL) {
+    return -1;
+  }
+  fflush(stdout);
+  saved = dup(STDOUT_FILENO);
+  dup2(fileno(f), STDOUT_FILENO);
+
+  bytes = 0;
+  *best_us = ~0ULL;
+  for(pass = 0; pass < PASSES; pass++) {
+    fflush(stdout);
+    lseek(STDOUT_FILENO, 0, SEEK_SET);
+    output_len = 0;
+    us = now_us();
+    for(i = 0; i < PERIODS; i++) {
+      set_counters(i);
+      if(binary) {
+        powertrace_record();
+      } else {
+        powertrace_print("");
+      }
+    }
+    if(binary) {
+      powertrace_flush();
+    }
+    fflush(stdout);
+    us = now_us() - us;
+    if(us < *best_us) {
+      *best_us = us;
+    }
+    bytes = lseek(STDOUT_FILENO, 0, SEEK_CUR);
+  }
+
+  dup2(saved, STDOUT_FILENO);
+  close(saved);
+  fclose(f);
+  return bytes;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, long bytes, unsigned long long us)
+{
+  printf("  %-28s %6.2f bytes, %6.3f us per period\n", name,
+         (double)bytes / PERIODS, (double)us / PERIODS);
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_powertrace(void)
+{
+  struct telemetry_reader r;
+  uint32_t values[TELEMETRY_MAX_FIELDS];
+  uint32_t node;
+  int pos, n;
+
+  node = (rimeaddr_node_addr.u8[0] << 8) | rimeaddr_node_addr.u8[1];
+  for(pos = n = 0; pos < output_len; pos += r.pos) {
+    if(telemetry_read_start(&r, output + pos, output_len - pos) < 0 ||
+       r.schema->id != TELEMETRY_SCHEMA_POWERTRACE) {
+      printf("  FAIL: malformed powertrace batch at %d\n", pos);
+      failures++;
+      return;
+    }
+    while(telemetry_read_next(&r, values) > 0) {
+      /* The clock is not simulated, so it is not compared. */
+      if(n >= PERIODS || values[1] != node ||
+         memcmp(&values[2], counters[n], sizeof(counters[0]))) {
+        printf("  FAIL: powertrace record %d differs\n", n);
+        failures++;
+        return;
+      }
+      n++;
+    }
+  }
+  if(n != PERIODS) {
+    printf("  FAIL: %d powertrace records decoded\n", n);
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_collect_view(void)
+{
+  struct telemetry_reader r;
+  uint32_t values[TELEMETRY_MAX_FIELDS];
+  unsigned long long us, struct_us, batch_us;
+  const uint16_t *fields;
+  int pass, pos, n, i;
+
+  struct_us = batch_us = ~0ULL;
+  for(pass = 0; pass < PASSES; pass++) {
+    us = now_us();
+    for(i = output_len = 0; i < PERIODS; i++) {
+      save_batch((const uint8_t *)&msgs[i], sizeof(msgs[i]));
+    }
+    us = now_us() - us;
+    if(us < struct_us) {
+      struct_us = us;
+    }
+  }
+  report("struct", output_len, struct_us);
+
+  for(pass = 0; pass < PASSES; pass++) {
+    us = now_us();
+    output_len = 0;
+    telemetry_clear(&cv_batch);
+    for(i = 0; i < PERIODS; i++) {
+      if(!collect_view_batch_add(&cv_batch, i, &msgs[i])) {
+        save_batch(telemetry_data(&cv_batch), telemetry_len(&cv_batch));
+        telemetry_clear(&cv_batch);
+        collect_view_batch_add(&cv_batch, i, &msgs[i]);
+      }
+      if(telemetry_records(&cv_batch) == 8) {
+        save_batch(telemetry_data(&cv_batch), telemetry_len(&cv_batch));
+        telemetry_clear(&cv_batch);
+      }
+    }
+    if(telemetry_records(&cv_batch) > 0) {
+      save_batch(telemetry_data(&cv_batch), telemetry_len(&cv_batch));
+    }
+    us = now_us() - us;
+    if(us < batch_us) {
+      batch_us = us;
+    }
+  }
+  report("batches of 8", output_len, batch_us);
+
+  for(pos = n = 0; pos < output_len; pos += r.pos) {
+    if(telemetry_read_start(&r, output + pos, output_len - pos) < 0 ||
+       r.schema->id != TELEMETRY_SCHEMA_COLLECT_VIEW) {
+      printf("  FAIL: malformed collect-view batch at %d\n", pos);
+      failures++;
+      return;
+    }
+    while(telemetry_read_next(&r, values) > 0) {
+      if(n >= PERIODS) {
+        break;
+      }
+      fields = &msgs[n].clock;
+      for(i = 0; i < TELEMETRY_COLLECT_VIEW_FIELDS; i++) {
+        if(values[i] != fields[i]) {
+          break;
+        }
+      }
+      if(i < TELEMETRY_COLLECT_VIEW_FIELDS || r.seqno + r.record - 1 != n) {
+        printf("  FAIL: collect-view record %d differs\n", n);
+        failures++;
+        return;
+      }
+      n++;
+    }
+  }
+  if(n != PERIODS) {
+    printf("  FAIL: %d collect-view records decoded\n", n);
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(telemetry_bench_process, ev, data)
+{
+  static char name[32];
+  unsigned long long us;
+  long bytes;
+
+  PROCESS_BEGIN();
+
+  generate();
+
+  printf("powertrace, %d periods:\n", PERIODS);
+  bytes = run_powertrace(0, &us);
+  report("text", bytes, us);
+
+  powertrace_output(save_batch);
+  bytes = run_powertrace(1, &us);
+  sprintf(name, "batches of %d", POWERTRACE_BATCH_RECORDS);
+  report(name, output_len, us);
+  check_powertrace();
+
+  powertrace_output(NULL);
+  bytes = run_powertrace(1, &us);
+  report("batches in TB lines", bytes, us);
+
+  printf("collect-view, %d periods:\n", PERIODS);
+  run_collect_view();
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
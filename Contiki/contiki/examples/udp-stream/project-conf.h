@@ -47,6 +47,10 @@
    swapping is disabled, and CFS not linked. */
 #define QUEUEBUFRAM_CONF_NUM            2
 
+/* Send long packet trains. */
+#undef CSMA_CONF_BURST_MAX
+#define CSMA_CONF_BURST_MAX             16
+
 /* Set a large (1 sector) default size for coffee files. */
 #define COFFEE_CONF_DYN_SIZE     (COFFEE_SECTOR_SIZE - COFFEE_PAGE_SIZE + 1)
 
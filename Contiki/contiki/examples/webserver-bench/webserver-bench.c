@@ -0,0 +1,371 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark for the pre-compressed files and the hashed file
+ *         lookup of apps/webserver. The default httpd-fs content is
+ *         requested through httpd_appcall() with uIP faked, and the bytes,
+ *         segments and a modelled latency are compared with the webserver
+ *         as it was before.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+
+#include "webserver.h"
+#include "httpd.h"
+#include "httpd-fs.h"
+#include "httpd-inflate.h"
+
+/* The round-trip time and the bitrate of the modelled link. uIP sends
+   one segment at a time, so each segment costs a round trip. */
+#define RTT_MS      125
+#define LINK_BPS    250000UL
+
+#define PASSES      20
+#define REQUESTS    100
+#define LOOKUPS     100000
+
+/* Not declared by uip.h. */
+extern void *uip_sappdata;
+extern uint16_t uip_slen;
+
+void legacy_httpd_appcall(void *state);
+int legacy_httpd_fs_open(const char *name, struct httpd_fs_file *file);
+
+enum {
+  MODE_LEGACY,
+  MODE_GZIP,
+  MODE_PLAIN,
+  MODE_REVALIDATE,
+  MODES
+};
+
+static const char *mode_names[] = {
+  "legacy    ", "gzip      ", "plain     ", "revalidate"
+};
+
+static const char *files[] = {
+  "/index.html", "/header.html", "/footer.html", "/style.css",
+  "/404.html", "/missing.html"
+};
+
+#define FILES (sizeof(files) / sizeof(files[0]))
+
+static struct uip_conn conn;
+static char response[8192];
+static int response_len, segments;
+static char etags[FILES][11];
+static char body[8192];
+static int failures;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(webserver_bench_process, "Webserver benchmark");
+AUTOSTART_PROCESSES(&webserver_bench_process);
+/*---------------------------------------------------------------------------*/
+void
+webserver_log_file(uip_ipaddr_t *requester, char *file)
+{
+}
+/*---------------------------------------------------------------------------*/
+void
+webserver_log(char *msg)
+{
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+/* Call the webserver as uIP would, and collect the segment it sends. */
+static void
+appcall(void (*app)(void *), uint8_t flags, const char *data, int len)
+{
+  uip_conn = &conn;
+  uip_flags = flags;
+  uip_appdata = uip_sappdata = &uip_buf[UIP_LLH_LEN + UIP_TCPIP_HLEN];
+  memcpy(uip_appdata, data, len);
+  uip_len = len;
+  uip_slen = 0;
+
+  app(conn.appstate.state);
+
+  if(uip_slen > 0 && response_len + uip_slen <= sizeof(response)) {
+    memcpy(response + response_len, uip_sappdata, uip_slen);
+    response_len += uip_slen;
+    segments++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Request a file, and return 0 if the server did not close the
+   connection. */
+static int
+request(void (*app)(void *), const char *name, const char *headers)
+{
+  char buf[192];
+  int len, i;
+
+  response_len = segments = 0;
+  memset(&conn, 0, sizeof(conn));
+  conn.mss = MSS;
+
+  appcall(app, UIP_CONNECTED, NULL, 0);
+  len = sprintf(buf, "GET %s HTTP/1.0\r\nHost: [aaaa::212:7401:1:101]\r\n%s\r\n",
+                name, headers);
+  appcall(app, UIP_NEWDATA, buf, len);
+  for(i = 0; i < 1000 && uip_flags != UIP_CLOSE; i++) {
+    appcall(app, UIP_ACKDATA, NULL, 0);
+  }
+  if(uip_flags != UIP_CLOSE) {
+    return 0;
+  }
+  appcall(app, UIP_CLOSE, NULL, 0);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static const char *
+find_header(const char *header)
+{
+  const char *ptr;
+
+  ptr = strstr(response, header);
+  if(ptr == NULL || ptr > strstr(response, "\r\n\r\n")) {
+    return NULL;
+  }
+  return ptr + strlen(header);
+}
+/*---------------------------------------------------------------------------*/
+static int
+read_file(const char *name, char *buf, int size)
+{
+  char path[64];
+  FILE *f;
+  int len;
+
+  sprintf(path, "../../apps/webserver/httpd-fs%s",
+          strcmp(name, "/missing.html") == 0 ? "/404.html" : name);
+  f = fopen(path, "rb");
+  if(f == NULL) {
+    return -1;
+  }
+  len = fread(buf, 1, size, f);
+  fclose(f);
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+/* Check the response to a request for a file in a mode. */
+static void
+check(int mode, int f)
+{
+  static struct httpd_inflate z;
+  static char expected[4096];
+  const char *ptr, *start;
+  char *data;
+  int expected_len, len, n;
+
+  response[response_len] = 0;
+  expected_len = read_file(files[f], expected, sizeof(expected));
+  start = strstr(response, "\r\n\r\n");
+  if(start == NULL || expected_len < 0) {
+    printf("FAIL: %s %s: no headers or no file\n", mode_names[mode], files[f]);
+    failures++;
+    return;
+  }
+  start += 4;
+  len = response_len - (start - response);
+
+  if(mode == MODE_REVALIDATE) {
+    if(strncmp(response, "HTTP/1.0 304", 12) != 0 || len != 0) {
+      printf("FAIL: %s %s: not a 304 without a body\n",
+             mode_names[mode], files[f]);
+      failures++;
+    }
+    return;
+  }
+
+  if(strncmp(response, f == FILES - 1 ? "HTTP/1.0 404" : "HTTP/1.0 200", 12)) {
+    printf("FAIL: %s %s: wrong status\n", mode_names[mode], files[f]);
+    failures++;
+  }
+
+  if(mode == MODE_LEGACY) {
+    memcpy(body, start, len);
+  } else {
+    ptr = find_header("Content-Length: ");
+    if(ptr == NULL || atoi(ptr) != len) {
+      printf("FAIL: %s %s: wrong Content-Length\n", mode_names[mode], files[f]);
+      failures++;
+    }
+    if(find_header("Content-Encoding: gzip") != NULL) {
+      if(mode != MODE_GZIP) {
+        printf("FAIL: %s %s: gzip for a plain client\n",
+               mode_names[mode], files[f]);
+        failures++;
+      }
+      n = len;
+      len = 0;
+      if(httpd_inflate_init(&z, start, n)) {
+        while((n = httpd_inflate_next(&z, &data, HTTPD_INFLATE_WINDOW)) > 0) {
+          memcpy(body + len, data, n);
+          len += n;
+        }
+      }
+    } else {
+      memcpy(body, start, len);
+    }
+    ptr = find_header("ETag: ");
+    if(mode == MODE_GZIP && f < FILES - 1) {
+      if(ptr == NULL) {
+        printf("FAIL: %s %s: no ETag\n", mode_names[mode], files[f]);
+        failures++;
+      } else {
+        strncpy(etags[f], ptr, 10);
+        etags[f][10] = 0;
+      }
+    }
+  }
+
+  if(len != expected_len || memcmp(body, expected, len) != 0) {
+    printf("FAIL: %s %s: the content differs\n", mode_names[mode], files[f]);
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+run(int mode)
+{
+  void (*app)(void *);
+  char headers[96];
+  unsigned long long us, best;
+  unsigned long bytes, segs, ms, ns;
+  int f, p, r;
+
+  bytes = segs = ms = ns = 0;
+  app = mode == MODE_LEGACY ? legacy_httpd_appcall : httpd_appcall;
+  for(f = 0; f < FILES; f++) {
+    if(mode == MODE_REVALIDATE && f == FILES - 1) {
+      continue;
+    }
+    headers[0] = 0;
+    if(mode == MODE_GZIP || mode == MODE_REVALIDATE) {
+      strcat(headers, "Accept-Encoding: gzip, deflate\r\n");
+    }
+    if(mode == MODE_REVALIDATE) {
+      sprintf(headers + strlen(headers), "If-None-Match: %s\r\n", etags[f]);
+    }
+
+    /* The best of PASSES runs of REQUESTS requests. */
+    best = 0;
+    for(p = 0; p < PASSES; p++) {
+      us = now_us();
+      for(r = 0; r < REQUESTS; r++) {
+        if(!request(app, files[f], headers)) {
+          printf("FAIL: %s %s: the connection was not closed\n",
+                 mode_names[mode], files[f]);
+          failures++;
+          return;
+        }
+      }
+      us = now_us() - us;
+      if(p == 0 || us < best) {
+        best = us;
+      }
+    }
+    ns += best * 1000 / REQUESTS;
+    check(mode, f);
+
+    bytes += response_len;
+    segs += segments;
+    ms += (segments + 1) * RTT_MS + response_len * 8000UL / LINK_BPS;
+  }
+  printf("  %s: %5lu bytes, %3lu segments, %5lu ms modelled, %6lu ns CPU\n",
+         mode_names[mode], bytes, segs, ms, ns);
+}
+/*---------------------------------------------------------------------------*/
+static void
+lookup(const char *name, int (*open)(const char *, struct httpd_fs_file *))
+{
+  struct httpd_fs_file file;
+  unsigned long long us, best;
+  int i, p, found;
+
+  best = 0;
+  found = 0;
+  for(p = 0; p < 10; p++) {
+    us = now_us();
+    for(i = 0; i < LOOKUPS; i++) {
+      found += open(files[i % FILES], &file);
+    }
+    us = now_us() - us;
+    if(p == 0 || us < best) {
+      best = us;
+    }
+  }
+  if(found != 10 * (LOOKUPS - LOOKUPS / FILES)) {
+    printf("FAIL: %s lookup found %d files\n", name, found);
+    failures++;
+  }
+  printf("  %s: %4lu ns per lookup\n", name,
+         (unsigned long)(best * 1000 / LOOKUPS));
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(webserver_bench_process, ev, data)
+{
+  static int mode;
+
+  PROCESS_BEGIN();
+
+  printf("%d files requested with an MSS of %d bytes:\n", (int)FILES, MSS);
+  for(mode = 0; mode < MODES; mode++) {
+    run(mode);
+  }
+
+  printf("File lookup:\n");
+  lookup("legacy", legacy_httpd_fs_open);
+  lookup("hashed", httpd_fs_open);
+
+  printf("%d failures\n", failures);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -177,4 +177,23 @@ typedef unsigned long clock_time_t;
 /* Not part of C99 but actually present */
 int strcasecmp(const char*, const char*);
 
+/* Gateways run on these platforms and may serve hundreds of Erbium
+   resources: dispatch requests through the trie and cache
+   /.well-known/core. */
+#ifndef REST_TRIE_SIZE
+#define REST_TRIE_SIZE          512
+#endif
+#ifndef REST_TRIE_BUCKETS
+#define REST_TRIE_BUCKETS       128
+#endif
+#ifndef REST_LINK_FORMAT_SIZE
+#define REST_LINK_FORMAT_SIZE   16384
+#endif
+
+/* Inflate the gzip files of the webserver for clients that do not
+   accept gzip, which takes about 1.7 KB of RAM per file being sent. */
+#ifndef WEBSERVER_CONF_INFLATE_CONNS
+#define WEBSERVER_CONF_INFLATE_CONNS 1
+#endif
+
 #endif /* __CONTIKI_CONF_H__ */
@@ -46,7 +46,11 @@
 #define COFFEE_SECTOR_SIZE		65536UL
 #define COFFEE_PAGE_SIZE		256UL
 #define COFFEE_START			0
+#ifdef COFFEE_CONF_SIZE
+#define COFFEE_SIZE			(COFFEE_CONF_SIZE - COFFEE_START)
+#else
 #define COFFEE_SIZE			((1024UL * 1024UL) - COFFEE_START)
+#endif
 #define COFFEE_NAME_LENGTH		16
 #define COFFEE_DYN_SIZE			16384
 #define COFFEE_MAX_OPEN_FILES		6
@@ -54,8 +58,31 @@
 #define COFFEE_LOG_DIVISOR		4
 #define COFFEE_LOG_SIZE			8192
 #define COFFEE_LOG_TABLE_LIMIT		256
+#ifdef COFFEE_CONF_MICRO_LOGS
+#define COFFEE_MICRO_LOGS		COFFEE_CONF_MICRO_LOGS
+#else
 #define COFFEE_MICRO_LOGS		0
+#endif
 #define COFFEE_IO_SEMANTICS		1
+#define COFFEE_STATS			1
+#ifdef COFFEE_CONF_NAME_INDEX_SIZE
+#define COFFEE_NAME_INDEX_SIZE		COFFEE_CONF_NAME_INDEX_SIZE
+#else
+#define COFFEE_NAME_INDEX_SIZE		1024
+#endif
+#ifdef COFFEE_CONF_PAGE_CACHE_SIZE
+#define COFFEE_PAGE_CACHE_SIZE		COFFEE_CONF_PAGE_CACHE_SIZE
+#else
+#define COFFEE_PAGE_CACHE_SIZE		8
+#endif
+#ifdef COFFEE_CONF_LOG_INDEX_LIMIT
+#define COFFEE_LOG_INDEX_LIMIT		COFFEE_CONF_LOG_INDEX_LIMIT
+#else
+#define COFFEE_LOG_INDEX_LIMIT		COFFEE_LOG_TABLE_LIMIT
+#endif
+#ifdef COFFEE_CONF_LOG_WRITE_BUFFER
+#define COFFEE_LOG_WRITE_BUFFER		COFFEE_CONF_LOG_WRITE_BUFFER
+#endif
 
 #define COFFEE_WRITE(buf, size, offset)				\
 		xmem_pwrite((char *)(buf), (size), COFFEE_START + (offset))
@@ -72,7 +99,12 @@
 #define WRITE_HEADER(hdr, page)						\
   COFFEE_WRITE((hdr), sizeof (*hdr), (page) * COFFEE_PAGE_SIZE)
 
-/* Coffee types. */
+/* Coffee types. Page numbers need 32 bits in flash images larger than
+   8 MB. */
+#if COFFEE_SIZE / COFFEE_PAGE_SIZE > 32767
+typedef int32_t coffee_page_t;
+#else
 typedef int16_t coffee_page_t;
+#endif
 
 #endif /* !COFFEE_ARCH_H */
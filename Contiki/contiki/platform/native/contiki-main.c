@@ -44,6 +44,7 @@
 #include "net/netstack.h"
 
 #include "dev/serial-line.h"
+#include "dev/xmem.h"
 
 #include "net/uip.h"
 
@@ -188,6 +189,8 @@ main(int argc, char **argv)
   process_start(&etimer_process, NULL);
   ctimer_init();
 
+  xmem_init();
+
   set_rime_addr();
 
   queuebuf_init();
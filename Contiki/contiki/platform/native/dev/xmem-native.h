@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Extensions of the xmem emulation on the native platform:
+ *         scatter/gather I/O, statistics and power failures.
+ */
+
+#ifndef XMEM_NATIVE_H
+#define XMEM_NATIVE_H
+
+#include <sys/uio.h>
+
+#include "contiki-conf.h"
+#include "dev/xmem.h"
+
+#ifdef XMEM_CONF_SIZE
+#define XMEM_SIZE XMEM_CONF_SIZE
+#else
+#define XMEM_SIZE (1024 * 1024UL)
+#endif
+
+/* The unit of erasure. An erase always clears whole sectors. */
+#ifdef XMEM_CONF_SECTOR_SIZE
+#define XMEM_SECTOR_SIZE XMEM_CONF_SECTOR_SIZE
+#else
+#define XMEM_SECTOR_SIZE 65536UL
+#endif
+
+#define XMEM_SECTORS (XMEM_SIZE / XMEM_SECTOR_SIZE)
+
+/* Keep the memory in a shared mapping, which survives in child 
+   processes and can be backed by a file, instead of in a static
+   array. */
+#ifdef XMEM_CONF_MMAP
+#define XMEM_MMAP XMEM_CONF_MMAP
+#else
+#define XMEM_MMAP 1
+#endif
+
+/* Program writes like flash memory does, so that a write can only set
+   bits and only an erase clears them. Otherwise writes overwrite the 
+   memory, and the bytes that flash memory could not have written are
+   only counted. */
+#ifdef XMEM_CONF_FLASH_SEMANTICS
+#define XMEM_FLASH_SEMANTICS XMEM_CONF_FLASH_SEMANTICS
+#else
+#define XMEM_FLASH_SEMANTICS 0
+#endif
+
+struct xmem_stats {
+  unsigned long reads;
+  unsigned long read_bytes;
+  unsigned long writes;
+  unsigned long written_bytes;
+  unsigned long erases;
+  /* Bytes written over data that has not been erased, in which a
+     write cleared bits. */
+  unsigned long overwrites;
+};
+
+extern struct xmem_stats xmem_stats;
+
+/**
+ * \brief Read into several buffers from consecutive memory.
+ * \return The number of bytes read, or -1 on failure.
+ */
+int xmem_preadv(const struct iovec *iov, int iovcnt, unsigned long offset);
+
+/**
+ * \brief Write several buffers to consecutive memory.
+ * \return The number of bytes written, or -1 on failure.
+ */
+int xmem_pwritev(const struct iovec *iov, int iovcnt, unsigned long offset);
+
+/**
+ * \brief The number of times that a sector has been erased.
+ */
+unsigned long xmem_sector_erases(int sector);
+
+/**
+ * \brief The number of writes to a sector.
+ */
+unsigned long xmem_sector_writes(int sector);
+
+/**
+ * \brief Cut the power in the middle of a later write or erase.
+ * \param operations The number of the write or erase operation, counted
+ *        from the next one, during which the power is cut. Zero turns
+ *        the power back on.
+ *
+ * The operation that is cut takes effect only for the first half of
+ * its bytes. All later writes and erases fail until the power is 
+ * turned back on.
+ */
+void xmem_power_cut(unsigned long operations);
+
+/**
+ * \brief Cut the power just before a later write or erase.
+ * \param operations The number of the write or erase operation, counted
+ *        from the next one, that the power is cut before.
+ *
+ * Unlike xmem_power_cut(), the operation that is cut takes no effect.
+ */
+void xmem_power_cut_before(unsigned long operations);
+
+/**
+ * \brief Check whether the power has been cut.
+ */
+int xmem_powered(void);
+
+#endif /* !XMEM_NATIVE_H */
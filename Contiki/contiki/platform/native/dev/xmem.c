@@ -33,56 +33,262 @@
  * $Id: xmem.c,v 1.2 2008/07/09 09:37:50 adamdunkels Exp $
  */
 
+
+/*
+ * The external memory is kept in a shared memory mapping, which may be
+ * backed by a flash image file. Erasing works on whole sectors, and
+ * writes and erases can be made to fail as if the power was cut.
+ */
+
 #include "contiki-conf.h"
 #include "dev/xmem.h"
+#include "dev/xmem-native.h"
 
 #include <stdio.h>
 #include <fcntl.h>
 #include <unistd.h>
-#include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
 
-#define XMEM_SIZE 1024 * 1024
+#if XMEM_SIZE % XMEM_SECTOR_SIZE
+#error "The xmem size must be a multiple of the sector size."
+#endif
 
+#if XMEM_MMAP
+static unsigned char *xmem;
+#else
 static unsigned char xmem[XMEM_SIZE];
+#endif
+
+static unsigned long sector_erases[XMEM_SECTORS];
+static unsigned long sector_writes[XMEM_SECTORS];
+
+struct xmem_stats xmem_stats;
+
+/* Counts down the operations until the power is cut. */
+static unsigned long operations_left;
+static char power_cut;
+/* Whether the operation that is cut takes no effect at all. */
+static char cut_whole;
+/*---------------------------------------------------------------------------*/
+static int
+map(void)
+{
+#if XMEM_MMAP
+#ifdef XMEM_CONF_FILE
+  int fd;
+#endif
+
+  if(xmem != NULL) {
+    return 1;
+  }
+
+#ifdef XMEM_CONF_FILE
+  /* The image is extended with zeroes, which is the erased state. */
+  fd = open(XMEM_CONF_FILE, O_RDWR | O_CREAT, 0644);
+  if(fd < 0 || ftruncate(fd, XMEM_SIZE) < 0) {
+    perror("xmem: " XMEM_CONF_FILE);
+    if(fd >= 0) {
+      close(fd);
+    }
+    return 0;
+  }
+  xmem = mmap(NULL, XMEM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+#else
+  xmem = mmap(NULL, XMEM_SIZE, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+#endif
+  if(xmem == MAP_FAILED) {
+    perror("xmem: mmap");
+    xmem = NULL;
+    return 0;
+  }
+#endif /* XMEM_MMAP */
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+in_range(long size, unsigned long offset)
+{
+  return size >= 0 && offset <= XMEM_SIZE && size <= XMEM_SIZE - offset &&
+    map();
+}
+/*---------------------------------------------------------------------------*/
+/* Return the number of bytes of a write or erase operation that take
+   effect before the power is cut. */
+static unsigned long
+powered_bytes(unsigned long size)
+{
+  if(power_cut) {
+    return 0;
+  }
+  if(operations_left > 0 && --operations_left == 0) {
+    power_cut = 1;
+    return cut_whole ? 0 : size / 2;
+  }
+  return size;
+}
+/*---------------------------------------------------------------------------*/
+static void
+program(const unsigned char *buf, unsigned long size, unsigned long offset)
+{
+  unsigned char *p;
+  unsigned long i, sector;
+
+  p = &xmem[offset];
+  for(i = 0; i < size; i++) {
+    if(p[i] & ~buf[i]) {
+      xmem_stats.overwrites++;
+    }
+#if XMEM_FLASH_SEMANTICS
+    p[i] |= buf[i];
+#endif
+  }
+#if !XMEM_FLASH_SEMANTICS
+  memcpy(p, buf, size);
+#endif
+
+  if(size > 0) {
+    for(sector = offset / XMEM_SECTOR_SIZE;
+        sector <= (offset + size - 1) / XMEM_SECTOR_SIZE;
+        sector++) {
+      sector_writes[sector]++;
+    }
+  }
+}
 /*---------------------------------------------------------------------------*/
 int
 xmem_pwrite(const void *buf, int size, unsigned long offset)
 {
-  /*  int f;
-  char name[400];
-
-  snprintf(name, sizeof(name), "xmem.%d.%d", node_x(), node_y());
-  f = open(name, O_WRONLY | O_APPEND | O_CREAT, 0644);
-  lseek(f, addr, SEEK_SET);
-  write(f, buf, size);
-  close(f);*/
-  
-  /*  printf("xmem_write(offset 0x%02x, buf %p, size %l);\n", offset, buf, size);*/
-  
-  memcpy(&xmem[offset], buf, size);
+  struct iovec iov;
+
+  iov.iov_base = (void *)buf;
+  iov.iov_len = size;
+  return xmem_pwritev(&iov, 1, offset);
+}
+/*---------------------------------------------------------------------------*/
+int
+xmem_pwritev(const struct iovec *iov, int iovcnt, unsigned long offset)
+{
+  unsigned long size, n;
+  int i;
+
+  for(i = 0, size = 0; i < iovcnt; i++) {
+    size += iov[i].iov_len;
+  }
+  if(!in_range(size, offset)) {
+    return -1;
+  }
+
+  n = powered_bytes(size);
+  for(i = 0, size = 0; i < iovcnt && size < n; i++) {
+    program(iov[i].iov_base,
+            iov[i].iov_len < n - size ? iov[i].iov_len : n - size,
+            offset + size);
+    size += iov[i].iov_len;
+  }
+  if(power_cut) {
+    return -1;
+  }
+
+  xmem_stats.writes++;
+  xmem_stats.written_bytes += size;
   return size;
 }
 /*---------------------------------------------------------------------------*/
 int
 xmem_pread(void *buf, int size, unsigned long offset)
 {
-  /*  printf("xmem_read(addr 0x%02x, buf %p, size %d);\n", addr, buf, size);*/
-  memcpy(buf, &xmem[offset], size);
+  struct iovec iov;
+
+  iov.iov_base = buf;
+  iov.iov_len = size;
+  return xmem_preadv(&iov, 1, offset);
+}
+/*---------------------------------------------------------------------------*/
+int
+xmem_preadv(const struct iovec *iov, int iovcnt, unsigned long offset)
+{
+  unsigned long size;
+  int i;
+
+  for(i = 0, size = 0; i < iovcnt; i++) {
+    size += iov[i].iov_len;
+  }
+  if(!in_range(size, offset)) {
+    return -1;
+  }
+
+  for(i = 0, size = 0; i < iovcnt; i++) {
+    memcpy(iov[i].iov_base, &xmem[offset + size], iov[i].iov_len);
+    size += iov[i].iov_len;
+  }
+
+  xmem_stats.reads++;
+  xmem_stats.read_bytes += size;
   return size;
 }
 /*---------------------------------------------------------------------------*/
 int
 xmem_erase(long nbytes, unsigned long offset)
 {
-  /*  printf("xmem_read(addr 0x%02x, buf %p, size %d);\n", addr, buf, size);*/
-  memset(&xmem[offset], 0, nbytes);
+  unsigned long sector, n;
+
+  if(nbytes <= 0 || !in_range(nbytes, offset)) {
+    return -1;
+  }
+
+  for(sector = offset / XMEM_SECTOR_SIZE;
+      sector <= (offset + nbytes - 1) / XMEM_SECTOR_SIZE;
+      sector++) {
+    n = powered_bytes(XMEM_SECTOR_SIZE);
+    memset(&xmem[sector * XMEM_SECTOR_SIZE], 0, n);
+    if(power_cut) {
+      return -1;
+    }
+    sector_erases[sector]++;
+    xmem_stats.erases++;
+  }
   return nbytes;
 }
 /*---------------------------------------------------------------------------*/
+unsigned long
+xmem_sector_erases(int sector)
+{
+  return sector >= 0 && sector < XMEM_SECTORS ? sector_erases[sector] : 0;
+}
+/*---------------------------------------------------------------------------*/
+unsigned long
+xmem_sector_writes(int sector)
+{
+  return sector >= 0 && sector < XMEM_SECTORS ? sector_writes[sector] : 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+xmem_power_cut(unsigned long operations)
+{
+  operations_left = operations;
+  power_cut = 0;
+  cut_whole = 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+xmem_power_cut_before(unsigned long operations)
+{
+  xmem_power_cut(operations);
+  cut_whole = 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+xmem_powered(void)
+{
+  return !power_cut;
+}
+/*---------------------------------------------------------------------------*/
 void
 xmem_init(void)
 {
-
+  map();
 }
 /*---------------------------------------------------------------------------*/
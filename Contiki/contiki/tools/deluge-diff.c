@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Makes a patch for Deluge delta updates, in the format that
+ *         apps/deluge/deluge-patch.h describes.
+ *
+ *         Usage: deluge-diff base new patch
+ *
+ *         The new file is described greedily with copies of the longest
+ *         matches in the base file, preferring copies from where the
+ *         previous copy ended, since their offsets are the cheapest.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_MATCH	4
+#define HASH_BITS	16
+#define MAX_CHAIN	512
+#define LENGTH_MASK	0x7f
+#define COPY		0x80
+
+static unsigned char *base, *target;
+static long base_size, target_size;
+static long *head, *chain;
+
+static unsigned char *patch;
+static long patch_size;
+static long copies, copied, literals;
+
+/*---------------------------------------------------------------------------*/
+/* The same CRC as crc16_add() in core/lib/crc16.c. */
+static unsigned short
+crc16_data(const unsigned char *data, long len)
+{
+  unsigned short acc;
+  long i;
+
+  acc = 0;
+  for(i = 0; i < len; i++) {
+    acc ^= data[i];
+    acc  = (acc >> 8) | (acc << 8);
+    acc ^= (acc & 0xff00) << 4;
+    acc ^= (acc >> 8) >> 4;
+    acc ^= (acc & 0xff00) >> 5;
+  }
+  return acc;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned char *
+read_file(const char *filename, long *size)
+{
+  FILE *f;
+  unsigned char *buf;
+
+  f = fopen(filename, "rb");
+  if(f == NULL) {
+    perror(filename);
+    exit(1);
+  }
+  fseek(f, 0, SEEK_END);
+  *size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  buf = malloc(*size + 1);
+  if(buf == NULL || fread(buf, 1, *size, f) != (size_t)*size) {
+    fprintf(stderr, "%s: could not read the file\n", filename);
+    exit(1);
+  }
+  fclose(f);
+  return buf;
+}
+/*---------------------------------------------------------------------------*/
+static void
+put(unsigned char b)
+{
+  patch[patch_size++] = b;
+}
+/*---------------------------------------------------------------------------*/
+static void
+put_varint(unsigned long v)
+{
+  while(v >= 0x80) {
+    put((v & 0x7f) | 0x80);
+    v >>= 7;
+  }
+  put(v);
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+zigzag(long v)
+{
+  return v < 0 ? ((unsigned long)-v << 1) - 1 : (unsigned long)v << 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+varint_size(unsigned long v)
+{
+  int n;
+
+  for(n = 1; v >= 0x80; n++) {
+    v >>= 7;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static void
+put_op(int flags, long length)
+{
+  if(length < LENGTH_MASK) {
+    put(flags | length);
+  } else {
+    put(flags | LENGTH_MASK);
+    put_varint(length - LENGTH_MASK);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+hash(const unsigned char *p)
+{
+  return ((p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3]) * 2654435761UL) >>
+    (32 - HASH_BITS) & ((1 << HASH_BITS) - 1);
+}
+/*---------------------------------------------------------------------------*/
+static long
+match_length(long b, long t)
+{
+  long n;
+
+  for(n = 0; b + n < base_size && t + n < target_size &&
+        base[b + n] == target[t + n]; n++);
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/* Find the copy that saves the most bytes at a position of the new
+   file, given the base offset that is aligned with it. */
+static long
+find_match(long t, long aligned, long *offset)
+{
+  long b, n, best, gain, best_gain;
+  int i;
+
+  best = 0;
+  best_gain = 0;
+  if(t + MIN_MATCH > target_size) {
+    return 0;
+  }
+
+  /* The aligned offset is tried first, even if the match is short. */
+  if(aligned >= 0 && aligned < base_size) {
+    n = match_length(aligned, t);
+    if(n > 2) {
+      best = n;
+      best_gain = n - 2;
+      *offset = aligned;
+    }
+  }
+
+  for(b = head[hash(&target[t])], i = 0; b >= 0 && i < MAX_CHAIN;
+      b = chain[b], i++) {
+    n = match_length(b, t);
+    gain = n - 1 - varint_size(zigzag(b - aligned));
+    if(n >= MIN_MATCH && gain > best_gain) {
+      best = n;
+      best_gain = gain;
+      *offset = b;
+    }
+  }
+  return best;
+}
+/*---------------------------------------------------------------------------*/
+static void
+flush_literals(long start, long end)
+{
+  if(end > start) {
+    put_op(0, end - start);
+    memcpy(&patch[patch_size], &target[start], end - start);
+    patch_size += end - start;
+    literals += end - start;
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  long t, b, n, next, offset, next_offset, literal_start, aligned;
+  unsigned h;
+  FILE *f;
+
+  if(argc != 4) {
+    fprintf(stderr, "usage: %s base new patch\n", argv[0]);
+    return 1;
+  }
+  base = read_file(argv[1], &base_size);
+  target = read_file(argv[2], &target_size);
+
+  head = malloc(sizeof(long) << HASH_BITS);
+  chain = malloc(sizeof(long) * (base_size + 1));
+  /* The worst case is all literals. */
+  patch = malloc(32 + target_size + target_size / LENGTH_MASK * 6);
+  if(head == NULL || chain == NULL || patch == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+
+  /* Later positions are put first in the chains. */
+  memset(head, 0xff, sizeof(long) << HASH_BITS);
+  for(b = 0; b + MIN_MATCH <= base_size; b++) {
+    h = hash(&base[b]);
+    chain[b] = head[h];
+    head[h] = b;
+  }
+
+  put('D');
+  put('L');
+  put('P');
+  put('1');
+  put_varint(base_size);
+  n = crc16_data(base, base_size);
+  put(n & 0xff);
+  put(n >> 8);
+  put_varint(target_size);
+  n = crc16_data(target, target_size);
+  put(n & 0xff);
+  put(n >> 8);
+
+  aligned = 0;
+  literal_start = 0;
+  for(t = 0; t < target_size;) {
+    n = find_match(t, aligned + t - literal_start, &offset);
+    if(n == 0) {
+      t++;
+      continue;
+    }
+
+    /* Postpone the copy by a byte if that gives a longer one. */
+    next = find_match(t + 1, aligned + t + 1 - literal_start, &next_offset);
+    if(next > n + 1) {
+      t++;
+      continue;
+    }
+
+    flush_literals(literal_start, t);
+    aligned += t - literal_start;
+    put_op(COPY, n);
+    put_varint(zigzag(offset - aligned));
+    copies++;
+    copied += n;
+    t += n;
+    aligned = offset + n;
+    literal_start = t;
+  }
+  flush_literals(literal_start, target_size);
+
+  f = fopen(argv[3], "wb");
+  if(f == NULL || fwrite(patch, 1, patch_size, f) != (size_t)patch_size) {
+    perror(argv[3]);
+    return 1;
+  }
+  fclose(f);
+
+  printf("%s: %ld bytes for %ld bytes, %ld copies of %ld bytes, "
+         "%ld literal bytes\n",
+         argv[3], patch_size, target_size, copies, copied, literals);
+  return 0;
+}
@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Adds a .prelink section to a loadable module, which maps each
+ *         undefined symbol of the module to its index in the symbols[]
+ *         array of a particular core. The ELF loader then resolves
+ *         those symbols without reading or comparing their names.
+ *
+ *         Usage: elfloader-prelink symbols.c module.ce output.ce
+ *
+ *         symbols.c is the symbol table that was generated for the
+ *         core. A module that is prelinked for another core is still
+ *         loaded, but through a lookup of the names.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SYMBOLS	4096
+#define MAX_NAME	64
+
+#define SHT_SYMTAB	2
+#define SHN_UNDEF	0
+
+#define EHDR_SIZE	52
+#define SHDR_SIZE	40
+#define SYM_SIZE	16
+
+static const unsigned char prelink_magic[] = {'P', 'L', 'N', 'K'};
+static const char prelink_name[] = ".prelink";
+
+static char names[MAX_SYMBOLS][MAX_NAME];
+static int nnames;
+
+/*---------------------------------------------------------------------------*/
+/* The same CRC as crc16_add() in core/lib/crc16.c. */
+static unsigned short
+crc16_add(unsigned char b, unsigned short acc)
+{
+  acc ^= b;
+  acc  = (acc >> 8) | (acc << 8);
+  acc ^= (acc & 0xff00) << 4;
+  acc ^= (acc >> 8) >> 4;
+  acc ^= (acc & 0xff00) >> 5;
+  return acc;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+get32(const unsigned char *p)
+{
+  return p[0] | p[1] << 8 | (unsigned long)p[2] << 16 |
+    (unsigned long)p[3] << 24;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+get16(const unsigned char *p)
+{
+  return p[0] | p[1] << 8;
+}
+/*---------------------------------------------------------------------------*/
+static void
+put32(unsigned char *p, unsigned long v)
+{
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+/*---------------------------------------------------------------------------*/
+static void
+put16(unsigned char *p, unsigned v)
+{
+  p[0] = v;
+  p[1] = v >> 8;
+}
+/*---------------------------------------------------------------------------*/
+/* Read the names of the symbols[] array in their order, from entries
+   such as { "name", (void *)&name }. */
+static int
+read_symbols(const char *filename)
+{
+  FILE *f;
+  char line[256];
+  char *p, *end;
+
+  f = fopen(filename, "r");
+  if(f == NULL) {
+    perror(filename);
+    return 0;
+  }
+  while(fgets(line, sizeof(line), f) != NULL) {
+    p = line + strspn(line, " \t");
+    if(*p++ != '{') {
+      continue;
+    }
+    p += strspn(p, " \t");
+    if(*p++ != '"' || (end = strchr(p, '"')) == NULL) {
+      continue;
+    }
+    if(nnames == MAX_SYMBOLS || end - p >= MAX_NAME) {
+      fprintf(stderr, "%s: too many or too long symbols\n", filename);
+      fclose(f);
+      return 0;
+    }
+    memcpy(names[nnames], p, end - p);
+    names[nnames][end - p] = '\0';
+    nnames++;
+  }
+  fclose(f);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+find_symbol(const char *name)
+{
+  int i;
+
+  for(i = 0; i < nnames; i++) {
+    if(strcmp(names[i], name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned char *
+read_file(const char *filename, long *size)
+{
+  FILE *f;
+  unsigned char *buf;
+
+  f = fopen(filename, "rb");
+  if(f == NULL) {
+    perror(filename);
+    return NULL;
+  }
+  fseek(f, 0, SEEK_END);
+  *size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  buf = malloc(*size);
+  if(buf == NULL || fread(buf, 1, *size, f) != (size_t)*size) {
+    fprintf(stderr, "%s: could not read the file\n", filename);
+    free(buf);
+    buf = NULL;
+  }
+  fclose(f);
+  return buf;
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  unsigned char *elf, *shdrs, *symtab, *sym, *out, *p;
+  long size, outsize, shoff, strtab, symtabsize, shstrtab, shstrtabsize;
+  long prelinkoff, shstrtaboff, newshoff;
+  unsigned shnum, shstrndx, nsyms, i;
+  unsigned short crc;
+  int index, unresolved;
+  const char *name;
+  FILE *f;
+
+  if(argc != 4) {
+    fprintf(stderr, "usage: %s symbols.c module.ce output.ce\n", argv[0]);
+    return 1;
+  }
+  if(!read_symbols(argv[1])) {
+    return 1;
+  }
+  elf = read_file(argv[2], &size);
+  if(elf == NULL) {
+    return 1;
+  }
+  if(size < EHDR_SIZE || memcmp(elf, "\177ELF\1\1", 6) != 0) {
+    fprintf(stderr, "%s: not a 32-bit little-endian ELF file\n", argv[2]);
+    return 1;
+  }
+
+  shoff = get32(elf + 32);
+  shnum = get16(elf + 48);
+  shstrndx = get16(elf + 50);
+  if(get16(elf + 46) != SHDR_SIZE || shoff + shnum * SHDR_SIZE > size ||
+     shstrndx >= shnum) {
+    fprintf(stderr, "%s: bad section headers\n", argv[2]);
+    return 1;
+  }
+  shdrs = elf + shoff;
+
+  for(i = 0; i < shnum && get32(shdrs + i * SHDR_SIZE + 4) != SHT_SYMTAB;
+      i++);
+  if(i == shnum) {
+    fprintf(stderr, "%s: no symbol table\n", argv[2]);
+    return 1;
+  }
+  symtab = elf + get32(shdrs + i * SHDR_SIZE + 16);
+  symtabsize = get32(shdrs + i * SHDR_SIZE + 20);
+  strtab = get32(shdrs + get32(shdrs + i * SHDR_SIZE + 24) * SHDR_SIZE + 16);
+  nsyms = symtabsize / SYM_SIZE;
+
+  shstrtab = get32(shdrs + shstrndx * SHDR_SIZE + 16);
+  shstrtabsize = get32(shdrs + shstrndx * SHDR_SIZE + 20);
+
+  /* The new file has the prelink table, a copy of the section name
+     table with the new name and a copy of the section headers with the
+     new section at its end. */
+  prelinkoff = (size + 3) & ~3L;
+  shstrtaboff = prelinkoff + 8 + 2 * nsyms;
+  newshoff = (shstrtaboff + shstrtabsize + sizeof(prelink_name) + 3) & ~3L;
+  outsize = newshoff + (shnum + 1) * SHDR_SIZE;
+  out = calloc(1, outsize);
+  if(out == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  memcpy(out, elf, size);
+
+  crc = 0;
+  for(i = 0; i < nnames; i++) {
+    for(name = names[i]; ; name++) {
+      crc = crc16_add(*name, crc);
+      if(*name == '\0') {
+        break;
+      }
+    }
+  }
+  p = out + prelinkoff;
+  memcpy(p, prelink_magic, sizeof(prelink_magic));
+  put16(p + 4, nnames + 1);
+  put16(p + 6, crc);
+
+  unresolved = 0;
+  for(i = 0; i < nsyms; i++) {
+    sym = symtab + i * SYM_SIZE;
+    index = -1;
+    if(get16(sym + 14) == SHN_UNDEF && get32(sym) != 0) {
+      name = (const char *)elf + strtab + get32(sym);
+      index = find_symbol(name);
+      if(index < 0) {
+        fprintf(stderr, "%s: %s is not in the core\n", argv[2], name);
+        unresolved++;
+      }
+    }
+    put16(p + 8 + 2 * i, index < 0 ? 0xffff : index);
+  }
+
+  memcpy(out + shstrtaboff, elf + shstrtab, shstrtabsize);
+  memcpy(out + shstrtaboff + shstrtabsize, prelink_name,
+         sizeof(prelink_name));
+
+  memcpy(out + newshoff, shdrs, shnum * SHDR_SIZE);
+  p = out + newshoff + shstrndx * SHDR_SIZE;
+  put32(p + 16, shstrtaboff);
+  put32(p + 20, shstrtabsize + sizeof(prelink_name));
+
+  /* A section of type SHT_PROGBITS without flags, so that it is not
+     loaded. */
+  p = out + newshoff + shnum * SHDR_SIZE;
+  put32(p, shstrtabsize);
+  put32(p + 4, 1);
+  put32(p + 16, prelinkoff);
+  put32(p + 20, 8 + 2 * nsyms);
+  put32(p + 32, 2);
+
+  put32(out + 32, newshoff);
+  put16(out + 48, shnum + 1);
+
+  f = fopen(argv[3], "wb");
+  if(f == NULL || fwrite(out, 1, outsize, f) != (size_t)outsize) {
+    perror(argv[3]);
+    return 1;
+  }
+  fclose(f);
+
+  printf("%s: %u symbols, %d not in the core\n", argv[3], nsyms, unresolved);
+  return 0;
+}
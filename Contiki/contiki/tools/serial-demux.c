@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2012, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Separates the streams of the serial multiplexer of a node,
+ *         apps/serial-mux, on a host.
+ *
+ *         Usage: serial-demux [-B baudrate] [-s siodev] [-S samplefile]
+ *
+ *         The shell stream is connected to a pseudo terminal, to be
+ *         used with a terminal program. The IP stream is connected to
+ *         another pseudo terminal as SLIP, so that tunslip6 can be
+ *         run on it, as on the serial port. Samples are appended to a
+ *         file, and logs are written to the standard error. Without a
+ *         serial device, the frames are read from the standard input
+ *         and written to the standard output.
+ */
+
+#define _GNU_SOURCE
+
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/select.h>
+
+#include "serial-mux-frame.h"
+
+/* The stream identifiers of apps/serial-mux/serial-mux.h. */
+#define SERIAL_MUX_SHELL	1
+#define SERIAL_MUX_IP		2
+#define SERIAL_MUX_SAMPLES	3
+#define SERIAL_MUX_LOG		4
+
+#define FRAME_SIZE	2048
+
+#define SLIP_END	0300
+#define SLIP_ESC	0333
+#define SLIP_ESC_END	0334
+#define SLIP_ESC_ESC	0335
+
+static int serialfd_in, serialfd_out;
+static int shellfd, slipfd;
+static FILE *samples;
+
+static struct serial_mux_decoder decoder;
+static uint8_t frame[FRAME_SIZE + 3];
+static uint8_t slip_packet[FRAME_SIZE];
+static int slip_len, slip_esc;
+
+static unsigned long frames, errors, unknown;
+
+/*---------------------------------------------------------------------------*/
+static void
+write_all(int fd, const uint8_t *data, int len)
+{
+  int n;
+
+  while(len > 0) {
+    n = write(fd, data, len);
+    if(n < 0) {
+      /* Nobody reads a pseudo terminal that is full. */
+      if(errno == EAGAIN) {
+        return;
+      }
+      err(1, "write");
+    }
+    data += n;
+    len -= n;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_frame(uint8_t stream, const uint8_t *data, int len)
+{
+  static uint8_t buf[SERIAL_MUX_ENCODED_SIZE(FRAME_SIZE)];
+  struct serial_mux_encoder e;
+
+  serial_mux_encode_start(&e, buf, sizeof(buf), stream);
+  if(serial_mux_encode_add(&e, data, len)) {
+    write_all(serialfd_out, buf, serial_mux_encode_end(&e));
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+slip_write(const uint8_t *data, int len)
+{
+  static uint8_t buf[2 * FRAME_SIZE + 2];
+  int i, n;
+
+  n = 0;
+  buf[n++] = SLIP_END;
+  for(i = 0; i < len; i++) {
+    if(data[i] == SLIP_END) {
+      buf[n++] = SLIP_ESC;
+      buf[n++] = SLIP_ESC_END;
+    } else if(data[i] == SLIP_ESC) {
+      buf[n++] = SLIP_ESC;
+      buf[n++] = SLIP_ESC_ESC;
+    } else {
+      buf[n++] = data[i];
+    }
+  }
+  buf[n++] = SLIP_END;
+  write_all(slipfd, buf, n);
+}
+/*---------------------------------------------------------------------------*/
+static void
+frame_input(int len)
+{
+  frames++;
+  switch(frame[0]) {
+  case SERIAL_MUX_SHELL:
+    write_all(shellfd, &frame[1], len);
+    break;
+  case SERIAL_MUX_IP:
+    slip_write(&frame[1], len);
+    break;
+  case SERIAL_MUX_SAMPLES:
+    if(samples != NULL) {
+      fwrite(&frame[1], 1, len, samples);
+      fflush(samples);
+    }
+    break;
+  case SERIAL_MUX_LOG:
+    write_all(STDERR_FILENO, &frame[1], len);
+    break;
+  default:
+    unknown++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+serial_input(void)
+{
+  uint8_t buf[1024];
+  int n, pos, len, used;
+
+  n = read(serialfd_in, buf, sizeof(buf));
+  if(n <= 0) {
+    return n;
+  }
+  for(pos = 0; pos < n; pos += used) {
+    len = serial_mux_decode(&decoder, buf + pos, n - pos, &used);
+    if(len > 0) {
+      frame_input(len);
+    } else if(len < 0) {
+      errors++;
+    }
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static void
+shell_input(void)
+{
+  uint8_t buf[128];
+  int n;
+
+  n = read(shellfd, buf, sizeof(buf));
+  if(n > 0) {
+    send_frame(SERIAL_MUX_SHELL, buf, n);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* SLIP packets from tunslip6 are sent on the IP stream. */
+static void
+slip_input(void)
+{
+  uint8_t buf[1024];
+  int n, i;
+  uint8_t c;
+
+  n = read(slipfd, buf, sizeof(buf));
+  for(i = 0; i < n; i++) {
+    c = buf[i];
+    if(c == SLIP_END) {
+      if(slip_len > 0) {
+        send_frame(SERIAL_MUX_IP, slip_packet, slip_len);
+      }
+      slip_len = 0;
+      continue;
+    }
+    if(slip_esc) {
+      slip_esc = 0;
+      c = c == SLIP_ESC_END ? SLIP_END : c == SLIP_ESC_ESC ? SLIP_ESC : c;
+    } else if(c == SLIP_ESC) {
+      slip_esc = 1;
+      continue;
+    }
+    if(slip_len < FRAME_SIZE) {
+      slip_packet[slip_len++] = c;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+open_pty(const char *name)
+{
+  struct termios tty;
+  int fd;
+
+  fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if(fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0) {
+    err(1, "posix_openpt");
+  }
+  if(tcgetattr(fd, &tty) == 0) {
+    cfmakeraw(&tty);
+    tcsetattr(fd, TCSANOW, &tty);
+  }
+  /* The slave is kept open, so that the master neither fails nor
+     loses data while no program has the terminal open. */
+  if(open(ptsname(fd), O_RDWR | O_NOCTTY) < 0) {
+    err(1, "%s", ptsname(fd));
+  }
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  fprintf(stderr, "%s on %s\n", name, ptsname(fd));
+  return fd;
+}
+/*---------------------------------------------------------------------------*/
+static void
+stty_raw(int fd, speed_t speed)
+{
+  struct termios tty;
+
+  if(tcgetattr(fd, &tty) == -1) err(1, "tcgetattr");
+  cfmakeraw(&tty);
+  tty.c_cc[VTIME] = 0;
+  tty.c_cc[VMIN] = 1;
+  tty.c_cflag |= CLOCAL;
+  cfsetispeed(&tty, speed);
+  cfsetospeed(&tty, speed);
+  if(tcsetattr(fd, TCSAFLUSH, &tty) == -1) err(1, "tcsetattr");
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  const char *siodev = NULL;
+  speed_t speed = B115200;
+  char dev[32];
+  fd_set rset;
+  int c, maxfd;
+
+  while((c = getopt(argc, argv, "B:s:S:h")) != -1) {
+    switch(c) {
+    case 'B':
+      switch(atoi(optarg)) {
+      case 9600: speed = B9600; break;
+      case 19200: speed = B19200; break;
+      case 38400: speed = B38400; break;
+      case 57600: speed = B57600; break;
+      case 115200: speed = B115200; break;
+      case 230400: speed = B230400; break;
+#ifndef __APPLE__
+      case 460800: speed = B460800; break;
+      case 921600: speed = B921600; break;
+#endif
+      default: errx(1, "unknown baudrate %s", optarg);
+      }
+      break;
+    case 's':
+      siodev = optarg;
+      break;
+    case 'S':
+      samples = fopen(optarg, "ab");
+      if(samples == NULL) {
+        err(1, "%s", optarg);
+      }
+      break;
+    default:
+      errx(1, "usage: serial-demux [-B baudrate] [-s siodev] [-S samplefile]");
+    }
+  }
+
+  if(siodev != NULL) {
+    if(siodev[0] == '/') {
+      snprintf(dev, sizeof(dev), "%s", siodev);
+    } else {
+      snprintf(dev, sizeof(dev), "/dev/%s", siodev);
+    }
+    serialfd_in = serialfd_out = open(dev, O_RDWR | O_NOCTTY);
+    if(serialfd_in < 0) {
+      err(1, "%s", dev);
+    }
+    stty_raw(serialfd_in, speed);
+  } else {
+    serialfd_in = STDIN_FILENO;
+    serialfd_out = STDOUT_FILENO;
+  }
+
+  serial_mux_decoder_init(&decoder, frame, sizeof(frame));
+  shellfd = open_pty("shell");
+  slipfd = open_pty("slip");
+
+  for(;;) {
+    FD_ZERO(&rset);
+    FD_SET(serialfd_in, &rset);
+    FD_SET(shellfd, &rset);
+    FD_SET(slipfd, &rset);
+    maxfd = serialfd_in > shellfd ? serialfd_in : shellfd;
+    maxfd = maxfd > slipfd ? maxfd : slipfd;
+    if(select(maxfd + 1, &rset, NULL, NULL, NULL) < 0) {
+      if(errno == EINTR) {
+        continue;
+      }
+      err(1, "select");
+    }
+    if(FD_ISSET(serialfd_in, &rset) && serial_input() <= 0) {
+      break;
+    }
+    if(FD_ISSET(shellfd, &rset)) {
+      shell_input();
+    }
+    if(FD_ISSET(slipfd, &rset)) {
+      slip_input();
+    }
+  }
+
+  fprintf(stderr, "serial-demux: %lu frames, %lu errors, %lu unknown\n",
+          frames, errors, unknown);
+  return 0;
+}
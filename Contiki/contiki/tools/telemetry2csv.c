@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2012, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Converts binary telemetry batches, in the format that
+ *         apps/telemetry/telemetry.h describes, to CSV.
+ *
+ *         Usage: telemetry2csv [-r] [-p] [file ...]
+ *
+ *         The input is a log with the batches as "TB" lines of
+ *         hexadecimal digits, as printed by powertrace, or with -r,
+ *         batches in binary that follow each other. With -p, powertrace
+ *         records are printed as the "P" lines of powertrace_print(),
+ *         for the scripts in tools/powertrace.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "telemetry.h"
+
+#define MAX_BATCH	4096
+#define MAX_NODES	1024
+
+static const char *powertrace_names[TELEMETRY_POWERTRACE_FIELDS] = {
+  "clock", "node", "all_cpu", "all_lpm", "all_transmit", "all_listen",
+  "all_idle_transmit", "all_idle_listen"
+};
+
+static const char *collect_view_names[TELEMETRY_COLLECT_VIEW_FIELDS] = {
+  "clock", "timesynch_time", "cpu", "lpm", "transmit", "listen",
+  "parent", "parent_etx", "current_rtmetric", "num_neighbors",
+  "beacon_interval", "sensor0", "sensor1", "sensor2", "sensor3",
+  "sensor4", "sensor5", "sensor6", "sensor7", "sensor8", "sensor9"
+};
+
+static struct {
+  uint32_t node;
+  uint32_t last[6];
+} nodes[MAX_NODES];
+static int num_nodes;
+
+static int powertrace_lines;
+static int last_schema = -1;
+static long records, errors;
+
+/*---------------------------------------------------------------------------*/
+static void
+print_csv(const struct telemetry_schema *s, uint32_t seqno,
+          const uint32_t *values)
+{
+  const char **names;
+  int i;
+
+  if(s->id != last_schema) {
+    names = s->id == TELEMETRY_SCHEMA_POWERTRACE ?
+      powertrace_names : collect_view_names;
+    printf("schema,seqno");
+    for(i = 0; i < s->fields; i++) {
+      printf(",%s", names[i]);
+    }
+    printf("\n");
+    last_schema = s->id;
+  }
+  printf("%u,%lu", s->id, (unsigned long)seqno);
+  for(i = 0; i < s->fields; i++) {
+    printf(",%lu", (unsigned long)values[i]);
+  }
+  printf("\n");
+}
+/*---------------------------------------------------------------------------*/
+static void
+print_powertrace(uint32_t seqno, const uint32_t *values)
+{
+  uint32_t *last;
+  int i;
+
+  for(i = 0; i < num_nodes && nodes[i].node != values[1]; i++);
+  if(i == num_nodes) {
+    if(num_nodes == MAX_NODES) {
+      fprintf(stderr, "telemetry2csv: too many nodes\n");
+      exit(1);
+    }
+    memset(&nodes[i], 0, sizeof(nodes[i]));
+    nodes[i].node = values[1];
+    num_nodes++;
+  }
+  last = nodes[i].last;
+
+  printf("%lu P %lu.%lu %lu", (unsigned long)values[0],
+         (unsigned long)(values[1] >> 8), (unsigned long)(values[1] & 0xff),
+         (unsigned long)seqno);
+  for(i = 0; i < 6; i++) {
+    printf(" %lu", (unsigned long)values[2 + i]);
+  }
+  for(i = 0; i < 6; i++) {
+    printf(" %lu", (unsigned long)(values[2 + i] - last[i]));
+    last[i] = values[2 + i];
+  }
+  printf("\n");
+}
+/*---------------------------------------------------------------------------*/
+/* Decode the batch at the start of data, and return its size, or -1
+   if it is malformed. */
+static int
+decode(const uint8_t *data, int len)
+{
+  struct telemetry_reader r;
+  uint32_t values[TELEMETRY_MAX_FIELDS];
+  int ret;
+
+  if(telemetry_read_start(&r, data, len) < 0) {
+    return -1;
+  }
+  while((ret = telemetry_read_next(&r, values)) > 0) {
+    records++;
+    if(!powertrace_lines) {
+      print_csv(r.schema, r.seqno + r.record - 1, values);
+    } else if(r.schema->id == TELEMETRY_SCHEMA_POWERTRACE) {
+      print_powertrace(r.seqno + r.record - 1, values);
+    }
+  }
+  return ret < 0 ? -1 : r.pos;
+}
+/*---------------------------------------------------------------------------*/
+static int
+hexval(int c)
+{
+  return isdigit(c) ? c - '0' : tolower(c) - 'a' + 10;
+}
+/*---------------------------------------------------------------------------*/
+static void
+read_log(FILE *f)
+{
+  static char line[2 * MAX_BATCH + 256];
+  static uint8_t data[MAX_BATCH];
+  char *p;
+  int len;
+
+  while(fgets(line, sizeof(line), f) != NULL) {
+    p = strstr(line, "TB ");
+    if(p == NULL || (p != line && !isspace((unsigned char)p[-1]))) {
+      continue;
+    }
+    p += 3;
+    for(len = 0; len < MAX_BATCH && isxdigit((unsigned char)p[0]) &&
+          isxdigit((unsigned char)p[1]); p += 2) {
+      data[len++] = hexval(p[0]) << 4 | hexval(p[1]);
+    }
+    if(decode(data, len) != len) {
+      errors++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+read_raw(FILE *f)
+{
+  static uint8_t data[MAX_BATCH];
+  int len, used;
+
+  len = 0;
+  for(;;) {
+    len += fread(data + len, 1, sizeof(data) - len, f);
+    if(len == 0) {
+      return;
+    }
+    /* The buffer is either full or holds the rest of the input, so
+       a batch that does not fit is malformed. */
+    used = decode(data, len);
+    if(used < 0) {
+      errors++;
+      return;
+    }
+    memmove(data, data + used, len - used);
+    len -= used;
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  FILE *f;
+  int raw, i;
+
+  raw = 0;
+  for(i = 1; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+    if(strcmp(argv[i], "-r") == 0) {
+      raw = 1;
+    } else if(strcmp(argv[i], "-p") == 0) {
+      powertrace_lines = 1;
+    } else {
+      fprintf(stderr, "usage: telemetry2csv [-r] [-p] [file ...]\n");
+      return 1;
+    }
+  }
+
+  if(i == argc) {
+    if(raw) {
+      read_raw(stdin);
+    } else {
+      read_log(stdin);
+    }
+  }
+  for(; i < argc; i++) {
+    f = fopen(argv[i], raw ? "rb" : "r");
+    if(f == NULL) {
+      perror(argv[i]);
+      return 1;
+    }
+    if(raw) {
+      read_raw(f);
+    } else {
+      read_log(f);
+    }
+    fclose(f);
+  }
+
+  if(errors > 0) {
+    fprintf(stderr, "telemetry2csv: %ld malformed batches, %ld records\n",
+            errors, records);
+    return 1;
+  }
+  return 0;
+}